@@ -0,0 +1,83 @@
+<?php
+
+/**
+ * Measures the throughput of the PHQL and Volt parsers
+ *
+ * The corpus is made of the PHQL statements found in the unit tests and the Volt
+ * templates used by them. The PHQL parser cache must be disabled to measure the parser:
+ *
+ *   php -d phalcon.orm.cache_level=-1 build/bench-parsers.php [iterations]
+ */
+
+if (!extension_loaded('phalcon')) {
+	fwrite(STDERR, "The phalcon extension is not loaded" . PHP_EOL);
+	exit(1);
+}
+
+if ((int) ini_get('phalcon.orm.cache_level') >= 0) {
+	fwrite(STDERR, "Warning: the PHQL parser cache is enabled, run with -d phalcon.orm.cache_level=-1" . PHP_EOL);
+}
+
+$iterations = isset($argv[1]) ? max(1, (int) $argv[1]) : 200;
+$testsDir = __DIR__ . '/../unit-tests';
+
+$statements = array();
+foreach (glob($testsDir . '/*.php') as $file) {
+	if (preg_match_all('/(?:executeQuery|createQuery|Query)\(\s*\'((?:SELECT|INSERT|UPDATE|DELETE)\b[^\']*)\'/i', file_get_contents($file), $matches)) {
+		foreach ($matches[1] as $phql) {
+			try {
+				Phalcon\Mvc\Model\Query\Lang::parsePHQL($phql);
+				$statements[$phql] = true;
+			} catch (Phalcon\Mvc\Model\Exception $e) {
+			}
+		}
+	}
+}
+$statements = array_keys($statements);
+
+$templates = array();
+$compiler = new Phalcon\Mvc\View\Engine\Volt\Compiler();
+$iterator = new RecursiveIteratorIterator(new RecursiveDirectoryIterator($testsDir . '/views'));
+foreach ($iterator as $file) {
+	if ($file->isFile() && substr($file->getFilename(), -5) == '.volt') {
+		$template = file_get_contents($file->getPathname());
+		try {
+			$compiler->parse($template);
+			$templates[] = $template;
+		} catch (Phalcon\Mvc\View\Exception $e) {
+		}
+	}
+}
+
+function bench($name, $corpus, $iterations, $parser)
+{
+	$bytes = 0;
+	foreach ($corpus as $source) {
+		$bytes += strlen($source);
+	}
+
+	$start = microtime(true);
+	for ($i = 0; $i < $iterations; $i++) {
+		foreach ($corpus as $source) {
+			$parser($source);
+		}
+	}
+	$elapsed = microtime(true) - $start;
+
+	$parses = $iterations * count($corpus);
+	printf(
+		"%-6s %5d sources %9d parses %8.3fs %12.0f parses/s %8.2f MB/s\n",
+		$name, count($corpus), $parses, $elapsed,
+		$parses / $elapsed, $bytes * $iterations / $elapsed / 1048576
+	);
+}
+
+bench('PHQL', $statements, $iterations, function($phql) {
+	return Phalcon\Mvc\Model\Query\Lang::parsePHQL($phql);
+});
+
+bench('Volt', $templates, $iterations, function($template) use ($compiler) {
+	return $compiler->parse($template);
+});
+
+printf("Peak memory: %.2f MB\n", memory_get_peak_usage() / 1048576);
@@ -154,6 +154,7 @@ mvc/model/metadata/apc.c \
 mvc/model/metadata/xcache.c \
 mvc/model/metadata/memory.c \
 mvc/model/metadata/session.c \
+mvc/model/metadata/mmap.c \
 mvc/model/transaction.c \
 mvc/model/validatorinterface.c \
 mvc/model/metadata.c \
@@ -192,6 +193,7 @@ mvc/model/validator/regex.c \
 mvc/model/validator/numericality.c \
 mvc/model/validator/stringlength.c \
 mvc/model/validator/json.c \
+mvc/model/resultset/columns.c \
 mvc/model/resultset/complex.c \
 mvc/model/resultset/simple.c \
 mvc/model/behavior/timestampable.c \
@@ -293,6 +295,7 @@ kernel.c \
 paginator/adapter/model.c \
 paginator/adapter/nativearray.c \
 paginator/adapter/querybuilder.c \
+paginator/adapter/keyset.c \
 paginator/exception.c \
 paginator/adapterinterface.c \
 di/injectable.c \
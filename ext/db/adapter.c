@@ -23,6 +23,7 @@
 #include "db/index.h"
 #include "db/rawvalue.h"
 #include "db/reference.h"
+#include "cache/backendinterface.h"
 #include "events/eventsawareinterface.h"
 
 #include "ext/pdo/php_pdo_driver.h"
@@ -39,6 +40,8 @@
 #include "kernel/hash.h"
 #include "kernel/string.h"
 
+#include <ext/standard/php_lcg.h>
+
 /**
  * Phalcon\Db\Adapter
  *
@@ -54,6 +57,8 @@ PHP_METHOD(Phalcon_Db_Adapter, getDialect);
 PHP_METHOD(Phalcon_Db_Adapter, fetchOne);
 PHP_METHOD(Phalcon_Db_Adapter, fetchAll);
 PHP_METHOD(Phalcon_Db_Adapter, insert);
+PHP_METHOD(Phalcon_Db_Adapter, insertMultiple);
+PHP_METHOD(Phalcon_Db_Adapter, upsert);
 PHP_METHOD(Phalcon_Db_Adapter, update);
 PHP_METHOD(Phalcon_Db_Adapter, delete);
 PHP_METHOD(Phalcon_Db_Adapter, getColumnList);
@@ -98,6 +103,9 @@ PHP_METHOD(Phalcon_Db_Adapter, getSQLVariables);
 PHP_METHOD(Phalcon_Db_Adapter, getSQLBindTypes);
 PHP_METHOD(Phalcon_Db_Adapter, getType);
 PHP_METHOD(Phalcon_Db_Adapter, getDialectType);
+PHP_METHOD(Phalcon_Db_Adapter, setSchemaCache);
+PHP_METHOD(Phalcon_Db_Adapter, getSchemaCache);
+PHP_METHOD(Phalcon_Db_Adapter, clearSchemaCache);
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_adapter_seteventsmanager, 0, 0, 1)
 	ZEND_ARG_INFO(0, eventsManager)
@@ -107,6 +115,33 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_adapter_setdialect, 0, 0, 1)
 	ZEND_ARG_INFO(0, dialect)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_adapter_insertmultiple, 0, 0, 2)
+	ZEND_ARG_INFO(0, table)
+	ZEND_ARG_INFO(0, rows)
+	ZEND_ARG_INFO(0, fields)
+	ZEND_ARG_INFO(0, dataTypes)
+	ZEND_ARG_INFO(0, identityField)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_adapter_upsert, 0, 0, 4)
+	ZEND_ARG_INFO(0, table)
+	ZEND_ARG_INFO(0, values)
+	ZEND_ARG_INFO(0, fields)
+	ZEND_ARG_INFO(0, keys)
+	ZEND_ARG_INFO(0, dataTypes)
+	ZEND_ARG_INFO(0, updateFields)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_adapter_setschemacache, 0, 0, 1)
+	ZEND_ARG_INFO(0, cache)
+	ZEND_ARG_INFO(0, lifetime)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_adapter_clearschemacache, 0, 0, 0)
+	ZEND_ARG_INFO(0, table)
+	ZEND_ARG_INFO(0, schema)
+ZEND_END_ARG_INFO()
+
 static const zend_function_entry phalcon_db_adapter_method_entry[] = {
 	PHP_ME(Phalcon_Db_Adapter, __construct, NULL, ZEND_ACC_PROTECTED|ZEND_ACC_CTOR)
 	PHP_ME(Phalcon_Db_Adapter, setEventsManager, arginfo_phalcon_db_adapter_seteventsmanager, ZEND_ACC_PUBLIC)
@@ -116,6 +151,8 @@ static const zend_function_entry phalcon_db_adapter_method_entry[] = {
 	PHP_ME(Phalcon_Db_Adapter, fetchOne, arginfo_phalcon_db_adapterinterface_fetchone, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Adapter, fetchAll, arginfo_phalcon_db_adapterinterface_fetchall, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Adapter, insert, arginfo_phalcon_db_adapterinterface_insert, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Adapter, insertMultiple, arginfo_phalcon_db_adapter_insertmultiple, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Adapter, upsert, arginfo_phalcon_db_adapter_upsert, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Adapter, update, arginfo_phalcon_db_adapterinterface_update, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Adapter, delete, arginfo_phalcon_db_adapterinterface_delete, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Adapter, getColumnList, arginfo_phalcon_db_adapterinterface_getcolumnlist, ZEND_ACC_PUBLIC)
@@ -160,6 +197,9 @@ static const zend_function_entry phalcon_db_adapter_method_entry[] = {
 	PHP_ME(Phalcon_Db_Adapter, getSQLBindTypes, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Adapter, getType, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Adapter, getDialectType, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Adapter, setSchemaCache, arginfo_phalcon_db_adapter_setschemacache, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Adapter, getSchemaCache, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Adapter, clearSchemaCache, arginfo_phalcon_db_adapter_clearschemacache, ZEND_ACC_PUBLIC)
 	PHP_FE_END
 };
 
@@ -182,6 +222,8 @@ PHALCON_INIT_CLASS(Phalcon_Db_Adapter){
 	zend_declare_property_long(phalcon_db_adapter_ce, SL("_transactionLevel"), 0, ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_long(phalcon_db_adapter_ce, SL("_transactionsWithSavepoints"), 0, ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_long(phalcon_db_adapter_ce, SL("_connectionConsecutive"), 0, ZEND_ACC_PROTECTED|ZEND_ACC_STATIC TSRMLS_CC);
+	zend_declare_property_null(phalcon_db_adapter_ce, SL("_schemaCache"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_long(phalcon_db_adapter_ce, SL("_schemaCacheLifetime"), 86400, ZEND_ACC_PROTECTED TSRMLS_CC);
 
 	zend_class_implements(phalcon_db_adapter_ce TSRMLS_CC, 2, phalcon_events_eventsawareinterface_ce, phalcon_db_adapterinterface_ce);
 
@@ -566,6 +608,495 @@ PHP_METHOD(Phalcon_Db_Adapter, insert){
 	RETURN_MM();
 }
 
+/**
+ * Inserts several rows into a table using multi-row INSERT statements. Rows are sent in chunks
+ * so every statement stays under the number of bind parameters accepted by the database system
+ *
+ * <code>
+ * //Inserting several robots at once
+ * $success = $connection->insertMultiple(
+ *     "robots",
+ *     array(
+ *         array("Astro Boy", 1952),
+ *         array("Terminator", 1984)
+ *     ),
+ *     array("name", "year")
+ * );
+ *
+ * //Next SQL sentence is sent to the database system
+ * INSERT INTO `robots` (`name`, `year`) VALUES ("Astro boy", 1952), ("Terminator", 1984);
+ * </code>
+ *
+ * When an identity column is passed the values generated for it are returned in the order of the rows:
+ * PostgreSQL reads them with RETURNING, MySQL and SQLite derive them from lastInsertId() because both
+ * assign consecutive values to the rows of a single statement (with the default auto_increment_increment
+ * in MySQL). Other adapters return true since the values cannot be recovered
+ *
+ * @param 	string $table
+ * @param 	array $rows
+ * @param 	array $fields
+ * @param 	array $dataTypes
+ * @param 	string $identityField
+ * @return 	boolean|array
+ */
+PHP_METHOD(Phalcon_Db_Adapter, insertMultiple){
+
+	zval *table, *rows, *fields = NULL, *data_types = NULL, *identity_field = NULL, *exception_message;
+	zval *dialect, *max_bind_params = NULL, *row = NULL, *value = NULL, *position = NULL;
+	zval *str_value = NULL, *bind_type = NULL, *row_placeholders = NULL;
+	zval *placeholders = NULL, *insert_values = NULL, *bind_data_types = NULL;
+	zval *escaped_table = NULL, *escaped_fields = NULL, *field = NULL, *escaped_field = NULL;
+	zval *insert_sql = NULL, *success = NULL, *type, *escaped_identity = NULL, *fetch_num = NULL;
+	zval *identity_rows = NULL, *identity_row = NULL, *identity_value = NULL, *last_insert_id = NULL, *identities = NULL;
+	HashTable *ah0, *ah1, *ah2, *ah3;
+	HashPosition hp0, hp1, hp2, hp3;
+	zval **hd;
+	long int number_columns, chunk_size, chunk_rows = 0, first_id, i;
+	enum { IDENTITY_NONE, IDENTITY_RETURNING, IDENTITY_FIRST, IDENTITY_LAST } identity_mode = IDENTITY_NONE;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 2, 3, &table, &rows, &fields, &data_types, &identity_field);
+	
+	if (!fields) {
+		fields = PHALCON_GLOBAL(z_null);
+	}
+	
+	if (!data_types) {
+		data_types = PHALCON_GLOBAL(z_null);
+	}
+	
+	/** 
+	 * The way to recover the generated identity values depends on the database system,
+	 * lastInsertId() is the first value of the statement in MySQL and the last one in SQLite
+	 */
+	if (identity_field && Z_TYPE_P(identity_field) == IS_STRING) {
+		type = phalcon_fetch_nproperty_this(this_ptr, SL("_type"), PH_NOISY TSRMLS_CC);
+		if (PHALCON_IS_STRING(type, "pgsql")) {
+			identity_mode = IDENTITY_RETURNING;
+		} else if (PHALCON_IS_STRING(type, "mysql")) {
+			identity_mode = IDENTITY_FIRST;
+		} else if (PHALCON_IS_STRING(type, "sqlite")) {
+			identity_mode = IDENTITY_LAST;
+		}
+	}
+	
+	if (identity_mode != IDENTITY_NONE) {
+		PHALCON_INIT_VAR(identities);
+		array_init_size(identities, zend_hash_num_elements(Z_ARRVAL_P(rows)));
+	}
+	
+	if (identity_mode == IDENTITY_RETURNING) {
+		if (PHALCON_GLOBAL(db).escape_identifiers) {
+			PHALCON_CALL_METHOD(&escaped_identity, this_ptr, "escapeidentifier", identity_field);
+		} else {
+			PHALCON_CPY_WRT(escaped_identity, identity_field);
+		}
+	
+		PHALCON_INIT_VAR(fetch_num);
+		ZVAL_LONG(fetch_num, PDO_FETCH_NUM);
+	}
+	
+	if (unlikely(Z_TYPE_P(rows) != IS_ARRAY)) { 
+		PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "The second parameter for insertMultiple isn't an Array");
+		return;
+	}
+	
+	if (!phalcon_fast_count_ev(rows TSRMLS_CC)) {
+		PHALCON_INIT_VAR(exception_message);
+		PHALCON_CONCAT_SVS(exception_message, "Unable to insert into ", table, " without data");
+		PHALCON_THROW_EXCEPTION_ZVAL(phalcon_db_exception_ce, exception_message);
+		return;
+	}
+	
+	/** 
+	 * Every row must have the same number of columns, the first row defines it if there are no fields
+	 */
+	if (Z_TYPE_P(fields) == IS_ARRAY) { 
+		number_columns = phalcon_fast_count_int(fields TSRMLS_CC);
+	} else {
+		zend_hash_internal_pointer_reset(Z_ARRVAL_P(rows));
+		if (zend_hash_get_current_data(Z_ARRVAL_P(rows), (void**) &hd) == FAILURE || Z_TYPE_PP(hd) != IS_ARRAY) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "Every row passed to insertMultiple must be an Array");
+			return;
+		}
+		number_columns = phalcon_fast_count_int(*hd TSRMLS_CC);
+	}
+	
+	if (!number_columns) {
+		PHALCON_INIT_VAR(exception_message);
+		PHALCON_CONCAT_SVS(exception_message, "Unable to insert into ", table, " without data");
+		PHALCON_THROW_EXCEPTION_ZVAL(phalcon_db_exception_ce, exception_message);
+		return;
+	}
+	
+	/** 
+	 * The dialect knows how many bind parameters can be sent in a single statement
+	 */
+	dialect = phalcon_fetch_nproperty_this(this_ptr, SL("_dialect"), PH_NOISY TSRMLS_CC);
+	PHALCON_CALL_METHOD(&max_bind_params, dialect, "getmaxbindparams");
+	
+	chunk_size = phalcon_get_intval(max_bind_params) / number_columns;
+	if (chunk_size < 1) {
+		chunk_size = 1;
+	}
+	
+	if (PHALCON_GLOBAL(db).escape_identifiers) {
+		PHALCON_CALL_METHOD(&escaped_table, this_ptr, "escapeidentifier", table);
+	} else {
+		PHALCON_CPY_WRT(escaped_table, table);
+	}
+	
+	if (Z_TYPE_P(fields) == IS_ARRAY) { 
+		if (PHALCON_GLOBAL(db).escape_identifiers) {
+	
+			PHALCON_INIT_VAR(escaped_fields);
+			array_init_size(escaped_fields, number_columns);
+	
+			phalcon_is_iterable(fields, &ah1, &hp1, 0, 0);
+	
+			while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
+	
+				PHALCON_GET_HVALUE(field);
+	
+				PHALCON_CALL_METHOD(&escaped_field, this_ptr, "escapeidentifier", field);
+				phalcon_array_append(&escaped_fields, escaped_field, 0);
+	
+				zend_hash_move_forward_ex(ah1, &hp1);
+			}
+	
+		} else {
+			PHALCON_CPY_WRT(escaped_fields, fields);
+		}
+	} else {
+		PHALCON_INIT_VAR(escaped_fields);
+	}
+	
+	phalcon_is_iterable(rows, &ah0, &hp0, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(row);
+	
+		if (Z_TYPE_P(row) != IS_ARRAY || phalcon_fast_count_int(row TSRMLS_CC) != number_columns) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "Every row passed to insertMultiple must have the same number of columns");
+			return;
+		}
+	
+		if (!chunk_rows) {
+			PHALCON_INIT_NVAR(placeholders);
+			array_init_size(placeholders, chunk_size);
+	
+			PHALCON_INIT_NVAR(insert_values);
+			array_init(insert_values);
+			if (Z_TYPE_P(data_types) == IS_ARRAY) { 
+				PHALCON_INIT_NVAR(bind_data_types);
+				array_init(bind_data_types);
+			} else {
+				PHALCON_CPY_WRT(bind_data_types, data_types);
+			}
+		}
+	
+		/** 
+		 * Values are treated as in insert(): objects are casted using __toString, null values
+		 * are converted to string 'null', everything else is passed as '?'
+		 */
+		PHALCON_INIT_NVAR(row_placeholders);
+		array_init_size(row_placeholders, number_columns);
+	
+		phalcon_is_iterable(row, &ah2, &hp2, 0, 0);
+	
+		while (zend_hash_get_current_data_ex(ah2, (void**) &hd, &hp2) == SUCCESS) {
+	
+			PHALCON_GET_HKEY(position, ah2, hp2);
+			PHALCON_GET_HVALUE(value);
+	
+			if (Z_TYPE_P(value) == IS_OBJECT) {
+				PHALCON_INIT_NVAR(str_value);
+				phalcon_strval(str_value, value);
+				phalcon_array_append(&row_placeholders, str_value, 0);
+			} else {
+				if (Z_TYPE_P(value) == IS_NULL) {
+					phalcon_array_append_string(&row_placeholders, SL("null"), 0);
+				} else {
+					phalcon_array_append_string(&row_placeholders, SL("?"), 0);
+					phalcon_array_append(&insert_values, value, 0);
+					if (Z_TYPE_P(data_types) == IS_ARRAY) { 
+						if (!phalcon_array_isset(data_types, position)) {
+							PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "Incomplete number of bind types");
+							return;
+						}
+	
+						PHALCON_OBS_NVAR(bind_type);
+						phalcon_array_fetch(&bind_type, data_types, position, PH_NOISY);
+						phalcon_array_append(&bind_data_types, bind_type, PH_SEPARATE);
+					}
+				}
+			}
+	
+			zend_hash_move_forward_ex(ah2, &hp2);
+		}
+	
+		phalcon_array_append(&placeholders, row_placeholders, 0);
+		chunk_rows++;
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+	
+		/** 
+		 * Send the chunk when it is full or there are no more rows
+		 */
+		if (chunk_rows == chunk_size || zend_hash_has_more_elements_ex(ah0, &hp0) == FAILURE) {
+	
+			PHALCON_CALL_METHOD(&insert_sql, dialect, "insertmultiple", escaped_table, escaped_fields, placeholders);
+	
+			if (identity_mode == IDENTITY_RETURNING) {
+				PHALCON_SCONCAT_SV(insert_sql, " RETURNING ", escaped_identity);
+	
+				PHALCON_CALL_METHOD(&identity_rows, this_ptr, "fetchall", insert_sql, fetch_num, insert_values, bind_data_types);
+				if (Z_TYPE_P(identity_rows) != IS_ARRAY) {
+					RETURN_MM_FALSE;
+				}
+	
+				phalcon_is_iterable(identity_rows, &ah3, &hp3, 0, 0);
+	
+				while (zend_hash_get_current_data_ex(ah3, (void**) &hd, &hp3) == SUCCESS) {
+	
+					PHALCON_GET_HVALUE(identity_row);
+	
+					PHALCON_OBS_NVAR(identity_value);
+					phalcon_array_fetch_long(&identity_value, identity_row, 0, PH_NOISY);
+					phalcon_array_append(&identities, identity_value, 0);
+	
+					zend_hash_move_forward_ex(ah3, &hp3);
+				}
+	
+			} else {
+				PHALCON_CALL_METHOD(&success, this_ptr, "execute", insert_sql, insert_values, bind_data_types);
+				if (!zend_is_true(success)) {
+					RETURN_CTOR(success);
+				}
+	
+				if (identity_mode != IDENTITY_NONE) {
+					PHALCON_CALL_METHOD(&last_insert_id, this_ptr, "lastinsertid");
+	
+					first_id = phalcon_get_intval(last_insert_id);
+					if (identity_mode == IDENTITY_LAST) {
+						first_id -= chunk_rows - 1;
+					}
+	
+					for (i = 0; i < chunk_rows; i++) {
+						add_next_index_long(identities, first_id + i);
+					}
+				}
+			}
+	
+			chunk_rows = 0;
+		}
+	}
+	
+	if (identity_mode != IDENTITY_NONE) {
+		RETURN_CTOR(identities);
+	}
+	
+	RETURN_MM_TRUE;
+}
+
+/**
+ * Inserts a row or updates it when the keys are already taken using a single statement
+ * (ON CONFLICT, ON DUPLICATE KEY UPDATE or MERGE depending on the dialect)
+ *
+ * <code>
+ * //Inserting or updating the robot with id 1
+ * $success = $connection->upsert(
+ *     "robots",
+ *     array(1, "Astro Boy", 1952),
+ *     array("id", "name", "year"),
+ *     array("id")
+ * );
+ *
+ * //Next SQL sentence is sent to the database system (MySQL)
+ * INSERT INTO `robots` (`id`, `name`, `year`) VALUES (1, "Astro boy", 1952) ON DUPLICATE KEY UPDATE `name` = VALUES(`name`), `year` = VALUES(`year`);
+ * </code>
+ *
+ * @param 	string $table
+ * @param 	array $values
+ * @param 	array $fields
+ * @param 	array $keys
+ * @param 	array $dataTypes
+ * @param 	array $updateFields
+ * @return 	boolean
+ */
+PHP_METHOD(Phalcon_Db_Adapter, upsert){
+
+	zval *table, *values, *fields, *keys, *data_types = NULL, *update_fields = NULL;
+	zval *exception_message, *placeholders, *upsert_values, *bind_data_types = NULL;
+	zval *value = NULL, *position = NULL, *str_value = NULL, *bind_type = NULL;
+	zval *escaped_table = NULL, *escaped_fields, *escaped_keys, *escaped_update_fields;
+	zval *field = NULL, *escaped_field = NULL, *dialect, *upsert_sql = NULL;
+	HashTable *ah0, *ah1, *ah2;
+	HashPosition hp0, hp1, hp2;
+	zval **hd;
+	int escape;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 4, 2, &table, &values, &fields, &keys, &data_types, &update_fields);
+	
+	if (!data_types) {
+		data_types = PHALCON_GLOBAL(z_null);
+	}
+	
+	if (!update_fields) {
+		update_fields = PHALCON_GLOBAL(z_null);
+	}
+	
+	if (unlikely(Z_TYPE_P(values) != IS_ARRAY)) { 
+		PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "The second parameter for upsert isn't an Array");
+		return;
+	}
+	
+	if (Z_TYPE_P(fields) != IS_ARRAY || phalcon_fast_count_int(fields TSRMLS_CC) != phalcon_fast_count_int(values TSRMLS_CC)) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "Every value passed to upsert must have a field");
+		return;
+	}
+	
+	if (Z_TYPE_P(keys) != IS_ARRAY || !phalcon_fast_count_ev(keys TSRMLS_CC)) {
+		PHALCON_INIT_VAR(exception_message);
+		PHALCON_CONCAT_SVS(exception_message, "Unable to upsert into ", table, " without keys");
+		PHALCON_THROW_EXCEPTION_ZVAL(phalcon_db_exception_ce, exception_message);
+		return;
+	}
+	
+	if (!phalcon_fast_count_ev(values TSRMLS_CC)) {
+		PHALCON_INIT_VAR(exception_message);
+		PHALCON_CONCAT_SVS(exception_message, "Unable to upsert into ", table, " without data");
+		PHALCON_THROW_EXCEPTION_ZVAL(phalcon_db_exception_ce, exception_message);
+		return;
+	}
+	
+	PHALCON_INIT_VAR(placeholders);
+	array_init(placeholders);
+	
+	PHALCON_INIT_VAR(upsert_values);
+	array_init(upsert_values);
+	if (Z_TYPE_P(data_types) == IS_ARRAY) { 
+		PHALCON_INIT_VAR(bind_data_types);
+		array_init(bind_data_types);
+	} else {
+		PHALCON_CPY_WRT(bind_data_types, data_types);
+	}
+	
+	/** 
+	 * Values are treated as in insert(): objects are casted using __toString, null values
+	 * are converted to string 'null', everything else is passed as '?'
+	 */
+	phalcon_is_iterable(values, &ah0, &hp0, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HKEY(position, ah0, hp0);
+		PHALCON_GET_HVALUE(value);
+	
+		if (Z_TYPE_P(value) == IS_OBJECT) {
+			PHALCON_INIT_NVAR(str_value);
+			phalcon_strval(str_value, value);
+			phalcon_array_append(&placeholders, str_value, 0);
+		} else {
+			if (Z_TYPE_P(value) == IS_NULL) {
+				phalcon_array_append_string(&placeholders, SL("null"), 0);
+			} else {
+				phalcon_array_append_string(&placeholders, SL("?"), 0);
+				phalcon_array_append(&upsert_values, value, 0);
+				if (Z_TYPE_P(data_types) == IS_ARRAY) { 
+					if (!phalcon_array_isset(data_types, position)) {
+						PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "Incomplete number of bind types");
+						return;
+					}
+	
+					PHALCON_OBS_NVAR(bind_type);
+					phalcon_array_fetch(&bind_type, data_types, position, PH_NOISY);
+					phalcon_array_append(&bind_data_types, bind_type, PH_SEPARATE);
+				}
+			}
+		}
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+	
+	escape = PHALCON_GLOBAL(db).escape_identifiers;
+	
+	if (escape) {
+		PHALCON_CALL_METHOD(&escaped_table, this_ptr, "escapeidentifier", table);
+	} else {
+		PHALCON_CPY_WRT(escaped_table, table);
+	}
+	
+	/** 
+	 * Fields that aren't keys are updated unless the update fields are passed explicitly
+	 */
+	PHALCON_INIT_VAR(escaped_fields);
+	array_init(escaped_fields);
+	
+	PHALCON_INIT_VAR(escaped_update_fields);
+	array_init(escaped_update_fields);
+	
+	phalcon_is_iterable(fields, &ah1, &hp1, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(field);
+	
+		if (escape) {
+			PHALCON_CALL_METHOD(&escaped_field, this_ptr, "escapeidentifier", field);
+		} else {
+			PHALCON_CPY_WRT(escaped_field, field);
+		}
+	
+		phalcon_array_append(&escaped_fields, escaped_field, 0);
+	
+		if (Z_TYPE_P(update_fields) == IS_ARRAY) {
+			if (phalcon_fast_in_array(field, update_fields TSRMLS_CC)) {
+				phalcon_array_append(&escaped_update_fields, escaped_field, 0);
+			}
+		} else {
+			if (!phalcon_fast_in_array(field, keys TSRMLS_CC)) {
+				phalcon_array_append(&escaped_update_fields, escaped_field, 0);
+			}
+		}
+	
+		zend_hash_move_forward_ex(ah1, &hp1);
+	}
+	
+	PHALCON_INIT_VAR(escaped_keys);
+	array_init(escaped_keys);
+	
+	phalcon_is_iterable(keys, &ah2, &hp2, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah2, (void**) &hd, &hp2) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(field);
+	
+		if (escape) {
+			PHALCON_CALL_METHOD(&escaped_field, this_ptr, "escapeidentifier", field);
+		} else {
+			PHALCON_CPY_WRT(escaped_field, field);
+		}
+	
+		phalcon_array_append(&escaped_keys, escaped_field, 0);
+	
+		zend_hash_move_forward_ex(ah2, &hp2);
+	}
+	
+	dialect = phalcon_fetch_nproperty_this(this_ptr, SL("_dialect"), PH_NOISY TSRMLS_CC);
+	PHALCON_CALL_METHOD(&upsert_sql, dialect, "upsert", escaped_table, escaped_fields, placeholders, escaped_keys, escaped_update_fields);
+	
+	/** 
+	 * Perform the execution via execute
+	 */
+	PHALCON_RETURN_CALL_METHOD(this_ptr, "execute", upsert_sql, upsert_values, bind_data_types);
+	RETURN_MM();
+}
+
 /**
  * Updates data on a table using custom RBDM SQL syntax
  *
@@ -1474,7 +2005,7 @@ PHP_METHOD(Phalcon_Db_Adapter, listViews){
  */
 PHP_METHOD(Phalcon_Db_Adapter, describeIndexes){
 
-	zval *table, *schema = NULL, *dialect, *fetch_num, *sql = NULL, *describe = NULL;
+	zval *table, *schema = NULL, *schema_key, *dialect, *fetch_num, *sql = NULL, *describe = NULL;
 	zval *indexes, *index = NULL, *key_name = NULL, *column_name = NULL;
 	zval *index_columns = NULL, *name = NULL;
 	HashTable *ah0, *ah1;
@@ -1489,6 +2020,11 @@ PHP_METHOD(Phalcon_Db_Adapter, describeIndexes){
 		schema = PHALCON_GLOBAL(z_null);
 	}
 	
+	PHALCON_INIT_VAR(schema_key);
+	if (phalcon_db_adapter_get_cached_schema(return_value, schema_key, this_ptr, "indexes", table, schema TSRMLS_CC)) {
+		RETURN_MM();
+	}
+	
 	dialect = phalcon_fetch_nproperty_this(this_ptr, SL("_dialect"), PH_NOISY TSRMLS_CC);
 	
 	/** 
@@ -1547,6 +2083,8 @@ PHP_METHOD(Phalcon_Db_Adapter, describeIndexes){
 		zend_hash_move_forward_ex(ah1, &hp1);
 	}
 	
+	phalcon_db_adapter_cache_schema(this_ptr, schema_key, return_value TSRMLS_CC);
+	
 	PHALCON_MM_RESTORE();
 }
 
@@ -1563,7 +2101,7 @@ PHP_METHOD(Phalcon_Db_Adapter, describeIndexes){
  */
 PHP_METHOD(Phalcon_Db_Adapter, describeReferences){
 
-	zval *table, *schema = NULL, *dialect, *fetch_num, *sql = NULL, *empty_arr;
+	zval *table, *schema = NULL, *schema_key, *dialect, *fetch_num, *sql = NULL, *empty_arr;
 	zval *references, *describe = NULL, *reference = NULL, *constraint_name = NULL;
 	zval *referenced_schema = NULL, *referenced_table = NULL;
 	zval *reference_array = NULL, *column_name = NULL, *referenced_columns = NULL;
@@ -1581,6 +2119,11 @@ PHP_METHOD(Phalcon_Db_Adapter, describeReferences){
 		schema = PHALCON_GLOBAL(z_null);
 	}
 	
+	PHALCON_INIT_VAR(schema_key);
+	if (phalcon_db_adapter_get_cached_schema(return_value, schema_key, this_ptr, "references", table, schema TSRMLS_CC)) {
+		RETURN_MM();
+	}
+	
 	dialect = phalcon_fetch_nproperty_this(this_ptr, SL("_dialect"), PH_NOISY TSRMLS_CC);
 	
 	/** 
@@ -1678,6 +2221,8 @@ PHP_METHOD(Phalcon_Db_Adapter, describeReferences){
 		zend_hash_move_forward_ex(ah1, &hp1);
 	}
 	
+	phalcon_db_adapter_cache_schema(this_ptr, schema_key, return_value TSRMLS_CC);
+	
 	PHALCON_MM_RESTORE();
 }
 
@@ -2004,3 +2549,276 @@ PHP_METHOD(Phalcon_Db_Adapter, getDialectType){
 
 	RETURN_MEMBER(this_ptr, "_dialectType");
 }
+
+static void phalcon_db_adapter_new_generation(zval *generation TSRMLS_DC) {
+
+	char *buffer;
+	int length;
+
+	length = spprintf(&buffer, 0, "%lx%lx", (unsigned long) time(NULL), (unsigned long) (php_combined_lcg(TSRMLS_C) * 0xFFFFFFFF));
+	ZVAL_STRINGL(generation, buffer, length, 0);
+}
+
+/**
+ * Adapters connected to the same server and database share the cached descriptions, the
+ * server is identified by the dsn or else by the host, the port and the unix socket
+ */
+static void phalcon_db_adapter_schema_identity(zval *return_value, zval *this_ptr TSRMLS_DC) {
+
+	zval *type, *descriptor, *value;
+	static const char *parts[] = { "host", "port", "unix_socket", "dbname", NULL };
+	int i;
+
+	type = phalcon_fetch_nproperty_this(this_ptr, SL("_type"), PH_NOISY TSRMLS_CC);
+	descriptor = phalcon_fetch_nproperty_this(this_ptr, SL("_descriptor"), PH_NOISY TSRMLS_CC);
+
+	ZVAL_ZVAL(return_value, type, 1, 0);
+	convert_to_string(return_value);
+
+	if (Z_TYPE_P(descriptor) != IS_ARRAY) {
+		return;
+	}
+
+	if (phalcon_array_isset_string_fetch(&value, descriptor, SS("dsn"))) {
+		PHALCON_SCONCAT_SV(return_value, "|dsn=", value);
+		return;
+	}
+
+	for (i = 0; parts[i]; ++i) {
+		phalcon_concat_self_str(&return_value, SL("|") TSRMLS_CC);
+		if (phalcon_array_isset_string_fetch(&value, descriptor, parts[i], strlen(parts[i]) + 1)) {
+			phalcon_concat_self(&return_value, value TSRMLS_CC);
+		}
+	}
+}
+
+/**
+ * Returns the generation of the cached descriptions. It is read from the cache every time,
+ * another adapter or process may have started a new one. A new generation is started if
+ * renew is set or the cache has none
+ */
+static void phalcon_db_adapter_schema_generation(zval *return_value, zval *this_ptr, zval *identity, int renew TSRMLS_DC) {
+
+	zval *cache, *lifetime, *identity_hash, *key, *cached = NULL;
+
+	PHALCON_MM_GROW();
+
+	cache = phalcon_fetch_nproperty_this(this_ptr, SL("_schemaCache"), PH_NOISY TSRMLS_CC);
+	lifetime = phalcon_fetch_nproperty_this(this_ptr, SL("_schemaCacheLifetime"), PH_NOISY TSRMLS_CC);
+
+	PHALCON_INIT_VAR(identity_hash);
+	phalcon_md5(identity_hash, identity);
+
+	PHALCON_INIT_VAR(key);
+	PHALCON_CONCAT_SV(key, "_schema_generation_", identity_hash);
+
+	if (!renew) {
+		PHALCON_CALL_METHOD(&cached, cache, "get", key, lifetime);
+	}
+
+	if (!cached || Z_TYPE_P(cached) != IS_STRING) {
+		PHALCON_INIT_NVAR(cached);
+		phalcon_db_adapter_new_generation(cached TSRMLS_CC);
+		PHALCON_CALL_METHOD(NULL, cache, "save", key, cached, lifetime);
+	}
+
+	RETURN_CTOR(cached);
+}
+
+/**
+ * Builds the cache key of a description, keys embed the current generation
+ */
+static void phalcon_db_adapter_schema_key(zval *return_value, zval *this_ptr, const char *kind, zval *table, zval *schema TSRMLS_DC) {
+
+	zval *identity, *generation, *kind_name, *description, *description_hash;
+
+	PHALCON_MM_GROW();
+
+	PHALCON_INIT_VAR(identity);
+	phalcon_db_adapter_schema_identity(identity, this_ptr TSRMLS_CC);
+
+	PHALCON_INIT_VAR(generation);
+	phalcon_db_adapter_schema_generation(generation, this_ptr, identity, 0 TSRMLS_CC);
+	if (EG(exception)) {
+		RETURN_MM();
+	}
+
+	PHALCON_INIT_VAR(kind_name);
+	ZVAL_STRING(kind_name, kind, 1);
+
+	PHALCON_INIT_VAR(description);
+	PHALCON_CONCAT_VSVSVSV(description, identity, "|", generation, "|", kind_name, "|", schema);
+	PHALCON_SCONCAT_SV(description, "|", table);
+
+	PHALCON_INIT_VAR(description_hash);
+	phalcon_md5(description_hash, description);
+
+	PHALCON_CONCAT_SVSV(return_value, "_schema_", kind_name, "_", description_hash);
+
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Reads a description (columns, indexes or references) from the schema cache. The key of the
+ * description is left in key so the caller can store the description with
+ * phalcon_db_adapter_cache_schema. Returns 1 if the description was found or an exception
+ * was thrown
+ */
+int phalcon_db_adapter_get_cached_schema(zval *return_value, zval *key, zval *adapter, const char *kind, zval *table, zval *schema TSRMLS_DC) {
+
+	zval *cache, *cached = NULL, *params[2];
+
+	cache = phalcon_fetch_nproperty_this(adapter, SL("_schemaCache"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(cache) != IS_OBJECT) {
+		return 0;
+	}
+
+	phalcon_db_adapter_schema_key(key, adapter, kind, table, schema ? schema : PHALCON_GLOBAL(z_null) TSRMLS_CC);
+	if (EG(exception)) {
+		return 1;
+	}
+
+	params[0] = key;
+	params[1] = phalcon_fetch_nproperty_this(adapter, SL("_schemaCacheLifetime"), PH_NOISY TSRMLS_CC);
+	if (phalcon_call_method(&cached, cache, "get", 2, params TSRMLS_CC) == FAILURE) {
+		return 1;
+	}
+
+	if (Z_TYPE_P(cached) == IS_ARRAY) {
+		RETVAL_ZVAL(cached, 1, 1);
+		return 1;
+	}
+
+	zval_ptr_dtor(&cached);
+	return 0;
+}
+
+/**
+ * Stores a description under the key computed by phalcon_db_adapter_get_cached_schema
+ */
+void phalcon_db_adapter_cache_schema(zval *adapter, zval *key, zval *description TSRMLS_DC) {
+
+	zval *cache, *params[3];
+
+	cache = phalcon_fetch_nproperty_this(adapter, SL("_schemaCache"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(cache) != IS_OBJECT || Z_TYPE_P(key) != IS_STRING) {
+		return;
+	}
+
+	params[0] = key;
+	params[1] = description;
+	params[2] = phalcon_fetch_nproperty_this(adapter, SL("_schemaCacheLifetime"), PH_NOISY TSRMLS_CC);
+	phalcon_call_method(NULL, cache, "save", 3, params TSRMLS_CC);
+}
+
+/**
+ * Starts a new generation, so every cached description of the connection is discarded
+ */
+int phalcon_db_adapter_invalidate_schema(zval *adapter TSRMLS_DC) {
+
+	zval *identity, *generation;
+
+	if (Z_TYPE_P(phalcon_fetch_nproperty_this(adapter, SL("_schemaCache"), PH_NOISY TSRMLS_CC)) != IS_OBJECT) {
+		return SUCCESS;
+	}
+
+	MAKE_STD_ZVAL(identity);
+	ZVAL_NULL(identity);
+	phalcon_db_adapter_schema_identity(identity, adapter TSRMLS_CC);
+
+	MAKE_STD_ZVAL(generation);
+	ZVAL_NULL(generation);
+	phalcon_db_adapter_schema_generation(generation, adapter, identity, 1 TSRMLS_CC);
+
+	zval_ptr_dtor(&generation);
+	zval_ptr_dtor(&identity);
+
+	return EG(exception) ? FAILURE : SUCCESS;
+}
+
+/**
+ * Sets a cache backend where the descriptions of the tables (columns, indexes and references)
+ * are kept between requests. Descriptions are discarded automatically when the adapter executes
+ * a DDL statement, changes made by other means require a call to clearSchemaCache()
+ *
+ *<code>
+ * $connection->setSchemaCache(new \Phalcon\Cache\Backend\Apc(new \Phalcon\Cache\Frontend\Data()), 3600);
+ *</code>
+ *
+ * @param Phalcon\Cache\BackendInterface $cache null disables the cache
+ * @param int $lifetime
+ */
+PHP_METHOD(Phalcon_Db_Adapter, setSchemaCache){
+
+	zval *cache, *lifetime = NULL;
+
+	phalcon_fetch_params(0, 1, 1, &cache, &lifetime);
+
+	if (Z_TYPE_P(cache) != IS_NULL) {
+		PHALCON_VERIFY_INTERFACE_EX(cache, phalcon_cache_backendinterface_ce, phalcon_db_exception_ce, 0);
+	}
+
+	phalcon_update_property_this(this_ptr, SL("_schemaCache"), cache TSRMLS_CC);
+
+	if (lifetime && Z_TYPE_P(lifetime) != IS_NULL) {
+		phalcon_update_property_this(this_ptr, SL("_schemaCacheLifetime"), lifetime TSRMLS_CC);
+	}
+}
+
+/**
+ * Returns the cache backend where the descriptions of the tables are kept
+ *
+ * @return Phalcon\Cache\BackendInterface
+ */
+PHP_METHOD(Phalcon_Db_Adapter, getSchemaCache){
+
+
+	RETURN_MEMBER(this_ptr, "_schemaCache");
+}
+
+/**
+ * Discards the cached descriptions of a table, or every cached description if no table is passed
+ *
+ *<code>
+ * $connection->clearSchemaCache('robots');
+ *</code>
+ *
+ * @param string $table
+ * @param string $schema
+ */
+PHP_METHOD(Phalcon_Db_Adapter, clearSchemaCache){
+
+	zval *table = NULL, *schema = NULL, *cache, *key = NULL;
+	static const char *kinds[] = { "columns", "indexes", "references", NULL };
+	int i;
+
+	phalcon_fetch_params(0, 0, 2, &table, &schema);
+
+	cache = phalcon_fetch_nproperty_this(this_ptr, SL("_schemaCache"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(cache) != IS_OBJECT) {
+		RETURN_NULL();
+	}
+
+	if (!table || Z_TYPE_P(table) == IS_NULL) {
+		phalcon_db_adapter_invalidate_schema(this_ptr TSRMLS_CC);
+		return;
+	}
+
+	if (!schema) {
+		schema = PHALCON_GLOBAL(z_null);
+	}
+
+	PHALCON_MM_GROW();
+
+	for (i = 0; kinds[i]; ++i) {
+		PHALCON_INIT_NVAR(key);
+		phalcon_db_adapter_schema_key(key, this_ptr, kinds[i], table, schema TSRMLS_CC);
+		if (EG(exception)) {
+			RETURN_MM();
+		}
+
+		PHALCON_CALL_METHOD(NULL, cache, "delete", key);
+	}
+
+	PHALCON_MM_RESTORE();
+}
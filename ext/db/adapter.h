@@ -24,6 +24,10 @@
 
 extern zend_class_entry *phalcon_db_adapter_ce;
 
+int phalcon_db_adapter_get_cached_schema(zval *return_value, zval *key, zval *adapter, const char *kind, zval *table, zval *schema TSRMLS_DC);
+void phalcon_db_adapter_cache_schema(zval *adapter, zval *key, zval *description TSRMLS_DC);
+int phalcon_db_adapter_invalidate_schema(zval *adapter TSRMLS_DC);
+
 PHALCON_INIT_CLASS(Phalcon_Db_Adapter);
 
 #endif /* PHALCON_DB_ADAPTER_H */
@@ -22,6 +22,7 @@
 #include "db/adapterinterface.h"
 #include "db/exception.h"
 #include "db/result/pdo.h"
+#include "mvc/model/manager.h"
 
 #include <ext/pdo/php_pdo_driver.h>
 
@@ -71,6 +72,9 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, commit);
 PHP_METHOD(Phalcon_Db_Adapter_Pdo, getTransactionLevel);
 PHP_METHOD(Phalcon_Db_Adapter_Pdo, isUnderTransaction);
 PHP_METHOD(Phalcon_Db_Adapter_Pdo, getInternalHandler);
+PHP_METHOD(Phalcon_Db_Adapter_Pdo, setStatementCacheSize);
+PHP_METHOD(Phalcon_Db_Adapter_Pdo, getStatementCacheStats);
+PHP_METHOD(Phalcon_Db_Adapter_Pdo, clearStatementCache);
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_adapter___construct, 0, 0, 1)
 	ZEND_ARG_INFO(0, descriptor)
@@ -86,6 +90,10 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_adapter_pdo_executeprepared, 0, 0, 3)
 	ZEND_ARG_INFO(0, dataTypes)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_adapter_pdo_setstatementcachesize, 0, 0, 1)
+	ZEND_ARG_INFO(0, size)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_adapter_pdo_begin, 0, 0, 0)
 	ZEND_ARG_INFO(0, nesting)
 ZEND_END_ARG_INFO()
@@ -117,6 +125,9 @@ static const zend_function_entry phalcon_db_adapter_pdo_method_entry[] = {
 	PHP_ME(Phalcon_Db_Adapter_Pdo, getTransactionLevel, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Adapter_Pdo, isUnderTransaction, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Adapter_Pdo, getInternalHandler, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Adapter_Pdo, setStatementCacheSize, arginfo_phalcon_db_adapter_pdo_setstatementcachesize, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Adapter_Pdo, getStatementCacheStats, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Adapter_Pdo, clearStatementCache, NULL, ZEND_ACC_PUBLIC)
 	PHP_FE_END
 };
 
@@ -130,10 +141,161 @@ PHALCON_INIT_CLASS(Phalcon_Db_Adapter_Pdo){
 	zend_declare_property_null(phalcon_db_adapter_pdo_ce, SL("_pdo"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_db_adapter_pdo_ce, SL("_affectedRows"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_long(phalcon_db_adapter_pdo_ce, SL("_transactionLevel"), 0, ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_db_adapter_pdo_ce, SL("_statementCache"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_long(phalcon_db_adapter_pdo_ce, SL("_statementCacheSize"), 0, ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_long(phalcon_db_adapter_pdo_ce, SL("_statementCacheHits"), 0, ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_long(phalcon_db_adapter_pdo_ce, SL("_statementCacheMisses"), 0, ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_db_adapter_pdo_ce, SL("_versionsManagers"), ZEND_ACC_PROTECTED TSRMLS_CC);
 
 	return SUCCESS;
 }
 
+/**
+ * Keeps a models manager whose table versions are bumped when the transaction ends
+ */
+void phalcon_db_adapter_pdo_defer_versions(zval *connection, zval *manager TSRMLS_DC)
+{
+	zval index;
+
+	INIT_ZVAL(index);
+	ZVAL_LONG(&index, Z_OBJ_HANDLE_P(manager));
+	phalcon_update_property_array(connection, SL("_versionsManagers"), &index, manager TSRMLS_CC);
+}
+
+/**
+ * Bumps the table versions deferred by the models managers while the transaction was open. A
+ * rollback bumps them too, it only costs cache misses. A failed commit drops them because the
+ * exception is still pending, closing or reconnecting drops them because the transaction is gone
+ */
+static int phalcon_db_adapter_pdo_end_versions(zval *this_ptr, int flush TSRMLS_DC)
+{
+	zval *managers, **manager;
+	HashPosition hp;
+	int status = SUCCESS;
+
+	managers = phalcon_fetch_nproperty_this(this_ptr, SL("_versionsManagers"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(managers) != IS_ARRAY) {
+		return SUCCESS;
+	}
+
+	Z_ADDREF_P(managers);
+	phalcon_update_property_null(this_ptr, SL("_versionsManagers") TSRMLS_CC);
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(managers), &hp);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(managers), (void**) &manager, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(managers), &hp)
+	) {
+		if (status == SUCCESS) {
+			status = phalcon_mvc_model_manager_end_versions(*manager, this_ptr, flush TSRMLS_CC);
+		} else {
+			phalcon_mvc_model_manager_end_versions(*manager, this_ptr, 0 TSRMLS_CC);
+		}
+	}
+
+	zval_ptr_dtor(&managers);
+	return status;
+}
+
+/**
+ * Checks if a SQL statement changes the schema, invalidating the statements prepared before it
+ */
+static int phalcon_db_adapter_pdo_is_ddl(zval *sql_statement)
+{
+	static const char *keywords[] = { "CREATE", "ALTER", "DROP", "RENAME", "TRUNCATE", NULL };
+	const char *sql;
+	size_t length, keyword_length;
+	int i;
+
+	if (Z_TYPE_P(sql_statement) != IS_STRING) {
+		return 0;
+	}
+
+	sql    = Z_STRVAL_P(sql_statement);
+	length = Z_STRLEN_P(sql_statement);
+
+	/**
+	 * Whitespace and comments could precede the first keyword
+	 */
+	while (length) {
+		if (isspace((unsigned char)*sql)) {
+			++sql;
+			--length;
+		} else if (*sql == '#' || (length >= 2 && sql[0] == '-' && sql[1] == '-')) {
+			while (length && *sql != '\n') {
+				++sql;
+				--length;
+			}
+		} else if (length >= 2 && sql[0] == '/' && sql[1] == '*') {
+			sql    += 2;
+			length -= 2;
+			while (length && !(length >= 2 && sql[0] == '*' && sql[1] == '/')) {
+				++sql;
+				--length;
+			}
+
+			if (!length) {
+				return 0;
+			}
+
+			sql    += 2;
+			length -= 2;
+		} else {
+			break;
+		}
+	}
+
+	for (i = 0; keywords[i]; ++i) {
+		keyword_length = strlen(keywords[i]);
+		if (length >= keyword_length && !strncasecmp(sql, keywords[i], keyword_length)) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Discards the prepared statements and the cached descriptions of the tables after a
+ * statement changing the schema
+ */
+static int phalcon_db_adapter_pdo_schema_changed(zval *this_ptr, zval *sql_statement TSRMLS_DC)
+{
+	if (!phalcon_db_adapter_pdo_is_ddl(sql_statement)) {
+		return SUCCESS;
+	}
+
+	phalcon_update_property_null(this_ptr, SL("_statementCache") TSRMLS_CC);
+	return phalcon_db_adapter_invalidate_schema(this_ptr TSRMLS_CC);
+}
+
+/**
+ * Removes the least recently used statements until the cache fits in its size
+ */
+static void phalcon_db_adapter_pdo_evict_statements(zval *this_ptr, long size TSRMLS_DC)
+{
+	zval *cache;
+	HashTable *ht;
+	char *key;
+	uint key_length;
+	ulong index;
+
+	cache = phalcon_fetch_nproperty_this(this_ptr, SL("_statementCache"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(cache) != IS_ARRAY || Z_REFCOUNT_P(cache) > 1) {
+		return;
+	}
+
+	ht = Z_ARRVAL_P(cache);
+	while (zend_hash_num_elements(ht) > (uint)(size > 0 ? size : 0)) {
+		zend_hash_internal_pointer_reset(ht);
+		if (zend_hash_get_current_key_ex(ht, &key, &key_length, &index, 0, NULL) == HASH_KEY_IS_STRING) {
+			zend_hash_del(ht, key, key_length);
+		} else {
+			zend_hash_index_del(ht, index);
+		}
+	}
+}
+
 /**
  * Constructor for Phalcon\Db\Adapter\Pdo
  *
@@ -181,7 +343,7 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, connect){
 
 	zval *descriptor = NULL, *username = NULL, *password = NULL, *dsn_parts;
 	zval *value = NULL, *key = NULL, *dsn_attribute = NULL, *dsn_attributes = NULL;
-	zval *pdo_type, *dsn, *options = NULL, *persistent, *pdo;
+	zval *pdo_type, *dsn, *options = NULL, *persistent, *pdo, *statement_cache_size;
 	zend_class_entry *ce;
 	HashTable *ah0;
 	HashPosition hp0;
@@ -226,6 +388,25 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, connect){
 		PHALCON_INIT_NVAR(password);
 	}
 
+	/**
+	 * Prepared statements and open transactions belong to the previous connection
+	 */
+	phalcon_update_property_null(this_ptr, SL("_statementCache") TSRMLS_CC);
+	phalcon_update_property_long(this_ptr, SL("_transactionLevel"), 0 TSRMLS_CC);
+	if (phalcon_db_adapter_pdo_end_versions(this_ptr, 0 TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+
+	/**
+	 * Number of prepared statements cached by this connection
+	 */
+	if (phalcon_array_isset_string(descriptor, SS("statementCacheSize"))) {
+		PHALCON_OBS_VAR(statement_cache_size);
+		phalcon_array_fetch_string(&statement_cache_size, descriptor, SL("statementCacheSize"), PH_NOISY);
+		phalcon_update_property_long(this_ptr, SL("_statementCacheSize"), phalcon_get_intval(statement_cache_size) TSRMLS_CC);
+		phalcon_array_unset_string(&descriptor, SS("statementCacheSize"), PH_SEPARATE);
+	}
+
 	/**
 	 * Check if the developer has defined custom options or create one from scratch
 	 */
@@ -308,7 +489,9 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, connect){
 }
 
 /**
- * Returns a PDO prepared statement to be executed with 'executePrepared'
+ * Returns a PDO prepared statement to be executed with 'executePrepared'.
+ * When the statement cache is enabled, a statement prepared before for the same SQL
+ * is reused if no result is still reading from it
  *
  *<code>
  * $statement = $connection->prepare('SELECT * FROM robots WHERE name = :name');
@@ -320,15 +503,69 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, connect){
  */
 PHP_METHOD(Phalcon_Db_Adapter_Pdo, prepare){
 
-	zval *sql_statement, *pdo;
+	zval *sql_statement, *pdo, *size, *cache, **cached, *cached_statement, *statement = NULL, *fetch_mode;
+	pdo_stmt_t *stmt;
+	HashTable *ht;
 
 	PHALCON_MM_GROW();
 
 	phalcon_fetch_params(1, 1, 0, &sql_statement);
 	
-	pdo = phalcon_fetch_nproperty_this(this_ptr, SL("_pdo"), PH_NOISY TSRMLS_CC);
-	PHALCON_RETURN_CALL_METHOD(pdo, "prepare", sql_statement);
-	RETURN_MM();
+	pdo  = phalcon_fetch_nproperty_this(this_ptr, SL("_pdo"), PH_NOISY TSRMLS_CC);
+	size = phalcon_fetch_nproperty_this(this_ptr, SL("_statementCacheSize"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(sql_statement) != IS_STRING || phalcon_get_intval(size) <= 0) {
+		PHALCON_RETURN_CALL_METHOD(pdo, "prepare", sql_statement);
+		RETURN_MM();
+	}
+
+	cache = phalcon_fetch_nproperty_this(this_ptr, SL("_statementCache"), PH_NOISY TSRMLS_CC);
+	if (
+		   Z_TYPE_P(cache) == IS_ARRAY
+		&& Z_REFCOUNT_P(cache) == 1
+		&& zend_symtable_find(Z_ARRVAL_P(cache), Z_STRVAL_P(sql_statement), Z_STRLEN_P(sql_statement) + 1, (void**)&cached) == SUCCESS
+		&& Z_TYPE_PP(cached) == IS_OBJECT
+		&& Z_REFCOUNT_PP(cached) == 1
+		&& zend_objects_store_get_refcount(*cached TSRMLS_CC) == 1
+	) {
+		cached_statement = *cached;
+
+		/** 
+		 * Move the statement to the most recently used position
+		 */
+		ht = Z_ARRVAL_P(cache);
+		Z_ADDREF_P(cached_statement);
+		zend_symtable_del(ht, Z_STRVAL_P(sql_statement), Z_STRLEN_P(sql_statement) + 1);
+		zend_symtable_update(ht, Z_STRVAL_P(sql_statement), Z_STRLEN_P(sql_statement) + 1, &cached_statement, sizeof(zval*), NULL);
+
+		PHALCON_INIT_VAR(statement);
+		ZVAL_ZVAL(statement, cached_statement, 1, 0);
+
+		phalcon_property_incr(this_ptr, SL("_statementCacheHits") TSRMLS_CC);
+
+		/** 
+		 * Discard the rows left by the last execution and restore the connection's fetch mode
+		 */
+		stmt = (pdo_stmt_t*)zend_object_store_get_object(statement TSRMLS_CC);
+
+		PHALCON_INIT_VAR(fetch_mode);
+		ZVAL_LONG(fetch_mode, stmt->dbh->default_fetch_type);
+
+		PHALCON_CALL_METHOD(NULL, statement, "closecursor");
+		PHALCON_CALL_METHOD(NULL, statement, "setfetchmode", fetch_mode);
+
+		RETURN_CTOR(statement);
+	}
+
+	PHALCON_CALL_METHOD(&statement, pdo, "prepare", sql_statement);
+	phalcon_property_incr(this_ptr, SL("_statementCacheMisses") TSRMLS_CC);
+
+	if (Z_TYPE_P(statement) == IS_OBJECT) {
+		phalcon_unset_property_array(this_ptr, SL("_statementCache"), sql_statement TSRMLS_CC);
+		phalcon_update_property_array(this_ptr, SL("_statementCache"), sql_statement, statement TSRMLS_CC);
+		phalcon_db_adapter_pdo_evict_statements(this_ptr, phalcon_get_intval(size) TSRMLS_CC);
+	}
+
+	RETURN_CTOR(statement);
 }
 
 /**
@@ -495,7 +732,7 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, query){
 	pdo = phalcon_fetch_nproperty_this(this_ptr, SL("_pdo"), PH_NOISY TSRMLS_CC);
 	if (Z_TYPE_P(bind_params) == IS_ARRAY) { 
 	
-		PHALCON_CALL_METHOD(&statement, pdo, "prepare", sql_statement);
+		PHALCON_CALL_METHOD(&statement, this_ptr, "prepare", sql_statement);
 		if (Z_TYPE_P(statement) == IS_OBJECT) {
 			PHALCON_CALL_METHOD(&new_statement, this_ptr, "executeprepared", statement, bind_params, bind_types);
 			PHALCON_CPY_WRT(statement, new_statement);
@@ -508,6 +745,10 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, query){
 	 * Execute the afterQuery event if a EventsManager is available
 	 */
 	if (likely(Z_TYPE_P(statement) == IS_OBJECT)) {
+		if (phalcon_db_adapter_pdo_schema_changed(this_ptr, sql_statement TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+	
 		if (Z_TYPE_P(events_manager) == IS_OBJECT) {
 			PHALCON_INIT_NVAR(event_name);
 			ZVAL_STRING(event_name, "db:afterQuery", 1);
@@ -576,7 +817,7 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, execute){
 	
 	pdo = phalcon_fetch_nproperty_this(this_ptr, SL("_pdo"), PH_NOISY TSRMLS_CC);
 	if (Z_TYPE_P(bind_params) == IS_ARRAY) { 
-		PHALCON_CALL_METHOD(&statement, pdo, "prepare", sql_statement);
+		PHALCON_CALL_METHOD(&statement, this_ptr, "prepare", sql_statement);
 		if (Z_TYPE_P(statement) == IS_OBJECT) {
 			PHALCON_CALL_METHOD(&new_statement, this_ptr, "executeprepared", statement, bind_params, bind_types);
 			PHALCON_CALL_METHOD(&affected_rows, new_statement, "rowcount");
@@ -589,6 +830,14 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, execute){
 		PHALCON_CALL_METHOD(&affected_rows, pdo, "exec", sql_statement);
 	}
 	
+	/** 
+	 * Statements prepared before a schema change could refer to dropped or altered objects,
+	 * the cached descriptions of the tables are discarded too
+	 */
+	if (phalcon_db_adapter_pdo_schema_changed(this_ptr, sql_statement TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+	
 	/** 
 	 * Execute the afterQuery event if a EventsManager is available
 	 */
@@ -632,7 +881,17 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, close){
 
 	pdo = phalcon_fetch_nproperty_this(this_ptr, SL("_pdo"), PH_NOISY TSRMLS_CC);
 	if (likely(Z_TYPE_P(pdo) == IS_OBJECT)) {
+		phalcon_update_property_null(this_ptr, SL("_statementCache") TSRMLS_CC);
 		phalcon_update_property_this(this_ptr, SL("_pdo"), PHALCON_GLOBAL(z_null) TSRMLS_CC);
+
+		/**
+		 * An open transaction is rolled back by the server, its deferred versions are dropped
+		 */
+		phalcon_update_property_long(this_ptr, SL("_transactionLevel"), 0 TSRMLS_CC);
+		if (phalcon_db_adapter_pdo_end_versions(this_ptr, 0 TSRMLS_CC) == FAILURE) {
+			return;
+		}
+
 		RETURN_TRUE;
 	}
 	
@@ -955,7 +1214,12 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, rollback){
 		 * Reduce the transaction nesting level
 		 */
 		phalcon_property_decr(this_ptr, SL("_transactionLevel") TSRMLS_CC);
-		PHALCON_RETURN_CALL_METHOD(pdo, "rollback");
+		if (phalcon_return_call_method(return_value, return_value_ptr, pdo, "rollback", 0, NULL TSRMLS_CC) == FAILURE) {
+			phalcon_db_adapter_pdo_end_versions(this_ptr, 0 TSRMLS_CC);
+			RETURN_MM();
+		}
+	
+		phalcon_db_adapter_pdo_end_versions(this_ptr, 1 TSRMLS_CC);
 		RETURN_MM();
 	}
 
@@ -1046,7 +1310,15 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, commit){
 		 * Reduce the transaction nesting level
 		 */
 		phalcon_property_decr(this_ptr, SL("_transactionLevel") TSRMLS_CC);
-		PHALCON_RETURN_CALL_METHOD(pdo, "commit");
+		if (phalcon_return_call_method(return_value, return_value_ptr, pdo, "commit", 0, NULL TSRMLS_CC) == FAILURE) {
+			phalcon_db_adapter_pdo_end_versions(this_ptr, 0 TSRMLS_CC);
+			RETURN_MM();
+		}
+	
+		/** 
+		 * The cached queries reading the written tables are invalidated once the rows are visible
+		 */
+		phalcon_db_adapter_pdo_end_versions(this_ptr, 1 TSRMLS_CC);
 		RETURN_MM();
 	}
 
@@ -1139,3 +1411,65 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo, getInternalHandler){
 	pdo = phalcon_fetch_nproperty_this(this_ptr, SL("_pdo"), PH_NOISY TSRMLS_CC);
 	RETURN_ZVAL(pdo, 1, 0);
 }
+
+/**
+ * Sets the number of prepared statements cached by the connection, 0 disables the cache.
+ * It can also be set with the 'statementCacheSize' option of the descriptor
+ *
+ *<code>
+ *	$connection->setStatementCacheSize(64);
+ *</code>
+ *
+ * @param int $size
+ * @return Phalcon\Db\Adapter\Pdo
+ */
+PHP_METHOD(Phalcon_Db_Adapter_Pdo, setStatementCacheSize){
+
+	zval **size;
+	long capacity;
+
+	phalcon_fetch_params_ex(1, 0, &size);
+
+	capacity = phalcon_get_intval(*size);
+	if (capacity < 0) {
+		capacity = 0;
+	}
+
+	phalcon_update_property_long(this_ptr, SL("_statementCacheSize"), capacity TSRMLS_CC);
+	phalcon_db_adapter_pdo_evict_statements(this_ptr, capacity TSRMLS_CC);
+
+	RETURN_THISW();
+}
+
+/**
+ * Returns the size, number of cached statements, hits and misses of the statement cache
+ *
+ *<code>
+ *	print_r($connection->getStatementCacheStats());
+ *</code>
+ *
+ * @return array
+ */
+PHP_METHOD(Phalcon_Db_Adapter_Pdo, getStatementCacheStats){
+
+	zval *cache, *size, *hits, *misses;
+
+	cache  = phalcon_fetch_nproperty_this(this_ptr, SL("_statementCache"), PH_NOISY TSRMLS_CC);
+	size   = phalcon_fetch_nproperty_this(this_ptr, SL("_statementCacheSize"), PH_NOISY TSRMLS_CC);
+	hits   = phalcon_fetch_nproperty_this(this_ptr, SL("_statementCacheHits"), PH_NOISY TSRMLS_CC);
+	misses = phalcon_fetch_nproperty_this(this_ptr, SL("_statementCacheMisses"), PH_NOISY TSRMLS_CC);
+
+	array_init_size(return_value, 4);
+	add_assoc_long_ex(return_value, SS("size"), phalcon_get_intval(size));
+	add_assoc_long_ex(return_value, SS("statements"), Z_TYPE_P(cache) == IS_ARRAY ? zend_hash_num_elements(Z_ARRVAL_P(cache)) : 0);
+	add_assoc_long_ex(return_value, SS("hits"), phalcon_get_intval(hits));
+	add_assoc_long_ex(return_value, SS("misses"), phalcon_get_intval(misses));
+}
+
+/**
+ * Discards the prepared statements cached by the connection
+ */
+PHP_METHOD(Phalcon_Db_Adapter_Pdo, clearStatementCache){
+
+	phalcon_update_property_null(this_ptr, SL("_statementCache") TSRMLS_CC);
+}
@@ -24,6 +24,8 @@
 
 extern zend_class_entry *phalcon_db_adapter_pdo_ce;
 
+void phalcon_db_adapter_pdo_defer_versions(zval *connection, zval *manager TSRMLS_DC);
+
 PHALCON_INIT_CLASS(Phalcon_Db_Adapter_Pdo);
 
 #endif /* PHALCON_DB_ADAPTER_PDO_H */
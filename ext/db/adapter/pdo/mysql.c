@@ -17,6 +17,7 @@
 */
 
 #include "db/adapter/pdo/mysql.h"
+#include "db/adapter.h"
 #include "db/adapter/pdo.h"
 #include "db/adapterinterface.h"
 #include "db/column.h"
@@ -128,7 +129,7 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Mysql, escapeIdentifier){
  */
 PHP_METHOD(Phalcon_Db_Adapter_Pdo_Mysql, describeColumns){
 
-	zval *table, *schema = NULL, *dialect, *sql = NULL, *fetch_num;
+	zval *table, *schema = NULL, *schema_key, *dialect, *sql = NULL, *fetch_num;
 	zval *describe = NULL, *old_column = NULL, *size_pattern, *columns;
 	zval *field = NULL, *definition = NULL, *column_type = NULL, *matches = NULL;
 	zval *pos = NULL, *match_one = NULL, *match_two = NULL, *attribute = NULL, *column_name = NULL;
@@ -145,6 +146,11 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Mysql, describeColumns){
 		schema = PHALCON_GLOBAL(z_null);
 	}
 	
+	PHALCON_INIT_VAR(schema_key);
+	if (phalcon_db_adapter_get_cached_schema(return_value, schema_key, this_ptr, "columns", table, schema TSRMLS_CC)) {
+		RETURN_MM();
+	}
+	
 	PHALCON_OBS_VAR(dialect);
 	phalcon_read_property_this(&dialect, this_ptr, SL("_dialect"), PH_NOISY TSRMLS_CC);
 	
@@ -404,5 +410,7 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Mysql, describeColumns){
 		zend_hash_move_forward_ex(ah0, &hp0);
 	}
 	
+	phalcon_db_adapter_cache_schema(this_ptr, schema_key, columns TSRMLS_CC);
+	
 	RETURN_CTOR(columns);
 }
@@ -19,6 +19,7 @@
 */
 
 #include "db/adapter/pdo/oracle.h"
+#include "db/adapter.h"
 #include "db/adapter/pdo.h"
 #include "db/adapterinterface.h"
 #include "db/column.h"
@@ -159,7 +160,7 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Oracle, connect){
  */
 PHP_METHOD(Phalcon_Db_Adapter_Pdo_Oracle, describeColumns){
 
-	zval *table, *schema = NULL, *columns, *dialect, *sql = NULL, *fetch_num;
+	zval *table, *schema = NULL, *schema_key, *columns, *dialect, *sql = NULL, *fetch_num;
 	zval *describe = NULL, *old_column = NULL, *field = NULL, *definition = NULL;
 	zval *column_size = NULL, *column_precision = NULL, *column_scale = NULL;
 	zval *column_type = NULL, *attribute = NULL, *column_name = NULL;
@@ -176,6 +177,11 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Oracle, describeColumns){
 		schema = PHALCON_GLOBAL(z_null);
 	}
 	
+	PHALCON_INIT_VAR(schema_key);
+	if (phalcon_db_adapter_get_cached_schema(return_value, schema_key, this_ptr, "columns", table, schema TSRMLS_CC)) {
+		RETURN_MM();
+	}
+	
 	PHALCON_INIT_VAR(columns);
 	array_init(columns);
 	
@@ -373,6 +379,8 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Oracle, describeColumns){
 		zend_hash_move_forward_ex(ah0, &hp0);
 	}
 	
+	phalcon_db_adapter_cache_schema(this_ptr, schema_key, columns TSRMLS_CC);
+	
 	RETURN_CTOR(columns);
 }
 
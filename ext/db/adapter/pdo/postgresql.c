@@ -19,6 +19,7 @@
 */
 
 #include "db/adapter/pdo/postgresql.h"
+#include "db/adapter.h"
 #include "db/adapter/pdo.h"
 #include "db/adapterinterface.h"
 #include "db/column.h"
@@ -161,7 +162,7 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Postgresql, connect){
  */
 PHP_METHOD(Phalcon_Db_Adapter_Pdo_Postgresql, describeColumns){
 
-	zval *table, *schema = NULL, *columns, *dialect, *sql = NULL, *fetch_num;
+	zval *table, *schema = NULL, *schema_key, *columns, *dialect, *sql = NULL, *fetch_num;
 	zval *describe = NULL, *old_column = NULL, *field = NULL, *definition = NULL;
 	zval *char_size = NULL, *numeric_size = NULL, *numeric_scale = NULL, *column_type = NULL;
 	zval *attribute = NULL, *column_name = NULL, *column = NULL;
@@ -177,6 +178,11 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Postgresql, describeColumns){
 		schema = PHALCON_GLOBAL(z_null);
 	}
 	
+	PHALCON_INIT_VAR(schema_key);
+	if (phalcon_db_adapter_get_cached_schema(return_value, schema_key, this_ptr, "columns", table, schema TSRMLS_CC)) {
+		RETURN_MM();
+	}
+	
 	PHALCON_INIT_VAR(columns);
 	array_init(columns);
 	
@@ -391,6 +397,8 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Postgresql, describeColumns){
 		zend_hash_move_forward_ex(ah0, &hp0);
 	}
 	
+	phalcon_db_adapter_cache_schema(this_ptr, schema_key, columns TSRMLS_CC);
+	
 	RETURN_CTOR(columns);
 }
 
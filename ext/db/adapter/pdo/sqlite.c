@@ -19,6 +19,7 @@
 */
 
 #include "db/adapter/pdo/sqlite.h"
+#include "db/adapter.h"
 #include "db/adapter/pdo.h"
 #include "db/adapterinterface.h"
 #include "db/column.h"
@@ -137,7 +138,7 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Sqlite, connect){
  */
 PHP_METHOD(Phalcon_Db_Adapter_Pdo_Sqlite, describeColumns){
 
-	zval *table, *schema = NULL, *columns, *dialect, *size_pattern;
+	zval *table, *schema = NULL, *schema_key, *columns, *dialect, *size_pattern;
 	zval *sql = NULL, *fetch_num, *describe = NULL, *old_column = NULL, *field = NULL;
 	zval *definition = NULL, *column_type = NULL, *pos = NULL, *attribute = NULL;
 	zval *matches = NULL, *match_one = NULL, *match_two = NULL, *column_name = NULL, *column = NULL;
@@ -153,6 +154,11 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Sqlite, describeColumns){
 		schema = PHALCON_GLOBAL(z_null);
 	}
 	
+	PHALCON_INIT_VAR(schema_key);
+	if (phalcon_db_adapter_get_cached_schema(return_value, schema_key, this_ptr, "columns", table, schema TSRMLS_CC)) {
+		RETURN_MM();
+	}
+	
 	PHALCON_INIT_VAR(columns);
 	array_init(columns);
 	
@@ -373,6 +379,8 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Sqlite, describeColumns){
 		zend_hash_move_forward_ex(ah0, &hp0);
 	}
 	
+	phalcon_db_adapter_cache_schema(this_ptr, schema_key, columns TSRMLS_CC);
+	
 	RETURN_CTOR(columns);
 }
 
@@ -385,7 +393,7 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Sqlite, describeColumns){
  */
 PHP_METHOD(Phalcon_Db_Adapter_Pdo_Sqlite, describeIndexes){
 
-	zval *table, *schema = NULL, *dialect, *fetch_num, *sql = NULL, *describe = NULL;
+	zval *table, *schema = NULL, *schema_key, *dialect, *fetch_num, *sql = NULL, *describe = NULL;
 	zval *indexes, *index = NULL, *key_name = NULL, *sql_index_describe = NULL;
 	zval *describe_index = NULL, *index_column = NULL, *column_name = NULL;
 	zval *index_objects, *index_columns = NULL, *name = NULL;
@@ -401,6 +409,11 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Sqlite, describeIndexes){
 		schema = PHALCON_GLOBAL(z_null);
 	}
 	
+	PHALCON_INIT_VAR(schema_key);
+	if (phalcon_db_adapter_get_cached_schema(return_value, schema_key, this_ptr, "indexes", table, schema TSRMLS_CC)) {
+		RETURN_MM();
+	}
+	
 	PHALCON_OBS_VAR(dialect);
 	phalcon_read_property_this(&dialect, this_ptr, SL("_dialect"), PH_NOISY TSRMLS_CC);
 	
@@ -466,6 +479,8 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Sqlite, describeIndexes){
 		zend_hash_move_forward_ex(ah2, &hp2);
 	}
 	
+	phalcon_db_adapter_cache_schema(this_ptr, schema_key, index_objects TSRMLS_CC);
+	
 	RETURN_CTOR(index_objects);
 }
 
@@ -478,7 +493,7 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Sqlite, describeIndexes){
  */
 PHP_METHOD(Phalcon_Db_Adapter_Pdo_Sqlite, describeReferences){
 
-	zval *table, *schema = NULL, *dialect, *sql = NULL, *fetch_num, *describe = NULL;
+	zval *table, *schema = NULL, *schema_key, *dialect, *sql = NULL, *fetch_num, *describe = NULL;
 	zval *reference_objects, *reference_describe = NULL;
 	zval *number = NULL, *constraint_name = NULL, *referenced_table = NULL;
 	zval *from = NULL, *to = NULL, *columns = NULL, *referenced_columns = NULL;
@@ -495,6 +510,11 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Sqlite, describeReferences){
 		schema = PHALCON_GLOBAL(z_null);
 	}
 	
+	PHALCON_INIT_VAR(schema_key);
+	if (phalcon_db_adapter_get_cached_schema(return_value, schema_key, this_ptr, "references", table, schema TSRMLS_CC)) {
+		RETURN_MM();
+	}
+	
 	PHALCON_OBS_VAR(dialect);
 	phalcon_read_property_this(&dialect, this_ptr, SL("_dialect"), PH_NOISY TSRMLS_CC);
 	
@@ -566,6 +586,8 @@ PHP_METHOD(Phalcon_Db_Adapter_Pdo_Sqlite, describeReferences){
 		zend_hash_move_forward_ex(ah0, &hp0);
 	}
 	
+	phalcon_db_adapter_cache_schema(this_ptr, schema_key, reference_objects TSRMLS_CC);
+	
 	RETURN_CTOR(reference_objects);
 }
 
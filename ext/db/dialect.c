@@ -30,6 +30,7 @@
 #include "kernel/array.h"
 #include "kernel/string.h"
 #include "kernel/exception.h"
+#include "kernel/framework/orm.h"
 
 /**
  * Phalcon\Db\Dialect
@@ -46,6 +47,11 @@ PHP_METHOD(Phalcon_Db_Dialect, getColumnList);
 PHP_METHOD(Phalcon_Db_Dialect, getSqlExpression);
 PHP_METHOD(Phalcon_Db_Dialect, getSqlTable);
 PHP_METHOD(Phalcon_Db_Dialect, select);
+PHP_METHOD(Phalcon_Db_Dialect, insertMultiple);
+PHP_METHOD(Phalcon_Db_Dialect, upsert);
+PHP_METHOD(Phalcon_Db_Dialect, existsMultiple);
+PHP_METHOD(Phalcon_Db_Dialect, getMaxBindParams);
+PHP_METHOD(Phalcon_Db_Dialect, getMaxListParams);
 PHP_METHOD(Phalcon_Db_Dialect, supportsSavepoints);
 PHP_METHOD(Phalcon_Db_Dialect, supportsReleaseSavepoints);
 PHP_METHOD(Phalcon_Db_Dialect, createSavepoint);
@@ -62,6 +68,24 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_dialect_getsqltable, 0, 0, 1)
 	ZEND_ARG_INFO(0, escapeChar)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_dialect_insertmultiple, 0, 0, 3)
+	ZEND_ARG_INFO(0, table)
+	ZEND_ARG_INFO(0, fields)
+	ZEND_ARG_INFO(0, rows)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_dialect_upsert, 0, 0, 4)
+	ZEND_ARG_INFO(0, table)
+	ZEND_ARG_INFO(0, fields)
+	ZEND_ARG_INFO(0, values)
+	ZEND_ARG_INFO(0, keys)
+	ZEND_ARG_INFO(0, updateFields)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_dialect_existsmultiple, 0, 0, 1)
+	ZEND_ARG_INFO(0, queries)
+ZEND_END_ARG_INFO()
+
 static const zend_function_entry phalcon_db_dialect_method_entry[] = {
 	PHP_ME(Phalcon_Db_Dialect, limit, arginfo_phalcon_db_dialectinterface_limit, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect, forUpdate, arginfo_phalcon_db_dialectinterface_forupdate, ZEND_ACC_PUBLIC)
@@ -70,6 +94,11 @@ static const zend_function_entry phalcon_db_dialect_method_entry[] = {
 	PHP_ME(Phalcon_Db_Dialect, getSqlExpression, arginfo_phalcon_db_dialect_getsqlexpression, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect, getSqlTable, arginfo_phalcon_db_dialect_getsqltable, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect, select, arginfo_phalcon_db_dialectinterface_select, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Dialect, insertMultiple, arginfo_phalcon_db_dialect_insertmultiple, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Dialect, upsert, arginfo_phalcon_db_dialect_upsert, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Dialect, existsMultiple, arginfo_phalcon_db_dialect_existsmultiple, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Dialect, getMaxBindParams, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Dialect, getMaxListParams, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect, supportsSavepoints, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect, supportsReleaseSavepoints, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect, createSavepoint, arginfo_phalcon_db_dialectinterface_createsavepoint, ZEND_ACC_PUBLIC)
@@ -86,6 +115,8 @@ PHALCON_INIT_CLASS(Phalcon_Db_Dialect){
 	PHALCON_REGISTER_CLASS(Phalcon\\Db, Dialect, db_dialect, phalcon_db_dialect_method_entry, ZEND_ACC_EXPLICIT_ABSTRACT_CLASS);
 
 	zend_declare_property_null(phalcon_db_dialect_ce, SL("_escapeChar"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_long(phalcon_db_dialect_ce, SL("_maxBindParams"), 999, ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_db_dialect_ce, SL("_maxListParams"), ZEND_ACC_PROTECTED TSRMLS_CC);
 
 	zend_class_implements(phalcon_db_dialect_ce TSRMLS_CC, 1, phalcon_db_dialectinterface_ce);
 
@@ -610,7 +641,7 @@ PHP_METHOD(Phalcon_Db_Dialect, select){
 	zval *order_expression = NULL, *order_sql_item = NULL, *sql_order_type = NULL;
 	zval *order_sql_item_type = NULL, *order_sql, *tmp1 = NULL, *tmp2 = NULL;
 	zval *limit_value;
-	zval *number, *offset;
+	zval *number, *offset, *sql_key;
 	HashTable *ah0, *ah1, *ah2, *ah3, *ah4, *ah5;
 	HashPosition hp0, hp1, hp2, hp3, hp4, hp5;
 	zval **hd;
@@ -633,6 +664,14 @@ PHP_METHOD(Phalcon_Db_Dialect, select){
 		return;
 	}
 	
+	/** 
+	 * The same definition always produces the same SQL
+	 */
+	PHALCON_INIT_VAR(sql_key);
+	if (phalcon_orm_get_cached_sql(return_value, sql_key, this_ptr, definition TSRMLS_CC)) {
+		RETURN_MM();
+	}
+	
 	if (PHALCON_GLOBAL(db).escape_identifiers) {
 		PHALCON_OBS_VAR(escape_char);
 		phalcon_read_property_this(&escape_char, this_ptr, SL("_escapeChar"), PH_NOISY TSRMLS_CC);
@@ -942,9 +981,231 @@ PHP_METHOD(Phalcon_Db_Dialect, select){
 		}
 	}
 	
+	phalcon_orm_set_cached_sql(sql_key, sql TSRMLS_CC);
+	
+	RETURN_CTOR(sql);
+}
+
+/**
+ * Builds a multi-row INSERT statement. The table and the fields must be already escaped,
+ * every row is a list of placeholders or literal values
+ *
+ *<code>
+ * $sql = $dialect->insertMultiple('robots', array('name', 'year'), array(array('?', '?'), array('?', 'null')));
+ * echo $sql; // INSERT INTO robots (name, year) VALUES (?, ?), (?, null)
+ *</code>
+ *
+ * @param string $table
+ * @param array $fields
+ * @param array $rows
+ * @return string
+ */
+PHP_METHOD(Phalcon_Db_Dialect, insertMultiple){
+
+	zval *table, *fields, *rows, *row = NULL, *joined_row = NULL;
+	zval *joined_fields, *sql;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+	int first = 1;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 3, 0, &table, &fields, &rows);
+	
+	if (Z_TYPE_P(rows) != IS_ARRAY || !zend_hash_num_elements(Z_ARRVAL_P(rows))) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "At least one row is required to build a multi-row INSERT");
+		return;
+	}
+	
+	PHALCON_INIT_VAR(sql);
+	if (Z_TYPE_P(fields) == IS_ARRAY) {
+		PHALCON_INIT_VAR(joined_fields);
+		phalcon_fast_join_str(joined_fields, SL(", "), fields TSRMLS_CC);
+		PHALCON_CONCAT_SVSVS(sql, "INSERT INTO ", table, " (", joined_fields, ") VALUES ");
+	} else {
+		PHALCON_CONCAT_SVS(sql, "INSERT INTO ", table, " VALUES ");
+	}
+	
+	phalcon_is_iterable(rows, &ah0, &hp0, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(row);
+	
+		PHALCON_INIT_NVAR(joined_row);
+		phalcon_fast_join_str(joined_row, SL(", "), row TSRMLS_CC);
+		if (first) {
+			PHALCON_SCONCAT_SVS(sql, "(", joined_row, ")");
+			first = 0;
+		} else {
+			PHALCON_SCONCAT_SVS(sql, ", (", joined_row, ")");
+		}
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+	
 	RETURN_CTOR(sql);
 }
 
+/**
+ * Builds an INSERT statement that updates the existing row when the keys are already taken.
+ * The table, the fields and the keys must be already escaped, the values are placeholders or literal values.
+ * The standard ON CONFLICT clause (PostgreSQL, SQLite) is generated by default
+ *
+ *<code>
+ * $sql = $dialect->upsert('robots', array('id', 'name'), array('?', '?'), array('id'));
+ * echo $sql; // INSERT INTO robots (id, name) VALUES (?, ?) ON CONFLICT (id) DO UPDATE SET name = EXCLUDED.name
+ *</code>
+ *
+ * @param string $table
+ * @param array $fields
+ * @param array $values
+ * @param array $keys
+ * @param array $updateFields
+ * @return string
+ */
+PHP_METHOD(Phalcon_Db_Dialect, upsert){
+
+	zval *table, *fields, *values, *keys, *update_fields = NULL;
+	zval *joined_fields, *joined_values, *joined_keys, *field = NULL, *sql;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+	int first = 1;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 4, 1, &table, &fields, &values, &keys, &update_fields);
+	
+	if (Z_TYPE_P(fields) != IS_ARRAY || Z_TYPE_P(values) != IS_ARRAY || Z_TYPE_P(keys) != IS_ARRAY || !zend_hash_num_elements(Z_ARRVAL_P(keys))) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "Fields, values and at least one key are required to build an UPSERT");
+		return;
+	}
+	
+	if (!update_fields) {
+		update_fields = PHALCON_GLOBAL(z_null);
+	}
+	
+	PHALCON_INIT_VAR(joined_fields);
+	phalcon_fast_join_str(joined_fields, SL(", "), fields TSRMLS_CC);
+	
+	PHALCON_INIT_VAR(joined_values);
+	phalcon_fast_join_str(joined_values, SL(", "), values TSRMLS_CC);
+	
+	PHALCON_INIT_VAR(joined_keys);
+	phalcon_fast_join_str(joined_keys, SL(", "), keys TSRMLS_CC);
+	
+	PHALCON_INIT_VAR(sql);
+	PHALCON_CONCAT_SVSVSVS(sql, "INSERT INTO ", table, " (", joined_fields, ") VALUES (", joined_values, ")");
+	PHALCON_SCONCAT_SVS(sql, " ON CONFLICT (", joined_keys, ")");
+	
+	if (Z_TYPE_P(update_fields) != IS_ARRAY || !zend_hash_num_elements(Z_ARRVAL_P(update_fields))) {
+		phalcon_concat_self_str(&sql, SL(" DO NOTHING") TSRMLS_CC);
+		RETURN_CTOR(sql);
+	}
+	
+	phalcon_concat_self_str(&sql, SL(" DO UPDATE SET ") TSRMLS_CC);
+	
+	phalcon_is_iterable(update_fields, &ah0, &hp0, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(field);
+	
+		if (first) {
+			PHALCON_SCONCAT_VSV(sql, field, " = EXCLUDED.", field);
+			first = 0;
+		} else {
+			PHALCON_SCONCAT_SVSV(sql, ", ", field, " = EXCLUDED.", field);
+		}
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+	
+	RETURN_CTOR(sql);
+}
+
+/**
+ * Builds a statement returning a single row with a column per query, every column is 1 if the
+ * query returns rows or 0 otherwise
+ *
+ *<code>
+ * $sql = $dialect->existsMultiple(array('SELECT 1 FROM robots WHERE id = ?', 'SELECT 1 FROM parts WHERE id = ?'));
+ * echo $sql; // SELECT CASE WHEN EXISTS (SELECT 1 FROM robots WHERE id = ?) THEN 1 ELSE 0 END, CASE WHEN EXISTS (SELECT 1 FROM parts WHERE id = ?) THEN 1 ELSE 0 END
+ *</code>
+ *
+ * @param array $queries
+ * @return string
+ */
+PHP_METHOD(Phalcon_Db_Dialect, existsMultiple){
+
+	zval *queries, *query = NULL, *sql;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+	int first = 1;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &queries);
+	
+	if (Z_TYPE_P(queries) != IS_ARRAY || !zend_hash_num_elements(Z_ARRVAL_P(queries))) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "At least one query is required to check if rows exist");
+		return;
+	}
+	
+	PHALCON_INIT_VAR(sql);
+	ZVAL_STRING(sql, "SELECT ", 1);
+	
+	phalcon_is_iterable(queries, &ah0, &hp0, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(query);
+	
+		if (first) {
+			PHALCON_SCONCAT_SVS(sql, "CASE WHEN EXISTS (", query, ") THEN 1 ELSE 0 END");
+			first = 0;
+		} else {
+			PHALCON_SCONCAT_SVS(sql, ", CASE WHEN EXISTS (", query, ") THEN 1 ELSE 0 END");
+		}
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+	
+	RETURN_CTOR(sql);
+}
+
+/**
+ * Returns the maximum number of bind parameters the database system accepts in a single statement
+ *
+ * @return int
+ */
+PHP_METHOD(Phalcon_Db_Dialect, getMaxBindParams){
+
+
+	RETURN_MEMBER(this_ptr, "_maxBindParams");
+}
+
+/**
+ * Returns the maximum number of values the database system accepts in an IN list, it's the
+ * same as the maximum number of bind parameters unless the system has a lower limit
+ *
+ * @return int
+ */
+PHP_METHOD(Phalcon_Db_Dialect, getMaxListParams){
+
+	zval *max_list_params;
+
+	max_list_params = phalcon_fetch_nproperty_this(this_ptr, SL("_maxListParams"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(max_list_params) == IS_NULL) {
+		RETURN_MEMBER(this_ptr, "_maxBindParams");
+	}
+
+	RETURN_ZVAL(max_list_params, 1, 0);
+}
+
 /**
  * Checks whether the platform supports savepoints
  *
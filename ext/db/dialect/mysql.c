@@ -65,6 +65,15 @@ PHP_METHOD(Phalcon_Db_Dialect_Mysql, listViews);
 PHP_METHOD(Phalcon_Db_Dialect_Mysql, describeIndexes);
 PHP_METHOD(Phalcon_Db_Dialect_Mysql, describeReferences);
 PHP_METHOD(Phalcon_Db_Dialect_Mysql, tableOptions);
+PHP_METHOD(Phalcon_Db_Dialect_Mysql, upsert);
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_dialect_mysql_upsert, 0, 0, 4)
+	ZEND_ARG_INFO(0, table)
+	ZEND_ARG_INFO(0, fields)
+	ZEND_ARG_INFO(0, values)
+	ZEND_ARG_INFO(0, keys)
+	ZEND_ARG_INFO(0, updateFields)
+ZEND_END_ARG_INFO()
 
 static const zend_function_entry phalcon_db_dialect_mysql_method_entry[] = {
 	PHP_ME(Phalcon_Db_Dialect_Mysql, getColumnDefinition, arginfo_phalcon_db_dialectinterface_getcolumndefinition, ZEND_ACC_PUBLIC)
@@ -90,6 +99,7 @@ static const zend_function_entry phalcon_db_dialect_mysql_method_entry[] = {
 	PHP_ME(Phalcon_Db_Dialect_Mysql, describeIndexes, arginfo_phalcon_db_dialectinterface_describeindexes, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect_Mysql, describeReferences, arginfo_phalcon_db_dialectinterface_describereferences, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect_Mysql, tableOptions, arginfo_phalcon_db_dialectinterface_tableoptions, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Dialect_Mysql, upsert, arginfo_phalcon_db_dialect_mysql_upsert, ZEND_ACC_PUBLIC)
 	PHP_FE_END
 };
 
@@ -101,6 +111,7 @@ PHALCON_INIT_CLASS(Phalcon_Db_Dialect_Mysql){
 	PHALCON_REGISTER_CLASS_EX(Phalcon\\Db\\Dialect, Mysql, db_dialect_mysql, phalcon_db_dialect_ce, phalcon_db_dialect_mysql_method_entry, 0);
 
 	zend_declare_property_string(phalcon_db_dialect_mysql_ce, SL("_escapeChar"), "`", ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_long(phalcon_db_dialect_mysql_ce, SL("_maxBindParams"), 65535, ZEND_ACC_PROTECTED TSRMLS_CC);
 
 	zend_class_implements(phalcon_db_dialect_mysql_ce TSRMLS_CC, 1, phalcon_db_dialectinterface_ce);
 
@@ -1115,3 +1126,81 @@ PHP_METHOD(Phalcon_Db_Dialect_Mysql, tableOptions){
 	RETURN_CTOR(sql);
 }
 
+/**
+ * Builds an INSERT statement that updates the existing row when a unique key is already taken.
+ * ON DUPLICATE KEY UPDATE fires on a conflict with any unique index of the table, not only
+ * the keys passed, so a single key is assigned through LAST_INSERT_ID(): lastInsertId()
+ * returns the key of the row actually inserted or updated
+ *
+ *<code>
+ * $sql = $dialect->upsert('`robots`', array('`id`', '`name`'), array('?', '?'), array('`id`'));
+ * echo $sql; // INSERT INTO `robots` (`id`, `name`) VALUES (?, ?) ON DUPLICATE KEY UPDATE `id` = LAST_INSERT_ID(`id`), `name` = VALUES(`name`)
+ *</code>
+ *
+ * @param string $table
+ * @param array $fields
+ * @param array $values
+ * @param array $keys
+ * @param array $updateFields
+ * @return string
+ */
+PHP_METHOD(Phalcon_Db_Dialect_Mysql, upsert){
+
+	zval *table, *fields, *values, *keys, *update_fields = NULL;
+	zval *joined_fields, *joined_values, *field = NULL, *sql;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 4, 1, &table, &fields, &values, &keys, &update_fields);
+	
+	if (Z_TYPE_P(fields) != IS_ARRAY || Z_TYPE_P(values) != IS_ARRAY || Z_TYPE_P(keys) != IS_ARRAY || !zend_hash_num_elements(Z_ARRVAL_P(keys))) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "Fields, values and at least one key are required to build an UPSERT");
+		return;
+	}
+	
+	if (!update_fields) {
+		update_fields = PHALCON_GLOBAL(z_null);
+	}
+	
+	PHALCON_INIT_VAR(joined_fields);
+	phalcon_fast_join_str(joined_fields, SL(", "), fields TSRMLS_CC);
+	
+	PHALCON_INIT_VAR(joined_values);
+	phalcon_fast_join_str(joined_values, SL(", "), values TSRMLS_CC);
+	
+	PHALCON_INIT_VAR(sql);
+	PHALCON_CONCAT_SVSVSVS(sql, "INSERT INTO ", table, " (", joined_fields, ") VALUES (", joined_values, ") ON DUPLICATE KEY UPDATE ");
+	
+	zend_hash_internal_pointer_reset(Z_ARRVAL_P(keys));
+	zend_hash_get_current_data(Z_ARRVAL_P(keys), (void**) &hd);
+	
+	/** 
+	 * Assigning a single key to itself through LAST_INSERT_ID() keeps it untouched and makes
+	 * the key of the updated row available, a composite key is just assigned to itself
+	 */
+	if (zend_hash_num_elements(Z_ARRVAL_P(keys)) == 1) {
+		PHALCON_SCONCAT_VSVS(sql, *hd, " = LAST_INSERT_ID(", *hd, ")");
+	} else {
+		PHALCON_SCONCAT_VSV(sql, *hd, " = ", *hd);
+	}
+	
+	if (Z_TYPE_P(update_fields) != IS_ARRAY) {
+		RETURN_CTOR(sql);
+	}
+	
+	phalcon_is_iterable(update_fields, &ah0, &hp0, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(field);
+	
+		PHALCON_SCONCAT_SVSVS(sql, ", ", field, " = VALUES(", field, ")");
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+	
+	RETURN_CTOR(sql);
+}
@@ -32,6 +32,7 @@
 #include "kernel/fcall.h"
 #include "kernel/operators.h"
 #include "kernel/concat.h"
+#include "kernel/framework/orm.h"
 
 /**
  * Phalcon\Db\Dialect\Oracle
@@ -66,6 +67,9 @@ PHP_METHOD(Phalcon_Db_Dialect_Oracle, tableOptions);
 PHP_METHOD(Phalcon_Db_Dialect_Oracle, getSqlTable);
 PHP_METHOD(Phalcon_Db_Dialect_Oracle, limit);
 PHP_METHOD(Phalcon_Db_Dialect_Oracle, select);
+PHP_METHOD(Phalcon_Db_Dialect_Oracle, insertMultiple);
+PHP_METHOD(Phalcon_Db_Dialect_Oracle, upsert);
+PHP_METHOD(Phalcon_Db_Dialect_Oracle, existsMultiple);
 PHP_METHOD(Phalcon_Db_Dialect_Oracle, supportsSavepoints);
 PHP_METHOD(Phalcon_Db_Dialect_Oracle, supportsReleaseSavepoints);
 
@@ -74,6 +78,24 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_dialect_oracle_getsqltable, 0, 0, 1)
 	ZEND_ARG_INFO(0, escapeChar)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_dialect_oracle_insertmultiple, 0, 0, 3)
+	ZEND_ARG_INFO(0, table)
+	ZEND_ARG_INFO(0, fields)
+	ZEND_ARG_INFO(0, rows)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_dialect_oracle_upsert, 0, 0, 4)
+	ZEND_ARG_INFO(0, table)
+	ZEND_ARG_INFO(0, fields)
+	ZEND_ARG_INFO(0, values)
+	ZEND_ARG_INFO(0, keys)
+	ZEND_ARG_INFO(0, updateFields)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_dialect_oracle_existsmultiple, 0, 0, 1)
+	ZEND_ARG_INFO(0, queries)
+ZEND_END_ARG_INFO()
+
 static const zend_function_entry phalcon_db_dialect_oracle_method_entry[] = {
 	PHP_ME(Phalcon_Db_Dialect_Oracle, getColumnDefinition, arginfo_phalcon_db_dialectinterface_getcolumndefinition, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect_Oracle, addColumn, arginfo_phalcon_db_dialectinterface_addcolumn, ZEND_ACC_PUBLIC)
@@ -101,6 +123,9 @@ static const zend_function_entry phalcon_db_dialect_oracle_method_entry[] = {
 	PHP_ME(Phalcon_Db_Dialect_Oracle, getSqlTable, arginfo_phalcon_db_dialect_oracle_getsqltable, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect_Oracle, limit, arginfo_phalcon_db_dialectinterface_limit, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect_Oracle, select, arginfo_phalcon_db_dialectinterface_select, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Dialect_Oracle, insertMultiple, arginfo_phalcon_db_dialect_oracle_insertmultiple, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Dialect_Oracle, upsert, arginfo_phalcon_db_dialect_oracle_upsert, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Dialect_Oracle, existsMultiple, arginfo_phalcon_db_dialect_oracle_existsmultiple, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect_Oracle, supportsSavepoints, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Dialect_Oracle, supportsReleaseSavepoints, NULL, ZEND_ACC_PUBLIC)
 	PHP_FE_END
@@ -114,6 +139,8 @@ PHALCON_INIT_CLASS(Phalcon_Db_Dialect_Oracle){
 	PHALCON_REGISTER_CLASS_EX(Phalcon\\Db\\Dialect, Oracle, db_dialect_oracle, phalcon_db_dialect_ce, phalcon_db_dialect_oracle_method_entry, 0);
 
 	zend_declare_property_string(phalcon_db_dialect_oracle_ce, SL("_escapeChar"), "", ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_long(phalcon_db_dialect_oracle_ce, SL("_maxBindParams"), 65535, ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_long(phalcon_db_dialect_oracle_ce, SL("_maxListParams"), 1000, ZEND_ACC_PROTECTED TSRMLS_CC);
 
 	zend_class_implements(phalcon_db_dialect_oracle_ce TSRMLS_CC, 1, phalcon_db_dialectinterface_ce);
 
@@ -827,7 +854,7 @@ PHP_METHOD(Phalcon_Db_Dialect_Oracle, select){
 	zval *order_expression = NULL, *order_sql_item = NULL, *sql_order_type = NULL;
 	zval *order_sql_item_type = NULL, *order_sql, *limit_value;
 	zval *number, *offset, *tmp1 = NULL, *tmp2 = NULL;
-	zval *z_one, *ini_range, *end_range = NULL, *sql_limit;
+	zval *z_one, *ini_range, *end_range = NULL, *sql_limit, *sql_key;
 	HashTable *ah0, *ah1, *ah2, *ah3, *ah4, *ah5;
 	HashPosition hp0, hp1, hp2, hp3, hp4, hp5;
 	zval **hd;
@@ -852,6 +879,14 @@ PHP_METHOD(Phalcon_Db_Dialect_Oracle, select){
 
 	PHALCON_MM_GROW();
 
+	/**
+	 * The same definition always produces the same SQL
+	 */
+	PHALCON_INIT_VAR(sql_key);
+	if (phalcon_orm_get_cached_sql(return_value, sql_key, this_ptr, definition TSRMLS_CC)) {
+		RETURN_MM();
+	}
+
 	if (PHALCON_GLOBAL(db).escape_identifiers) {
 		PHALCON_OBS_VAR(escape_char);
 		phalcon_read_property_this(&escape_char, this_ptr, SL("_escapeChar"), PH_NOISY TSRMLS_CC);
@@ -1198,6 +1233,201 @@ PHP_METHOD(Phalcon_Db_Dialect_Oracle, select){
 		}
 	}
 
+	phalcon_orm_set_cached_sql(sql_key, sql TSRMLS_CC);
+
+	RETURN_CTOR(sql);
+}
+
+/**
+ * Builds a multi-row INSERT statement, Oracle doesn't support several rows
+ * in the VALUES clause so INSERT ALL is used instead
+ *
+ * @param string $table
+ * @param array $fields
+ * @param array $rows
+ * @return string
+ */
+PHP_METHOD(Phalcon_Db_Dialect_Oracle, insertMultiple){
+
+	zval *table, *fields, *rows, *row = NULL, *joined_row = NULL;
+	zval *into, *joined_fields, *sql;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 3, 0, &table, &fields, &rows);
+	
+	if (Z_TYPE_P(rows) != IS_ARRAY || !zend_hash_num_elements(Z_ARRVAL_P(rows))) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "At least one row is required to build a multi-row INSERT");
+		return;
+	}
+	
+	PHALCON_INIT_VAR(into);
+	if (Z_TYPE_P(fields) == IS_ARRAY) {
+		PHALCON_INIT_VAR(joined_fields);
+		phalcon_fast_join_str(joined_fields, SL(", "), fields TSRMLS_CC);
+		PHALCON_CONCAT_SVSVS(into, " INTO ", table, " (", joined_fields, ") VALUES (");
+	} else {
+		PHALCON_CONCAT_SVS(into, " INTO ", table, " VALUES (");
+	}
+	
+	PHALCON_INIT_VAR(sql);
+	ZVAL_STRING(sql, "INSERT ALL", 1);
+	
+	phalcon_is_iterable(rows, &ah0, &hp0, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(row);
+	
+		PHALCON_INIT_NVAR(joined_row);
+		phalcon_fast_join_str(joined_row, SL(", "), row TSRMLS_CC);
+		PHALCON_SCONCAT_VVS(sql, into, joined_row, ")");
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+	
+	phalcon_concat_self_str(&sql, SL(" SELECT 1 FROM DUAL") TSRMLS_CC);
+	
+	RETURN_CTOR(sql);
+}
+
+/**
+ * Builds an UPSERT statement, Oracle doesn't support ON CONFLICT so MERGE is used instead
+ *
+ * @param string $table
+ * @param array $fields
+ * @param array $values
+ * @param array $keys
+ * @param array $updateFields
+ * @return string
+ */
+PHP_METHOD(Phalcon_Db_Dialect_Oracle, upsert){
+
+	zval *table, *fields, *values, *keys, *update_fields = NULL;
+	zval *field = NULL, *value = NULL, *source, *condition, *assignments;
+	zval *joined_fields, *inserted, *sql;
+	HashTable *ah0, *ah1;
+	HashPosition hp0, hp1;
+	zval **hd;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 4, 1, &table, &fields, &values, &keys, &update_fields);
+	
+	if (Z_TYPE_P(fields) != IS_ARRAY || Z_TYPE_P(values) != IS_ARRAY || Z_TYPE_P(keys) != IS_ARRAY || !zend_hash_num_elements(Z_ARRVAL_P(keys))) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "Fields, values and at least one key are required to build an UPSERT");
+		return;
+	}
+	
+	if (!update_fields) {
+		update_fields = PHALCON_GLOBAL(z_null);
+	}
+	
+	/** 
+	 * The values are selected from DUAL using the field names as aliases
+	 */
+	PHALCON_INIT_VAR(source);
+	PHALCON_INIT_VAR(inserted);
+	
+	phalcon_is_iterable(fields, &ah0, &hp0, 0, 0);
+	zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(values), &hp1);
+	ah1 = Z_ARRVAL_P(values);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(field);
+	
+		if (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == FAILURE) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_db_exception_ce, "The number of values doesn't match the number of fields");
+			return;
+		}
+	
+		PHALCON_GET_HVALUE(value);
+	
+		if (Z_TYPE_P(source) == IS_NULL) {
+			PHALCON_CONCAT_VSV(source, value, " ", field);
+			PHALCON_CONCAT_SV(inserted, "s.", field);
+		} else {
+			PHALCON_SCONCAT_SVSV(source, ", ", value, " ", field);
+			PHALCON_SCONCAT_SV(inserted, ", s.", field);
+		}
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+		zend_hash_move_forward_ex(ah1, &hp1);
+	}
+	
+	PHALCON_INIT_VAR(condition);
+	
+	phalcon_is_iterable(keys, &ah0, &hp0, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(field);
+	
+		if (Z_TYPE_P(condition) == IS_NULL) {
+			PHALCON_CONCAT_SVSV(condition, "d.", field, " = s.", field);
+		} else {
+			PHALCON_SCONCAT_SVSV(condition, " AND d.", field, " = s.", field);
+		}
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+	
+	PHALCON_INIT_VAR(joined_fields);
+	phalcon_fast_join_str(joined_fields, SL(", "), fields TSRMLS_CC);
+	
+	PHALCON_INIT_VAR(sql);
+	PHALCON_CONCAT_SVSVSVS(sql, "MERGE INTO ", table, " d USING (SELECT ", source, " FROM DUAL) s ON (", condition, ")");
+	
+	if (Z_TYPE_P(update_fields) == IS_ARRAY && zend_hash_num_elements(Z_ARRVAL_P(update_fields))) {
+	
+		PHALCON_INIT_VAR(assignments);
+	
+		phalcon_is_iterable(update_fields, &ah0, &hp0, 0, 0);
+	
+		while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+			PHALCON_GET_HVALUE(field);
+	
+			if (Z_TYPE_P(assignments) == IS_NULL) {
+				PHALCON_CONCAT_SVSV(assignments, "d.", field, " = s.", field);
+			} else {
+				PHALCON_SCONCAT_SVSV(assignments, ", d.", field, " = s.", field);
+			}
+	
+			zend_hash_move_forward_ex(ah0, &hp0);
+		}
+	
+		PHALCON_SCONCAT_SV(sql, " WHEN MATCHED THEN UPDATE SET ", assignments);
+	}
+	
+	PHALCON_SCONCAT_SVSVS(sql, " WHEN NOT MATCHED THEN INSERT (", joined_fields, ") VALUES (", inserted, ")");
+	
+	RETURN_CTOR(sql);
+}
+
+/**
+ * Builds a statement returning a single row with a column per query, Oracle requires
+ * the row to be selected from DUAL
+ *
+ * @param array $queries
+ * @return string
+ */
+PHP_METHOD(Phalcon_Db_Dialect_Oracle, existsMultiple){
+
+	zval *queries, *sql = NULL;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &queries);
+	
+	PHALCON_CALL_PARENT(&sql, phalcon_db_dialect_oracle_ce, this_ptr, "existsmultiple", queries);
+	
+	phalcon_concat_self_str(&sql, SL(" FROM DUAL") TSRMLS_CC);
+	
 	RETURN_CTOR(sql);
 }
 
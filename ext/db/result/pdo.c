@@ -57,6 +57,7 @@ PHP_METHOD(Phalcon_Db_Result_Pdo, numRows);
 PHP_METHOD(Phalcon_Db_Result_Pdo, dataSeek);
 PHP_METHOD(Phalcon_Db_Result_Pdo, setFetchMode);
 PHP_METHOD(Phalcon_Db_Result_Pdo, getInternalResult);
+PHP_METHOD(Phalcon_Db_Result_Pdo, getCountFallbacks);
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_db_result___construct, 0, 0, 2)
 	ZEND_ARG_INFO(0, connection)
@@ -76,6 +77,7 @@ static const zend_function_entry phalcon_db_result_pdo_method_entry[] = {
 	PHP_ME(Phalcon_Db_Result_Pdo, dataSeek, arginfo_phalcon_db_resultinterface_dataseek, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Result_Pdo, setFetchMode, arginfo_phalcon_db_resultinterface_setfetchmode, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Db_Result_Pdo, getInternalResult, arginfo_phalcon_db_resultinterface_getinternalresult, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Db_Result_Pdo, getCountFallbacks, NULL, ZEND_ACC_PUBLIC|ZEND_ACC_STATIC)
 	PHP_FE_END
 };
 
@@ -94,6 +96,7 @@ PHALCON_INIT_CLASS(Phalcon_Db_Result_Pdo){
 	zend_declare_property_null(phalcon_db_result_pdo_ce, SL("_bindParams"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_db_result_pdo_ce, SL("_bindTypes"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_bool(phalcon_db_result_pdo_ce, SL("_rowCount"), 0, ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_long(phalcon_db_result_pdo_ce, SL("_fetchedRows"), 0, ZEND_ACC_PROTECTED TSRMLS_CC);
 
 	return SUCCESS;
 }
@@ -159,9 +162,34 @@ PHP_METHOD(Phalcon_Db_Result_Pdo, execute){
 
 	pdo_statement = phalcon_fetch_nproperty_this(this_ptr, SL("_pdoStatement"), PH_NOISY TSRMLS_CC);
 	PHALCON_RETURN_CALL_METHOD(pdo_statement, "execute");
+
+	/**
+	 * The cursor starts again from the first row
+	 */
+	phalcon_update_property_long(this_ptr, SL("_fetchedRows"), 0 TSRMLS_CC);
 	PHALCON_MM_RESTORE();
 }
 
+/**
+ * Keeps track of the rows read through the cursor, once the end is reached
+ * the number of rows is known and numRows() doesn't need an extra query
+ */
+static void phalcon_db_result_pdo_track_row(zval *this_ptr, zval *row TSRMLS_DC) {
+
+	zval *row_count, *fetched_rows;
+
+	if (PHALCON_IS_NOT_FALSE(row)) {
+		phalcon_property_incr(this_ptr, SL("_fetchedRows") TSRMLS_CC);
+		return;
+	}
+
+	row_count = phalcon_fetch_nproperty_this(this_ptr, SL("_rowCount"), PH_NOISY TSRMLS_CC);
+	if (PHALCON_IS_FALSE(row_count)) {
+		fetched_rows = phalcon_fetch_nproperty_this(this_ptr, SL("_fetchedRows"), PH_NOISY TSRMLS_CC);
+		phalcon_update_property_this(this_ptr, SL("_rowCount"), fetched_rows TSRMLS_CC);
+	}
+}
+
 /**
  * Fetches an array/object of strings that corresponds to the fetched row, or FALSE if there are no more rows.
  * This method is affected by the active fetch flag set using Phalcon\Db\Result\Pdo::setFetchMode
@@ -184,6 +212,8 @@ PHP_METHOD(Phalcon_Db_Result_Pdo, fetch){
 
 	pdo_statement = phalcon_fetch_nproperty_this(this_ptr, SL("_pdoStatement"), PH_NOISY TSRMLS_CC);
 	PHALCON_RETURN_CALL_METHOD(pdo_statement, "fetch");
+
+	phalcon_db_result_pdo_track_row(this_ptr, return_value_ptr ? *return_value_ptr : return_value TSRMLS_CC);
 	RETURN_MM();
 }
 
@@ -209,6 +239,8 @@ PHP_METHOD(Phalcon_Db_Result_Pdo, fetchArray){
 
 	pdo_statement = phalcon_fetch_nproperty_this(this_ptr, SL("_pdoStatement"), PH_NOISY TSRMLS_CC);
 	PHALCON_RETURN_CALL_METHOD(pdo_statement, "fetch");
+
+	phalcon_db_result_pdo_track_row(this_ptr, return_value_ptr ? *return_value_ptr : return_value TSRMLS_CC);
 	RETURN_MM();
 }
 
@@ -225,18 +257,40 @@ PHP_METHOD(Phalcon_Db_Result_Pdo, fetchArray){
  */
 PHP_METHOD(Phalcon_Db_Result_Pdo, fetchAll){
 
-	zval *pdo_statement;
+	zval *pdo_statement, *rows, *fetched_rows, *row_count;
+	long number_rows;
 
 	PHALCON_MM_GROW();
 
 	pdo_statement = phalcon_fetch_nproperty_this(this_ptr, SL("_pdoStatement"), PH_NOISY TSRMLS_CC);
 	PHALCON_RETURN_CALL_METHOD(pdo_statement, "fetchall");
+
+	rows = return_value_ptr ? *return_value_ptr : return_value;
+
+	/**
+	 * The whole cursor is now in memory, so the number of rows is known
+	 */
+	if (Z_TYPE_P(rows) == IS_ARRAY) {
+		fetched_rows = phalcon_fetch_nproperty_this(this_ptr, SL("_fetchedRows"), PH_NOISY TSRMLS_CC);
+		number_rows  = phalcon_get_intval(fetched_rows) + zend_hash_num_elements(Z_ARRVAL_P(rows));
+
+		phalcon_update_property_long(this_ptr, SL("_fetchedRows"), number_rows TSRMLS_CC);
+
+		row_count = phalcon_fetch_nproperty_this(this_ptr, SL("_rowCount"), PH_NOISY TSRMLS_CC);
+		if (PHALCON_IS_FALSE(row_count)) {
+			phalcon_update_property_long(this_ptr, SL("_rowCount"), number_rows TSRMLS_CC);
+		}
+	}
+
 	RETURN_MM();
 }
 
 /**
  * Gets number of rows returned by a resulset
  *
+ * If the driver cannot report it and the cursor hasn't been traversed until the end,
+ * an extra SELECT COUNT(*) query is executed (see getCountFallbacks())
+ *
  *<code>
  *	$result = $connection->query("SELECT * FROM robots ORDER BY name");
  *	echo 'There are ', $result->numRows(), ' rows in the resulset';
@@ -310,6 +364,8 @@ PHP_METHOD(Phalcon_Db_Result_Pdo, numRows){
 					PHALCON_INIT_VAR(sql);
 					PHALCON_CONCAT_SVS(sql, "SELECT COUNT(*) \"numrows\" FROM (SELECT ", else_clauses, ")");
 	
+					PHALCON_GLOBAL(db).count_fallbacks++;
+
 					PHALCON_CALL_METHOD(&result, connection, "query", sql, bind_params, bind_types);
 					PHALCON_CALL_METHOD(&row, result, "fetch");
 	
@@ -398,11 +454,14 @@ PHP_METHOD(Phalcon_Db_Result_Pdo, dataSeek){
 		RETURN_FALSE;
 	}
 
+	phalcon_update_property_long(this_ptr, SL("_fetchedRows"), 0 TSRMLS_CC);
+
 	n = -1;
 	number--;
 	while (n != number) {
 
 		if(!stmt->methods->fetcher(stmt, PDO_FETCH_ORI_NEXT, 0 TSRMLS_CC)) {
+			phalcon_update_property_long(this_ptr, SL("_fetchedRows"), n + 1 TSRMLS_CC);
 			PHALCON_MM_RESTORE();
 			RETURN_NULL();
 		}
@@ -410,6 +469,7 @@ PHP_METHOD(Phalcon_Db_Result_Pdo, dataSeek){
 		n++;
 	}
 
+	phalcon_update_property_long(this_ptr, SL("_fetchedRows"), n + 1 TSRMLS_CC);
 	PHALCON_MM_RESTORE();
 }
 
@@ -469,3 +529,20 @@ PHP_METHOD(Phalcon_Db_Result_Pdo, getInternalResult){
 	RETURN_MEMBER(this_ptr, "_pdoStatement");
 }
 
+
+/**
+ * Returns how many times numRows() had to execute an extra SELECT COUNT(*) query
+ * in the current request because the row count wasn't known
+ *
+ *<code>
+ *	$robots = Robots::find();
+ *	echo count($robots), ' robots, ', Phalcon\Db\Result\Pdo::getCountFallbacks(), ' count queries';
+ *</code>
+ *
+ * @return int
+ */
+PHP_METHOD(Phalcon_Db_Result_Pdo, getCountFallbacks){
+
+
+	RETURN_LONG((long int)PHALCON_GLOBAL(db).count_fallbacks);
+}
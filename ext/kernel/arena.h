@@ -0,0 +1,83 @@
+
+/*
+  +------------------------------------------------------------------------+
+  | Phalcon Framework                                                      |
+  +------------------------------------------------------------------------+
+  | Copyright (c) 2011-2014 Phalcon Team (http://www.phalconphp.com)       |
+  +------------------------------------------------------------------------+
+  | This source file is subject to the New BSD License that is bundled     |
+  | with this package in the file docs/LICENSE.txt.                        |
+  |                                                                        |
+  | If you did not receive a copy of the license and are unable to         |
+  | obtain it through the world-wide-web, please send an email             |
+  | to license@phalconphp.com so we can send you a copy immediately.       |
+  +------------------------------------------------------------------------+
+  | Authors: Andres Gutierrez <andres@phalconphp.com>                      |
+  |          Eduar Carvajal <eduar@phalconphp.com>                         |
+  +------------------------------------------------------------------------+
+*/
+
+#ifndef PHALCON_KERNEL_ARENA_H
+#define PHALCON_KERNEL_ARENA_H
+
+#include "php_phalcon.h"
+
+/**
+ * Bump allocator for short-lived allocations that share the same lifetime,
+ * every chunk is released at once by phalcon_arena_destroy(). Blocks are
+ * block_size bytes, sized by the caller for its usual number of allocations
+ */
+typedef struct _phalcon_arena_block {
+	struct _phalcon_arena_block *next;
+	size_t used;
+	size_t size;
+} phalcon_arena_block;
+
+typedef struct _phalcon_arena {
+	phalcon_arena_block *head;
+	size_t block_size;
+} phalcon_arena;
+
+PHALCON_ATTR_NONNULL static inline void phalcon_arena_init(phalcon_arena *arena, size_t block_size)
+{
+	arena->head = NULL;
+	arena->block_size = block_size;
+}
+
+PHALCON_ATTR_NONNULL static inline void* phalcon_arena_alloc(phalcon_arena *arena, size_t size)
+{
+	phalcon_arena_block *block = arena->head;
+	size_t block_size;
+	void *pointer;
+
+	size = ZEND_MM_ALIGNED_SIZE(size);
+
+	if (!block || block->used + size > block->size) {
+		block_size = size > arena->block_size ? size : arena->block_size;
+		block = emalloc(ZEND_MM_ALIGNED_SIZE(sizeof(phalcon_arena_block)) + block_size);
+		block->next = arena->head;
+		block->used = 0;
+		block->size = block_size;
+		arena->head = block;
+	}
+
+	pointer = (char*)block + ZEND_MM_ALIGNED_SIZE(sizeof(phalcon_arena_block)) + block->used;
+	block->used += size;
+
+	return pointer;
+}
+
+PHALCON_ATTR_NONNULL static inline void phalcon_arena_destroy(phalcon_arena *arena)
+{
+	phalcon_arena_block *block = arena->head, *next;
+
+	while (block) {
+		next = block->next;
+		efree(block);
+		block = next;
+	}
+
+	arena->head = NULL;
+}
+
+#endif /* PHALCON_KERNEL_ARENA_H */
@@ -18,6 +18,7 @@
 */
 
 #include "php_phalcon.h"
+#include "kernel/object.h"
 #include <ext/standard/php_smart_str.h>
 
 /**
@@ -38,6 +39,14 @@ void phalcon_orm_destroy_cache(TSRMLS_D) {
 		FREE_HASHTABLE(phalcon_globals_ptr->orm.ast_cache);
 		phalcon_globals_ptr->orm.ast_cache = NULL;
 	}
+
+	if (phalcon_globals_ptr->orm.sql_cache != NULL) {
+		zend_hash_destroy(phalcon_globals_ptr->orm.sql_cache);
+		FREE_HASHTABLE(phalcon_globals_ptr->orm.sql_cache);
+		phalcon_globals_ptr->orm.sql_cache = NULL;
+	}
+
+	phalcon_globals_ptr->orm.sql_cache_misses = 0;
 }
 
 /**
@@ -90,6 +99,194 @@ void phalcon_orm_set_prepared_ast(zval *unique_id, zval *prepared_ast TSRMLS_DC)
 
 }
 
+/**
+ * Maximum number of SQL statements kept in the dialects cache
+ */
+#define PHALCON_ORM_SQL_CACHE_SIZE 1024
+
+/**
+ * Once the cache is full and keeps missing, only one statement in this many is looked up
+ */
+#define PHALCON_ORM_SQL_CACHE_SAMPLE 16
+
+/**
+ * Appends an unambiguous representation of an intermediate definition to the key,
+ * fails for values that cannot be part of a definition (objects, resources)
+ */
+static int phalcon_orm_fingerprint(smart_str *key, zval *value) {
+
+	HashTable *ht;
+	HashPosition hp;
+	zval **item;
+	char *str_key;
+	uint str_key_len;
+	ulong num_key;
+
+	switch (Z_TYPE_P(value)) {
+
+		case IS_NULL:
+			smart_str_appendc(key, 'n');
+			return SUCCESS;
+
+		case IS_BOOL:
+			smart_str_appendc(key, Z_BVAL_P(value) ? 't' : 'f');
+			return SUCCESS;
+
+		case IS_LONG:
+			smart_str_appendc(key, 'l');
+			smart_str_append_long(key, Z_LVAL_P(value));
+			smart_str_appendc(key, ';');
+			return SUCCESS;
+
+		case IS_DOUBLE:
+			smart_str_appendc(key, 'd');
+			smart_str_appendl(key, (const char*) &Z_DVAL_P(value), sizeof(double));
+			return SUCCESS;
+
+		case IS_STRING:
+			smart_str_appendc(key, 's');
+			smart_str_append_long(key, Z_STRLEN_P(value));
+			smart_str_appendc(key, ':');
+			smart_str_appendl(key, Z_STRVAL_P(value), Z_STRLEN_P(value));
+			return SUCCESS;
+
+		case IS_ARRAY:
+			ht = Z_ARRVAL_P(value);
+			smart_str_appendc(key, 'a');
+			smart_str_append_long(key, zend_hash_num_elements(ht));
+			smart_str_appendc(key, '{');
+
+			for (
+				zend_hash_internal_pointer_reset_ex(ht, &hp);
+				zend_hash_get_current_data_ex(ht, (void**) &item, &hp) == SUCCESS;
+				zend_hash_move_forward_ex(ht, &hp)
+			) {
+				if (zend_hash_get_current_key_ex(ht, &str_key, &str_key_len, &num_key, 0, &hp) == HASH_KEY_IS_STRING) {
+					smart_str_appendc(key, 's');
+					smart_str_append_long(key, str_key_len - 1);
+					smart_str_appendc(key, ':');
+					smart_str_appendl(key, str_key, str_key_len - 1);
+				} else {
+					smart_str_appendc(key, 'i');
+					smart_str_append_unsigned(key, num_key);
+					smart_str_appendc(key, ';');
+				}
+
+				if (phalcon_orm_fingerprint(key, *item) == FAILURE) {
+					return FAILURE;
+				}
+			}
+
+			smart_str_appendc(key, '}');
+			return SUCCESS;
+
+		default:
+			return FAILURE;
+	}
+}
+
+/**
+ * Obtains the SQL generated by a dialect for an intermediate definition, the fingerprint
+ * of the definition is stored in key so the generated SQL can be cached afterwards.
+ * Only the dialects of the framework are cached: a userland dialect can produce
+ * different SQL for the same definition
+ */
+int phalcon_orm_get_cached_sql(zval *return_value, zval *key, zval *dialect, zval *definition TSRMLS_DC) {
+
+	zend_phalcon_globals *phalcon_globals_ptr = PHALCON_VGLOBAL;
+	zend_class_entry *ce;
+	smart_str fingerprint = { NULL, 0, 0 };
+	zval *escape_char, **cached;
+	int full;
+
+	if (phalcon_globals_ptr->orm.cache_level < 1 || Z_TYPE_P(dialect) != IS_OBJECT) {
+		return 0;
+	}
+
+	ce = Z_OBJCE_P(dialect);
+	if (ce->type != ZEND_INTERNAL_CLASS) {
+		return 0;
+	}
+
+	/**
+	 * A full cache still serves the statements it holds, but when nothing has been found in
+	 * a long run of lookups the fingerprint is only computed for a sample of the statements.
+	 * Any hit restores the lookups of every statement
+	 */
+	full = phalcon_globals_ptr->orm.sql_cache != NULL && zend_hash_num_elements(phalcon_globals_ptr->orm.sql_cache) >= PHALCON_ORM_SQL_CACHE_SIZE;
+	if (full && phalcon_globals_ptr->orm.sql_cache_misses >= PHALCON_ORM_SQL_CACHE_SIZE) {
+		if (++phalcon_globals_ptr->orm.sql_cache_misses % PHALCON_ORM_SQL_CACHE_SAMPLE) {
+			return 0;
+		}
+	}
+
+	/**
+	 * The same definition produces different SQL in every dialect and escaping mode
+	 */
+	smart_str_appendl(&fingerprint, ce->name, ce->name_length);
+	smart_str_appendc(&fingerprint, phalcon_globals_ptr->db.escape_identifiers ? 'e' : 'r');
+
+	escape_char = phalcon_fetch_nproperty_this(dialect, SL("_escapeChar"), PH_NOISY TSRMLS_CC);
+	if (phalcon_orm_fingerprint(&fingerprint, escape_char) == FAILURE || phalcon_orm_fingerprint(&fingerprint, definition) == FAILURE) {
+		smart_str_free(&fingerprint);
+		return 0;
+	}
+
+	smart_str_0(&fingerprint);
+
+	zval_dtor(key);
+	ZVAL_STRINGL(key, fingerprint.c, fingerprint.len, 0);
+
+	if (phalcon_globals_ptr->orm.sql_cache != NULL) {
+		if (zend_hash_find(phalcon_globals_ptr->orm.sql_cache, Z_STRVAL_P(key), Z_STRLEN_P(key) + 1, (void**) &cached) == SUCCESS) {
+			phalcon_globals_ptr->orm.sql_cache_misses = 0;
+			RETVAL_ZVAL(*cached, 1, 0);
+			return 1;
+		}
+	}
+
+	if (full) {
+		++phalcon_globals_ptr->orm.sql_cache_misses;
+	}
+
+	return 0;
+}
+
+/**
+ * Stores the SQL generated by a dialect using the fingerprint obtained by phalcon_orm_get_cached_sql
+ */
+void phalcon_orm_set_cached_sql(zval *key, zval *sql TSRMLS_DC) {
+
+	zend_phalcon_globals *phalcon_globals_ptr = PHALCON_VGLOBAL;
+
+	if (Z_TYPE_P(key) != IS_STRING || Z_TYPE_P(sql) != IS_STRING) {
+		return;
+	}
+
+	if (!phalcon_globals_ptr->orm.sql_cache) {
+		ALLOC_HASHTABLE(phalcon_globals_ptr->orm.sql_cache);
+		zend_hash_init(phalcon_globals_ptr->orm.sql_cache, 0, NULL, ZVAL_PTR_DTOR, 0);
+	}
+
+	/**
+	 * Definitions with literals can produce an unbounded number of statements
+	 */
+	if (zend_hash_num_elements(phalcon_globals_ptr->orm.sql_cache) >= PHALCON_ORM_SQL_CACHE_SIZE) {
+		return;
+	}
+
+	Z_ADDREF_P(sql);
+
+	zend_hash_update(
+		phalcon_globals_ptr->orm.sql_cache,
+		Z_STRVAL_P(key),
+		Z_STRLEN_P(key) + 1,
+		&sql,
+		sizeof(zval *),
+		NULL
+	);
+}
+
 /**
  * Escapes single quotes into database single quotes
  */
@@ -20,4 +20,6 @@
 void phalcon_orm_destroy_cache(TSRMLS_D);
 void phalcon_orm_get_prepared_ast(zval **return_value, zval *unique_id TSRMLS_DC);
 void phalcon_orm_set_prepared_ast(zval *unique_id, zval *prepared_ast TSRMLS_DC);
+int phalcon_orm_get_cached_sql(zval *return_value, zval *key, zval *dialect, zval *definition TSRMLS_DC);
+void phalcon_orm_set_cached_sql(zval *key, zval *sql TSRMLS_DC);
 void phalcon_orm_singlequotes(zval *return_value, zval *str TSRMLS_DC);
\ No newline at end of file
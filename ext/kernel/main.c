@@ -48,13 +48,16 @@ void php_phalcon_init_globals(zend_phalcon_globals *phalcon_globals TSRMLS_DC) {
 	phalcon_globals->orm.not_null_validations = 1;
 	phalcon_globals->orm.exception_on_failed_save = 0;
 	phalcon_globals->orm.enable_literals = 1;
-	phalcon_globals->orm.cache_level = 3;
+	phalcon_globals->orm.identity_map = 0;
 	phalcon_globals->orm.unique_cache_id = 0;
 	phalcon_globals->orm.parser_cache = NULL;
 	phalcon_globals->orm.ast_cache = NULL;
+	phalcon_globals->orm.sql_cache = NULL;
+	phalcon_globals->orm.sql_cache_misses = 0;
 
 	/* DB options */
 	phalcon_globals->db.escape_identifiers = 1;
+	phalcon_globals->db.count_fallbacks = 0;
 }
 
 /**
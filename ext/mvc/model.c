@@ -85,6 +85,24 @@
  */
 zend_class_entry *phalcon_mvc_model_ce;
 
+static zend_object_handlers phalcon_mvc_model_object_handlers;
+
+typedef struct _phalcon_mvc_model_object {
+	zend_object obj;     /**< Zend object data */
+	zend_bool read_only; /**< Whether writes to the attributes are rejected */
+} phalcon_mvc_model_object;
+
+/**
+ * @brief Fetches @c phalcon_mvc_model_object
+ * @see phalcon_mvc_model_object
+ * @param zobj @c \Phalcon\Mvc\Model instance
+ * @return phalcon_mvc_model_object associated with @a zobj
+ */
+static inline phalcon_mvc_model_object* phalcon_mvc_model_get_object(zval* zobj TSRMLS_DC)
+{
+	return (phalcon_mvc_model_object*)zend_objects_get_address(zobj TSRMLS_CC);
+}
+
 PHP_METHOD(Phalcon_Mvc_Model, __construct);
 PHP_METHOD(Phalcon_Mvc_Model, setDI);
 PHP_METHOD(Phalcon_Mvc_Model, getDI);
@@ -132,12 +150,16 @@ PHP_METHOD(Phalcon_Mvc_Model, _checkForeignKeysReverseRestrict);
 PHP_METHOD(Phalcon_Mvc_Model, _checkForeignKeysReverseCascade);
 PHP_METHOD(Phalcon_Mvc_Model, _preSave);
 PHP_METHOD(Phalcon_Mvc_Model, _postSave);
+PHP_METHOD(Phalcon_Mvc_Model, _prepareLowInsert);
 PHP_METHOD(Phalcon_Mvc_Model, _doLowInsert);
+PHP_METHOD(Phalcon_Mvc_Model, _doLowUpsert);
 PHP_METHOD(Phalcon_Mvc_Model, _doLowUpdate);
 PHP_METHOD(Phalcon_Mvc_Model, _preSaveRelatedRecords);
 PHP_METHOD(Phalcon_Mvc_Model, _postSaveRelatedRecords);
 PHP_METHOD(Phalcon_Mvc_Model, save);
+PHP_METHOD(Phalcon_Mvc_Model, upsert);
 PHP_METHOD(Phalcon_Mvc_Model, create);
+PHP_METHOD(Phalcon_Mvc_Model, createMany);
 PHP_METHOD(Phalcon_Mvc_Model, update);
 PHP_METHOD(Phalcon_Mvc_Model, delete);
 PHP_METHOD(Phalcon_Mvc_Model, getOperationMade);
@@ -160,6 +182,8 @@ PHP_METHOD(Phalcon_Mvc_Model, getSnapshotData);
 PHP_METHOD(Phalcon_Mvc_Model, hasChanged);
 PHP_METHOD(Phalcon_Mvc_Model, getChangedFields);
 PHP_METHOD(Phalcon_Mvc_Model, useDynamicUpdate);
+PHP_METHOD(Phalcon_Mvc_Model, useIdentityMap);
+PHP_METHOD(Phalcon_Mvc_Model, useReadOnlyRecords);
 PHP_METHOD(Phalcon_Mvc_Model, getRelated);
 PHP_METHOD(Phalcon_Mvc_Model, _getRelatedRecords);
 PHP_METHOD(Phalcon_Mvc_Model, __call);
@@ -183,6 +207,10 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_setdirtystate, 0, 0, 1)
 	ZEND_ARG_INFO(0, dirtyState)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_createmany, 0, 0, 1)
+	ZEND_ARG_INFO(0, records)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_skipoperation, 0, 0, 1)
 	ZEND_ARG_INFO(0, skip)
 ZEND_END_ARG_INFO()
@@ -279,12 +307,16 @@ static const zend_function_entry phalcon_mvc_model_method_entry[] = {
 	PHP_ME(Phalcon_Mvc_Model, _checkForeignKeysReverseCascade, NULL, ZEND_ACC_PROTECTED)
 	PHP_ME(Phalcon_Mvc_Model, _preSave, NULL, ZEND_ACC_PROTECTED)
 	PHP_ME(Phalcon_Mvc_Model, _postSave, NULL, ZEND_ACC_PROTECTED)
+	PHP_ME(Phalcon_Mvc_Model, _prepareLowInsert, NULL, ZEND_ACC_PROTECTED)
 	PHP_ME(Phalcon_Mvc_Model, _doLowInsert, NULL, ZEND_ACC_PROTECTED)
+	PHP_ME(Phalcon_Mvc_Model, _doLowUpsert, NULL, ZEND_ACC_PROTECTED)
 	PHP_ME(Phalcon_Mvc_Model, _doLowUpdate, NULL, ZEND_ACC_PROTECTED)
 	PHP_ME(Phalcon_Mvc_Model, _preSaveRelatedRecords, NULL, ZEND_ACC_PROTECTED)
 	PHP_ME(Phalcon_Mvc_Model, _postSaveRelatedRecords, NULL, ZEND_ACC_PROTECTED)
 	PHP_ME(Phalcon_Mvc_Model, save, arginfo_phalcon_mvc_modelinterface_save, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model, upsert, arginfo_phalcon_mvc_modelinterface_save, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model, create, arginfo_phalcon_mvc_modelinterface_create, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model, createMany, arginfo_phalcon_mvc_model_createmany, ZEND_ACC_PUBLIC|ZEND_ACC_STATIC)
 	PHP_ME(Phalcon_Mvc_Model, update, arginfo_phalcon_mvc_modelinterface_update, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model, delete, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model, getOperationMade, NULL, ZEND_ACC_PUBLIC)
@@ -307,6 +339,8 @@ static const zend_function_entry phalcon_mvc_model_method_entry[] = {
 	PHP_ME(Phalcon_Mvc_Model, hasChanged, arginfo_phalcon_mvc_model_haschanged, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model, getChangedFields, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model, useDynamicUpdate, NULL, ZEND_ACC_PROTECTED)
+	PHP_ME(Phalcon_Mvc_Model, useIdentityMap, NULL, ZEND_ACC_PROTECTED)
+	PHP_ME(Phalcon_Mvc_Model, useReadOnlyRecords, NULL, ZEND_ACC_PROTECTED)
 	PHP_ME(Phalcon_Mvc_Model, getRelated, arginfo_phalcon_mvc_modelinterface_getrelated, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model, _getRelatedRecords, NULL, ZEND_ACC_PROTECTED)
 	PHP_ME(Phalcon_Mvc_Model, __call, arginfo_phalcon_mvc_model___call, ZEND_ACC_PUBLIC)
@@ -323,6 +357,176 @@ static const zend_function_entry phalcon_mvc_model_method_entry[] = {
 	PHP_FE_END
 };
 
+/**
+ * Records an attribute written while the model keeps a snapshot, so change checks
+ * only compare the written attributes against it
+ */
+static void phalcon_mvc_model_mark_written(zval *object, zval *member TSRMLS_DC)
+{
+	zval *written, name;
+
+	written = phalcon_fetch_nproperty_this(object, SL("_written"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(written) != IS_ARRAY) {
+		return;
+	}
+
+	if (Z_TYPE_P(member) == IS_STRING) {
+		if (PHALCON_IS_STRING(member, "_written") || phalcon_array_isset(written, member)) {
+			return;
+		}
+
+		phalcon_update_property_array(object, SL("_written"), member, PHALCON_GLOBAL(z_true) TSRMLS_CC);
+		return;
+	}
+
+	name = *member;
+	zval_copy_ctor(&name);
+	convert_to_string(&name);
+
+	if (!phalcon_array_isset(written, &name)) {
+		phalcon_update_property_array(object, SL("_written"), &name, PHALCON_GLOBAL(z_true) TSRMLS_CC);
+	}
+
+	zval_dtor(&name);
+}
+
+/**
+ * Read-only records only accept writes to the internal properties declared by
+ * Phalcon\Mvc\Model, any other write throws an exception
+ */
+static int phalcon_mvc_model_read_only_check(zval *object, zval *member TSRMLS_DC)
+{
+	zval name;
+
+	if (!phalcon_mvc_model_get_object(object TSRMLS_CC)->read_only) {
+		return SUCCESS;
+	}
+
+	if (Z_TYPE_P(member) == IS_STRING) {
+		if (zend_hash_exists(&phalcon_mvc_model_ce->properties_info, Z_STRVAL_P(member), Z_STRLEN_P(member) + 1)) {
+			return SUCCESS;
+		}
+
+		zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "Cannot modify the attribute '%s' of a read-only record", Z_STRVAL_P(member));
+		return FAILURE;
+	}
+
+	name = *member;
+	zval_copy_ctor(&name);
+	convert_to_string(&name);
+	zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "Cannot modify the attribute '%s' of a read-only record", Z_STRVAL(name));
+	zval_dtor(&name);
+	return FAILURE;
+}
+
+static void phalcon_mvc_model_write_property(zval *object, zval *member, zval *value ZLK_DC TSRMLS_DC)
+{
+	if (phalcon_mvc_model_read_only_check(object, member TSRMLS_CC) == SUCCESS) {
+		std_object_handlers.write_property(object, member, value ZLK_CC TSRMLS_CC);
+		phalcon_mvc_model_mark_written(object, member TSRMLS_CC);
+	}
+}
+
+static void phalcon_mvc_model_unset_property(zval *object, zval *member ZLK_DC TSRMLS_DC)
+{
+	if (phalcon_mvc_model_read_only_check(object, member TSRMLS_CC) == SUCCESS) {
+		std_object_handlers.unset_property(object, member ZLK_CC TSRMLS_CC);
+		phalcon_mvc_model_mark_written(object, member TSRMLS_CC);
+	}
+}
+
+/**
+ * Direct access to a property (compound assignments, references) is considered a write,
+ * read-only records return no pointer so the engine falls back to write_property
+ */
+#if PHP_VERSION_ID < 50500
+
+static zval** phalcon_mvc_model_get_property_ptr_ptr(zval *object, zval *member ZLK_DC TSRMLS_DC)
+{
+	zval **ptr;
+
+	if (phalcon_mvc_model_get_object(object TSRMLS_CC)->read_only) {
+		if (Z_TYPE_P(member) != IS_STRING || !zend_hash_exists(&phalcon_mvc_model_ce->properties_info, Z_STRVAL_P(member), Z_STRLEN_P(member) + 1)) {
+			return NULL;
+		}
+	}
+
+	ptr = std_object_handlers.get_property_ptr_ptr(object, member ZLK_CC TSRMLS_CC);
+	phalcon_mvc_model_mark_written(object, member TSRMLS_CC);
+	return ptr;
+}
+
+#else
+
+static zval** phalcon_mvc_model_get_property_ptr_ptr(zval *object, zval *member, int type, const zend_literal* key TSRMLS_DC)
+{
+	zval **ptr;
+
+	if (phalcon_mvc_model_get_object(object TSRMLS_CC)->read_only) {
+		if (Z_TYPE_P(member) != IS_STRING || !zend_hash_exists(&phalcon_mvc_model_ce->properties_info, Z_STRVAL_P(member), Z_STRLEN_P(member) + 1)) {
+			return NULL;
+		}
+	}
+
+	ptr = std_object_handlers.get_property_ptr_ptr(object, member, type, key TSRMLS_CC);
+	phalcon_mvc_model_mark_written(object, member TSRMLS_CC);
+	return ptr;
+}
+
+#endif
+
+/**
+ * Turns a hydrated record into a read-only one
+ */
+void phalcon_mvc_model_make_read_only(zval *record TSRMLS_DC)
+{
+	phalcon_mvc_model_get_object(record TSRMLS_CC)->read_only = 1;
+}
+
+int phalcon_mvc_model_is_read_only(zval *record TSRMLS_DC)
+{
+	if (Z_TYPE_P(record) != IS_OBJECT || Z_OBJ_HT_P(record) != &phalcon_mvc_model_object_handlers) {
+		return 0;
+	}
+
+	return phalcon_mvc_model_get_object(record TSRMLS_CC)->read_only;
+}
+
+static zend_object_value phalcon_mvc_model_ctor(zend_class_entry *ce TSRMLS_DC)
+{
+	phalcon_mvc_model_object *obj = ecalloc(1, sizeof(phalcon_mvc_model_object));
+	zend_object_value retval;
+
+	zend_object_std_init(&obj->obj, ce TSRMLS_CC);
+	object_properties_init(&obj->obj, ce);
+
+	retval.handle = zend_objects_store_put(
+		obj,
+		(zend_objects_store_dtor_t)zend_objects_destroy_object,
+		(zend_objects_free_object_storage_t)zend_objects_free_object_storage,
+		NULL
+		TSRMLS_CC
+	);
+
+	retval.handlers = &phalcon_mvc_model_object_handlers;
+	return retval;
+}
+
+/**
+ * Clones of read-only records are read-only too, __clone() still can change the attributes
+ */
+static zend_object_value phalcon_mvc_model_clone_obj(zval *object TSRMLS_DC)
+{
+	phalcon_mvc_model_object *orig  = phalcon_mvc_model_get_object(object TSRMLS_CC);
+	zend_object_value result        = phalcon_mvc_model_ctor(Z_OBJCE_P(object) TSRMLS_CC);
+	phalcon_mvc_model_object *clone = zend_object_store_get_object_by_handle(result.handle TSRMLS_CC);
+
+	zend_objects_clone_members(&clone->obj, result, &orig->obj, Z_OBJ_HANDLE_P(object) TSRMLS_CC);
+	clone->read_only = orig->read_only;
+
+	return result;
+}
+
 /**
  * Phalcon\Mvc\Model initializer
  */
@@ -343,6 +547,8 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model){
 	zend_declare_property_null(phalcon_mvc_model_ce, SL("_skipped"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_ce, SL("_related"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_ce, SL("_snapshot"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_ce, SL("_snapshotMap"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_ce, SL("_written"), ZEND_ACC_PROTECTED TSRMLS_CC);
 
 	zend_declare_class_constant_long(phalcon_mvc_model_ce, SL("OP_NONE"), 0 TSRMLS_CC);
 	zend_declare_class_constant_long(phalcon_mvc_model_ce, SL("OP_CREATE"), 1 TSRMLS_CC);
@@ -354,6 +560,17 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model){
 
 	zend_class_implements(phalcon_mvc_model_ce TSRMLS_CC, 4, phalcon_mvc_modelinterface_ce, phalcon_mvc_model_resultinterface_ce, phalcon_di_injectionawareinterface_ce, zend_ce_serializable);
 
+	/**
+	 * Models inherit the handlers which track the attributes written after a snapshot was taken
+	 */
+	phalcon_mvc_model_ce->create_object = phalcon_mvc_model_ctor;
+
+	phalcon_mvc_model_object_handlers = *zend_get_std_object_handlers();
+	phalcon_mvc_model_object_handlers.write_property       = phalcon_mvc_model_write_property;
+	phalcon_mvc_model_object_handlers.get_property_ptr_ptr = phalcon_mvc_model_get_property_ptr_ptr;
+	phalcon_mvc_model_object_handlers.unset_property       = phalcon_mvc_model_unset_property;
+	phalcon_mvc_model_object_handlers.clone_obj            = phalcon_mvc_model_clone_obj;
+
 	return SUCCESS;
 }
 
@@ -412,6 +629,44 @@ static int phalcon_mvc_model_get_messages_from_model(zval *this_ptr, zval *model
 	return likely(!EG(exception)) ? SUCCESS : FAILURE;
 }
 
+/**
+ * Drops the record from the identity map of the models manager, if the manager keeps one
+ */
+static int phalcon_mvc_model_forget_identity(zval *this_ptr TSRMLS_DC)
+{
+	zval *manager = phalcon_fetch_nproperty_this(this_ptr, SL("_modelsManager"), PH_NOISY TSRMLS_CC);
+
+	if (Z_TYPE_P(manager) == IS_OBJECT && instanceof_function(Z_OBJCE_P(manager), phalcon_mvc_model_manager_ce TSRMLS_CC)) {
+		zval *params[] = { this_ptr };
+		return phalcon_call_method(NULL, manager, "removeidentityrecord", 1, params TSRMLS_CC);
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * Changes the version of the table of a record after a write, so the cached queries reading
+ * the table are not used anymore. Writes made inside a transaction change it on commit
+ */
+static int phalcon_mvc_model_bump_version(zval *record TSRMLS_DC)
+{
+	zval *manager = phalcon_fetch_nproperty_this(record, SL("_modelsManager"), PH_NOISY TSRMLS_CC);
+	zval *connection = NULL;
+	int status;
+
+	if (!phalcon_mvc_model_manager_has_versions(manager TSRMLS_CC)) {
+		return SUCCESS;
+	}
+
+	if (phalcon_call_method(&connection, record, "getwriteconnection", 0, NULL TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+
+	status = phalcon_mvc_model_manager_bump_version(manager, record, connection TSRMLS_CC);
+	zval_ptr_dtor(&connection);
+	return status;
+}
+
 /**
  * Phalcon\Mvc\Model constructor
  *
@@ -759,9 +1014,10 @@ PHP_METHOD(Phalcon_Mvc_Model, setConnectionService){
 }
 
 /**
- * Sets the DependencyInjection connection service name used to read data
+ * Sets the DependencyInjection connection service name used to read data,
+ * an array of service names and weights spreads the reads across several replicas
  *
- * @param string $connectionService
+ * @param string|array $connectionService
  * @return Phalcon\Mvc\Model
  */
 PHP_METHOD(Phalcon_Mvc_Model, setReadConnectionService){
@@ -1378,6 +1634,9 @@ PHP_METHOD(Phalcon_Mvc_Model, findFirst){
 	zval *parameters = NULL, *model_name, *params = NULL, *builder;
 	zval *query = NULL, *bind_params = NULL, *bind_types = NULL, *cache;
 	zval *unique, *index, tmp = zval_used_for_init;
+	zval *dependency_injector = NULL, *service_name, *manager = NULL;
+	zval *use_identity_map = NULL, *record = NULL;
+	int f_identity = 0;
 
 	PHALCON_MM_GROW();
 
@@ -1389,6 +1648,36 @@ PHP_METHOD(Phalcon_Mvc_Model, findFirst){
 	
 	PHALCON_INIT_VAR(model_name);
 	phalcon_get_called_class(model_name  TSRMLS_CC);
+	
+	/** 
+	 * Primary key lookups are served by the identity map if the model uses one, the manager is
+	 * only looked up once some model in the request keeps an identity map
+	 */
+	if (PHALCON_GLOBAL(orm).identity_map && Z_TYPE_P(parameters) != IS_ARRAY && Z_TYPE_P(parameters) != IS_NULL && phalcon_is_numeric(parameters)) {
+		PHALCON_CALL_CE_STATIC(&dependency_injector, phalcon_di_ce, "getdefault");
+		if (Z_TYPE_P(dependency_injector) == IS_OBJECT) {
+			PHALCON_INIT_VAR(service_name);
+			ZVAL_STRING(service_name, "modelsManager", 1);
+	
+			PHALCON_CALL_METHOD(&manager, dependency_injector, "getshared", service_name);
+			if (Z_TYPE_P(manager) == IS_OBJECT && instanceof_function(Z_OBJCE_P(manager), phalcon_mvc_model_manager_ce TSRMLS_CC)) {
+	
+				/** 
+				 * Models not initialized yet can't have records in the map
+				 */
+				PHALCON_CALL_METHOD(&use_identity_map, manager, "isusingidentitymap", model_name);
+				if (zend_is_true(use_identity_map)) {
+					f_identity = 1;
+	
+					PHALCON_CALL_METHOD(&record, manager, "getidentityrecord", model_name, parameters);
+					if (Z_TYPE_P(record) == IS_OBJECT) {
+						RETURN_CTOR(record);
+					}
+				}
+			}
+		}
+	}
+	
 	if (Z_TYPE_P(parameters) != IS_ARRAY) { 
 	
 		PHALCON_INIT_VAR(params);
@@ -1472,8 +1761,17 @@ PHP_METHOD(Phalcon_Mvc_Model, findFirst){
 	/** 
 	 * Execute the query passing the bind-params and casting-types
 	 */
-	PHALCON_RETURN_CALL_METHOD(query, "execute", bind_params, bind_types);
-	RETURN_MM();
+	if (!f_identity) {
+		PHALCON_RETURN_CALL_METHOD(query, "execute", bind_params, bind_types);
+		RETURN_MM();
+	}
+	
+	PHALCON_CALL_METHOD(&record, query, "execute", bind_params, bind_types);
+	if (Z_TYPE_P(record) == IS_OBJECT) {
+		PHALCON_CALL_METHOD(NULL, manager, "setidentityrecord", record);
+	}
+	
+	RETURN_CTOR(record);
 }
 
 /**
@@ -1746,7 +2044,45 @@ PHP_METHOD(Phalcon_Mvc_Model, _exists){
 }
 
 /**
- * Generate a PHQL SELECT statement for an aggregate
+ * Checks if the parameters of an aggregate only have conditions, bound parameters and cache options
+ */
+static int phalcon_mvc_model_is_scalar_aggregate(zval *params)
+{
+	HashTable *ah = Z_ARRVAL_P(params);
+	HashPosition hp;
+	zval **value;
+	char *key;
+	uint key_length;
+	ulong index;
+
+	for (
+		zend_hash_internal_pointer_reset_ex(ah, &hp);
+		zend_hash_get_current_data_ex(ah, (void**)&value, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(ah, &hp)
+	) {
+		if (zend_hash_get_current_key_ex(ah, &key, &key_length, &index, 0, &hp) == HASH_KEY_IS_LONG) {
+			if (index != 0) {
+				return 0;
+			}
+		} else if (!strcmp(key, "conditions")) {
+			/* Numeric conditions are primary keys resolved by the builder */
+		} else if (strcmp(key, "column") && strcmp(key, "distinct") && strcmp(key, "bind") && strcmp(key, "bindTypes") && strcmp(key, "cache")) {
+			return 0;
+		} else {
+			continue;
+		}
+
+		if (Z_TYPE_PP(value) != IS_NULL && (Z_TYPE_PP(value) != IS_STRING || phalcon_is_numeric(*value))) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Generate a PHQL SELECT statement for an aggregate. Aggregates without groups
+ * are compiled straight to SQL and return the value without building a resultset
  *
  * @param string $function
  * @param string $alias
@@ -1758,8 +2094,9 @@ PHP_METHOD(Phalcon_Mvc_Model, _groupResult){
 	zval *function, *alias, *parameters, *params = NULL, *group_column = NULL;
 	zval *distinct_column, *columns = NULL, *group_columns;
 	zval *model_name, *builder, *query = NULL, *bind_params = NULL;
-	zval *bind_types = NULL, *resultset = NULL, *cache, *number_rows;
-	zval *first_row = NULL, *value;
+	zval *bind_types = NULL, *resultset = NULL, *cache;
+	zval *first_row = NULL, *value, *phql, *conditions = NULL;
+	zval *dependency_injector = NULL;
 
 	PHALCON_MM_GROW();
 
@@ -1809,17 +2146,6 @@ PHP_METHOD(Phalcon_Mvc_Model, _groupResult){
 	PHALCON_INIT_VAR(model_name);
 	phalcon_get_called_class(model_name  TSRMLS_CC);
 	
-	/** 
-	 * Builds a query with the passed parameters
-	 */
-	PHALCON_INIT_VAR(builder);
-	object_init_ex(builder, phalcon_mvc_model_query_builder_ce);
-	PHALCON_CALL_METHOD(NULL, builder, "__construct", params);
-	
-	PHALCON_CALL_METHOD(NULL, builder, "columns", columns);
-	PHALCON_CALL_METHOD(NULL, builder, "from", model_name);
-	PHALCON_CALL_METHOD(&query, builder, "getquery");
-	
 	/** 
 	 * Check for bind parameters
 	 */
@@ -1837,19 +2163,59 @@ PHP_METHOD(Phalcon_Mvc_Model, _groupResult){
 	}
 	
 	/** 
-	 * Execute the query
+	 * Aggregates returning a single value skip the builder and the resultset
 	 */
-	PHALCON_CALL_METHOD(&resultset, query, "execute", bind_params, bind_types);
+	if (!phalcon_array_isset_string(params, SS("group")) && phalcon_mvc_model_is_scalar_aggregate(params)) {
+	
+		PHALCON_INIT_VAR(phql);
+		PHALCON_CONCAT_SVSVS(phql, "SELECT ", columns, " FROM [", model_name, "]");
+	
+		if (phalcon_array_isset_long_fetch(&conditions, params, 0) || phalcon_array_isset_string_fetch(&conditions, params, SS("conditions"))) {
+			if (PHALCON_IS_NOT_EMPTY(conditions)) {
+				PHALCON_SCONCAT_SV(phql, " WHERE ", conditions);
+			}
+		}
+	
+		PHALCON_CALL_CE_STATIC(&dependency_injector, phalcon_di_ce, "getdefault");
+	
+		PHALCON_INIT_VAR(query);
+		object_init_ex(query, phalcon_mvc_model_query_ce);
+		PHALCON_CALL_METHOD(NULL, query, "__construct", phql, dependency_injector);
+	
+		/** 
+		 * Pass the cache options to the query
+		 */
+		if (phalcon_array_isset_string_fetch(&cache, params, SS("cache"))) {
+			PHALCON_CALL_METHOD(NULL, query, "cache", cache);
+		}
+	
+		PHALCON_RETURN_CALL_METHOD(query, "getscalarresult", bind_params, bind_types);
+		RETURN_MM();
+	}
+	
+	/** 
+	 * Builds a query with the passed parameters
+	 */
+	PHALCON_INIT_VAR(builder);
+	object_init_ex(builder, phalcon_mvc_model_query_builder_ce);
+	PHALCON_CALL_METHOD(NULL, builder, "__construct", params);
+	
+	PHALCON_CALL_METHOD(NULL, builder, "columns", columns);
+	PHALCON_CALL_METHOD(NULL, builder, "from", model_name);
+	PHALCON_CALL_METHOD(&query, builder, "getquery");
 	
 	/** 
 	 * Pass the cache options to the query
 	 */
-	if (phalcon_array_isset_string(params, SS("cache"))) {
-		PHALCON_OBS_VAR(cache);
-		phalcon_array_fetch_string(&cache, params, SL("cache"), PH_NOISY);
+	if (phalcon_array_isset_string_fetch(&cache, params, SS("cache"))) {
 		PHALCON_CALL_METHOD(NULL, query, "cache", cache);
 	}
 	
+	/** 
+	 * Execute the query
+	 */
+	PHALCON_CALL_METHOD(&resultset, query, "execute", bind_params, bind_types);
+	
 	/** 
 	 * Return the full resultset if the query is grouped
 	 */
@@ -1860,8 +2226,6 @@ PHP_METHOD(Phalcon_Mvc_Model, _groupResult){
 	/** 
 	 * Return only the value in the first result
 	 */
-	PHALCON_INIT_VAR(number_rows);
-	phalcon_fast_count(number_rows, resultset TSRMLS_CC);
 	PHALCON_CALL_METHOD(&first_row, resultset, "getfirst");
 	
 	PHALCON_OBS_VAR(value);
@@ -2073,26 +2437,42 @@ PHP_METHOD(Phalcon_Mvc_Model, average){
  */
 PHP_METHOD(Phalcon_Mvc_Model, fireEvent){
 
-	zval **event_name, *models_manager;
+	zval **event_name, *manager, *models_manager;
 	zval *lower;
 	char *tmp;
+	int handlers;
 
 	phalcon_fetch_params_ex(1, 0, &event_name);
 	PHALCON_ENSURE_IS_STRING(event_name);
 
-	PHALCON_MM_GROW();
+	/** 
+	 * Events without methods, behaviors or listeners attached are skipped
+	 */
+	manager  = phalcon_fetch_nproperty_this(this_ptr, SL("_modelsManager"), PH_NOISY TSRMLS_CC);
+	handlers = phalcon_mvc_model_manager_event_handlers(manager, this_ptr, Z_STRVAL_PP(event_name), Z_STRLEN_PP(event_name) TSRMLS_CC);
+	if (!handlers) {
+		RETURN_NULL();
+	}
 
-	PHALCON_INIT_VAR(lower);
-	tmp = zend_str_tolower_dup(Z_STRVAL_PP(event_name), Z_STRLEN_PP(event_name));
-	ZVAL_STRINGL(lower, tmp, Z_STRLEN_PP(event_name), 0);
+	PHALCON_MM_GROW();
 
 	/** 
 	 * Check if there is a method with the same name of the event
 	 */
-	if (phalcon_method_exists_ex(this_ptr, Z_STRVAL_P(lower), Z_STRLEN_P(lower)+1  TSRMLS_CC) == SUCCESS) {
-		PHALCON_CALL_METHOD(NULL, this_ptr, Z_STRVAL_P(lower));
+	if (handlers & PHALCON_MODEL_EVENT_METHOD) {
+		PHALCON_INIT_VAR(lower);
+		tmp = zend_str_tolower_dup(Z_STRVAL_PP(event_name), Z_STRLEN_PP(event_name));
+		ZVAL_STRINGL(lower, tmp, Z_STRLEN_PP(event_name), 0);
+
+		if (phalcon_method_exists_ex(this_ptr, Z_STRVAL_P(lower), Z_STRLEN_P(lower)+1  TSRMLS_CC) == SUCCESS) {
+			PHALCON_CALL_METHOD(NULL, this_ptr, Z_STRVAL_P(lower));
+		}
 	}
 	
+	if (!(handlers & PHALCON_MODEL_EVENT_NOTIFY)) {
+		RETURN_MM_NULL();
+	}
+
 	PHALCON_OBS_VAR(models_manager);
 	phalcon_read_property_this(&models_manager, this_ptr, SL("_modelsManager"), PH_NOISY TSRMLS_CC);
 	
@@ -2112,29 +2492,45 @@ PHP_METHOD(Phalcon_Mvc_Model, fireEvent){
  */
 PHP_METHOD(Phalcon_Mvc_Model, fireEventCancel){
 
-	zval **event_name, *status = NULL, *models_manager;
+	zval **event_name, *status = NULL, *manager, *models_manager;
 	zval *lower;
 	char *tmp;
+	int handlers;
 
 	phalcon_fetch_params_ex(1, 0, &event_name);
 	PHALCON_ENSURE_IS_STRING(event_name);
 
-	PHALCON_MM_GROW();
+	/** 
+	 * Events without methods, behaviors or listeners attached are skipped
+	 */
+	manager  = phalcon_fetch_nproperty_this(this_ptr, SL("_modelsManager"), PH_NOISY TSRMLS_CC);
+	handlers = phalcon_mvc_model_manager_event_handlers(manager, this_ptr, Z_STRVAL_PP(event_name), Z_STRLEN_PP(event_name) TSRMLS_CC);
+	if (!handlers) {
+		RETURN_TRUE;
+	}
 
-	PHALCON_INIT_VAR(lower);
-	tmp = zend_str_tolower_dup(Z_STRVAL_PP(event_name), Z_STRLEN_PP(event_name));
-	ZVAL_STRINGL(lower, tmp, Z_STRLEN_PP(event_name), 0);
+	PHALCON_MM_GROW();
 
 	/**
 	 * Check if there is a method with the same name of the event
 	 */
-	if (phalcon_method_exists_ex(this_ptr, Z_STRVAL_P(lower), Z_STRLEN_P(lower)+1  TSRMLS_CC) == SUCCESS) {
-		PHALCON_CALL_METHOD(&status, this_ptr, Z_STRVAL_P(lower));
-		if (PHALCON_IS_FALSE(status)) {
-			RETURN_MM_FALSE;
+	if (handlers & PHALCON_MODEL_EVENT_METHOD) {
+		PHALCON_INIT_VAR(lower);
+		tmp = zend_str_tolower_dup(Z_STRVAL_PP(event_name), Z_STRLEN_PP(event_name));
+		ZVAL_STRINGL(lower, tmp, Z_STRLEN_PP(event_name), 0);
+
+		if (phalcon_method_exists_ex(this_ptr, Z_STRVAL_P(lower), Z_STRLEN_P(lower)+1  TSRMLS_CC) == SUCCESS) {
+			PHALCON_CALL_METHOD(&status, this_ptr, Z_STRVAL_P(lower));
+			if (PHALCON_IS_FALSE(status)) {
+				RETURN_MM_FALSE;
+			}
 		}
 	}
 	
+	if (!(handlers & PHALCON_MODEL_EVENT_NOTIFY)) {
+		RETURN_MM_TRUE;
+	}
+
 	PHALCON_OBS_VAR(models_manager);
 	phalcon_read_property_this(&models_manager, this_ptr, SL("_modelsManager"), PH_NOISY TSRMLS_CC);
 	
@@ -2402,51 +2798,533 @@ PHP_METHOD(Phalcon_Mvc_Model, getMessages){
 }
 
 /**
- * Reads "belongs to" relations and check the virtual foreign keys when inserting or updating records
- * to verify that inserted/updated values are present in the related entity
- *
- * @return boolean
+ * Builds array(referencedModel, referencedFields, values, conditions) describing the rows a virtual
+ * foreign key looks for, the values are read from the fields of the relation in the record
  */
-PHP_METHOD(Phalcon_Mvc_Model, _checkForeignKeysRestrict){
-
-	zval *manager, *belongs_to = NULL, *error = NULL, *relation = NULL, *foreign_key = NULL;
-	zval *action = NULL, *relation_class = NULL, *referenced_model = NULL;
-	zval *conditions = NULL, *bind_params = NULL, *fields = NULL, *referenced_fields = NULL;
-	zval *field = NULL, *position = NULL, *value = NULL, *referenced_field = NULL;
-	zval *condition = NULL, *extra_conditions = NULL, *join_conditions = NULL;
-	zval *parameters = NULL, *rowcount = NULL, *user_message = NULL, *joined_fields = NULL;
-	zval *type = NULL, *message = NULL, *event_name;
-	HashTable *ah0, *ah1;
-	HashPosition hp0, hp1;
+static void phalcon_mvc_model_foreign_key_check(zval *return_value, zval *this_ptr, zval *referenced_model, zval *relation, zval *foreign_key TSRMLS_DC)
+{
+	zval *fields = NULL, *referenced_fields = NULL, *field_list = NULL, *referenced_list = NULL;
+	zval *values, *field = NULL, *value = NULL, *extra_conditions;
+	HashTable *ah0;
+	HashPosition hp0;
 	zval **hd;
 
 	PHALCON_MM_GROW();
 
+	PHALCON_CALL_METHOD(&fields, relation, "getfields");
+	PHALCON_CALL_METHOD(&referenced_fields, relation, "getreferencedfields");
+
 	/** 
-	 * Get the models manager
-	 */
-	PHALCON_OBS_VAR(manager);
-	phalcon_read_property_this(&manager, this_ptr, SL("_modelsManager"), PH_NOISY TSRMLS_CC);
-	
-	/** 
-	 * We check if some of the belongsTo relations act as virtual foreign key
+	 * A relation can have many fields or a single one
 	 */
-	PHALCON_CALL_METHOD(&belongs_to, manager, "getbelongsto", this_ptr);
-	if (phalcon_fast_count_ev(belongs_to TSRMLS_CC)) {
-	
-		PHALCON_INIT_VAR(error);
-		ZVAL_BOOL(error, 0);
-	
-		phalcon_is_iterable(belongs_to, &ah0, &hp0, 0, 0);
-	
-		while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
-	
-			PHALCON_GET_HVALUE(relation);
-	
-			PHALCON_CALL_METHOD(&foreign_key, relation, "getforeignkey");
-			if (PHALCON_IS_NOT_FALSE(foreign_key)) {
-	
-				/** 
+	if (Z_TYPE_P(fields) == IS_ARRAY) {
+		PHALCON_CPY_WRT(field_list, fields);
+		PHALCON_CPY_WRT(referenced_list, referenced_fields);
+	} else {
+		PHALCON_INIT_VAR(field_list);
+		array_init_size(field_list, 1);
+		phalcon_array_append(&field_list, fields, 0);
+
+		PHALCON_INIT_VAR(referenced_list);
+		array_init_size(referenced_list, 1);
+		phalcon_array_append(&referenced_list, referenced_fields, 0);
+	}
+
+	PHALCON_INIT_VAR(values);
+	array_init(values);
+
+	phalcon_is_iterable(field_list, &ah0, &hp0, 0, 0);
+
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+		PHALCON_GET_HVALUE(field);
+
+		if (phalcon_isset_property_zval(this_ptr, field TSRMLS_CC)) {
+			PHALCON_OBS_NVAR(value);
+			phalcon_read_property_zval(&value, this_ptr, field, PH_NOISY TSRMLS_CC);
+		} else {
+			PHALCON_INIT_NVAR(value);
+		}
+
+		phalcon_array_append(&values, value, PH_SEPARATE);
+
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+
+	array_init_size(return_value, 4);
+	phalcon_array_append(&return_value, referenced_model, 0);
+	phalcon_array_append(&return_value, referenced_list, 0);
+	phalcon_array_append(&return_value, values, 0);
+
+	/** 
+	 * Extra conditions of the virtual foreign key are PHQL
+	 */
+	if (Z_TYPE_P(foreign_key) == IS_ARRAY && phalcon_array_isset_string_fetch(&extra_conditions, foreign_key, SS("conditions"))) {
+		phalcon_array_append(&return_value, extra_conditions, 0);
+	} else {
+		add_next_index_null(return_value);
+	}
+
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Builds the parameters for find()/count() returning the rows described by a foreign key check.
+ * We don't trust the actual values in the object and pass them using bound parameters
+ */
+static void phalcon_mvc_model_foreign_key_parameters(zval *return_value, zval *check TSRMLS_DC)
+{
+	zval *referenced_fields, *values, *extra_conditions, *conditions;
+	zval *referenced_field = NULL, *position, *condition = NULL, *join_conditions;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+	long int i = 0;
+
+	PHALCON_MM_GROW();
+
+	phalcon_array_isset_long_fetch(&referenced_fields, check, 1);
+	phalcon_array_isset_long_fetch(&values, check, 2);
+	phalcon_array_isset_long_fetch(&extra_conditions, check, 3);
+
+	PHALCON_INIT_VAR(conditions);
+	array_init(conditions);
+
+	PHALCON_INIT_VAR(position);
+
+	phalcon_is_iterable(referenced_fields, &ah0, &hp0, 0, 0);
+
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+		PHALCON_GET_HVALUE(referenced_field);
+
+		ZVAL_LONG(position, i++);
+
+		PHALCON_INIT_NVAR(condition);
+		PHALCON_CONCAT_SVSV(condition, "[", referenced_field, "] = ?", position);
+		phalcon_array_append(&conditions, condition, 0);
+
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+
+	if (Z_TYPE_P(extra_conditions) != IS_NULL) {
+		phalcon_array_append(&conditions, extra_conditions, 0);
+	}
+
+	PHALCON_INIT_VAR(join_conditions);
+	phalcon_fast_join_str(join_conditions, SL(" AND "), conditions TSRMLS_CC);
+
+	array_init_size(return_value, 2);
+	phalcon_array_append(&return_value, join_conditions, 0);
+	phalcon_array_update_string(&return_value, SL("bind"), values, PH_COPY);
+
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Builds the escaped table and the SQL conditions matching the rows described by a foreign key check,
+ * the values of the conditions are appended to the bind parameters
+ */
+static void phalcon_mvc_model_foreign_key_sql(zval *table_sql, zval *where_sql, zval *bind_params, zval *connection, zval *check TSRMLS_DC)
+{
+	zval *referenced_model, *referenced_fields, *values, *meta_data = NULL, *column_map = NULL;
+	zval *schema = NULL, *source = NULL, *table, *escaped_table = NULL, *referenced_field = NULL;
+	zval *column = NULL, *escaped_column = NULL, *value = NULL, *conditions, *condition = NULL;
+	zval *exception_message;
+	HashTable *ah0, *ah1;
+	HashPosition hp0, hp1;
+	zval **hd;
+	int escape = PHALCON_GLOBAL(db).escape_identifiers;
+
+	PHALCON_MM_GROW();
+
+	phalcon_array_isset_long_fetch(&referenced_model, check, 0);
+	phalcon_array_isset_long_fetch(&referenced_fields, check, 1);
+	phalcon_array_isset_long_fetch(&values, check, 2);
+
+	PHALCON_CALL_METHOD(&schema, referenced_model, "getschema");
+	PHALCON_CALL_METHOD(&source, referenced_model, "getsource");
+	if (zend_is_true(schema)) {
+		if (escape) {
+			PHALCON_INIT_VAR(table);
+			array_init_size(table, 2);
+			phalcon_array_append(&table, schema, 0);
+			phalcon_array_append(&table, source, 0);
+			PHALCON_CALL_METHOD(&escaped_table, connection, "escapeidentifier", table);
+		} else {
+			PHALCON_INIT_VAR(escaped_table);
+			PHALCON_CONCAT_VSV(escaped_table, schema, ".", source);
+		}
+	} else {
+		if (escape) {
+			PHALCON_CALL_METHOD(&escaped_table, connection, "escapeidentifier", source);
+		} else {
+			PHALCON_CPY_WRT(escaped_table, source);
+		}
+	}
+
+	ZVAL_ZVAL(table_sql, escaped_table, 1, 0);
+
+	/** 
+	 * The relation uses attributes, the conditions need the columns
+	 */
+	if (PHALCON_GLOBAL(orm).column_renaming) {
+		PHALCON_CALL_METHOD(&meta_data, referenced_model, "getmodelsmetadata");
+		PHALCON_CALL_METHOD(&column_map, meta_data, "getreversecolumnmap", referenced_model);
+	} else {
+		PHALCON_INIT_VAR(column_map);
+	}
+
+	PHALCON_INIT_VAR(conditions);
+	array_init(conditions);
+
+	phalcon_is_iterable(referenced_fields, &ah0, &hp0, 0, 0);
+	phalcon_is_iterable(values, &ah1, &hp1, 0, 0);
+
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+		PHALCON_GET_HVALUE(referenced_field);
+
+		if (Z_TYPE_P(column_map) == IS_ARRAY) {
+			if (!phalcon_array_isset(column_map, referenced_field)) {
+				PHALCON_INIT_VAR(exception_message);
+				PHALCON_CONCAT_SVS(exception_message, "Column '", referenced_field, "' isn't part of the column map");
+				PHALCON_THROW_EXCEPTION_ZVAL(phalcon_mvc_model_exception_ce, exception_message);
+				return;
+			}
+
+			PHALCON_OBS_NVAR(column);
+			phalcon_array_fetch(&column, column_map, referenced_field, PH_NOISY);
+		} else {
+			PHALCON_CPY_WRT(column, referenced_field);
+		}
+
+		if (escape) {
+			PHALCON_CALL_METHOD(&escaped_column, connection, "escapeidentifier", column);
+		} else {
+			PHALCON_CPY_WRT(escaped_column, column);
+		}
+
+		PHALCON_INIT_NVAR(condition);
+		PHALCON_CONCAT_VS(condition, escaped_column, " = ?");
+		phalcon_array_append(&conditions, condition, 0);
+
+		if (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
+			PHALCON_GET_HVALUE(value);
+		} else {
+			PHALCON_INIT_NVAR(value);
+		}
+
+		phalcon_array_append(&bind_params, value, 0);
+
+		zend_hash_move_forward_ex(ah0, &hp0);
+		zend_hash_move_forward_ex(ah1, &hp1);
+	}
+
+	phalcon_fast_join_str(where_sql, SL(" AND "), conditions TSRMLS_CC);
+
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Checks whether the rows described by a list of foreign key checks exist, returning a boolean per check.
+ * Checks without extra conditions over models read from the same connection are sent in a single query,
+ * the rest are counted one by one
+ */
+static void phalcon_mvc_model_foreign_keys_exist(zval *return_value, zval *manager, zval *checks TSRMLS_DC)
+{
+	zval *batched = NULL, *others = NULL, *position = NULL, *check = NULL;
+	zval *referenced_model, *extra_conditions, *shards = NULL, *service = NULL, *batch_service = NULL;
+	zval *parameters = NULL, *rowcount = NULL, *exists = NULL, *connection = NULL, *queries, *bind_params;
+	zval *table_sql = NULL, *where_sql = NULL, *query = NULL, *dialect = NULL, *sql = NULL;
+	zval *fetch_num, *row = NULL, *value;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+	int batchable;
+	long int i;
+
+	PHALCON_MM_GROW();
+
+	array_init(return_value);
+
+	PHALCON_INIT_VAR(batched);
+	array_init(batched);
+
+	PHALCON_INIT_VAR(others);
+	array_init(others);
+
+	phalcon_is_iterable(checks, &ah0, &hp0, 0, 0);
+
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+		PHALCON_GET_HKEY(position, ah0, hp0);
+		PHALCON_GET_HVALUE(check);
+
+		phalcon_array_isset_long_fetch(&referenced_model, check, 0);
+		phalcon_array_isset_long_fetch(&extra_conditions, check, 3);
+
+		/** 
+		 * PHQL conditions and sharded models can only be checked using count()
+		 */
+		batchable = Z_TYPE_P(extra_conditions) == IS_NULL && Z_TYPE_P(manager) == IS_OBJECT && instanceof_function(Z_OBJCE_P(manager), phalcon_mvc_model_manager_ce TSRMLS_CC);
+		if (batchable) {
+			PHALCON_CALL_METHOD(&shards, manager, "getshards", referenced_model);
+			batchable = Z_TYPE_P(shards) == IS_NULL;
+		}
+
+		if (batchable) {
+			PHALCON_CALL_METHOD(&service, manager, "getreadconnectionservice", referenced_model);
+			if (!batch_service) {
+				PHALCON_CPY_WRT(batch_service, service);
+			} else {
+				batchable = PHALCON_IS_EQUAL(service, batch_service);
+			}
+		}
+
+		if (batchable) {
+			phalcon_array_update_zval(&batched, position, check, PH_COPY);
+		} else {
+			phalcon_array_update_zval(&others, position, check, PH_COPY);
+		}
+
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+
+	/** 
+	 * There is nothing to gain batching a single check
+	 */
+	if (zend_hash_num_elements(Z_ARRVAL_P(batched)) == 1) {
+		PHALCON_CPY_WRT(others, checks);
+
+		PHALCON_INIT_NVAR(batched);
+		array_init(batched);
+	}
+
+	phalcon_is_iterable(others, &ah0, &hp0, 0, 0);
+
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+		PHALCON_GET_HKEY(position, ah0, hp0);
+		PHALCON_GET_HVALUE(check);
+
+		phalcon_array_isset_long_fetch(&referenced_model, check, 0);
+
+		PHALCON_INIT_NVAR(parameters);
+		phalcon_mvc_model_foreign_key_parameters(parameters, check TSRMLS_CC);
+
+		PHALCON_CALL_METHOD(&rowcount, referenced_model, "count", parameters);
+
+		PHALCON_INIT_NVAR(exists);
+		ZVAL_BOOL(exists, zend_is_true(rowcount));
+		phalcon_array_update_zval(&return_value, position, exists, PH_COPY);
+
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+
+	if (zend_hash_num_elements(Z_ARRVAL_P(batched))) {
+
+		PHALCON_INIT_VAR(queries);
+		array_init(queries);
+
+		PHALCON_INIT_VAR(bind_params);
+		array_init(bind_params);
+
+		phalcon_is_iterable(batched, &ah0, &hp0, 0, 0);
+
+		while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+			PHALCON_GET_HVALUE(check);
+
+			if (!connection) {
+				phalcon_array_isset_long_fetch(&referenced_model, check, 0);
+				PHALCON_CALL_METHOD(&connection, referenced_model, "getreadconnection");
+			}
+
+			PHALCON_INIT_NVAR(table_sql);
+			PHALCON_INIT_NVAR(where_sql);
+			phalcon_mvc_model_foreign_key_sql(table_sql, where_sql, bind_params, connection, check TSRMLS_CC);
+			if (EG(exception)) {
+				RETURN_MM();
+			}
+
+			PHALCON_INIT_NVAR(query);
+			PHALCON_CONCAT_SVSV(query, "SELECT 1 FROM ", table_sql, " WHERE ", where_sql);
+			phalcon_array_append(&queries, query, 0);
+
+			zend_hash_move_forward_ex(ah0, &hp0);
+		}
+
+		/** 
+		 * Every referenced row is looked for in a single query
+		 */
+		PHALCON_CALL_METHOD(&dialect, connection, "getdialect");
+		PHALCON_CALL_METHOD(&sql, dialect, "existsmultiple", queries);
+
+		PHALCON_INIT_VAR(fetch_num);
+		ZVAL_LONG(fetch_num, PDO_FETCH_NUM);
+
+		PHALCON_CALL_METHOD(&row, connection, "fetchone", sql, fetch_num, bind_params);
+
+		i = 0;
+
+		phalcon_is_iterable(batched, &ah0, &hp0, 0, 0);
+
+		while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+			PHALCON_GET_HKEY(position, ah0, hp0);
+
+			PHALCON_INIT_NVAR(exists);
+			ZVAL_BOOL(exists, Z_TYPE_P(row) == IS_ARRAY && phalcon_array_isset_long_fetch(&value, row, i) && zend_is_true(value));
+			phalcon_array_update_zval(&return_value, position, exists, PH_COPY);
+
+			++i;
+			zend_hash_move_forward_ex(ah0, &hp0);
+		}
+	}
+
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Deletes the rows described by a foreign key check using a single statement. This is only possible when
+ * the referenced model doesn't have per-record events, behaviors or virtual foreign keys, otherwise null
+ * is returned and the records must be deleted one by one
+ */
+static void phalcon_mvc_model_foreign_key_delete(zval *return_value, zval *manager, zval *check TSRMLS_DC)
+{
+	zval *referenced_model, *extra_conditions, *shards = NULL, *observed = NULL;
+	zval *relations = NULL, *relation = NULL, *foreign_key = NULL, *connection = NULL;
+	zval *table_sql, *where_sql, *bind_params, *sql, *success = NULL, *identity_map = NULL;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+
+	PHALCON_MM_GROW();
+
+	phalcon_array_isset_long_fetch(&referenced_model, check, 0);
+	phalcon_array_isset_long_fetch(&extra_conditions, check, 3);
+
+	if (Z_TYPE_P(extra_conditions) != IS_NULL || Z_TYPE_P(manager) != IS_OBJECT || !instanceof_function(Z_OBJCE_P(manager), phalcon_mvc_model_manager_ce TSRMLS_CC)) {
+		RETURN_MM_NULL();
+	}
+
+	PHALCON_CALL_METHOD(&shards, manager, "getshards", referenced_model);
+	if (Z_TYPE_P(shards) != IS_NULL) {
+		RETURN_MM_NULL();
+	}
+
+	if (PHALCON_GLOBAL(orm).events) {
+		if (phalcon_method_exists_ex(referenced_model, SS("beforedelete") TSRMLS_CC) == SUCCESS || phalcon_method_exists_ex(referenced_model, SS("afterdelete") TSRMLS_CC) == SUCCESS) {
+			RETURN_MM_NULL();
+		}
+
+		PHALCON_CALL_METHOD(&observed, manager, "isobserved", referenced_model);
+		if (zend_is_true(observed)) {
+			RETURN_MM_NULL();
+		}
+	}
+
+	if (PHALCON_GLOBAL(orm).virtual_foreign_keys) {
+		PHALCON_CALL_METHOD(&relations, manager, "gethasoneandhasmany", referenced_model);
+		if (Z_TYPE_P(relations) == IS_ARRAY) {
+
+			phalcon_is_iterable(relations, &ah0, &hp0, 0, 0);
+
+			while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+				PHALCON_GET_HVALUE(relation);
+
+				PHALCON_CALL_METHOD(&foreign_key, relation, "getforeignkey");
+				if (PHALCON_IS_NOT_FALSE(foreign_key)) {
+					RETURN_MM_NULL();
+				}
+
+				zend_hash_move_forward_ex(ah0, &hp0);
+			}
+		}
+	}
+
+	PHALCON_CALL_METHOD(&connection, referenced_model, "getwriteconnection");
+
+	PHALCON_INIT_VAR(table_sql);
+	PHALCON_INIT_VAR(where_sql);
+
+	PHALCON_INIT_VAR(bind_params);
+	array_init(bind_params);
+
+	phalcon_mvc_model_foreign_key_sql(table_sql, where_sql, bind_params, connection, check TSRMLS_CC);
+	if (EG(exception)) {
+		RETURN_MM();
+	}
+
+	PHALCON_INIT_VAR(sql);
+	PHALCON_CONCAT_SVSV(sql, "DELETE FROM ", table_sql, " WHERE ", where_sql);
+
+	PHALCON_CALL_METHOD(&success, connection, "execute", sql, bind_params);
+	if (zend_is_true(success)) {
+		RETURN_MM_ON_FAILURE(phalcon_mvc_model_bump_version(referenced_model TSRMLS_CC));
+
+		/** 
+		 * Mapped instances of the deleted records are stale now
+		 */
+		PHALCON_CALL_METHOD(&identity_map, manager, "isusingidentitymap", referenced_model);
+		if (zend_is_true(identity_map)) {
+			PHALCON_CALL_METHOD(NULL, manager, "clearidentitymap", referenced_model);
+		}
+	}
+
+	RETURN_MM_BOOL(zend_is_true(success));
+}
+
+/**
+ * Reads "belongs to" relations and check the virtual foreign keys when inserting or updating records
+ * to verify that inserted/updated values are present in the related entity
+ *
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model, _checkForeignKeysRestrict){
+
+	zval *manager, *belongs_to = NULL, *relation = NULL, *foreign_key = NULL;
+	zval *action = NULL, *relation_class = NULL, *referenced_model = NULL;
+	zval *checks, *checked, *check = NULL, *existing, *exists, *failed_relation;
+	zval *fields = NULL, *user_message = NULL, *joined_fields = NULL;
+	zval *type, *message, *event_name;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+	long int i, number_checks;
+
+	PHALCON_MM_GROW();
+
+	/** 
+	 * Get the models manager
+	 */
+	PHALCON_OBS_VAR(manager);
+	phalcon_read_property_this(&manager, this_ptr, SL("_modelsManager"), PH_NOISY TSRMLS_CC);
+	
+	/** 
+	 * We check if some of the belongsTo relations act as virtual foreign key
+	 */
+	PHALCON_CALL_METHOD(&belongs_to, manager, "getbelongsto", this_ptr);
+	if (phalcon_fast_count_ev(belongs_to TSRMLS_CC)) {
+	
+		PHALCON_INIT_VAR(checks);
+		array_init(checks);
+	
+		PHALCON_INIT_VAR(checked);
+		array_init(checked);
+	
+		phalcon_is_iterable(belongs_to, &ah0, &hp0, 0, 0);
+	
+		while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+			PHALCON_GET_HVALUE(relation);
+	
+			PHALCON_CALL_METHOD(&foreign_key, relation, "getforeignkey");
+			if (PHALCON_IS_NOT_FALSE(foreign_key)) {
+	
+				/** 
 				 * By default action is restrict
 				 */
 				PHALCON_INIT_NVAR(action);
@@ -2473,137 +3351,79 @@ PHP_METHOD(Phalcon_Mvc_Model, _checkForeignKeysRestrict){
 					 */
 					PHALCON_CALL_METHOD(&referenced_model, manager, "load", relation_class);
 	
-					/** 
-					 * Since relations can have multiple columns or a single one, we need to build a
-					 * condition for each of these cases
-					 */
-					PHALCON_INIT_NVAR(conditions);
-					array_init(conditions);
-	
-					PHALCON_INIT_NVAR(bind_params);
-					array_init(bind_params);
-	
-					PHALCON_CALL_METHOD(&fields, relation, "getfields");
-					PHALCON_CALL_METHOD(&referenced_fields, relation, "getreferencedfields");
-					if (Z_TYPE_P(fields) == IS_ARRAY) { 
-	
-						/** 
-						 * Create a compound condition
-						 */
-						phalcon_is_iterable(fields, &ah1, &hp1, 0, 0);
-	
-						while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
-	
-							PHALCON_GET_HKEY(position, ah1, hp1);
-							PHALCON_GET_HVALUE(field);
-	
-							if (phalcon_isset_property_zval(this_ptr, field TSRMLS_CC)) {
-								PHALCON_OBS_NVAR(value);
-								phalcon_read_property_zval(&value, this_ptr, field, PH_NOISY TSRMLS_CC);
-							} else {
-								PHALCON_INIT_NVAR(value);
-							}
-	
-							PHALCON_OBS_NVAR(referenced_field);
-							phalcon_array_fetch(&referenced_field, referenced_fields, position, PH_NOISY);
-	
-							PHALCON_INIT_NVAR(condition);
-							PHALCON_CONCAT_SVSV(condition, "[", referenced_field, "] = ?", position);
-							phalcon_array_append(&conditions, condition, PH_SEPARATE);
-							phalcon_array_append(&bind_params, value, PH_SEPARATE);
-	
-							zend_hash_move_forward_ex(ah1, &hp1);
-						}
-	
-					} else {
-						/** 
-						 * Create a simple condition
-						 */
-						if (phalcon_isset_property_zval(this_ptr, fields TSRMLS_CC)) {
-							PHALCON_OBS_NVAR(value);
-							phalcon_read_property_zval(&value, this_ptr, fields, PH_NOISY TSRMLS_CC);
-						} else {
-							PHALCON_INIT_NVAR(value);
-						}
-	
-						PHALCON_INIT_NVAR(condition);
-						PHALCON_CONCAT_SVS(condition, "[", referenced_fields, "] = ?0");
-						phalcon_array_append(&conditions, condition, PH_SEPARATE);
-						phalcon_array_append(&bind_params, value, PH_SEPARATE);
+					PHALCON_INIT_NVAR(check);
+					phalcon_mvc_model_foreign_key_check(check, this_ptr, referenced_model, relation, foreign_key TSRMLS_CC);
+					if (EG(exception)) {
+						RETURN_MM();
 					}
 	
-					/** 
-					 * Check if the virtual foreign key has extra conditions
-					 */
-					if (phalcon_array_isset_string(foreign_key, SS("conditions"))) {
-						PHALCON_OBS_NVAR(extra_conditions);
-						phalcon_array_fetch_string(&extra_conditions, foreign_key, SL("conditions"), PH_NOISY);
-						phalcon_array_append(&conditions, extra_conditions, PH_SEPARATE);
-					}
+					phalcon_array_append(&checks, check, 0);
+					phalcon_array_append(&checked, relation, 0);
+				}
+			}
 	
-					/** 
-					 * We don't trust the actual values in the object and pass the values using bound
-					 * parameters
-					 */
-					PHALCON_INIT_NVAR(join_conditions);
-					phalcon_fast_join_str(join_conditions, SL(" AND "), conditions TSRMLS_CC);
+			zend_hash_move_forward_ex(ah0, &hp0);
+		}
 	
-					PHALCON_INIT_NVAR(parameters);
-					array_init_size(parameters, 2);
-					phalcon_array_append(&parameters, join_conditions, 0);
-					phalcon_array_update_string(&parameters, SL("bind"), bind_params, PH_COPY);
+		number_checks = zend_hash_num_elements(Z_ARRVAL_P(checks));
+		if (!number_checks) {
+			RETURN_MM_TRUE;
+		}
 	
-					/** 
-					 * Let's make the checking
-					 */
-					PHALCON_CALL_METHOD(&rowcount, referenced_model, "count", parameters);
-					if (!zend_is_true(rowcount)) {
+		/** 
+		 * Let's make the checking, the referenced rows are looked for at once
+		 */
+		PHALCON_INIT_VAR(existing);
+		phalcon_mvc_model_foreign_keys_exist(existing, manager, checks TSRMLS_CC);
+		if (EG(exception)) {
+			RETURN_MM();
+		}
 	
-						/** 
-						 * Get the user message or produce a new one
-						 */
-						if (phalcon_array_isset_string(foreign_key, SS("message"))) {
-							PHALCON_OBS_NVAR(user_message);
-							phalcon_array_fetch_string(&user_message, foreign_key, SL("message"), PH_NOISY);
-						} else {
-							if (Z_TYPE_P(fields) == IS_ARRAY) { 
-								PHALCON_INIT_NVAR(joined_fields);
-								phalcon_fast_join_str(joined_fields, SL(", "), fields TSRMLS_CC);
+		for (i = 0; i < number_checks; ++i) {
 	
-								PHALCON_INIT_NVAR(user_message);
-								PHALCON_CONCAT_SVS(user_message, "Value of fields \"", joined_fields, "\" does not exist on referenced table");
-							} else {
-								PHALCON_INIT_NVAR(user_message);
-								PHALCON_CONCAT_SVS(user_message, "Value of field \"", fields, "\" does not exist on referenced table");
-							}
-						}
+			if (!phalcon_array_isset_long_fetch(&exists, existing, i) || zend_is_true(exists)) {
+				continue;
+			}
 	
-						/** 
-						 * Create a message
-						 */
-						PHALCON_INIT_NVAR(type);
-						ZVAL_STRING(type, "ConstraintViolation", 1);
+			phalcon_array_isset_long_fetch(&failed_relation, checked, i);
 	
-						PHALCON_INIT_NVAR(message);
-						object_init_ex(message, phalcon_mvc_model_message_ce);
-						PHALCON_CALL_METHOD(NULL, message, "__construct", user_message, fields, type);
+			PHALCON_CALL_METHOD(&foreign_key, failed_relation, "getforeignkey");
+			PHALCON_CALL_METHOD(&fields, failed_relation, "getfields");
 	
-						PHALCON_CALL_METHOD(NULL, this_ptr, "appendmessage", message);
+			/** 
+			 * Get the user message or produce a new one
+			 */
+			if (Z_TYPE_P(foreign_key) == IS_ARRAY && phalcon_array_isset_string(foreign_key, SS("message"))) {
+				PHALCON_OBS_NVAR(user_message);
+				phalcon_array_fetch_string(&user_message, foreign_key, SL("message"), PH_NOISY);
+			} else {
+				if (Z_TYPE_P(fields) == IS_ARRAY) { 
+					PHALCON_INIT_NVAR(joined_fields);
+					phalcon_fast_join_str(joined_fields, SL(", "), fields TSRMLS_CC);
 	
-						PHALCON_INIT_NVAR(error);
-						ZVAL_BOOL(error, 1);
-						break;
-					}
+					PHALCON_INIT_NVAR(user_message);
+					PHALCON_CONCAT_SVS(user_message, "Value of fields \"", joined_fields, "\" does not exist on referenced table");
+				} else {
+					PHALCON_INIT_NVAR(user_message);
+					PHALCON_CONCAT_SVS(user_message, "Value of field \"", fields, "\" does not exist on referenced table");
 				}
 			}
 	
-			zend_hash_move_forward_ex(ah0, &hp0);
-		}
+			/** 
+			 * Create a message
+			 */
+			PHALCON_INIT_VAR(type);
+			ZVAL_STRING(type, "ConstraintViolation", 1);
 	
-		/** 
-		 * Call 'onValidationFails' if the validation fails
-		 */
-		if (PHALCON_IS_TRUE(error)) {
+			PHALCON_INIT_VAR(message);
+			object_init_ex(message, phalcon_mvc_model_message_ce);
+			PHALCON_CALL_METHOD(NULL, message, "__construct", user_message, fields, type);
+	
+			PHALCON_CALL_METHOD(NULL, this_ptr, "appendmessage", message);
+	
+			/** 
+			 * Call 'onValidationFails' if the validation fails
+			 */
 			if (PHALCON_GLOBAL(orm).events) {
 				PHALCON_INIT_VAR(event_name);
 				ZVAL_STRING(event_name, "onValidationFails", 1);
@@ -2624,16 +3444,14 @@ PHP_METHOD(Phalcon_Mvc_Model, _checkForeignKeysRestrict){
  */
 PHP_METHOD(Phalcon_Mvc_Model, _checkForeignKeysReverseRestrict){
 
-	zval *manager, *relations = NULL, *error = NULL, *relation = NULL, *foreign_key = NULL;
+	zval *manager, *relations = NULL, *relation = NULL, *foreign_key = NULL;
 	zval *action = NULL, *relation_class = NULL, *referenced_model = NULL;
-	zval *fields = NULL, *referenced_fields = NULL, *conditions = NULL;
-	zval *bind_params = NULL, *field = NULL, *position = NULL, *value = NULL, *referenced_field = NULL;
-	zval *condition = NULL, *extra_conditions = NULL, *join_conditions = NULL;
-	zval *parameters = NULL, *rowcount = NULL, *user_message = NULL, *type = NULL;
-	zval *message = NULL, *event_name;
-	HashTable *ah0, *ah1;
-	HashPosition hp0, hp1;
+	zval *checks, *checked, *check = NULL, *existing, *exists, *failed_relation;
+	zval *fields = NULL, *user_message = NULL, *type, *message, *event_name;
+	HashTable *ah0;
+	HashPosition hp0;
 	zval **hd;
+	long int i, number_checks;
 
 	PHALCON_MM_GROW();
 
@@ -2649,8 +3467,11 @@ PHP_METHOD(Phalcon_Mvc_Model, _checkForeignKeysReverseRestrict){
 	PHALCON_CALL_METHOD(&relations, manager, "gethasoneandhasmany", this_ptr);
 	if (phalcon_fast_count_ev(relations TSRMLS_CC)) {
 	
-		PHALCON_INIT_VAR(error);
-		ZVAL_BOOL(error, 0);
+		PHALCON_INIT_VAR(checks);
+		array_init(checks);
+	
+		PHALCON_INIT_VAR(checked);
+		array_init(checked);
 	
 		phalcon_is_iterable(relations, &ah0, &hp0, 0, 0);
 	
@@ -2691,122 +3512,74 @@ PHP_METHOD(Phalcon_Mvc_Model, _checkForeignKeysReverseRestrict){
 					 * Load a plain instance from the models manager
 					 */
 					PHALCON_CALL_METHOD(&referenced_model, manager, "load", relation_class);
-					PHALCON_CALL_METHOD(&fields, relation, "getfields");
-					PHALCON_CALL_METHOD(&referenced_fields, relation, "getreferencedfields");
-	
-					/** 
-					 * Create the checking conditions. A relation can has many fields or a single one
-					 */
-					PHALCON_INIT_NVAR(conditions);
-					array_init(conditions);
-	
-					PHALCON_INIT_NVAR(bind_params);
-					array_init(bind_params);
-					if (Z_TYPE_P(fields) == IS_ARRAY) { 
-	
-						phalcon_is_iterable(fields, &ah1, &hp1, 0, 0);
-	
-						while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
-	
-							PHALCON_GET_HKEY(position, ah1, hp1);
-							PHALCON_GET_HVALUE(field);
 	
-							if (phalcon_isset_property_zval(this_ptr, field TSRMLS_CC)) {
-								PHALCON_OBS_NVAR(value);
-								phalcon_read_property_zval(&value, this_ptr, field, PH_NOISY TSRMLS_CC);
-							} else {
-								PHALCON_INIT_NVAR(value);
-							}
-	
-							PHALCON_OBS_NVAR(referenced_field);
-							phalcon_array_fetch(&referenced_field, referenced_fields, position, PH_NOISY);
-	
-							PHALCON_INIT_NVAR(condition);
-							PHALCON_CONCAT_SVSV(condition, "[", referenced_field, "] = ?", position);
-							phalcon_array_append(&conditions, condition, PH_SEPARATE);
-							phalcon_array_append(&bind_params, value, PH_SEPARATE);
+					PHALCON_INIT_NVAR(check);
+					phalcon_mvc_model_foreign_key_check(check, this_ptr, referenced_model, relation, foreign_key TSRMLS_CC);
+					if (EG(exception)) {
+						RETURN_MM();
+					}
 	
-							zend_hash_move_forward_ex(ah1, &hp1);
-						}
+					phalcon_array_append(&checks, check, 0);
+					phalcon_array_append(&checked, relation, 0);
+				}
+			}
 	
-					} else {
-						if (phalcon_isset_property_zval(this_ptr, fields TSRMLS_CC)) {
-							PHALCON_OBS_NVAR(value);
-							phalcon_read_property_zval(&value, this_ptr, fields, PH_NOISY TSRMLS_CC);
-						} else {
-							PHALCON_INIT_NVAR(value);
-						}
+			zend_hash_move_forward_ex(ah0, &hp0);
+		}
 	
-						PHALCON_INIT_NVAR(condition);
-						PHALCON_CONCAT_SVS(condition, "[", referenced_fields, "] = ?0");
-						phalcon_array_append(&conditions, condition, PH_SEPARATE);
-						phalcon_array_append(&bind_params, value, PH_SEPARATE);
-					}
+		number_checks = zend_hash_num_elements(Z_ARRVAL_P(checks));
+		if (!number_checks) {
+			RETURN_MM_TRUE;
+		}
 	
-					/** 
-					 * Check if the virtual foreign key has extra conditions
-					 */
-					if (phalcon_array_isset_string(foreign_key, SS("conditions"))) {
-						PHALCON_OBS_NVAR(extra_conditions);
-						phalcon_array_fetch_string(&extra_conditions, foreign_key, SL("conditions"), PH_NOISY);
-						phalcon_array_append(&conditions, extra_conditions, PH_SEPARATE);
-					}
+		/** 
+		 * Let's make the checking, the referencing rows are looked for at once
+		 */
+		PHALCON_INIT_VAR(existing);
+		phalcon_mvc_model_foreign_keys_exist(existing, manager, checks TSRMLS_CC);
+		if (EG(exception)) {
+			RETURN_MM();
+		}
 	
-					/** 
-					 * We don't trust the actual values in the object and then we're passing the values
-					 * using bound parameters
-					 */
-					PHALCON_INIT_NVAR(join_conditions);
-					phalcon_fast_join_str(join_conditions, SL(" AND "), conditions TSRMLS_CC);
+		for (i = 0; i < number_checks; ++i) {
 	
-					PHALCON_INIT_NVAR(parameters);
-					array_init_size(parameters, 2);
-					phalcon_array_append(&parameters, join_conditions, 0);
-					phalcon_array_update_string(&parameters, SL("bind"), bind_params, PH_COPY);
+			if (!phalcon_array_isset_long_fetch(&exists, existing, i) || !zend_is_true(exists)) {
+				continue;
+			}
 	
-					/** 
-					 * Let's make the checking
-					 */
-					PHALCON_CALL_METHOD(&rowcount, referenced_model, "count", parameters);
-					if (zend_is_true(rowcount)) {
+			phalcon_array_isset_long_fetch(&failed_relation, checked, i);
 	
-						/** 
-						 * Create a new message
-						 */
-						if (phalcon_array_isset_string(foreign_key, SS("message"))) {
-							PHALCON_OBS_NVAR(user_message);
-							phalcon_array_fetch_string(&user_message, foreign_key, SL("message"), PH_NOISY);
-						} else {
-							PHALCON_INIT_NVAR(user_message);
-							PHALCON_CONCAT_SV(user_message, "Record is referenced by model ", relation_class);
-						}
+			PHALCON_CALL_METHOD(&foreign_key, failed_relation, "getforeignkey");
+			PHALCON_CALL_METHOD(&fields, failed_relation, "getfields");
 	
-						/** 
-						 * Create a message
-						 */
-						PHALCON_INIT_NVAR(type);
-						ZVAL_STRING(type, "ConstraintViolation", 1);
+			/** 
+			 * Create a new message
+			 */
+			if (Z_TYPE_P(foreign_key) == IS_ARRAY && phalcon_array_isset_string(foreign_key, SS("message"))) {
+				PHALCON_OBS_NVAR(user_message);
+				phalcon_array_fetch_string(&user_message, foreign_key, SL("message"), PH_NOISY);
+			} else {
+				PHALCON_CALL_METHOD(&relation_class, failed_relation, "getreferencedmodel");
 	
-						PHALCON_INIT_NVAR(message);
-						object_init_ex(message, phalcon_mvc_model_message_ce);
-						PHALCON_CALL_METHOD(NULL, message, "__construct", user_message, fields, type);
+				PHALCON_INIT_NVAR(user_message);
+				PHALCON_CONCAT_SV(user_message, "Record is referenced by model ", relation_class);
+			}
 	
-						PHALCON_CALL_METHOD(NULL, this_ptr, "appendmessage", message);
+			/** 
+			 * Create a message
+			 */
+			PHALCON_INIT_VAR(type);
+			ZVAL_STRING(type, "ConstraintViolation", 1);
 	
-						PHALCON_INIT_NVAR(error);
-						ZVAL_BOOL(error, 1);
-						break;
-					}
-				}
-			}
+			PHALCON_INIT_VAR(message);
+			object_init_ex(message, phalcon_mvc_model_message_ce);
+			PHALCON_CALL_METHOD(NULL, message, "__construct", user_message, fields, type);
 	
-			zend_hash_move_forward_ex(ah0, &hp0);
-		}
+			PHALCON_CALL_METHOD(NULL, this_ptr, "appendmessage", message);
 	
-		/** 
-		 * Call validation fails event
-		 */
-		if (PHALCON_IS_TRUE(error)) {
+			/** 
+			 * Call validation fails event
+			 */
 			if (PHALCON_GLOBAL(orm).events) {
 				PHALCON_INIT_VAR(event_name);
 				ZVAL_STRING(event_name, "onValidationFails", 1);
@@ -2821,7 +3594,8 @@ PHP_METHOD(Phalcon_Mvc_Model, _checkForeignKeysReverseRestrict){
 }
 
 /**
- * Reads both "hasMany" and "hasOne" relations and checks the virtual foreign keys (cascade) when deleting records
+ * Reads both "hasMany" and "hasOne" relations and checks the virtual foreign keys (cascade) when deleting records.
+ * Related records without per-record events are deleted using a single statement per relation
  *
  * @return boolean
  */
@@ -2829,12 +3603,9 @@ PHP_METHOD(Phalcon_Mvc_Model, _checkForeignKeysReverseCascade){
 
 	zval *manager, *relations = NULL, *relation = NULL, *foreign_key = NULL;
 	zval *action = NULL, *relation_class = NULL, *referenced_model = NULL;
-	zval *fields = NULL, *referenced_fields = NULL, *conditions = NULL;
-	zval *bind_params = NULL, *field = NULL, *position = NULL, *value = NULL, *referenced_field = NULL;
-	zval *condition = NULL, *extra_conditions = NULL, *join_conditions = NULL;
-	zval *parameters = NULL, *resulset = NULL, *status = NULL;
-	HashTable *ah0, *ah1;
-	HashPosition hp0, hp1;
+	zval *check = NULL, *parameters = NULL, *resulset = NULL, *status = NULL;
+	HashTable *ah0;
+	HashPosition hp0;
 	zval **hd;
 
 	PHALCON_MM_GROW();
@@ -2890,88 +3661,32 @@ PHP_METHOD(Phalcon_Mvc_Model, _checkForeignKeysReverseCascade){
 					 * Load a plain instance from the models manager
 					 */
 					PHALCON_CALL_METHOD(&referenced_model, manager, "load", relation_class);
-					PHALCON_CALL_METHOD(&fields, relation, "getfields");
-					PHALCON_CALL_METHOD(&referenced_fields, relation, "getreferencedfields");
-	
-					/** 
-					 * Create the checking conditions. A relation can has many fields or a single one
-					 */
-					PHALCON_INIT_NVAR(conditions);
-					array_init(conditions);
-	
-					PHALCON_INIT_NVAR(bind_params);
-					array_init(bind_params);
-					if (Z_TYPE_P(fields) == IS_ARRAY) { 
-	
-						phalcon_is_iterable(fields, &ah1, &hp1, 0, 0);
-	
-						while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
-	
-							PHALCON_GET_HKEY(position, ah1, hp1);
-							PHALCON_GET_HVALUE(field);
-	
-							if (phalcon_isset_property_zval(this_ptr, field TSRMLS_CC)) {
-								PHALCON_OBS_NVAR(value);
-								phalcon_read_property_zval(&value, this_ptr, field, PH_NOISY TSRMLS_CC);
-							} else {
-								PHALCON_INIT_NVAR(value);
-							}
-	
-							PHALCON_OBS_NVAR(referenced_field);
-							phalcon_array_fetch(&referenced_field, referenced_fields, position, PH_NOISY);
-	
-							PHALCON_INIT_NVAR(condition);
-							PHALCON_CONCAT_SVSV(condition, "[", referenced_field, "] = ?", position);
-							phalcon_array_append(&conditions, condition, PH_SEPARATE);
-							phalcon_array_append(&bind_params, value, PH_SEPARATE);
-	
-							zend_hash_move_forward_ex(ah1, &hp1);
-						}
 	
-					} else {
-						if (phalcon_isset_property_zval(this_ptr, fields TSRMLS_CC)) {
-							PHALCON_OBS_NVAR(value);
-							phalcon_read_property_zval(&value, this_ptr, fields, PH_NOISY TSRMLS_CC);
-						} else {
-							PHALCON_INIT_NVAR(value);
-						}
-	
-						PHALCON_INIT_NVAR(condition);
-						PHALCON_CONCAT_SVS(condition, "[", referenced_fields, "] = ?0");
-						phalcon_array_append(&conditions, condition, PH_SEPARATE);
-						phalcon_array_append(&bind_params, value, PH_SEPARATE);
+					PHALCON_INIT_NVAR(check);
+					phalcon_mvc_model_foreign_key_check(check, this_ptr, referenced_model, relation, foreign_key TSRMLS_CC);
+					if (EG(exception)) {
+						RETURN_MM();
 					}
 	
 					/** 
-					 * Check if the virtual foreign key has extra conditions
+					 * Try to delete the related records with a single statement
 					 */
-					if (phalcon_array_isset_string(foreign_key, SS("conditions"))) {
-						PHALCON_OBS_NVAR(extra_conditions);
-						phalcon_array_fetch_string(&extra_conditions, foreign_key, SL("conditions"), PH_NOISY);
-						phalcon_array_append(&conditions, extra_conditions, PH_SEPARATE);
+					PHALCON_INIT_NVAR(status);
+					phalcon_mvc_model_foreign_key_delete(status, manager, check TSRMLS_CC);
+					if (EG(exception)) {
+						RETURN_MM();
 					}
 	
-					/** 
-					 * We don't trust the actual values in the object and then we're passing the values
-					 * using bound parameters
-					 */
-					PHALCON_INIT_NVAR(join_conditions);
-					phalcon_fast_join_str(join_conditions, SL(" AND "), conditions TSRMLS_CC);
+					if (Z_TYPE_P(status) == IS_NULL) {
+						PHALCON_INIT_NVAR(parameters);
+						phalcon_mvc_model_foreign_key_parameters(parameters, check TSRMLS_CC);
 	
-					PHALCON_INIT_NVAR(parameters);
-					array_init_size(parameters, 2);
-					phalcon_array_append(&parameters, join_conditions, 0);
-					phalcon_array_update_string(&parameters, SL("bind"), bind_params, PH_COPY);
-	
-					/** 
-					 * Let's make the checking
-					 */
-					PHALCON_CALL_METHOD(&resulset, referenced_model, "find", parameters);
-	
-					/** 
-					 * Delete the resultset
-					 */
-					PHALCON_CALL_METHOD(&status, resulset, "delete");
+						/** 
+						 * Otherwise the related records are deleted one by one
+						 */
+						PHALCON_CALL_METHOD(&resulset, referenced_model, "find", parameters);
+						PHALCON_CALL_METHOD(&status, resulset, "delete");
+					}
 	
 					/** 
 					 * Stop the operation
@@ -3322,31 +4037,29 @@ PHP_METHOD(Phalcon_Mvc_Model, _postSave){
 }
 
 /**
- * Sends a pre-build INSERT SQL statement to the relational database system
+ * Collects the fields, values and bind types used to INSERT the record. Returns an array with
+ * the fields, the values, the bind types and the attribute that holds the identity (or false)
  *
  * @param Phalcon\Mvc\Model\MetadataInterface $metaData
  * @param Phalcon\Db\AdapterInterface $connection
- * @param string $table
- * @return boolean
+ * @param string $identityField
+ * @return array
  */
-PHP_METHOD(Phalcon_Mvc_Model, _doLowInsert){
+PHP_METHOD(Phalcon_Mvc_Model, _prepareLowInsert){
 
-	zval *meta_data, *connection, *table, *identity_field;
+	zval *meta_data, *connection, *identity_field;
 	zval *null_value, *bind_skip, *fields, *values;
 	zval *bind_types, *attributes = NULL, *bind_data_types = NULL;
 	zval *automatic_attributes = NULL, *column_map = NULL, *field = NULL;
 	zval *attribute_field = NULL, *exception_message = NULL;
 	zval *value = NULL, *bind_type = NULL, *default_value = NULL, *use_explicit_identity = NULL;
-	zval *success = NULL, *sequence_name = NULL, *support_sequences = NULL;
-	zval *schema = NULL, *source = NULL, *last_insert_id = NULL;
 	HashTable *ah0;
 	HashPosition hp0;
 	zval **hd;
-	int identity_field_is_not_false; /* scan-build insists on using flags */
 
 	PHALCON_MM_GROW();
 
-	phalcon_fetch_params(1, 4, 0, &meta_data, &connection, &table, &identity_field);
+	phalcon_fetch_params(1, 3, 0, &meta_data, &connection, &identity_field);
 
 	null_value = PHALCON_GLOBAL(z_null);
 	
@@ -3442,8 +4155,7 @@ PHP_METHOD(Phalcon_Mvc_Model, _doLowInsert){
 	/** 
 	 * If there is an identity field we add it using "null" or "default"
 	 */
-	identity_field_is_not_false = PHALCON_IS_NOT_FALSE(identity_field);
-	if (identity_field_is_not_false) {
+	if (PHALCON_IS_NOT_FALSE(identity_field)) {
 		PHALCON_CALL_METHOD(&default_value, connection, "getdefaultidvalue");
 	
 		/** 
@@ -3515,6 +4227,55 @@ PHP_METHOD(Phalcon_Mvc_Model, _doLowInsert){
 		}
 	}
 	
+	array_init_size(return_value, 4);
+	phalcon_array_append(&return_value, fields, 0);
+	phalcon_array_append(&return_value, values, 0);
+	phalcon_array_append(&return_value, bind_types, 0);
+	if (PHALCON_IS_NOT_FALSE(identity_field)) {
+		phalcon_array_append(&return_value, attribute_field, 0);
+	} else {
+		add_next_index_bool(return_value, 0);
+	}
+	
+	RETURN_MM();
+}
+
+/**
+ * Sends a pre-build INSERT SQL statement to the relational database system
+ *
+ * @param Phalcon\Mvc\Model\MetadataInterface $metaData
+ * @param Phalcon\Db\AdapterInterface $connection
+ * @param string $table
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model, _doLowInsert){
+
+	zval *meta_data, *connection, *table, *identity_field;
+	zval *insert_data = NULL, *fields, *values, *bind_types, *attribute_field;
+	zval *success = NULL, *sequence_name = NULL, *support_sequences = NULL;
+	zval *schema = NULL, *source = NULL, *last_insert_id = NULL;
+	int identity_field_is_not_false; /* scan-build insists on using flags */
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 4, 0, &meta_data, &connection, &table, &identity_field);
+
+	PHALCON_CALL_METHOD(&insert_data, this_ptr, "_preparelowinsert", meta_data, connection, identity_field);
+
+	PHALCON_OBS_VAR(fields);
+	phalcon_array_fetch_long(&fields, insert_data, 0, PH_NOISY);
+
+	PHALCON_OBS_VAR(values);
+	phalcon_array_fetch_long(&values, insert_data, 1, PH_NOISY);
+
+	PHALCON_OBS_VAR(bind_types);
+	phalcon_array_fetch_long(&bind_types, insert_data, 2, PH_NOISY);
+
+	PHALCON_OBS_VAR(attribute_field);
+	phalcon_array_fetch_long(&attribute_field, insert_data, 3, PH_NOISY);
+
+	identity_field_is_not_false = PHALCON_IS_NOT_FALSE(identity_field);
+
 	/** 
 	 * The low level insert is performed
 	 */
@@ -3560,6 +4321,131 @@ PHP_METHOD(Phalcon_Mvc_Model, _doLowInsert){
 	RETURN_CTOR(success);
 }
 
+/**
+ * Sends a pre-build UPSERT SQL statement to the relational database system, the primary key
+ * decides whether the row is inserted or the rest of the columns are updated
+ *
+ * @param Phalcon\Mvc\Model\MetadataInterface $metaData
+ * @param Phalcon\Db\AdapterInterface $connection
+ * @param string|array $table
+ * @param string $identityField
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model, _doLowUpsert){
+
+	zval *meta_data, *connection, *table, *identity_field;
+	zval *insert_data = NULL, *fields, *values, *bind_types, *attribute_field;
+	zval *primary_keys = NULL, *automatic_attributes = NULL, *update_fields, *field = NULL;
+	zval *identity_value = NULL, *success = NULL, *sequence_name = NULL, *support_sequences = NULL;
+	zval *schema = NULL, *source = NULL, *last_insert_id = NULL;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+	int generate_identity = 0;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 4, 0, &meta_data, &connection, &table, &identity_field);
+
+	PHALCON_CALL_METHOD(&primary_keys, meta_data, "getprimarykeyattributes", this_ptr);
+	if (!phalcon_fast_count_ev(primary_keys TSRMLS_CC)) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "A primary key must be defined in the model in order to perform an upsert");
+		return;
+	}
+
+	PHALCON_CALL_METHOD(&insert_data, this_ptr, "_preparelowinsert", meta_data, connection, identity_field);
+
+	PHALCON_OBS_VAR(fields);
+	phalcon_array_fetch_long(&fields, insert_data, 0, PH_NOISY);
+
+	PHALCON_OBS_VAR(values);
+	phalcon_array_fetch_long(&values, insert_data, 1, PH_NOISY);
+
+	PHALCON_OBS_VAR(bind_types);
+	phalcon_array_fetch_long(&bind_types, insert_data, 2, PH_NOISY);
+
+	PHALCON_OBS_VAR(attribute_field);
+	phalcon_array_fetch_long(&attribute_field, insert_data, 3, PH_NOISY);
+
+	/** 
+	 * The identity is only recovered when the database generates it
+	 */
+	if (PHALCON_IS_NOT_FALSE(identity_field)) {
+		if (phalcon_isset_property_zval(this_ptr, attribute_field TSRMLS_CC)) {
+			PHALCON_OBS_VAR(identity_value);
+			phalcon_read_property_zval(&identity_value, this_ptr, attribute_field, PH_NOISY TSRMLS_CC);
+			generate_identity = PHALCON_IS_EMPTY(identity_value);
+		} else {
+			generate_identity = 1;
+		}
+	}
+
+	/** 
+	 * Every inserted column except the primary key and the ones skipped on updates is updated
+	 */
+	PHALCON_CALL_METHOD(&automatic_attributes, meta_data, "getautomaticupdateattributes", this_ptr);
+
+	PHALCON_INIT_VAR(update_fields);
+	array_init(update_fields);
+
+	phalcon_is_iterable(fields, &ah0, &hp0, 0, 0);
+
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+		PHALCON_GET_HVALUE(field);
+
+		if (!phalcon_fast_in_array(field, primary_keys TSRMLS_CC) && !phalcon_array_isset(automatic_attributes, field)) {
+			phalcon_array_append(&update_fields, field, 0);
+		}
+
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+
+	/** 
+	 * The low level upsert is performed
+	 */
+	PHALCON_CALL_METHOD(&success, connection, "upsert", table, values, fields, primary_keys, bind_types, update_fields);
+	if (generate_identity && zend_is_true(success)) {
+
+		/** 
+		 * We check if the model have sequences
+		 */
+		PHALCON_CALL_METHOD(&support_sequences, connection, "supportsequences");
+		if (PHALCON_IS_TRUE(support_sequences)) {
+			if (phalcon_method_exists_ex(this_ptr, SS("getsequencename") TSRMLS_CC) == SUCCESS) {
+				PHALCON_CALL_METHOD(&sequence_name, this_ptr, "getsequencename");
+			} else {
+				PHALCON_CALL_METHOD(&schema, this_ptr, "getschema"); 
+				PHALCON_CALL_METHOD(&source, this_ptr, "getsource");
+
+				PHALCON_INIT_VAR(sequence_name);
+				if (PHALCON_IS_EMPTY(schema)) {	
+					PHALCON_CONCAT_VSVS(sequence_name, source, "_", identity_field, "_seq");
+				} else {
+					PHALCON_CONCAT_VSVSVS(sequence_name, schema, ".", source, "_", identity_field, "_seq");
+				}
+			}
+		}
+		else {
+			PHALCON_INIT_VAR(sequence_name);
+		}
+
+		/** 
+		 * Recover the last "insert id" and assign it to the object
+		 */
+		PHALCON_CALL_METHOD(&last_insert_id, connection, "lastinsertid", sequence_name);
+		phalcon_update_property_zval_zval(this_ptr, attribute_field, last_insert_id TSRMLS_CC);
+	}
+
+	/** 
+	 * The primary key could have been modified, we delete the _uniqueParams to force any
+	 * future update to re-build it
+	 */
+	phalcon_update_property_null(this_ptr, SL("_uniqueParams") TSRMLS_CC);
+
+	RETURN_CTOR(success);
+}
+
 /**
  * Sends a pre-build UPDATE SQL statement to the relational database system
  *
@@ -3572,11 +4458,11 @@ PHP_METHOD(Phalcon_Mvc_Model, _doLowUpdate){
 
 	zval *meta_data, *connection, *table, *null_value;
 	zval *bind_skip, *fields, *values, *bind_types;
-	zval *manager, *use_dynamic_update = NULL, *snapshot;
+	zval *manager, *use_dynamic_update = NULL, *snapshot, *snapshot_map = NULL, *written = NULL;
 	zval *bind_data_types = NULL, *non_primary = NULL, *automatic_attributes = NULL;
 	zval *column_map = NULL, *field = NULL, *exception_message = NULL;
 	zval *attribute_field = NULL, *value = NULL, *bind_type = NULL, *changed = NULL;
-	zval *snapshot_value = NULL, *unique_key, *unique_params = NULL;
+	zval *snapshot_value = NULL, *snapshot_key = NULL, *unique_key, *unique_params = NULL;
 	zval *unique_types, *primary_keys = NULL, *conditions;
 	HashTable *ah0, *ah1;
 	HashPosition hp0, hp1;
@@ -3615,6 +4501,12 @@ PHP_METHOD(Phalcon_Mvc_Model, _doLowUpdate){
 		phalcon_read_property_this(&snapshot, this_ptr, SL("_snapshot"), PH_NOISY TSRMLS_CC);
 		if (Z_TYPE_P(snapshot) != IS_ARRAY) { 
 			i_use_dynamic_update = 0;
+		} else {
+			PHALCON_OBS_VAR(snapshot_map);
+			phalcon_read_property_this(&snapshot_map, this_ptr, SL("_snapshotMap"), PH_NOISY TSRMLS_CC);
+	
+			PHALCON_OBS_VAR(written);
+			phalcon_read_property_this(&written, this_ptr, SL("_written"), PH_NOISY TSRMLS_CC);
 		}
 	}
 	
@@ -3688,15 +4580,30 @@ PHP_METHOD(Phalcon_Mvc_Model, _doLowUpdate){
 					phalcon_array_fetch(&bind_type, bind_data_types, field, PH_NOISY);
 					phalcon_array_append(&bind_types, bind_type, PH_SEPARATE);
 				} else {
+					/** 
+					 * A snapshot taken with a column map is indexed by column
+					 */
+					if (Z_TYPE_P(snapshot_map) == IS_ARRAY) {
+						PHALCON_CPY_WRT(snapshot_key, field);
+					} else {
+						PHALCON_CPY_WRT(snapshot_key, attribute_field);
+					}
+	
 					/** 
 					 * If the field is not part of the snapshot we add them as changed
 					 */
-					if (!phalcon_array_isset(snapshot, attribute_field)) {
+					if (!phalcon_array_isset(snapshot, snapshot_key)) {
 						PHALCON_INIT_NVAR(changed);
 						ZVAL_BOOL(changed, 1);
+					} else if (Z_TYPE_P(written) == IS_ARRAY && !phalcon_array_isset(written, attribute_field)) {
+						/** 
+						 * Fields not written since the snapshot was taken are skipped without comparing them
+						 */
+						PHALCON_INIT_NVAR(changed);
+						ZVAL_BOOL(changed, 0);
 					} else {
 						PHALCON_OBS_NVAR(snapshot_value);
-						phalcon_array_fetch(&snapshot_value, snapshot, attribute_field, PH_NOISY);
+						phalcon_array_fetch(&snapshot_value, snapshot, snapshot_key, PH_NOISY);
 						if (!PHALCON_IS_EQUAL(value, snapshot_value)) {
 							PHALCON_INIT_NVAR(changed);
 							ZVAL_BOOL(changed, 1);
@@ -4142,29 +5049,11 @@ PHP_METHOD(Phalcon_Mvc_Model, _postSaveRelatedRecords){
 }
 
 /**
- * Inserts or updates a model instance. Returning true on success or false otherwise.
- *
- *<code>
- *	//Creating a new robot
- *	$robot = new Robots();
- *	$robot->type = 'mechanical';
- *	$robot->name = 'Astro Boy';
- *	$robot->year = 1952;
- *	$robot->save();
- *
- *	//Updating a robot name
- *	$robot = Robots::findFirst("id=100");
- *	$robot->name = "Biomass";
- *	$robot->save();
- *</code>
- *
- * @param array $data
- * @param array $whiteList
- * @return boolean
+ * Assigns the data passed, validates and writes the record, upsert writes it without checking whether it exists
  */
-PHP_METHOD(Phalcon_Mvc_Model, save){
-
-	zval *data = NULL, *white_list = NULL, *meta_data = NULL, *attributes = NULL;
+static void phalcon_mvc_model_save(zval *return_value, zval *this_ptr, zval *data, zval *white_list, int upsert TSRMLS_DC)
+{
+	zval *meta_data = NULL, *attributes = NULL;
 	zval *attribute = NULL, *value = NULL, *possible_setter = NULL, *write_connection = NULL;
 	zval *related, *status = NULL, *schema = NULL, *source = NULL, *table = NULL, *read_connection = NULL;
 	zval *exists = NULL, *error_messages = NULL, *identity_field = NULL;
@@ -4175,16 +5064,6 @@ PHP_METHOD(Phalcon_Mvc_Model, save){
 
 	PHALCON_MM_GROW();
 
-	phalcon_fetch_params(1, 0, 2, &data, &white_list);
-	
-	if (!data) {
-		data = PHALCON_GLOBAL(z_null);
-	}
-	
-	if (!white_list) {
-		white_list = PHALCON_GLOBAL(z_null);
-	}
-	
 	PHALCON_CALL_METHOD(&meta_data, this_ptr, "getmodelsmetadata");
 	
 	/** 
@@ -4278,15 +5157,25 @@ PHP_METHOD(Phalcon_Mvc_Model, save){
 		PHALCON_CPY_WRT(table, source);
 	}
 	
-	/** 
-	 * Create/Get the current database connection
-	 */
-	PHALCON_CALL_METHOD(&read_connection, this_ptr, "getreadconnection");
+	if (upsert) {
+		/** 
+		 * The statement itself resolves the conflict, the dirty state only tells
+		 * which events and validations are applied
+		 */
+		PHALCON_INIT_VAR(exists);
+		ZVAL_BOOL(exists, phalcon_get_intval(phalcon_fetch_nproperty_this(this_ptr, SL("_dirtyState"), PH_NOISY TSRMLS_CC)) == 0);
+	} else {
+		/** 
+		 * Create/Get the current database connection
+		 */
+		PHALCON_CALL_METHOD(&read_connection, this_ptr, "getreadconnection");
+	
+		/** 
+		 * We need to check if the record exists
+		 */
+		PHALCON_CALL_METHOD(&exists, this_ptr, "_exists", meta_data, read_connection, table);
+	}
 	
-	/** 
-	 * We need to check if the record exists
-	 */
-	PHALCON_CALL_METHOD(&exists, this_ptr, "_exists", meta_data, read_connection, table);
 	if (zend_is_true(exists)) {
 		phalcon_update_property_long(this_ptr, SL("_operationMade"), 2 TSRMLS_CC);
 	} else {
@@ -4344,7 +5233,9 @@ PHP_METHOD(Phalcon_Mvc_Model, save){
 	/** 
 	 * Depending if the record exists we do an update or an insert operation
 	 */
-	if (zend_is_true(exists)) {
+	if (upsert) {
+		PHALCON_CALL_METHOD(&success, this_ptr, "_dolowupsert", meta_data, write_connection, table, identity_field);
+	} else if (zend_is_true(exists)) {
 		PHALCON_CALL_METHOD(&success, this_ptr, "_dolowupdate", meta_data, write_connection, table);
 	} else {
 		PHALCON_CALL_METHOD(&success, this_ptr, "_dolowinsert", meta_data, write_connection, table, identity_field);
@@ -4355,6 +5246,16 @@ PHP_METHOD(Phalcon_Mvc_Model, save){
 	 */
 	if (zend_is_true(success)) {
 		phalcon_update_property_long(this_ptr, SL("_dirtyState"), 0 TSRMLS_CC);
+	
+		/** 
+		 * A mapped instance of the record is stale now, an upsert may have replaced a row
+		 * the record didn't know about
+		 */
+		if (upsert || zend_is_true(exists)) {
+			RETURN_MM_ON_FAILURE(phalcon_mvc_model_forget_identity(this_ptr TSRMLS_CC));
+		}
+	
+		RETURN_MM_ON_FAILURE(phalcon_mvc_model_bump_version(this_ptr TSRMLS_CC));
 	}
 	
 	/** 
@@ -4378,16 +5279,102 @@ PHP_METHOD(Phalcon_Mvc_Model, save){
 			RETURN_MM_FALSE;
 		}
 	
-		/** 
-		 * Save the post-related records
-		 */
-		PHALCON_CALL_METHOD(&status, this_ptr, "_postsaverelatedrecords", write_connection, related);
-		if (PHALCON_IS_FALSE(status)) {
-			RETURN_MM_FALSE;
-		}
+		/** 
+		 * Save the post-related records
+		 */
+		PHALCON_CALL_METHOD(&status, this_ptr, "_postsaverelatedrecords", write_connection, related);
+		if (PHALCON_IS_FALSE(status)) {
+			RETURN_MM_FALSE;
+		}
+	}
+	
+	RETURN_CTOR(new_success);
+}
+
+/**
+ * Inserts or updates a model instance. Returning true on success or false otherwise.
+ *
+ *<code>
+ *	//Creating a new robot
+ *	$robot = new Robots();
+ *	$robot->type = 'mechanical';
+ *	$robot->name = 'Astro Boy';
+ *	$robot->year = 1952;
+ *	$robot->save();
+ *
+ *	//Updating a robot name
+ *	$robot = Robots::findFirst("id=100");
+ *	$robot->name = "Biomass";
+ *	$robot->save();
+ *</code>
+ *
+ * @param array $data
+ * @param array $whiteList
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model, save){
+
+	zval *data = NULL, *white_list = NULL;
+
+	if (phalcon_mvc_model_is_read_only(this_ptr TSRMLS_CC)) {
+		PHALCON_THROW_EXCEPTION_STRW(phalcon_mvc_model_exception_ce, "The record is read-only");
+		return;
+	}
+
+	phalcon_fetch_params(0, 0, 2, &data, &white_list);
+	
+	if (!data) {
+		data = PHALCON_GLOBAL(z_null);
+	}
+	
+	if (!white_list) {
+		white_list = PHALCON_GLOBAL(z_null);
+	}
+	
+	phalcon_mvc_model_save(return_value, this_ptr, data, white_list, 0 TSRMLS_CC);
+}
+
+/**
+ * Inserts or updates a model instance using a single UPSERT statement, the record isn't
+ * looked up in the database before writing it. Validations and events run once as in save(),
+ * the create or update ones are chosen from the state of the record.
+ * On MySQL a conflict with any unique index updates the conflicting row, a generated identity
+ * is then taken from that row
+ *
+ *<code>
+ *	//Writing the robot with id 100 whether it exists or not
+ *	$robot = new Robots();
+ *	$robot->id = 100;
+ *	$robot->type = 'mechanical';
+ *	$robot->name = 'Astro Boy';
+ *	$robot->year = 1952;
+ *	$robot->upsert();
+ *</code>
+ *
+ * @param array $data
+ * @param array $whiteList
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model, upsert){
+
+	zval *data = NULL, *white_list = NULL;
+
+	if (phalcon_mvc_model_is_read_only(this_ptr TSRMLS_CC)) {
+		PHALCON_THROW_EXCEPTION_STRW(phalcon_mvc_model_exception_ce, "The record is read-only");
+		return;
+	}
+
+	phalcon_fetch_params(0, 0, 2, &data, &white_list);
+	
+	if (!data) {
+		data = PHALCON_GLOBAL(z_null);
 	}
 	
-	RETURN_CTOR(new_success);
+	if (!white_list) {
+		white_list = PHALCON_GLOBAL(z_null);
+	}
+	
+	phalcon_mvc_model_save(return_value, this_ptr, data, white_list, 1 TSRMLS_CC);
 }
 
 /**
@@ -4426,6 +5413,11 @@ PHP_METHOD(Phalcon_Mvc_Model, create){
 	HashPosition hp0;
 	zval **hd;
 
+	if (phalcon_mvc_model_is_read_only(this_ptr TSRMLS_CC)) {
+		PHALCON_THROW_EXCEPTION_STRW(phalcon_mvc_model_exception_ce, "The record is read-only");
+		return;
+	}
+
 	PHALCON_MM_GROW();
 
 	phalcon_fetch_params(1, 0, 2, &data, &white_list);
@@ -4521,44 +5513,433 @@ PHP_METHOD(Phalcon_Mvc_Model, create){
 	
 	}
 	
-	/** 
-	 * Get the current connection
-	 */
-	PHALCON_CALL_METHOD(&read_connection, this_ptr, "getreadconnection");
+	/** 
+	 * Get the current connection
+	 */
+	PHALCON_CALL_METHOD(&read_connection, this_ptr, "getreadconnection");
+	
+	/** 
+	 * A 'exists' confirmation is performed first
+	 */
+	PHALCON_CALL_METHOD(&exists, this_ptr, "_exists", meta_data, read_connection);
+	
+	/** 
+	 * If the record already exists we must throw an exception
+	 */
+	if (zend_is_true(exists)) {
+		PHALCON_INIT_VAR(field);
+	
+		PHALCON_INIT_VAR(type);
+		ZVAL_STRING(type, "InvalidCreateAttempt", 1);
+	
+		PHALCON_INIT_VAR(message);
+		ZVAL_STRING(message, "Record cannot be created because it already exists", 1);
+	
+		PHALCON_INIT_VAR(model_message);
+		object_init_ex(model_message, phalcon_mvc_model_message_ce);
+		PHALCON_CALL_METHOD(NULL, model_message, "__construct", message, field, type);
+	
+		PHALCON_INIT_VAR(messages);
+		array_init_size(messages, 1);
+		phalcon_array_append(&messages, model_message, PH_SEPARATE);
+		phalcon_update_property_this(this_ptr, SL("_errorMessages"), messages TSRMLS_CC);
+		RETURN_MM_FALSE;
+	}
+	
+	/** 
+	 * Using save() anyways
+	 */
+	PHALCON_RETURN_CALL_METHOD(this_ptr, "save");
+	RETURN_MM();
+}
+
+/**
+ * Sends a batch of records of createMany() and marks them as persistent. When the database
+ * generated their identity values these are assigned back in order, records whose values
+ * cannot be recovered are left transient
+ */
+static void phalcon_mvc_model_insert_batch(zval *return_value, zval *models, zval *rows, zval *fields, zval *bind_types, zval *connection, zval *table, zval *identity_field, zval *attribute_field TSRMLS_DC) {
+
+	zval *identities = NULL, *model = NULL, *identity_value = NULL;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+	long int position = 0;
+
+	PHALCON_MM_GROW();
+
+	if (Z_TYPE_P(identity_field) == IS_STRING) {
+		PHALCON_CALL_METHOD(&identities, connection, "insertmultiple", table, rows, fields, bind_types, identity_field);
+	} else {
+		PHALCON_CALL_METHOD(&identities, connection, "insertmultiple", table, rows, fields, bind_types);
+	}
+	
+	if (!zend_is_true(identities)) {
+		RETURN_MM_FALSE;
+	}
+	
+	if (Z_TYPE_P(identity_field) == IS_STRING && Z_TYPE_P(identities) != IS_ARRAY) {
+		RETURN_MM_TRUE;
+	}
+	
+	phalcon_is_iterable(models, &ah0, &hp0, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(model);
+	
+		if (Z_TYPE_P(identities) == IS_ARRAY) {
+			PHALCON_OBS_NVAR(identity_value);
+			phalcon_array_fetch_long(&identity_value, identities, position++, PH_NOISY);
+			phalcon_update_property_zval_zval(model, attribute_field, identity_value TSRMLS_CC);
+			phalcon_update_property_null(model, SL("_uniqueParams") TSRMLS_CC);
+		}
+	
+		phalcon_update_property_long(model, SL("_dirtyState"), 0 TSRMLS_CC);
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+	
+	RETURN_MM_TRUE;
+}
+
+/**
+ * Sends the records of createMany() using multi-row INSERT statements, a new statement is
+ * started every time the list of fields changes or the identity value stops or starts being
+ * generated by the database
+ */
+static void phalcon_mvc_model_insert_many(zval *return_value, zval *models, zval *meta_data, zval *connection, zval *table, zval *identity_field TSRMLS_DC) {
+
+	zval *model = NULL, *insert_data = NULL, *fields = NULL, *values = NULL, *bind_types = NULL;
+	zval *attribute_field = NULL, *identity_value = NULL;
+	zval *batch_models = NULL, *batch_fields = NULL, *batch_rows = NULL, *batch_types = NULL, *bind_type = NULL;
+	zval *success = NULL, *position = NULL;
+	HashTable *ah0, *ah1;
+	HashPosition hp0, hp1;
+	zval **hd;
+	int generated, batch_generated = 0;
+
+	PHALCON_MM_GROW();
+
+	PHALCON_INIT_VAR(batch_models);
+	array_init(batch_models);
+	
+	PHALCON_INIT_VAR(batch_rows);
+	array_init(batch_rows);
+	
+	PHALCON_INIT_VAR(batch_types);
+	array_init(batch_types);
+	
+	PHALCON_INIT_VAR(batch_fields);
+	
+	PHALCON_INIT_VAR(success);
+	
+	phalcon_is_iterable(models, &ah0, &hp0, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(model);
+	
+		/** 
+		 * Records skipped by a behavior or an event aren't inserted
+		 */
+		if (zend_is_true(phalcon_fetch_nproperty_this(model, SL("_skipped"), PH_NOISY TSRMLS_CC))) {
+			zend_hash_move_forward_ex(ah0, &hp0);
+			continue;
+		}
+	
+		PHALCON_CALL_METHOD(&insert_data, model, "_preparelowinsert", meta_data, connection, identity_field);
+	
+		PHALCON_OBS_NVAR(fields);
+		phalcon_array_fetch_long(&fields, insert_data, 0, PH_NOISY);
+	
+		PHALCON_OBS_NVAR(values);
+		phalcon_array_fetch_long(&values, insert_data, 1, PH_NOISY);
+	
+		PHALCON_OBS_NVAR(bind_types);
+		phalcon_array_fetch_long(&bind_types, insert_data, 2, PH_NOISY);
+	
+		PHALCON_OBS_NVAR(attribute_field);
+		phalcon_array_fetch_long(&attribute_field, insert_data, 3, PH_NOISY);
+	
+		/** 
+		 * The database generates the identity value when the record doesn't have one
+		 */
+		generated = PHALCON_IS_NOT_FALSE(identity_field);
+		if (generated && phalcon_isset_property_zval(model, attribute_field TSRMLS_CC)) {
+			PHALCON_OBS_NVAR(identity_value);
+			phalcon_read_property_zval(&identity_value, model, attribute_field, PH_NOISY TSRMLS_CC);
+			generated = PHALCON_IS_EMPTY(identity_value);
+		}
+	
+		/** 
+		 * A multi-row INSERT requires the same fields in every row and the generated identity
+		 * values are only recovered for statements without explicit ones, send the pending rows
+		 * if this record is different
+		 */
+		if (Z_TYPE_P(batch_fields) == IS_ARRAY && (!PHALCON_IS_EQUAL(batch_fields, fields) || generated != batch_generated)) {
+	
+			phalcon_mvc_model_insert_batch(success, batch_models, batch_rows, batch_fields, batch_types, connection, table, batch_generated ? identity_field : PHALCON_GLOBAL(z_false), attribute_field TSRMLS_CC);
+			if (EG(exception) || !zend_is_true(success)) {
+				RETURN_MM_FALSE;
+			}
+	
+			PHALCON_INIT_NVAR(batch_models);
+			array_init(batch_models);
+	
+			PHALCON_INIT_NVAR(batch_rows);
+			array_init(batch_rows);
+	
+			PHALCON_INIT_NVAR(batch_types);
+			array_init(batch_types);
+		}
+	
+		PHALCON_CPY_WRT(batch_fields, fields);
+		batch_generated = generated;
+		phalcon_array_append(&batch_models, model, 0);
+		phalcon_array_append(&batch_rows, values, 0);
+	
+		/** 
+		 * Null values don't use a bind type, so any real type seen in a position is kept
+		 */
+		phalcon_is_iterable(bind_types, &ah1, &hp1, 0, 0);
+	
+		while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
+	
+			PHALCON_GET_HKEY(position, ah1, hp1);
+			PHALCON_GET_HVALUE(bind_type);
+	
+			if (!phalcon_array_isset(batch_types, position) || !phalcon_compare_strict_long(bind_type, 1024 TSRMLS_CC)) {
+				phalcon_array_update_zval(&batch_types, position, bind_type, PH_COPY);
+			}
+	
+			zend_hash_move_forward_ex(ah1, &hp1);
+		}
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+	
+	if (phalcon_fast_count_ev(batch_rows TSRMLS_CC)) {
+		phalcon_mvc_model_insert_batch(success, batch_models, batch_rows, batch_fields, batch_types, connection, table, batch_generated ? identity_field : PHALCON_GLOBAL(z_false), attribute_field TSRMLS_CC);
+		if (EG(exception) || !zend_is_true(success)) {
+			RETURN_MM_FALSE;
+		}
+	}
+	
+	RETURN_MM_TRUE;
+}
+
+/**
+ * Rolls back the transaction of createMany(), an exception that aborted the inserts is kept
+ */
+static void phalcon_mvc_model_rollback_many(zval *connection TSRMLS_DC) {
+
+	zval *exception = EG(exception);
+	zend_op *opline = EG(opline_before_exception);
+
+	EG(exception) = NULL;
+	if (phalcon_call_method(NULL, connection, "rollback", 0, NULL TSRMLS_CC) == SUCCESS && !EG(exception)) {
+		EG(exception) = exception;
+		EG(opline_before_exception) = opline;
+		return;
+	}
+
+	if (exception) {
+		if (EG(exception)) {
+			zend_exception_set_previous(EG(exception), exception TSRMLS_CC);
+		} else {
+			EG(exception) = exception;
+		}
+
+		EG(opline_before_exception) = opline;
+	}
+}
+
+/**
+ * Inserts several records of the current model at once. Every record is validated first, then
+ * the records are written using multi-row INSERT statements inside a single transaction.
+ * Records can be passed as arrays of attributes or as instances of the model.
+ * Identity values generated by the database are assigned back to the records on PostgreSQL,
+ * MySQL and SQLite, with other adapters the records stay transient after being inserted
+ *
+ *<code>
+ *	$success = Robots::createMany(array(
+ *		array('type' => 'mechanical', 'name' => 'Astro Boy', 'year' => 1952),
+ *		array('type' => 'virtual', 'name' => 'Wall-E', 'year' => 2008)
+ *	));
+ *</code>
+ *
+ * @param array $records
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model, createMany){
+
+	zval *records, *model_name, *models, *record = NULL, *model = NULL;
+	zval *meta_data = NULL, *write_connection = NULL, *schema = NULL, *source = NULL;
+	zval *table = NULL, *identity_field = NULL, *exists, *error_messages = NULL;
+	zval *status = NULL, *exception, *success, *saved;
+	zend_class_entry *ce0;
+	HashTable *ah0, *ah1;
+	HashPosition hp0, hp1;
+	zval **hd;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &records);
+	
+	if (Z_TYPE_P(records) != IS_ARRAY) { 
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Records passed to createMany() must be an array");
+		return;
+	}
+	
+	if (!phalcon_fast_count_ev(records TSRMLS_CC)) {
+		RETURN_MM_TRUE;
+	}
+	
+	PHALCON_INIT_VAR(model_name);
+	phalcon_get_called_class(model_name TSRMLS_CC);
+	
+	ce0 = phalcon_fetch_class(model_name TSRMLS_CC);
+	
+	/** 
+	 * Arrays are converted into new instances of the model
+	 */
+	PHALCON_INIT_VAR(models);
+	array_init_size(models, zend_hash_num_elements(Z_ARRVAL_P(records)));
+	
+	phalcon_is_iterable(records, &ah0, &hp0, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(record);
+	
+		if (Z_TYPE_P(record) == IS_OBJECT && instanceof_function_ex(Z_OBJCE_P(record), ce0, 0 TSRMLS_CC)) {
+			phalcon_array_append(&models, record, 0);
+		} else {
+			if (Z_TYPE_P(record) != IS_ARRAY) { 
+				PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Records passed to createMany() must be arrays or instances of the model");
+				return;
+			}
+	
+			PHALCON_INIT_NVAR(model);
+			object_init_ex(model, ce0);
+			PHALCON_CALL_METHOD(NULL, model, "__construct");
+			PHALCON_CALL_METHOD(NULL, model, "assign", record);
+			phalcon_array_append(&models, model, 0);
+		}
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+	
+	/** 
+	 * All the records share the metadata, the connection and the table
+	 */
+	PHALCON_OBS_NVAR(model);
+	phalcon_array_fetch_long(&model, models, 0, PH_NOISY);
+	
+	PHALCON_CALL_METHOD(&meta_data, model, "getmodelsmetadata");
+	PHALCON_CALL_METHOD(&write_connection, model, "getwriteconnection");
+	PHALCON_CALL_METHOD(&schema, model, "getschema");
+	PHALCON_CALL_METHOD(&source, model, "getsource");
+	if (zend_is_true(schema)) {
+		PHALCON_INIT_VAR(table);
+		array_init_size(table, 2);
+		phalcon_array_append(&table, schema, 0);
+		phalcon_array_append(&table, source, 0);
+	} else {
+		PHALCON_CPY_WRT(table, source);
+	}
+	
+	PHALCON_CALL_METHOD(&identity_field, meta_data, "getidentityfield", model);
+	
+	exists = PHALCON_GLOBAL(z_false);
+	
+	/** 
+	 * Validate every record before sending anything to the database
+	 */
+	phalcon_is_iterable(models, &ah1, &hp1, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
+	
+		PHALCON_GET_HVALUE(model);
+	
+		phalcon_update_property_long(model, SL("_operationMade"), 1 TSRMLS_CC);
+	
+		PHALCON_INIT_NVAR(error_messages);
+		array_init(error_messages);
+		phalcon_update_property_this(model, SL("_errorMessages"), error_messages TSRMLS_CC);
+	
+		PHALCON_CALL_METHOD(&status, model, "_presave", meta_data, exists, identity_field);
+		if (PHALCON_IS_FALSE(status)) {
+	
+			/** 
+			 * Throw exceptions on failed saves?
+			 */
+			if (PHALCON_GLOBAL(orm).exception_on_failed_save) {
+				PHALCON_OBS_NVAR(error_messages);
+				phalcon_read_property(&error_messages, model, SL("_errorMessages"), PH_NOISY TSRMLS_CC);
+	
+				PHALCON_INIT_VAR(exception);
+				object_init_ex(exception, phalcon_mvc_model_validationfailed_ce);
+				PHALCON_CALL_METHOD(NULL, exception, "__construct", model, error_messages);
+	
+				phalcon_throw_exception(exception TSRMLS_CC);
+				RETURN_MM();
+			}
+	
+			RETURN_MM_FALSE;
+		}
+	
+		zend_hash_move_forward_ex(ah1, &hp1);
+	}
+	
+	PHALCON_CALL_METHOD(NULL, write_connection, "begin");
+	
+	/** 
+	 * The transaction is rolled back if an insert fails or throws
+	 */
+	PHALCON_INIT_VAR(success);
+	phalcon_mvc_model_insert_many(success, models, meta_data, write_connection, table, identity_field TSRMLS_CC);
+	if (EG(exception) || !zend_is_true(success)) {
+		phalcon_mvc_model_rollback_many(write_connection TSRMLS_CC);
+		if (EG(exception)) {
+			RETURN_MM();
+		}
+	
+		RETURN_MM_FALSE;
+	}
+	
+	PHALCON_CALL_METHOD(NULL, write_connection, "commit");
 	
-	/** 
-	 * A 'exists' confirmation is performed first
-	 */
-	PHALCON_CALL_METHOD(&exists, this_ptr, "_exists", meta_data, read_connection);
+	RETURN_MM_ON_FAILURE(phalcon_mvc_model_bump_version(model TSRMLS_CC));
 	
 	/** 
-	 * If the record already exists we must throw an exception
+	 * The dirty state was already changed by the inserts, run the events after save
 	 */
-	if (zend_is_true(exists)) {
-		PHALCON_INIT_VAR(field);
+	saved = PHALCON_GLOBAL(z_true);
 	
-		PHALCON_INIT_VAR(type);
-		ZVAL_STRING(type, "InvalidCreateAttempt", 1);
+	phalcon_is_iterable(models, &ah1, &hp1, 0, 0);
 	
-		PHALCON_INIT_VAR(message);
-		ZVAL_STRING(message, "Record cannot be created because it already exists", 1);
+	while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
 	
-		PHALCON_INIT_VAR(model_message);
-		object_init_ex(model_message, phalcon_mvc_model_message_ce);
-		PHALCON_CALL_METHOD(NULL, model_message, "__construct", message, field, type);
+		PHALCON_GET_HVALUE(model);
 	
-		PHALCON_INIT_VAR(messages);
-		array_init_size(messages, 1);
-		phalcon_array_append(&messages, model_message, PH_SEPARATE);
-		phalcon_update_property_this(this_ptr, SL("_errorMessages"), messages TSRMLS_CC);
-		RETURN_MM_FALSE;
+		/** 
+		 * Skipped records were not inserted
+		 */
+		if (zend_is_true(phalcon_fetch_nproperty_this(model, SL("_skipped"), PH_NOISY TSRMLS_CC))) {
+			zend_hash_move_forward_ex(ah1, &hp1);
+			continue;
+		}
+	
+		if (PHALCON_GLOBAL(orm).events) {
+			PHALCON_CALL_METHOD(NULL, model, "_postsave", saved, exists);
+		}
+	
+		zend_hash_move_forward_ex(ah1, &hp1);
 	}
 	
-	/** 
-	 * Using save() anyways
-	 */
-	PHALCON_RETURN_CALL_METHOD(this_ptr, "save");
-	RETURN_MM();
+	RETURN_MM_TRUE;
 }
 
 /**
@@ -4587,6 +5968,11 @@ PHP_METHOD(Phalcon_Mvc_Model, update){
 	HashPosition hp0;
 	zval **hd;
 
+	if (phalcon_mvc_model_is_read_only(this_ptr TSRMLS_CC)) {
+		PHALCON_THROW_EXCEPTION_STRW(phalcon_mvc_model_exception_ce, "The record is read-only");
+		return;
+	}
+
 	PHALCON_MM_GROW();
 
 	phalcon_fetch_params(1, 0, 2, &data, &white_list);
@@ -4753,6 +6139,11 @@ PHP_METHOD(Phalcon_Mvc_Model, delete){
 	HashPosition hp0;
 	zval **hd;
 
+	if (phalcon_mvc_model_is_read_only(this_ptr TSRMLS_CC)) {
+		PHALCON_THROW_EXCEPTION_STRW(phalcon_mvc_model_exception_ce, "The record is read-only");
+		return;
+	}
+
 	PHALCON_MM_GROW();
 
 	PHALCON_CALL_METHOD(&meta_data, this_ptr, "getmodelsmetadata");
@@ -4913,6 +6304,11 @@ PHP_METHOD(Phalcon_Mvc_Model, delete){
 	 */
 	PHALCON_CALL_METHOD(&success, write_connection, "delete", table, delete_conditions, values, bind_types);
 	
+	if (zend_is_true(success)) {
+		RETURN_MM_ON_FAILURE(phalcon_mvc_model_forget_identity(this_ptr TSRMLS_CC));
+		RETURN_MM_ON_FAILURE(phalcon_mvc_model_bump_version(this_ptr TSRMLS_CC));
+	}
+	
 	/** 
 	 * Check if there is virtual foreign keys with cascade action
 	 */
@@ -5068,6 +6464,8 @@ PHP_METHOD(Phalcon_Mvc_Model, refresh){
 		PHALCON_CALL_METHOD(NULL, this_ptr, "assign", row, column_map);
 	}
 	
+	RETURN_MM_ON_FAILURE(phalcon_mvc_model_forget_identity(this_ptr TSRMLS_CC));
+	
 	PHALCON_MM_RESTORE();
 }
 
@@ -5567,15 +6965,15 @@ PHP_METHOD(Phalcon_Mvc_Model, keepSnapshots){
 
 /**
  * Sets the record's snapshot data.
- * This method is used internally to set snapshot data when the model was set up to keep snapshot data
+ * This method is used internally to set snapshot data when the model was set up to keep snapshot data.
+ * The fetched row is shared with the snapshot, a column map is only applied when the snapshot is read
  *
  * @param array $data
  * @param array $columnMap
  */
 PHP_METHOD(Phalcon_Mvc_Model, setSnapshotData){
 
-	zval *data, *column_map = NULL, *snapshot, *value = NULL, *key = NULL, *exception_message = NULL;
-	zval *attribute = NULL;
+	zval *data, *column_map = NULL, *key = NULL, *exception_message = NULL, *written;
 	HashTable *ah0;
 	HashPosition hp0;
 	zval **hd;
@@ -5594,51 +6992,43 @@ PHP_METHOD(Phalcon_Mvc_Model, setSnapshotData){
 	}
 	
 	/** 
-	 * Build the snapshot based on a column map
+	 * Every field in the snapshot must be part of the column map
 	 */
 	if (Z_TYPE_P(column_map) == IS_ARRAY) { 
 	
-		PHALCON_INIT_VAR(snapshot);
-		array_init(snapshot);
-	
 		phalcon_is_iterable(data, &ah0, &hp0, 0, 0);
 	
 		while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
 	
 			PHALCON_GET_HKEY(key, ah0, hp0);
-			PHALCON_GET_HVALUE(value);
-	
-			/** 
-			 * Use only strings
-			 */
-			if (Z_TYPE_P(key) != IS_STRING) {
-				zend_hash_move_forward_ex(ah0, &hp0);
-				continue;
-			}
 	
-			/** 
-			 * Every field must be part of the column map
-			 */
-			if (!phalcon_array_isset(column_map, key)) {
+			if (Z_TYPE_P(key) == IS_STRING && !phalcon_array_isset(column_map, key)) {
 				PHALCON_INIT_NVAR(exception_message);
 				PHALCON_CONCAT_SVS(exception_message, "Column \"", key, "\" doesn't make part of the column map");
 				PHALCON_THROW_EXCEPTION_ZVAL(phalcon_mvc_model_exception_ce, exception_message);
 				return;
 			}
 	
-			PHALCON_OBS_NVAR(attribute);
-			phalcon_array_fetch(&attribute, column_map, key, PH_NOISY);
-			phalcon_array_update_zval(&snapshot, attribute, value, PH_COPY);
-	
 			zend_hash_move_forward_ex(ah0, &hp0);
 		}
 	
-		phalcon_update_property_this(this_ptr, SL("_snapshot"), snapshot TSRMLS_CC);
-		RETURN_MM_NULL();
+		phalcon_update_property_this(this_ptr, SL("_snapshotMap"), column_map TSRMLS_CC);
+	} else {
+		phalcon_update_property_null(this_ptr, SL("_snapshotMap") TSRMLS_CC);
 	}
 	
+	/** 
+	 * The row is shared copy-on-write with the resultset
+	 */
 	phalcon_update_property_this(this_ptr, SL("_snapshot"), data TSRMLS_CC);
 	
+	/** 
+	 * Attributes written from now on are the only ones that can differ from the snapshot
+	 */
+	PHALCON_INIT_VAR(written);
+	array_init(written);
+	phalcon_update_property_this(this_ptr, SL("_written"), written TSRMLS_CC);
+	
 	PHALCON_MM_RESTORE();
 }
 
@@ -5669,8 +7059,32 @@ PHP_METHOD(Phalcon_Mvc_Model, hasSnapshotData){
  */
 PHP_METHOD(Phalcon_Mvc_Model, getSnapshotData){
 
+	zval *snapshot, *snapshot_map, *attribute, **value;
+	HashPosition hp;
+
+	snapshot     = phalcon_fetch_nproperty_this(this_ptr, SL("_snapshot"), PH_NOISY TSRMLS_CC);
+	snapshot_map = phalcon_fetch_nproperty_this(this_ptr, SL("_snapshotMap"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(snapshot) != IS_ARRAY || Z_TYPE_P(snapshot_map) != IS_ARRAY) {
+		RETURN_ZVAL(snapshot, 1, 0);
+	}
+
+	/** 
+	 * Apply the column map to the shared row
+	 */
+	array_init_size(return_value, zend_hash_num_elements(Z_ARRVAL_P(snapshot)));
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(snapshot), &hp);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(snapshot), (void**)&value, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(snapshot), &hp)
+	) {
+		zval key = phalcon_get_current_key_w(Z_ARRVAL_P(snapshot), &hp);
 
-	RETURN_MEMBER(this_ptr, "_snapshot");
+		if (Z_TYPE(key) == IS_STRING && phalcon_array_isset_fetch(&attribute, snapshot_map, &key)) {
+			Z_ADDREF_PP(value);
+			phalcon_hash_update_or_insert(Z_ARRVAL_P(return_value), attribute, *value);
+		}
+	}
 }
 
 /**
@@ -5684,7 +7098,7 @@ PHP_METHOD(Phalcon_Mvc_Model, hasChanged){
 	zval *field_name = NULL, *snapshot, *dirty_state, *meta_data = NULL;
 	zval *column_map = NULL, *attributes = NULL, *all_attributes = NULL;
 	zval *exception_message = NULL, *value = NULL, *original_value = NULL;
-	zval *type = NULL, *name = NULL;
+	zval *type = NULL, *name = NULL, *snapshot_map, *written, *snapshot_key = NULL;
 	HashTable *ah0;
 	HashPosition hp0;
 	zval **hd;
@@ -5704,6 +7118,12 @@ PHP_METHOD(Phalcon_Mvc_Model, hasChanged){
 		return;
 	}
 	
+	PHALCON_OBS_VAR(snapshot_map);
+	phalcon_read_property_this(&snapshot_map, this_ptr, SL("_snapshotMap"), PH_NOISY TSRMLS_CC);
+	
+	PHALCON_OBS_VAR(written);
+	phalcon_read_property_this(&written, this_ptr, SL("_written"), PH_NOISY TSRMLS_CC);
+	
 	if (Z_TYPE_P(field_name) != IS_STRING) {
 		if (Z_TYPE_P(field_name) != IS_NULL) {
 			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The field name must be string");
@@ -5776,21 +7196,38 @@ PHP_METHOD(Phalcon_Mvc_Model, hasChanged){
 			return;
 		}
 	
+		/** 
+		 * A snapshot taken with a column map is indexed by column
+		 */
+		if (Z_TYPE_P(snapshot_map) == IS_ARRAY && Z_TYPE_P(column_map) == IS_ARRAY) {
+			PHALCON_OBS_VAR(snapshot_key);
+			phalcon_array_fetch(&snapshot_key, column_map, field_name, PH_NOISY);
+		} else {
+			PHALCON_CPY_WRT(snapshot_key, field_name);
+		}
+	
 		/** 
 		 * The field is not part of the data snapshot, throw exception
 		 */
-		if (!phalcon_array_isset(snapshot, field_name)) {
+		if (!phalcon_array_isset(snapshot, snapshot_key)) {
 			PHALCON_INIT_NVAR(exception_message);
 			PHALCON_CONCAT_SVS(exception_message, "The field '", field_name, "' was not found in the snapshot");
 			PHALCON_THROW_EXCEPTION_ZVAL(phalcon_mvc_model_exception_ce, exception_message);
 			return;
 		}
 	
+		/** 
+		 * A field not written since the snapshot was taken can't have changed
+		 */
+		if (Z_TYPE_P(written) == IS_ARRAY && !phalcon_array_isset(written, field_name)) {
+			RETURN_MM_FALSE;
+		}
+	
 		PHALCON_OBS_VAR(value);
 		phalcon_read_property_zval(&value, this_ptr, field_name, PH_NOISY TSRMLS_CC);
 	
 		PHALCON_OBS_VAR(original_value);
-		phalcon_array_fetch(&original_value, snapshot, field_name, PH_NOISY);
+		phalcon_array_fetch(&original_value, snapshot, snapshot_key, PH_NOISY);
 	
 		/** 
 		 * Check if the field has changed
@@ -5812,14 +7249,28 @@ PHP_METHOD(Phalcon_Mvc_Model, hasChanged){
 		PHALCON_GET_HKEY(name, ah0, hp0);
 		PHALCON_GET_HVALUE(type);
 	
+		if (Z_TYPE_P(snapshot_map) == IS_ARRAY && Z_TYPE_P(column_map) == IS_ARRAY) {
+			PHALCON_CPY_WRT(snapshot_key, type);
+		} else {
+			PHALCON_CPY_WRT(snapshot_key, name);
+		}
+	
 		/** 
 		 * If some attribute is not present in the snapshot, we assume the record as
 		 * changed
 		 */
-		if (!phalcon_array_isset(snapshot, name)) {
+		if (!phalcon_array_isset(snapshot, snapshot_key)) {
 			RETURN_MM_TRUE;
 		}
 	
+		/** 
+		 * Only the written attributes are compared
+		 */
+		if (Z_TYPE_P(written) == IS_ARRAY && !phalcon_array_isset(written, name)) {
+			zend_hash_move_forward_ex(ah0, &hp0);
+			continue;
+		}
+	
 		/** 
 		 * If some attribute is not present in the model, we assume the record as changed
 		 */
@@ -5831,7 +7282,7 @@ PHP_METHOD(Phalcon_Mvc_Model, hasChanged){
 		phalcon_read_property_zval(&value, this_ptr, name, PH_NOISY TSRMLS_CC);
 	
 		PHALCON_OBS_NVAR(original_value);
-		phalcon_array_fetch(&original_value, snapshot, name, PH_NOISY);
+		phalcon_array_fetch(&original_value, snapshot, snapshot_key, PH_NOISY);
 	
 		/** 
 		 * Check if the field has changed
@@ -5856,6 +7307,7 @@ PHP_METHOD(Phalcon_Mvc_Model, getChangedFields){
 	zval *snapshot, *dirty_state, *meta_data = NULL, *column_map = NULL;
 	zval *attributes = NULL, *all_attributes = NULL, *changed;
 	zval *type = NULL, *name = NULL, *value = NULL, *original_value = NULL;
+	zval *snapshot_map, *written, *snapshot_key = NULL;
 	HashTable *ah0;
 	HashPosition hp0;
 	zval **hd;
@@ -5869,6 +7321,12 @@ PHP_METHOD(Phalcon_Mvc_Model, getChangedFields){
 		return;
 	}
 	
+	PHALCON_OBS_VAR(snapshot_map);
+	phalcon_read_property_this(&snapshot_map, this_ptr, SL("_snapshotMap"), PH_NOISY TSRMLS_CC);
+	
+	PHALCON_OBS_VAR(written);
+	phalcon_read_property_this(&written, this_ptr, SL("_written"), PH_NOISY TSRMLS_CC);
+	
 	PHALCON_OBS_VAR(dirty_state);
 	phalcon_read_property_this(&dirty_state, this_ptr, SL("_dirtyState"), PH_NOISY TSRMLS_CC);
 	
@@ -5913,16 +7371,30 @@ PHP_METHOD(Phalcon_Mvc_Model, getChangedFields){
 		PHALCON_GET_HKEY(name, ah0, hp0);
 		PHALCON_GET_HVALUE(type);
 	
+		if (Z_TYPE_P(snapshot_map) == IS_ARRAY && Z_TYPE_P(column_map) == IS_ARRAY) {
+			PHALCON_CPY_WRT(snapshot_key, type);
+		} else {
+			PHALCON_CPY_WRT(snapshot_key, name);
+		}
+	
 		/** 
 		 * If some attribute is not present in the snapshot, we assume the record as
 		 * changed
 		 */
-		if (!phalcon_array_isset(snapshot, name)) {
+		if (!phalcon_array_isset(snapshot, snapshot_key)) {
 			phalcon_array_append(&changed, name, PH_SEPARATE);
 			zend_hash_move_forward_ex(ah0, &hp0);
 			continue;
 		}
 	
+		/** 
+		 * Only the written attributes are compared
+		 */
+		if (Z_TYPE_P(written) == IS_ARRAY && !phalcon_array_isset(written, name)) {
+			zend_hash_move_forward_ex(ah0, &hp0);
+			continue;
+		}
+	
 		/** 
 		 * If some attribute is not present in the model, we assume the record as changed
 		 */
@@ -5936,7 +7408,7 @@ PHP_METHOD(Phalcon_Mvc_Model, getChangedFields){
 		phalcon_read_property_zval(&value, this_ptr, name, PH_NOISY TSRMLS_CC);
 	
 		PHALCON_OBS_NVAR(original_value);
-		phalcon_array_fetch(&original_value, snapshot, name, PH_NOISY);
+		phalcon_array_fetch(&original_value, snapshot, snapshot_key, PH_NOISY);
 	
 		/** 
 		 * Check if the field has changed
@@ -5986,6 +7458,74 @@ PHP_METHOD(Phalcon_Mvc_Model, useDynamicUpdate){
 	PHALCON_MM_RESTORE();
 }
 
+/**
+ * Sets if the records of the model queried by primary key must be kept in an identity map,
+ * so findFirst($id) and belongsTo/hasOne lookups return the same instance without a query
+ *
+ *<code>
+ *
+ *class Robots extends \Phalcon\Mvc\Model
+ *{
+ *
+ *   public function initialize()
+ *   {
+ *		$this->useIdentityMap(true);
+ *   }
+ *
+ *}
+ *</code>
+ *
+ * @param boolean $identityMap
+ */
+PHP_METHOD(Phalcon_Mvc_Model, useIdentityMap){
+
+	zval *identity_map, *manager;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &identity_map);
+	
+	PHALCON_OBS_VAR(manager);
+	phalcon_read_property_this(&manager, this_ptr, SL("_modelsManager"), PH_NOISY TSRMLS_CC);
+	PHALCON_CALL_METHOD(NULL, manager, "useidentitymap", this_ptr, identity_map);
+	
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Sets if the records of the model are hydrated as read-only instances. They skip snapshots,
+ * share the services of the base instance and reject any modification
+ *
+ *<code>
+ *
+ *class Countries extends \Phalcon\Mvc\Model
+ *{
+ *
+ *   public function initialize()
+ *   {
+ *		$this->useReadOnlyRecords(true);
+ *   }
+ *
+ *}
+ *</code>
+ *
+ * @param boolean $readOnly
+ */
+PHP_METHOD(Phalcon_Mvc_Model, useReadOnlyRecords){
+
+	zval *read_only, *manager;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &read_only);
+	
+	PHALCON_OBS_VAR(manager);
+	phalcon_read_property_this(&manager, this_ptr, SL("_modelsManager"), PH_NOISY TSRMLS_CC);
+	PHALCON_CALL_METHOD(NULL, manager, "usereadonlyrecords", this_ptr, read_only);
+	
+	PHALCON_MM_RESTORE();
+}
+
 /**
  * Returns related records based on defined relations
  *
@@ -6379,7 +7919,8 @@ PHP_METHOD(Phalcon_Mvc_Model, __set){
 PHP_METHOD(Phalcon_Mvc_Model, __get){
 
 	zval *property, *model_name, *manager = NULL, *lower_property;
-	zval *relation = NULL, *call_args, *call_object, *result;
+	zval *relation = NULL, *call_args, *call_object, *result, *related;
+	int read_only;
 
 	PHALCON_MM_GROW();
 
@@ -6393,12 +7934,33 @@ PHP_METHOD(Phalcon_Mvc_Model, __get){
 	PHALCON_INIT_VAR(lower_property);
 	phalcon_fast_strtolower(lower_property, property);
 	
+	/** 
+	 * Read-only records cannot get new attributes, their related records are only kept in the related bag
+	 */
+	read_only = phalcon_mvc_model_is_read_only(this_ptr TSRMLS_CC);
+	if (read_only) {
+		related = phalcon_fetch_nproperty_this(this_ptr, SL("_related"), PH_NOISY TSRMLS_CC);
+		if (phalcon_array_isset_fetch(&result, related, lower_property)) {
+			RETURN_CTOR(result);
+		}
+	}
+	
 	/** 
 	 * Check if the property is a relationship
 	 */
 	PHALCON_CALL_METHOD(&relation, manager, "getrelationbyalias", model_name, lower_property);
 	if (Z_TYPE_P(relation) == IS_OBJECT) {
 	
+		/** 
+		 * Related records already loaded are stored using the lowercased alias, other
+		 * attributes are never looked up with a different case
+		 */
+		if (!PHALCON_IS_EQUAL(lower_property, property) && phalcon_isset_property_zval(this_ptr, lower_property TSRMLS_CC)) {
+			PHALCON_OBS_VAR(result);
+			phalcon_read_property_zval(&result, this_ptr, lower_property, PH_NOISY TSRMLS_CC);
+			RETURN_CTOR(result);
+		}
+	
 		PHALCON_INIT_VAR(call_args);
 		array_init_size(call_args, 4);
 		phalcon_array_append(&call_args, relation, 0);
@@ -6422,6 +7984,11 @@ PHP_METHOD(Phalcon_Mvc_Model, __get){
 		 */
 		if (Z_TYPE_P(result) == IS_OBJECT) {
 	
+			if (read_only) {
+				phalcon_update_property_array(this_ptr, SL("_related"), lower_property, result TSRMLS_CC);
+				RETURN_CTOR(result);
+			}
+	
 			/** 
 			 * We assign the result to the instance avoiding future queries
 			 */
@@ -6519,6 +8086,13 @@ PHP_METHOD(Phalcon_Mvc_Model, serialize){
 		zend_hash_move_forward_ex(ah0, &hp0);
 	}
 	
+	/** 
+	 * Read-only records are unserialized as read-only records
+	 */
+	if (phalcon_mvc_model_is_read_only(this_ptr TSRMLS_CC)) {
+		phalcon_array_update_string_bool(&data, SL("_readOnly"), 1, 0);
+	}
+	
 	/** 
 	 * Use the standard serialize function to serialize the array data
 	 */
@@ -6538,6 +8112,7 @@ PHP_METHOD(Phalcon_Mvc_Model, unserialize){
 	HashTable *ah0;
 	HashPosition hp0;
 	zval **hd;
+	int read_only;
 
 	PHALCON_MM_GROW();
 
@@ -6588,6 +8163,11 @@ PHP_METHOD(Phalcon_Mvc_Model, unserialize){
 			 */
 			PHALCON_CALL_METHOD(NULL, manager, "initialize", this_ptr);
 	
+			read_only = phalcon_array_isset_string(attributes, SS("_readOnly"));
+			if (read_only) {
+				phalcon_array_unset_string(&attributes, SS("_readOnly"), 0);
+			}
+	
 			/** 
 			 * Update the objects attributes
 			 */
@@ -6603,6 +8183,13 @@ PHP_METHOD(Phalcon_Mvc_Model, unserialize){
 				zend_hash_move_forward_ex(ah0, &hp0);
 			}
 	
+			/** 
+			 * The record is flagged once the attributes are written
+			 */
+			if (read_only) {
+				phalcon_mvc_model_make_read_only(this_ptr TSRMLS_CC);
+			}
+	
 			RETURN_MM_NULL();
 		}
 	}
@@ -6716,6 +8303,7 @@ PHP_METHOD(Phalcon_Mvc_Model, toArray){
  * notNullValidations    — Enables/Disables automatic not null validation
  * exceptionOnFailedSave — Enables/Disables throws an exception if the saving process fails
  * phqlLiterals          — Enables/Disables literals in PHQL this improves the security of applications  
+ * columnarResultsets    — Minimum number of rows to store a materialized resultset by column, 0 disables it
  *
  * @param array $options
  */
@@ -6723,7 +8311,7 @@ PHP_METHOD(Phalcon_Mvc_Model, setup){
 
 	zval *options, *disable_events, *virtual_foreign_keys;
 	zval *column_renaming, *not_null_validations;
-	zval *exception_on_failed_save, *phql_literals;
+	zval *exception_on_failed_save, *phql_literals, *columnar_resultsets;
 
 	PHALCON_MM_GROW();
 
@@ -6788,11 +8376,50 @@ PHP_METHOD(Phalcon_Mvc_Model, setup){
 		PHALCON_GLOBAL(orm).enable_literals = zend_is_true(phql_literals);
 	}
 	
+	/** 
+	 * Sets the minimum number of rows to store a resultset by column
+	 */
+	if (phalcon_array_isset_string(options, SS("columnarResultsets"))) {
+		PHALCON_OBS_VAR(columnar_resultsets);
+		phalcon_array_fetch_string(&columnar_resultsets, options, SL("columnarResultsets"), PH_NOISY);
+		PHALCON_GLOBAL(orm).columnar_resultsets = phalcon_get_intval(columnar_resultsets);
+	}
+	
 	PHALCON_MM_RESTORE();
 }
 
 /**
- * Allows to delete a set of records that match the specified conditions
+ * Deletes the rows matching the conditions of remove() through a connection, the number of
+ * rows deleted is returned or false if the statement failed
+ */
+static void phalcon_mvc_model_remove_rows(zval *return_value, zval *connection, zval *table_conditions, zval *where_conditions, zval *bind_params, zval *bind_types TSRMLS_DC)
+{
+	zval *dialect = NULL, *where_expression = NULL, *success = NULL;
+
+	PHALCON_MM_GROW();
+
+	if (where_conditions && Z_TYPE_P(where_conditions) == IS_ARRAY) {
+		PHALCON_CALL_METHOD(&dialect, connection, "getdialect");
+		PHALCON_CALL_METHOD(&where_expression, dialect, "getsqlexpression", where_conditions);
+	} else if (where_conditions) {
+		PHALCON_CPY_WRT(where_expression, where_conditions);
+	} else {
+		PHALCON_INIT_VAR(where_expression);
+	}
+
+	PHALCON_CALL_METHOD(&success, connection, "delete", table_conditions, where_expression, bind_params, bind_types);
+	if (!PHALCON_IS_TRUE(success)) {
+		RETURN_MM_FALSE;
+	}
+
+	PHALCON_RETURN_CALL_METHOD(connection, "affectedrows");
+	RETURN_MM();
+}
+
+/**
+ * Allows to delete a set of records that match the specified conditions.
+ * The rows of a sharded model are deleted from the shard fixed by the conditions or from
+ * every shard, each shard in its own transaction committed once all the shards succeeded
  *
  * <code>
  *$robot = Robots::remove("id=100")
@@ -6807,8 +8434,15 @@ PHP_METHOD(Phalcon_Mvc_Model, remove){
 	zval *dependency_injector = NULL, *model_name, *manager, *model = NULL, *write_connection = NULL;
 	zval *schema = NULL, *source = NULL;
 	zval *delete_conditions = NULL, *bind_params = NULL, *bind_types = NULL;
-	zval *query, *phql, *intermediate = NULL, *dialect = NULL;
-	zval *table_conditions, *where_conditions, *where_expression = NULL, *success = NULL;
+	zval *query, *phql, *intermediate = NULL, *where_conditions = NULL;
+	zval *table_conditions, *write_connections, *connections, *affected_rows = NULL;
+	zval *service_name, *shared_manager = NULL, *shards = NULL, *shard_key = NULL;
+	zval *shard_value, *shard_service = NULL, *service = NULL;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+	long total = 0;
+	int transaction;
 
 	PHALCON_MM_GROW();
 
@@ -6888,31 +8522,110 @@ PHP_METHOD(Phalcon_Mvc_Model, remove){
 
 	PHALCON_CALL_METHOD(&intermediate, query, "parse");
 
+	if (!phalcon_array_isset_string_fetch(&where_conditions, intermediate, SS("where"))) {
+		where_conditions = NULL;
+	}
+
+	/** 
+	 * The shards and the versions of the tables are kept by the shared models manager
+	 */
+	PHALCON_INIT_VAR(service_name);
+	PHALCON_ZVAL_MAYBE_INTERNED_STRING(service_name, phalcon_interned_modelsManager);
+
+	PHALCON_CALL_METHOD(&shared_manager, dependency_injector, "getshared", service_name);
+
+	PHALCON_INIT_VAR(write_connections);
+	array_init(write_connections);
+
 	if (phalcon_method_exists_ex(model, SS("selectwriteconnection") TSRMLS_CC) == SUCCESS) {
 		PHALCON_CALL_METHOD(&write_connection, model, "selectwriteconnection", intermediate, bind_params, bind_types);
 		if (Z_TYPE_P(write_connection) != IS_OBJECT) {
 			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "'selectWriteConnection' didn't returned a valid connection");
 			return;
 		}
+
+		phalcon_array_append(&write_connections, write_connection, PH_COPY);
 	} else {
-		PHALCON_CALL_METHOD(&write_connection, model, "getwriteconnection");
-	}
+		if (Z_TYPE_P(shared_manager) == IS_OBJECT && instanceof_function(Z_OBJCE_P(shared_manager), phalcon_mvc_model_manager_ce TSRMLS_CC)) {
+			PHALCON_CALL_METHOD(&shards, shared_manager, "getshards", model);
+		}
+
+		if (shards && Z_TYPE_P(shards) == IS_ARRAY) {
+			/** 
+			 * Sharded models are deleted from the shard fixed by the conditions, or from every shard
+			 * if the conditions don't fix the shard key
+			 */
+			PHALCON_CALL_METHOD(&shard_key, shared_manager, "getshardkey", model);
+			if (where_conditions && phalcon_mvc_model_query_find_shard_value(&shard_value, where_conditions, shard_key, bind_params TSRMLS_CC) == SUCCESS) {
+				PHALCON_CALL_METHOD(&shard_service, shared_manager, "getshardservice", model, shard_value);
+
+				PHALCON_INIT_NVAR(shards);
+				array_init_size(shards, 1);
+				phalcon_array_append(&shards, shard_service, PH_COPY);
+			}
 
-	PHALCON_CALL_METHOD(&dialect, write_connection, "getdialect");
+			phalcon_is_iterable(shards, &ah0, &hp0, 0, 0);
 
-	if (phalcon_array_isset_string_fetch(&where_conditions, intermediate, SS("where"))) {		
-		if (Z_TYPE_P(where_conditions) == IS_ARRAY) { 
-			PHALCON_CALL_METHOD(&where_expression, dialect, "getsqlexpression", where_conditions);
+			while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+				PHALCON_GET_HVALUE(service);
+
+				PHALCON_CALL_METHOD(&write_connection, dependency_injector, "getshared", service);
+				if (Z_TYPE_P(write_connection) != IS_OBJECT) {
+					PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Invalid injected connection service");
+					return;
+				}
+
+				phalcon_array_append(&write_connections, write_connection, PH_COPY);
+
+				zend_hash_move_forward_ex(ah0, &hp0);
+			}
 		} else {
-			PHALCON_CPY_WRT(where_expression, where_conditions);
+			PHALCON_CALL_METHOD(&write_connection, model, "getwriteconnection");
+			phalcon_array_append(&write_connections, write_connection, PH_COPY);
 		}
 	}
 
-	PHALCON_CALL_METHOD(&success, write_connection, "delete", table_conditions, where_expression, bind_params, bind_types);
+	/** 
+	 * Every shard gets its own statement, they are committed together once all of them succeeded
+	 */
+	transaction = zend_hash_num_elements(Z_ARRVAL_P(write_connections)) > 1;
 
-	if (PHALCON_IS_TRUE(success)) {
-		PHALCON_CALL_METHOD(&success, write_connection, "affectedRows");
+	PHALCON_INIT_VAR(connections);
+	array_init(connections);
+
+	phalcon_is_iterable(write_connections, &ah0, &hp0, 0, 0);
+
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+		PHALCON_GET_HVALUE(write_connection);
+
+		if (transaction && phalcon_mvc_model_query_begin_connection(connections, write_connection TSRMLS_CC) == FAILURE) {
+			phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC);
+			RETURN_MM();
+		}
+
+		PHALCON_INIT_NVAR(affected_rows);
+		phalcon_mvc_model_remove_rows(affected_rows, write_connection, table_conditions, where_conditions, bind_params, bind_types TSRMLS_CC);
+		if (EG(exception) || PHALCON_IS_FALSE(affected_rows)) {
+			if (phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC) == FAILURE || EG(exception)) {
+				RETURN_MM();
+			}
+
+			RETURN_MM_FALSE;
+		}
+
+		total += phalcon_get_intval(affected_rows);
+
+		if (phalcon_mvc_model_manager_bump_version(shared_manager, model, write_connection TSRMLS_CC) == FAILURE) {
+			phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC);
+			RETURN_MM();
+		}
+
+		zend_hash_move_forward_ex(ah0, &hp0);
 	}
 
-	RETURN_CTOR(success);
+	RETURN_MM_ON_FAILURE(phalcon_mvc_model_query_end_connections(connections, 1 TSRMLS_CC));
+
+	RETURN_MM_LONG(total);
 }
@@ -24,6 +24,9 @@
 
 extern zend_class_entry *phalcon_mvc_model_ce;
 
+void phalcon_mvc_model_make_read_only(zval *record TSRMLS_DC);
+int phalcon_mvc_model_is_read_only(zval *record TSRMLS_DC);
+
 PHALCON_INIT_CLASS(Phalcon_Mvc_Model);
 
 #endif /* PHALCON_MVC_MODEL_H */
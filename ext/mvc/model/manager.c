@@ -26,6 +26,8 @@
 #include "diinterface.h"
 #include "di/injectionawareinterface.h"
 #include "db/adapterinterface.h"
+#include "db/adapter/pdo.h"
+#include "cache/backendinterface.h"
 #include "events/eventsawareinterface.h"
 
 #include "kernel/main.h"
@@ -41,6 +43,10 @@
 #include "kernel/hash.h"
 #include "kernel/framework/orm.h"
 
+#include <ext/standard/php_rand.h>
+#include <ext/standard/php_lcg.h>
+#include <ext/standard/crc32.h>
+
 /**
  * Phalcon\Mvc\Model\Manager
  *
@@ -82,13 +88,33 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, getWriteConnection);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, getReadConnection);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, getReadConnectionService);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, getWriteConnectionService);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, setReadConnectionCooldown);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, resetReadConnections);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, setShards);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getShards);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getShardKey);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getShardService);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, notifyEvent);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, missingMethod);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, isObserved);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, addBehavior);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, keepSnapshots);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, isKeepingSnapshots);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, useDynamicUpdate);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, isUsingDynamicUpdate);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, useIdentityMap);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, isUsingIdentityMap);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, useReadOnlyRecords);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, isUsingReadOnlyRecords);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, setVersionsCache);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getVersionsCache);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getTableVersion);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, bumpTableVersion);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, _getIdentityAttribute);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getIdentityRecord);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, setIdentityRecord);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, removeIdentityRecord);
+PHP_METHOD(Phalcon_Mvc_Model_Manager, clearIdentityMap);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, addHasOne);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, addBelongsTo);
 PHP_METHOD(Phalcon_Mvc_Model_Manager, addHasMany);
@@ -130,6 +156,10 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_getcustomeventsmanager,
 	ZEND_ARG_INFO(0, model)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_isobserved, 0, 0, 1)
+	ZEND_ARG_INFO(0, model)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_setmodelsource, 0, 0, 2)
 	ZEND_ARG_INFO(0, model)
 	ZEND_ARG_INFO(0, source)
@@ -179,6 +209,30 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_getwriteconnectionservi
 	ZEND_ARG_INFO(0, model)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_setreadconnectioncooldown, 0, 0, 1)
+	ZEND_ARG_INFO(0, seconds)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_setshards, 0, 0, 3)
+	ZEND_ARG_INFO(0, model)
+	ZEND_ARG_INFO(0, services)
+	ZEND_ARG_INFO(0, shardKey)
+	ZEND_ARG_INFO(0, resolver)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_getshards, 0, 0, 1)
+	ZEND_ARG_INFO(0, model)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_getshardkey, 0, 0, 1)
+	ZEND_ARG_INFO(0, model)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_getshardservice, 0, 0, 1)
+	ZEND_ARG_INFO(0, model)
+	ZEND_ARG_INFO(0, value)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_keepsnapshots, 0, 0, 2)
 	ZEND_ARG_INFO(0, model)
 	ZEND_ARG_INFO(0, keepSnapshots)
@@ -197,6 +251,58 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_isusingdynamicupdate, 0
 	ZEND_ARG_INFO(0, model)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_useidentitymap, 0, 0, 2)
+	ZEND_ARG_INFO(0, model)
+	ZEND_ARG_INFO(0, identityMap)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_isusingidentitymap, 0, 0, 1)
+	ZEND_ARG_INFO(0, model)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_usereadonlyrecords, 0, 0, 2)
+	ZEND_ARG_INFO(0, model)
+	ZEND_ARG_INFO(0, readOnly)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_isusingreadonlyrecords, 0, 0, 1)
+	ZEND_ARG_INFO(0, model)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_setversionscache, 0, 0, 1)
+	ZEND_ARG_INFO(0, cache)
+	ZEND_ARG_INFO(0, lifetime)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_gettableversion, 0, 0, 1)
+	ZEND_ARG_INFO(0, table)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_bumptableversion, 0, 0, 1)
+	ZEND_ARG_INFO(0, table)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager__getidentityattribute, 0, 0, 1)
+	ZEND_ARG_INFO(0, model)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_getidentityrecord, 0, 0, 2)
+	ZEND_ARG_INFO(0, modelName)
+	ZEND_ARG_INFO(0, key)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_setidentityrecord, 0, 0, 1)
+	ZEND_ARG_INFO(0, record)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_removeidentityrecord, 0, 0, 1)
+	ZEND_ARG_INFO(0, record)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_clearidentitymap, 0, 0, 0)
+	ZEND_ARG_INFO(0, modelName)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_manager_addhasmanytomany, 0, 0, 7)
 	ZEND_ARG_INFO(0, model)
 	ZEND_ARG_INFO(0, fields)
@@ -271,13 +377,33 @@ static const zend_function_entry phalcon_mvc_model_manager_method_entry[] = {
 	PHP_ME(Phalcon_Mvc_Model_Manager, getReadConnection, arginfo_phalcon_mvc_model_manager_getreadconnection, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Manager, getReadConnectionService, arginfo_phalcon_mvc_model_manager_getreadconnectionservice, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Manager, getWriteConnectionService, arginfo_phalcon_mvc_model_manager_getwriteconnectionservice, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, setReadConnectionCooldown, arginfo_phalcon_mvc_model_manager_setreadconnectioncooldown, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, resetReadConnections, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, setShards, arginfo_phalcon_mvc_model_manager_setshards, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, getShards, arginfo_phalcon_mvc_model_manager_getshards, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, getShardKey, arginfo_phalcon_mvc_model_manager_getshardkey, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, getShardService, arginfo_phalcon_mvc_model_manager_getshardservice, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Manager, notifyEvent, arginfo_phalcon_mvc_model_managerinterface_notifyevent, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Manager, missingMethod, arginfo_phalcon_mvc_model_managerinterface_missingmethod, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, isObserved, arginfo_phalcon_mvc_model_manager_isobserved, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Manager, addBehavior, arginfo_phalcon_mvc_model_managerinterface_addbehavior, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Manager, keepSnapshots, arginfo_phalcon_mvc_model_manager_keepsnapshots, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Manager, isKeepingSnapshots, arginfo_phalcon_mvc_model_manager_iskeepingsnapshots, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Manager, useDynamicUpdate, arginfo_phalcon_mvc_model_manager_usedynamicupdate, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Manager, isUsingDynamicUpdate, arginfo_phalcon_mvc_model_manager_isusingdynamicupdate, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, useIdentityMap, arginfo_phalcon_mvc_model_manager_useidentitymap, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, isUsingIdentityMap, arginfo_phalcon_mvc_model_manager_isusingidentitymap, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, useReadOnlyRecords, arginfo_phalcon_mvc_model_manager_usereadonlyrecords, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, isUsingReadOnlyRecords, arginfo_phalcon_mvc_model_manager_isusingreadonlyrecords, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, setVersionsCache, arginfo_phalcon_mvc_model_manager_setversionscache, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, getVersionsCache, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, getTableVersion, arginfo_phalcon_mvc_model_manager_gettableversion, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, bumpTableVersion, arginfo_phalcon_mvc_model_manager_bumptableversion, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, _getIdentityAttribute, arginfo_phalcon_mvc_model_manager__getidentityattribute, ZEND_ACC_PROTECTED)
+	PHP_ME(Phalcon_Mvc_Model_Manager, getIdentityRecord, arginfo_phalcon_mvc_model_manager_getidentityrecord, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, setIdentityRecord, arginfo_phalcon_mvc_model_manager_setidentityrecord, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, removeIdentityRecord, arginfo_phalcon_mvc_model_manager_removeidentityrecord, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Manager, clearIdentityMap, arginfo_phalcon_mvc_model_manager_clearidentitymap, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Manager, addHasOne, arginfo_phalcon_mvc_model_managerinterface_addhasone, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Manager, addBelongsTo, arginfo_phalcon_mvc_model_managerinterface_addbelongsto, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Manager, addHasMany, arginfo_phalcon_mvc_model_managerinterface_addhasmany, ZEND_ACC_PUBLIC)
@@ -324,6 +450,11 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Manager){
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_customEventsManager"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_readConnectionServices"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_writeConnectionServices"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_readConnectionPools"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_selectedReadServices"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_stickyConnections"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_long(phalcon_mvc_model_manager_ce, SL("_readConnectionCooldown"), 30, ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_shards"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_aliases"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_hasMany"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_hasManySingle"), ZEND_ACC_PROTECTED TSRMLS_CC);
@@ -337,11 +468,21 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Manager){
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_sources"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_schemas"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_behaviors"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_eventsMasks"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_lastInitialized"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_lastQuery"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_reusable"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_keepSnapshots"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_dynamicUpdate"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_useIdentityMap"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_identityAttributes"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_identityMap"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_readOnlyRecords"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_versionsCache"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_long(phalcon_mvc_model_manager_ce, SL("_versionsLifetime"), 86400, ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_tableVersions"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_deferredVersions"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_transactionVersions"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_manager_ce, SL("_namespaceAliases"), ZEND_ACC_PROTECTED TSRMLS_CC);
 
 	zend_class_implements(phalcon_mvc_model_manager_ce TSRMLS_CC, 3, phalcon_mvc_model_managerinterface_ce, phalcon_di_injectionawareinterface_ce, phalcon_events_eventsawareinterface_ce);
@@ -400,6 +541,145 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, getEventsManager){
 	RETURN_MEMBER(this_ptr, "_eventsManager");
 }
 
+/**
+ * Lifecycle events fired by the models, the position of an event is its bit in the events masks
+ */
+static const char* const phalcon_mvc_model_manager_events[] = {
+	"beforeValidation",
+	"beforeValidationOnCreate",
+	"beforeValidationOnUpdate",
+	"validation",
+	"afterValidationOnCreate",
+	"afterValidationOnUpdate",
+	"afterValidation",
+	"onValidationFails",
+	"beforeSave",
+	"beforeCreate",
+	"beforeUpdate",
+	"afterCreate",
+	"afterUpdate",
+	"afterSave",
+	"notSave",
+	"notSaved",
+	"beforeDelete",
+	"afterDelete",
+	"notDeleted",
+	NULL
+};
+
+/**
+ * Set in the mask of the models having behaviors or a custom events manager
+ */
+#define PHALCON_MODEL_EVENTS_OBSERVED (1L << 30)
+
+static int phalcon_mvc_model_manager_event_bit(const char *event_name, uint event_length)
+{
+	int i;
+
+	for (i = 0; phalcon_mvc_model_manager_events[i]; ++i) {
+		if (strlen(phalcon_mvc_model_manager_events[i]) == event_length && !memcmp(phalcon_mvc_model_manager_events[i], event_name, event_length)) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * Methods deciding who observes the events of the models, a subclass of the manager overriding
+ * any of them can't rely on the events masks
+ */
+static const char* const phalcon_mvc_model_manager_observers[] = {
+	"notifyevent",
+	"notifyeventcancel",
+	"addbehavior",
+	"setcustomeventsmanager",
+	NULL
+};
+
+static int phalcon_mvc_model_manager_observers_overridden(zval *manager TSRMLS_DC)
+{
+	zend_class_entry *ce = Z_OBJCE_P(manager);
+	zend_function *function;
+	int i;
+
+	if (ce == phalcon_mvc_model_manager_ce) {
+		return 0;
+	}
+
+	for (i = 0; phalcon_mvc_model_manager_observers[i]; ++i) {
+		if (zend_hash_find(&ce->function_table, phalcon_mvc_model_manager_observers[i], strlen(phalcon_mvc_model_manager_observers[i]) + 1, (void**) &function) == SUCCESS && function->common.scope != phalcon_mvc_model_manager_ce) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Computes the events mask of a model class, the masks are indexed by class entry.
+ * No mask is stored when the manager overrides how events are observed, so every
+ * handler runs for the model
+ */
+static void phalcon_mvc_model_manager_build_events_mask(zval *manager, zval *model, zval *entity_name TSRMLS_DC)
+{
+	zend_class_entry *ce = Z_OBJCE_P(model);
+	zval *behaviors, *custom_events_manager, *mask, index;
+	char *lower;
+	uint length;
+	long events = 0;
+	int i;
+
+	if (phalcon_mvc_model_manager_observers_overridden(manager TSRMLS_CC)) {
+		return;
+	}
+
+	for (i = 0; phalcon_mvc_model_manager_events[i]; ++i) {
+		length = strlen(phalcon_mvc_model_manager_events[i]);
+		lower  = zend_str_tolower_dup(phalcon_mvc_model_manager_events[i], length);
+		if (zend_hash_exists(&ce->function_table, lower, length + 1)) {
+			events |= 1L << i;
+		}
+
+		efree(lower);
+	}
+
+	behaviors = phalcon_fetch_nproperty_this(manager, SL("_behaviors"), PH_NOISY TSRMLS_CC);
+	custom_events_manager = phalcon_fetch_nproperty_this(manager, SL("_customEventsManager"), PH_NOISY TSRMLS_CC);
+	if (phalcon_array_isset(behaviors, entity_name) || phalcon_array_isset(custom_events_manager, entity_name)) {
+		events |= PHALCON_MODEL_EVENTS_OBSERVED;
+	}
+
+	INIT_ZVAL(index);
+	ZVAL_LONG(&index, (long) (zend_uintptr_t) ce);
+
+	MAKE_STD_ZVAL(mask);
+	ZVAL_LONG(mask, events);
+	phalcon_update_property_array(manager, SL("_eventsMasks"), &index, mask TSRMLS_CC);
+	zval_ptr_dtor(&mask);
+}
+
+/**
+ * Flags an already initialized model class as observed by behaviors or events managers
+ */
+static void phalcon_mvc_model_manager_observe(zval *manager, zval *model TSRMLS_DC)
+{
+	zval *masks, **mask, *observed, index;
+
+	masks = phalcon_fetch_nproperty_this(manager, SL("_eventsMasks"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(masks) != IS_ARRAY || zend_hash_index_find(Z_ARRVAL_P(masks), (ulong) (zend_uintptr_t) Z_OBJCE_P(model), (void**) &mask) != SUCCESS) {
+		return;
+	}
+
+	INIT_ZVAL(index);
+	ZVAL_LONG(&index, (long) (zend_uintptr_t) Z_OBJCE_P(model));
+
+	MAKE_STD_ZVAL(observed);
+	ZVAL_LONG(observed, Z_LVAL_PP(mask) | PHALCON_MODEL_EVENTS_OBSERVED);
+	phalcon_update_property_array(manager, SL("_eventsMasks"), &index, observed TSRMLS_CC);
+	zval_ptr_dtor(&observed);
+}
+
 /**
  * Sets a custom events manager for a specific model
  *
@@ -417,6 +697,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, setCustomEventsManager){
 	PHALCON_INIT_VAR(class_name);
 	phalcon_get_class(class_name, model, 1 TSRMLS_CC);
 	phalcon_update_property_array(this_ptr, SL("_customEventsManager"), class_name, events_manager TSRMLS_CC);
+	phalcon_mvc_model_manager_observe(this_ptr, model TSRMLS_CC);
 	
 	PHALCON_MM_RESTORE();
 }
@@ -492,6 +773,11 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, initialize){
 		PHALCON_CALL_METHOD(NULL, model, "initialize");
 	}
 	
+	/** 
+	 * Precompute which lifecycle events the model handles, so events without handlers are skipped
+	 */
+	phalcon_mvc_model_manager_build_events_mask(this_ptr, model, class_name TSRMLS_CC);
+	
 	/** 
 	 * Update the last initialized model, so it can be used in
 	 * modelsManager:afterInitialize
@@ -754,6 +1040,110 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, getModelSchema){
 	RETURN_MM_NULL();
 }
 
+/**
+ * Checks if a read connection service is cooling down after failing to connect. The
+ * failures are kept by the worker process so the cool-down outlives the request
+ */
+static int phalcon_mvc_model_manager_is_unhealthy(zval *service TSRMLS_DC)
+{
+	HashTable *unhealthy = PHALCON_GLOBAL(db).unhealthy_connections;
+	long *until;
+
+	if (unhealthy && Z_TYPE_P(service) == IS_STRING) {
+		if (zend_hash_find(unhealthy, Z_STRVAL_P(service), Z_STRLEN_P(service) + 1, (void**)&until) == SUCCESS) {
+			return *until > (long) time(NULL);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Leaves a read connection service out of its pools for some seconds
+ */
+static void phalcon_mvc_model_manager_set_unhealthy(zval *service, long seconds TSRMLS_DC)
+{
+	HashTable **unhealthy = &PHALCON_GLOBAL(db).unhealthy_connections;
+	long until = (long) time(NULL) + seconds;
+
+	if (Z_TYPE_P(service) != IS_STRING) {
+		return;
+	}
+
+	if (!*unhealthy) {
+		*unhealthy = pemalloc(sizeof(HashTable), 1);
+		zend_hash_init(*unhealthy, 4, NULL, NULL, 1);
+	}
+
+	zend_hash_update(*unhealthy, Z_STRVAL_P(service), Z_STRLEN_P(service) + 1, &until, sizeof(long), NULL);
+}
+
+/**
+ * Checks if a replica of a pool can be picked, returning its service and weight
+ */
+static int phalcon_mvc_model_manager_is_available(zval *replica, zval **replica_service, zval **weight, zval *tried TSRMLS_DC)
+{
+	if (!phalcon_array_isset_long_fetch(replica_service, replica, 0) || !phalcon_array_isset_long_fetch(weight, replica, 1)) {
+		return 0;
+	}
+
+	return !phalcon_array_isset(tried, *replica_service) && !phalcon_mvc_model_manager_is_unhealthy(*replica_service TSRMLS_CC);
+}
+
+/**
+ * Picks a service from a pool of read replicas according to their weights. The replica
+ * selected is kept for the rest of the request, and shared by the other pools including it,
+ * until it fails or the read connections are reset
+ */
+static int phalcon_mvc_model_manager_pick_replica(zval *service, zval *this_ptr, zval *pool, zval *tried TSRMLS_DC)
+{
+	zval *selected_services, *replica_service, *weight;
+	zval **hd;
+	HashTable *ah;
+	HashPosition hp;
+	long total = 0, point;
+
+	selected_services = phalcon_fetch_nproperty_this(this_ptr, SL("_selectedReadServices"), PH_NOISY TSRMLS_CC);
+
+	ah = Z_ARRVAL_P(pool);
+	for (
+		zend_hash_internal_pointer_reset_ex(ah, &hp);
+		zend_hash_get_current_data_ex(ah, (void**)&hd, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(ah, &hp)
+	) {
+		if (phalcon_mvc_model_manager_is_available(*hd, &replica_service, &weight, tried TSRMLS_CC)) {
+			if (phalcon_array_isset(selected_services, replica_service)) {
+				ZVAL_ZVAL(service, replica_service, 1, 0);
+				return SUCCESS;
+			}
+
+			total += phalcon_get_intval(weight);
+		}
+	}
+
+	if (total <= 0) {
+		return FAILURE;
+	}
+
+	point = php_rand(TSRMLS_C) % total;
+	for (
+		zend_hash_internal_pointer_reset_ex(ah, &hp);
+		zend_hash_get_current_data_ex(ah, (void**)&hd, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(ah, &hp)
+	) {
+		if (phalcon_mvc_model_manager_is_available(*hd, &replica_service, &weight, tried TSRMLS_CC)) {
+			point -= phalcon_get_intval(weight);
+			if (point < 0) {
+				ZVAL_ZVAL(service, replica_service, 1, 0);
+				phalcon_update_property_array(this_ptr, SL("_selectedReadServices"), service, PHALCON_GLOBAL(z_true) TSRMLS_CC);
+				return SUCCESS;
+			}
+		}
+	}
+
+	return FAILURE;
+}
+
 /**
  * Sets both write and read connection service for a model
  *
@@ -777,6 +1167,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, setConnectionService){
 	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
 	phalcon_update_property_array(this_ptr, SL("_readConnectionServices"), entity_name, connection_service TSRMLS_CC);
 	phalcon_update_property_array(this_ptr, SL("_writeConnectionServices"), entity_name, connection_service TSRMLS_CC);
+	phalcon_unset_property_array(this_ptr, SL("_readConnectionPools"), entity_name TSRMLS_CC);
 	
 	PHALCON_MM_RESTORE();
 }
@@ -808,31 +1199,135 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, setWriteConnectionService){
 }
 
 /**
- * Sets read connection service for a model
+ * Sets read connection service for a model. A list of services, or an array of services
+ * and their weights, spreads the reads across several replicas
+ *
+ *<code>
+ * $manager->setReadConnectionService($robot, array('dbReplicaOne' => 3, 'dbReplicaTwo' => 1));
+ *</code>
  *
  * @param Phalcon\Mvc\ModelInterface $model
- * @param string $connectionService
+ * @param string|array $connectionService
  */
 PHP_METHOD(Phalcon_Mvc_Model_Manager, setReadConnectionService){
 
-	zval *model, *connection_service, *entity_name;
+	zval *model, *connection_service, *entity_name, *pool;
+	zval *key = NULL, *value = NULL, *replica = NULL;
+	zval *service;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+	long weight;
 
 	PHALCON_MM_GROW();
 
 	phalcon_fetch_params(1, 2, 0, &model, &connection_service);
 	
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+
+	if (Z_TYPE_P(connection_service) == IS_ARRAY) {
+	
+		PHALCON_INIT_VAR(pool);
+		array_init(pool);
+	
+		phalcon_is_iterable(connection_service, &ah0, &hp0, 0, 0);
+	
+		while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+			PHALCON_GET_HKEY(key, ah0, hp0);
+			PHALCON_GET_HVALUE(value);
+	
+			/** 
+			 * Services without a weight are picked with the same probability
+			 */
+			if (Z_TYPE_P(key) == IS_STRING) {
+				service = key;
+				weight  = phalcon_get_intval(value);
+			} else {
+				service = value;
+				weight  = 1;
+			}
+	
+			if (Z_TYPE_P(service) != IS_STRING) {
+				PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The connection service must be a string");
+				return;
+			}
+	
+			if (weight > 0) {
+				PHALCON_INIT_NVAR(replica);
+				array_init_size(replica, 2);
+				phalcon_array_append(&replica, service, 0);
+				add_next_index_long(replica, weight);
+				phalcon_array_append(&pool, replica, 0);
+			}
+	
+			zend_hash_move_forward_ex(ah0, &hp0);
+		}
+	
+		if (!zend_hash_num_elements(Z_ARRVAL_P(pool))) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The pool of read connection services cannot be empty");
+			return;
+		}
+	
+		phalcon_update_property_array(this_ptr, SL("_readConnectionPools"), entity_name, pool TSRMLS_CC);
+		RETURN_MM_NULL();
+	}
+
 	if (Z_TYPE_P(connection_service) != IS_STRING) {
 		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The connection service must be a string");
 		return;
 	}
 	
-	PHALCON_INIT_VAR(entity_name);
-	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
 	phalcon_update_property_array(this_ptr, SL("_readConnectionServices"), entity_name, connection_service TSRMLS_CC);
+	phalcon_unset_property_array(this_ptr, SL("_readConnectionPools"), entity_name TSRMLS_CC);
 	
 	PHALCON_MM_RESTORE();
 }
 
+/**
+ * Records of a sharded model are written to the shard of their key, a record without a value
+ * in the key cannot be placed. The model itself (the instance kept by load()) is only used to
+ * reach a connection for the metadata and the SQL dialect
+ */
+static int phalcon_mvc_model_manager_check_shard_key(zval *this_ptr, zval *model TSRMLS_DC) {
+
+	zval *shards, *entity_name, *shard, *shard_key, *initialized, *base, *value;
+	int status = SUCCESS;
+
+	shards = phalcon_fetch_nproperty_this(this_ptr, SL("_shards"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(shards) != IS_ARRAY || Z_TYPE_P(model) != IS_OBJECT) {
+		return SUCCESS;
+	}
+
+	MAKE_STD_ZVAL(entity_name);
+	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+
+	if (phalcon_array_isset_fetch(&shard, shards, entity_name) && phalcon_array_isset_string_fetch(&shard_key, shard, SS("key"))) {
+
+		initialized = phalcon_fetch_nproperty_this(this_ptr, SL("_initialized"), PH_NOISY TSRMLS_CC);
+		if (!phalcon_array_isset_fetch(&base, initialized, entity_name) || Z_TYPE_P(base) != IS_OBJECT || Z_OBJ_HANDLE_P(base) != Z_OBJ_HANDLE_P(model)) {
+
+			value = NULL;
+			if (phalcon_isset_property_zval(model, shard_key TSRMLS_CC)) {
+				phalcon_read_property_zval(&value, model, shard_key, PH_NOISY TSRMLS_CC);
+			}
+
+			if (!value || Z_TYPE_P(value) == IS_NULL) {
+				zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "The shard key '%s' of the sharded model '%s' must have a value to write the record", Z_STRVAL_P(shard_key), Z_OBJCE_P(model)->name);
+				status = FAILURE;
+			}
+
+			if (value) {
+				zval_ptr_dtor(&value);
+			}
+		}
+	}
+
+	zval_ptr_dtor(&entity_name);
+	return status;
+}
+
 /**
  * Returns the connection to write data related to a model
  *
@@ -841,29 +1336,41 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, setReadConnectionService){
  */
 PHP_METHOD(Phalcon_Mvc_Model_Manager, getWriteConnection){
 
-	zval *model, *service = NULL, *connection_services;
+	zval *model, *service = NULL, *shard_service = NULL, *connection_services;
 	zval *entity_name, *dependency_injector, *connection = NULL;
 
 	PHALCON_MM_GROW();
 
 	phalcon_fetch_params(1, 1, 0, &model);
 	
-	PHALCON_INIT_VAR(service);
-	ZVAL_STRING(service, "db", 1);
+	/** 
+	 * Records of sharded models are written to their own shard
+	 */
+	if (Z_TYPE_P(phalcon_fetch_nproperty_this(this_ptr, SL("_shards"), PH_NOISY TSRMLS_CC)) == IS_ARRAY) {
+		RETURN_MM_ON_FAILURE(phalcon_mvc_model_manager_check_shard_key(this_ptr, model TSRMLS_CC));
+		PHALCON_CALL_METHOD(&shard_service, this_ptr, "getshardservice", model);
+	}
 	
-	PHALCON_OBS_VAR(connection_services);
-	phalcon_read_property_this(&connection_services, this_ptr, SL("_writeConnectionServices"), PH_NOISY TSRMLS_CC);
-	if (Z_TYPE_P(connection_services) == IS_ARRAY) { 
+	if (shard_service && Z_TYPE_P(shard_service) == IS_STRING) {
+		PHALCON_CPY_WRT(service, shard_service);
+	} else {
+		PHALCON_INIT_VAR(service);
+		ZVAL_STRING(service, "db", 1);
 	
-		PHALCON_INIT_VAR(entity_name);
-		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+		PHALCON_OBS_VAR(connection_services);
+		phalcon_read_property_this(&connection_services, this_ptr, SL("_writeConnectionServices"), PH_NOISY TSRMLS_CC);
+		if (Z_TYPE_P(connection_services) == IS_ARRAY) { 
 	
-		/** 
-		 * Check if the model has a custom connection service
-		 */
-		if (phalcon_array_isset(connection_services, entity_name)) {
-			PHALCON_OBS_NVAR(service);
-			phalcon_array_fetch(&service, connection_services, entity_name, PH_NOISY);
+			PHALCON_INIT_VAR(entity_name);
+			phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+	
+			/** 
+			 * Check if the model has a custom connection service
+			 */
+			if (phalcon_array_isset(connection_services, entity_name)) {
+				PHALCON_OBS_NVAR(service);
+				phalcon_array_fetch(&service, connection_services, entity_name, PH_NOISY);
+			}
 		}
 	}
 	
@@ -884,6 +1391,12 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, getWriteConnection){
 	}
 	
 	PHALCON_VERIFY_INTERFACE(connection, phalcon_db_adapterinterface_ce);
+
+	/** 
+	 * Pooled reads of the models sharing this connection must see what is written from now on
+	 */
+	phalcon_update_property_array(this_ptr, SL("_stickyConnections"), service, PHALCON_GLOBAL(z_true) TSRMLS_CC);
+
 	RETURN_CTOR(connection);
 }
 
@@ -895,31 +1408,19 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, getWriteConnection){
  */
 PHP_METHOD(Phalcon_Mvc_Model_Manager, getReadConnection){
 
-	zval *model, *service = NULL, *connection_services;
+	zval *model, *service = NULL, *shard_service = NULL, *connection_services;
 	zval *entity_name, *dependency_injector, *connection = NULL;
+	zval *pools, *pool, *sticky_connections, *write_service = NULL;
+	zval *tried, *cooldown;
+	zval *params[1];
+	zend_class_entry *pdo_exception_ce;
 
 	PHALCON_MM_GROW();
 
 	phalcon_fetch_params(1, 1, 0, &model);
 	
-	PHALCON_INIT_VAR(service);
-	ZVAL_STRING(service, "db", 1);
-	
-	PHALCON_OBS_VAR(connection_services);
-	phalcon_read_property_this(&connection_services, this_ptr, SL("_readConnectionServices"), PH_NOISY TSRMLS_CC);
-	if (Z_TYPE_P(connection_services) == IS_ARRAY) { 
-	
-		PHALCON_INIT_VAR(entity_name);
-		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
-	
-		/** 
-		 * Check if the model has a custom connection service
-		 */
-		if (phalcon_array_isset(connection_services, entity_name)) {
-			PHALCON_OBS_NVAR(service);
-			phalcon_array_fetch(&service, connection_services, entity_name, PH_NOISY);
-		}
-	}
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
 	
 	PHALCON_OBS_VAR(dependency_injector);
 	phalcon_read_property_this(&dependency_injector, this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
@@ -929,40 +1430,161 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, getReadConnection){
 	}
 	
 	/** 
-	 * Request the connection service from the DI
+	 * Records of sharded models are read from their own shard
 	 */
-	PHALCON_CALL_METHOD(&connection, dependency_injector, "getshared", service);
-	if (Z_TYPE_P(connection) != IS_OBJECT) {
-		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Invalid injected connection service");
-		return;
+	if (Z_TYPE_P(phalcon_fetch_nproperty_this(this_ptr, SL("_shards"), PH_NOISY TSRMLS_CC)) == IS_ARRAY) {
+		PHALCON_CALL_METHOD(&shard_service, this_ptr, "getshardservice", model);
 	}
 	
-	PHALCON_VERIFY_INTERFACE(connection, phalcon_db_adapterinterface_ce);
-	RETURN_CTOR(connection);
-}
-
-/**
- * Returns the connection service name used to read data related to a model
- *
- * @param Phalcon\Mvc\ModelInterface $model
- * @param string
- */
-PHP_METHOD(Phalcon_Mvc_Model_Manager, getReadConnectionService){
-
-	zval *model, *connection_services, *entity_name;
-	zval *connection;
+	PHALCON_OBS_VAR(pools);
+	phalcon_read_property_this(&pools, this_ptr, SL("_readConnectionPools"), PH_NOISY TSRMLS_CC);
+	if (shard_service && Z_TYPE_P(shard_service) == IS_STRING) {
+		PHALCON_CALL_METHOD(&connection, dependency_injector, "getshared", shard_service);
+	} else if (phalcon_array_isset(pools, entity_name)) {
+	
+		PHALCON_OBS_VAR(pool);
+		phalcon_array_fetch(&pool, pools, entity_name, PH_NOISY);
+	
+		PHALCON_CALL_METHOD(&write_service, this_ptr, "getwriteconnectionservice", model);
+	
+		/** 
+		 * Once the write connection was used, reads go to it to see their own writes
+		 */
+		sticky_connections = phalcon_fetch_nproperty_this(this_ptr, SL("_stickyConnections"), PH_NOISY TSRMLS_CC);
+		if (!phalcon_array_isset(sticky_connections, write_service)) {
+	
+			PHALCON_INIT_VAR(tried);
+			array_init(tried);
+	
+			PHALCON_INIT_VAR(service);
+			while (phalcon_mvc_model_manager_pick_replica(service, this_ptr, pool, tried TSRMLS_CC) == SUCCESS) {
+	
+				params[0] = service;
+				PHALCON_OBSERVE_OR_NULLIFY_PPZV(&connection);
+				if (phalcon_call_method(&connection, dependency_injector, "getshared", 1, params TSRMLS_CC) == SUCCESS) {
+					break;
+				}
+	
+				/** 
+				 * Only connection failures move the read to another replica
+				 */
+				pdo_exception_ce = zend_fetch_class(SL("PDOException"), ZEND_FETCH_CLASS_NO_AUTOLOAD | ZEND_FETCH_CLASS_SILENT TSRMLS_CC);
+				if (!EG(exception) || !pdo_exception_ce || !instanceof_function(Z_OBJCE_P(EG(exception)), pdo_exception_ce TSRMLS_CC)) {
+					RETURN_MM();
+				}
+	
+				/** 
+				 * The replica could not connect, leave it out until its cool-down expires
+				 */
+				zend_clear_exception(TSRMLS_C);
+	
+				cooldown = phalcon_fetch_nproperty_this(this_ptr, SL("_readConnectionCooldown"), PH_NOISY TSRMLS_CC);
+	
+				phalcon_mvc_model_manager_set_unhealthy(service, phalcon_get_intval(cooldown) TSRMLS_CC);
+				phalcon_unset_property_array(this_ptr, SL("_selectedReadServices"), service TSRMLS_CC);
+				phalcon_array_update_zval_bool(&tried, service, 1, 0);
+	
+				PHALCON_INIT_NVAR(service);
+			}
+	
+			/** 
+			 * Every replica is down, read from the write connection
+			 */
+			if (!connection) {
+				PHALCON_CPY_WRT(service, write_service);
+			}
+		} else {
+			PHALCON_CPY_WRT(service, write_service);
+		}
+	} else {
+		PHALCON_INIT_VAR(service);
+		ZVAL_STRING(service, "db", 1);
+	
+		PHALCON_OBS_VAR(connection_services);
+		phalcon_read_property_this(&connection_services, this_ptr, SL("_readConnectionServices"), PH_NOISY TSRMLS_CC);
+	
+		/** 
+		 * Check if the model has a custom connection service
+		 */
+		if (phalcon_array_isset(connection_services, entity_name)) {
+			PHALCON_OBS_NVAR(service);
+			phalcon_array_fetch(&service, connection_services, entity_name, PH_NOISY);
+		}
+	}
+	
+	/** 
+	 * Request the connection service from the DI
+	 */
+	if (!connection) {
+		PHALCON_CALL_METHOD(&connection, dependency_injector, "getshared", service);
+	}
+	
+	if (Z_TYPE_P(connection) != IS_OBJECT) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Invalid injected connection service");
+		return;
+	}
+	
+	PHALCON_VERIFY_INTERFACE(connection, phalcon_db_adapterinterface_ce);
+	RETURN_CTOR(connection);
+}
+
+/**
+ * Returns the connection service name used to read data related to a model
+ *
+ * @param Phalcon\Mvc\ModelInterface $model
+ * @param string
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getReadConnectionService){
+
+	zval *model, *connection_services, *entity_name;
+	zval *connection, *pools, *pool, *sticky_connections, *tried, *service;
+	zval *write_service = NULL, *shard_service = NULL;
 
 	PHALCON_MM_GROW();
 
 	phalcon_fetch_params(1, 1, 0, &model);
 	
+	if (Z_TYPE_P(phalcon_fetch_nproperty_this(this_ptr, SL("_shards"), PH_NOISY TSRMLS_CC)) == IS_ARRAY) {
+		PHALCON_CALL_METHOD(&shard_service, this_ptr, "getshardservice", model);
+		if (Z_TYPE_P(shard_service) == IS_STRING) {
+			RETURN_CTOR(shard_service);
+		}
+	}
+	
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+	
+	/** 
+	 * Pooled models report the replica currently selected
+	 */
+	PHALCON_OBS_VAR(pools);
+	phalcon_read_property_this(&pools, this_ptr, SL("_readConnectionPools"), PH_NOISY TSRMLS_CC);
+	if (phalcon_array_isset(pools, entity_name)) {
+	
+		PHALCON_OBS_VAR(pool);
+		phalcon_array_fetch(&pool, pools, entity_name, PH_NOISY);
+	
+		PHALCON_CALL_METHOD(&write_service, this_ptr, "getwriteconnectionservice", model);
+	
+		sticky_connections = phalcon_fetch_nproperty_this(this_ptr, SL("_stickyConnections"), PH_NOISY TSRMLS_CC);
+		if (!phalcon_array_isset(sticky_connections, write_service)) {
+	
+			PHALCON_INIT_VAR(tried);
+			array_init(tried);
+	
+			PHALCON_INIT_VAR(service);
+			if (phalcon_mvc_model_manager_pick_replica(service, this_ptr, pool, tried TSRMLS_CC) == SUCCESS) {
+				RETURN_CTOR(service);
+			}
+		}
+	
+		RETURN_CTOR(write_service);
+	}
+	
 	PHALCON_OBS_VAR(connection_services);
 	phalcon_read_property_this(&connection_services, this_ptr, SL("_readConnectionServices"), PH_NOISY TSRMLS_CC);
 	if (Z_TYPE_P(connection_services) == IS_ARRAY) { 
 	
-		PHALCON_INIT_VAR(entity_name);
-		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
-	
 		/** 
 		 * Check if there is a custom service connection name
 		 */
@@ -985,12 +1607,20 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, getReadConnectionService){
 PHP_METHOD(Phalcon_Mvc_Model_Manager, getWriteConnectionService){
 
 	zval *model, *connection_services, *entity_name;
-	zval *connection;
+	zval *connection, *shard_service = NULL;
 
 	PHALCON_MM_GROW();
 
 	phalcon_fetch_params(1, 1, 0, &model);
 	
+	if (Z_TYPE_P(phalcon_fetch_nproperty_this(this_ptr, SL("_shards"), PH_NOISY TSRMLS_CC)) == IS_ARRAY) {
+		RETURN_MM_ON_FAILURE(phalcon_mvc_model_manager_check_shard_key(this_ptr, model TSRMLS_CC));
+		PHALCON_CALL_METHOD(&shard_service, this_ptr, "getshardservice", model);
+		if (Z_TYPE_P(shard_service) == IS_STRING) {
+			RETURN_CTOR(shard_service);
+		}
+	}
+	
 	PHALCON_OBS_VAR(connection_services);
 	phalcon_read_property_this(&connection_services, this_ptr, SL("_writeConnectionServices"), PH_NOISY TSRMLS_CC);
 	if (Z_TYPE_P(connection_services) == IS_ARRAY) { 
@@ -1011,6 +1641,252 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, getWriteConnectionService){
 	RETURN_MM_STRING("db", 1);
 }
 
+/**
+ * Sets the number of seconds a read replica is left out after failing to connect
+ *
+ * @param int $seconds
+ * @return Phalcon\Mvc\Model\Manager
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, setReadConnectionCooldown){
+
+	zval **seconds;
+
+	phalcon_fetch_params_ex(1, 0, &seconds);
+	
+	PHALCON_ENSURE_IS_LONG(seconds);
+	
+	phalcon_update_property_this(this_ptr, SL("_readConnectionCooldown"), *seconds TSRMLS_CC);
+	RETURN_THISW();
+}
+
+/**
+ * Forgets the replicas selected and the connections written so far, so the next reads are
+ * spread across the pools again. Replicas cooling down stay out until their cool-down expires
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, resetReadConnections){
+
+	phalcon_update_property_null(this_ptr, SL("_selectedReadServices") TSRMLS_CC);
+	phalcon_update_property_null(this_ptr, SL("_stickyConnections") TSRMLS_CC);
+}
+
+/**
+ * Splits the records of a model across several connection services (shards). The shard of
+ * a record is chosen from the value of its shard key: a resolver receives the value and the
+ * model and returns the index of the service in $services, without a resolver integers are
+ * taken modulo the number of shards and any other value is hashed with crc32 first.
+ * Writing a record without a value in the shard key throws an exception, the model itself
+ * and records read without the key use the first shard
+ *
+ *<code>
+ * $modelsManager->setShards(new Invoices(), array('invoicesShard0', 'invoicesShard1'), 'customers_id');
+ *</code>
+ *
+ * @param Phalcon\Mvc\ModelInterface $model
+ * @param array $services
+ * @param string $shardKey
+ * @param callable $resolver
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, setShards){
+
+	zval *model, *services, *shard_key, *resolver = NULL, *entity_name, *shard;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 3, 1, &model, &services, &shard_key, &resolver);
+	
+	if (!resolver) {
+		resolver = PHALCON_GLOBAL(z_null);
+	}
+	
+	if (Z_TYPE_P(services) != IS_ARRAY || !zend_hash_num_elements(Z_ARRVAL_P(services))) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The shards must be a non-empty array of connection services");
+		return;
+	}
+	
+	if (Z_TYPE_P(shard_key) != IS_STRING) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The shard key must be a string");
+		return;
+	}
+	
+	if (Z_TYPE_P(resolver) != IS_NULL && !phalcon_is_callable(resolver TSRMLS_CC)) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The shard resolver must be callable");
+		return;
+	}
+	
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+	
+	PHALCON_INIT_VAR(shard);
+	array_init_size(shard, 3);
+	phalcon_array_update_string(&shard, SL("services"), services, PH_COPY);
+	phalcon_array_update_string(&shard, SL("key"), shard_key, PH_COPY);
+	phalcon_array_update_string(&shard, SL("resolver"), resolver, PH_COPY);
+	
+	phalcon_update_property_array(this_ptr, SL("_shards"), entity_name, shard TSRMLS_CC);
+	
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Returns the connection services of the shards of a model, null if the model is not sharded
+ *
+ * @param Phalcon\Mvc\ModelInterface $model
+ * @return array
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getShards){
+
+	zval *model, *shards, *entity_name, *shard, *services;
+
+	phalcon_fetch_params(0, 1, 0, &model);
+	
+	shards = phalcon_fetch_nproperty_this(this_ptr, SL("_shards"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(shards) == IS_ARRAY) {
+	
+		PHALCON_MM_GROW();
+	
+		PHALCON_INIT_VAR(entity_name);
+		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+		if (phalcon_array_isset_fetch(&shard, shards, entity_name) && phalcon_array_isset_string_fetch(&services, shard, SS("services"))) {
+			RETURN_CTOR(services);
+		}
+	
+		PHALCON_MM_RESTORE();
+	}
+	
+	RETURN_NULL();
+}
+
+/**
+ * Returns the attribute that chooses the shard of the records of a model
+ *
+ * @param Phalcon\Mvc\ModelInterface $model
+ * @return string
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getShardKey){
+
+	zval *model, *shards, *entity_name, *shard, *shard_key;
+
+	phalcon_fetch_params(0, 1, 0, &model);
+	
+	shards = phalcon_fetch_nproperty_this(this_ptr, SL("_shards"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(shards) == IS_ARRAY) {
+	
+		PHALCON_MM_GROW();
+	
+		PHALCON_INIT_VAR(entity_name);
+		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+		if (phalcon_array_isset_fetch(&shard, shards, entity_name) && phalcon_array_isset_string_fetch(&shard_key, shard, SS("key"))) {
+			RETURN_CTOR(shard_key);
+		}
+	
+		PHALCON_MM_RESTORE();
+	}
+	
+	RETURN_NULL();
+}
+
+/**
+ * Returns the connection service of the shard that holds a value of the shard key. If no value
+ * is passed the shard key of the record is used. Returns null if the model is not sharded
+ *
+ * @param Phalcon\Mvc\ModelInterface $model
+ * @param mixed $value
+ * @return string
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getShardService){
+
+	zval *model, *value = NULL, *shards, *entity_name, *shard, *services;
+	zval *shard_key, *resolver, *key_value = NULL, *params, *index, *service, *hashed;
+	HashPosition hp;
+	zval **hd;
+	unsigned int crc;
+	long position, number_shards;
+	int i;
+
+	phalcon_fetch_params(0, 1, 1, &model, &value);
+	
+	shards = phalcon_fetch_nproperty_this(this_ptr, SL("_shards"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(shards) != IS_ARRAY) {
+		RETURN_NULL();
+	}
+	
+	PHALCON_MM_GROW();
+	
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+	if (!phalcon_array_isset_fetch(&shard, shards, entity_name)) {
+		RETURN_MM_NULL();
+	}
+	
+	phalcon_array_isset_string_fetch(&services, shard, SS("services"));
+	phalcon_array_isset_string_fetch(&shard_key, shard, SS("key"));
+	phalcon_array_isset_string_fetch(&resolver, shard, SS("resolver"));
+	
+	/** 
+	 * Records carry the value of their shard key
+	 */
+	if (value && Z_TYPE_P(value) != IS_NULL) {
+		PHALCON_CPY_WRT(key_value, value);
+	} else if (Z_TYPE_P(model) == IS_OBJECT && phalcon_isset_property_zval(model, shard_key TSRMLS_CC)) {
+		PHALCON_OBS_VAR(key_value);
+		phalcon_read_property_zval(&key_value, model, shard_key, PH_NOISY TSRMLS_CC);
+	}
+	
+	zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(services), &hp);
+	if (key_value && Z_TYPE_P(key_value) != IS_NULL) {
+	
+		if (Z_TYPE_P(resolver) != IS_NULL) {
+			PHALCON_INIT_VAR(params);
+			array_init_size(params, 2);
+			phalcon_array_append(&params, key_value, 0);
+			phalcon_array_append(&params, model, 0);
+	
+			PHALCON_INIT_VAR(index);
+			PHALCON_CALL_USER_FUNC_ARRAY(index, resolver, params);
+	
+			if (!phalcon_array_isset_fetch(&service, services, index)) {
+				PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The shard resolver returned an unknown shard");
+				return;
+			}
+	
+			RETURN_CTOR(service);
+		}
+	
+		/** 
+		 * Integers (or numeric strings, as returned by most drivers) are taken modulo the
+		 * number of shards, anything else is hashed before
+		 */
+		number_shards = zend_hash_num_elements(Z_ARRVAL_P(services));
+		if (Z_TYPE_P(key_value) == IS_LONG) {
+			position = Z_LVAL_P(key_value) % number_shards;
+		} else if (Z_TYPE_P(key_value) == IS_STRING && is_numeric_string(Z_STRVAL_P(key_value), Z_STRLEN_P(key_value), &position, NULL, 0) == IS_LONG) {
+			position %= number_shards;
+		} else {
+			PHALCON_INIT_VAR(hashed);
+			ZVAL_ZVAL(hashed, key_value, 1, 0);
+			convert_to_string(hashed);
+	
+			crc = 0xFFFFFFFF;
+			for (i = 0; i < Z_STRLEN_P(hashed); i++) {
+				CRC32(crc, Z_STRVAL_P(hashed)[i]);
+			}
+	
+			position = (long) ((crc ^ 0xFFFFFFFF) % (unsigned int) number_shards);
+		}
+	
+		if (position < 0) {
+			position += number_shards;
+		}
+	
+		while (position-- > 0) {
+			zend_hash_move_forward_ex(Z_ARRVAL_P(services), &hp);
+		}
+	}
+	
+	zend_hash_get_current_data_ex(Z_ARRVAL_P(services), (void**) &hd, &hp);
+	RETURN_CTOR(*hd);
+}
+
 /**
  * Receives events generated in the models and dispatches them to a events-manager if available
  * Notify the behaviors that are listening in the model
@@ -1077,250 +1953,1055 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, notifyEvent){
 			RETURN_CTOR(status);
 		}
 	}
-	
-	/** 
-	 * A model can has a specific events manager for it
-	 */
-	custom_events_manager = phalcon_fetch_nproperty_this(this_ptr, SL("_customEventsManager"), PH_NOISY TSRMLS_CC);
-	if (Z_TYPE_P(custom_events_manager) == IS_ARRAY) { 
-	
-		PHALCON_INIT_NVAR(entity_name);
-		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
-		if (phalcon_array_isset_fetch(&mgr, custom_events_manager, entity_name)) {
-	
-			PHALCON_INIT_NVAR(fire_event_name);
-			PHALCON_CONCAT_SV(fire_event_name, "model:", event_name);
-	
-			PHALCON_CALL_METHOD(&status, mgr, "fire", fire_event_name, model);
-			if (PHALCON_IS_FALSE(status)) {
-				RETURN_CTOR(status);
-			}
-		}
+	
+	/** 
+	 * A model can has a specific events manager for it
+	 */
+	custom_events_manager = phalcon_fetch_nproperty_this(this_ptr, SL("_customEventsManager"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(custom_events_manager) == IS_ARRAY) { 
+	
+		PHALCON_INIT_NVAR(entity_name);
+		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+		if (phalcon_array_isset_fetch(&mgr, custom_events_manager, entity_name)) {
+	
+			PHALCON_INIT_NVAR(fire_event_name);
+			PHALCON_CONCAT_SV(fire_event_name, "model:", event_name);
+	
+			PHALCON_CALL_METHOD(&status, mgr, "fire", fire_event_name, model);
+			if (PHALCON_IS_FALSE(status)) {
+				RETURN_CTOR(status);
+			}
+		}
+	}
+	
+	RETURN_CTOR(status);
+}
+
+/**
+ * Dispatch a event to the listeners and behaviors
+ * This method expects that the endpoint listeners/behaviors returns true
+ * meaning that a least one is implemented
+ *
+ * @param Phalcon\Mvc\ModelInterface $model
+ * @param string $eventName
+ * @param array $data
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, missingMethod){
+
+	zval *model, *event_name, *data, *behaviors, *entity_name;
+	zval *models_behaviors, *behavior = NULL, *result = NULL, *events_manager;
+	zval *fire_event_name;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 3, 0, &model, &event_name, &data);
+	
+	/** 
+	 * Dispatch events to the global events manager
+	 */
+	PHALCON_OBS_VAR(behaviors);
+	phalcon_read_property_this(&behaviors, this_ptr, SL("_behaviors"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(behaviors) == IS_ARRAY) { 
+	
+		PHALCON_INIT_VAR(entity_name);
+		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+		if (phalcon_array_isset(behaviors, entity_name)) {
+	
+			/** 
+			 * Notify all the events on the behavior
+			 */
+			PHALCON_OBS_VAR(models_behaviors);
+			phalcon_array_fetch(&models_behaviors, behaviors, entity_name, PH_NOISY);
+	
+			phalcon_is_iterable(models_behaviors, &ah0, &hp0, 0, 0);
+	
+			while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+				PHALCON_GET_HVALUE(behavior);
+	
+				PHALCON_CALL_METHOD(&result, behavior, "missingmethod", model, event_name, data);
+				if (Z_TYPE_P(result) != IS_NULL) {
+					RETURN_CTOR(result);
+				}
+	
+				zend_hash_move_forward_ex(ah0, &hp0);
+			}
+	
+		}
+	}
+	
+	/** 
+	 * Dispatch events to the global events manager
+	 */
+	PHALCON_OBS_VAR(events_manager);
+	phalcon_read_property_this(&events_manager, this_ptr, SL("_eventsManager"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(events_manager) == IS_OBJECT) {
+		PHALCON_INIT_VAR(fire_event_name);
+		PHALCON_CONCAT_SV(fire_event_name, "model:", event_name);
+		PHALCON_RETURN_CALL_METHOD(events_manager, "fire", fire_event_name, model, data);
+		RETURN_MM();
+	}
+	
+	RETURN_MM_NULL();
+}
+
+/**
+ * Checks whether the events generated by a model are dispatched to behaviors or events managers.
+ * Bulk operations use this to know if they can skip the per-record events
+ *
+ * @param Phalcon\Mvc\ModelInterface $model
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, isObserved){
+
+	zval *model, *behaviors, *custom_events_manager, *events_manager;
+	zval *entity_name;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &model);
+	
+	events_manager = phalcon_fetch_nproperty_this(this_ptr, SL("_eventsManager"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(events_manager) == IS_OBJECT) {
+		RETURN_MM_TRUE;
+	}
+	
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+	
+	behaviors = phalcon_fetch_nproperty_this(this_ptr, SL("_behaviors"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(behaviors) == IS_ARRAY && phalcon_array_isset(behaviors, entity_name)) {
+		RETURN_MM_TRUE;
+	}
+	
+	custom_events_manager = phalcon_fetch_nproperty_this(this_ptr, SL("_customEventsManager"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(custom_events_manager) == IS_ARRAY && phalcon_array_isset(custom_events_manager, entity_name)) {
+		RETURN_MM_TRUE;
+	}
+	
+	RETURN_MM_FALSE;
+}
+
+/**
+ * Binds a behavior to a model
+ *
+ * @param Phalcon\Mvc\ModelInterface $model
+ * @param Phalcon\Mvc\Model\BehaviorInterface $behavior
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, addBehavior){
+
+	zval *model, *behavior, *entity_name, *behaviors;
+	zval *models_behaviors = NULL;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 2, 0, &model, &behavior);
+	
+	if (Z_TYPE_P(behavior) != IS_OBJECT) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The behavior is invalid");
+		return;
+	}
+	
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+	
+	/** 
+	 * Get the current behaviors
+	 */
+	PHALCON_OBS_VAR(behaviors);
+	phalcon_read_property_this(&behaviors, this_ptr, SL("_behaviors"), PH_NOISY TSRMLS_CC);
+	if (phalcon_array_isset(behaviors, entity_name)) {
+		PHALCON_OBS_VAR(models_behaviors);
+		phalcon_array_fetch(&models_behaviors, behaviors, entity_name, PH_NOISY);
+	} else {
+		PHALCON_INIT_NVAR(models_behaviors);
+		array_init(models_behaviors);
+	}
+	
+	/** 
+	 * Append the behavior to the list of behaviors
+	 */
+	phalcon_array_append(&models_behaviors, behavior, PH_SEPARATE);
+	
+	/** 
+	 * Update the behaviors list
+	 */
+	phalcon_update_property_array(this_ptr, SL("_behaviors"), entity_name, models_behaviors TSRMLS_CC);
+	phalcon_mvc_model_manager_observe(this_ptr, model TSRMLS_CC);
+	
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Sets if a model must keep snapshots
+ *
+ * @param Phalcon\Mvc\Model $model
+ * @param boolean $keepSnapshots
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, keepSnapshots){
+
+	zval *model, *keep_snapshots, *entity_name;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 2, 0, &model, &keep_snapshots);
+	
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+	phalcon_update_property_array(this_ptr, SL("_keepSnapshots"), entity_name, keep_snapshots TSRMLS_CC);
+	
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Checks if a model is keeping snapshots for the queried records
+ *
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, isKeepingSnapshots){
+
+	zval *model, *keep_snapshots, *entity_name, *is_keeping;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &model);
+	
+	PHALCON_OBS_VAR(keep_snapshots);
+	phalcon_read_property_this(&keep_snapshots, this_ptr, SL("_keepSnapshots"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(keep_snapshots) == IS_ARRAY) { 
+	
+		PHALCON_INIT_VAR(entity_name);
+		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+		if (phalcon_array_isset(keep_snapshots, entity_name)) {
+			PHALCON_OBS_VAR(is_keeping);
+			phalcon_array_fetch(&is_keeping, keep_snapshots, entity_name, PH_NOISY);
+			RETURN_CTOR(is_keeping);
+		}
+	}
+	
+	RETURN_MM_FALSE;
+}
+
+/**
+ * Sets if a model must use dynamic update instead of the all-field update
+ *
+ * @param Phalcon\Mvc\Model $model
+ * @param boolean $dynamicUpdate
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, useDynamicUpdate){
+
+	zval *model, *dynamic_update, *entity_name;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 2, 0, &model, &dynamic_update);
+	
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+	phalcon_update_property_array(this_ptr, SL("_dynamicUpdate"), entity_name, dynamic_update TSRMLS_CC);
+	phalcon_update_property_array(this_ptr, SL("_keepSnapshots"), entity_name, dynamic_update TSRMLS_CC);
+	
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Checks if a model is using dynamic update instead of all-field update
+ *
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, isUsingDynamicUpdate){
+
+	zval *model, *dynamic_update, *entity_name, *is_using;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &model);
+	
+	PHALCON_OBS_VAR(dynamic_update);
+	phalcon_read_property_this(&dynamic_update, this_ptr, SL("_dynamicUpdate"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(dynamic_update) == IS_ARRAY) { 
+	
+		PHALCON_INIT_VAR(entity_name);
+		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+		if (phalcon_array_isset(dynamic_update, entity_name)) {
+			PHALCON_OBS_VAR(is_using);
+			phalcon_array_fetch(&is_using, dynamic_update, entity_name, PH_NOISY);
+			RETURN_CTOR(is_using);
+		}
+	}
+	
+	RETURN_MM_FALSE;
+}
+
+/**
+ * Returns the lowercased class name of a model passed either as an instance or as a class name
+ */
+static void phalcon_mvc_model_manager_entity_name(zval *entity_name, zval *model TSRMLS_DC) {
+
+	if (Z_TYPE_P(model) == IS_OBJECT) {
+		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+	} else {
+		phalcon_fast_strtolower(entity_name, model);
+	}
+}
+
+/**
+ * Sets if a model must keep an identity map of the records queried by primary key,
+ * so repeated findFirst($id) calls and belongsTo/hasOne lookups don't hit the database
+ *
+ * @param Phalcon\Mvc\Model $model
+ * @param boolean $identityMap
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, useIdentityMap){
+
+	zval *model, *identity_map, *entity_name;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 2, 0, &model, &identity_map);
+	
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_mvc_model_manager_entity_name(entity_name, model TSRMLS_CC);
+	phalcon_update_property_array(this_ptr, SL("_useIdentityMap"), entity_name, identity_map TSRMLS_CC);
+	
+	if (zend_is_true(identity_map)) {
+		PHALCON_GLOBAL(orm).identity_map = 1;
+	} else {
+		phalcon_unset_property_array(this_ptr, SL("_identityMap"), entity_name TSRMLS_CC);
+	}
+	
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Checks if a model is keeping an identity map
+ *
+ * @param Phalcon\Mvc\Model|string $model
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, isUsingIdentityMap){
+
+	zval *model, *use_identity_map, *entity_name, *is_using;
+
+	phalcon_fetch_params(0, 1, 0, &model);
+	
+	use_identity_map = phalcon_fetch_nproperty_this(this_ptr, SL("_useIdentityMap"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(use_identity_map) == IS_ARRAY) {
+	
+		PHALCON_MM_GROW();
+	
+		PHALCON_INIT_VAR(entity_name);
+		phalcon_mvc_model_manager_entity_name(entity_name, model TSRMLS_CC);
+		if (phalcon_array_isset_fetch(&is_using, use_identity_map, entity_name)) {
+			RETURN_MM_BOOL(zend_is_true(is_using));
+		}
+	
+		PHALCON_MM_RESTORE();
+	}
+	
+	RETURN_FALSE;
+}
+
+/**
+ * Sets if the records of a model are hydrated as read-only instances. Read-only records
+ * skip snapshots and reject any write to their attributes or to the database
+ *
+ * @param Phalcon\Mvc\Model $model
+ * @param boolean $readOnly
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, useReadOnlyRecords){
+
+	zval *model, *read_only, *entity_name;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 2, 0, &model, &read_only);
+	
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_mvc_model_manager_entity_name(entity_name, model TSRMLS_CC);
+	phalcon_update_property_array(this_ptr, SL("_readOnlyRecords"), entity_name, read_only TSRMLS_CC);
+	
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Checks if the records of a model are hydrated as read-only instances
+ *
+ * @param Phalcon\Mvc\Model|string $model
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, isUsingReadOnlyRecords){
+
+	zval *model, *read_only_records, *entity_name, *is_using;
+
+	phalcon_fetch_params(0, 1, 0, &model);
+	
+	read_only_records = phalcon_fetch_nproperty_this(this_ptr, SL("_readOnlyRecords"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(read_only_records) == IS_ARRAY) {
+	
+		PHALCON_MM_GROW();
+	
+		PHALCON_INIT_VAR(entity_name);
+		phalcon_mvc_model_manager_entity_name(entity_name, model TSRMLS_CC);
+		if (phalcon_array_isset_fetch(&is_using, read_only_records, entity_name)) {
+			RETURN_MM_BOOL(zend_is_true(is_using));
+		}
+	
+		PHALCON_MM_RESTORE();
+	}
+	
+	RETURN_FALSE;
+}
+
+/**
+ * Returns the name under which the version of a table is kept: "schema.source" or "source".
+ * Tables are passed as models, as sources of a PHQL intermediate representation
+ * (array(source, schema[, alias])) or as names
+ */
+static int phalcon_mvc_model_manager_version_name(zval *name, zval *table TSRMLS_DC) {
+
+	zval *source = NULL, *schema = NULL;
+
+	if (Z_TYPE_P(table) == IS_OBJECT) {
+		if (phalcon_call_method(&source, table, "getsource", 0, NULL TSRMLS_CC) == FAILURE) {
+			return FAILURE;
+		}
+
+		if (phalcon_call_method(&schema, table, "getschema", 0, NULL TSRMLS_CC) == FAILURE) {
+			zval_ptr_dtor(&source);
+			return FAILURE;
+		}
+
+		if (zend_is_true(schema)) {
+			PHALCON_CONCAT_VSV(name, schema, ".", source);
+		} else {
+			ZVAL_ZVAL(name, source, 1, 0);
+			convert_to_string(name);
+		}
+
+		zval_ptr_dtor(&source);
+		zval_ptr_dtor(&schema);
+		return SUCCESS;
+	}
+
+	if (Z_TYPE_P(table) == IS_ARRAY) {
+		if (!phalcon_array_isset_long_fetch(&source, table, 0)) {
+			PHALCON_THROW_EXCEPTION_STRW(phalcon_mvc_model_exception_ce, "Invalid table definition");
+			return FAILURE;
+		}
+
+		if (phalcon_array_isset_long_fetch(&schema, table, 1) && zend_is_true(schema)) {
+			PHALCON_CONCAT_VSV(name, schema, ".", source);
+		} else {
+			ZVAL_ZVAL(name, source, 1, 0);
+			convert_to_string(name);
+		}
+
+		return SUCCESS;
+	}
+
+	ZVAL_ZVAL(name, table, 1, 0);
+	convert_to_string(name);
+	return SUCCESS;
+}
+
+/**
+ * Versions are random so a version lost by the cache backend is never produced again
+ */
+static void phalcon_mvc_model_manager_new_version(zval *version TSRMLS_DC) {
+
+	char *buffer;
+	int length;
+
+	length = spprintf(&buffer, 0, "%lx%lx", (unsigned long) time(NULL), (unsigned long) (php_combined_lcg(TSRMLS_C) * 0xFFFFFFFF));
+	ZVAL_STRINGL(version, buffer, length, 0);
+}
+
+/**
+ * Sets the cache backend where the models manager keeps a version of every table. The version
+ * of a table changes on every write made through the ORM (Phalcon\Mvc\Model::save/delete,
+ * PHQL UPDATE/DELETE), cached PHQL queries embed the versions of the tables they read in
+ * their keys, so they invalidate themselves
+ *
+ *<code>
+ * $di->set('modelsManager', function() {
+ *     $modelsManager = new \Phalcon\Mvc\Model\Manager();
+ *     $modelsManager->setVersionsCache('modelsCache');
+ *     return $modelsManager;
+ * });
+ *</code>
+ *
+ * @param string|Phalcon\Cache\BackendInterface $cache a service name or a backend, null disables the versions
+ * @param int $lifetime
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, setVersionsCache){
+
+	zval *cache, *lifetime = NULL;
+
+	phalcon_fetch_params(0, 1, 1, &cache, &lifetime);
+	
+	if (Z_TYPE_P(cache) != IS_NULL && Z_TYPE_P(cache) != IS_STRING) {
+		PHALCON_VERIFY_INTERFACE_EX(cache, phalcon_cache_backendinterface_ce, phalcon_mvc_model_exception_ce, 0);
+	}
+	
+	phalcon_update_property_this(this_ptr, SL("_versionsCache"), cache TSRMLS_CC);
+	phalcon_update_property_null(this_ptr, SL("_tableVersions") TSRMLS_CC);
+	
+	if (lifetime && Z_TYPE_P(lifetime) != IS_NULL) {
+		phalcon_update_property_this(this_ptr, SL("_versionsLifetime"), lifetime TSRMLS_CC);
+	}
+}
+
+/**
+ * Returns the cache backend where the versions of the tables are kept
+ *
+ * @return Phalcon\Cache\BackendInterface
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getVersionsCache){
+
+	zval *cache, *dependency_injector, *service = NULL;
+
+	cache = phalcon_fetch_nproperty_this(this_ptr, SL("_versionsCache"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(cache) != IS_STRING) {
+		RETURN_ZVAL(cache, 1, 0);
+	}
+	
+	PHALCON_MM_GROW();
+	
+	dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(dependency_injector) != IS_OBJECT) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "A dependency injector container is required to obtain the versions cache");
+		return;
+	}
+	
+	PHALCON_CALL_METHOD(&service, dependency_injector, "getshared", cache);
+	PHALCON_VERIFY_INTERFACE_EX(service, phalcon_cache_backendinterface_ce, phalcon_mvc_model_exception_ce, 1);
+	
+	/** 
+	 * The service is resolved only once
+	 */
+	phalcon_update_property_this(this_ptr, SL("_versionsCache"), service TSRMLS_CC);
+	
+	RETURN_CTOR(service);
+}
+
+/**
+ * Returns the current version of a table, null if the versions are disabled. Versions are
+ * read from the cache backend once per request
+ *
+ * @param Phalcon\Mvc\ModelInterface|string $table
+ * @return string
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getTableVersion){
+
+	zval *table, *versions, *cached, *name, *cache = NULL, *key, *lifetime;
+	zval *version = NULL;
+
+	phalcon_fetch_params(0, 1, 0, &table);
+	
+	if (Z_TYPE_P(phalcon_fetch_nproperty_this(this_ptr, SL("_versionsCache"), PH_NOISY TSRMLS_CC)) == IS_NULL) {
+		RETURN_NULL();
+	}
+	
+	PHALCON_MM_GROW();
+	
+	PHALCON_INIT_VAR(name);
+	if (phalcon_mvc_model_manager_version_name(name, table TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+	
+	versions = phalcon_fetch_nproperty_this(this_ptr, SL("_tableVersions"), PH_NOISY TSRMLS_CC);
+	if (phalcon_array_isset_fetch(&cached, versions, name)) {
+		RETURN_CTOR(cached);
+	}
+	
+	PHALCON_CALL_METHOD(&cache, this_ptr, "getversionscache");
+	
+	PHALCON_INIT_VAR(key);
+	PHALCON_CONCAT_SV(key, "_version_", name);
+	
+	lifetime = phalcon_fetch_nproperty_this(this_ptr, SL("_versionsLifetime"), PH_NOISY TSRMLS_CC);
+	
+	PHALCON_CALL_METHOD(&version, cache, "get", key, lifetime);
+	if (Z_TYPE_P(version) != IS_STRING) {
+		PHALCON_INIT_NVAR(version);
+		phalcon_mvc_model_manager_new_version(version TSRMLS_CC);
+		PHALCON_CALL_METHOD(NULL, cache, "save", key, version, lifetime);
+	}
+	
+	phalcon_update_property_array(this_ptr, SL("_tableVersions"), name, version TSRMLS_CC);
+	
+	RETURN_CTOR(version);
+}
+
+/**
+ * Changes the version of a table, so the cached queries reading it are not used anymore
+ *
+ * @param Phalcon\Mvc\ModelInterface|string $table
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Manager, bumpTableVersion){
+
+	zval *table, *name, *deferred, *cache = NULL, *key, *version, *lifetime;
+
+	phalcon_fetch_params(0, 1, 0, &table);
+	
+	if (Z_TYPE_P(phalcon_fetch_nproperty_this(this_ptr, SL("_versionsCache"), PH_NOISY TSRMLS_CC)) == IS_NULL) {
+		return;
+	}
+	
+	PHALCON_MM_GROW();
+	
+	PHALCON_INIT_VAR(name);
+	if (phalcon_mvc_model_manager_version_name(name, table TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+	
+	/** 
+	 * Statements writing many records bump every table once when they finish
+	 */
+	deferred = phalcon_fetch_nproperty_this(this_ptr, SL("_deferredVersions"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(deferred) == IS_ARRAY) {
+		phalcon_update_property_array(this_ptr, SL("_deferredVersions"), name, PHALCON_GLOBAL(z_true) TSRMLS_CC);
+		RETURN_MM();
+	}
+	
+	PHALCON_CALL_METHOD(&cache, this_ptr, "getversionscache");
+	
+	PHALCON_INIT_VAR(key);
+	PHALCON_CONCAT_SV(key, "_version_", name);
+	
+	PHALCON_INIT_VAR(version);
+	phalcon_mvc_model_manager_new_version(version TSRMLS_CC);
+	
+	lifetime = phalcon_fetch_nproperty_this(this_ptr, SL("_versionsLifetime"), PH_NOISY TSRMLS_CC);
+	PHALCON_CALL_METHOD(NULL, cache, "save", key, version, lifetime);
+	
+	phalcon_update_property_array(this_ptr, SL("_tableVersions"), name, version TSRMLS_CC);
+	
+	PHALCON_MM_RESTORE();
+}
+
+int phalcon_mvc_model_manager_has_versions(zval *manager TSRMLS_DC) {
+
+	if (Z_TYPE_P(manager) != IS_OBJECT || !instanceof_function(Z_OBJCE_P(manager), phalcon_mvc_model_manager_ce TSRMLS_CC)) {
+		return 0;
+	}
+
+	return Z_TYPE_P(phalcon_fetch_nproperty_this(manager, SL("_versionsCache"), PH_NOISY TSRMLS_CC)) != IS_NULL;
+}
+
+/**
+ * Returns which handlers (PHALCON_MODEL_EVENT_*) must run for a lifecycle event of a model,
+ * unknown events, models not initialized by this manager and managers overriding how events
+ * are observed always run every handler
+ */
+int phalcon_mvc_model_manager_event_handlers(zval *manager, zval *model, const char *event_name, uint event_length TSRMLS_DC) {
+
+	zval *masks, **mask;
+	int bit, handlers = 0;
+
+	if (Z_TYPE_P(manager) != IS_OBJECT || Z_TYPE_P(model) != IS_OBJECT || !instanceof_function(Z_OBJCE_P(manager), phalcon_mvc_model_manager_ce TSRMLS_CC)) {
+		return PHALCON_MODEL_EVENT_METHOD | PHALCON_MODEL_EVENT_NOTIFY;
+	}
+
+	bit = phalcon_mvc_model_manager_event_bit(event_name, event_length);
+	if (bit < 0) {
+		return PHALCON_MODEL_EVENT_METHOD | PHALCON_MODEL_EVENT_NOTIFY;
+	}
+
+	masks = phalcon_fetch_nproperty_this(manager, SL("_eventsMasks"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(masks) != IS_ARRAY || zend_hash_index_find(Z_ARRVAL_P(masks), (ulong) (zend_uintptr_t) Z_OBJCE_P(model), (void**) &mask) != SUCCESS) {
+		return PHALCON_MODEL_EVENT_METHOD | PHALCON_MODEL_EVENT_NOTIFY;
+	}
+
+	if (Z_LVAL_PP(mask) & (1L << bit)) {
+		handlers |= PHALCON_MODEL_EVENT_METHOD;
+	}
+
+	/** 
+	 * Listeners can be attached to the global events manager at any time
+	 */
+	if ((Z_LVAL_PP(mask) & PHALCON_MODEL_EVENTS_OBSERVED) || Z_TYPE_P(phalcon_fetch_nproperty_this(manager, SL("_eventsManager"), PH_NOISY TSRMLS_CC)) == IS_OBJECT) {
+		handlers |= PHALCON_MODEL_EVENT_NOTIFY;
+	}
+
+	return handlers;
+}
+
+/**
+ * Starts deferring the version bumps, returns 1 only if they were not deferred yet, so the
+ * caller that started deferring them is the one flushing them
+ */
+int phalcon_mvc_model_manager_defer_versions(zval *manager TSRMLS_DC) {
+
+	zval *deferred;
+
+	if (!phalcon_mvc_model_manager_has_versions(manager TSRMLS_CC)) {
+		return 0;
+	}
+
+	if (Z_TYPE_P(phalcon_fetch_nproperty_this(manager, SL("_deferredVersions"), PH_NOISY TSRMLS_CC)) == IS_ARRAY) {
+		return 0;
+	}
+
+	MAKE_STD_ZVAL(deferred);
+	array_init(deferred);
+	phalcon_update_property_this(manager, SL("_deferredVersions"), deferred TSRMLS_CC);
+	zval_ptr_dtor(&deferred);
+	return 1;
+}
+
+/**
+ * Bumps the versions deferred while a statement was running
+ */
+int phalcon_mvc_model_manager_flush_versions(zval *manager TSRMLS_DC) {
+
+	zval *deferred, *name, *params[1], key;
+	HashPosition hp;
+	int status = SUCCESS;
+
+	if (!phalcon_mvc_model_manager_has_versions(manager TSRMLS_CC)) {
+		return SUCCESS;
+	}
+
+	deferred = phalcon_fetch_nproperty_this(manager, SL("_deferredVersions"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(deferred) != IS_ARRAY) {
+		return SUCCESS;
+	}
+
+	Z_ADDREF_P(deferred);
+	phalcon_update_property_null(manager, SL("_deferredVersions") TSRMLS_CC);
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(deferred), &hp);
+		status == SUCCESS && zend_hash_get_current_key_type_ex(Z_ARRVAL_P(deferred), &hp) != HASH_KEY_NON_EXISTENT;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(deferred), &hp)
+	) {
+		key = phalcon_get_current_key_w(Z_ARRVAL_P(deferred), &hp);
+
+		MAKE_STD_ZVAL(name);
+		ZVAL_ZVAL(name, &key, 1, 0);
+
+		params[0] = name;
+		status = phalcon_call_method(NULL, manager, "bumptableversion", 1, params TSRMLS_CC);
+		zval_ptr_dtor(&name);
+	}
+
+	zval_ptr_dtor(&deferred);
+	return status;
+}
+
+/**
+ * Drops the versions deferred while a statement was running, used when nothing was written
+ */
+void phalcon_mvc_model_manager_discard_versions(zval *manager TSRMLS_DC) {
+
+	if (phalcon_mvc_model_manager_has_versions(manager TSRMLS_CC)) {
+		phalcon_update_property_null(manager, SL("_deferredVersions") TSRMLS_CC);
+	}
+}
+
+/**
+ * Ends the versions deferred by the transaction of a connection: they are bumped if flush is
+ * set or dropped otherwise. The versions deferred by other connections are kept
+ */
+int phalcon_mvc_model_manager_end_versions(zval *manager, zval *connection, int flush TSRMLS_DC) {
+
+	zval *versions, *tables, *name, *params[1], index, key;
+	HashPosition hp;
+	int status = SUCCESS;
+
+	if (!phalcon_mvc_model_manager_has_versions(manager TSRMLS_CC)) {
+		return SUCCESS;
 	}
-	
-	RETURN_CTOR(status);
+
+	INIT_ZVAL(index);
+	ZVAL_LONG(&index, Z_OBJ_HANDLE_P(connection));
+
+	versions = phalcon_fetch_nproperty_this(manager, SL("_transactionVersions"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(versions) != IS_ARRAY || !phalcon_array_isset_fetch(&tables, versions, &index)) {
+		return SUCCESS;
+	}
+
+	Z_ADDREF_P(tables);
+	phalcon_unset_property_array(manager, SL("_transactionVersions"), &index TSRMLS_CC);
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(tables), &hp);
+		flush && status == SUCCESS && zend_hash_get_current_key_type_ex(Z_ARRVAL_P(tables), &hp) != HASH_KEY_NON_EXISTENT;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(tables), &hp)
+	) {
+		key = phalcon_get_current_key_w(Z_ARRVAL_P(tables), &hp);
+
+		MAKE_STD_ZVAL(name);
+		ZVAL_ZVAL(name, &key, 1, 0);
+
+		params[0] = name;
+		status = phalcon_call_method(NULL, manager, "bumptableversion", 1, params TSRMLS_CC);
+		zval_ptr_dtor(&name);
+	}
+
+	zval_ptr_dtor(&tables);
+	return status;
 }
 
 /**
- * Dispatch a event to the listeners and behaviors
- * This method expects that the endpoint listeners/behaviors returns true
- * meaning that a least one is implemented
- *
- * @param Phalcon\Mvc\ModelInterface $model
- * @param string $eventName
- * @param array $data
- * @return boolean
+ * Bumps the version of a table written through a connection. Inside a transaction the bump
+ * is kept apart for that connection until it commits, otherwise a query running before the
+ * commit could cache the old rows under the new version
  */
-PHP_METHOD(Phalcon_Mvc_Model_Manager, missingMethod){
+int phalcon_mvc_model_manager_bump_version(zval *manager, zval *table, zval *connection TSRMLS_DC) {
 
-	zval *model, *event_name, *data, *behaviors, *entity_name;
-	zval *models_behaviors, *behavior = NULL, *result = NULL, *events_manager;
-	zval *fire_event_name;
-	HashTable *ah0;
-	HashPosition hp0;
-	zval **hd;
+	zval *versions, *existing, *tables, *name, *params[1], index;
 
-	PHALCON_MM_GROW();
+	if (!phalcon_mvc_model_manager_has_versions(manager TSRMLS_CC)) {
+		return SUCCESS;
+	}
 
-	phalcon_fetch_params(1, 3, 0, &model, &event_name, &data);
-	
-	/** 
-	 * Dispatch events to the global events manager
-	 */
-	PHALCON_OBS_VAR(behaviors);
-	phalcon_read_property_this(&behaviors, this_ptr, SL("_behaviors"), PH_NOISY TSRMLS_CC);
-	if (Z_TYPE_P(behaviors) == IS_ARRAY) { 
-	
-		PHALCON_INIT_VAR(entity_name);
-		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
-		if (phalcon_array_isset(behaviors, entity_name)) {
-	
-			/** 
-			 * Notify all the events on the behavior
-			 */
-			PHALCON_OBS_VAR(models_behaviors);
-			phalcon_array_fetch(&models_behaviors, behaviors, entity_name, PH_NOISY);
-	
-			phalcon_is_iterable(models_behaviors, &ah0, &hp0, 0, 0);
-	
-			while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
-	
-				PHALCON_GET_HVALUE(behavior);
-	
-				PHALCON_CALL_METHOD(&result, behavior, "missingmethod", model, event_name, data);
-				if (Z_TYPE_P(result) != IS_NULL) {
-					RETURN_CTOR(result);
-				}
-	
-				zend_hash_move_forward_ex(ah0, &hp0);
+	if (Z_TYPE_P(connection) == IS_OBJECT && instanceof_function(Z_OBJCE_P(connection), phalcon_db_adapter_pdo_ce TSRMLS_CC)) {
+		if (phalcon_get_intval(phalcon_fetch_nproperty_this(connection, SL("_transactionLevel"), PH_NOISY TSRMLS_CC)) > 0) {
+
+			MAKE_STD_ZVAL(name);
+			ZVAL_NULL(name);
+			if (phalcon_mvc_model_manager_version_name(name, table TSRMLS_CC) == FAILURE) {
+				zval_ptr_dtor(&name);
+				return FAILURE;
 			}
-	
+
+			INIT_ZVAL(index);
+			ZVAL_LONG(&index, Z_OBJ_HANDLE_P(connection));
+
+			MAKE_STD_ZVAL(tables);
+			versions = phalcon_fetch_nproperty_this(manager, SL("_transactionVersions"), PH_NOISY TSRMLS_CC);
+			if (Z_TYPE_P(versions) == IS_ARRAY && phalcon_array_isset_fetch(&existing, versions, &index)) {
+				ZVAL_ZVAL(tables, existing, 1, 0);
+			} else {
+				array_init(tables);
+			}
+
+			phalcon_array_update_zval_bool(&tables, name, 1, 0);
+			phalcon_update_property_array(manager, SL("_transactionVersions"), &index, tables TSRMLS_CC);
+			phalcon_db_adapter_pdo_defer_versions(connection, manager TSRMLS_CC);
+
+			zval_ptr_dtor(&tables);
+			zval_ptr_dtor(&name);
+			return SUCCESS;
 		}
 	}
-	
-	/** 
-	 * Dispatch events to the global events manager
-	 */
-	PHALCON_OBS_VAR(events_manager);
-	phalcon_read_property_this(&events_manager, this_ptr, SL("_eventsManager"), PH_NOISY TSRMLS_CC);
-	if (Z_TYPE_P(events_manager) == IS_OBJECT) {
-		PHALCON_INIT_VAR(fire_event_name);
-		PHALCON_CONCAT_SV(fire_event_name, "model:", event_name);
-		PHALCON_RETURN_CALL_METHOD(events_manager, "fire", fire_event_name, model, data);
-		RETURN_MM();
-	}
-	
-	RETURN_MM_NULL();
+
+	params[0] = table;
+	return phalcon_call_method(NULL, manager, "bumptableversion", 1, params TSRMLS_CC);
 }
 
 /**
- * Binds a behavior to a model
+ * Returns the attribute used as key in the identity map of a model, or false if the
+ * model doesn't have a single-column primary key
  *
- * @param Phalcon\Mvc\ModelInterface $model
- * @param Phalcon\Mvc\Model\BehaviorInterface $behavior
+ * @param Phalcon\Mvc\Model|string $model
+ * @return string|boolean
  */
-PHP_METHOD(Phalcon_Mvc_Model_Manager, addBehavior){
+PHP_METHOD(Phalcon_Mvc_Model_Manager, _getIdentityAttribute){
 
-	zval *model, *behavior, *entity_name, *behaviors;
-	zval *models_behaviors = NULL;
+	zval *model, *entity_name, *identity_attributes, *attribute;
+	zval *instance = NULL, *meta_data = NULL, *primary_keys = NULL;
+	zval *column_map = NULL, *identity, **primary_key;
 
 	PHALCON_MM_GROW();
 
-	phalcon_fetch_params(1, 2, 0, &model, &behavior);
-	
-	if (Z_TYPE_P(behavior) != IS_OBJECT) {
-		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The behavior is invalid");
-		return;
-	}
+	phalcon_fetch_params(1, 1, 0, &model);
 	
 	PHALCON_INIT_VAR(entity_name);
-	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
+	phalcon_mvc_model_manager_entity_name(entity_name, model TSRMLS_CC);
 	
-	/** 
-	 * Get the current behaviors
-	 */
-	PHALCON_OBS_VAR(behaviors);
-	phalcon_read_property_this(&behaviors, this_ptr, SL("_behaviors"), PH_NOISY TSRMLS_CC);
-	if (phalcon_array_isset(behaviors, entity_name)) {
-		PHALCON_OBS_VAR(models_behaviors);
-		phalcon_array_fetch(&models_behaviors, behaviors, entity_name, PH_NOISY);
+	identity_attributes = phalcon_fetch_nproperty_this(this_ptr, SL("_identityAttributes"), PH_NOISY TSRMLS_CC);
+	if (phalcon_array_isset_fetch(&attribute, identity_attributes, entity_name)) {
+		RETURN_CTOR(attribute);
+	}
+	
+	if (Z_TYPE_P(model) == IS_OBJECT) {
+		PHALCON_CPY_WRT(instance, model);
 	} else {
-		PHALCON_INIT_NVAR(models_behaviors);
-		array_init(models_behaviors);
+		PHALCON_CALL_METHOD(&instance, this_ptr, "load", model);
 	}
 	
-	/** 
-	 * Append the behavior to the list of behaviors
-	 */
-	phalcon_array_append(&models_behaviors, behavior, PH_SEPARATE);
+	PHALCON_CALL_METHOD(&meta_data, instance, "getmodelsmetadata");
+	PHALCON_CALL_METHOD(&primary_keys, meta_data, "getprimarykeyattributes", instance);
+	
+	PHALCON_INIT_VAR(identity);
+	ZVAL_FALSE(identity);
 	
 	/** 
-	 * Update the behaviors list
+	 * Only models with a single-column primary key can be mapped
 	 */
-	phalcon_update_property_array(this_ptr, SL("_behaviors"), entity_name, models_behaviors TSRMLS_CC);
+	if (Z_TYPE_P(primary_keys) == IS_ARRAY && zend_hash_num_elements(Z_ARRVAL_P(primary_keys)) == 1) {
+		zend_hash_internal_pointer_reset(Z_ARRVAL_P(primary_keys));
+		zend_hash_get_current_data(Z_ARRVAL_P(primary_keys), (void**) &primary_key);
+	
+		if (PHALCON_GLOBAL(orm).column_renaming) {
+			PHALCON_CALL_METHOD(&column_map, meta_data, "getcolumnmap", instance);
+			if (phalcon_array_isset_fetch(&attribute, column_map, *primary_key)) {
+				ZVAL_ZVAL(identity, attribute, 1, 0);
+			} else {
+				ZVAL_ZVAL(identity, *primary_key, 1, 0);
+			}
+		} else {
+			ZVAL_ZVAL(identity, *primary_key, 1, 0);
+		}
+	}
 	
-	PHALCON_MM_RESTORE();
+	phalcon_update_property_array(this_ptr, SL("_identityAttributes"), entity_name, identity TSRMLS_CC);
+	
+	RETURN_CTOR(identity);
 }
 
 /**
- * Sets if a model must keep snapshots
+ * Returns a record from the identity map by its primary key value, or null if it isn't mapped
  *
- * @param Phalcon\Mvc\Model $model
- * @param boolean $keepSnapshots
+ * @param string $modelName
+ * @param mixed $key
+ * @return Phalcon\Mvc\ModelInterface
  */
-PHP_METHOD(Phalcon_Mvc_Model_Manager, keepSnapshots){
+PHP_METHOD(Phalcon_Mvc_Model_Manager, getIdentityRecord){
 
-	zval *model, *keep_snapshots, *entity_name;
-
-	PHALCON_MM_GROW();
+	zval *model_name, *key, *identity_map, *entity_name, *records, *record;
 
-	phalcon_fetch_params(1, 2, 0, &model, &keep_snapshots);
+	phalcon_fetch_params(0, 2, 0, &model_name, &key);
 	
-	PHALCON_INIT_VAR(entity_name);
-	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
-	phalcon_update_property_array(this_ptr, SL("_keepSnapshots"), entity_name, keep_snapshots TSRMLS_CC);
+	identity_map = phalcon_fetch_nproperty_this(this_ptr, SL("_identityMap"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(identity_map) == IS_ARRAY && Z_TYPE_P(key) != IS_NULL) {
 	
-	PHALCON_MM_RESTORE();
+		PHALCON_MM_GROW();
+	
+		PHALCON_INIT_VAR(entity_name);
+		phalcon_mvc_model_manager_entity_name(entity_name, model_name TSRMLS_CC);
+		if (phalcon_array_isset_fetch(&records, identity_map, entity_name)) {
+			if (phalcon_array_isset_fetch(&record, records, key)) {
+				RETURN_CTOR(record);
+			}
+		}
+	
+		PHALCON_MM_RESTORE();
+	}
+	
+	RETURN_NULL();
 }
 
 /**
- * Checks if a model is keeping snapshots for the queried records
+ * Stores a record in the identity map of its model using its primary key value
  *
+ * @param Phalcon\Mvc\ModelInterface $record
  * @return boolean
  */
-PHP_METHOD(Phalcon_Mvc_Model_Manager, isKeepingSnapshots){
+PHP_METHOD(Phalcon_Mvc_Model_Manager, setIdentityRecord){
 
-	zval *model, *keep_snapshots, *entity_name, *is_keeping;
+	zval *record, *entity_name, *attribute = NULL, *key = NULL, *identity_map;
 
 	PHALCON_MM_GROW();
 
-	phalcon_fetch_params(1, 1, 0, &model);
+	phalcon_fetch_params(1, 1, 0, &record);
 	
-	PHALCON_OBS_VAR(keep_snapshots);
-	phalcon_read_property_this(&keep_snapshots, this_ptr, SL("_keepSnapshots"), PH_NOISY TSRMLS_CC);
-	if (Z_TYPE_P(keep_snapshots) == IS_ARRAY) { 
+	if (Z_TYPE_P(record) != IS_OBJECT) {
+		RETURN_MM_FALSE;
+	}
 	
-		PHALCON_INIT_VAR(entity_name);
-		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
-		if (phalcon_array_isset(keep_snapshots, entity_name)) {
-			PHALCON_OBS_VAR(is_keeping);
-			phalcon_array_fetch(&is_keeping, keep_snapshots, entity_name, PH_NOISY);
-			RETURN_CTOR(is_keeping);
-		}
+	PHALCON_CALL_METHOD(&attribute, this_ptr, "_getidentityattribute", record);
+	if (Z_TYPE_P(attribute) != IS_STRING) {
+		RETURN_MM_FALSE;
 	}
 	
-	RETURN_MM_FALSE;
+	PHALCON_CALL_METHOD(&key, record, "readattribute", attribute);
+	if (Z_TYPE_P(key) == IS_NULL) {
+		RETURN_MM_FALSE;
+	}
+	
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_get_class(entity_name, record, 1 TSRMLS_CC);
+	
+	PHALCON_OBS_VAR(identity_map);
+	phalcon_read_property_this(&identity_map, this_ptr, SL("_identityMap"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(identity_map) != IS_ARRAY) {
+		PHALCON_INIT_NVAR(identity_map);
+		array_init(identity_map);
+	}
+	
+	phalcon_array_update_multi_2(&identity_map, entity_name, key, record, 0);
+	phalcon_update_property_this(this_ptr, SL("_identityMap"), identity_map TSRMLS_CC);
+	
+	RETURN_MM_TRUE;
 }
 
 /**
- * Sets if a model must use dynamic update instead of the all-field update
+ * Removes a record from the identity map of its model
  *
- * @param Phalcon\Mvc\Model $model
- * @param boolean $dynamicUpdate
+ * @param Phalcon\Mvc\ModelInterface $record
  */
-PHP_METHOD(Phalcon_Mvc_Model_Manager, useDynamicUpdate){
+PHP_METHOD(Phalcon_Mvc_Model_Manager, removeIdentityRecord){
 
-	zval *model, *dynamic_update, *entity_name;
+	zval *record, *identity_map, *entity_name, *records;
+	zval *attribute = NULL, *key = NULL;
 
+	phalcon_fetch_params(0, 1, 0, &record);
+	
+	identity_map = phalcon_fetch_nproperty_this(this_ptr, SL("_identityMap"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(identity_map) != IS_ARRAY || Z_TYPE_P(record) != IS_OBJECT) {
+		return;
+	}
+	
 	PHALCON_MM_GROW();
-
-	phalcon_fetch_params(1, 2, 0, &model, &dynamic_update);
 	
 	PHALCON_INIT_VAR(entity_name);
-	phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
-	phalcon_update_property_array(this_ptr, SL("_dynamicUpdate"), entity_name, dynamic_update TSRMLS_CC);
-	phalcon_update_property_array(this_ptr, SL("_keepSnapshots"), entity_name, dynamic_update TSRMLS_CC);
+	phalcon_get_class(entity_name, record, 1 TSRMLS_CC);
+	
+	/** 
+	 * Nothing was mapped for this model, avoid reading the primary key
+	 */
+	if (!phalcon_array_isset(identity_map, entity_name)) {
+		RETURN_MM();
+	}
+	
+	PHALCON_CALL_METHOD(&attribute, this_ptr, "_getidentityattribute", record);
+	if (Z_TYPE_P(attribute) == IS_STRING) {
+		PHALCON_CALL_METHOD(&key, record, "readattribute", attribute);
+	
+		/** 
+		 * Re-read the map, calling the model could have changed it
+		 */
+		identity_map = phalcon_fetch_nproperty_this(this_ptr, SL("_identityMap"), PH_NOISY TSRMLS_CC);
+		if (Z_TYPE_P(key) != IS_NULL && phalcon_array_isset_fetch(&records, identity_map, entity_name)) {
+			phalcon_array_unset(&records, key, 0);
+		}
+	}
 	
 	PHALCON_MM_RESTORE();
 }
 
 /**
- * Checks if a model is using dynamic update instead of all-field update
+ * Clears the identity map of a model, or of every model if no model name is passed
  *
- * @return boolean
+ * @param string $modelName
  */
-PHP_METHOD(Phalcon_Mvc_Model_Manager, isUsingDynamicUpdate){
-
-	zval *model, *dynamic_update, *entity_name, *is_using;
+PHP_METHOD(Phalcon_Mvc_Model_Manager, clearIdentityMap){
 
-	PHALCON_MM_GROW();
+	zval *model_name = NULL, *entity_name;
 
-	phalcon_fetch_params(1, 1, 0, &model);
-	
-	PHALCON_OBS_VAR(dynamic_update);
-	phalcon_read_property_this(&dynamic_update, this_ptr, SL("_dynamicUpdate"), PH_NOISY TSRMLS_CC);
-	if (Z_TYPE_P(dynamic_update) == IS_ARRAY) { 
+	phalcon_fetch_params(0, 0, 1, &model_name);
 	
-		PHALCON_INIT_VAR(entity_name);
-		phalcon_get_class(entity_name, model, 1 TSRMLS_CC);
-		if (phalcon_array_isset(dynamic_update, entity_name)) {
-			PHALCON_OBS_VAR(is_using);
-			phalcon_array_fetch(&is_using, dynamic_update, entity_name, PH_NOISY);
-			RETURN_CTOR(is_using);
-		}
+	if (!model_name || Z_TYPE_P(model_name) == IS_NULL) {
+		phalcon_update_property_null(this_ptr, SL("_identityMap") TSRMLS_CC);
+		return;
 	}
 	
-	RETURN_MM_FALSE;
+	PHALCON_MM_GROW();
+	
+	PHALCON_INIT_VAR(entity_name);
+	phalcon_mvc_model_manager_entity_name(entity_name, model_name TSRMLS_CC);
+	phalcon_unset_property_array(this_ptr, SL("_identityMap"), entity_name TSRMLS_CC);
+	
+	PHALCON_MM_RESTORE();
 }
 
 /**
@@ -2124,10 +3805,11 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, getRelationRecords){
 	zval *find_params, *find_arguments = NULL, *arguments;
 	zval *type = NULL, *retrieve_method = NULL, *reusable = NULL, *unique_key;
 	zval *records = NULL, *referenced_entity = NULL, *call_object;
+	zval *use_identity_map = NULL, *identity_attribute = NULL;
 	HashTable *ah0;
 	HashPosition hp0;
 	zval **hd;
-	int f_reusable;
+	int f_reusable, f_identity = 0;
 
 	PHALCON_MM_GROW();
 
@@ -2373,6 +4055,26 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, getRelationRecords){
 		PHALCON_CPY_WRT(retrieve_method, method);
 	}
 	
+	/** 
+	 * Single records referenced by primary key can be served by the identity map
+	 */
+	if (Z_TYPE_P(fields) != IS_ARRAY && Z_TYPE_P(pre_conditions) == IS_NULL && Z_TYPE_P(parameters) != IS_ARRAY) {
+		if (Z_TYPE_P(value) != IS_NULL && PHALCON_IS_STRING(retrieve_method, "findFirst")) {
+			PHALCON_CALL_METHOD(&use_identity_map, this_ptr, "isusingidentitymap", referenced_model);
+			if (zend_is_true(use_identity_map)) {
+				PHALCON_CALL_METHOD(&identity_attribute, this_ptr, "_getidentityattribute", referenced_model);
+				if (PHALCON_IS_EQUAL(identity_attribute, referenced_field)) {
+					f_identity = 1;
+	
+					PHALCON_CALL_METHOD(&records, this_ptr, "getidentityrecord", referenced_model, value);
+					if (Z_TYPE_P(records) == IS_OBJECT) {
+						RETURN_CTOR(records);
+					}
+				}
+			}
+		}
+	}
+	
 	/** 
 	 * Find first results could be reusable
 	 */
@@ -2416,6 +4118,10 @@ PHP_METHOD(Phalcon_Mvc_Model_Manager, getRelationRecords){
 		PHALCON_CALL_METHOD(NULL, this_ptr, "setreusablerecords", referenced_model, unique_key, records);
 	}
 	
+	if (f_identity && Z_TYPE_P(records) == IS_OBJECT) {
+		PHALCON_CALL_METHOD(NULL, this_ptr, "setidentityrecord", records);
+	}
+	
 	RETURN_CTOR(records);
 }
 
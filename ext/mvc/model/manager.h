@@ -24,6 +24,17 @@
 
 extern zend_class_entry *phalcon_mvc_model_manager_ce;
 
+#define PHALCON_MODEL_EVENT_METHOD  1  /**< The model implements a method with the name of the event */
+#define PHALCON_MODEL_EVENT_NOTIFY  2  /**< Behaviors or events managers must be notified */
+
+int phalcon_mvc_model_manager_has_versions(zval *manager TSRMLS_DC);
+int phalcon_mvc_model_manager_defer_versions(zval *manager TSRMLS_DC);
+int phalcon_mvc_model_manager_flush_versions(zval *manager TSRMLS_DC);
+void phalcon_mvc_model_manager_discard_versions(zval *manager TSRMLS_DC);
+int phalcon_mvc_model_manager_end_versions(zval *manager, zval *connection, int flush TSRMLS_DC);
+int phalcon_mvc_model_manager_bump_version(zval *manager, zval *table, zval *connection TSRMLS_DC);
+int phalcon_mvc_model_manager_event_handlers(zval *manager, zval *model, const char *event_name, uint event_length TSRMLS_DC);
+
 PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Manager);
 
 #endif /* PHALCON_MVC_MODEL_MANAGER_H */
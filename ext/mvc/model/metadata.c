@@ -20,6 +20,7 @@
 #include "mvc/model/metadatainterface.h"
 #include "mvc/model/metadata/strategy/introspection.h"
 #include "mvc/model/exception.h"
+#include "mvc/model/managerinterface.h"
 #include "mvc/modelinterface.h"
 #include "diinterface.h"
 #include "di/injectionawareinterface.h"
@@ -35,6 +36,9 @@
 #include "kernel/string.h"
 #include "kernel/file.h"
 
+#include <main/php_streams.h>
+#include <ext/standard/flock_compat.h>
+
 /**
  * Phalcon\Mvc\Model\MetaData
  *
@@ -80,6 +84,17 @@ PHP_METHOD(Phalcon_Mvc_Model_MetaData, getReverseColumnMap);
 PHP_METHOD(Phalcon_Mvc_Model_MetaData, hasAttribute);
 PHP_METHOD(Phalcon_Mvc_Model_MetaData, isEmpty);
 PHP_METHOD(Phalcon_Mvc_Model_MetaData, reset);
+PHP_METHOD(Phalcon_Mvc_Model_MetaData, setLockDir);
+PHP_METHOD(Phalcon_Mvc_Model_MetaData, getLockDir);
+PHP_METHOD(Phalcon_Mvc_Model_MetaData, warmUp);
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_metadata_setlockdir, 0, 0, 1)
+	ZEND_ARG_INFO(0, lockDir)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_metadata_warmup, 0, 0, 1)
+	ZEND_ARG_INFO(0, models)
+ZEND_END_ARG_INFO()
 
 static const zend_function_entry phalcon_mvc_model_metadata_method_entry[] = {
 	PHP_ME(Phalcon_Mvc_Model_MetaData, _initialize, NULL, ZEND_ACC_PROTECTED)
@@ -109,6 +124,9 @@ static const zend_function_entry phalcon_mvc_model_metadata_method_entry[] = {
 	PHP_ME(Phalcon_Mvc_Model_MetaData, hasAttribute, arginfo_phalcon_mvc_model_metadatainterface_hasattribute, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_MetaData, isEmpty, arginfo_phalcon_mvc_model_metadatainterface_isempty, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_MetaData, reset, arginfo_phalcon_mvc_model_metadatainterface_reset, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_MetaData, setLockDir, arginfo_phalcon_mvc_model_metadata_setlockdir, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_MetaData, getLockDir, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_MetaData, warmUp, arginfo_phalcon_mvc_model_metadata_warmup, ZEND_ACC_PUBLIC)
 	PHP_FE_END
 };
 
@@ -123,6 +141,7 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_MetaData){
 	zend_declare_property_null(phalcon_mvc_model_metadata_ce, SL("_strategy"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_metadata_ce, SL("_metaData"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_metadata_ce, SL("_columnMap"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_metadata_ce, SL("_lockDir"), ZEND_ACC_PROTECTED TSRMLS_CC);
 
 	zend_declare_class_constant_long(phalcon_mvc_model_metadata_ce, SL("MODELS_ATTRIBUTES"),               PHALCON_MVC_MODEL_METADATA_MODELS_ATTRIBUTES               TSRMLS_CC);
 	zend_declare_class_constant_long(phalcon_mvc_model_metadata_ce, SL("MODELS_PRIMARY_KEY"),              PHALCON_MVC_MODEL_METADATA_MODELS_PRIMARY_KEY              TSRMLS_CC);
@@ -146,85 +165,163 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_MetaData){
 }
 
 /**
- * Initialize the metadata for certain table
- *
- * @param Phalcon\Mvc\ModelInterface $model
- * @param string $key
- * @param string $table
- * @param string $schema
+ * Takes an exclusive lock on the file associated to a meta-data key, waiting for other
+ * processes introspecting the same model. Returns NULL if no lock directory was set
  */
-PHP_METHOD(Phalcon_Mvc_Model_MetaData, _initialize){
+static php_stream* phalcon_mvc_model_metadata_lock(zval *this_ptr, zval *prefix_key TSRMLS_DC)
+{
+	zval *lock_dir, *virtual_key;
+	php_stream *stream;
+	char *path;
+
+	lock_dir = phalcon_fetch_nproperty_this(this_ptr, SL("_lockDir"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(lock_dir) != IS_STRING || !Z_STRLEN_P(lock_dir) || Z_TYPE_P(prefix_key) != IS_STRING) {
+		return NULL;
+	}
 
-	zval *model, *key, *table, *schema, *strategy = NULL, *class_name;
-	zval *meta_data = NULL, *prefix_key = NULL, *data = NULL, *model_metadata = NULL;
-	zval *exception_message, *dependency_injector;
-	zval *key_name, *column_map = NULL, *model_column_map = NULL;
+	ALLOC_INIT_ZVAL(virtual_key);
+	phalcon_prepare_virtual_path_ex(virtual_key, Z_STRVAL_P(prefix_key), Z_STRLEN_P(prefix_key), '_' TSRMLS_CC);
+	spprintf(&path, 0, "%s%s.lock", Z_STRVAL_P(lock_dir), Z_STRVAL_P(virtual_key));
+	zval_ptr_dtor(&virtual_key);
+
+	stream = php_stream_open_wrapper(path, "c", REPORT_ERRORS, NULL);
+	efree(path);
+	if (!stream) {
+		return NULL;
+	}
+
+	if (php_stream_lock(stream, LOCK_EX)) {
+		php_stream_close(stream);
+		return NULL;
+	}
+
+	return stream;
+}
+
+/**
+ * Releases a lock taken by phalcon_mvc_model_metadata_lock
+ */
+static void phalcon_mvc_model_metadata_unlock(php_stream *stream TSRMLS_DC)
+{
+	php_stream_lock(stream, LOCK_UN);
+	php_stream_close(stream);
+}
+
+/**
+ * Introspects the meta-data or the column map of a model and writes it to the adapter.
+ * With reread the adapter is checked first, another process may have written it while
+ * this one was waiting for the lock
+ */
+static void phalcon_mvc_model_metadata_introspect(zval *return_value, zval *this_ptr, zval *model, zval *prefix_key, int column_map, int reread, int flush TSRMLS_DC)
+{
+	zval *data = NULL, *dependency_injector, *strategy = NULL, *class_name, *exception_message;
 
 	PHALCON_MM_GROW();
 
-	phalcon_fetch_params(1, 4, 0, &model, &key, &table, &schema);
-	
-	dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
+	if (reread) {
+		PHALCON_CALL_METHOD(&data, this_ptr, "read", prefix_key);
+		if (Z_TYPE_P(data) != IS_NULL) {
+			RETURN_CTOR(data);
+		}
+	}
+
+	if (column_map) {
+		dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
+
+		PHALCON_CALL_METHOD(&strategy, this_ptr, "getstrategy");
+		PHALCON_CALL_METHOD(&data, strategy, "getcolumnmaps", model, dependency_injector);
+	} else if (phalcon_method_exists_ex(model, SS("metadata") TSRMLS_CC) == SUCCESS) {
+
+		/** 
+		 * The model can provide its own meta-data with a method 'metaData'
+		 */
+		PHALCON_CALL_METHOD(&data, model, "metadata");
+		if (Z_TYPE_P(data) != IS_ARRAY) {
+			PHALCON_INIT_VAR(class_name);
+			phalcon_get_class(class_name, model, 0 TSRMLS_CC);
+
+			PHALCON_INIT_VAR(exception_message);
+			PHALCON_CONCAT_SV(exception_message, "Invalid meta-data for model ", class_name);
+			PHALCON_THROW_EXCEPTION_ZVAL(phalcon_mvc_model_exception_ce, exception_message);
+			return;
+		}
+	} else {
+		dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
+
+		PHALCON_CALL_METHOD(&strategy, this_ptr, "getstrategy");
+		PHALCON_CALL_METHOD(&data, strategy, "getmetadata", model, dependency_injector);
+	}
+
+	PHALCON_CALL_METHOD(NULL, this_ptr, "write", prefix_key, data);
+
+	/**
+	 * Adapters buffering their writes must publish them before releasing the lock
+	 */
+	if (flush && phalcon_method_exists_ex(this_ptr, SS("flush") TSRMLS_CC) == SUCCESS) {
+		PHALCON_CALL_METHOD(NULL, this_ptr, "flush");
+	}
+
+	RETURN_CTOR(data);
+}
+
+/**
+ * Returns the meta-data or the column map of a model stored in the adapter, introspecting the
+ * model when it is missing or when forced. Only one process introspects a model, the others
+ * wait and read its result. The lock is released on every path, exceptions included
+ */
+static void phalcon_mvc_model_metadata_fetch(zval *return_value, zval *this_ptr, zval *model, zval *prefix_key, int column_map, int force TSRMLS_DC)
+{
+	zval *data = NULL;
+	php_stream *lock;
+
+	PHALCON_MM_GROW();
+
+	if (!force) {
+		PHALCON_CALL_METHOD(&data, this_ptr, "read", prefix_key);
+		if (Z_TYPE_P(data) != IS_NULL) {
+			RETURN_CTOR(data);
+		}
+	}
+
+	lock = phalcon_mvc_model_metadata_lock(this_ptr, prefix_key TSRMLS_CC);
+
+	phalcon_mvc_model_metadata_introspect(return_value, this_ptr, model, prefix_key, column_map, lock && !force, lock != NULL TSRMLS_CC);
+
+	if (lock) {
+		phalcon_mvc_model_metadata_unlock(lock TSRMLS_CC);
+	}
+
+	RETURN_MM();
+}
+
+/**
+ * Loads the meta-data and the column map of a model, a forced load ignores the data stored
+ * locally and in the adapter and writes the introspected one through
+ */
+static void phalcon_mvc_model_metadata_initialize(zval *this_ptr, zval *model, zval *key, int force TSRMLS_DC)
+{
+	zval *meta_data, *prefix_key = NULL, *data = NULL, *key_name, *column_map;
+
+	PHALCON_MM_GROW();
 
-	PHALCON_INIT_VAR(strategy);
-	
-	PHALCON_INIT_VAR(class_name);
-	phalcon_get_class(class_name, model, 0 TSRMLS_CC);
 	if (Z_TYPE_P(key) != IS_NULL) {
 	
-		PHALCON_OBS_VAR(meta_data);
-		phalcon_read_property_this(&meta_data, this_ptr, SL("_metaData"), PH_NOISY TSRMLS_CC);
-		if (!phalcon_array_isset(meta_data, key)) {
+		meta_data = phalcon_fetch_nproperty_this(this_ptr, SL("_metaData"), PH_NOISY TSRMLS_CC);
+		if (force || !phalcon_array_isset(meta_data, key)) {
 	
 			PHALCON_INIT_VAR(prefix_key);
 			PHALCON_CONCAT_SV(prefix_key, "meta-", key);
 	
+			PHALCON_INIT_VAR(data);
+			phalcon_mvc_model_metadata_fetch(data, this_ptr, model, prefix_key, 0, force TSRMLS_CC);
+			if (EG(exception)) {
+				RETURN_MM();
+			}
+	
 			/** 
-			 * The meta-data is read from the adapter always
+			 * Store the meta-data locally
 			 */
-			PHALCON_CALL_METHOD(&data, this_ptr, "read", prefix_key);
-			if (Z_TYPE_P(data) != IS_NULL) {
-				if (Z_TYPE_P(meta_data) != IS_ARRAY) { 
-					PHALCON_INIT_NVAR(meta_data);
-					array_init(meta_data);
-				}
-				phalcon_array_update_zval(&meta_data, key, data, PH_COPY | PH_SEPARATE);
-				phalcon_update_property_this(this_ptr, SL("_metaData"), meta_data TSRMLS_CC);
-			} else {
-				/** 
-				 * Check if there is a method 'metaData' in the model to retrieve meta-data from it
-				 */
-				if (phalcon_method_exists_ex(model, SS("metadata") TSRMLS_CC) == SUCCESS) {
-					PHALCON_CALL_METHOD(&model_metadata, model, "metadata");
-					if (Z_TYPE_P(model_metadata) != IS_ARRAY) { 
-						PHALCON_INIT_VAR(exception_message);
-						PHALCON_CONCAT_SV(exception_message, "Invalid meta-data for model ", class_name);
-						PHALCON_THROW_EXCEPTION_ZVAL(phalcon_mvc_model_exception_ce, exception_message);
-						return;
-					}
-				} else {
-
-					/** 
-					 * Get the meta-data extraction strategy
-					 */
-					PHALCON_CALL_METHOD(&strategy, this_ptr, "getstrategy");
-	
-					/** 
-					 * Get the meta-data
-					 */
-					PHALCON_CALL_METHOD(&model_metadata, strategy, "getmetadata", model, dependency_injector);
-				}
-	
-				/** 
-				 * Store the meta-data locally
-				 */
-				phalcon_update_property_array(this_ptr, SL("_metaData"), key, model_metadata TSRMLS_CC);
-	
-				/** 
-				 * Store the meta-data in the adapter
-				 */
-				PHALCON_CALL_METHOD(NULL, this_ptr, "write", prefix_key, model_metadata);
-			}
+			phalcon_update_property_array(this_ptr, SL("_metaData"), key, data TSRMLS_CC);
 		}
 	}
 	
@@ -232,21 +329,15 @@ PHP_METHOD(Phalcon_Mvc_Model_MetaData, _initialize){
 	 * Check for a column map, store in _columnMap in order and reversed order
 	 */
 	if (!PHALCON_GLOBAL(orm).column_renaming) {
-		RETURN_MM_NULL();
+		RETURN_MM();
 	}
 	
 	PHALCON_INIT_VAR(key_name);
-	phalcon_fast_strtolower(key_name, class_name);
-	
-	PHALCON_OBS_VAR(column_map);
-	phalcon_read_property_this(&column_map, this_ptr, SL("_columnMap"), PH_NOISY TSRMLS_CC);
-	if (phalcon_array_isset(column_map, key_name)) {
-		RETURN_MM_NULL();
-	}
+	phalcon_get_class(key_name, model, 1 TSRMLS_CC);
 	
-	if (Z_TYPE_P(column_map) != IS_ARRAY) { 
-		PHALCON_INIT_NVAR(column_map);
-		array_init(column_map);
+	column_map = phalcon_fetch_nproperty_this(this_ptr, SL("_columnMap"), PH_NOISY TSRMLS_CC);
+	if (!force && phalcon_array_isset(column_map, key_name)) {
+		RETURN_MM();
 	}
 	
 	/** 
@@ -255,41 +346,37 @@ PHP_METHOD(Phalcon_Mvc_Model_MetaData, _initialize){
 	PHALCON_INIT_NVAR(prefix_key);
 	PHALCON_CONCAT_SV(prefix_key, "map-", key_name);
 	
-	/** 
-	 * Check if the meta-data is already in the adapter
-	 */
-	PHALCON_CALL_METHOD(&data, this_ptr, "read", prefix_key);
-	if (Z_TYPE_P(data) != IS_NULL) {
-		phalcon_array_update_zval(&column_map, key_name, data, PH_COPY | PH_SEPARATE);
-		phalcon_update_property_this(this_ptr, SL("_columnMap"), column_map TSRMLS_CC);
-		RETURN_MM_NULL();
-	}
-	
-	/** 
-	 * Get the meta-data extraction strategy
-	 */
-	if (Z_TYPE_P(strategy) != IS_OBJECT) {
-		PHALCON_CALL_METHOD(&strategy, this_ptr, "getstrategy");
+	PHALCON_INIT_NVAR(data);
+	phalcon_mvc_model_metadata_fetch(data, this_ptr, model, prefix_key, 1, force TSRMLS_CC);
+	if (EG(exception)) {
+		RETURN_MM();
 	}
 	
-	/** 
-	 * Get the meta-data
-	 */
-	PHALCON_CALL_METHOD(&model_column_map, strategy, "getcolumnmaps", model, dependency_injector);
-	
 	/** 
 	 * Update the column map locally
 	 */
-	phalcon_update_property_array(this_ptr, SL("_columnMap"), key_name, model_column_map TSRMLS_CC);
-	
-	/** 
-	 * Write the data to the adapter
-	 */
-	PHALCON_CALL_METHOD(NULL, this_ptr, "write", prefix_key, model_column_map);
+	phalcon_update_property_array(this_ptr, SL("_columnMap"), key_name, data TSRMLS_CC);
 	
 	PHALCON_MM_RESTORE();
 }
 
+/**
+ * Initialize the metadata for certain table
+ *
+ * @param Phalcon\Mvc\ModelInterface $model
+ * @param string $key
+ * @param string $table
+ * @param string $schema
+ */
+PHP_METHOD(Phalcon_Mvc_Model_MetaData, _initialize){
+
+	zval *model, *key, *table, *schema;
+
+	phalcon_fetch_params(0, 4, 0, &model, &key, &table, &schema);
+	
+	phalcon_mvc_model_metadata_initialize(this_ptr, model, key, 0 TSRMLS_CC);
+}
+
 /**
  * Sets the DependencyInjector container
  *
@@ -1118,3 +1205,236 @@ PHP_METHOD(Phalcon_Mvc_Model_MetaData, reset){
 	phalcon_update_property_this(this_ptr, SL("_metaData"), empty_array TSRMLS_CC);
 	phalcon_update_property_this(this_ptr, SL("_columnMap"), empty_array TSRMLS_CC);
 }
+
+/**
+ * Sets a directory where lock files are created, so only one process introspects a model
+ * while the others wait for its meta-data to be stored in the adapter
+ *
+ *<code>
+ *	$metaData->setLockDir('../app/cache/locks/');
+ *</code>
+ *
+ * @param string $lockDir
+ * @return Phalcon\Mvc\Model\MetaData
+ */
+PHP_METHOD(Phalcon_Mvc_Model_MetaData, setLockDir){
+
+	zval **lock_dir;
+
+	phalcon_fetch_params_ex(1, 0, &lock_dir);
+
+	if (Z_TYPE_PP(lock_dir) != IS_NULL) {
+		PHALCON_ENSURE_IS_STRING(lock_dir);
+	}
+
+	phalcon_update_property_this(this_ptr, SL("_lockDir"), *lock_dir TSRMLS_CC);
+	RETURN_THISW();
+}
+
+/**
+ * Returns the directory where lock files are created
+ *
+ * @return string
+ */
+PHP_METHOD(Phalcon_Mvc_Model_MetaData, getLockDir){
+
+
+	RETURN_MEMBER(this_ptr, "_lockDir");
+}
+
+/**
+ * Introspects the meta-data and the column map of a model again, replacing the stored ones
+ */
+static void phalcon_mvc_model_metadata_refresh(zval *this_ptr, zval *model TSRMLS_DC)
+{
+	zval *table = NULL, *schema = NULL, *class_name, *key;
+
+	PHALCON_MM_GROW();
+
+	PHALCON_CALL_METHOD(&table, model, "getsource");
+	PHALCON_CALL_METHOD(&schema, model, "getschema");
+
+	PHALCON_INIT_VAR(class_name);
+	phalcon_get_class(class_name, model, 1 TSRMLS_CC);
+
+	/**
+	 * Unique key for meta-data is created using class-name-schema-table
+	 */
+	PHALCON_INIT_VAR(key);
+	PHALCON_CONCAT_VSVV(key, class_name, "-", schema, table);
+
+	phalcon_mvc_model_metadata_initialize(this_ptr, model, key, 1 TSRMLS_CC);
+
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Introspects the meta-data and column maps of a set of models in one pass and writes them
+ * to the adapter, replacing the stored ones, so it can be run on every deploy.
+ * Directories are scanned for *.php files, a string key is used as the namespace of
+ * the classes found in its directory. Adapters buffering their writes are flushed at the end
+ *
+ *<code>
+ *	class MetadataTask extends Phalcon\CLI\Task
+ *	{
+ *		public function warmUpAction()
+ *		{
+ *			$this->modelsMetadata->warmUp(array(
+ *				'Store\Models' => '../app/models/',
+ *				'Robots'
+ *			));
+ *		}
+ *	}
+ *</code>
+ *
+ * @param array|string $models
+ * @return array
+ */
+PHP_METHOD(Phalcon_Mvc_Model_MetaData, warmUp){
+
+	zval *models, *dependency_injector, *service, *manager = NULL;
+	zval *is_dir, *pattern = NULL, *files = NULL, *suffix;
+	zval *file_name = NULL, *class_name = NULL, *model = NULL, *name = NULL, *namespace_name = NULL;
+	zval **value, **entry;
+	HashTable *ah0, *ah1;
+	HashPosition hp0, hp1;
+	zend_class_entry *ce0;
+	char *str_key;
+	uint str_key_len;
+	ulong idx;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &models);
+
+	if (Z_TYPE_P(models) == IS_STRING) {
+		PHALCON_SEPARATE_PARAM(models);
+		convert_to_array(models);
+	} else if (Z_TYPE_P(models) != IS_ARRAY) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Models must be an array or a string");
+		return;
+	}
+
+	dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(dependency_injector) != IS_OBJECT) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "A dependency injector container is required to obtain the models manager");
+		return;
+	}
+
+	PHALCON_INIT_VAR(service);
+	ZVAL_STRING(service, "modelsManager", 1);
+
+	PHALCON_CALL_METHOD(&manager, dependency_injector, "getshared", service);
+	PHALCON_VERIFY_INTERFACE(manager, phalcon_mvc_model_managerinterface_ce);
+
+	PHALCON_INIT_VAR(suffix);
+	ZVAL_STRING(suffix, ".php", 1);
+
+	PHALCON_INIT_VAR(is_dir);
+
+	array_init(return_value);
+
+	phalcon_is_iterable(models, &ah0, &hp0, 0, 0);
+
+	while (zend_hash_get_current_data_ex(ah0, (void**) &value, &hp0) == SUCCESS) {
+
+		if (Z_TYPE_PP(value) != IS_STRING) {
+			zend_hash_move_forward_ex(ah0, &hp0);
+			continue;
+		}
+
+		phalcon_is_dir(is_dir, *value TSRMLS_CC);
+		if (!zend_is_true(is_dir)) {
+
+			/**
+			 * Explicit class names must be models
+			 */
+			if (
+				   !phalcon_class_exists_ex(&ce0, *value, 1 TSRMLS_CC)
+				|| (ce0->ce_flags & (ZEND_ACC_IMPLICIT_ABSTRACT_CLASS | ZEND_ACC_EXPLICIT_ABSTRACT_CLASS))
+				|| !instanceof_function_ex(ce0, phalcon_mvc_modelinterface_ce, 1 TSRMLS_CC)
+			) {
+				zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "Model '%s' could not be loaded", Z_STRVAL_PP(value));
+				RETURN_MM();
+			}
+
+			PHALCON_CALL_METHOD(&model, manager, "load", *value);
+
+			phalcon_mvc_model_metadata_refresh(this_ptr, model TSRMLS_CC);
+			if (EG(exception)) {
+				RETURN_MM();
+			}
+
+			phalcon_array_append(&return_value, *value, PH_COPY);
+
+			zend_hash_move_forward_ex(ah0, &hp0);
+			continue;
+		}
+
+		PHALCON_INIT_NVAR(pattern);
+		if (Z_STRLEN_PP(value) && Z_STRVAL_PP(value)[Z_STRLEN_PP(value) - 1] != '/' && Z_STRVAL_PP(value)[Z_STRLEN_PP(value) - 1] != '\\') {
+			PHALCON_CONCAT_VS(pattern, *value, "/*.php");
+		} else {
+			PHALCON_CONCAT_VS(pattern, *value, "*.php");
+		}
+
+		PHALCON_CALL_FUNCTION(&files, "glob", pattern);
+		if (Z_TYPE_P(files) != IS_ARRAY) {
+			zend_hash_move_forward_ex(ah0, &hp0);
+			continue;
+		}
+
+		PHALCON_INIT_NVAR(namespace_name);
+		if (zend_hash_get_current_key_ex(ah0, &str_key, &str_key_len, &idx, 0, &hp0) == HASH_KEY_IS_STRING) {
+			ZVAL_STRINGL(namespace_name, str_key, str_key_len - 1, 1);
+		}
+
+		phalcon_is_iterable(files, &ah1, &hp1, 0, 0);
+
+		while (zend_hash_get_current_data_ex(ah1, (void**) &entry, &hp1) == SUCCESS) {
+
+			PHALCON_CALL_FUNCTION(&file_name, "basename", *entry, suffix);
+
+			PHALCON_INIT_NVAR(class_name);
+			if (Z_TYPE_P(namespace_name) == IS_STRING && Z_STRLEN_P(namespace_name)) {
+				PHALCON_CONCAT_VSV(class_name, namespace_name, "\\", file_name);
+			} else {
+				ZVAL_ZVAL(class_name, file_name, 1, 0);
+			}
+
+			/**
+			 * Files in the directory not declaring a concrete model are skipped
+			 */
+			if (
+				   phalcon_class_exists_ex(&ce0, class_name, 1 TSRMLS_CC)
+				&& !(ce0->ce_flags & (ZEND_ACC_IMPLICIT_ABSTRACT_CLASS | ZEND_ACC_EXPLICIT_ABSTRACT_CLASS))
+				&& instanceof_function_ex(ce0, phalcon_mvc_modelinterface_ce, 1 TSRMLS_CC)
+			) {
+				PHALCON_INIT_NVAR(name);
+				ZVAL_STRINGL(name, ce0->name, ce0->name_length, 1);
+
+				PHALCON_CALL_METHOD(&model, manager, "load", name);
+
+				phalcon_mvc_model_metadata_refresh(this_ptr, model TSRMLS_CC);
+				if (EG(exception)) {
+					RETURN_MM();
+				}
+
+				phalcon_array_append(&return_value, name, PH_COPY);
+			}
+
+			zend_hash_move_forward_ex(ah1, &hp1);
+		}
+
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+
+	/**
+	 * Adapters buffering their writes store everything at once
+	 */
+	if (phalcon_method_exists_ex(this_ptr, SS("flush") TSRMLS_CC) == SUCCESS) {
+		PHALCON_CALL_METHOD(NULL, this_ptr, "flush");
+	}
+
+	RETURN_MM();
+}
@@ -0,0 +1,935 @@
+
+/*
+  +------------------------------------------------------------------------+
+  | Phalcon Framework                                                      |
+  +------------------------------------------------------------------------+
+  | Copyright (c) 2011-2014 Phalcon Team (http://www.phalconphp.com)       |
+  +------------------------------------------------------------------------+
+  | This source file is subject to the New BSD License that is bundled     |
+  | with this package in the file docs/LICENSE.txt.                        |
+  |                                                                        |
+  | If you did not receive a copy of the license and are unable to         |
+  | obtain it through the world-wide-web, please send an email             |
+  | to license@phalconphp.com so we can send you a copy immediately.       |
+  +------------------------------------------------------------------------+
+  | Authors: Andres Gutierrez <andres@phalconphp.com>                      |
+  |          Eduar Carvajal <eduar@phalconphp.com>                         |
+  +------------------------------------------------------------------------+
+*/
+
+#include "mvc/model/metadata/mmap.h"
+#include "mvc/model/metadata.h"
+#include "mvc/model/metadatainterface.h"
+#include "mvc/model/exception.h"
+#include "mvc/modelinterface.h"
+
+#include <main/php_streams.h>
+#include <ext/standard/php_smart_str.h>
+#include <ext/standard/php_var.h>
+#include <ext/standard/php_lcg.h>
+#include <ext/standard/flock_compat.h>
+
+#ifdef PHP_WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "kernel/main.h"
+#include "kernel/memory.h"
+#include "kernel/array.h"
+#include "kernel/object.h"
+#include "kernel/fcall.h"
+#include "kernel/file.h"
+#include "kernel/concat.h"
+#include "kernel/operators.h"
+#include "kernel/exception.h"
+#include "kernel/hash.h"
+
+/**
+ * Phalcon\Mvc\Model\MetaData\Mmap
+ *
+ * Stores the meta-data of every model in a single binary segment which is memory-mapped
+ * by every process, so a cold worker maps one file instead of including/fetching one
+ * entry per model. Entries are located through a hash index embedded in the segment and
+ * every index of the meta-data is stored apart, so readMetaDataIndex() only unserializes
+ * the requested index.
+ *
+ * New meta-data is collected during the request and written once when the adapter is
+ * destroyed (or flush() is called): the segment is rebuilt in a temporary file that
+ * atomically replaces the previous one, increasing its version.
+ *
+ *<code>
+ * $metaData = new \Phalcon\Mvc\Model\Metadata\Mmap(array(
+ *    'metaDataFile' => 'app/cache/metadata.bin'
+ * ));
+ *</code>
+ */
+zend_class_entry *phalcon_mvc_model_metadata_mmap_ce;
+
+static zend_object_handlers phalcon_mvc_model_metadata_mmap_object_handlers;
+
+/**
+ * Layout of the segment, integers are stored in host byte order:
+ *
+ * header:  magic[4] format version buckets entries size
+ * index:   buckets x offset of the entry (0 if the bucket is empty)
+ * entries: hash key_length value_length key value
+ *
+ * Values start with a tag: 'S' followed by a serialized value, or 'I' followed by the list
+ * of indexes of an array whose elements are stored as "<key>\0<index>" entries
+ */
+#define PHALCON_MMAP_MAGIC        "PMMD"
+#define PHALCON_MMAP_FORMAT       1
+#define PHALCON_MMAP_HEADER_SIZE  24
+#define PHALCON_MMAP_ENTRY_SIZE   12
+
+#define PHALCON_MMAP_TAG_SERIALIZED  'S'
+#define PHALCON_MMAP_TAG_INDEXES     'I'
+
+typedef struct _phalcon_mvc_model_metadata_mmap_object {
+	zend_object obj;      /**< Zend Object */
+	php_stream *stream;   /**< Stream of the mapped file */
+	int rsrc_id;          /**< Resource id of the stream */
+	char *segment;        /**< Mapped segment, or a copy of it if the stream cannot be mapped */
+	size_t size;          /**< Size of the segment */
+	int mapped;           /**< Whether the segment is mapped */
+	zend_uint version;    /**< Version of the segment */
+	zend_uint buckets;    /**< Number of buckets of the hash index */
+} phalcon_mvc_model_metadata_mmap_object;
+
+PHALCON_ATTR_NONNULL static inline phalcon_mvc_model_metadata_mmap_object* phalcon_mvc_model_metadata_mmap_get_object(zval *obj TSRMLS_DC)
+{
+	return (phalcon_mvc_model_metadata_mmap_object*)zend_objects_get_address(obj TSRMLS_CC);
+}
+
+static inline zend_uint phalcon_mmap_read_uint(const char *p)
+{
+	zend_uint v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline void phalcon_mmap_write_uint(char *p, zend_uint v)
+{
+	memcpy(p, &v, sizeof(v));
+}
+
+/**
+ * Releases the segment
+ */
+static void phalcon_mvc_model_metadata_mmap_close(phalcon_mvc_model_metadata_mmap_object *obj TSRMLS_DC)
+{
+	if (obj->stream) {
+		int type;
+
+		/* The stream could have been released already if the request is shutting down */
+		if (zend_list_find(obj->rsrc_id, &type) == obj->stream) {
+			php_stream_mmap_unmap(obj->stream);
+			php_stream_close(obj->stream);
+		}
+	} else if (obj->segment) {
+		efree(obj->segment);
+	}
+
+	obj->stream  = NULL;
+	obj->rsrc_id = 0;
+	obj->segment = NULL;
+	obj->size    = 0;
+	obj->mapped  = 0;
+	obj->version = 0;
+	obj->buckets = 0;
+}
+
+/**
+ * Maps the segment stored in a file, checking that its header and index are consistent
+ */
+static int phalcon_mvc_model_metadata_mmap_open(phalcon_mvc_model_metadata_mmap_object *obj, const char *path TSRMLS_DC)
+{
+	php_stream *stream;
+	char *segment = NULL;
+	size_t size = 0;
+	zend_uint buckets;
+
+	phalcon_mvc_model_metadata_mmap_close(obj TSRMLS_CC);
+
+	stream = php_stream_open_wrapper((char*)path, "rb", 0, NULL);
+	if (!stream) {
+		return FAILURE;
+	}
+
+	if (php_stream_mmap_possible(stream)) {
+		segment = php_stream_mmap_range(stream, 0, PHP_STREAM_MMAP_ALL, PHP_STREAM_MAP_MODE_SHARED_READONLY, &size);
+	}
+
+	if (segment) {
+		obj->stream  = stream;
+		obj->rsrc_id = stream->rsrc_id;
+		obj->mapped  = 1;
+	} else {
+		size = php_stream_copy_to_mem(stream, &segment, PHP_STREAM_COPY_ALL, 0);
+		php_stream_close(stream);
+	}
+
+	obj->segment = segment;
+	obj->size    = size;
+
+	if (!segment || size < PHALCON_MMAP_HEADER_SIZE || memcmp(segment, PHALCON_MMAP_MAGIC, 4)) {
+		phalcon_mvc_model_metadata_mmap_close(obj TSRMLS_CC);
+		return FAILURE;
+	}
+
+	buckets = phalcon_mmap_read_uint(segment + 12);
+	if (
+		   phalcon_mmap_read_uint(segment + 4) != PHALCON_MMAP_FORMAT
+		|| phalcon_mmap_read_uint(segment + 20) != size
+		|| !buckets || (buckets & (buckets - 1))
+		|| buckets > (size - PHALCON_MMAP_HEADER_SIZE) / sizeof(zend_uint)
+	) {
+		phalcon_mvc_model_metadata_mmap_close(obj TSRMLS_CC);
+		return FAILURE;
+	}
+
+	obj->version = phalcon_mmap_read_uint(segment + 8);
+	obj->buckets = buckets;
+	return SUCCESS;
+}
+
+/**
+ * Opens and exclusively locks "<file>.lock", flushes of several processes are serialized so
+ * every one of them merges the entries written by the previous ones
+ */
+static php_stream* phalcon_mvc_model_metadata_mmap_lock(const char *path TSRMLS_DC)
+{
+	php_stream *stream;
+	char *lock_path;
+
+	spprintf(&lock_path, 0, "%s.lock", path);
+	stream = php_stream_open_wrapper(lock_path, "cb", REPORT_ERRORS, NULL);
+	efree(lock_path);
+
+	if (stream && php_stream_supports_lock(stream) && php_stream_lock(stream, LOCK_EX)) {
+		php_stream_close(stream);
+		return NULL;
+	}
+
+	return stream;
+}
+
+/**
+ * Releases the lock taken by phalcon_mvc_model_metadata_mmap_lock()
+ */
+static void phalcon_mvc_model_metadata_mmap_unlock(php_stream *stream TSRMLS_DC)
+{
+	if (php_stream_supports_lock(stream)) {
+		php_stream_lock(stream, LOCK_UN);
+	}
+
+	php_stream_close(stream);
+}
+
+/**
+ * Returns the entry stored at an offset of the segment, if it is inside the segment
+ */
+static int phalcon_mvc_model_metadata_mmap_entry(phalcon_mvc_model_metadata_mmap_object *obj, zend_uint offset, zend_uint *hash, const char **key, zend_uint *key_len, const char **value, zend_uint *value_len)
+{
+	const char *entry;
+
+	if (offset < PHALCON_MMAP_HEADER_SIZE || offset > obj->size - PHALCON_MMAP_ENTRY_SIZE) {
+		return 0;
+	}
+
+	entry      = obj->segment + offset;
+	*hash      = phalcon_mmap_read_uint(entry);
+	*key_len   = phalcon_mmap_read_uint(entry + 4);
+	*value_len = phalcon_mmap_read_uint(entry + 8);
+
+	if (*key_len > obj->size - offset - PHALCON_MMAP_ENTRY_SIZE || *value_len > obj->size - offset - PHALCON_MMAP_ENTRY_SIZE - *key_len) {
+		return 0;
+	}
+
+	*key   = entry + PHALCON_MMAP_ENTRY_SIZE;
+	*value = *key + *key_len;
+	return 1;
+}
+
+/**
+ * Looks up an entry by its key using the hash index
+ */
+static int phalcon_mvc_model_metadata_mmap_find(phalcon_mvc_model_metadata_mmap_object *obj, const char *key, uint key_len, const char **value, zend_uint *value_len)
+{
+	zend_uint hash, mask, position, i, entry_hash, entry_key_len;
+	const char *index, *entry_key;
+
+	if (!obj->segment) {
+		return 0;
+	}
+
+	hash     = (zend_uint)zend_inline_hash_func(key, key_len);
+	mask     = obj->buckets - 1;
+	position = hash & mask;
+	index    = obj->segment + PHALCON_MMAP_HEADER_SIZE;
+
+	for (i = 0; i < obj->buckets; ++i) {
+		zend_uint offset = phalcon_mmap_read_uint(index + position * sizeof(zend_uint));
+
+		if (!offset || !phalcon_mvc_model_metadata_mmap_entry(obj, offset, &entry_hash, &entry_key, &entry_key_len, value, value_len)) {
+			return 0;
+		}
+
+		if (entry_hash == hash && entry_key_len == key_len && !memcmp(entry_key, key, key_len)) {
+			return 1;
+		}
+
+		position = (position + 1) & mask;
+	}
+
+	return 0;
+}
+
+/**
+ * Unserializes a value tagged as serialized
+ */
+static int phalcon_mvc_model_metadata_mmap_unserialize(zval *return_value, const char *value, zend_uint value_len TSRMLS_DC)
+{
+	php_unserialize_data_t var_hash;
+	const unsigned char *p, *max;
+	int retval;
+
+	if (value_len < 1 || value[0] != PHALCON_MMAP_TAG_SERIALIZED) {
+		return FAILURE;
+	}
+
+	p   = (const unsigned char*)value + 1;
+	max = (const unsigned char*)value + value_len;
+
+	PHP_VAR_UNSERIALIZE_INIT(var_hash);
+	retval = php_var_unserialize(&return_value, &p, max, &var_hash TSRMLS_CC) ? SUCCESS : FAILURE;
+	PHP_VAR_UNSERIALIZE_DESTROY(var_hash);
+
+	if (retval == FAILURE) {
+		zval_dtor(return_value);
+		ZVAL_NULL(return_value);
+	}
+
+	return retval;
+}
+
+/**
+ * Builds the key of the entry holding an index of an array
+ */
+static void phalcon_mvc_model_metadata_mmap_index_key(smart_str *buf, const char *key, uint key_len, ulong index)
+{
+	smart_str_appendl(buf, key, key_len);
+	smart_str_appendc(buf, '\0');
+	smart_str_append_unsigned(buf, index);
+	smart_str_0(buf);
+}
+
+/**
+ * Serializes a value, adding its tag
+ */
+static void phalcon_mvc_model_metadata_mmap_serialize(zval *entries, const char *key, uint key_len, zval *value TSRMLS_DC)
+{
+	smart_str buf = { NULL, 0, 0 };
+	php_serialize_data_t var_hash;
+
+	smart_str_appendc(&buf, PHALCON_MMAP_TAG_SERIALIZED);
+
+	PHP_VAR_SERIALIZE_INIT(var_hash);
+	php_var_serialize(&buf, &value, &var_hash TSRMLS_CC);
+	PHP_VAR_SERIALIZE_DESTROY(var_hash);
+
+	add_assoc_stringl_ex(entries, (char*)key, key_len + 1, buf.c, buf.len, 0);
+}
+
+/**
+ * Adds the entries of a value, arrays with numeric keys are stored one entry per index
+ */
+static void phalcon_mvc_model_metadata_mmap_add(zval *entries, const char *key, uint key_len, zval *value TSRMLS_DC)
+{
+	HashTable *ht;
+	HashPosition hp;
+	zval **item;
+	smart_str indexes = { NULL, 0, 0 };
+
+	if (Z_TYPE_P(value) == IS_ARRAY && zend_hash_num_elements(Z_ARRVAL_P(value))) {
+		ht = Z_ARRVAL_P(value);
+
+		for (
+			zend_hash_internal_pointer_reset_ex(ht, &hp);
+			zend_hash_get_current_data_ex(ht, (void**)&item, &hp) == SUCCESS;
+			zend_hash_move_forward_ex(ht, &hp)
+		) {
+			if (zend_hash_get_current_key_type_ex(ht, &hp) != HASH_KEY_IS_LONG) {
+				phalcon_mvc_model_metadata_mmap_serialize(entries, key, key_len, value TSRMLS_CC);
+				return;
+			}
+		}
+
+		smart_str_appendc(&indexes, PHALCON_MMAP_TAG_INDEXES);
+
+		for (
+			zend_hash_internal_pointer_reset_ex(ht, &hp);
+			zend_hash_get_current_data_ex(ht, (void**)&item, &hp) == SUCCESS;
+			zend_hash_move_forward_ex(ht, &hp)
+		) {
+			smart_str index_key = { NULL, 0, 0 };
+			char raw[sizeof(zend_uint)];
+			ulong index;
+
+			zend_hash_get_current_key_ex(ht, NULL, NULL, &index, 0, &hp);
+
+			phalcon_mmap_write_uint(raw, (zend_uint)index);
+			smart_str_appendl(&indexes, raw, sizeof(raw));
+
+			phalcon_mvc_model_metadata_mmap_index_key(&index_key, key, key_len, index);
+			phalcon_mvc_model_metadata_mmap_serialize(entries, index_key.c, index_key.len, *item TSRMLS_CC);
+			smart_str_free(&index_key);
+		}
+
+		add_assoc_stringl_ex(entries, (char*)key, key_len + 1, indexes.c, indexes.len, 0);
+		return;
+	}
+
+	phalcon_mvc_model_metadata_mmap_serialize(entries, key, key_len, value TSRMLS_CC);
+}
+
+/**
+ * Builds a segment from a list of entries
+ */
+static char* phalcon_mvc_model_metadata_mmap_build(zval *entries, zend_uint version, size_t *size)
+{
+	HashTable *ht = Z_ARRVAL_P(entries);
+	HashPosition hp;
+	zval **value;
+	zend_uint buckets = 8, mask, offset;
+	size_t total;
+	char *segment, *index;
+
+	while (buckets < 2 * zend_hash_num_elements(ht)) {
+		buckets <<= 1;
+	}
+
+	total = PHALCON_MMAP_HEADER_SIZE + buckets * sizeof(zend_uint);
+	for (
+		zend_hash_internal_pointer_reset_ex(ht, &hp);
+		zend_hash_get_current_data_ex(ht, (void**)&value, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(ht, &hp)
+	) {
+		char *key;
+		uint key_len;
+
+		zend_hash_get_current_key_ex(ht, &key, &key_len, NULL, 0, &hp);
+		total += PHALCON_MMAP_ENTRY_SIZE + (key_len - 1) + Z_STRLEN_PP(value);
+	}
+
+	segment = ecalloc(1, total);
+	index   = segment + PHALCON_MMAP_HEADER_SIZE;
+	mask    = buckets - 1;
+	offset  = PHALCON_MMAP_HEADER_SIZE + buckets * sizeof(zend_uint);
+
+	memcpy(segment, PHALCON_MMAP_MAGIC, 4);
+	phalcon_mmap_write_uint(segment + 4, PHALCON_MMAP_FORMAT);
+	phalcon_mmap_write_uint(segment + 8, version);
+	phalcon_mmap_write_uint(segment + 12, buckets);
+	phalcon_mmap_write_uint(segment + 16, zend_hash_num_elements(ht));
+	phalcon_mmap_write_uint(segment + 20, (zend_uint)total);
+
+	for (
+		zend_hash_internal_pointer_reset_ex(ht, &hp);
+		zend_hash_get_current_data_ex(ht, (void**)&value, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(ht, &hp)
+	) {
+		char *key;
+		uint key_len;
+		zend_uint hash, position;
+
+		zend_hash_get_current_key_ex(ht, &key, &key_len, NULL, 0, &hp);
+		--key_len;
+
+		hash = (zend_uint)zend_inline_hash_func(key, key_len);
+		position = hash & mask;
+		while (phalcon_mmap_read_uint(index + position * sizeof(zend_uint))) {
+			position = (position + 1) & mask;
+		}
+
+		phalcon_mmap_write_uint(index + position * sizeof(zend_uint), offset);
+
+		phalcon_mmap_write_uint(segment + offset, hash);
+		phalcon_mmap_write_uint(segment + offset + 4, key_len);
+		phalcon_mmap_write_uint(segment + offset + 8, Z_STRLEN_PP(value));
+		memcpy(segment + offset + PHALCON_MMAP_ENTRY_SIZE, key, key_len);
+		memcpy(segment + offset + PHALCON_MMAP_ENTRY_SIZE + key_len, Z_STRVAL_PP(value), Z_STRLEN_PP(value));
+
+		offset += PHALCON_MMAP_ENTRY_SIZE + key_len + Z_STRLEN_PP(value);
+	}
+
+	*size = total;
+	return segment;
+}
+
+/**
+ * Frees the segment when the adapter is destroyed
+ */
+static void phalcon_mvc_model_metadata_mmap_dtor(void *v TSRMLS_DC)
+{
+	phalcon_mvc_model_metadata_mmap_object *obj = v;
+
+	phalcon_mvc_model_metadata_mmap_close(obj TSRMLS_CC);
+	zend_object_std_dtor(&obj->obj TSRMLS_CC);
+	efree(obj);
+}
+
+static zend_object_value phalcon_mvc_model_metadata_mmap_ctor(zend_class_entry* ce TSRMLS_DC)
+{
+	phalcon_mvc_model_metadata_mmap_object *obj = ecalloc(1, sizeof(phalcon_mvc_model_metadata_mmap_object));
+	zend_object_value retval;
+
+	zend_object_std_init(&obj->obj, ce TSRMLS_CC);
+	object_properties_init(&obj->obj, ce);
+
+	retval.handle = zend_objects_store_put(
+		obj,
+		(zend_objects_store_dtor_t)zend_objects_destroy_object,
+		phalcon_mvc_model_metadata_mmap_dtor,
+		NULL TSRMLS_CC
+	);
+
+	retval.handlers = &phalcon_mvc_model_metadata_mmap_object_handlers;
+
+	return retval;
+}
+
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, __construct);
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, read);
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, write);
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, readMetaDataIndex);
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, flush);
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, getVersion);
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, reset);
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, __destruct);
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_metadata_mmap___construct, 0, 0, 0)
+	ZEND_ARG_INFO(0, options)
+ZEND_END_ARG_INFO()
+
+static const zend_function_entry phalcon_mvc_model_metadata_mmap_method_entry[] = {
+	PHP_ME(Phalcon_Mvc_Model_MetaData_Mmap, __construct, arginfo_phalcon_mvc_model_metadata_mmap___construct, ZEND_ACC_PUBLIC|ZEND_ACC_CTOR)
+	PHP_ME(Phalcon_Mvc_Model_MetaData_Mmap, read, arginfo_phalcon_mvc_model_metadatainterface_read, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_MetaData_Mmap, write, arginfo_phalcon_mvc_model_metadatainterface_write, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_MetaData_Mmap, readMetaDataIndex, arginfo_phalcon_mvc_model_metadatainterface_readmetadataindex, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_MetaData_Mmap, flush, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_MetaData_Mmap, getVersion, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_MetaData_Mmap, reset, arginfo_phalcon_mvc_model_metadatainterface_reset, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_MetaData_Mmap, __destruct, NULL, ZEND_ACC_PUBLIC|ZEND_ACC_DTOR)
+	PHP_FE_END
+};
+
+/**
+ * Phalcon\Mvc\Model\MetaData\Mmap initializer
+ */
+PHALCON_INIT_CLASS(Phalcon_Mvc_Model_MetaData_Mmap){
+
+	PHALCON_REGISTER_CLASS_EX(Phalcon\\Mvc\\Model\\MetaData, Mmap, mvc_model_metadata_mmap, phalcon_mvc_model_metadata_ce, phalcon_mvc_model_metadata_mmap_method_entry, 0);
+
+	zend_declare_property_string(phalcon_mvc_model_metadata_mmap_ce, SL("_metaDataFile"), "./metadata.bin", ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_metadata_mmap_ce, SL("_pending"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_metadata_mmap_ce, SL("_indexes"), ZEND_ACC_PROTECTED TSRMLS_CC);
+
+	phalcon_mvc_model_metadata_mmap_ce->create_object = phalcon_mvc_model_metadata_mmap_ctor;
+
+	phalcon_mvc_model_metadata_mmap_object_handlers = *zend_get_std_object_handlers();
+	phalcon_mvc_model_metadata_mmap_object_handlers.clone_obj = NULL;
+
+	zend_class_implements(phalcon_mvc_model_metadata_mmap_ce TSRMLS_CC, 1, phalcon_mvc_model_metadatainterface_ce);
+
+	return SUCCESS;
+}
+
+/**
+ * Phalcon\Mvc\Model\MetaData\Mmap constructor
+ *
+ * @param array $options
+ */
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, __construct){
+
+	zval *options = NULL, *meta_data_file, *empty_array;
+	phalcon_mvc_model_metadata_mmap_object *obj;
+
+	phalcon_fetch_params(0, 0, 1, &options);
+
+	if (options && Z_TYPE_P(options) == IS_ARRAY) {
+		if (phalcon_array_isset_string_fetch(&meta_data_file, options, SS("metaDataFile"))) {
+			phalcon_update_property_this(this_ptr, SL("_metaDataFile"), meta_data_file TSRMLS_CC);
+		}
+	}
+
+	PHALCON_ALLOC_GHOST_ZVAL(empty_array);
+	array_init(empty_array);
+	phalcon_update_property_this(this_ptr, SL("_metaData"), empty_array TSRMLS_CC);
+
+	meta_data_file = phalcon_fetch_nproperty_this(this_ptr, SL("_metaDataFile"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(meta_data_file) != IS_STRING) {
+		PHALCON_THROW_EXCEPTION_STRW(phalcon_mvc_model_exception_ce, "The meta-data file must be a string");
+		return;
+	}
+
+	/**
+	 * A missing or invalid segment is just an empty one
+	 */
+	obj = phalcon_mvc_model_metadata_mmap_get_object(getThis() TSRMLS_CC);
+	phalcon_mvc_model_metadata_mmap_open(obj, Z_STRVAL_P(meta_data_file) TSRMLS_CC);
+}
+
+/**
+ * Reads meta-data from the segment
+ *
+ * @param string $key
+ * @return array
+ */
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, read){
+
+	zval **key, *pending, *data, *meta_data_file;
+	phalcon_mvc_model_metadata_mmap_object *obj;
+	const char *value;
+	zend_uint value_len, i;
+
+	phalcon_fetch_params_ex(1, 0, &key);
+	PHALCON_ENSURE_IS_STRING(key);
+
+	pending = phalcon_fetch_nproperty_this(this_ptr, SL("_pending"), PH_NOISY TSRMLS_CC);
+	if (phalcon_array_isset_fetch(&data, pending, *key)) {
+		RETURN_ZVAL(data, 1, 0);
+	}
+
+	obj = phalcon_mvc_model_metadata_mmap_get_object(getThis() TSRMLS_CC);
+	if (!phalcon_mvc_model_metadata_mmap_find(obj, Z_STRVAL_PP(key), Z_STRLEN_PP(key), &value, &value_len)) {
+
+		/**
+		 * Another process could have flushed the key since the segment was mapped
+		 */
+		meta_data_file = phalcon_fetch_nproperty_this(this_ptr, SL("_metaDataFile"), PH_NOISY TSRMLS_CC);
+		if (
+			   Z_TYPE_P(meta_data_file) != IS_STRING
+			|| phalcon_mvc_model_metadata_mmap_open(obj, Z_STRVAL_P(meta_data_file) TSRMLS_CC) == FAILURE
+			|| !phalcon_mvc_model_metadata_mmap_find(obj, Z_STRVAL_PP(key), Z_STRLEN_PP(key), &value, &value_len)
+		) {
+			RETURN_NULL();
+		}
+	}
+
+	if (value_len < 1 || value[0] != PHALCON_MMAP_TAG_INDEXES) {
+		phalcon_mvc_model_metadata_mmap_unserialize(return_value, value, value_len TSRMLS_CC);
+		return;
+	}
+
+	/**
+	 * Rebuild the array from the entries of its indexes
+	 */
+	array_init_size(return_value, (value_len - 1) / sizeof(zend_uint));
+	for (i = 1; i + sizeof(zend_uint) <= value_len; i += sizeof(zend_uint)) {
+		smart_str index_key = { NULL, 0, 0 };
+		zend_uint index = phalcon_mmap_read_uint(value + i);
+		const char *item;
+		zend_uint item_len;
+		zval *element;
+
+		phalcon_mvc_model_metadata_mmap_index_key(&index_key, Z_STRVAL_PP(key), Z_STRLEN_PP(key), index);
+
+		if (!phalcon_mvc_model_metadata_mmap_find(obj, index_key.c, index_key.len, &item, &item_len)) {
+			smart_str_free(&index_key);
+			zval_dtor(return_value);
+			RETURN_NULL();
+		}
+
+		smart_str_free(&index_key);
+
+		MAKE_STD_ZVAL(element);
+		if (phalcon_mvc_model_metadata_mmap_unserialize(element, item, item_len TSRMLS_CC) == FAILURE) {
+			zval_ptr_dtor(&element);
+			zval_dtor(return_value);
+			RETURN_NULL();
+		}
+
+		add_index_zval(return_value, index, element);
+	}
+}
+
+/**
+ * Collects the meta-data to be written in the segment
+ *
+ * @param string $key
+ * @param array $data
+ */
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, write){
+
+	zval **key, **data;
+
+	phalcon_fetch_params_ex(2, 0, &key, &data);
+	PHALCON_ENSURE_IS_STRING(key);
+
+	phalcon_update_property_array(this_ptr, SL("_pending"), *key, *data TSRMLS_CC);
+}
+
+/**
+ * Reads meta-data for certain model using a MODEL_* constant, unserializing only the requested index
+ *
+ * @param Phalcon\Mvc\ModelInterface $model
+ * @param int $index
+ * @return array
+ */
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, readMetaDataIndex){
+
+	zval **model, **index, *table = NULL, *schema = NULL, *class_name;
+	zval *key, *meta_data, *indexes, *index_key, *data;
+	phalcon_mvc_model_metadata_mmap_object *obj;
+	smart_str buf = { NULL, 0, 0 };
+	const char *value;
+	zend_uint value_len;
+
+	phalcon_fetch_params_ex(2, 0, &model, &index);
+
+	PHALCON_VERIFY_INTERFACE_EX(*model, phalcon_mvc_modelinterface_ce, phalcon_mvc_model_exception_ce, 0);
+	PHALCON_ENSURE_IS_LONG(index);
+
+	PHALCON_MM_GROW();
+
+	obj = phalcon_mvc_model_metadata_mmap_get_object(getThis() TSRMLS_CC);
+	meta_data = phalcon_fetch_nproperty_this(this_ptr, SL("_metaData"), PH_NOISY TSRMLS_CC);
+
+	if (obj->segment) {
+		PHALCON_CALL_METHOD(&table, *model, "getsource");
+		PHALCON_CALL_METHOD(&schema, *model, "getschema");
+
+		PHALCON_INIT_VAR(class_name);
+		phalcon_get_class(class_name, *model, 1 TSRMLS_CC);
+
+		/**
+		 * Same key used by Phalcon\Mvc\Model\MetaData::readMetaDataIndex()
+		 */
+		PHALCON_INIT_VAR(key);
+		PHALCON_CONCAT_VSVV(key, class_name, "-", schema, table);
+
+		if (!phalcon_array_isset(meta_data, key)) {
+			smart_str_appendl(&buf, "meta-", 5);
+			smart_str_appendl(&buf, Z_STRVAL_P(key), Z_STRLEN_P(key));
+			phalcon_mvc_model_metadata_mmap_index_key(&buf, "", 0, Z_LVAL_PP(index));
+
+			PHALCON_INIT_VAR(index_key);
+			ZVAL_STRINGL(index_key, buf.c, buf.len, 0);
+
+			indexes = phalcon_fetch_nproperty_this(this_ptr, SL("_indexes"), PH_NOISY TSRMLS_CC);
+			if (phalcon_array_isset_fetch(&data, indexes, index_key)) {
+				RETURN_CTOR(data);
+			}
+
+			if (phalcon_mvc_model_metadata_mmap_find(obj, Z_STRVAL_P(index_key), Z_STRLEN_P(index_key), &value, &value_len)) {
+				PHALCON_INIT_VAR(data);
+				if (phalcon_mvc_model_metadata_mmap_unserialize(data, value, value_len TSRMLS_CC) == SUCCESS) {
+					phalcon_update_property_array(this_ptr, SL("_indexes"), index_key, data TSRMLS_CC);
+					RETURN_CTOR(data);
+				}
+			}
+		}
+	}
+
+	PHALCON_RETURN_CALL_PARENT(phalcon_mvc_model_metadata_mmap_ce, this_ptr, "readmetadataindex", *model, *index);
+	RETURN_MM();
+}
+
+/**
+ * Writes the collected meta-data, merging it with the latest version of the segment
+ *
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, flush){
+
+	zval *pending, *meta_data_file, *entries, *path, *tmp_path, *status = NULL, *params[2];
+	zval **data;
+	phalcon_mvc_model_metadata_mmap_object *obj;
+	HashTable *ht;
+	HashPosition hp;
+	php_stream *stream, *lock;
+	char *segment, *tmp;
+	size_t size;
+	zend_uint i;
+	int renamed;
+
+	pending = phalcon_fetch_nproperty_this(this_ptr, SL("_pending"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(pending) != IS_ARRAY || !zend_hash_num_elements(Z_ARRVAL_P(pending))) {
+		RETURN_FALSE;
+	}
+
+	PHALCON_MM_GROW();
+
+	meta_data_file = phalcon_fetch_nproperty_this(this_ptr, SL("_metaDataFile"), PH_NOISY TSRMLS_CC);
+
+	PHALCON_INIT_VAR(path);
+	ZVAL_ZVAL(path, meta_data_file, 1, 0);
+	convert_to_string(path);
+
+	/**
+	 * The lock is held from the merge until the new segment replaces the current one
+	 */
+	lock = phalcon_mvc_model_metadata_mmap_lock(Z_STRVAL_P(path) TSRMLS_CC);
+	if (!lock) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Meta-Data file cannot be locked");
+		return;
+	}
+
+	/**
+	 * Other processes could have written the segment after it was mapped
+	 */
+	obj = phalcon_mvc_model_metadata_mmap_get_object(getThis() TSRMLS_CC);
+	phalcon_mvc_model_metadata_mmap_open(obj, Z_STRVAL_P(path) TSRMLS_CC);
+
+	PHALCON_INIT_VAR(entries);
+	array_init(entries);
+
+	/**
+	 * Keep the current entries unless they are replaced
+	 */
+	for (i = 0; obj->segment && i < obj->buckets; ++i) {
+		zend_uint offset = phalcon_mmap_read_uint(obj->segment + PHALCON_MMAP_HEADER_SIZE + i * sizeof(zend_uint));
+		zend_uint hash, key_len, value_len;
+		const char *key, *value, *end;
+		char *base, *full_key;
+
+		if (!offset || !phalcon_mvc_model_metadata_mmap_entry(obj, offset, &hash, &key, &key_len, &value, &value_len)) {
+			continue;
+		}
+
+		end  = memchr(key, '\0', key_len);
+		base = estrndup(key, end ? (uint)(end - key) : key_len);
+		if (zend_symtable_exists(Z_ARRVAL_P(pending), base, strlen(base) + 1)) {
+			efree(base);
+			continue;
+		}
+
+		efree(base);
+
+		full_key = estrndup(key, key_len);
+		add_assoc_stringl_ex(entries, full_key, key_len + 1, (char*)value, value_len, 1);
+		efree(full_key);
+	}
+
+	ht = Z_ARRVAL_P(pending);
+	for (
+		zend_hash_internal_pointer_reset_ex(ht, &hp);
+		zend_hash_get_current_data_ex(ht, (void**)&data, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(ht, &hp)
+	) {
+		zval key = phalcon_get_current_key_w(ht, &hp);
+
+		if (Z_TYPE(key) == IS_STRING) {
+			phalcon_mvc_model_metadata_mmap_add(entries, Z_STRVAL(key), Z_STRLEN(key), *data TSRMLS_CC);
+		}
+	}
+
+	segment = phalcon_mvc_model_metadata_mmap_build(entries, obj->version + 1, &size);
+
+	/**
+	 * Write a new file and replace the current one, readers keep the segment they mapped
+	 */
+	spprintf(&tmp, 0, "%s.%lx%lx", Z_STRVAL_P(path), (unsigned long)getpid(), (unsigned long)(php_combined_lcg(TSRMLS_C) * 0xFFFFFF));
+
+	PHALCON_INIT_VAR(tmp_path);
+	ZVAL_STRING(tmp_path, tmp, 0);
+
+	stream = php_stream_open_wrapper(tmp, "wb", REPORT_ERRORS, NULL);
+	if (!stream) {
+		efree(segment);
+		phalcon_mvc_model_metadata_mmap_unlock(lock TSRMLS_CC);
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Meta-Data file cannot be written");
+		return;
+	}
+
+	if (php_stream_write(stream, segment, size) != size) {
+		php_stream_close(stream);
+		efree(segment);
+		{
+			zval dummy;
+			phalcon_unlink(&dummy, tmp_path TSRMLS_CC);
+		}
+		phalcon_mvc_model_metadata_mmap_unlock(lock TSRMLS_CC);
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Meta-Data file cannot be written");
+		return;
+	}
+
+	php_stream_close(stream);
+	efree(segment);
+
+	params[0] = tmp_path;
+	params[1] = path;
+
+	PHALCON_OBSERVE_OR_NULLIFY_VAR(status);
+	renamed = phalcon_call_func_aparams(&status, SL("rename"), 2, params TSRMLS_CC);
+	phalcon_mvc_model_metadata_mmap_unlock(lock TSRMLS_CC);
+	if (renamed == FAILURE) {
+		RETURN_MM();
+	}
+
+	if (!zend_is_true(status)) {
+		zval dummy;
+		phalcon_unlink(&dummy, tmp_path TSRMLS_CC);
+		RETURN_MM_FALSE;
+	}
+
+	phalcon_update_property_null(this_ptr, SL("_pending") TSRMLS_CC);
+	phalcon_mvc_model_metadata_mmap_open(obj, Z_STRVAL_P(path) TSRMLS_CC);
+
+	RETURN_MM_TRUE;
+}
+
+/**
+ * Returns the version of the mapped segment, 0 if there is no segment
+ *
+ * @return int
+ */
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, getVersion){
+
+	phalcon_mvc_model_metadata_mmap_object *obj = phalcon_mvc_model_metadata_mmap_get_object(getThis() TSRMLS_CC);
+
+	RETURN_LONG(obj->version);
+}
+
+/**
+ * Removes the segment and resets the internal meta-data
+ */
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, reset){
+
+	zval *meta_data_file;
+	phalcon_mvc_model_metadata_mmap_object *obj;
+
+	PHALCON_MM_GROW();
+
+	obj = phalcon_mvc_model_metadata_mmap_get_object(getThis() TSRMLS_CC);
+	phalcon_mvc_model_metadata_mmap_close(obj TSRMLS_CC);
+
+	meta_data_file = phalcon_fetch_nproperty_this(this_ptr, SL("_metaDataFile"), PH_NOISY TSRMLS_CC);
+	if (phalcon_file_exists(meta_data_file TSRMLS_CC) == SUCCESS) {
+		zval dummy;
+		phalcon_unlink(&dummy, meta_data_file TSRMLS_CC);
+	}
+
+	phalcon_update_property_null(this_ptr, SL("_pending") TSRMLS_CC);
+	phalcon_update_property_null(this_ptr, SL("_indexes") TSRMLS_CC);
+
+	PHALCON_CALL_PARENT(NULL, phalcon_mvc_model_metadata_mmap_ce, this_ptr, "reset");
+
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Writes the meta-data collected during the request
+ */
+PHP_METHOD(Phalcon_Mvc_Model_MetaData_Mmap, __destruct){
+
+	/**
+	 * Failing to write the segment only means the meta-data is introspected again
+	 */
+	if (phalcon_call_method(NULL, this_ptr, "flush", 0, NULL TSRMLS_CC) == FAILURE && EG(exception)) {
+		zend_clear_exception(TSRMLS_C);
+	}
+}
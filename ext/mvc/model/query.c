@@ -27,6 +27,7 @@
 #include "mvc/model/resultset/simple.h"
 #include "mvc/model/exception.h"
 #include "mvc/model/managerinterface.h"
+#include "mvc/model/manager.h"
 #include "mvc/model/metadatainterface.h"
 #include "mvc/model/row.h"
 #include "cache/backendinterface.h"
@@ -35,6 +36,9 @@
 #include "di/injectionawareinterface.h"
 #include "db/rawvalue.h"
 
+#include <ext/pdo/php_pdo_driver.h>
+#include <ext/standard/php_smart_str.h>
+
 #include "kernel/main.h"
 #include "kernel/memory.h"
 #include "kernel/object.h"
@@ -108,6 +112,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeUpdate);
 PHP_METHOD(Phalcon_Mvc_Model_Query, _executeDelete);
 PHP_METHOD(Phalcon_Mvc_Model_Query, execute);
 PHP_METHOD(Phalcon_Mvc_Model_Query, getSingleResult);
+PHP_METHOD(Phalcon_Mvc_Model_Query, getScalarResult);
 PHP_METHOD(Phalcon_Mvc_Model_Query, setType);
 PHP_METHOD(Phalcon_Mvc_Model_Query, getType);
 PHP_METHOD(Phalcon_Mvc_Model_Query, setBindParams);
@@ -116,6 +121,8 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, setBindTypes);
 PHP_METHOD(Phalcon_Mvc_Model_Query, getBindTypes);
 PHP_METHOD(Phalcon_Mvc_Model_Query, setIntermediate);
 PHP_METHOD(Phalcon_Mvc_Model_Query, getIntermediate);
+PHP_METHOD(Phalcon_Mvc_Model_Query, with);
+PHP_METHOD(Phalcon_Mvc_Model_Query, getWith);
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_query___construct, 0, 0, 1)
 	ZEND_ARG_INFO(0, phql)
@@ -150,6 +157,10 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_query_setintermediate, 0, 0, 1)
 	ZEND_ARG_INFO(0, intermediate)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_query_with, 0, 0, 1)
+	ZEND_ARG_INFO(0, relations)
+ZEND_END_ARG_INFO()
+
 static const zend_function_entry phalcon_mvc_model_query_method_entry[] = {
 	PHP_ME(Phalcon_Mvc_Model_Query, __construct, arginfo_phalcon_mvc_model_query___construct, ZEND_ACC_PUBLIC|ZEND_ACC_CTOR)
 	PHP_ME(Phalcon_Mvc_Model_Query, setDI, arginfo_phalcon_di_injectionawareinterface_setdi, ZEND_ACC_PUBLIC)
@@ -185,6 +196,7 @@ static const zend_function_entry phalcon_mvc_model_query_method_entry[] = {
 	PHP_ME(Phalcon_Mvc_Model_Query, _executeDelete, NULL, ZEND_ACC_PROTECTED)
 	PHP_ME(Phalcon_Mvc_Model_Query, execute, arginfo_phalcon_mvc_model_queryinterface_execute, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Query, getSingleResult, arginfo_phalcon_mvc_model_query_getsingleresult, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Query, getScalarResult, arginfo_phalcon_mvc_model_query_getsingleresult, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Query, setType, arginfo_phalcon_mvc_model_query_settype, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Query, getType, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Query, setBindParams, arginfo_phalcon_mvc_model_query_setbindparams, ZEND_ACC_PUBLIC)
@@ -193,6 +205,8 @@ static const zend_function_entry phalcon_mvc_model_query_method_entry[] = {
 	PHP_ME(Phalcon_Mvc_Model_Query, getBindTypes, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Query, setIntermediate, arginfo_phalcon_mvc_model_query_setintermediate, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Query, getIntermediate, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Query, with, arginfo_phalcon_mvc_model_query_with, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Query, getWith, NULL, ZEND_ACC_PUBLIC)
 	PHP_FE_END
 };
 
@@ -222,7 +236,9 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Query){
 	zend_declare_property_null(phalcon_mvc_model_query_ce, SL("_uniqueRow"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_query_ce, SL("_bindParams"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_query_ce, SL("_bindTypes"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_query_ce, SL("_with"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_query_ce, SL("_irPhqlCache"), ZEND_ACC_STATIC|ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_query_ce, SL("_scalarSqlCache"), ZEND_ACC_STATIC|ZEND_ACC_PROTECTED TSRMLS_CC);
 
 	zend_declare_class_constant_long(phalcon_mvc_model_query_ce, SL("TYPE_SELECT"), 309 TSRMLS_CC);
 	zend_declare_class_constant_long(phalcon_mvc_model_query_ce, SL("TYPE_INSERT"), 306 TSRMLS_CC);
@@ -234,6 +250,43 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Query){
 	return SUCCESS;
 }
 
+/**
+ * Converts the numeric placeholders in the bind parameters or types to the names used in the SQL
+ */
+static void phalcon_mvc_model_query_process_placeholders(zval *return_value, zval *bind TSRMLS_DC)
+{
+	HashTable *ah;
+	HashPosition hp;
+	zval **value;
+	char *wildcard;
+	int wildcard_length;
+
+	if (Z_TYPE_P(bind) != IS_ARRAY) {
+		ZVAL_ZVAL(return_value, bind, 1, 0);
+		return;
+	}
+
+	ah = Z_ARRVAL_P(bind);
+	array_init_size(return_value, zend_hash_num_elements(ah));
+
+	for (
+		zend_hash_internal_pointer_reset_ex(ah, &hp);
+		zend_hash_get_current_data_ex(ah, (void**)&value, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(ah, &hp)
+	) {
+		zval key = phalcon_get_current_key_w(ah, &hp);
+
+		Z_ADDREF_PP(value);
+		if (Z_TYPE(key) == IS_LONG) {
+			wildcard_length = spprintf(&wildcard, 0, ":%ld", Z_LVAL(key));
+			zend_hash_update(Z_ARRVAL_P(return_value), wildcard, wildcard_length + 1, value, sizeof(zval*), NULL);
+			efree(wildcard);
+		} else {
+			zend_symtable_update(Z_ARRVAL_P(return_value), Z_STRVAL(key), Z_STRLEN(key) + 1, value, sizeof(zval*), NULL);
+		}
+	}
+}
+
 /**
  * Phalcon\Mvc\Model\Query constructor
  *
@@ -3484,6 +3537,35 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, parse){
 	RETURN_CTOR(ir_phql);
 }
 
+/**
+ * Prepares a SELECT statement from an AST that was not produced by the PHQL parser,
+ * Phalcon\Mvc\Model\Query\Builder hands its statements to the query this way
+ */
+int phalcon_mvc_model_query_prepare_select(zval *query, zval *ast TSRMLS_DC)
+{
+	zval *ir_phql = NULL;
+	int status;
+
+	phalcon_update_property_this(query, SL("_ast"), ast TSRMLS_CC);
+	phalcon_update_property_long(query, SL("_type"), PHQL_T_SELECT TSRMLS_CC);
+
+	status = phalcon_call_method(&ir_phql, query, "_prepareselect", 0, NULL TSRMLS_CC);
+	if (status == FAILURE || EG(exception)) {
+		status = FAILURE;
+	} else if (ir_phql && Z_TYPE_P(ir_phql) == IS_ARRAY) {
+		phalcon_update_property_this(query, SL("_intermediate"), ir_phql TSRMLS_CC);
+	} else {
+		PHALCON_THROW_EXCEPTION_STRW(phalcon_mvc_model_exception_ce, "Corrupted AST");
+		status = FAILURE;
+	}
+
+	if (ir_phql) {
+		zval_ptr_dtor(&ir_phql);
+	}
+
+	return status;
+}
+
 /**
  * Sets the cache parameters of the query
  *
@@ -3522,6 +3604,230 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, getCache){
 	RETURN_MEMBER(this_ptr, "_cache");
 }
 
+/**
+ * Looks for "shardKey = value" in the conditions joined by AND of a WHERE clause, the value
+ * can be a numeric literal or a bound parameter
+ */
+int phalcon_mvc_model_query_find_shard_value(zval **value, zval *expr, zval *shard_key, zval *bind_params TSRMLS_DC)
+{
+	zval *type, *op, *left, *right, *column, *operand, *name, *operand_type, *operand_value;
+	zval **param;
+	int i;
+
+	if (Z_TYPE_P(expr) != IS_ARRAY || Z_TYPE_P(shard_key) != IS_STRING) {
+		return FAILURE;
+	}
+
+	if (!phalcon_array_isset_string_fetch(&type, expr, SS("type")) || !PHALCON_IS_STRING(type, "binary-op")) {
+		return FAILURE;
+	}
+
+	if (!phalcon_array_isset_string_fetch(&op, expr, SS("op")) || !phalcon_array_isset_string_fetch(&left, expr, SS("left")) || !phalcon_array_isset_string_fetch(&right, expr, SS("right"))) {
+		return FAILURE;
+	}
+
+	if (PHALCON_IS_STRING(op, "AND")) {
+		if (phalcon_mvc_model_query_find_shard_value(value, left, shard_key, bind_params TSRMLS_CC) == SUCCESS) {
+			return SUCCESS;
+		}
+
+		return phalcon_mvc_model_query_find_shard_value(value, right, shard_key, bind_params TSRMLS_CC);
+	}
+
+	if (!PHALCON_IS_STRING(op, "=")) {
+		return FAILURE;
+	}
+
+	for (i = 0; i < 2; i++) {
+		column  = i ? right : left;
+		operand = i ? left : right;
+
+		if (Z_TYPE_P(column) != IS_ARRAY || !phalcon_array_isset_string_fetch(&type, column, SS("type")) || !PHALCON_IS_STRING(type, "qualified")) {
+			continue;
+		}
+
+		if (!phalcon_array_isset_string_fetch(&name, column, SS("balias")) && !phalcon_array_isset_string_fetch(&name, column, SS("name"))) {
+			continue;
+		}
+
+		if (Z_TYPE_P(name) != IS_STRING || Z_STRLEN_P(name) != Z_STRLEN_P(shard_key) || memcmp(Z_STRVAL_P(name), Z_STRVAL_P(shard_key), Z_STRLEN_P(name))) {
+			continue;
+		}
+
+		if (Z_TYPE_P(operand) != IS_ARRAY || !phalcon_array_isset_string_fetch(&operand_type, operand, SS("type")) || !phalcon_array_isset_string_fetch(&operand_value, operand, SS("value")) || Z_TYPE_P(operand_value) != IS_STRING) {
+			continue;
+		}
+
+		if (PHALCON_IS_STRING(operand_type, "literal")) {
+			if (is_numeric_string(Z_STRVAL_P(operand_value), Z_STRLEN_P(operand_value), NULL, NULL, 0)) {
+				*value = operand_value;
+				return SUCCESS;
+			}
+		} else if (PHALCON_IS_STRING(operand_type, "placeholder") && Z_TYPE_P(bind_params) == IS_ARRAY && Z_STRLEN_P(operand_value) > 1) {
+			/* Placeholders are ":0" or ":name", their parameters are 0 or "name" */
+			if (zend_symtable_find(Z_ARRVAL_P(bind_params), Z_STRVAL_P(operand_value) + 1, Z_STRLEN_P(operand_value), (void**) &param) == SUCCESS) {
+				*value = *param;
+				return SUCCESS;
+			}
+		}
+	}
+
+	return FAILURE;
+}
+
+/**
+ * Returns the value of the number or the offset of a LIMIT clause, -1 if it can't be known
+ */
+static long phalcon_mvc_model_query_limit_value(zval *expr, zval *bind_params TSRMLS_DC)
+{
+	zval *type, *value;
+	zval **param;
+
+	if (Z_TYPE_P(expr) != IS_ARRAY || !phalcon_array_isset_string_fetch(&type, expr, SS("type")) || !phalcon_array_isset_string_fetch(&value, expr, SS("value")) || Z_TYPE_P(value) != IS_STRING) {
+		return -1;
+	}
+
+	if (PHALCON_IS_STRING(type, "placeholder")) {
+		if (Z_TYPE_P(bind_params) != IS_ARRAY || Z_STRLEN_P(value) < 2 || zend_symtable_find(Z_ARRVAL_P(bind_params), Z_STRVAL_P(value) + 1, Z_STRLEN_P(value), (void**) &param) != SUCCESS) {
+			return -1;
+		}
+
+		return phalcon_get_intval(*param);
+	}
+
+	return phalcon_get_intval(value);
+}
+
+/**
+ * Merges the rows returned by every shard, each list is already sorted by the ORDER BY clause,
+ * skipping the first $offset rows and returning $number rows at most ($number < 0 means all)
+ */
+static int phalcon_mvc_model_query_merge_shards(zval *return_value, zval *shard_rows, zval *order, long offset, long number TSRMLS_DC)
+{
+	HashTable **tables;
+	HashPosition *positions, hp;
+	zval **names = NULL, **item, **expr, **sort, *type;
+	zval **row, **best_row = NULL, **a, **b, *null_value, result;
+	int *descending = NULL;
+	uint num_shards, num_order = 0, s, i;
+	long taken = 0, cmp;
+	int best;
+
+	array_init(return_value);
+
+	num_shards = zend_hash_num_elements(Z_ARRVAL_P(shard_rows));
+	if (!num_shards) {
+		return SUCCESS;
+	}
+
+	/**
+	 * Only plain columns can be compared in memory
+	 */
+	if (order && Z_TYPE_P(order) == IS_ARRAY && zend_hash_num_elements(Z_ARRVAL_P(order))) {
+
+		num_order  = zend_hash_num_elements(Z_ARRVAL_P(order));
+		names      = safe_emalloc(num_order, sizeof(zval*), 0);
+		descending = safe_emalloc(num_order, sizeof(int), 0);
+
+		for (
+			i = 0, zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(order), &hp);
+			zend_hash_get_current_data_ex(Z_ARRVAL_P(order), (void**) &item, &hp) == SUCCESS;
+			i++, zend_hash_move_forward_ex(Z_ARRVAL_P(order), &hp)
+		) {
+			if (Z_TYPE_PP(item) != IS_ARRAY
+				|| zend_hash_index_find(Z_ARRVAL_PP(item), 0, (void**) &expr) != SUCCESS
+				|| Z_TYPE_PP(expr) != IS_ARRAY
+				|| !phalcon_array_isset_string_fetch(&type, *expr, SS("type"))
+				|| !PHALCON_IS_STRING(type, "qualified")
+				|| !phalcon_array_isset_string_fetch(&names[i], *expr, SS("name"))
+				|| Z_TYPE_P(names[i]) != IS_STRING
+			) {
+				efree(names);
+				efree(descending);
+				zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "Only columns can be used to order rows coming from several shards");
+				return FAILURE;
+			}
+
+			descending[i] = zend_hash_index_find(Z_ARRVAL_PP(item), 1, (void**) &sort) == SUCCESS && PHALCON_IS_STRING(*sort, "DESC");
+		}
+	}
+
+	tables    = safe_emalloc(num_shards, sizeof(HashTable*), 0);
+	positions = safe_emalloc(num_shards, sizeof(HashPosition), 0);
+
+	for (
+		s = 0, zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(shard_rows), &hp);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(shard_rows), (void**) &row, &hp) == SUCCESS;
+		s++, zend_hash_move_forward_ex(Z_ARRVAL_P(shard_rows), &hp)
+	) {
+		tables[s] = Z_ARRVAL_PP(row);
+		zend_hash_internal_pointer_reset_ex(tables[s], &positions[s]);
+	}
+
+	null_value = PHALCON_GLOBAL(z_null);
+
+	while (number < 0 || taken < offset + number) {
+
+		/**
+		 * Take the smallest row at the head of the shards, ties go to the first shard
+		 */
+		best = -1;
+		for (s = 0; s < num_shards; s++) {
+
+			if (zend_hash_get_current_data_ex(tables[s], (void**) &row, &positions[s]) != SUCCESS) {
+				continue;
+			}
+
+			if (best < 0) {
+				best = s;
+				best_row = row;
+				continue;
+			}
+
+			cmp = 0;
+			for (i = 0; i < num_order && !cmp; i++) {
+
+				if (Z_TYPE_PP(row) != IS_ARRAY || zend_hash_find(Z_ARRVAL_PP(row), Z_STRVAL_P(names[i]), Z_STRLEN_P(names[i]) + 1, (void**) &a) != SUCCESS) {
+					a = &null_value;
+				}
+
+				if (Z_TYPE_PP(best_row) != IS_ARRAY || zend_hash_find(Z_ARRVAL_PP(best_row), Z_STRVAL_P(names[i]), Z_STRLEN_P(names[i]) + 1, (void**) &b) != SUCCESS) {
+					b = &null_value;
+				}
+
+				compare_function(&result, *a, *b TSRMLS_CC);
+				cmp = descending[i] ? -Z_LVAL(result) : Z_LVAL(result);
+			}
+
+			if (cmp < 0) {
+				best = s;
+				best_row = row;
+			}
+		}
+
+		if (best < 0) {
+			break;
+		}
+
+		if (taken >= offset) {
+			Z_ADDREF_PP(best_row);
+			add_next_index_zval(return_value, *best_row);
+		}
+
+		++taken;
+		zend_hash_move_forward_ex(tables[best], &positions[best]);
+	}
+
+	efree(tables);
+	efree(positions);
+	if (names) {
+		efree(names);
+		efree(descending);
+	}
+
+	return SUCCESS;
+}
+
 /**
  * Executes the SELECT intermediate representation producing a Phalcon\Mvc\Model\Resultset
  *
@@ -3540,16 +3846,18 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeSelect){
 	zval *simple_column_map = NULL, *meta_data, *z_null;
 	zval *alias_copy = NULL, *sql_column = NULL, *instance = NULL, *attributes = NULL;
 	zval *column_map = NULL, *attribute = NULL, *hidden_alias = NULL;
-	zval *column_alias = NULL, *is_keeping_snapshots = NULL;
-	zval *sql_alias = NULL, *dialect = NULL, *sql_select = NULL, *processed = NULL;
-	zval *value = NULL, *wildcard = NULL, *string_wildcard = NULL, *processed_types = NULL;
-	zval *type_wildcard = NULL, *result = NULL, *count = NULL, *result_data = NULL;
+	zval *column_alias = NULL, *is_keeping_snapshots = NULL, *is_read_only = NULL;
+	zval *sql_alias = NULL, *dialect = NULL, *sql_select = NULL, *processed;
+	zval *processed_types, *result = NULL, *result_data = NULL;
 	zval *cache, *result_object = NULL;
-	HashTable *ah0, *ah1, *ah2, *ah3, *ah4, *ah5, *ah6;
-	HashPosition hp0, hp1, hp2, hp3, hp4, hp5, hp6;
+	zval *shards = NULL, *shard_key = NULL, *shard_value, *shard_service = NULL, *shard_rows = NULL;
+	zval *dependency_injector, *where, *limit, *limit_expr, *number_expr, *shard_limit, *order, *fetch_assoc, *rows = NULL;
+	HashTable *ah0, *ah1, *ah2, *ah3, *ah4;
+	HashPosition hp0, hp1, hp2, hp3, hp4;
 	zval **hd;
-	int have_scalars = 0, have_objects = 0, is_complex = 0, is_simple_std = 0;
+	int have_scalars = 0, have_objects = 0, is_complex = 0, is_simple_std = 0, scatter = 0;
 	size_t number_objects = 0;
+	long number = -1, offset = 0;
 
 	PHALCON_MM_GROW();
 
@@ -3603,10 +3911,30 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeSelect){
 				return;
 			}
 		} else {
+			/** 
+			 * Sharded models are read from the shard fixed by the WHERE clause, or from
+			 * every shard if the clause doesn't fix the shard key
+			 */
+			PHALCON_CALL_METHOD(&shards, manager, "getshards", model);
+			if (Z_TYPE_P(shards) == IS_ARRAY) {
+				PHALCON_CALL_METHOD(&shard_key, manager, "getshardkey", model);
+	
+				if (phalcon_array_isset_string_fetch(&where, intermediate, SS("where")) && phalcon_mvc_model_query_find_shard_value(&shard_value, where, shard_key, bind_params TSRMLS_CC) == SUCCESS) {
+					PHALCON_CALL_METHOD(&shard_service, manager, "getshardservice", model, shard_value);
+	
+					dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
+					PHALCON_CALL_METHOD(&connection, dependency_injector, "getshared", shard_service);
+				} else {
+					scatter = 1;
+				}
+			}
+	
 			/** 
 			 * Get the current connection to the model
 			 */
-			PHALCON_CALL_METHOD(&connection, model, "getreadconnection");
+			if (!connection) {
+				PHALCON_CALL_METHOD(&connection, model, "getreadconnection");
+			}
 		}
 	} else {
 		/** 
@@ -3705,6 +4033,14 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeSelect){
 		}
 	}
 	
+	/** 
+	 * Rows coming from several shards can only be merged if they are complete records
+	 */
+	if (scatter && (is_complex || is_simple_std || phalcon_array_isset_string(intermediate, SS("group")))) {
+		zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "The shard key '%s' is required to query the sharded model '%s' this way", Z_STRVAL_P(shard_key), Z_OBJCE_P(model)->name);
+		RETURN_MM();
+	}
+	
 	/** 
 	 * Processing selected columns
 	 */
@@ -3857,6 +4193,36 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeSelect){
 	
 	phalcon_array_update_string(&intermediate, SL("columns"), select_columns, PH_COPY | PH_SEPARATE);
 	
+	/** 
+	 * Every shard returns up to offset + number rows, the offset is applied after merging them
+	 */
+	if (scatter && phalcon_array_isset_string_fetch(&limit, intermediate, SS("limit"))) {
+		if (phalcon_array_isset_string_fetch(&limit_expr, limit, SS("number"))) {
+			number = phalcon_mvc_model_query_limit_value(limit_expr, bind_params TSRMLS_CC);
+		}
+	
+		if (phalcon_array_isset_string_fetch(&limit_expr, limit, SS("offset"))) {
+			offset = phalcon_mvc_model_query_limit_value(limit_expr, bind_params TSRMLS_CC);
+			if (offset < 0) {
+				offset = 0;
+			}
+		}
+	
+		if (number >= 0) {
+			PHALCON_INIT_VAR(number_expr);
+			array_init_size(number_expr, 2);
+			add_assoc_stringl_ex(number_expr, ISS(type), SL("literal"), 1);
+			add_assoc_long_ex(number_expr, ISS(value), offset + number);
+	
+			PHALCON_INIT_VAR(shard_limit);
+			array_init_size(shard_limit, 1);
+			phalcon_array_update_string(&shard_limit, ISL(number), number_expr, PH_COPY);
+			phalcon_array_update_string(&intermediate, SL("limit"), shard_limit, PH_COPY | PH_SEPARATE);
+		} else {
+			phalcon_array_unset_string(&intermediate, SS("limit"), PH_SEPARATE);
+		}
+	}
+	
 	/** 
 	 * The corresponding SQL dialect generates the SQL statement based accordingly with
 	 * the database system
@@ -3865,79 +4231,59 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeSelect){
 	PHALCON_CALL_METHOD(&sql_select, dialect, "select", intermediate);
 
 	/** 
-	 * Replace the placeholders
+	 * Replace the placeholders and the bind types
 	 */
-	if (Z_TYPE_P(bind_params) == IS_ARRAY) { 
-	
-		PHALCON_INIT_VAR(processed);
-		array_init(processed);
-	
-		phalcon_is_iterable(bind_params, &ah5, &hp5, 0, 0);
-	
-		while (zend_hash_get_current_data_ex(ah5, (void**) &hd, &hp5) == SUCCESS) {
-	
-			PHALCON_GET_HKEY(wildcard, ah5, hp5);
-			PHALCON_GET_HVALUE(value);
-	
-			if (Z_TYPE_P(wildcard) == IS_LONG) {
-				PHALCON_INIT_NVAR(string_wildcard);
-				PHALCON_CONCAT_SV(string_wildcard, ":", wildcard);
-				phalcon_array_update_zval(&processed, string_wildcard, value, PH_COPY);
-			} else {
-				phalcon_array_update_zval(&processed, wildcard, value, PH_COPY);
-			}
+	PHALCON_INIT_VAR(processed);
+	phalcon_mvc_model_query_process_placeholders(processed, bind_params TSRMLS_CC);
 	
-			zend_hash_move_forward_ex(ah5, &hp5);
-		}
+	PHALCON_INIT_VAR(processed_types);
+	phalcon_mvc_model_query_process_placeholders(processed_types, bind_types TSRMLS_CC);
 	
-	} else {
-		PHALCON_CPY_WRT(processed, bind_params);
-	}
+	if (scatter) {
+		/** 
+		 * Scatter the query across the shards and gather their rows in memory
+		 */
+		dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
 	
-	/** 
-	 * Replace the bind Types
-	 */
-	if (Z_TYPE_P(bind_types) == IS_ARRAY) { 
+		PHALCON_INIT_VAR(fetch_assoc);
+		ZVAL_LONG(fetch_assoc, PDO_FETCH_ASSOC);
 	
-		PHALCON_INIT_VAR(processed_types);
-		array_init(processed_types);
+		PHALCON_INIT_VAR(shard_rows);
+		array_init_size(shard_rows, zend_hash_num_elements(Z_ARRVAL_P(shards)));
 	
-		phalcon_is_iterable(bind_types, &ah6, &hp6, 0, 0);
+		phalcon_is_iterable(shards, &ah0, &hp0, 0, 0);
 	
-		while (zend_hash_get_current_data_ex(ah6, (void**) &hd, &hp6) == SUCCESS) {
+		while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
 	
-			PHALCON_GET_HKEY(type_wildcard, ah6, hp6);
-			PHALCON_GET_HVALUE(value);
+			PHALCON_GET_HVALUE(shard_service);
 	
-			if (Z_TYPE_P(type_wildcard) == IS_LONG) {
-				PHALCON_INIT_NVAR(string_wildcard);
-				PHALCON_CONCAT_SV(string_wildcard, ":", type_wildcard);
-				phalcon_array_update_zval(&processed_types, string_wildcard, value, PH_COPY | PH_SEPARATE);
-			} else {
-				phalcon_array_update_zval(&processed_types, type_wildcard, value, PH_COPY | PH_SEPARATE);
+			PHALCON_CALL_METHOD(&connection, dependency_injector, "getshared", shard_service);
+			PHALCON_CALL_METHOD(&rows, connection, "fetchall", sql_select, fetch_assoc, processed, processed_types);
+			if (Z_TYPE_P(rows) == IS_ARRAY) {
+				phalcon_array_append(&shard_rows, rows, 0);
 			}
 	
-			zend_hash_move_forward_ex(ah6, &hp6);
+			zend_hash_move_forward_ex(ah0, &hp0);
 		}
 	
-	} else {
-		PHALCON_CPY_WRT(processed_types, bind_types);
-	}
+		order = NULL;
+		phalcon_array_isset_string_fetch(&order, intermediate, SS("order"));
 	
-	/** 
-	 * Execute the query
-	 */
-	PHALCON_CALL_METHOD(&result, connection, "query", sql_select, processed, processed_types);
+		PHALCON_INIT_VAR(result_data);
+		if (phalcon_mvc_model_query_merge_shards(result_data, shard_rows, order, offset, number TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+	} else {
+		/** 
+		 * Execute the query
+		 */
+		PHALCON_CALL_METHOD(&result, connection, "query", sql_select, processed, processed_types);
 	
-	/** 
-	 * Check if the query has data
-	 */
-	PHALCON_CALL_METHOD(&count, result, "numrows", result);
-	if (zend_is_true(count)) {
+		/** 
+		 * Empty results are detected by the resultsets while fetching, asking for the
+		 * number of rows here could trigger an extra COUNT(*) query on some drivers
+		 */
 		PHALCON_CPY_WRT(result_data, result);
-	} else {
-		PHALCON_INIT_NVAR(result_data);
-		ZVAL_BOOL(result_data, 0);
 	}
 	
 	/** 
@@ -3974,13 +4320,34 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeSelect){
 			 * Check if the model keeps snapshots
 			 */
 			PHALCON_CALL_METHOD(&is_keeping_snapshots, manager, "iskeepingsnapshots", model);
+	
+			/** 
+			 * Check if the records of the model are hydrated as read-only instances
+			 */
+			PHALCON_CALL_METHOD(&is_read_only, manager, "isusingreadonlyrecords", model);
 		}
 	
 		/** 
 		 * Simple resultsets contains only complete objects
 		 */
 		object_init_ex(return_value, phalcon_mvc_model_resultset_simple_ce);
-		PHALCON_CALL_METHOD(NULL, return_value, "__construct", simple_column_map, result_object, result_data, cache, is_keeping_snapshots);
+		if (scatter) {
+			PHALCON_CALL_METHOD(NULL, return_value, "__construct", simple_column_map, result_object, PHALCON_GLOBAL(z_false), cache, is_keeping_snapshots);
+	
+			/** 
+			 * The merged rows are served from memory
+			 */
+			zend_hash_internal_pointer_reset(Z_ARRVAL_P(result_data));
+			phalcon_update_property_this(return_value, SL("_rows"), result_data TSRMLS_CC);
+			phalcon_update_property_long(return_value, SL("_count"), zend_hash_num_elements(Z_ARRVAL_P(result_data)) TSRMLS_CC);
+			phalcon_update_property_this(return_value, SL("_keepSnapshots"), is_keeping_snapshots TSRMLS_CC);
+		} else {
+			PHALCON_CALL_METHOD(NULL, return_value, "__construct", simple_column_map, result_object, result_data, cache, is_keeping_snapshots);
+		}
+	
+		if (is_read_only && zend_is_true(is_read_only)) {
+			phalcon_update_property_long(return_value, SL("_hydrateMode"), 3 TSRMLS_CC);
+		}
 	
 		RETURN_MM();
 	}
@@ -4326,6 +4693,119 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _getRelatedRecords){
 	PHALCON_MM_RESTORE();
 }
 
+/**
+ * Drops the records of a model from the identity map after a PHQL UPDATE/DELETE
+ */
+static int phalcon_mvc_model_query_clear_identity(zval *this_ptr, zval *model_name TSRMLS_DC) {
+
+	zval *manager, *params[1];
+
+	if (!PHALCON_GLOBAL(orm).identity_map) {
+		return SUCCESS;
+	}
+
+	manager = phalcon_fetch_nproperty_this(this_ptr, SL("_manager"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(manager) != IS_OBJECT || !instanceof_function(Z_OBJCE_P(manager), phalcon_mvc_model_manager_ce TSRMLS_CC)) {
+		return SUCCESS;
+	}
+
+	params[0] = model_name;
+	return phalcon_call_method(NULL, manager, "clearidentitymap", 1, params TSRMLS_CC);
+}
+
+/**
+ * Starts a transaction on a connection unless the statement already started one there, the
+ * connections are kept by object handle so every shard touched is committed once
+ */
+int phalcon_mvc_model_query_begin_connection(zval *connections, zval *connection TSRMLS_DC) {
+
+	if (Z_TYPE_P(connection) != IS_OBJECT) {
+		zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "Invalid injected connection service");
+		return FAILURE;
+	}
+
+	if (zend_hash_index_exists(Z_ARRVAL_P(connections), Z_OBJ_HANDLE_P(connection))) {
+		return SUCCESS;
+	}
+
+	if (phalcon_call_method(NULL, connection, "begin", 0, NULL TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+
+	return phalcon_array_update_long(&connections, Z_OBJ_HANDLE_P(connection), connection, PH_COPY);
+}
+
+/**
+ * Starts a transaction on the write connection of a record, records of sharded models are
+ * written to the shard of their key
+ */
+int phalcon_mvc_model_query_begin_record(zval *connections, zval *record TSRMLS_DC) {
+
+	zval *connection = NULL;
+	int status;
+
+	if (phalcon_call_method(&connection, record, "getwriteconnection", 0, NULL TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+
+	status = phalcon_mvc_model_query_begin_connection(connections, connection TSRMLS_CC);
+	zval_ptr_dtor(&connection);
+
+	return status;
+}
+
+/**
+ * Commits the transactions started by phalcon_mvc_model_query_begin_connection() or rolls them
+ * back. A rollback keeps the exception that aborted the statement, if a commit fails the
+ * connections left are rolled back
+ */
+int phalcon_mvc_model_query_end_connections(zval *connections, int commit TSRMLS_DC) {
+
+	HashPosition hp;
+	zval **connection, *exception;
+	zend_op *opline;
+	int status = SUCCESS;
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(connections), &hp);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(connections), (void**) &connection, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(connections), &hp)
+	) {
+		if (commit) {
+			if (phalcon_call_method(NULL, *connection, "commit", 0, NULL TSRMLS_CC) == FAILURE) {
+				commit = 0;
+				status = FAILURE;
+			}
+
+			continue;
+		}
+
+		exception = EG(exception);
+		opline    = EG(opline_before_exception);
+
+		EG(exception) = NULL;
+		if (phalcon_call_method(NULL, *connection, "rollback", 0, NULL TSRMLS_CC) == SUCCESS && !EG(exception)) {
+			EG(exception) = exception;
+			EG(opline_before_exception) = opline;
+			continue;
+		}
+
+		status = FAILURE;
+		if (exception) {
+			if (EG(exception)) {
+				zend_exception_set_previous(EG(exception), exception TSRMLS_CC);
+			} else {
+				EG(exception) = exception;
+			}
+
+			EG(opline_before_exception) = opline;
+		}
+	}
+
+	zend_hash_clean(Z_ARRVAL_P(connections));
+	return status;
+}
+
 /**
  * Executes the UPDATE intermediate representation producing a Phalcon\Mvc\Model\Query\Status
  *
@@ -4344,8 +4824,8 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeUpdate){
 	zval *null_value, *field = NULL, *number = NULL, *field_name = NULL;
 	zval *value = NULL, *type = NULL, *expr_value = NULL, *update_value = NULL;
 	zval *update_expr = NULL, *wildcard = NULL, *exception_message = NULL;
-	zval *records = NULL, *success = NULL, *record = NULL;
-	zval *r0 = NULL;
+	zval *records = NULL, *success = NULL, *record = NULL, *connections;
+	zval *r0 = NULL, *params[1];
 	HashTable *ah0;
 	HashPosition hp0;
 	zval **hd;
@@ -4508,12 +4988,13 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeUpdate){
 		RETURN_MM();
 	}
 	
-	PHALCON_CALL_METHOD(&connection, model, "getwriteconnection");
-	
 	/** 
-	 * Create a transaction in the write connection
+	 * A transaction is created in the write connection of every record, the records of a
+	 * sharded model are spread across the connections of its shards
 	 */
-	PHALCON_CALL_METHOD(NULL, connection, "begin");
+	PHALCON_INIT_VAR(connections);
+	array_init(connections);
+	
 	PHALCON_CALL_METHOD(NULL, records, "rewind");
 	
 	while (1) {
@@ -4526,17 +5007,29 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeUpdate){
 		/** 
 		 * Get the current record in the iterator
 		 */
-		PHALCON_CALL_METHOD(&record, records, "current");
+		PHALCON_OBSERVE_OR_NULLIFY_PPZV(&record);
+		if (phalcon_call_method(&record, records, "current", 0, NULL TSRMLS_CC) == FAILURE
+			|| phalcon_mvc_model_query_begin_record(connections, record TSRMLS_CC) == FAILURE
+		) {
+			phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC);
+			RETURN_MM();
+		}
 	
 		/** 
 		 * We apply the executed values to every record found
 		 */
-		PHALCON_CALL_METHOD(&success, record, "update", update_values);
+		params[0] = update_values;
+		PHALCON_OBSERVE_OR_NULLIFY_PPZV(&success);
+		if (phalcon_call_method(&success, record, "update", 1, params TSRMLS_CC) == FAILURE) {
+			phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC);
+			RETURN_MM();
+		}
+	
 		if (!zend_is_true(success)) {
 			/** 
-			 * Rollback the transaction on failure
+			 * Rollback the transactions on failure
 			 */
-			PHALCON_CALL_METHOD(NULL, connection, "rollback");
+			RETURN_MM_ON_FAILURE(phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC));
 			object_init_ex(return_value, phalcon_mvc_model_query_status_ce);
 			PHALCON_CALL_METHOD(NULL, return_value, "__construct", success, record);
 	
@@ -4550,9 +5043,13 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeUpdate){
 	}
 	
 	/** 
-	 * Commit transaction on success
+	 * Commit the transactions on success
 	 */
-	PHALCON_CALL_METHOD(NULL, connection, "commit");
+	RETURN_MM_ON_FAILURE(phalcon_mvc_model_query_end_connections(connections, 1 TSRMLS_CC));
+	
+	if (phalcon_mvc_model_query_clear_identity(this_ptr, model_name TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
 	
 	PHALCON_INIT_NVAR(success);
 	ZVAL_TRUE(success);
@@ -4575,7 +5072,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeDelete){
 	zval *intermediate, *bind_params, *bind_types;
 	zval *models, *model_name, *models_instances;
 	zval *model = NULL, *manager, *records = NULL, *success = NULL, *null_value = NULL;
-	zval *connection = NULL, *record = NULL;
+	zval *connection = NULL, *record = NULL, *connections;
 	zval *r0 = NULL;
 
 	PHALCON_MM_GROW();
@@ -4634,14 +5131,19 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeDelete){
 			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "'selectWriteConnection' didn't returned a valid connection");
 			return;
 		}
-	} else {
-		PHALCON_CALL_METHOD(&connection, model, "getwriteconnection");
 	}
 	
 	/** 
-	 * Create a transaction in the write connection
+	 * Create a transaction in the write connection, the records of a sharded model are deleted
+	 * from the shards of their keys so every shard touched gets its own transaction
 	 */
-	PHALCON_CALL_METHOD(NULL, connection, "begin");
+	PHALCON_INIT_VAR(connections);
+	array_init(connections);
+	
+	if (connection) {
+		RETURN_MM_ON_FAILURE(phalcon_mvc_model_query_begin_connection(connections, connection TSRMLS_CC));
+	}
+	
 	PHALCON_CALL_METHOD(NULL, records, "rewind");
 	
 	while (1) {
@@ -4652,17 +5154,28 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeDelete){
 			break;
 		}
 	
-		PHALCON_CALL_METHOD(&record, records, "current");
+		PHALCON_OBSERVE_OR_NULLIFY_PPZV(&record);
+		if (phalcon_call_method(&record, records, "current", 0, NULL TSRMLS_CC) == FAILURE
+			|| phalcon_mvc_model_query_begin_record(connections, record TSRMLS_CC) == FAILURE
+		) {
+			phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC);
+			RETURN_MM();
+		}
 	
 		/** 
 		 * We delete every record found
 		 */
-		PHALCON_CALL_METHOD(&success, record, "delete");
+		PHALCON_OBSERVE_OR_NULLIFY_PPZV(&success);
+		if (phalcon_call_method(&success, record, "delete", 0, NULL TSRMLS_CC) == FAILURE) {
+			phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC);
+			RETURN_MM();
+		}
+	
 		if (!zend_is_true(success)) {
 			/** 
-			 * Rollback the transaction
+			 * Rollback the transactions
 			 */
-			PHALCON_CALL_METHOD(NULL, connection, "rollback");
+			RETURN_MM_ON_FAILURE(phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC));
 			object_init_ex(return_value, phalcon_mvc_model_query_status_ce);
 			PHALCON_CALL_METHOD(NULL, return_value, "__construct", success, record);
 	
@@ -4676,9 +5189,13 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeDelete){
 	}
 	
 	/** 
-	 * Commit the transaction
+	 * Commit the transactions
 	 */
-	PHALCON_CALL_METHOD(NULL, connection, "commit");
+	RETURN_MM_ON_FAILURE(phalcon_mvc_model_query_end_connections(connections, 1 TSRMLS_CC));
+	
+	if (phalcon_mvc_model_query_clear_identity(this_ptr, model_name TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
 	
 	PHALCON_INIT_NVAR(success);
 	ZVAL_TRUE(success);
@@ -4696,21 +5213,114 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, _executeDelete){
 }
 
 /**
- * Executes a parsed PHQL statement
- *
- * @param array $bindParams
- * @param array $bindTypes
- * @return mixed
+ * Appends the version of a table to a cache key
  */
-PHP_METHOD(Phalcon_Mvc_Model_Query, execute){
+static int phalcon_mvc_model_query_append_version(smart_str *key, zval *manager, zval *table TSRMLS_DC) {
+
+	zval *version = NULL, *params[] = { table };
+
+	if (phalcon_call_method(&version, manager, "gettableversion", 1, params TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+
+	if (Z_TYPE_P(version) == IS_STRING) {
+		smart_str_appendc(key, '-');
+		smart_str_appendl(key, Z_STRVAL_P(version), Z_STRLEN_P(version));
+	}
+
+	zval_ptr_dtor(&version);
+	return SUCCESS;
+}
+
+/**
+ * Embeds the versions of the tables read by the statement in a cache key, writes to any of
+ * them produce a different key so stale resultsets are never read again
+ *
+ * @see Phalcon\Mvc\Model\Manager::setVersionsCache()
+ */
+static int phalcon_mvc_model_query_versioned_key(zval *versioned_key, zval *this_ptr, zval *key TSRMLS_DC) {
+
+	zval *manager, *intermediate = NULL, *tables, *joins, *source, **item;
+	smart_str buffer = { NULL, 0, 0 };
+	HashPosition hp;
+	int status = SUCCESS;
+
+	manager = phalcon_fetch_nproperty_this(this_ptr, SL("_manager"), PH_NOISY TSRMLS_CC);
+	if (!phalcon_mvc_model_manager_has_versions(manager TSRMLS_CC)) {
+		ZVAL_ZVAL(versioned_key, key, 1, 0);
+		return SUCCESS;
+	}
+
+	if (phalcon_call_method(&intermediate, this_ptr, "parse", 0, NULL TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+
+	if (Z_TYPE_P(key) == IS_STRING) {
+		smart_str_appendl(&buffer, Z_STRVAL_P(key), Z_STRLEN_P(key));
+	} else {
+		zval copy = *key;
+		zval_copy_ctor(&copy);
+		convert_to_string(&copy);
+		smart_str_appendl(&buffer, Z_STRVAL(copy), Z_STRLEN(copy));
+		zval_dtor(&copy);
+	}
+
+	if (phalcon_array_isset_string_fetch(&tables, intermediate, SS("tables")) && Z_TYPE_P(tables) == IS_ARRAY) {
+		for (
+			zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(tables), &hp);
+			status == SUCCESS && zend_hash_get_current_data_ex(Z_ARRVAL_P(tables), (void**) &item, &hp) == SUCCESS;
+			zend_hash_move_forward_ex(Z_ARRVAL_P(tables), &hp)
+		) {
+			status = phalcon_mvc_model_query_append_version(&buffer, manager, *item TSRMLS_CC);
+		}
+	}
+
+	if (phalcon_array_isset_string_fetch(&joins, intermediate, SS("joins")) && Z_TYPE_P(joins) == IS_ARRAY) {
+		for (
+			zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(joins), &hp);
+			status == SUCCESS && zend_hash_get_current_data_ex(Z_ARRVAL_P(joins), (void**) &item, &hp) == SUCCESS;
+			zend_hash_move_forward_ex(Z_ARRVAL_P(joins), &hp)
+		) {
+			if (phalcon_array_isset_string_fetch(&source, *item, SS("source"))) {
+				status = phalcon_mvc_model_query_append_version(&buffer, manager, source TSRMLS_CC);
+			}
+		}
+	}
+
+	zval_ptr_dtor(&intermediate);
+
+	if (status == FAILURE) {
+		smart_str_free(&buffer);
+		return FAILURE;
+	}
+
+	if (!buffer.c) {
+		ZVAL_EMPTY_STRING(versioned_key);
+		return SUCCESS;
+	}
+
+	smart_str_0(&buffer);
+	ZVAL_STRINGL(versioned_key, buffer.c, buffer.len, 0);
+	return SUCCESS;
+}
+
+/**
+ * Executes a parsed PHQL statement
+ *
+ * @param array $bindParams
+ * @param array $bindTypes
+ * @return mixed
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Query, execute){
 
 	zval *bind_params = NULL, *bind_types = NULL, *unique_row;
 	zval *cache_options, *key = NULL, *lifetime = NULL, *cache_service = NULL;
 	zval *dependency_injector, *cache = NULL, *frontend = NULL, *result = NULL, *is_fresh;
 	zval *prepared_result = NULL, *intermediate = NULL, *default_bind_params;
 	zval *merged_params = NULL, *default_bind_types;
-	zval *merged_types = NULL, *type, *exception_message;
-	int cache_options_is_not_null;
+	zval *merged_types = NULL, *type, *exception_message, *with, *versioned_key, *manager;
+	zval *params[2];
+	int cache_options_is_not_null, status, deferred;
 
 	PHALCON_MM_GROW();
 
@@ -4727,6 +5337,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, execute){
 	PHALCON_OBS_VAR(unique_row);
 	phalcon_read_property_this(&unique_row, this_ptr, SL("_uniqueRow"), PH_NOISY TSRMLS_CC);
 	
+	with                      = phalcon_fetch_nproperty_this(this_ptr, SL("_with"), PH_NOISY TSRMLS_CC);
 	cache_options             = phalcon_fetch_nproperty_this(this_ptr, SL("_cacheOptions"), PH_NOISY TSRMLS_CC);
 	cache_options_is_not_null = (Z_TYPE_P(cache_options) != IS_NULL); /* to keep scan-build happy */
 
@@ -4744,6 +5355,13 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, execute){
 			return;
 		}
 	
+		PHALCON_INIT_VAR(versioned_key);
+		if (phalcon_mvc_model_query_versioned_key(versioned_key, this_ptr, key TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+	
+		key = versioned_key;
+	
 		/** 
 		 * 'modelsCache' is the default name for the models cache service
 		 */
@@ -4779,7 +5397,22 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, execute){
 			}
 		}
 
-		PHALCON_CALL_METHOD(&result, cache, "get", key, lifetime);
+		/** 
+		 * Entries that can't be decoded anymore are a cache miss, the resultset is stored again
+		 */
+		params[0] = key;
+		params[1] = lifetime;
+		PHALCON_OBSERVE_OR_NULLIFY_PPZV(&result);
+		if (phalcon_call_method(&result, cache, "get", 2, params TSRMLS_CC) == FAILURE) {
+			if (!EG(exception) || !instanceof_function(Z_OBJCE_P(EG(exception)), phalcon_mvc_model_exception_ce TSRMLS_CC)) {
+				RETURN_MM();
+			}
+	
+			zend_clear_exception(TSRMLS_C);
+	
+			PHALCON_INIT_NVAR(result);
+		}
+	
 		if (Z_TYPE_P(result) != IS_NULL) {
 			if (Z_TYPE_P(result) != IS_OBJECT) {
 				PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The cache didn't return a valid resultset");
@@ -4790,6 +5423,13 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, execute){
 			ZVAL_BOOL(is_fresh, 0);
 			PHALCON_CALL_METHOD(NULL, result, "setisfresh", is_fresh);
 	
+			/** 
+			 * Eager load the relations of the cached resultset
+			 */
+			if (Z_TYPE_P(with) != IS_NULL && instanceof_function_ex(Z_OBJCE_P(result), phalcon_mvc_model_resultset_simple_ce, 0 TSRMLS_CC)) {
+				PHALCON_CALL_METHOD(NULL, result, "eagerload", with);
+			}
+	
 			/** 
 			 * Check if only the first row must be returned
 			 */
@@ -4857,12 +5497,28 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, execute){
 			break;
 	
 		case PHQL_T_UPDATE:
-			PHALCON_CALL_METHOD(&result, this_ptr, "_executeupdate", intermediate, merged_params, merged_types);
-			break;
+		case PHQL_T_DELETE: {
+			zval *params[] = { intermediate, merged_params, merged_types };
+	
+			/** 
+			 * The versions of the tables are bumped once the statement finishes, not on
+			 * every record written
+			 */
+			manager = phalcon_fetch_nproperty_this(this_ptr, SL("_manager"), PH_NOISY TSRMLS_CC);
+			deferred = phalcon_mvc_model_manager_defer_versions(manager TSRMLS_CC);
+	
+			PHALCON_OBSERVE_OR_NULLIFY_VAR(result);
+			status = phalcon_call_method(&result, this_ptr, PHALCON_IS_LONG(type, PHQL_T_UPDATE) ? "_executeupdate" : "_executedelete", 3, params TSRMLS_CC);
+	
+			/** 
+			 * Inside a transaction the versions are bumped when the transaction ends
+			 */
+			if ((deferred && phalcon_mvc_model_manager_flush_versions(manager TSRMLS_CC) == FAILURE) || status == FAILURE) {
+				RETURN_MM();
+			}
 	
-		case PHQL_T_DELETE:
-			PHALCON_CALL_METHOD(&result, this_ptr, "_executedelete", intermediate, merged_params, merged_types);
 			break;
+		}
 	
 		default:
 			PHALCON_INIT_VAR(exception_message);
@@ -4889,6 +5545,13 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, execute){
 		PHALCON_CALL_METHOD(NULL, cache, "save", key, result, lifetime);
 	}
 	
+	/** 
+	 * Eager load the relations, one query is executed per relation
+	 */
+	if (Z_TYPE_P(with) != IS_NULL && Z_TYPE_P(result) == IS_OBJECT && instanceof_function_ex(Z_OBJCE_P(result), phalcon_mvc_model_resultset_simple_ce, 0 TSRMLS_CC)) {
+		PHALCON_CALL_METHOD(NULL, result, "eagerload", with);
+	}
+	
 	/** 
 	 * Check if only the first row must be returned
 	 */
@@ -4939,6 +5602,416 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, getSingleResult){
 	RETURN_MM();
 }
 
+/**
+ * Returns how the values of the scalar column computed by every shard are combined: '+' for
+ * COUNT and SUM, '<' for MIN, '>' for MAX, 0 if they can't be combined
+ */
+static int phalcon_mvc_model_query_shard_aggregate(zval *intermediate TSRMLS_DC)
+{
+	zval *columns, *column, *expr, *type, *name;
+	HashPosition hp;
+	zval **hd;
+
+	if (phalcon_array_isset_string(intermediate, SS("group")) || phalcon_array_isset_string(intermediate, SS("having"))) {
+		return 0;
+	}
+
+	if (!phalcon_array_isset_string_fetch(&columns, intermediate, SS("columns")) || Z_TYPE_P(columns) != IS_ARRAY || zend_hash_num_elements(Z_ARRVAL_P(columns)) != 1) {
+		return 0;
+	}
+
+	zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(columns), &hp);
+	zend_hash_get_current_data_ex(Z_ARRVAL_P(columns), (void**)&hd, &hp);
+	column = *hd;
+
+	if (!phalcon_array_isset_string_fetch(&expr, column, SS("column")) || Z_TYPE_P(expr) != IS_ARRAY) {
+		return 0;
+	}
+
+	if (!phalcon_array_isset_string_fetch(&type, expr, SS("type")) || !PHALCON_IS_STRING(type, "functionCall") || phalcon_array_isset_string(expr, SS("distinct"))) {
+		return 0;
+	}
+
+	if (!phalcon_array_isset_string_fetch(&name, expr, SS("name")) || Z_TYPE_P(name) != IS_STRING) {
+		return 0;
+	}
+
+	if (!zend_binary_strcasecmp(Z_STRVAL_P(name), Z_STRLEN_P(name), SL("COUNT")) || !zend_binary_strcasecmp(Z_STRVAL_P(name), Z_STRLEN_P(name), SL("SUM"))) {
+		return '+';
+	}
+
+	if (!zend_binary_strcasecmp(Z_STRVAL_P(name), Z_STRLEN_P(name), SL("MIN"))) {
+		return '<';
+	}
+
+	if (!zend_binary_strcasecmp(Z_STRVAL_P(name), Z_STRLEN_P(name), SL("MAX"))) {
+		return '>';
+	}
+
+	return 0;
+}
+
+/**
+ * Combines the value computed by a shard with the values of the previous ones, NULLs (empty
+ * shards for SUM/MIN/MAX) are skipped
+ */
+static void phalcon_mvc_model_query_combine_scalar(zval *value, zval *scalar, int aggregate TSRMLS_DC)
+{
+	zval result;
+
+	if (Z_TYPE_P(scalar) == IS_NULL) {
+		return;
+	}
+
+	if (Z_TYPE_P(value) == IS_NULL) {
+		ZVAL_ZVAL(value, scalar, 1, 0);
+		return;
+	}
+
+	if (aggregate == '+') {
+		add_function(value, value, scalar TSRMLS_CC);
+		return;
+	}
+
+	compare_function(&result, scalar, value TSRMLS_CC);
+	if ((aggregate == '<' && Z_LVAL(result) < 0) || (aggregate == '>' && Z_LVAL(result) > 0)) {
+		zval_dtor(value);
+		ZVAL_ZVAL(value, scalar, 1, 0);
+	}
+}
+
+/**
+ * Executes a SELECT with a single scalar column returning the value in its first row.
+ * No resultset is built and the SQL is generated once per statement and database system
+ *
+ * On sharded models without the shard key in the WHERE clause COUNT, SUM, MIN and MAX are
+ * computed on every shard and combined, any other column requires the shard key
+ *
+ *<code>
+ * $query = $manager->createQuery("SELECT COUNT(*) FROM Robots WHERE type = :type:");
+ * $number = $query->getScalarResult(array('type' => 'mechanical'));
+ *</code>
+ *
+ * @param array $bindParams
+ * @param array $bindTypes
+ * @return mixed
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Query, getScalarResult){
+
+	zval *bind_params = NULL, *bind_types = NULL;
+	zval *cache_options, *key = NULL, *lifetime = NULL, *cache_service = NULL;
+	zval *dependency_injector, *cache = NULL, *frontend = NULL, *value = NULL;
+	zval *manager, *phql, *sql_cache = NULL, *sql_key, *cached = NULL, *cached_sql = NULL;
+	zval *intermediate = NULL, *type, *models, *model_name = NULL, *model = NULL;
+	zval *columns, *column, *column_type, *sql_column, *column_alias, *select_columns;
+	zval *connection = NULL, *connection_type = NULL, *dialect = NULL, *sql_select = NULL;
+	zval *default_bind_params, *merged_params = NULL, *default_bind_types, *merged_types = NULL;
+	zval *processed, *processed_types, *fetch_num, *row = NULL, *scalar = NULL, *versioned_key;
+	zval *shards = NULL, *shard_key = NULL, *shard_value, *shard_service = NULL, *where;
+	HashTable *ah0;
+	HashPosition hp;
+	zval **hd;
+	int aggregate = 0;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 0, 2, &bind_params, &bind_types);
+	
+	if (!bind_params) {
+		bind_params = PHALCON_GLOBAL(z_null);
+	}
+	
+	if (!bind_types) {
+		bind_types = PHALCON_GLOBAL(z_null);
+	}
+	
+	manager = phalcon_fetch_nproperty_this(this_ptr, SL("_manager"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(manager) != IS_OBJECT) {
+		zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "Dependency Injector is required to get '%s' service", "modelsManager");
+		RETURN_MM();
+	}
+	
+	cache_options = phalcon_fetch_nproperty_this(this_ptr, SL("_cacheOptions"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(cache_options) != IS_NULL) {
+		if (Z_TYPE_P(cache_options) != IS_ARRAY) { 
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Invalid caching options");
+			return;
+		}
+	
+		/** 
+		 * The user must set a cache key
+		 */
+		if (!phalcon_array_isset_string_fetch(&key, cache_options, SS("key"))) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "A cache key must be provided to identify the cached resultset in the cache backend");
+			return;
+		}
+	
+		PHALCON_INIT_VAR(versioned_key);
+		if (phalcon_mvc_model_query_versioned_key(versioned_key, this_ptr, key TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+	
+		key = versioned_key;
+	
+		/** 
+		 * 'modelsCache' is the default name for the models cache service
+		 */
+		if (!phalcon_array_isset_string_fetch(&cache_service, cache_options, SS("service"))) {
+			PHALCON_INIT_VAR(cache_service);
+			PHALCON_ZVAL_MAYBE_INTERNED_STRING(cache_service, phalcon_interned_modelsCache);
+		}
+	
+		dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
+	
+		PHALCON_CALL_METHOD(&cache, dependency_injector, "getshared", cache_service);
+		if (Z_TYPE_P(cache) != IS_OBJECT) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The cache service must be an object");
+			return;
+		}
+
+		PHALCON_VERIFY_INTERFACE(cache, phalcon_cache_backendinterface_ce);
+	
+		if (!phalcon_array_isset_string_fetch(&lifetime, cache_options, SS("lifetime"))) {
+			PHALCON_CALL_METHOD(&frontend, cache, "getfrontend");
+
+			if (Z_TYPE_P(frontend) == IS_OBJECT) {
+				PHALCON_VERIFY_INTERFACE_EX(frontend, phalcon_cache_frontendinterface_ce, phalcon_mvc_model_exception_ce, 1);
+				PHALCON_CALL_METHOD(&lifetime, frontend, "getlifetime");
+			}
+			else {
+				PHALCON_INIT_VAR(lifetime);
+				ZVAL_LONG(lifetime, 3600);
+			}
+		}
+
+		PHALCON_CALL_METHOD(&value, cache, "get", key, lifetime);
+		if (Z_TYPE_P(value) != IS_NULL) {
+			RETURN_CTOR(value);
+		}
+	}
+	
+	/** 
+	 * Statements compiled before only need the model to find the connection
+	 */
+	phql = phalcon_fetch_nproperty_this(this_ptr, SL("_phql"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(phql) == IS_STRING) {
+		PHALCON_OBS_VAR(sql_cache);
+		phalcon_read_static_property(&sql_cache, SL("phalcon\\mvc\\model\\query"), SL("_scalarSqlCache") TSRMLS_CC);
+		if (phalcon_array_isset_fetch(&cached, sql_cache, phql)) {
+			phalcon_array_isset_string_fetch(&model_name, cached, SS("model"));
+		}
+	}
+	
+	if (!model_name) {
+		PHALCON_CALL_METHOD(&intermediate, this_ptr, "parse");
+	
+		type = phalcon_fetch_nproperty_this(this_ptr, SL("_type"), PH_NOISY TSRMLS_CC);
+		if (!PHALCON_IS_LONG(type, PHQL_T_SELECT)) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Only SELECT statements can return a scalar result");
+			return;
+		}
+	
+		PHALCON_OBS_VAR(models);
+		phalcon_array_fetch_string(&models, intermediate, SL("models"), PH_NOISY);
+		if (Z_TYPE_P(models) != IS_ARRAY || zend_hash_num_elements(Z_ARRVAL_P(models)) != 1) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Scalar results can only be selected from one model");
+			return;
+		}
+	
+		PHALCON_OBS_NVAR(model_name);
+		phalcon_array_fetch_long(&model_name, models, 0, PH_NOISY);
+	}
+	
+	PHALCON_CALL_METHOD(&model, manager, "load", model_name);
+	
+	/** 
+	 * Check for default bind parameters and merge them with the passed ones
+	 */
+	default_bind_params = phalcon_fetch_nproperty_this(this_ptr, SL("_bindParams"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(default_bind_params) == IS_ARRAY) { 
+		if (Z_TYPE_P(bind_params) == IS_ARRAY) { 
+			PHALCON_INIT_VAR(merged_params);
+			phalcon_fast_array_merge(merged_params, &default_bind_params, &bind_params TSRMLS_CC);
+		} else {
+			PHALCON_CPY_WRT(merged_params, default_bind_params);
+		}
+	} else {
+		PHALCON_CPY_WRT(merged_params, bind_params);
+	}
+	
+	default_bind_types = phalcon_fetch_nproperty_this(this_ptr, SL("_bindTypes"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(default_bind_types) == IS_ARRAY) { 
+		if (Z_TYPE_P(bind_types) == IS_ARRAY) { 
+			PHALCON_INIT_VAR(merged_types);
+			phalcon_fast_array_merge(merged_types, &default_bind_types, &bind_types TSRMLS_CC);
+		} else {
+			PHALCON_CPY_WRT(merged_types, default_bind_types);
+		}
+	} else {
+		PHALCON_CPY_WRT(merged_types, bind_types);
+	}
+	
+	/** 
+	 * Sharded models are read from the shard fixed by the WHERE clause, without it the
+	 * aggregate is computed on every shard and the values are combined
+	 */
+	PHALCON_CALL_METHOD(&shards, manager, "getshards", model);
+	if (Z_TYPE_P(shards) == IS_ARRAY) {
+		if (!intermediate) {
+			PHALCON_CALL_METHOD(&intermediate, this_ptr, "parse");
+		}
+	
+		PHALCON_CALL_METHOD(&shard_key, manager, "getshardkey", model);
+	
+		if (phalcon_array_isset_string_fetch(&where, intermediate, SS("where")) && phalcon_mvc_model_query_find_shard_value(&shard_value, where, shard_key, merged_params TSRMLS_CC) == SUCCESS) {
+			PHALCON_CALL_METHOD(&shard_service, manager, "getshardservice", model, shard_value);
+		} else {
+			aggregate = phalcon_mvc_model_query_shard_aggregate(intermediate TSRMLS_CC);
+			if (!aggregate) {
+				zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "The shard key '%s' is required to query the sharded model '%s' this way", Z_STRVAL_P(shard_key), Z_OBJCE_P(model)->name);
+				RETURN_MM();
+			}
+	
+			/** 
+			 * The SQL is generated for the dialect of the first shard
+			 */
+			zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(shards), &hp);
+			zend_hash_get_current_data_ex(Z_ARRVAL_P(shards), (void**)&hd, &hp);
+			PHALCON_CPY_WRT(shard_service, *hd);
+		}
+	
+		dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
+		PHALCON_CALL_METHOD(&connection, dependency_injector, "getshared", shard_service);
+	} else if (phalcon_method_exists_ex(model, SS("selectreadconnection") TSRMLS_CC) == SUCCESS) {
+	
+		/** 
+		 * The 'selectReadConnection' method receives the intermediate representation
+		 */
+		if (!intermediate) {
+			PHALCON_CALL_METHOD(&intermediate, this_ptr, "parse");
+		}
+	
+		PHALCON_CALL_METHOD(&connection, model, "selectreadconnection", intermediate, bind_params, bind_types);
+		if (Z_TYPE_P(connection) != IS_OBJECT) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "'selectReadConnection' didn't returned a valid connection");
+			return;
+		}
+	} else {
+		PHALCON_CALL_METHOD(&connection, model, "getreadconnection");
+	}
+	
+	PHALCON_CALL_METHOD(&connection_type, connection, "gettype");
+	
+	if (!cached || !phalcon_array_isset_string_fetch(&cached_sql, cached, SS("sql")) || !phalcon_array_isset_fetch(&sql_select, cached_sql, connection_type)) {
+	
+		if (!intermediate) {
+			PHALCON_CALL_METHOD(&intermediate, this_ptr, "parse");
+		}
+	
+		/** 
+		 * Only one scalar column can be selected
+		 */
+		PHALCON_OBS_VAR(columns);
+		phalcon_array_fetch_string(&columns, intermediate, SL("columns"), PH_NOISY);
+		if (Z_TYPE_P(columns) != IS_ARRAY || zend_hash_num_elements(Z_ARRVAL_P(columns)) != 1) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Scalar results require exactly one column");
+			return;
+		}
+	
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(columns), &hp);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(columns), (void**)&hd, &hp);
+		column = *hd;
+	
+		if (!phalcon_array_isset_string(column, ISS(type)) || !phalcon_array_isset_string_fetch(&sql_column, column, SS("column"))) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Corrupted SELECT AST");
+			return;
+		}
+	
+		PHALCON_OBS_VAR(column_type);
+		phalcon_array_fetch_string(&column_type, column, ISL(type), PH_NOISY);
+		if (!PHALCON_IS_STRING(column_type, "scalar")) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Scalar results require exactly one column");
+			return;
+		}
+	
+		PHALCON_INIT_VAR(column_alias);
+		array_init_size(column_alias, 2);
+		phalcon_array_append(&column_alias, sql_column, 0);
+		phalcon_array_append(&column_alias, PHALCON_GLOBAL(z_null), 0);
+	
+		PHALCON_INIT_VAR(select_columns);
+		array_init_size(select_columns, 1);
+		phalcon_array_append(&select_columns, column_alias, 0);
+	
+		phalcon_array_update_string(&intermediate, SL("columns"), select_columns, PH_COPY);
+	
+		PHALCON_CALL_METHOD(&dialect, connection, "getdialect");
+		PHALCON_CALL_METHOD(&sql_select, dialect, "select", intermediate);
+	
+		/** 
+		 * Store the SQL for the next executions of the same PHQL
+		 */
+		if (Z_TYPE_P(phql) == IS_STRING && Z_TYPE_P(sql_select) == IS_STRING) {
+			if (Z_TYPE_P(sql_cache) != IS_ARRAY) { 
+				PHALCON_INIT_NVAR(sql_cache);
+				array_init(sql_cache);
+			} else {
+				PHALCON_SEPARATE_ARRAY(sql_cache);
+			}
+	
+			PHALCON_INIT_VAR(sql_key);
+			ZVAL_STRING(sql_key, "sql", 1);
+	
+			phalcon_array_update_string_multi_2(&sql_cache, phql, SL("model"), model_name, 0);
+			phalcon_array_update_zval_zval_zval_multi_3(&sql_cache, phql, sql_key, connection_type, sql_select, 0);
+			phalcon_update_static_property_ce(phalcon_mvc_model_query_ce, SL("_scalarSqlCache"), sql_cache TSRMLS_CC);
+		}
+	}
+	
+	PHALCON_INIT_VAR(processed);
+	phalcon_mvc_model_query_process_placeholders(processed, merged_params TSRMLS_CC);
+	
+	PHALCON_INIT_VAR(processed_types);
+	phalcon_mvc_model_query_process_placeholders(processed_types, merged_types TSRMLS_CC);
+	
+	PHALCON_INIT_VAR(fetch_num);
+	ZVAL_LONG(fetch_num, PDO_FETCH_NUM);
+	
+	PHALCON_INIT_NVAR(value);
+	if (aggregate) {
+		dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
+	
+		phalcon_is_iterable(shards, &ah0, &hp, 0, 0);
+	
+		while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp) == SUCCESS) {
+	
+			PHALCON_GET_HVALUE(shard_service);
+	
+			PHALCON_CALL_METHOD(&connection, dependency_injector, "getshared", shard_service);
+			PHALCON_CALL_METHOD(&row, connection, "fetchone", sql_select, fetch_num, processed, processed_types);
+			if (phalcon_array_isset_long_fetch(&scalar, row, 0)) {
+				phalcon_mvc_model_query_combine_scalar(value, scalar, aggregate TSRMLS_CC);
+			}
+	
+			zend_hash_move_forward_ex(ah0, &hp);
+		}
+	} else {
+		PHALCON_CALL_METHOD(&row, connection, "fetchone", sql_select, fetch_num, processed, processed_types);
+		if (phalcon_array_isset_long_fetch(&scalar, row, 0)) {
+			ZVAL_ZVAL(value, scalar, 1, 0);
+		}
+	}
+	
+	/** 
+	 * We store the value in the cache if any
+	 */
+	if (cache) {
+		PHALCON_CALL_METHOD(NULL, cache, "save", key, value, lifetime);
+	}
+	
+	RETURN_CTOR(value);
+}
+
 /**
  * Sets the type of PHQL statement to be executed
  *
@@ -5056,3 +6129,30 @@ PHP_METHOD(Phalcon_Mvc_Model_Query, getIntermediate){
 
 	RETURN_MEMBER(this_ptr, "_intermediate");
 }
+
+/**
+ * Sets the relations that must be eager loaded in the resultset
+ *
+ * @param string|array $relations
+ * @return Phalcon\Mvc\Model\Query
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Query, with){
+
+	zval *relations;
+
+	phalcon_fetch_params(0, 1, 0, &relations);
+	
+	phalcon_update_property_this(this_ptr, SL("_with"), relations TSRMLS_CC);
+	RETURN_THISW();
+}
+
+/**
+ * Returns the relations that must be eager loaded
+ *
+ * @return string|array
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Query, getWith){
+
+
+	RETURN_MEMBER(this_ptr, "_with");
+}
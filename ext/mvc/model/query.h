@@ -27,4 +27,10 @@ extern zend_class_entry *phalcon_mvc_model_query_ce;
 
 PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Query);
 
+int phalcon_mvc_model_query_find_shard_value(zval **value, zval *expr, zval *shard_key, zval *bind_params TSRMLS_DC);
+int phalcon_mvc_model_query_begin_connection(zval *connections, zval *connection TSRMLS_DC);
+int phalcon_mvc_model_query_begin_record(zval *connections, zval *record TSRMLS_DC);
+int phalcon_mvc_model_query_end_connections(zval *connections, int commit TSRMLS_DC);
+int phalcon_mvc_model_query_prepare_select(zval *query, zval *ast TSRMLS_DC);
+
 #endif /* PHALCON_MVC_MODEL_QUERY_H */
@@ -101,7 +101,7 @@ static void phql_parse_with_token(void* phql_parser, int opcode, int parsercode,
 
 	phql_parser_token *pToken;
 
-	pToken = emalloc(sizeof(phql_parser_token));
+	pToken = phalcon_arena_alloc(&parser_status->arena, sizeof(phql_parser_token));
 	pToken->opcode = opcode;
 	pToken->token = token->value;
 	pToken->token_len = token->len;
@@ -173,9 +173,9 @@ int phql_parse_phql(zval *result, zval *phql TSRMLS_DC) {
 int phql_internal_parse_phql(zval **result, char *phql, unsigned int phql_length, zval **error_msg TSRMLS_DC) {
 
 	zend_phalcon_globals *phalcon_globals_ptr = PHALCON_VGLOBAL;
-	phql_parser_status *parser_status = NULL;
+	phql_parser_status parser_status_s, *parser_status = &parser_status_s;
 	int scanner_status, status = SUCCESS, error_length, cache_level;
-	phql_scanner_state *state;
+	phql_scanner_state state_s, *state = &state_s;
 	phql_scanner_token token;
 	unsigned long phql_key = 0;
 	void* phql_parser;
@@ -209,8 +209,11 @@ int phql_internal_parse_phql(zval **result, char *phql, unsigned int phql_length
 		return FAILURE;
 	}
 
-	parser_status = emalloc(sizeof(phql_parser_status));
-	state = emalloc(sizeof(phql_scanner_state));
+	/**
+	 * The status, the scanner state and the tokens passed to the parser don't outlive
+	 * this call, tokens are bump-allocated from an arena released at the end of the parse
+	 */
+	phalcon_arena_init(&parser_status->arena, PHQL_ARENA_BLOCK_SIZE);
 
 	parser_status->status = PHQL_PARSING_OK;
 	parser_status->scanner_state = state;
@@ -579,8 +582,7 @@ int phql_internal_parse_phql(zval **result, char *phql, unsigned int phql_length
 		}
 	}
 
-	efree(parser_status);
-	efree(state);
+	phalcon_arena_destroy(&parser_status->arena);
 
 	return status;
 }
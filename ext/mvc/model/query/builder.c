@@ -22,6 +22,8 @@
 #include "mvc/model/exception.h"
 #include "mvc/model/metadatainterface.h"
 #include "mvc/model/query.h"
+#include "mvc/model/query/scanner.h"
+#include "mvc/model/query/phql.h"
 #include "di.h"
 #include "diinterface.h"
 #include "di/injectionawareinterface.h"
@@ -89,6 +91,8 @@ PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, offset);
 PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getOffset);
 PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, groupBy);
 PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getGroupBy);
+PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, with);
+PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getWith);
 PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getPhql);
 PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getQuery);
 
@@ -100,6 +104,10 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_query_builder_offset, 0, 0, 1)
 	ZEND_ARG_INFO(0, offset)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_query_builder_with, 0, 0, 1)
+	ZEND_ARG_INFO(0, relations)
+ZEND_END_ARG_INFO()
+
 static const zend_function_entry phalcon_mvc_model_query_builder_method_entry[] = {
 	PHP_ME(Phalcon_Mvc_Model_Query_Builder, __construct, arginfo_phalcon_mvc_model_query_builder___construct, ZEND_ACC_PUBLIC|ZEND_ACC_CTOR)
 	PHP_ME(Phalcon_Mvc_Model_Query_Builder, distinct, arginfo_phalcon_mvc_model_query_builderinterface_distinct, ZEND_ACC_PUBLIC)
@@ -133,6 +141,8 @@ static const zend_function_entry phalcon_mvc_model_query_builder_method_entry[]
 	PHP_ME(Phalcon_Mvc_Model_Query_Builder, getOffset, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Query_Builder, groupBy, arginfo_phalcon_mvc_model_query_builderinterface_groupby, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Query_Builder, getGroupBy, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Query_Builder, with, arginfo_phalcon_mvc_model_query_builder_with, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Query_Builder, getWith, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Query_Builder, getPhql, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Query_Builder, getQuery, NULL, ZEND_ACC_PUBLIC)
 	PHP_FE_END
@@ -160,6 +170,7 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Query_Builder){
 	zend_declare_property_null(phalcon_mvc_model_query_builder_ce, SL("_bindParams"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_query_builder_ce, SL("_bindTypes"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_query_builder_ce, SL("_distinct"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_query_builder_ce, SL("_with"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_long(phalcon_mvc_model_query_builder_ce, SL("_hiddenParamNumber"), 0, ZEND_ACC_PROTECTED TSRMLS_CC);
 
 	zend_class_implements(phalcon_mvc_model_query_builder_ce TSRMLS_CC, 2, phalcon_mvc_model_query_builderinterface_ce, phalcon_di_injectionawareinterface_ce);
@@ -188,6 +199,7 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Query_Builder){
  *    'limit'      => 20,
  *    'offset'     => 20,
  *    // or 'limit' => array(20, 20),
+ *    'with'       => array('robotsParts', 'robotsParts.parts'),
  *);
  *$queryBuilder = new Phalcon\Mvc\Model\Query\Builder($params);
  *</code> 
@@ -200,7 +212,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, __construct){
 	zval *params = NULL, *dependency_injector = NULL, *conditions = NULL;
 	zval *models, *columns, *group_clause, *joins;
 	zval *having_clause, *order_clause, *limit_clause;
-	zval *offset_clause, *for_update, *shared_lock;
+	zval *offset_clause, *for_update, *shared_lock, *with;
 	zval *limit, *offset, *single_condition_array;
 	zval *condition_string = NULL, *bind_params, *bind_types;	
 	zval *merged_conditions, *merged_bind_params, *merged_bind_types;
@@ -356,6 +368,13 @@ PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, __construct){
 		if (phalcon_array_isset_string_fetch(&shared_lock, params, SS("shared_lock"))) {
 			phalcon_update_property_this(this_ptr, SL("_sharedLock"), shared_lock TSRMLS_CC);
 		}
+
+		/** 
+		 * Assign the relations to eager load
+		 */
+		if (phalcon_array_isset_string_fetch(&with, params, SS("with"))) {
+			phalcon_update_property_this(this_ptr, SL("_with"), with TSRMLS_CC);
+		}
 	}
 
 	/** 
@@ -1380,107 +1399,125 @@ PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getGroupBy){
 }
 
 /**
- * Returns a PHQL statement built based on the builder parameters
+ * Sets the relations that must be eager loaded in the resultset, nested relations are
+ * separated by dots
  *
- * @return string
+ *<code>
+ *	$builder->with(array('robotsParts', 'robotsParts.parts'));
+ *</code>
+ *
+ * @param string|array $relations
+ * @return Phalcon\Mvc\Model\Query\Builder
  */
-PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getPhql){
+PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, with){
+
+	zval *relations;
 
-	zval *dependency_injector = NULL, *models, *conditions = NULL, *distinct;
-	zval *z_one, *number_models, *invalid_condition;
+	phalcon_fetch_params(0, 1, 0, &relations);
+	
+	phalcon_update_property_this(this_ptr, SL("_with"), relations TSRMLS_CC);
+	RETURN_THISW();
+}
+
+/**
+ * Returns the relations that must be eager loaded
+ *
+ * @return string|array
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getWith){
+
+
+	RETURN_MEMBER(this_ptr, "_with");
+}
+
+/**
+ * Checks that the builder has at least one model to select from
+ */
+static int phalcon_mvc_model_query_builder_check_models(zval *models TSRMLS_DC)
+{
+	if (Z_TYPE_P(models) == IS_ARRAY) {
+		if (zend_hash_num_elements(Z_ARRVAL_P(models))) {
+			return SUCCESS;
+		}
+	} else if (zend_is_true(models)) {
+		return SUCCESS;
+	}
+
+	PHALCON_THROW_EXCEPTION_STRW(phalcon_mvc_model_exception_ce, "At least one model is required to build the query");
+	return FAILURE;
+}
+
+/**
+ * Returns the conditions of the builder, a numeric condition is turned into a condition on
+ * the primary key of the model
+ */
+static void phalcon_mvc_model_query_builder_conditions(zval *return_value, zval *this_ptr, zval *models, zval *dependency_injector TSRMLS_DC)
+{
+	zval *conditions = NULL, *z_one, *number_models, *invalid_condition;
 	zval *model = NULL, *service_name, *meta_data = NULL, *model_instance;
 	zval *no_primary = NULL, *primary_keys = NULL, *first_primary_key;
 	zval *column_map = NULL, *attribute_field = NULL, *exception_message;
-	zval *primary_key_condition, *phql, *columns;
-	zval *selected_columns = NULL, *column = NULL, *column_alias = NULL;
-	zval *aliased_column = NULL, *joined_columns = NULL, *model_column_alias = NULL;
-	zval *selected_column = NULL, *selected_models, *model_alias = NULL;
-	zval *selected_model = NULL, *joined_models, *joins;
-	zval *join = NULL, *join_model = NULL, *join_conditions = NULL, *join_alias = NULL;
-	zval *join_type = NULL, *group, *group_items, *group_item = NULL;
-	zval *escaped_item = NULL, *joined_items = NULL, *having, *order;
-	zval *order_items, *order_item = NULL, *limit, *number;
-	HashTable *ah0, *ah1, *ah2, *ah3, *ah4, *ah5;
-	HashPosition hp0, hp1, hp2, hp3, hp4, hp5;
-	zval **hd;
+	zval *primary_key_condition;
 	zend_class_entry *ce0;
 
 	PHALCON_MM_GROW();
 
-	dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
-	if (Z_TYPE_P(dependency_injector) != IS_OBJECT) {
-		dependency_injector = NULL;
-		PHALCON_CALL_CE_STATIC(&dependency_injector, phalcon_di_ce, "getdefault");
-		phalcon_update_property_this(this_ptr, SL("_dependencyInjector"), dependency_injector TSRMLS_CC);
-	}
-	
-	models = phalcon_fetch_nproperty_this(this_ptr, SL("_models"), PH_NOISY TSRMLS_CC);
-	if (Z_TYPE_P(models) == IS_ARRAY) { 
-		if (!phalcon_fast_count_ev(models TSRMLS_CC)) {
-			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "At least one model is required to build the query");
-			return;
-		}
-	} else if (!zend_is_true(models)) {
-		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "At least one model is required to build the query");
-		return;
-	}
-	
 	PHALCON_OBS_VAR(conditions);
 	phalcon_read_property_this(&conditions, this_ptr, SL("_conditions"), PH_NOISY TSRMLS_CC);
 	if (phalcon_is_numeric(conditions)) {
-	
-		/** 
+
+		/**
 		 * If the conditions is a single numeric field. We internally create a condition
 		 * using the related primary key
 		 */
-		if (Z_TYPE_P(models) == IS_ARRAY) { 
-	
+		if (Z_TYPE_P(models) == IS_ARRAY) {
+
 			z_one = PHALCON_GLOBAL(z_one);
-	
+
 			PHALCON_INIT_VAR(number_models);
 			phalcon_fast_count(number_models, models TSRMLS_CC);
-	
+
 			PHALCON_INIT_VAR(invalid_condition);
 			is_smaller_function(invalid_condition, z_one, number_models TSRMLS_CC);
 			if (PHALCON_IS_TRUE(invalid_condition)) {
 				PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Cannot build the query. Invalid condition");
 				return;
 			}
-	
+
 			PHALCON_OBS_VAR(model);
 			phalcon_array_fetch_long(&model, models, 0, PH_NOISY);
 		} else {
 			PHALCON_CPY_WRT(model, models);
 		}
-	
+
 		PHALCON_INIT_VAR(service_name);
 		PHALCON_ZVAL_MAYBE_INTERNED_STRING(service_name, phalcon_interned_modelsMetadata);
-	
-		/** 
+
+		/**
 		 * Get the models metadata service to obtain the column names, column map and
 		 * primary key
 		 */
 		PHALCON_CALL_METHOD(&meta_data, dependency_injector, "getshared", service_name);
 		PHALCON_VERIFY_INTERFACE(meta_data, phalcon_mvc_model_metadatainterface_ce);
 		ce0 = phalcon_fetch_class(model TSRMLS_CC);
-	
+
 		PHALCON_INIT_VAR(model_instance);
 		object_init_ex(model_instance, ce0);
 		if (phalcon_has_constructor(model_instance TSRMLS_CC)) {
 			PHALCON_CALL_METHOD(NULL, model_instance, "__construct", dependency_injector);
 		}
-	
+
 		PHALCON_INIT_VAR(no_primary);
 		ZVAL_TRUE(no_primary);
-	
+
 		PHALCON_CALL_METHOD(&primary_keys, meta_data, "getprimarykeyattributes", model_instance);
 		if (phalcon_fast_count_ev(primary_keys TSRMLS_CC)) {
 			if (phalcon_array_isset_long(primary_keys, 0)) {
-	
+
 				PHALCON_OBS_VAR(first_primary_key);
 				phalcon_array_fetch_long(&first_primary_key, primary_keys, 0, PH_NOISY);
-	
-				/** 
+
+				/**
 				 * The PHQL contains the renamed columns if available
 				 */
 				if (PHALCON_GLOBAL(orm).column_renaming) {
@@ -1488,8 +1525,8 @@ PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getPhql){
 				} else {
 					PHALCON_INIT_VAR(column_map);
 				}
-	
-				if (Z_TYPE_P(column_map) == IS_ARRAY) { 
+
+				if (Z_TYPE_P(column_map) == IS_ARRAY) {
 					if (phalcon_array_isset(column_map, first_primary_key)) {
 						PHALCON_OBS_VAR(attribute_field);
 						phalcon_array_fetch(&attribute_field, column_map, first_primary_key, PH_NOISY);
@@ -1502,16 +1539,16 @@ PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getPhql){
 				} else {
 					PHALCON_CPY_WRT(attribute_field, first_primary_key);
 				}
-	
+
 				PHALCON_INIT_VAR(primary_key_condition);
 				PHALCON_CONCAT_SVSVSV(primary_key_condition, "[", model, "].[", attribute_field, "] = ", conditions);
 				PHALCON_CPY_WRT(conditions, primary_key_condition);
-	
+
 				ZVAL_FALSE(no_primary);
 			}
 		}
-	
-		/** 
+
+		/**
 		 * A primary key is mandatory in these cases
 		 */
 		if (PHALCON_IS_TRUE(no_primary)) {
@@ -1519,6 +1556,548 @@ PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getPhql){
 			return;
 		}
 	}
+
+	RETURN_CTOR(conditions);
+}
+
+/**
+ * Returns the PHQL of the columns when they are passed as an array, the string keys are
+ * the aliases of the columns
+ */
+static void phalcon_mvc_model_query_builder_columns_phql(zval *return_value, zval *columns TSRMLS_DC)
+{
+	zval *selected_columns, *column = NULL, *column_alias = NULL, *aliased_column = NULL;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+
+	PHALCON_MM_GROW();
+
+	PHALCON_INIT_VAR(selected_columns);
+	array_init(selected_columns);
+
+	phalcon_is_iterable(columns, &ah0, &hp0, 0, 0);
+
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+		PHALCON_GET_HKEY(column_alias, ah0, hp0);
+		PHALCON_GET_HVALUE(column);
+
+		if (Z_TYPE_P(column_alias) == IS_LONG) {
+			phalcon_array_append(&selected_columns, column, PH_SEPARATE);
+		} else {
+			PHALCON_INIT_NVAR(aliased_column);
+			PHALCON_CONCAT_VSV(aliased_column, column, " AS ", column_alias);
+			phalcon_array_append(&selected_columns, aliased_column, PH_SEPARATE);
+		}
+
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+
+	phalcon_fast_join_str(return_value, SL(", "), selected_columns TSRMLS_CC);
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Returns the PHQL of GROUP BY or ORDER BY items, the items that are neither numeric nor
+ * qualified are escaped
+ */
+static void phalcon_mvc_model_query_builder_items_phql(zval *return_value, zval *items TSRMLS_DC)
+{
+	zval *escaped_items, *item = NULL, *escaped_item = NULL;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+
+	PHALCON_MM_GROW();
+
+	if (Z_TYPE_P(items) != IS_ARRAY) {
+		if (phalcon_is_numeric(items) || phalcon_memnstr_str(items, SL("."))) {
+			RETURN_CTOR(items);
+		}
+
+		PHALCON_CONCAT_SVS(return_value, "[", items, "]");
+		RETURN_MM();
+	}
+
+	PHALCON_INIT_VAR(escaped_items);
+	array_init(escaped_items);
+
+	phalcon_is_iterable(items, &ah0, &hp0, 0, 0);
+
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+		PHALCON_GET_HVALUE(item);
+
+		if (phalcon_is_numeric(item)) {
+			phalcon_array_append(&escaped_items, item, PH_SEPARATE);
+		} else {
+			if (phalcon_memnstr_str(item, SL("."))) {
+				phalcon_array_append(&escaped_items, item, PH_SEPARATE);
+			} else {
+				PHALCON_INIT_NVAR(escaped_item);
+				PHALCON_CONCAT_SVS(escaped_item, "[", item, "]");
+				phalcon_array_append(&escaped_items, escaped_item, PH_SEPARATE);
+			}
+		}
+
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+
+	phalcon_fast_join_str(return_value, SL(", "), escaped_items TSRMLS_CC);
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Returns a part of the builder as a string for a node of the AST
+ */
+static zval *phalcon_mvc_model_query_builder_ast_string(zval *value)
+{
+	zval *ret;
+
+	MAKE_STD_ZVAL(ret);
+	ZVAL_ZVAL(ret, value, 1, 0);
+	convert_to_string(ret);
+
+	return ret;
+}
+
+/**
+ * Returns the AST of a model or an alias, as the parser produces it for [name]
+ */
+static zval *phalcon_mvc_model_query_builder_ast_qualified(zval *name)
+{
+	zval *ret;
+
+	MAKE_STD_ZVAL(ret);
+	array_init_size(ret, 2);
+	add_assoc_long(ret, phalcon_interned_type, PHQL_T_QUALIFIED);
+	add_assoc_zval(ret, phalcon_interned_name, phalcon_mvc_model_query_builder_ast_string(name));
+
+	return ret;
+}
+
+/**
+ * Returns the AST of a limit or an offset given as a non-negative integer, NULL for
+ * anything else
+ */
+static zval *phalcon_mvc_model_query_builder_ast_integer(zval *value)
+{
+	zval *ret;
+	int i;
+
+	if (Z_TYPE_P(value) == IS_LONG) {
+		if (Z_LVAL_P(value) < 0) {
+			return NULL;
+		}
+	} else if (Z_TYPE_P(value) == IS_STRING && Z_STRLEN_P(value)) {
+		for (i = 0; i < Z_STRLEN_P(value); i++) {
+			if (Z_STRVAL_P(value)[i] < '0' || Z_STRVAL_P(value)[i] > '9') {
+				return NULL;
+			}
+		}
+	} else {
+		return NULL;
+	}
+
+	MAKE_STD_ZVAL(ret);
+	array_init_size(ret, 2);
+	add_assoc_long(ret, phalcon_interned_type, PHQL_T_INTEGER);
+	add_assoc_zval(ret, phalcon_interned_value, phalcon_mvc_model_query_builder_ast_string(value));
+
+	return ret;
+}
+
+/**
+ * Returns the PHQL join type of a join added to the builder, 0 if the type is not known
+ */
+static int phalcon_mvc_model_query_builder_join_type(zval *type)
+{
+	const char *name;
+	int length;
+
+	if (Z_TYPE_P(type) != IS_STRING) {
+		return 0;
+	}
+
+	name   = Z_STRVAL_P(type);
+	length = Z_STRLEN_P(type);
+
+	if (length == 5 && !strncasecmp(name, "INNER", 5)) {
+		return PHQL_T_INNERJOIN;
+	}
+
+	if (length == 5 && !strncasecmp(name, "CROSS", 5)) {
+		return PHQL_T_CROSSJOIN;
+	}
+
+	if (length > 6 && !strncasecmp(name + length - 6, " OUTER", 6)) {
+		length -= 6;
+	}
+
+	if (length == 4 && !strncasecmp(name, "LEFT", 4)) {
+		return PHQL_T_LEFTJOIN;
+	}
+
+	if (length == 5 && !strncasecmp(name, "RIGHT", 5)) {
+		return PHQL_T_RIGHTJOIN;
+	}
+
+	if (length == 4 && !strncasecmp(name, "FULL", 4)) {
+		return PHQL_T_FULLJOIN;
+	}
+
+	return 0;
+}
+
+/**
+ * Builds the AST of the statement getPhql() generates straight from the parts of the builder.
+ * The models, joins, DISTINCT and integer limits are structured already and become nodes
+ * directly. The columns, conditions, grouping, ordering and join conditions are PHQL of
+ * their own, only those are parsed, wrapped in a SELECT on the first model, so the parser
+ * cache keeps serving them when only the limits or the joins of the builder change
+ */
+static void phalcon_mvc_model_query_builder_select_ast(zval *return_value, zval *this_ptr, zval *models, zval *dependency_injector TSRMLS_DC)
+{
+	zval *conditions, *first_model, *distinct, *columns, *group, *having, *order;
+	zval *joins, *limit, *number = NULL, *offset = NULL, *phql, *joined_columns;
+	zval *joined_items = NULL, *fragments_ast = NULL, *fragments_select, *part, *select;
+	zval *tables, *select_columns;
+	zval *model = NULL, *model_alias = NULL, *item = NULL, *sql_joins, *join = NULL;
+	zval *join_model = NULL, *join_conditions = NULL, *join_alias = NULL, *join_type = NULL;
+	zval *join_phql = NULL, *join_ast = NULL, *limit_clause = NULL, *exception_message;
+	zval *number_node, *offset_node;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+	int fragments = 0, join_type_code;
+
+	PHALCON_MM_GROW();
+
+	PHALCON_INIT_VAR(conditions);
+	phalcon_mvc_model_query_builder_conditions(conditions, this_ptr, models, dependency_injector TSRMLS_CC);
+	if (EG(exception)) {
+		RETURN_MM();
+	}
+
+	if (Z_TYPE_P(models) == IS_ARRAY) {
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(models), &hp0);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(models), (void**) &hd, &hp0);
+		first_model = *hd;
+	} else {
+		first_model = models;
+	}
+
+	/**
+	 * Collect the fragments of PHQL in a single statement
+	 */
+	PHALCON_INIT_VAR(phql);
+
+	columns = phalcon_fetch_nproperty_this(this_ptr, SL("_columns"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(columns) == IS_ARRAY) {
+		PHALCON_INIT_VAR(joined_columns);
+		phalcon_mvc_model_query_builder_columns_phql(joined_columns, columns TSRMLS_CC);
+		PHALCON_CONCAT_SVSVS(phql, "SELECT ", joined_columns, " FROM [", first_model, "]");
+		fragments = 1;
+	} else if (Z_TYPE_P(columns) != IS_NULL) {
+		PHALCON_CONCAT_SVSVS(phql, "SELECT ", columns, " FROM [", first_model, "]");
+		fragments = 1;
+	} else {
+		PHALCON_CONCAT_SVS(phql, "SELECT * FROM [", first_model, "]");
+	}
+
+	if (Z_TYPE_P(conditions) == IS_STRING && PHALCON_IS_NOT_EMPTY(conditions)) {
+		PHALCON_SCONCAT_SV(phql, " WHERE ", conditions);
+		fragments = 1;
+	}
+
+	group = phalcon_fetch_nproperty_this(this_ptr, SL("_group"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(group) != IS_NULL) {
+		PHALCON_INIT_NVAR(joined_items);
+		phalcon_mvc_model_query_builder_items_phql(joined_items, group TSRMLS_CC);
+		PHALCON_SCONCAT_SV(phql, " GROUP BY ", joined_items);
+		fragments = 1;
+	}
+
+	having = phalcon_fetch_nproperty_this(this_ptr, SL("_having"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(having) != IS_NULL && PHALCON_IS_NOT_EMPTY(having)) {
+		PHALCON_SCONCAT_SV(phql, " HAVING ", having);
+		fragments = 1;
+	}
+
+	order = phalcon_fetch_nproperty_this(this_ptr, SL("_order"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(order) == IS_ARRAY) {
+		PHALCON_INIT_NVAR(joined_items);
+		phalcon_mvc_model_query_builder_items_phql(joined_items, order TSRMLS_CC);
+		PHALCON_SCONCAT_SV(phql, " ORDER BY ", joined_items);
+		fragments = 1;
+	} else if (Z_TYPE_P(order) != IS_NULL) {
+		PHALCON_SCONCAT_SV(phql, " ORDER BY ", order);
+		fragments = 1;
+	}
+
+	/**
+	 * Integer limits are built directly, placeholders are left to the parser
+	 */
+	limit = phalcon_fetch_nproperty_this(this_ptr, SL("_limit"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(limit) != IS_NULL) {
+		if (Z_TYPE_P(limit) == IS_ARRAY) {
+			PHALCON_OBS_VAR(number);
+			phalcon_array_fetch_string(&number, limit, SL("number"), PH_NOISY);
+			phalcon_array_isset_string_fetch(&offset, limit, SS("offset"));
+		} else {
+			number = limit;
+			offset = phalcon_fetch_nproperty_this(this_ptr, SL("_offset"), PH_NOISY TSRMLS_CC);
+		}
+
+		if (offset && Z_TYPE_P(offset) == IS_NULL) {
+			offset = NULL;
+		}
+
+		number_node = phalcon_mvc_model_query_builder_ast_integer(number);
+		offset_node = offset ? phalcon_mvc_model_query_builder_ast_integer(offset) : NULL;
+		if (number_node && (!offset || offset_node)) {
+			PHALCON_INIT_VAR(limit_clause);
+			array_init_size(limit_clause, 2);
+			add_assoc_zval(limit_clause, phalcon_interned_number, number_node);
+			if (offset_node) {
+				add_assoc_zval(limit_clause, phalcon_interned_offset, offset_node);
+			}
+		} else {
+			if (number_node) {
+				zval_ptr_dtor(&number_node);
+			}
+			if (offset_node) {
+				zval_ptr_dtor(&offset_node);
+			}
+
+			if (offset) {
+				PHALCON_SCONCAT_SVSV(phql, " LIMIT ", number, " OFFSET ", offset);
+			} else {
+				PHALCON_SCONCAT_SV(phql, " LIMIT ", number);
+			}
+			fragments = 1;
+		}
+	}
+
+	if (fragments) {
+		PHALCON_INIT_VAR(fragments_ast);
+		if (phql_parse_phql(fragments_ast, phql TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+	}
+
+	PHALCON_INIT_VAR(select);
+	array_init_size(select, 4);
+
+	distinct = phalcon_fetch_nproperty_this(this_ptr, SL("_distinct"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(distinct) == IS_BOOL) {
+		add_assoc_long(select, phalcon_interned_distinct, Z_BVAL_P(distinct) ? 1 : 0);
+	}
+
+	/**
+	 * Without columns every model is selected entirely
+	 */
+	if (Z_TYPE_P(columns) != IS_NULL) {
+		PHALCON_OBS_VAR(fragments_select);
+		phalcon_array_fetch_string(&fragments_select, fragments_ast, ISL(select), PH_NOISY);
+
+		PHALCON_OBS_VAR(select_columns);
+		phalcon_array_fetch_string(&select_columns, fragments_select, ISL(columns), PH_NOISY);
+	} else {
+		PHALCON_INIT_VAR(select_columns);
+		array_init(select_columns);
+	}
+
+	PHALCON_INIT_VAR(tables);
+	array_init(tables);
+
+	if (Z_TYPE_P(models) == IS_ARRAY) {
+
+		phalcon_is_iterable(models, &ah0, &hp0, 0, 0);
+
+		while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+			PHALCON_GET_HKEY(model_alias, ah0, hp0);
+			PHALCON_GET_HVALUE(model);
+
+			PHALCON_INIT_NVAR(item);
+			array_init_size(item, 2);
+			add_assoc_zval(item, phalcon_interned_qualifiedName, phalcon_mvc_model_query_builder_ast_qualified(model));
+			if (Z_TYPE_P(model_alias) == IS_STRING) {
+				add_assoc_zval(item, phalcon_interned_alias, phalcon_mvc_model_query_builder_ast_string(model_alias));
+			}
+			phalcon_array_append(&tables, item, PH_COPY);
+
+			if (Z_TYPE_P(columns) == IS_NULL) {
+				PHALCON_INIT_NVAR(item);
+				array_init_size(item, 2);
+				add_assoc_long(item, phalcon_interned_type, PHQL_T_DOMAINALL);
+				add_assoc_zval(item, phalcon_interned_column, phalcon_mvc_model_query_builder_ast_string(Z_TYPE_P(model_alias) == IS_LONG ? model : model_alias));
+				phalcon_array_append(&select_columns, item, PH_COPY);
+			}
+
+			zend_hash_move_forward_ex(ah0, &hp0);
+		}
+	} else {
+		PHALCON_INIT_NVAR(item);
+		array_init_size(item, 1);
+		add_assoc_zval(item, phalcon_interned_qualifiedName, phalcon_mvc_model_query_builder_ast_qualified(models));
+		phalcon_array_append(&tables, item, PH_COPY);
+
+		if (Z_TYPE_P(columns) == IS_NULL) {
+			PHALCON_INIT_NVAR(item);
+			array_init_size(item, 2);
+			add_assoc_long(item, phalcon_interned_type, PHQL_T_DOMAINALL);
+			add_assoc_zval(item, phalcon_interned_column, phalcon_mvc_model_query_builder_ast_string(models));
+			phalcon_array_append(&select_columns, item, PH_COPY);
+		}
+	}
+
+	phalcon_array_update_string(&select, ISL(columns), select_columns, PH_COPY);
+	phalcon_array_update_string(&select, ISL(tables), tables, PH_COPY);
+
+	/**
+	 * Each join condition is parsed on its own
+	 */
+	joins = phalcon_fetch_nproperty_this(this_ptr, SL("_joins"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(joins) == IS_ARRAY && zend_hash_num_elements(Z_ARRVAL_P(joins))) {
+
+		PHALCON_INIT_VAR(sql_joins);
+		array_init(sql_joins);
+
+		phalcon_is_iterable(joins, &ah0, &hp0, 0, 0);
+
+		while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+			PHALCON_GET_HVALUE(join);
+
+			PHALCON_OBS_NVAR(join_model);
+			phalcon_array_fetch_long(&join_model, join, 0, PH_NOISY);
+
+			PHALCON_OBS_NVAR(join_conditions);
+			phalcon_array_fetch_long(&join_conditions, join, 1, PH_NOISY);
+
+			PHALCON_OBS_NVAR(join_alias);
+			phalcon_array_fetch_long(&join_alias, join, 2, PH_NOISY);
+
+			PHALCON_OBS_NVAR(join_type);
+			phalcon_array_fetch_long(&join_type, join, 3, PH_NOISY);
+
+			if (zend_is_true(join_type)) {
+				join_type_code = phalcon_mvc_model_query_builder_join_type(join_type);
+				if (!join_type_code) {
+					PHALCON_INIT_VAR(exception_message);
+					PHALCON_CONCAT_SV(exception_message, "Unknown join type: ", join_type);
+					PHALCON_THROW_EXCEPTION_ZVAL(phalcon_mvc_model_exception_ce, exception_message);
+					return;
+				}
+			} else {
+				join_type_code = PHQL_T_INNERJOIN;
+			}
+
+			PHALCON_INIT_NVAR(item);
+			array_init_size(item, 4);
+			add_assoc_long(item, phalcon_interned_type, join_type_code);
+			add_assoc_zval(item, phalcon_interned_qualified, phalcon_mvc_model_query_builder_ast_qualified(join_model));
+
+			if (zend_is_true(join_alias)) {
+				add_assoc_zval(item, phalcon_interned_alias, phalcon_mvc_model_query_builder_ast_qualified(join_alias));
+			}
+
+			if (zend_is_true(join_conditions)) {
+				PHALCON_INIT_NVAR(join_phql);
+				PHALCON_CONCAT_SVSV(join_phql, "SELECT * FROM [", first_model, "] WHERE ", join_conditions);
+
+				PHALCON_INIT_NVAR(join_ast);
+				if (phql_parse_phql(join_ast, join_phql TSRMLS_CC) == FAILURE) {
+					RETURN_MM();
+				}
+
+				if (phalcon_array_isset_string_fetch(&part, join_ast, ISS(where))) {
+					phalcon_array_update_string(&item, ISL(conditions), part, PH_COPY);
+				}
+			}
+
+			phalcon_array_append(&sql_joins, item, PH_COPY);
+
+			zend_hash_move_forward_ex(ah0, &hp0);
+		}
+
+		phalcon_array_update_string(&select, ISL(joins), sql_joins, PH_COPY);
+	}
+
+	array_init_size(return_value, 7);
+	add_assoc_long(return_value, phalcon_interned_type, PHQL_T_SELECT);
+	phalcon_array_update_string(&return_value, ISL(select), select, PH_COPY);
+
+	if (fragments) {
+		if (phalcon_array_isset_string_fetch(&part, fragments_ast, ISS(where))) {
+			phalcon_array_update_string(&return_value, ISL(where), part, PH_COPY);
+		}
+
+		if (phalcon_array_isset_string_fetch(&part, fragments_ast, ISS(groupBy))) {
+			phalcon_array_update_string(&return_value, ISL(groupBy), part, PH_COPY);
+		}
+
+		if (phalcon_array_isset_string_fetch(&part, fragments_ast, ISS(having))) {
+			phalcon_array_update_string(&return_value, ISL(having), part, PH_COPY);
+		}
+
+		if (phalcon_array_isset_string_fetch(&part, fragments_ast, ISS(orderBy))) {
+			phalcon_array_update_string(&return_value, ISL(orderBy), part, PH_COPY);
+		}
+
+		if (!limit_clause && phalcon_array_isset_string_fetch(&part, fragments_ast, ISS(limit))) {
+			phalcon_array_update_string(&return_value, ISL(limit), part, PH_COPY);
+		}
+	}
+
+	if (limit_clause) {
+		phalcon_array_update_string(&return_value, ISL(limit), limit_clause, PH_COPY);
+	}
+
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Returns a PHQL statement built based on the builder parameters
+ *
+ * @return string
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getPhql){
+
+	zval *dependency_injector = NULL, *models, *conditions, *distinct;
+	zval *model = NULL, *phql, *columns;
+	zval *selected_columns = NULL, *joined_columns = NULL, *model_column_alias = NULL;
+	zval *selected_column = NULL, *selected_models, *model_alias = NULL;
+	zval *selected_model = NULL, *joined_models, *joins;
+	zval *join = NULL, *join_model = NULL, *join_conditions = NULL, *join_alias = NULL;
+	zval *join_type = NULL, *group, *joined_items = NULL, *having, *order;
+	zval *limit, *number;
+	HashTable *ah1, *ah2, *ah3;
+	HashPosition hp1, hp2, hp3;
+	zval **hd;
+
+	PHALCON_MM_GROW();
+
+	dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(dependency_injector) != IS_OBJECT) {
+		dependency_injector = NULL;
+		PHALCON_CALL_CE_STATIC(&dependency_injector, phalcon_di_ce, "getdefault");
+		phalcon_update_property_this(this_ptr, SL("_dependencyInjector"), dependency_injector TSRMLS_CC);
+	}
+	
+	models = phalcon_fetch_nproperty_this(this_ptr, SL("_models"), PH_NOISY TSRMLS_CC);
+	if (phalcon_mvc_model_query_builder_check_models(models TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+	
+	PHALCON_INIT_VAR(conditions);
+	phalcon_mvc_model_query_builder_conditions(conditions, this_ptr, models, dependency_injector TSRMLS_CC);
+	if (EG(exception)) {
+		RETURN_MM();
+	}
 	
 	PHALCON_INIT_VAR(phql);
 
@@ -1543,30 +2122,8 @@ PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getPhql){
 		 * Generate PHQL for columns
 		 */
 		if (Z_TYPE_P(columns) == IS_ARRAY) { 
-	
-			PHALCON_INIT_VAR(selected_columns);
-			array_init(selected_columns);
-	
-			phalcon_is_iterable(columns, &ah0, &hp0, 0, 0);
-	
-			while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
-	
-				PHALCON_GET_HKEY(column_alias, ah0, hp0);
-				PHALCON_GET_HVALUE(column);
-	
-				if (Z_TYPE_P(column_alias) == IS_LONG) {
-					phalcon_array_append(&selected_columns, column, PH_SEPARATE);
-				} else {
-					PHALCON_INIT_NVAR(aliased_column);
-					PHALCON_CONCAT_VSV(aliased_column, column, " AS ", column_alias);
-					phalcon_array_append(&selected_columns, aliased_column, PH_SEPARATE);
-				}
-	
-				zend_hash_move_forward_ex(ah0, &hp0);
-			}
-	
 			PHALCON_INIT_VAR(joined_columns);
-			phalcon_fast_join_str(joined_columns, SL(", "), selected_columns TSRMLS_CC);
+			phalcon_mvc_model_query_builder_columns_phql(joined_columns, columns TSRMLS_CC);
 			phalcon_concat_self(&phql, joined_columns TSRMLS_CC);
 		} else {
 			phalcon_concat_self(&phql, columns TSRMLS_CC);
@@ -1721,46 +2278,9 @@ PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getPhql){
 	PHALCON_OBS_VAR(group);
 	phalcon_read_property_this(&group, this_ptr, SL("_group"), PH_NOISY TSRMLS_CC);
 	if (Z_TYPE_P(group) != IS_NULL) {
-		if (Z_TYPE_P(group) == IS_ARRAY) { 
-	
-			PHALCON_INIT_VAR(group_items);
-			array_init(group_items);
-	
-			phalcon_is_iterable(group, &ah4, &hp4, 0, 0);
-	
-			while (zend_hash_get_current_data_ex(ah4, (void**) &hd, &hp4) == SUCCESS) {
-	
-				PHALCON_GET_HVALUE(group_item);
-	
-				if (phalcon_is_numeric(group_item)) {
-					phalcon_array_append(&group_items, group_item, PH_SEPARATE);
-				} else {
-					if (phalcon_memnstr_str(group_item, SL("."))) {
-						phalcon_array_append(&group_items, group_item, PH_SEPARATE);
-					} else {
-						PHALCON_INIT_NVAR(escaped_item);
-						PHALCON_CONCAT_SVS(escaped_item, "[", group_item, "]");
-						phalcon_array_append(&group_items, escaped_item, PH_SEPARATE);
-					}
-				}
-	
-				zend_hash_move_forward_ex(ah4, &hp4);
-			}
-	
-			PHALCON_INIT_VAR(joined_items);
-			phalcon_fast_join_str(joined_items, SL(", "), group_items TSRMLS_CC);
-			PHALCON_SCONCAT_SV(phql, " GROUP BY ", joined_items);
-		} else {
-			if (phalcon_is_numeric(group)) {
-				PHALCON_SCONCAT_SV(phql, " GROUP BY ", group);
-			} else {
-				if (phalcon_memnstr_str(group, SL("."))) {
-					PHALCON_SCONCAT_SV(phql, " GROUP BY ", group);
-				} else {
-					PHALCON_SCONCAT_SVS(phql, " GROUP BY [", group, "]");
-				}
-			}
-		}
+		PHALCON_INIT_VAR(joined_items);
+		phalcon_mvc_model_query_builder_items_phql(joined_items, group TSRMLS_CC);
+		PHALCON_SCONCAT_SV(phql, " GROUP BY ", joined_items);
 	}
 	
 	/* Process HAVING clause */
@@ -1779,33 +2299,8 @@ PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getPhql){
 	phalcon_read_property_this(&order, this_ptr, SL("_order"), PH_NOISY TSRMLS_CC);
 	if (Z_TYPE_P(order) != IS_NULL) {
 		if (Z_TYPE_P(order) == IS_ARRAY) { 
-	
-			PHALCON_INIT_VAR(order_items);
-			array_init(order_items);
-	
-			phalcon_is_iterable(order, &ah5, &hp5, 0, 0);
-	
-			while (zend_hash_get_current_data_ex(ah5, (void**) &hd, &hp5) == SUCCESS) {
-	
-				PHALCON_GET_HVALUE(order_item);
-	
-				if (phalcon_is_numeric(order_item)) {
-					phalcon_array_append(&order_items, order_item, PH_SEPARATE);
-				} else {
-					if (phalcon_memnstr_str(order_item, SL("."))) {
-						phalcon_array_append(&order_items, order_item, PH_SEPARATE);
-					} else {
-						PHALCON_INIT_NVAR(escaped_item);
-						PHALCON_CONCAT_SVS(escaped_item, "[", order_item, "]");
-						phalcon_array_append(&order_items, escaped_item, PH_SEPARATE);
-					}
-				}
-	
-				zend_hash_move_forward_ex(ah5, &hp5);
-			}
-	
 			PHALCON_INIT_NVAR(joined_items);
-			phalcon_fast_join_str(joined_items, SL(", "), order_items TSRMLS_CC);
+			phalcon_mvc_model_query_builder_items_phql(joined_items, order TSRMLS_CC);
 			PHALCON_SCONCAT_SV(phql, " ORDER BY ", joined_items);
 		} else {
 			PHALCON_SCONCAT_SV(phql, " ORDER BY ", order);
@@ -1843,26 +2338,53 @@ PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getPhql){
 }
 
 /**
- * Returns the query built
+ * Returns the query built. The query receives the AST of the statement built from the
+ * parts of the builder and is prepared right away, the PHQL is only generated by getPhql()
  *
  * @return Phalcon\Mvc\Model\Query
  */
 PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getQuery){
 
-	zval *phql = NULL, *dependency_injector, *bind_params;
-	zval *bind_types;
+	zval *dependency_injector = NULL, *models, *ast, *phql = NULL, *bind_params;
+	zval *bind_types, *with;
 
 	PHALCON_MM_GROW();
 
-	/** 
-	 * Process the PHQL
-	 */
-	PHALCON_CALL_METHOD(&phql, this_ptr, "getphql");
-	
 	dependency_injector = phalcon_fetch_nproperty_this(this_ptr, SL("_dependencyInjector"), PH_NOISY TSRMLS_CC);
-	
-	object_init_ex(return_value, phalcon_mvc_model_query_ce);
-	PHALCON_CALL_METHOD(NULL, return_value, "__construct", phql, dependency_injector);
+	if (Z_TYPE_P(dependency_injector) != IS_OBJECT) {
+		dependency_injector = NULL;
+		PHALCON_CALL_CE_STATIC(&dependency_injector, phalcon_di_ce, "getdefault");
+		phalcon_update_property_this(this_ptr, SL("_dependencyInjector"), dependency_injector TSRMLS_CC);
+	}
+
+	if (Z_TYPE_P(dependency_injector) == IS_OBJECT) {
+		models = phalcon_fetch_nproperty_this(this_ptr, SL("_models"), PH_NOISY TSRMLS_CC);
+		if (phalcon_mvc_model_query_builder_check_models(models TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+
+		PHALCON_INIT_VAR(ast);
+		phalcon_mvc_model_query_builder_select_ast(ast, this_ptr, models, dependency_injector TSRMLS_CC);
+		if (EG(exception)) {
+			RETURN_MM();
+		}
+
+		object_init_ex(return_value, phalcon_mvc_model_query_ce);
+		PHALCON_CALL_METHOD(NULL, return_value, "__construct", PHALCON_GLOBAL(z_null), dependency_injector);
+
+		if (phalcon_mvc_model_query_prepare_select(return_value, ast TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+	} else {
+		/** 
+		 * Without a container there are no models to prepare the statement for, the query
+		 * gets the PHQL
+		 */
+		PHALCON_CALL_METHOD(&phql, this_ptr, "getphql");
+
+		object_init_ex(return_value, phalcon_mvc_model_query_ce);
+		PHALCON_CALL_METHOD(NULL, return_value, "__construct", phql, dependency_injector);
+	}
 	
 	bind_params = phalcon_fetch_nproperty_this(this_ptr, SL("_bindParams"), PH_NOISY TSRMLS_CC);
 	
@@ -1882,6 +2404,14 @@ PHP_METHOD(Phalcon_Mvc_Model_Query_Builder, getQuery){
 		PHALCON_CALL_METHOD(NULL, return_value, "setbindtypes", bind_types);
 	}
 	
+	with = phalcon_fetch_nproperty_this(this_ptr, SL("_with"), PH_NOISY TSRMLS_CC);
+	
+	/** 
+	 * Pass the relations to eager load
+	 */
+	if (Z_TYPE_P(with) != IS_NULL) {
+		PHALCON_CALL_METHOD(NULL, return_value, "with", with);
+	}
+	
 	RETURN_MM();
 }
-
@@ -30,7 +30,6 @@ static zval *phql_ret_literal_zval(int type, phql_parser_token *T)
 	add_assoc_long(ret, phalcon_interned_type, type);
 	if (T) {
 		add_assoc_stringl(ret, phalcon_interned_value, T->token, T->token_len, 0);
-		efree(T);
 	}
 
 	return ret;
@@ -44,7 +43,6 @@ static zval *phql_ret_placeholder_zval(int type, phql_parser_token *T)
 	array_init_size(ret, 2);
 	add_assoc_long(ret, phalcon_interned_type, type);
 	add_assoc_stringl(ret, phalcon_interned_value, T->token, T->token_len, 0);
-	efree(T);
 
 	return ret;
 }
@@ -60,16 +58,13 @@ static zval *phql_ret_qualified_name(phql_parser_token *A, phql_parser_token *B,
 
 	if (A != NULL) {
 		add_assoc_stringl(ret, phalcon_interned_ns_alias, A->token, A->token_len, 0);
-		efree(A);
 	}
 
 	if (B != NULL) {
 		add_assoc_stringl(ret, phalcon_interned_domain, B->token, B->token_len, 0);
-		efree(B);
 	}
 
 	add_assoc_stringl(ret, phalcon_interned_name, C->token, C->token_len, 0);
-	efree(C);
 
 	return ret;
 }
@@ -85,11 +80,9 @@ static zval *phql_ret_raw_qualified_name(phql_parser_token *A, phql_parser_token
 	if (B != NULL) {
 		add_assoc_stringl(ret, phalcon_interned_domain, A->token, A->token_len, 0);
 		add_assoc_stringl(ret, phalcon_interned_name, B->token, B->token_len, 0);
-		efree(B);
 	} else {
 		add_assoc_stringl(ret, phalcon_interned_name, A->token, A->token_len, 0);
 	}
-	efree(A);
 
 	return ret;
 }
@@ -329,11 +322,9 @@ static zval *phql_ret_column_item(int type, zval *column, phql_parser_token *ide
 	}
 	if (identifier_column) {
 		add_assoc_stringl(ret, phalcon_interned_column, identifier_column->token, identifier_column->token_len, 0);
-		efree(identifier_column);
 	}
 	if (alias) {
 		add_assoc_stringl(ret, phalcon_interned_alias, alias->token, alias->token_len, 0);
-		efree(alias);
 	}
 
 	return ret;
@@ -348,7 +339,6 @@ static zval *phql_ret_assoc_name(zval *qualified_name, phql_parser_token *alias)
 	add_assoc_zval(ret, phalcon_interned_qualifiedName, qualified_name);
 	if (alias) {
 		add_assoc_stringl(ret, phalcon_interned_alias, alias->token, alias->token_len, 0);
-		efree(alias);
 	}
 
 	return ret;
@@ -412,7 +402,6 @@ static zval *phql_ret_func_call(phql_parser_token *name, zval *arguments, zval *
 	array_init_size(ret, 4);
 	add_assoc_long(ret, phalcon_interned_type, PHQL_T_FCALL);
 	add_assoc_stringl(ret, phalcon_interned_name, name->token, name->token_len, 0);
-	efree(name);
 
 	if (arguments) {
 		add_assoc_zval(ret, phalcon_interned_arguments, arguments);
@@ -1151,7 +1140,6 @@ static void yy_destructor(YYCODETYPE yymajor, YYMINORTYPE *yypminor){
 		if ((yypminor->yy0)->free_flag) {
 			efree((yypminor->yy0)->token);
 		}
-		efree((yypminor->yy0));
 	}
 }
 /* #line 1158 "parser.c" */
@@ -2754,7 +2742,7 @@ static void phql_parse_with_token(void* phql_parser, int opcode, int parsercode,
 
 	phql_parser_token *pToken;
 
-	pToken = emalloc(sizeof(phql_parser_token));
+	pToken = phalcon_arena_alloc(&parser_status->arena, sizeof(phql_parser_token));
 	pToken->opcode = opcode;
 	pToken->token = token->value;
 	pToken->token_len = token->len;
@@ -2826,9 +2814,9 @@ int phql_parse_phql(zval *result, zval *phql TSRMLS_DC) {
 int phql_internal_parse_phql(zval **result, char *phql, unsigned int phql_length, zval **error_msg TSRMLS_DC) {
 
 	zend_phalcon_globals *phalcon_globals_ptr = PHALCON_VGLOBAL;
-	phql_parser_status *parser_status = NULL;
+	phql_parser_status parser_status_s, *parser_status = &parser_status_s;
 	int scanner_status, status = SUCCESS, error_length, cache_level;
-	phql_scanner_state *state;
+	phql_scanner_state state_s, *state = &state_s;
 	phql_scanner_token token;
 	unsigned long phql_key = 0;
 	void* phql_parser;
@@ -2862,8 +2850,11 @@ int phql_internal_parse_phql(zval **result, char *phql, unsigned int phql_length
 		return FAILURE;
 	}
 
-	parser_status = emalloc(sizeof(phql_parser_status));
-	state = emalloc(sizeof(phql_scanner_state));
+	/**
+	 * The status, the scanner state and the tokens passed to the parser don't outlive
+	 * this call, tokens are bump-allocated from an arena released at the end of the parse
+	 */
+	phalcon_arena_init(&parser_status->arena, PHQL_ARENA_BLOCK_SIZE);
 
 	parser_status->status = PHQL_PARSING_OK;
 	parser_status->scanner_state = state;
@@ -3230,8 +3221,7 @@ int phql_internal_parse_phql(zval **result, char *phql, unsigned int phql_length
 		}
 	}
 
-	efree(parser_status);
-	efree(state);
+	phalcon_arena_destroy(&parser_status->arena);
 
 	return status;
 }
@@ -61,7 +61,6 @@ static zval *phql_ret_literal_zval(int type, phql_parser_token *T)
 	add_assoc_long(ret, phalcon_interned_type, type);
 	if (T) {
 		add_assoc_stringl(ret, phalcon_interned_value, T->token, T->token_len, 0);
-		efree(T);
 	}
 
 	return ret;
@@ -75,7 +74,6 @@ static zval *phql_ret_placeholder_zval(int type, phql_parser_token *T)
 	array_init_size(ret, 2);
 	add_assoc_long(ret, phalcon_interned_type, type);
 	add_assoc_stringl(ret, phalcon_interned_value, T->token, T->token_len, 0);
-	efree(T);
 
 	return ret;
 }
@@ -91,16 +89,13 @@ static zval *phql_ret_qualified_name(phql_parser_token *A, phql_parser_token *B,
 
 	if (A != NULL) {
 		add_assoc_stringl(ret, phalcon_interned_ns_alias, A->token, A->token_len, 0);
-		efree(A);
 	}
 
 	if (B != NULL) {
 		add_assoc_stringl(ret, phalcon_interned_domain, B->token, B->token_len, 0);
-		efree(B);
 	}
 
 	add_assoc_stringl(ret, phalcon_interned_name, C->token, C->token_len, 0);
-	efree(C);
 
 	return ret;
 }
@@ -116,11 +111,9 @@ static zval *phql_ret_raw_qualified_name(phql_parser_token *A, phql_parser_token
 	if (B != NULL) {
 		add_assoc_stringl(ret, phalcon_interned_domain, A->token, A->token_len, 0);
 		add_assoc_stringl(ret, phalcon_interned_name, B->token, B->token_len, 0);
-		efree(B);
 	} else {
 		add_assoc_stringl(ret, phalcon_interned_name, A->token, A->token_len, 0);
 	}
-	efree(A);
 
 	return ret;
 }
@@ -360,11 +353,9 @@ static zval *phql_ret_column_item(int type, zval *column, phql_parser_token *ide
 	}
 	if (identifier_column) {
 		add_assoc_stringl(ret, phalcon_interned_column, identifier_column->token, identifier_column->token_len, 0);
-		efree(identifier_column);
 	}
 	if (alias) {
 		add_assoc_stringl(ret, phalcon_interned_alias, alias->token, alias->token_len, 0);
-		efree(alias);
 	}
 
 	return ret;
@@ -379,7 +370,6 @@ static zval *phql_ret_assoc_name(zval *qualified_name, phql_parser_token *alias)
 	add_assoc_zval(ret, phalcon_interned_qualifiedName, qualified_name);
 	if (alias) {
 		add_assoc_stringl(ret, phalcon_interned_alias, alias->token, alias->token_len, 0);
-		efree(alias);
 	}
 
 	return ret;
@@ -443,7 +433,6 @@ static zval *phql_ret_func_call(phql_parser_token *name, zval *arguments, zval *
 	array_init_size(ret, 4);
 	add_assoc_long(ret, phalcon_interned_type, PHQL_T_FCALL);
 	add_assoc_stringl(ret, phalcon_interned_name, name->token, name->token_len, 0);
-	efree(name);
 
 	if (arguments) {
 		add_assoc_zval(ret, phalcon_interned_arguments, arguments);
@@ -530,7 +519,6 @@ static zval *phql_ret_func_call(phql_parser_token *name, zval *arguments, zval *
 		if ($$->free_flag) {
 			efree($$->token);
 		}
-		efree($$);
 	}
 }
 
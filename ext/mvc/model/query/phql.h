@@ -23,6 +23,8 @@
 #include "php_phalcon.h"
 #include "mvc/model/query/scanner.h"
 
+#include "kernel/arena.h"
+
 typedef struct _phql_parser_token {
 	char *token;
 	int opcode;
@@ -40,8 +42,15 @@ typedef struct _phql_parser_status {
 	char *syntax_error;
 	zend_uint syntax_error_len;
 	zend_bool enable_literals;
+	phalcon_arena arena;
 } phql_parser_status;
 
+/**
+ * Parser tokens are only needed for values (identifiers, literals, placeholders), the PHQL
+ * statements of the unit tests have 17 of them at most, so a parse fits in a single block
+ */
+#define PHQL_ARENA_BLOCK_SIZE (32 * ZEND_MM_ALIGNED_SIZE(sizeof(phql_parser_token)))
+
 #define PHQL_PARSING_OK 1
 #define PHQL_PARSING_FAILED 0
 
@@ -20,6 +20,13 @@
 #include "mvc/model/resultset.h"
 #include "mvc/model/resultsetinterface.h"
 #include "mvc/model/exception.h"
+#include "mvc/model/manager.h"
+#include "mvc/model/query.h"
+#include "mvc/model/resultset/simple.h"
+#include "mvc/model.h"
+
+#include <ext/standard/php_smart_str.h>
+#include <ext/standard/php_var.h>
 
 #include "kernel/main.h"
 #include "kernel/memory.h"
@@ -27,7 +34,9 @@
 #include "kernel/operators.h"
 #include "kernel/fcall.h"
 #include "kernel/array.h"
+#include "kernel/concat.h"
 #include "kernel/exception.h"
+#include "kernel/hash.h"
 
 #include "internal/arginfo.h"
 
@@ -79,7 +88,9 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, getHydrateMode);
 PHP_METHOD(Phalcon_Mvc_Model_Resultset, getCache);
 PHP_METHOD(Phalcon_Mvc_Model_Resultset, current);
 PHP_METHOD(Phalcon_Mvc_Model_Resultset, getMessages);
+PHP_METHOD(Phalcon_Mvc_Model_Resultset, _prepareBulkOperation);
 PHP_METHOD(Phalcon_Mvc_Model_Resultset, delete);
+PHP_METHOD(Phalcon_Mvc_Model_Resultset, update);
 PHP_METHOD(Phalcon_Mvc_Model_Resultset, filter);
 
 static const zend_function_entry phalcon_mvc_model_resultset_method_entry[] = {
@@ -102,7 +113,9 @@ static const zend_function_entry phalcon_mvc_model_resultset_method_entry[] = {
 	PHP_ME(Phalcon_Mvc_Model_Resultset, getCache, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Resultset, current, arginfo_iterator_current, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Resultset, getMessages, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Resultset, _prepareBulkOperation, NULL, ZEND_ACC_PROTECTED)
 	PHP_ME(Phalcon_Mvc_Model_Resultset, delete, arginfo_phalcon_mvc_model_resultset_delete, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Resultset, update, arginfo_phalcon_mvc_model_resultset_update, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Resultset, filter, arginfo_phalcon_mvc_model_resultset_filter, ZEND_ACC_PUBLIC)
 	PHP_FE_END
 };
@@ -122,6 +135,7 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Resultset){
 	zend_declare_property_null(phalcon_mvc_model_resultset_ce, SL("_count"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_resultset_ce, SL("_activeRow"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_resultset_ce, SL("_rows"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_resultset_ce, SL("_prefetched"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_resultset_ce, SL("_errorMessages"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_long(phalcon_mvc_model_resultset_ce, SL("_hydrateMode"), 0, ZEND_ACC_PROTECTED TSRMLS_CC);
 
@@ -130,6 +144,7 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Resultset){
 	zend_declare_class_constant_long(phalcon_mvc_model_resultset_ce, SL("HYDRATE_RECORDS"), 0 TSRMLS_CC);
 	zend_declare_class_constant_long(phalcon_mvc_model_resultset_ce, SL("HYDRATE_OBJECTS"), 2 TSRMLS_CC);
 	zend_declare_class_constant_long(phalcon_mvc_model_resultset_ce, SL("HYDRATE_ARRAYS"), 1 TSRMLS_CC);
+	zend_declare_class_constant_long(phalcon_mvc_model_resultset_ce, SL("HYDRATE_READONLY"), 3 TSRMLS_CC);
 
 	zend_class_implements(phalcon_mvc_model_resultset_ce TSRMLS_CC, 6, phalcon_mvc_model_resultsetinterface_ce, zend_ce_iterator, spl_ce_SeekableIterator, spl_ce_Countable, zend_ce_arrayaccess, zend_ce_serializable);
 
@@ -158,6 +173,18 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, key){
 	RETURN_MEMBER(this_ptr, "_pointer");
 }
 
+/**
+ * Keeps the rows fetched from the cursor, Resultset\Simple may store them by column
+ */
+static void phalcon_mvc_model_resultset_store_rows(zval *this_ptr, zval *rows TSRMLS_DC) {
+
+	if (instanceof_function(Z_OBJCE_P(this_ptr), phalcon_mvc_model_resultset_simple_ce TSRMLS_CC)) {
+		phalcon_mvc_model_resultset_simple_store_rows(this_ptr, rows TSRMLS_CC);
+	} else {
+		phalcon_update_property_this(this_ptr, SL("_rows"), rows TSRMLS_CC);
+	}
+}
+
 /**
  * Rewinds resultset to its beginning
  *
@@ -179,6 +206,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, rewind){
 	
 			zval *active_row = phalcon_fetch_nproperty_this(this_ptr, SL("_activeRow"), PH_NOISY TSRMLS_CC);
 			if (Z_TYPE_P(active_row) != IS_NULL) {
+				phalcon_update_property_null(this_ptr, SL("_prefetched") TSRMLS_CC);
 				PHALCON_MM_GROW();
 				PHALCON_CALL_METHOD(NULL, result, "dataseek", z_zero);
 				PHALCON_MM_RESTORE();
@@ -199,7 +227,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, rewind){
 					zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(r), NULL);
 				}
 
-				phalcon_update_property_this(this_ptr, SL("_rows"), r TSRMLS_CC);
+				phalcon_mvc_model_resultset_store_rows(this_ptr, r TSRMLS_CC);
 				zval_ptr_dtor(&r);
 			}
 		}
@@ -248,6 +276,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, seek){
 			 */
 			PHALCON_OBS_VAR(result);
 			phalcon_read_property(&result, this_ptr, SL("_result"), PH_NOISY TSRMLS_CC);
+			phalcon_update_property_null(this_ptr, SL("_prefetched") TSRMLS_CC);
 			PHALCON_CALL_METHOD(NULL, result, "dataseek", position);
 
 		} else {
@@ -266,7 +295,13 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, seek){
 				phalcon_read_property(&result, this_ptr, SL("_result"), PH_NOISY TSRMLS_CC);
 				if (PHALCON_IS_NOT_FALSE(result)) {
 					PHALCON_CALL_METHOD(&rows, result, "fetchall");
-					phalcon_update_property_zval(this_ptr, SL("_rows"), rows TSRMLS_CC);
+					phalcon_mvc_model_resultset_store_rows(this_ptr, rows TSRMLS_CC);
+
+					/**
+					 * Rows stored by column leave _rows as false, only _pointer is moved then
+					 */
+					PHALCON_OBS_NVAR(rows);
+					phalcon_read_property(&rows, this_ptr, SL("_rows"), PH_NOISY TSRMLS_CC);
 				}
 			}
 
@@ -344,7 +379,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, count){
 				phalcon_read_property_this(&result, this_ptr, SL("_result"), PH_NOISY TSRMLS_CC);
 				if (Z_TYPE_P(result) == IS_OBJECT) {
 					PHALCON_CALL_METHOD(&rows, result, "fetchall");
-					phalcon_update_property_this(this_ptr, SL("_rows"), rows TSRMLS_CC);
+					phalcon_mvc_model_resultset_store_rows(this_ptr, rows TSRMLS_CC);
 				}
 			}
 	
@@ -616,7 +651,575 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, getMessages){
 }
 
 /**
- * Deletes every record in the resultset
+ * Events fired by Phalcon\Mvc\Model::delete() for every record
+ */
+static const char *phalcon_mvc_model_resultset_delete_events[] = {
+	"beforedelete", "afterdelete", NULL
+};
+
+/**
+ * Events fired by Phalcon\Mvc\Model::update() for every record
+ */
+static const char *phalcon_mvc_model_resultset_update_events[] = {
+	"beforevalidation", "beforevalidationonupdate", "validation", "onvalidationfails",
+	"aftervalidationonupdate", "aftervalidation", "beforesave", "beforeupdate",
+	"afterupdate", "aftersave", "notsave", NULL
+};
+
+/**
+ * Builds "field IN (?, ?, ...)" for a chunk of primary key values, every placeholder uses the
+ * bind type of the primary key
+ */
+static void phalcon_mvc_model_resultset_in_condition(zval *conditions, zval *bind_types, zval *field, zval *bind_type, long int number)
+{
+	smart_str sql = { NULL, 0, 0 };
+	long int i;
+
+	smart_str_appendl(&sql, Z_STRVAL_P(field), Z_STRLEN_P(field));
+	smart_str_appendl(&sql, " IN (", 5);
+
+	for (i = 0; i < number; ++i) {
+		if (i) {
+			smart_str_appendl(&sql, ", ?", 3);
+		} else {
+			smart_str_appendc(&sql, '?');
+		}
+
+		Z_ADDREF_P(bind_type);
+		add_next_index_zval(bind_types, bind_type);
+	}
+
+	smart_str_appendc(&sql, ')');
+	smart_str_0(&sql);
+
+	ZVAL_STRINGL(conditions, sql.c, sql.len, 0);
+}
+
+/**
+ * Translates the attributes passed to update() into columns, values and bind types skipping the
+ * automatic update attributes. Returns NULL if an empty value is assigned to a not null column,
+ * those records must be updated one by one to produce the validation messages
+ */
+static void phalcon_mvc_model_resultset_update_data(zval *return_value, zval *record, zval *meta_data, zval *data TSRMLS_DC)
+{
+	zval *column_map = NULL, *bind_data_types = NULL, *automatic_attributes = NULL;
+	zval *not_null = NULL, *fields, *values, *types, *attribute = NULL, *value = NULL;
+	zval *field = NULL, *field_type = NULL, *exception_message = NULL;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+
+	PHALCON_MM_GROW();
+
+	if (PHALCON_GLOBAL(orm).column_renaming) {
+		PHALCON_CALL_METHOD(&column_map, meta_data, "getreversecolumnmap", record);
+	} else {
+		PHALCON_INIT_VAR(column_map);
+	}
+
+	PHALCON_CALL_METHOD(&bind_data_types, meta_data, "getbindtypes", record);
+	PHALCON_CALL_METHOD(&automatic_attributes, meta_data, "getautomaticupdateattributes", record);
+	if (PHALCON_GLOBAL(orm).not_null_validations) {
+		PHALCON_CALL_METHOD(&not_null, meta_data, "getnotnullattributes", record);
+	} else {
+		PHALCON_INIT_VAR(not_null);
+	}
+
+	PHALCON_INIT_VAR(fields);
+	array_init(fields);
+
+	PHALCON_INIT_VAR(values);
+	array_init(values);
+
+	PHALCON_INIT_VAR(types);
+	array_init(types);
+
+	phalcon_is_iterable(data, &ah0, &hp0, 0, 0);
+
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+		PHALCON_GET_HKEY(attribute, ah0, hp0);
+		PHALCON_GET_HVALUE(value);
+
+		if (Z_TYPE_P(column_map) == IS_ARRAY) { 
+			if (!phalcon_array_isset(column_map, attribute)) {
+				PHALCON_INIT_NVAR(exception_message);
+				PHALCON_CONCAT_SVS(exception_message, "Column '", attribute, "' isn't part of the column map");
+				PHALCON_THROW_EXCEPTION_ZVAL(phalcon_mvc_model_exception_ce, exception_message);
+				return;
+			}
+
+			PHALCON_OBS_NVAR(field);
+			phalcon_array_fetch(&field, column_map, attribute, PH_NOISY);
+		} else {
+			PHALCON_CPY_WRT(field, attribute);
+		}
+
+		if (!phalcon_array_isset(bind_data_types, field)) {
+			PHALCON_INIT_NVAR(exception_message);
+			PHALCON_CONCAT_SVS(exception_message, "Column '", field, "' have not defined a bind data type");
+			PHALCON_THROW_EXCEPTION_ZVAL(phalcon_mvc_model_exception_ce, exception_message);
+			return;
+		}
+
+		if (Z_TYPE_P(not_null) == IS_ARRAY && Z_TYPE_P(value) != IS_OBJECT && PHALCON_IS_EMPTY(value)) {
+			if (phalcon_fast_in_array(field, not_null TSRMLS_CC)) {
+				RETURN_MM();
+			}
+		}
+
+		if (!phalcon_array_isset(automatic_attributes, field)) {
+			PHALCON_OBS_NVAR(field_type);
+			phalcon_array_fetch(&field_type, bind_data_types, field, PH_NOISY);
+
+			phalcon_array_append(&fields, field, 0);
+			phalcon_array_append(&values, value, 0);
+			phalcon_array_append(&types, field_type, 0);
+		}
+
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+
+	array_init_size(return_value, 3);
+	phalcon_array_update_string(&return_value, SL("fields"), fields, PH_COPY);
+	phalcon_array_update_string(&return_value, SL("values"), values, PH_COPY);
+	phalcon_array_update_string(&return_value, SL("types"), types, PH_COPY);
+
+	RETURN_MM();
+}
+
+/**
+ * Removes the records of the model from the identity map and bumps the version of its table after
+ * a bulk delete/update, the rows changed in the database weren't loaded one by one
+ */
+static int phalcon_mvc_model_resultset_written(zval *manager, zval *record TSRMLS_DC)
+{
+	zval *model_name, *params[1];
+	int status;
+
+	if (Z_TYPE_P(manager) != IS_OBJECT || !instanceof_function(Z_OBJCE_P(manager), phalcon_mvc_model_manager_ce TSRMLS_CC)) {
+		return SUCCESS;
+	}
+
+	MAKE_STD_ZVAL(model_name);
+	phalcon_get_class(model_name, record, 0 TSRMLS_CC);
+
+	params[0] = model_name;
+	status = phalcon_call_method(NULL, manager, "clearidentitymap", 1, params TSRMLS_CC);
+	zval_ptr_dtor(&model_name);
+
+	if (status == SUCCESS && phalcon_mvc_model_manager_has_versions(manager TSRMLS_CC)) {
+		params[0] = record;
+		status = phalcon_call_method(NULL, manager, "bumptableversion", 1, params TSRMLS_CC);
+	}
+
+	return status;
+}
+
+/**
+ * Deletes, or updates with the passed data, the rows of the resultset without hydrating the records:
+ * the primary keys held by the resultset are sent in chunks, DELETE/UPDATE ... WHERE pk IN (...), sized
+ * to the bind parameters the dialect accepts. The rows of a sharded model are grouped by shard, every
+ * statement runs in the shard of its keys. Returns NULL if the resultset can't be processed this way
+ */
+static void phalcon_mvc_model_resultset_statement(zval *return_value, zval *this_ptr, zval *data TSRMLS_DC)
+{
+	zval *model, *bulk = NULL, *connection, *manager, *meta_data, *table, *attribute_field;
+	zval *escaped_field, *bind_type, *max_list_params, *max_bind_params = NULL, *dialect = NULL;
+	zval *update_data = NULL, *fields = NULL, *values = NULL, *types = NULL, *keys = NULL;
+	zval *shards = NULL, *shard_key = NULL, *shard_values = NULL, *shard_service = NULL;
+	zval *dependency_injector = NULL, *shard_connection = NULL, *groups, *group, *connections;
+	zval *chunk = NULL, *conditions = NULL, *bind_types = NULL, *where = NULL, *status = NULL;
+	zval **key, **shard_value, *params[5];
+	HashTable *ah0, *ah1;
+	HashPosition hp0, hp1;
+	zval **hd;
+	long int chunk_size, max_bind;
+	int transaction;
+
+	PHALCON_MM_GROW();
+
+	if (!instanceof_function(Z_OBJCE_P(this_ptr), phalcon_mvc_model_resultset_simple_ce TSRMLS_CC)) {
+		RETURN_MM();
+	}
+
+	model = phalcon_fetch_nproperty_this(this_ptr, SL("_model"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(model) != IS_OBJECT || !instanceof_function(Z_OBJCE_P(model), phalcon_mvc_model_ce TSRMLS_CC)) {
+		RETURN_MM();
+	}
+
+	PHALCON_CALL_METHOD(&bulk, this_ptr, "_preparebulkoperation", model, data ? PHALCON_GLOBAL(z_true) : PHALCON_GLOBAL(z_false));
+	if (Z_TYPE_P(bulk) != IS_ARRAY) {
+		RETURN_MM();
+	}
+
+	phalcon_array_isset_string_fetch(&connection, bulk, SS("connection"));
+	phalcon_array_isset_string_fetch(&manager, bulk, SS("manager"));
+	phalcon_array_isset_string_fetch(&meta_data, bulk, SS("metaData"));
+	phalcon_array_isset_string_fetch(&table, bulk, SS("table"));
+	phalcon_array_isset_string_fetch(&attribute_field, bulk, SS("attribute"));
+	phalcon_array_isset_string_fetch(&escaped_field, bulk, SS("field"));
+	phalcon_array_isset_string_fetch(&bind_type, bulk, SS("bindType"));
+	phalcon_array_isset_string_fetch(&max_list_params, bulk, SS("maxBindParams"));
+
+	PHALCON_CALL_METHOD(&dialect, connection, "getdialect");
+	PHALCON_CALL_METHOD(&max_bind_params, dialect, "getmaxbindparams");
+
+	chunk_size = phalcon_get_intval(max_list_params);
+	max_bind   = phalcon_get_intval(max_bind_params);
+
+	if (data) {
+		PHALCON_INIT_VAR(update_data);
+		phalcon_mvc_model_resultset_update_data(update_data, model, meta_data, data TSRMLS_CC);
+		if (Z_TYPE_P(update_data) != IS_ARRAY) {
+			RETURN_MM();
+		}
+
+		phalcon_array_isset_string_fetch(&fields, update_data, SS("fields"));
+		phalcon_array_isset_string_fetch(&values, update_data, SS("values"));
+		phalcon_array_isset_string_fetch(&types, update_data, SS("types"));
+
+		/** 
+		 * Every passed attribute is automatic, there is nothing to write
+		 */
+		if (!zend_hash_num_elements(Z_ARRVAL_P(fields))) {
+			RETURN_MM_TRUE;
+		}
+
+		/** 
+		 * The values of the SET clause take bind parameters too
+		 */
+		max_bind -= zend_hash_num_elements(Z_ARRVAL_P(values));
+	}
+
+	if (max_bind < chunk_size) {
+		chunk_size = max_bind;
+	}
+
+	if (chunk_size < 1) {
+		chunk_size = 1;
+	}
+
+	/** 
+	 * The primary keys are read from the rows without building the records
+	 */
+	PHALCON_CALL_METHOD(&keys, this_ptr, "pluck", attribute_field);
+	if (Z_TYPE_P(keys) != IS_ARRAY || !zend_hash_num_elements(Z_ARRVAL_P(keys))) {
+		RETURN_MM_TRUE;
+	}
+
+	/** 
+	 * The keys of a sharded model are grouped by the shard that holds their rows
+	 */
+	PHALCON_INIT_VAR(groups);
+	array_init(groups);
+
+	if (Z_TYPE_P(manager) == IS_OBJECT && instanceof_function(Z_OBJCE_P(manager), phalcon_mvc_model_manager_ce TSRMLS_CC)) {
+		PHALCON_CALL_METHOD(&shards, manager, "getshards", model);
+	}
+
+	if (shards && Z_TYPE_P(shards) == IS_ARRAY) {
+		PHALCON_CALL_METHOD(&shard_key, manager, "getshardkey", model);
+		PHALCON_CALL_METHOD(&shard_values, this_ptr, "pluck", shard_key);
+		PHALCON_CALL_METHOD(&dependency_injector, manager, "getdi");
+
+		phalcon_is_iterable(keys, &ah0, &hp0, 0, 0);
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(shard_values), &hp1);
+
+		while (zend_hash_get_current_data_ex(ah0, (void**) &key, &hp0) == SUCCESS
+			&& zend_hash_get_current_data_ex(Z_ARRVAL_P(shard_values), (void**) &shard_value, &hp1) == SUCCESS
+		) {
+			PHALCON_CALL_METHOD(&shard_service, manager, "getshardservice", model, *shard_value);
+
+			if (!phalcon_array_isset_fetch(&group, groups, shard_service)) {
+				MAKE_STD_ZVAL(group);
+				array_init(group);
+				phalcon_array_update_zval(&groups, shard_service, group, 0);
+			}
+
+			Z_ADDREF_PP(key);
+			add_next_index_zval(group, *key);
+
+			zend_hash_move_forward_ex(ah0, &hp0);
+			zend_hash_move_forward_ex(Z_ARRVAL_P(shard_values), &hp1);
+		}
+	} else {
+		phalcon_array_append(&groups, keys, PH_COPY);
+	}
+
+	/** 
+	 * Several statements are committed together once all of them succeeded
+	 */
+	transaction = zend_hash_num_elements(Z_ARRVAL_P(groups)) > 1 || zend_hash_num_elements(Z_ARRVAL_P(keys)) > chunk_size;
+
+	PHALCON_INIT_VAR(connections);
+	array_init(connections);
+
+	phalcon_is_iterable(groups, &ah0, &hp0, 0, 0);
+
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+
+		group = *hd;
+
+		if (dependency_injector) {
+			zval service = phalcon_get_current_key_w(ah0, &hp0);
+
+			PHALCON_INIT_NVAR(shard_service);
+			ZVAL_ZVAL(shard_service, &service, 1, 0);
+
+			PHALCON_CALL_METHOD(&shard_connection, dependency_injector, "getshared", shard_service);
+			if (Z_TYPE_P(shard_connection) != IS_OBJECT) {
+				phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC);
+				PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Invalid injected connection service");
+				return;
+			}
+
+			connection = shard_connection;
+		}
+
+		if (transaction && phalcon_mvc_model_query_begin_connection(connections, connection TSRMLS_CC) == FAILURE) {
+			phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC);
+			RETURN_MM();
+		}
+
+		PHALCON_INIT_NVAR(chunk);
+		array_init(chunk);
+
+		phalcon_is_iterable(group, &ah1, &hp1, 0, 0);
+
+		while (1) {
+
+			if (zend_hash_get_current_data_ex(ah1, (void**) &key, &hp1) == SUCCESS) {
+				Z_ADDREF_PP(key);
+				add_next_index_zval(chunk, *key);
+				zend_hash_move_forward_ex(ah1, &hp1);
+
+				if (zend_hash_num_elements(Z_ARRVAL_P(chunk)) < chunk_size) {
+					continue;
+				}
+			}
+
+			if (!zend_hash_num_elements(Z_ARRVAL_P(chunk))) {
+				break;
+			}
+
+			PHALCON_INIT_NVAR(conditions);
+
+			PHALCON_INIT_NVAR(bind_types);
+			array_init_size(bind_types, zend_hash_num_elements(Z_ARRVAL_P(chunk)));
+
+			phalcon_mvc_model_resultset_in_condition(conditions, bind_types, escaped_field, bind_type, zend_hash_num_elements(Z_ARRVAL_P(chunk)));
+
+			PHALCON_OBSERVE_OR_NULLIFY_PPZV(&status);
+			if (data) {
+				PHALCON_INIT_NVAR(where);
+				array_init_size(where, 3);
+				phalcon_array_update_string(&where, SL("conditions"), conditions, PH_COPY);
+				phalcon_array_update_string(&where, SL("bind"), chunk, PH_COPY);
+				phalcon_array_update_string(&where, SL("bindTypes"), bind_types, PH_COPY);
+
+				params[0] = table;
+				params[1] = fields;
+				params[2] = values;
+				params[3] = where;
+				params[4] = types;
+				if (phalcon_call_method(&status, connection, "update", 5, params TSRMLS_CC) == FAILURE) {
+					phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC);
+					RETURN_MM();
+				}
+			} else {
+				params[0] = table;
+				params[1] = conditions;
+				params[2] = chunk;
+				params[3] = bind_types;
+				if (phalcon_call_method(&status, connection, "delete", 4, params TSRMLS_CC) == FAILURE) {
+					phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC);
+					RETURN_MM();
+				}
+			}
+
+			if (!zend_is_true(status)) {
+				RETURN_MM_ON_FAILURE(phalcon_mvc_model_query_end_connections(connections, 0 TSRMLS_CC));
+				RETURN_MM_FALSE;
+			}
+
+			PHALCON_INIT_NVAR(chunk);
+			array_init(chunk);
+		}
+
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+
+	RETURN_MM_ON_FAILURE(phalcon_mvc_model_query_end_connections(connections, 1 TSRMLS_CC));
+
+	if (phalcon_mvc_model_resultset_written(manager, model TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+
+	RETURN_MM_TRUE;
+}
+
+/**
+ * Checks if a delete/update over the records of the resultset can be done with a single statement
+ * per chunk of primary keys. This is only possible when the model doesn't have per-record events,
+ * behaviors, virtual foreign keys and it has a single column primary key. Returns false or an array
+ * describing the operation
+ *
+ * @param Phalcon\Mvc\ModelInterface $record
+ * @param boolean $update
+ * @return array|boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Resultset, _prepareBulkOperation){
+
+	zval *record, *update, *manager = NULL, *observed = NULL, *relations = NULL;
+	zval *relation = NULL, *foreign_key = NULL, *meta_data = NULL, *primary_keys = NULL;
+	zval *primary_key, *bind_data_types = NULL, *bind_type, *column_map = NULL;
+	zval *attribute_field = NULL, *connection = NULL, *escaped_field = NULL;
+	zval *schema = NULL, *source = NULL, *table = NULL, *escaped_table = NULL;
+	zval *dialect = NULL, *max_bind_params = NULL;
+	const char **events;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 2, 0, &record, &update);
+	
+	PHALCON_CALL_METHOD(&manager, record, "getmodelsmanager");
+	
+	/** 
+	 * Records with events must be processed one by one
+	 */
+	if (PHALCON_GLOBAL(orm).events) {
+	
+		events = zend_is_true(update) ? phalcon_mvc_model_resultset_update_events : phalcon_mvc_model_resultset_delete_events;
+		for (; *events; ++events) {
+			if (phalcon_method_exists_ex(record, *events, strlen(*events) + 1 TSRMLS_CC) == SUCCESS) {
+				RETURN_MM_FALSE;
+			}
+		}
+	
+		PHALCON_CALL_METHOD(&observed, manager, "isobserved", record);
+		if (zend_is_true(observed)) {
+			RETURN_MM_FALSE;
+		}
+	}
+	
+	/** 
+	 * Virtual foreign keys are checked record by record
+	 */
+	if (PHALCON_GLOBAL(orm).virtual_foreign_keys) {
+		if (zend_is_true(update)) {
+			PHALCON_CALL_METHOD(&relations, manager, "getbelongsto", record);
+		} else {
+			PHALCON_CALL_METHOD(&relations, manager, "gethasoneandhasmany", record);
+		}
+	
+		if (Z_TYPE_P(relations) == IS_ARRAY) {
+	
+			phalcon_is_iterable(relations, &ah0, &hp0, 0, 0);
+	
+			while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+				PHALCON_GET_HVALUE(relation);
+	
+				PHALCON_CALL_METHOD(&foreign_key, relation, "getforeignkey");
+				if (PHALCON_IS_NOT_FALSE(foreign_key)) {
+					RETURN_MM_FALSE;
+				}
+	
+				zend_hash_move_forward_ex(ah0, &hp0);
+			}
+		}
+	}
+	
+	PHALCON_CALL_METHOD(&meta_data, record, "getmodelsmetadata");
+	PHALCON_CALL_METHOD(&primary_keys, meta_data, "getprimarykeyattributes", record);
+	if (Z_TYPE_P(primary_keys) != IS_ARRAY || phalcon_fast_count_int(primary_keys TSRMLS_CC) != 1) {
+		RETURN_MM_FALSE;
+	}
+	
+	PHALCON_OBS_VAR(primary_key);
+	phalcon_array_fetch_long(&primary_key, primary_keys, 0, PH_NOISY);
+	
+	PHALCON_CALL_METHOD(&bind_data_types, meta_data, "getbindtypes", record);
+	if (!phalcon_array_isset(bind_data_types, primary_key)) {
+		RETURN_MM_FALSE;
+	}
+	
+	PHALCON_OBS_VAR(bind_type);
+	phalcon_array_fetch(&bind_type, bind_data_types, primary_key, PH_NOISY);
+	
+	if (PHALCON_GLOBAL(orm).column_renaming) {
+		PHALCON_CALL_METHOD(&column_map, meta_data, "getcolumnmap", record);
+	}
+	
+	if (column_map && Z_TYPE_P(column_map) == IS_ARRAY) {
+		if (!phalcon_array_isset(column_map, primary_key)) {
+			RETURN_MM_FALSE;
+		}
+		PHALCON_OBS_VAR(attribute_field);
+		phalcon_array_fetch(&attribute_field, column_map, primary_key, PH_NOISY);
+	} else {
+		PHALCON_CPY_WRT(attribute_field, primary_key);
+	}
+	
+	PHALCON_CALL_METHOD(&connection, record, "getwriteconnection");
+	if (PHALCON_GLOBAL(db).escape_identifiers) {
+		PHALCON_CALL_METHOD(&escaped_field, connection, "escapeidentifier", primary_key);
+	} else {
+		PHALCON_CPY_WRT(escaped_field, primary_key);
+	}
+	
+	PHALCON_CALL_METHOD(&schema, record, "getschema");
+	PHALCON_CALL_METHOD(&source, record, "getsource");
+	if (zend_is_true(schema)) {
+		PHALCON_INIT_VAR(table);
+		array_init_size(table, 2);
+		phalcon_array_append(&table, schema, 0);
+		phalcon_array_append(&table, source, 0);
+	} else {
+		PHALCON_CPY_WRT(table, source);
+	}
+	
+	if (PHALCON_GLOBAL(db).escape_identifiers) {
+		PHALCON_CALL_METHOD(&escaped_table, connection, "escapeidentifier", table);
+	} else if (zend_is_true(schema)) {
+		PHALCON_INIT_VAR(escaped_table);
+		PHALCON_CONCAT_VSV(escaped_table, schema, ".", source);
+	} else {
+		PHALCON_CPY_WRT(escaped_table, source);
+	}
+	
+	PHALCON_CALL_METHOD(&dialect, connection, "getdialect");
+	PHALCON_CALL_METHOD(&max_bind_params, dialect, "getmaxlistparams");
+	
+	array_init_size(return_value, 9);
+	phalcon_array_update_string(&return_value, SL("connection"), connection, PH_COPY);
+	phalcon_array_update_string(&return_value, SL("manager"), manager, PH_COPY);
+	phalcon_array_update_string(&return_value, SL("table"), table, PH_COPY);
+	phalcon_array_update_string(&return_value, SL("escapedTable"), escaped_table, PH_COPY);
+	phalcon_array_update_string(&return_value, SL("metaData"), meta_data, PH_COPY);
+	phalcon_array_update_string(&return_value, SL("attribute"), attribute_field, PH_COPY);
+	phalcon_array_update_string(&return_value, SL("field"), escaped_field, PH_COPY);
+	phalcon_array_update_string(&return_value, SL("bindType"), bind_type, PH_COPY);
+	phalcon_array_update_string(&return_value, SL("maxBindParams"), max_bind_params, PH_COPY);
+	
+	RETURN_MM();
+}
+
+/**
+ * Deletes every record in the resultset. If the model doesn't have per-record events, behaviors
+ * or virtual foreign keys the rows are deleted using a DELETE ... WHERE pk IN (...) per chunk of
+ * primary keys, without hydrating the records unless a condition callback is passed
+ *
+ *<code>
+ * $robots = Robots::find("type = 'mechanical'");
+ * $robots->delete(function($robot){
+ *		return $robot->year < 1990;
+ * });
+ *</code>
  *
  * @param Closure $conditionCallback
  * @return boolean
@@ -625,7 +1228,11 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, delete){
 
 	zval *condition_callback = NULL, *transaction = NULL, *record = NULL;
 	zval *connection = NULL, *parameters = NULL, *status = NULL, *messages = NULL;
+	zval *bulk = NULL, *table = NULL, *attribute_field = NULL, *escaped_field = NULL;
+	zval *bind_type = NULL, *max_bind_params, *manager = NULL, *keys = NULL, *value = NULL;
+	zval *conditions = NULL, *bind_types = NULL;
 	zval *r0 = NULL;
+	long int chunk_size = 0;
 
 	PHALCON_MM_GROW();
 
@@ -635,8 +1242,25 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, delete){
 		condition_callback = PHALCON_GLOBAL(z_null);
 	}
 	
+	/** 
+	 * Without a condition callback the rows can be deleted without hydrating the records
+	 */
+	if (Z_TYPE_P(condition_callback) != IS_OBJECT) {
+		PHALCON_INIT_VAR(status);
+		phalcon_mvc_model_resultset_statement(status, this_ptr, NULL TSRMLS_CC);
+		if (EG(exception)) {
+			RETURN_MM();
+		}
+	
+		if (Z_TYPE_P(status) == IS_BOOL) {
+			RETURN_CTOR(status);
+		}
+	}
+	
 	PHALCON_INIT_VAR(transaction);
 	ZVAL_FALSE(transaction);
+	
+	PHALCON_INIT_VAR(bulk);
 	PHALCON_CALL_METHOD(NULL, this_ptr, "rewind");
 	
 	while (1) {
@@ -662,6 +1286,27 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, delete){
 	
 			PHALCON_INIT_NVAR(transaction);
 			ZVAL_TRUE(transaction);
+	
+			/** 
+			 * Check if the records can be deleted without loading them one by one
+			 */
+			PHALCON_CALL_METHOD(&bulk, this_ptr, "_preparebulkoperation", record, PHALCON_GLOBAL(z_false));
+			if (Z_TYPE_P(bulk) == IS_ARRAY) {
+				phalcon_array_isset_string_fetch(&manager, bulk, SS("manager"));
+				phalcon_array_isset_string_fetch(&table, bulk, SS("table"));
+				phalcon_array_isset_string_fetch(&attribute_field, bulk, SS("attribute"));
+				phalcon_array_isset_string_fetch(&escaped_field, bulk, SS("field"));
+				phalcon_array_isset_string_fetch(&bind_type, bulk, SS("bindType"));
+				phalcon_array_isset_string_fetch(&max_bind_params, bulk, SS("maxBindParams"));
+	
+				chunk_size = phalcon_get_intval(max_bind_params);
+				if (chunk_size < 1) {
+					chunk_size = 1;
+				}
+	
+				PHALCON_INIT_VAR(keys);
+				array_init(keys);
+			}
 		}
 	
 		/** 
@@ -676,34 +1321,326 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, delete){
 			PHALCON_INIT_NVAR(status);/**/
 			PHALCON_CALL_USER_FUNC_ARRAY(status, condition_callback, parameters);
 			if (PHALCON_IS_FALSE(status)) {
+				PHALCON_CALL_METHOD(NULL, this_ptr, "next");
 				continue;
 			}
 		}
 	
-		/** 
-		 * Try to delete the record
-		 */
-		PHALCON_CALL_METHOD(&status, record, "delete");
-		if (!zend_is_true(status)) {
+		if (Z_TYPE_P(bulk) == IS_ARRAY) {
+	
+			PHALCON_OBS_NVAR(value);
+			phalcon_read_property_zval(&value, record, attribute_field, PH_NOISY TSRMLS_CC);
+			phalcon_array_append(&keys, value, 0);
+	
 			/** 
-			 * Get the messages from the record that produce the error
+			 * The record is no longer in the database
 			 */
-			PHALCON_CALL_METHOD(&messages, record, "getmessages");
-			phalcon_update_property_this(this_ptr, SL("_errorMessages"), messages TSRMLS_CC);
+			phalcon_update_property_long(record, SL("_dirtyState"), 2 TSRMLS_CC);
 	
 			/** 
-			 * Rollback the transaction
+			 * Send the chunk of primary keys when it is full
 			 */
-			PHALCON_CALL_METHOD(NULL, connection, "rollback");
+			if (zend_hash_num_elements(Z_ARRVAL_P(keys)) >= chunk_size) {
 	
-			PHALCON_INIT_NVAR(transaction);
-			ZVAL_BOOL(transaction, 0);
-			break;
+				PHALCON_INIT_NVAR(conditions);
+	
+				PHALCON_INIT_NVAR(bind_types);
+				array_init_size(bind_types, chunk_size);
+	
+				phalcon_mvc_model_resultset_in_condition(conditions, bind_types, escaped_field, bind_type, zend_hash_num_elements(Z_ARRVAL_P(keys)));
+	
+				PHALCON_CALL_METHOD(&status, connection, "delete", table, conditions, keys, bind_types);
+				if (!zend_is_true(status)) {
+					PHALCON_CALL_METHOD(NULL, connection, "rollback");
+					RETURN_MM_FALSE;
+				}
+	
+				PHALCON_INIT_NVAR(keys);
+				array_init(keys);
+			}
+		} else {
+			/** 
+			 * Try to delete the record
+			 */
+			PHALCON_CALL_METHOD(&status, record, "delete");
+			if (!zend_is_true(status)) {
+				/** 
+				 * Get the messages from the record that produce the error
+				 */
+				PHALCON_CALL_METHOD(&messages, record, "getmessages");
+				phalcon_update_property_this(this_ptr, SL("_errorMessages"), messages TSRMLS_CC);
+	
+				/** 
+				 * Rollback the transaction
+				 */
+				PHALCON_CALL_METHOD(NULL, connection, "rollback");
+				RETURN_MM_FALSE;
+			}
+		}
+	
+		PHALCON_CALL_METHOD(NULL, this_ptr, "next");
+	}
+	
+	/** 
+	 * Send the remaining primary keys
+	 */
+	if (Z_TYPE_P(bulk) == IS_ARRAY && zend_hash_num_elements(Z_ARRVAL_P(keys))) {
+	
+		PHALCON_INIT_NVAR(conditions);
+	
+		PHALCON_INIT_NVAR(bind_types);
+		array_init(bind_types);
+	
+		phalcon_mvc_model_resultset_in_condition(conditions, bind_types, escaped_field, bind_type, zend_hash_num_elements(Z_ARRVAL_P(keys)));
+	
+		PHALCON_CALL_METHOD(&status, connection, "delete", table, conditions, keys, bind_types);
+		if (!zend_is_true(status)) {
+			PHALCON_CALL_METHOD(NULL, connection, "rollback");
+			RETURN_MM_FALSE;
+		}
+	}
+	
+	/** 
+	 * Commit the transaction
+	 */
+	if (PHALCON_IS_TRUE(transaction)) {
+		PHALCON_CALL_METHOD(NULL, connection, "commit");
+	}
+	
+	if (Z_TYPE_P(bulk) == IS_ARRAY) {
+		if (phalcon_mvc_model_resultset_written(manager, record TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+	}
+	
+	RETURN_MM_TRUE;
+}
+
+/**
+ * Updates every record in the resultset with the passed data. If the model doesn't have per-record
+ * events, behaviors or virtual foreign keys the rows are updated using an UPDATE ... WHERE pk IN (...)
+ * per chunk of primary keys, without hydrating the records unless a condition callback is passed,
+ * otherwise every record is updated using Phalcon\Mvc\Model::update()
+ *
+ *<code>
+ * $robots = Robots::find("type = 'mechanical'");
+ * $robots->update(array('type' => 'virtual'));
+ *</code>
+ *
+ * @param array $data
+ * @param Closure $conditionCallback
+ * @return boolean
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Resultset, update){
+
+	zval *data, *condition_callback = NULL, *transaction = NULL, *record = NULL;
+	zval *connection = NULL, *parameters = NULL, *status = NULL, *messages = NULL;
+	zval *bulk = NULL, *table = NULL, *attribute_field = NULL, *escaped_field = NULL;
+	zval *bind_type = NULL, *max_bind_params, *meta_data, *manager = NULL, *keys = NULL, *value = NULL;
+	zval *conditions = NULL, *bind_types = NULL, *where = NULL, *update_data = NULL;
+	zval *fields = NULL, *values = NULL, *types = NULL;
+	zval *r0 = NULL;
+	long int chunk_size = 0;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 1, &data, &condition_callback);
+	
+	if (!condition_callback) {
+		condition_callback = PHALCON_GLOBAL(z_null);
+	}
+	
+	if (Z_TYPE_P(data) != IS_ARRAY || !zend_hash_num_elements(Z_ARRVAL_P(data))) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Data passed to update() must be a non empty array");
+		return;
+	}
+	
+	/** 
+	 * Without a condition callback the rows can be updated without hydrating the records
+	 */
+	if (Z_TYPE_P(condition_callback) != IS_OBJECT) {
+		PHALCON_INIT_VAR(status);
+		phalcon_mvc_model_resultset_statement(status, this_ptr, data TSRMLS_CC);
+		if (EG(exception)) {
+			RETURN_MM();
+		}
+	
+		if (Z_TYPE_P(status) == IS_BOOL) {
+			RETURN_CTOR(status);
+		}
+	}
+	
+	PHALCON_INIT_VAR(transaction);
+	ZVAL_FALSE(transaction);
+	
+	PHALCON_INIT_VAR(bulk);
+	PHALCON_CALL_METHOD(NULL, this_ptr, "rewind");
+	
+	while (1) {
+		PHALCON_CALL_METHOD(&r0, this_ptr, "valid");
+		if (zend_is_true(r0)) {
+		} else {
+			break;
+		}
+	
+		PHALCON_CALL_METHOD(&record, this_ptr, "current");
+		if (PHALCON_IS_FALSE(transaction)) {
+	
+			/** 
+			 * We only can update resultsets whose every element is a complete object
+			 */
+			if (phalcon_method_exists_ex(record, SS("getwriteconnection") TSRMLS_CC) == FAILURE) {
+				PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The returned record is not valid");
+				return;
+			}
+	
+			PHALCON_CALL_METHOD(&connection, record, "getwriteconnection");
+			PHALCON_CALL_METHOD(NULL, connection, "begin");
+	
+			PHALCON_INIT_NVAR(transaction);
+			ZVAL_TRUE(transaction);
+	
+			/** 
+			 * Check if the records can be updated without loading them one by one
+			 */
+			PHALCON_CALL_METHOD(&bulk, this_ptr, "_preparebulkoperation", record, PHALCON_GLOBAL(z_true));
+			if (Z_TYPE_P(bulk) == IS_ARRAY) {
+				phalcon_array_isset_string_fetch(&manager, bulk, SS("manager"));
+				phalcon_array_isset_string_fetch(&table, bulk, SS("table"));
+				phalcon_array_isset_string_fetch(&meta_data, bulk, SS("metaData"));
+				phalcon_array_isset_string_fetch(&attribute_field, bulk, SS("attribute"));
+				phalcon_array_isset_string_fetch(&escaped_field, bulk, SS("field"));
+				phalcon_array_isset_string_fetch(&bind_type, bulk, SS("bindType"));
+				phalcon_array_isset_string_fetch(&max_bind_params, bulk, SS("maxBindParams"));
+	
+				/** 
+				 * Translate the attributes into columns with their bind types
+				 */
+				PHALCON_INIT_VAR(update_data);
+				phalcon_mvc_model_resultset_update_data(update_data, record, meta_data, data TSRMLS_CC);
+				if (EG(exception)) {
+					RETURN_MM();
+				}
+	
+				if (Z_TYPE_P(update_data) == IS_ARRAY) {
+					phalcon_array_isset_string_fetch(&fields, update_data, SS("fields"));
+					phalcon_array_isset_string_fetch(&values, update_data, SS("values"));
+					phalcon_array_isset_string_fetch(&types, update_data, SS("types"));
+	
+					chunk_size = phalcon_get_intval(max_bind_params) - zend_hash_num_elements(Z_ARRVAL_P(values));
+					if (chunk_size < 1) {
+						chunk_size = 1;
+					}
+	
+					PHALCON_INIT_VAR(keys);
+					array_init(keys);
+				} else {
+					/** 
+					 * Empty values in not null columns must produce the validation messages
+					 */
+					PHALCON_INIT_NVAR(bulk);
+				}
+			}
+		}
+	
+		/** 
+		 * Perform additional validations
+		 */
+		if (Z_TYPE_P(condition_callback) == IS_OBJECT) {
+	
+			PHALCON_INIT_NVAR(parameters);
+			array_init_size(parameters, 1);
+			phalcon_array_append(&parameters, record, PH_SEPARATE);
+	
+			PHALCON_INIT_NVAR(status);/**/
+			PHALCON_CALL_USER_FUNC_ARRAY(status, condition_callback, parameters);
+			if (PHALCON_IS_FALSE(status)) {
+				PHALCON_CALL_METHOD(NULL, this_ptr, "next");
+				continue;
+			}
+		}
+	
+		if (Z_TYPE_P(bulk) == IS_ARRAY) {
+	
+			PHALCON_OBS_NVAR(value);
+			phalcon_read_property_zval(&value, record, attribute_field, PH_NOISY TSRMLS_CC);
+			phalcon_array_append(&keys, value, 0);
+	
+			/** 
+			 * Send the chunk of primary keys when it is full
+			 */
+			if (zend_hash_num_elements(Z_ARRVAL_P(keys)) >= chunk_size && zend_hash_num_elements(Z_ARRVAL_P(fields))) {
+	
+				PHALCON_INIT_NVAR(conditions);
+	
+				PHALCON_INIT_NVAR(bind_types);
+				array_init_size(bind_types, chunk_size);
+	
+				phalcon_mvc_model_resultset_in_condition(conditions, bind_types, escaped_field, bind_type, zend_hash_num_elements(Z_ARRVAL_P(keys)));
+	
+				PHALCON_INIT_NVAR(where);
+				array_init_size(where, 3);
+				phalcon_array_update_string(&where, SL("conditions"), conditions, PH_COPY);
+				phalcon_array_update_string(&where, SL("bind"), keys, PH_COPY);
+				phalcon_array_update_string(&where, SL("bindTypes"), bind_types, PH_COPY);
+	
+				PHALCON_CALL_METHOD(&status, connection, "update", table, fields, values, where, types);
+				if (!zend_is_true(status)) {
+					PHALCON_CALL_METHOD(NULL, connection, "rollback");
+					RETURN_MM_FALSE;
+				}
+	
+				PHALCON_INIT_NVAR(keys);
+				array_init(keys);
+			}
+		} else {
+			/** 
+			 * Try to update the record
+			 */
+			PHALCON_CALL_METHOD(&status, record, "update", data);
+			if (!zend_is_true(status)) {
+				/** 
+				 * Get the messages from the record that produce the error
+				 */
+				PHALCON_CALL_METHOD(&messages, record, "getmessages");
+				phalcon_update_property_this(this_ptr, SL("_errorMessages"), messages TSRMLS_CC);
+	
+				/** 
+				 * Rollback the transaction
+				 */
+				PHALCON_CALL_METHOD(NULL, connection, "rollback");
+				RETURN_MM_FALSE;
+			}
 		}
 	
 		PHALCON_CALL_METHOD(NULL, this_ptr, "next");
 	}
 	
+	/** 
+	 * Send the remaining primary keys
+	 */
+	if (Z_TYPE_P(bulk) == IS_ARRAY && zend_hash_num_elements(Z_ARRVAL_P(keys)) && zend_hash_num_elements(Z_ARRVAL_P(fields))) {
+	
+		PHALCON_INIT_NVAR(conditions);
+	
+		PHALCON_INIT_NVAR(bind_types);
+		array_init(bind_types);
+	
+		phalcon_mvc_model_resultset_in_condition(conditions, bind_types, escaped_field, bind_type, zend_hash_num_elements(Z_ARRVAL_P(keys)));
+	
+		PHALCON_INIT_NVAR(where);
+		array_init_size(where, 3);
+		phalcon_array_update_string(&where, SL("conditions"), conditions, PH_COPY);
+		phalcon_array_update_string(&where, SL("bind"), keys, PH_COPY);
+		phalcon_array_update_string(&where, SL("bindTypes"), bind_types, PH_COPY);
+	
+		PHALCON_CALL_METHOD(&status, connection, "update", table, fields, values, where, types);
+		if (!zend_is_true(status)) {
+			PHALCON_CALL_METHOD(NULL, connection, "rollback");
+			RETURN_MM_FALSE;
+		}
+	}
+	
 	/** 
 	 * Commit the transaction
 	 */
@@ -711,6 +1648,12 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, delete){
 		PHALCON_CALL_METHOD(NULL, connection, "commit");
 	}
 	
+	if (Z_TYPE_P(bulk) == IS_ARRAY) {
+		if (phalcon_mvc_model_resultset_written(manager, record TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+	}
+	
 	RETURN_MM_TRUE;
 }
 
@@ -773,3 +1716,548 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset, filter){
 	
 	RETURN_CTOR(records);
 }
+
+/**
+ * Compact serialization of the rows of a resultset
+ *
+ * The rows are stored by column: a dictionary with the column names, followed by a null
+ * bitmap and a typed vector of values for every column. Bodies larger than
+ * PHALCON_RESULTSET_CODEC_COMPRESS_MIN bytes are deflated when ext/zlib is available
+ *
+ *   header:  "PHRS" version(1) flags(1) [body | gzcompress(body)]
+ *   body:    rows(u32) columns(u32) column*
+ *   column:  key-type(1) (len(u32) name | index(u64)) vector-type(1) null-bitmap value*
+ */
+#define PHALCON_RESULTSET_CODEC_VERSION        1
+#define PHALCON_RESULTSET_CODEC_ZLIB           1
+#define PHALCON_RESULTSET_CODEC_COMPRESS_MIN   1024
+
+#define PHALCON_RESULTSET_VECTOR_NULL          0
+#define PHALCON_RESULTSET_VECTOR_STRING        1
+#define PHALCON_RESULTSET_VECTOR_LONG          2
+#define PHALCON_RESULTSET_VECTOR_DOUBLE        3
+#define PHALCON_RESULTSET_VECTOR_BOOL          4
+#define PHALCON_RESULTSET_VECTOR_MIXED         5
+
+typedef struct _phalcon_resultset_reader {
+	const unsigned char *p;
+	const unsigned char *end;
+} phalcon_resultset_reader;
+
+static void phalcon_resultset_write_u32(smart_str *buf, zend_uint value)
+{
+	char bytes[4];
+
+	bytes[0] = (char)(value & 0xFF);
+	bytes[1] = (char)((value >> 8) & 0xFF);
+	bytes[2] = (char)((value >> 16) & 0xFF);
+	bytes[3] = (char)((value >> 24) & 0xFF);
+	smart_str_appendl(buf, bytes, 4);
+}
+
+static void phalcon_resultset_write_u64(smart_str *buf, unsigned long long value)
+{
+	phalcon_resultset_write_u32(buf, (zend_uint)(value & 0xFFFFFFFFUL));
+	phalcon_resultset_write_u32(buf, (zend_uint)((value >> 32) & 0xFFFFFFFFUL));
+}
+
+static int phalcon_resultset_read_bytes(phalcon_resultset_reader *reader, size_t length, const unsigned char **bytes)
+{
+	if ((size_t)(reader->end - reader->p) < length) {
+		return FAILURE;
+	}
+
+	*bytes = reader->p;
+	reader->p += length;
+	return SUCCESS;
+}
+
+static int phalcon_resultset_read_u32(phalcon_resultset_reader *reader, zend_uint *value)
+{
+	const unsigned char *b;
+
+	if (phalcon_resultset_read_bytes(reader, 4, &b) == FAILURE) {
+		return FAILURE;
+	}
+
+	*value = (zend_uint)b[0] | ((zend_uint)b[1] << 8) | ((zend_uint)b[2] << 16) | ((zend_uint)b[3] << 24);
+	return SUCCESS;
+}
+
+static int phalcon_resultset_read_u64(phalcon_resultset_reader *reader, unsigned long long *value)
+{
+	zend_uint low, high;
+
+	if (phalcon_resultset_read_u32(reader, &low) == FAILURE || phalcon_resultset_read_u32(reader, &high) == FAILURE) {
+		return FAILURE;
+	}
+
+	*value = (unsigned long long)low | ((unsigned long long)high << 32);
+	return SUCCESS;
+}
+
+static zval** phalcon_resultset_row_value(zval *row, const zval *key)
+{
+	zval **value;
+
+	if (Z_TYPE_P(row) != IS_ARRAY) {
+		return NULL;
+	}
+
+	if (Z_TYPE_P(key) == IS_STRING) {
+		if (zend_hash_find(Z_ARRVAL_P(row), Z_STRVAL_P(key), Z_STRLEN_P(key) + 1, (void**)&value) == SUCCESS) {
+			return value;
+		}
+	} else if (zend_hash_index_find(Z_ARRVAL_P(row), Z_LVAL_P(key), (void**)&value) == SUCCESS) {
+		return value;
+	}
+
+	return NULL;
+}
+
+/**
+ * Encodes a list of rows sharing the same columns, fails if the rows can't be represented
+ */
+int phalcon_mvc_model_resultset_encode_rows(zval *return_value, zval *rows TSRMLS_DC)
+{
+	HashTable *rows_ht, *columns_ht = NULL;
+	HashPosition rows_hp, columns_hp;
+	zval **row, **value, *compressed = NULL, *body_zval, *params[1];
+	smart_str body = { NULL, 0, 0 }, result = { NULL, 0, 0 };
+	zend_uint num_rows, num_columns = 0, bitmap_size, i;
+	unsigned char *bitmap = NULL, vector_type, value_type;
+	unsigned long long bits;
+	double dval;
+	char flags = 0;
+
+	if (Z_TYPE_P(rows) != IS_ARRAY) {
+		return FAILURE;
+	}
+
+	rows_ht  = Z_ARRVAL_P(rows);
+	num_rows = zend_hash_num_elements(rows_ht);
+
+	/**
+	 * The first row is the dictionary of columns, every row must have the same columns
+	 */
+	if (num_rows) {
+		zend_hash_internal_pointer_reset_ex(rows_ht, &rows_hp);
+		if (zend_hash_get_current_data_ex(rows_ht, (void**)&row, &rows_hp) == FAILURE || Z_TYPE_PP(row) != IS_ARRAY) {
+			return FAILURE;
+		}
+
+		columns_ht  = Z_ARRVAL_PP(row);
+		num_columns = zend_hash_num_elements(columns_ht);
+		if (!num_columns) {
+			return FAILURE;
+		}
+
+		for (
+			zend_hash_internal_pointer_reset_ex(rows_ht, &rows_hp);
+			zend_hash_get_current_data_ex(rows_ht, (void**)&row, &rows_hp) == SUCCESS;
+			zend_hash_move_forward_ex(rows_ht, &rows_hp)
+		) {
+			if (Z_TYPE_PP(row) != IS_ARRAY || zend_hash_num_elements(Z_ARRVAL_PP(row)) != num_columns) {
+				return FAILURE;
+			}
+		}
+	}
+
+	phalcon_resultset_write_u32(&body, num_rows);
+	phalcon_resultset_write_u32(&body, num_columns);
+
+	bitmap_size = (num_rows + 7) / 8;
+	if (bitmap_size) {
+		bitmap = emalloc(bitmap_size);
+	}
+
+	if (columns_ht) {
+		for (
+			zend_hash_internal_pointer_reset_ex(columns_ht, &columns_hp);
+			zend_hash_get_current_data_ex(columns_ht, (void**)&value, &columns_hp) == SUCCESS;
+			zend_hash_move_forward_ex(columns_ht, &columns_hp)
+		) {
+			zval key = phalcon_get_current_key_w(columns_ht, &columns_hp);
+
+			if (Z_TYPE(key) == IS_STRING) {
+				smart_str_appendc(&body, 0);
+				phalcon_resultset_write_u32(&body, Z_STRLEN(key));
+				smart_str_appendl(&body, Z_STRVAL(key), Z_STRLEN(key));
+			} else {
+				smart_str_appendc(&body, 1);
+				phalcon_resultset_write_u64(&body, (unsigned long long)(long long)Z_LVAL(key));
+			}
+
+			/**
+			 * A column gets a typed vector when all its values have the same type
+			 */
+			memset(bitmap, 0, bitmap_size);
+			vector_type = PHALCON_RESULTSET_VECTOR_NULL;
+
+			i = 0;
+			for (
+				zend_hash_internal_pointer_reset_ex(rows_ht, &rows_hp);
+				zend_hash_get_current_data_ex(rows_ht, (void**)&row, &rows_hp) == SUCCESS;
+				zend_hash_move_forward_ex(rows_ht, &rows_hp), ++i
+			) {
+				value = phalcon_resultset_row_value(*row, &key);
+				if (!value) {
+					goto failure;
+				}
+
+				switch (Z_TYPE_PP(value)) {
+					case IS_NULL:
+						bitmap[i >> 3] |= (unsigned char)(1 << (i & 7));
+						continue;
+					case IS_STRING: value_type = PHALCON_RESULTSET_VECTOR_STRING; break;
+					case IS_LONG:   value_type = PHALCON_RESULTSET_VECTOR_LONG; break;
+					case IS_DOUBLE: value_type = PHALCON_RESULTSET_VECTOR_DOUBLE; break;
+					case IS_BOOL:   value_type = PHALCON_RESULTSET_VECTOR_BOOL; break;
+					default:        value_type = PHALCON_RESULTSET_VECTOR_MIXED; break;
+				}
+
+				if (vector_type == PHALCON_RESULTSET_VECTOR_NULL) {
+					vector_type = value_type;
+				} else if (vector_type != value_type) {
+					vector_type = PHALCON_RESULTSET_VECTOR_MIXED;
+				}
+			}
+
+			smart_str_appendc(&body, (char)vector_type);
+			smart_str_appendl(&body, (char*)bitmap, bitmap_size);
+
+			if (vector_type == PHALCON_RESULTSET_VECTOR_NULL) {
+				continue;
+			}
+
+			for (
+				zend_hash_internal_pointer_reset_ex(rows_ht, &rows_hp);
+				zend_hash_get_current_data_ex(rows_ht, (void**)&row, &rows_hp) == SUCCESS;
+				zend_hash_move_forward_ex(rows_ht, &rows_hp)
+			) {
+				value = phalcon_resultset_row_value(*row, &key);
+				if (Z_TYPE_PP(value) == IS_NULL) {
+					continue;
+				}
+
+				switch (vector_type) {
+
+					case PHALCON_RESULTSET_VECTOR_STRING:
+						phalcon_resultset_write_u32(&body, Z_STRLEN_PP(value));
+						smart_str_appendl(&body, Z_STRVAL_PP(value), Z_STRLEN_PP(value));
+						break;
+
+					case PHALCON_RESULTSET_VECTOR_LONG:
+						phalcon_resultset_write_u64(&body, (unsigned long long)(long long)Z_LVAL_PP(value));
+						break;
+
+					case PHALCON_RESULTSET_VECTOR_DOUBLE:
+						dval = Z_DVAL_PP(value);
+						memcpy(&bits, &dval, sizeof(bits));
+						phalcon_resultset_write_u64(&body, bits);
+						break;
+
+					case PHALCON_RESULTSET_VECTOR_BOOL:
+						smart_str_appendc(&body, Z_BVAL_PP(value) ? 1 : 0);
+						break;
+
+					default: {
+						php_serialize_data_t var_hash;
+						smart_str serialized = { NULL, 0, 0 };
+
+						PHP_VAR_SERIALIZE_INIT(var_hash);
+						php_var_serialize(&serialized, value, &var_hash TSRMLS_CC);
+						PHP_VAR_SERIALIZE_DESTROY(var_hash);
+
+						if (EG(exception)) {
+							smart_str_free(&serialized);
+							goto failure;
+						}
+
+						phalcon_resultset_write_u32(&body, serialized.len);
+						smart_str_appendl(&body, serialized.c, serialized.len);
+						smart_str_free(&serialized);
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	if (bitmap) {
+		efree(bitmap);
+	}
+
+	/**
+	 * Large bodies are deflated when ext/zlib is available and it pays off
+	 */
+	if (body.len >= PHALCON_RESULTSET_CODEC_COMPRESS_MIN && phalcon_function_exists_ex(SS("gzcompress") TSRMLS_CC) == SUCCESS) {
+
+		MAKE_STD_ZVAL(body_zval);
+		ZVAL_STRINGL(body_zval, body.c, body.len, 0);
+		params[0] = body_zval;
+
+		if (phalcon_call_func_aparams(&compressed, SL("gzcompress"), 1, params TSRMLS_CC) == SUCCESS && compressed && Z_TYPE_P(compressed) == IS_STRING && (size_t)Z_STRLEN_P(compressed) < body.len) {
+			flags |= PHALCON_RESULTSET_CODEC_ZLIB;
+		}
+
+		/* body_zval owns the buffer of body from now on */
+		body.c   = NULL;
+		body.len = 0;
+		body.a   = 0;
+
+		smart_str_appendl(&result, "PHRS", 4);
+		smart_str_appendc(&result, PHALCON_RESULTSET_CODEC_VERSION);
+		smart_str_appendc(&result, flags);
+
+		if (flags & PHALCON_RESULTSET_CODEC_ZLIB) {
+			smart_str_appendl(&result, Z_STRVAL_P(compressed), Z_STRLEN_P(compressed));
+		} else {
+			smart_str_appendl(&result, Z_STRVAL_P(body_zval), Z_STRLEN_P(body_zval));
+		}
+
+		zval_ptr_dtor(&body_zval);
+		if (compressed) {
+			zval_ptr_dtor(&compressed);
+		}
+
+		if (EG(exception)) {
+			zend_clear_exception(TSRMLS_C);
+		}
+	} else {
+		smart_str_appendl(&result, "PHRS", 4);
+		smart_str_appendc(&result, PHALCON_RESULTSET_CODEC_VERSION);
+		smart_str_appendc(&result, flags);
+		smart_str_appendl(&result, body.c, body.len);
+		smart_str_free(&body);
+	}
+
+	smart_str_0(&result);
+	RETVAL_STRINGL(result.c, result.len, 0);
+	return SUCCESS;
+
+failure:
+	if (bitmap) {
+		efree(bitmap);
+	}
+
+	smart_str_free(&body);
+	return FAILURE;
+}
+
+/**
+ * Decodes the rows encoded by phalcon_mvc_model_resultset_encode_rows()
+ */
+int phalcon_mvc_model_resultset_decode_rows(zval *return_value, zval *data TSRMLS_DC)
+{
+	phalcon_resultset_reader reader;
+	zval *uncompressed = NULL, *compressed, *params[1], **rows = NULL, *value;
+	const unsigned char *bytes, *bitmap;
+	zend_uint num_rows, num_columns, bitmap_size, length, name_length = 0, i, c;
+	unsigned long long bits;
+	double dval;
+	unsigned char key_type, vector_type;
+	char *name = NULL;
+	ulong index = 0;
+	int status = FAILURE, error_reporting;
+
+	if (Z_TYPE_P(data) != IS_STRING || Z_STRLEN_P(data) < 6 || memcmp(Z_STRVAL_P(data), "PHRS", 4) || Z_STRVAL_P(data)[4] != PHALCON_RESULTSET_CODEC_VERSION) {
+		return FAILURE;
+	}
+
+	reader.p   = (const unsigned char*)Z_STRVAL_P(data) + 6;
+	reader.end = (const unsigned char*)Z_STRVAL_P(data) + Z_STRLEN_P(data);
+
+	if (Z_STRVAL_P(data)[5] & PHALCON_RESULTSET_CODEC_ZLIB) {
+
+		if (phalcon_function_exists_ex(SS("gzuncompress") TSRMLS_CC) == FAILURE) {
+			return FAILURE;
+		}
+
+		MAKE_STD_ZVAL(compressed);
+		ZVAL_STRINGL(compressed, (const char*)reader.p, reader.end - reader.p, 1);
+		params[0] = compressed;
+
+		/**
+		 * A corrupted body is reported by the caller, the warning of gzuncompress() is silenced
+		 */
+		error_reporting = EG(error_reporting);
+		EG(error_reporting) = 0;
+		status = phalcon_call_func_aparams(&uncompressed, SL("gzuncompress"), 1, params TSRMLS_CC);
+		EG(error_reporting) = error_reporting;
+
+		if (status == FAILURE || !uncompressed || Z_TYPE_P(uncompressed) != IS_STRING) {
+			zval_ptr_dtor(&compressed);
+			if (uncompressed) {
+				zval_ptr_dtor(&uncompressed);
+			}
+			if (EG(exception)) {
+				zend_clear_exception(TSRMLS_C);
+			}
+			return FAILURE;
+		}
+
+		zval_ptr_dtor(&compressed);
+		status = FAILURE;
+
+		reader.p   = (const unsigned char*)Z_STRVAL_P(uncompressed);
+		reader.end = reader.p + Z_STRLEN_P(uncompressed);
+	}
+
+	if (phalcon_resultset_read_u32(&reader, &num_rows) == FAILURE || phalcon_resultset_read_u32(&reader, &num_columns) == FAILURE) {
+		goto done;
+	}
+
+	if (!num_columns && num_rows) {
+		goto done;
+	}
+
+	bitmap_size = (num_rows + 7) / 8;
+
+	/* Every column carries a bitmap, a row count not covered by the data is corrupted */
+	if (num_columns && (size_t)(reader.end - reader.p) / num_columns < bitmap_size) {
+		goto done;
+	}
+
+	array_init_size(return_value, num_rows);
+
+	if (num_rows) {
+		rows = safe_emalloc(num_rows, sizeof(zval*), 0);
+		for (i = 0; i < num_rows; ++i) {
+			MAKE_STD_ZVAL(rows[i]);
+			array_init_size(rows[i], num_columns);
+			add_next_index_zval(return_value, rows[i]);
+		}
+	}
+
+	for (c = 0; c < num_columns; ++c) {
+
+		if (phalcon_resultset_read_bytes(&reader, 1, &bytes) == FAILURE) {
+			goto done;
+		}
+
+		key_type = bytes[0];
+		if (key_type == 0) {
+			if (phalcon_resultset_read_u32(&reader, &name_length) == FAILURE || phalcon_resultset_read_bytes(&reader, name_length, &bytes) == FAILURE) {
+				goto done;
+			}
+			name = estrndup((const char*)bytes, name_length);
+		} else {
+			if (phalcon_resultset_read_u64(&reader, &bits) == FAILURE) {
+				goto done;
+			}
+			index = (ulong)(long)(long long)bits;
+		}
+
+		if (phalcon_resultset_read_bytes(&reader, 1, &bytes) == FAILURE || phalcon_resultset_read_bytes(&reader, bitmap_size, &bitmap) == FAILURE) {
+			goto done;
+		}
+
+		vector_type = bytes[0];
+		if (vector_type > PHALCON_RESULTSET_VECTOR_MIXED) {
+			goto done;
+		}
+
+		for (i = 0; i < num_rows; ++i) {
+
+			MAKE_STD_ZVAL(value);
+
+			if (vector_type == PHALCON_RESULTSET_VECTOR_NULL || (bitmap[i >> 3] & (1 << (i & 7)))) {
+				ZVAL_NULL(value);
+			} else {
+				switch (vector_type) {
+
+					case PHALCON_RESULTSET_VECTOR_STRING:
+						if (phalcon_resultset_read_u32(&reader, &length) == FAILURE || phalcon_resultset_read_bytes(&reader, length, &bytes) == FAILURE) {
+							FREE_ZVAL(value);
+							goto done;
+						}
+						ZVAL_STRINGL(value, (const char*)bytes, length, 1);
+						break;
+
+					case PHALCON_RESULTSET_VECTOR_LONG:
+						if (phalcon_resultset_read_u64(&reader, &bits) == FAILURE) {
+							FREE_ZVAL(value);
+							goto done;
+						}
+						ZVAL_LONG(value, (long)(long long)bits);
+						break;
+
+					case PHALCON_RESULTSET_VECTOR_DOUBLE:
+						if (phalcon_resultset_read_u64(&reader, &bits) == FAILURE) {
+							FREE_ZVAL(value);
+							goto done;
+						}
+						memcpy(&dval, &bits, sizeof(dval));
+						ZVAL_DOUBLE(value, dval);
+						break;
+
+					case PHALCON_RESULTSET_VECTOR_BOOL:
+						if (phalcon_resultset_read_bytes(&reader, 1, &bytes) == FAILURE) {
+							FREE_ZVAL(value);
+							goto done;
+						}
+						ZVAL_BOOL(value, bytes[0] ? 1 : 0);
+						break;
+
+					default: {
+						php_unserialize_data_t var_hash;
+						const unsigned char *p;
+						int unserialized;
+
+						if (phalcon_resultset_read_u32(&reader, &length) == FAILURE || phalcon_resultset_read_bytes(&reader, length, &bytes) == FAILURE) {
+							FREE_ZVAL(value);
+							goto done;
+						}
+
+						INIT_ZVAL(*value);
+						p = bytes;
+
+						PHP_VAR_UNSERIALIZE_INIT(var_hash);
+						unserialized = php_var_unserialize(&value, &p, bytes + length, &var_hash TSRMLS_CC);
+						PHP_VAR_UNSERIALIZE_DESTROY(var_hash);
+
+						if (!unserialized) {
+							zval_ptr_dtor(&value);
+							goto done;
+						}
+						break;
+					}
+				}
+			}
+
+			if (key_type == 0) {
+				add_assoc_zval_ex(rows[i], name, name_length + 1, value);
+			} else {
+				add_index_zval(rows[i], index, value);
+			}
+		}
+
+		if (name) {
+			efree(name);
+			name = NULL;
+		}
+	}
+
+	status = SUCCESS;
+
+done:
+	if (name) {
+		efree(name);
+	}
+
+	if (rows) {
+		efree(rows);
+	}
+
+	if (uncompressed) {
+		zval_ptr_dtor(&uncompressed);
+	}
+
+	if (status == FAILURE && Z_TYPE_P(return_value) == IS_ARRAY) {
+		zval_dtor(return_value);
+		ZVAL_NULL(return_value);
+	}
+
+	return status;
+}
@@ -29,6 +29,9 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Resultset);
 #define PHALCON_MVC_MODEL_RESULTSET_TYPE_FULL       0
 #define PHALCON_MVC_MODEL_RESULTSET_TYPE_PARTIAL    1
 
+int phalcon_mvc_model_resultset_encode_rows(zval *return_value, zval *rows TSRMLS_DC);
+int phalcon_mvc_model_resultset_decode_rows(zval *return_value, zval *data TSRMLS_DC);
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_resultset_sethydratemode, 0, 0, 1)
 	ZEND_ARG_INFO(0, hydrateMode)
 ZEND_END_ARG_INFO()
@@ -37,6 +40,11 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_resultset_delete, 0, 0, 0)
 	ZEND_ARG_INFO(0, conditionCallback)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_resultset_update, 0, 0, 1)
+	ZEND_ARG_INFO(0, data)
+	ZEND_ARG_INFO(0, conditionCallback)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_resultset_filter, 0, 0, 1)
 	ZEND_ARG_INFO(0, filter)
 ZEND_END_ARG_INFO()
@@ -0,0 +1,425 @@
+
+/*
+  +------------------------------------------------------------------------+
+  | Phalcon Framework                                                      |
+  +------------------------------------------------------------------------+
+  | Copyright (c) 2011-2014 Phalcon Team (http://www.phalconphp.com)       |
+  +------------------------------------------------------------------------+
+  | This source file is subject to the New BSD License that is bundled     |
+  | with this package in the file docs/LICENSE.txt.                        |
+  |                                                                        |
+  | If you did not receive a copy of the license and are unable to         |
+  | obtain it through the world-wide-web, please send an email             |
+  | to license@phalconphp.com so we can send you a copy immediately.       |
+  +------------------------------------------------------------------------+
+  | Authors: Andres Gutierrez <andres@phalconphp.com>                      |
+  |          Eduar Carvajal <eduar@phalconphp.com>                         |
+  +------------------------------------------------------------------------+
+*/
+
+#include "mvc/model/resultset/columns.h"
+
+/**
+ * Columnar storage for the rows of a resultset
+ *
+ * Every row of a materialized resultset is a hash table that repeats the names of the
+ * columns. Here every column is a packed vector instead: integers and floats are stored
+ * natively, equal strings share the same zval and the names are stored only once.
+ * Rows are rebuilt on demand when they are traversed
+ */
+
+/**
+ * Checks if a string is the canonical representation of an integer, so it can be
+ * stored as a long and converted back to the same string
+ */
+static int phalcon_mvc_model_resultset_columns_is_numeric(const zval *value, long *lval)
+{
+	char buffer[MAX_LENGTH_OF_LONG + 1];
+	double dval;
+	int length;
+
+	if (!Z_STRLEN_P(value) || Z_STRLEN_P(value) > MAX_LENGTH_OF_LONG) {
+		return 0;
+	}
+
+	if (is_numeric_string(Z_STRVAL_P(value), Z_STRLEN_P(value), lval, &dval, 0) != IS_LONG) {
+		return 0;
+	}
+
+	length = slprintf(buffer, sizeof(buffer), "%ld", *lval);
+	return length == Z_STRLEN_P(value) && !memcmp(buffer, Z_STRVAL_P(value), length);
+}
+
+/**
+ * Stores a list of rows by column, returns NULL if the rows don't share the same string keys
+ */
+phalcon_mvc_model_resultset_columns* phalcon_mvc_model_resultset_columns_build(zval *rows TSRMLS_DC)
+{
+	phalcon_mvc_model_resultset_columns *columns;
+	phalcon_mvc_model_resultset_column *column;
+	HashTable *rows_ht, *first_ht, interned;
+	HashPosition rows_hp, hp;
+	zval **row, **value, **shared, *copy;
+	zend_uint num_rows, num_columns, bitmap_size, c, i;
+	char *key;
+	uint key_length;
+	ulong index;
+	long lval;
+	int has_nulls, has_values, is_long, is_numeric, is_double;
+
+	if (Z_TYPE_P(rows) != IS_ARRAY) {
+		return NULL;
+	}
+
+	rows_ht  = Z_ARRVAL_P(rows);
+	num_rows = zend_hash_num_elements(rows_ht);
+	if (!num_rows) {
+		return NULL;
+	}
+
+	zend_hash_internal_pointer_reset_ex(rows_ht, &rows_hp);
+	if (zend_hash_get_current_data_ex(rows_ht, (void**) &row, &rows_hp) == FAILURE || Z_TYPE_PP(row) != IS_ARRAY) {
+		return NULL;
+	}
+
+	first_ht    = Z_ARRVAL_PP(row);
+	num_columns = zend_hash_num_elements(first_ht);
+	if (!num_columns) {
+		return NULL;
+	}
+
+	for (
+		zend_hash_internal_pointer_reset_ex(rows_ht, &rows_hp);
+		zend_hash_get_current_data_ex(rows_ht, (void**) &row, &rows_hp) == SUCCESS;
+		zend_hash_move_forward_ex(rows_ht, &rows_hp)
+	) {
+		if (Z_TYPE_PP(row) != IS_ARRAY || zend_hash_num_elements(Z_ARRVAL_PP(row)) != num_columns) {
+			return NULL;
+		}
+	}
+
+	bitmap_size = (num_rows + 7) / 8;
+
+	columns              = emalloc(sizeof(phalcon_mvc_model_resultset_columns));
+	columns->refcount    = 1;
+	columns->num_rows    = num_rows;
+	columns->num_columns = num_columns;
+	columns->columns     = ecalloc(num_columns, sizeof(phalcon_mvc_model_resultset_column));
+
+	c = 0;
+	for (
+		zend_hash_internal_pointer_reset_ex(first_ht, &hp);
+		zend_hash_get_current_data_ex(first_ht, (void**) &value, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(first_ht, &hp)
+	) {
+		if (zend_hash_get_current_key_ex(first_ht, &key, &key_length, &index, 0, &hp) != HASH_KEY_IS_STRING) {
+			goto failure;
+		}
+
+		column              = &columns->columns[c++];
+		column->name        = estrndup(key, key_length - 1);
+		column->name_length = key_length - 1;
+		column->hash        = zend_inline_hash_func(key, key_length);
+
+		/**
+		 * The narrowest type able to hold every value of the column is chosen
+		 */
+		has_nulls  = 0;
+		has_values = 0;
+		is_long    = 1;
+		is_numeric = 1;
+		is_double  = 1;
+
+		for (
+			zend_hash_internal_pointer_reset_ex(rows_ht, &rows_hp);
+			zend_hash_get_current_data_ex(rows_ht, (void**) &row, &rows_hp) == SUCCESS;
+			zend_hash_move_forward_ex(rows_ht, &rows_hp)
+		) {
+			if (zend_hash_quick_find(Z_ARRVAL_PP(row), column->name, column->name_length + 1, column->hash, (void**) &shared) == FAILURE) {
+				goto failure;
+			}
+
+			switch (Z_TYPE_PP(shared)) {
+
+				case IS_NULL:
+					has_nulls = 1;
+					continue;
+
+				case IS_LONG:
+					is_numeric = 0;
+					is_double  = 0;
+					break;
+
+				case IS_DOUBLE:
+					is_long    = 0;
+					is_numeric = 0;
+					break;
+
+				case IS_STRING:
+					is_long   = 0;
+					is_double = 0;
+					if (is_numeric && !phalcon_mvc_model_resultset_columns_is_numeric(*shared, &lval)) {
+						is_numeric = 0;
+					}
+					break;
+
+				default:
+					is_long    = 0;
+					is_numeric = 0;
+					is_double  = 0;
+					break;
+			}
+
+			has_values = 1;
+		}
+
+		if (!has_values) {
+			column->type = PHALCON_RESULTSET_COLUMN_NULL;
+			continue;
+		}
+
+		if (has_nulls) {
+			column->nulls = ecalloc(bitmap_size, 1);
+		}
+
+		if (is_long) {
+			column->type         = PHALCON_RESULTSET_COLUMN_LONG;
+			column->values.lvals = safe_emalloc(num_rows, sizeof(long), 0);
+		} else if (is_numeric) {
+			column->type         = PHALCON_RESULTSET_COLUMN_NUMERIC;
+			column->values.lvals = safe_emalloc(num_rows, sizeof(long), 0);
+		} else if (is_double) {
+			column->type         = PHALCON_RESULTSET_COLUMN_DOUBLE;
+			column->values.dvals = safe_emalloc(num_rows, sizeof(double), 0);
+		} else {
+			column->type         = PHALCON_RESULTSET_COLUMN_ZVAL;
+			column->values.zvals = ecalloc(num_rows, sizeof(zval*));
+			zend_hash_init(&interned, 0, NULL, NULL, 0);
+		}
+
+		i = 0;
+		for (
+			zend_hash_internal_pointer_reset_ex(rows_ht, &rows_hp);
+			zend_hash_get_current_data_ex(rows_ht, (void**) &row, &rows_hp) == SUCCESS;
+			zend_hash_move_forward_ex(rows_ht, &rows_hp), ++i
+		) {
+			zend_hash_quick_find(Z_ARRVAL_PP(row), column->name, column->name_length + 1, column->hash, (void**) &shared);
+
+			if (Z_TYPE_PP(shared) == IS_NULL) {
+				column->nulls[i >> 3] |= (unsigned char) (1 << (i & 7));
+				if (column->type == PHALCON_RESULTSET_COLUMN_LONG || column->type == PHALCON_RESULTSET_COLUMN_NUMERIC) {
+					column->values.lvals[i] = 0;
+				} else if (column->type == PHALCON_RESULTSET_COLUMN_DOUBLE) {
+					column->values.dvals[i] = 0;
+				}
+				continue;
+			}
+
+			switch (column->type) {
+
+				case PHALCON_RESULTSET_COLUMN_LONG:
+					column->values.lvals[i] = Z_LVAL_PP(shared);
+					break;
+
+				case PHALCON_RESULTSET_COLUMN_NUMERIC:
+					phalcon_mvc_model_resultset_columns_is_numeric(*shared, &column->values.lvals[i]);
+					break;
+
+				case PHALCON_RESULTSET_COLUMN_DOUBLE:
+					column->values.dvals[i] = Z_DVAL_PP(shared);
+					break;
+
+				default:
+					/**
+					 * References are never shared with the rows passed
+					 */
+					if (Z_ISREF_PP(shared)) {
+						ALLOC_ZVAL(copy);
+						INIT_PZVAL_COPY(copy, *shared);
+						zval_copy_ctor(copy);
+						column->values.zvals[i] = copy;
+						break;
+					}
+
+					/**
+					 * Equal strings of the same column are interned
+					 */
+					if (Z_TYPE_PP(shared) == IS_STRING) {
+						if (zend_hash_find(&interned, Z_STRVAL_PP(shared), Z_STRLEN_PP(shared) + 1, (void**) &value) == SUCCESS) {
+							shared = value;
+						} else {
+							zend_hash_add(&interned, Z_STRVAL_PP(shared), Z_STRLEN_PP(shared) + 1, (void*) shared, sizeof(zval*), NULL);
+						}
+					}
+
+					Z_ADDREF_PP(shared);
+					column->values.zvals[i] = *shared;
+					break;
+			}
+		}
+
+		if (column->type == PHALCON_RESULTSET_COLUMN_ZVAL) {
+			zend_hash_destroy(&interned);
+		}
+	}
+
+	return columns;
+
+failure:
+	phalcon_mvc_model_resultset_columns_release(columns);
+	return NULL;
+}
+
+/**
+ * Releases a reference to the columns, the memory is freed by the last one
+ */
+void phalcon_mvc_model_resultset_columns_release(phalcon_mvc_model_resultset_columns *columns)
+{
+	phalcon_mvc_model_resultset_column *column;
+	zend_uint c, i;
+
+	if (--columns->refcount) {
+		return;
+	}
+
+	for (c = 0; c < columns->num_columns; ++c) {
+
+		column = &columns->columns[c];
+
+		if (column->name) {
+			efree(column->name);
+		}
+
+		if (column->nulls) {
+			efree(column->nulls);
+		}
+
+		switch (column->type) {
+
+			case PHALCON_RESULTSET_COLUMN_LONG:
+			case PHALCON_RESULTSET_COLUMN_NUMERIC:
+				efree(column->values.lvals);
+				break;
+
+			case PHALCON_RESULTSET_COLUMN_DOUBLE:
+				efree(column->values.dvals);
+				break;
+
+			case PHALCON_RESULTSET_COLUMN_ZVAL:
+				for (i = 0; i < columns->num_rows; ++i) {
+					if (column->values.zvals[i]) {
+						zval_ptr_dtor(&column->values.zvals[i]);
+					}
+				}
+
+				efree(column->values.zvals);
+				break;
+		}
+	}
+
+	efree(columns->columns);
+	efree(columns);
+}
+
+/**
+ * Returns a new zval with the value of a column in a row
+ */
+static zval* phalcon_mvc_model_resultset_columns_value(const phalcon_mvc_model_resultset_column *column, zend_uint row)
+{
+	char buffer[MAX_LENGTH_OF_LONG + 1];
+	zval *value;
+	int length;
+
+	if (column->type == PHALCON_RESULTSET_COLUMN_NULL || (column->nulls && (column->nulls[row >> 3] & (1 << (row & 7))))) {
+		MAKE_STD_ZVAL(value);
+		ZVAL_NULL(value);
+		return value;
+	}
+
+	switch (column->type) {
+
+		case PHALCON_RESULTSET_COLUMN_LONG:
+			MAKE_STD_ZVAL(value);
+			ZVAL_LONG(value, column->values.lvals[row]);
+			break;
+
+		case PHALCON_RESULTSET_COLUMN_NUMERIC:
+			length = slprintf(buffer, sizeof(buffer), "%ld", column->values.lvals[row]);
+			MAKE_STD_ZVAL(value);
+			ZVAL_STRINGL(value, buffer, length, 1);
+			break;
+
+		case PHALCON_RESULTSET_COLUMN_DOUBLE:
+			MAKE_STD_ZVAL(value);
+			ZVAL_DOUBLE(value, column->values.dvals[row]);
+			break;
+
+		default:
+			value = column->values.zvals[row];
+			Z_ADDREF_P(value);
+			break;
+	}
+
+	return value;
+}
+
+/**
+ * Rebuilds a row as an associative array
+ */
+void phalcon_mvc_model_resultset_columns_fetch(zval *return_value, const phalcon_mvc_model_resultset_columns *columns, zend_uint row)
+{
+	const phalcon_mvc_model_resultset_column *column;
+	zval *value;
+	zend_uint c;
+
+	array_init_size(return_value, columns->num_columns);
+
+	for (c = 0; c < columns->num_columns; ++c) {
+		column = &columns->columns[c];
+		value  = phalcon_mvc_model_resultset_columns_value(column, row);
+		zend_hash_quick_update(Z_ARRVAL_P(return_value), column->name, column->name_length + 1, column->hash, (void*) &value, sizeof(zval*), NULL);
+	}
+}
+
+/**
+ * Returns the values of a single column without rebuilding the rows
+ */
+int phalcon_mvc_model_resultset_columns_fetch_column(zval *return_value, const phalcon_mvc_model_resultset_columns *columns, const char *name, uint name_length)
+{
+	const phalcon_mvc_model_resultset_column *column;
+	zend_uint c, i;
+
+	for (c = 0; c < columns->num_columns; ++c) {
+
+		column = &columns->columns[c];
+		if (column->name_length != name_length || memcmp(column->name, name, name_length)) {
+			continue;
+		}
+
+		array_init_size(return_value, columns->num_rows);
+		for (i = 0; i < columns->num_rows; ++i) {
+			add_next_index_zval(return_value, phalcon_mvc_model_resultset_columns_value(column, i));
+		}
+
+		return SUCCESS;
+	}
+
+	return FAILURE;
+}
+
+/**
+ * Rebuilds every row
+ */
+void phalcon_mvc_model_resultset_columns_to_array(zval *return_value, const phalcon_mvc_model_resultset_columns *columns)
+{
+	zval *row;
+	zend_uint i;
+
+	array_init_size(return_value, columns->num_rows);
+
+	for (i = 0; i < columns->num_rows; ++i) {
+		MAKE_STD_ZVAL(row);
+		phalcon_mvc_model_resultset_columns_fetch(row, columns, i);
+		add_next_index_zval(return_value, row);
+	}
+}
@@ -0,0 +1,60 @@
+
+/*
+  +------------------------------------------------------------------------+
+  | Phalcon Framework                                                      |
+  +------------------------------------------------------------------------+
+  | Copyright (c) 2011-2014 Phalcon Team (http://www.phalconphp.com)       |
+  +------------------------------------------------------------------------+
+  | This source file is subject to the New BSD License that is bundled     |
+  | with this package in the file docs/LICENSE.txt.                        |
+  |                                                                        |
+  | If you did not receive a copy of the license and are unable to         |
+  | obtain it through the world-wide-web, please send an email             |
+  | to license@phalconphp.com so we can send you a copy immediately.       |
+  +------------------------------------------------------------------------+
+  | Authors: Andres Gutierrez <andres@phalconphp.com>                      |
+  |          Eduar Carvajal <eduar@phalconphp.com>                         |
+  +------------------------------------------------------------------------+
+*/
+
+#ifndef PHALCON_MVC_MODEL_RESULTSET_COLUMNS_H
+#define PHALCON_MVC_MODEL_RESULTSET_COLUMNS_H
+
+#include "php_phalcon.h"
+
+#define PHALCON_RESULTSET_COLUMN_NULL      0  /**< Every value is NULL */
+#define PHALCON_RESULTSET_COLUMN_LONG      1  /**< Integers */
+#define PHALCON_RESULTSET_COLUMN_NUMERIC   2  /**< Integers returned as strings by the driver */
+#define PHALCON_RESULTSET_COLUMN_DOUBLE    3  /**< Floats */
+#define PHALCON_RESULTSET_COLUMN_ZVAL      4  /**< Strings and any other value, equal strings share the same zval */
+
+typedef struct _phalcon_mvc_model_resultset_column {
+	char *name;             /**< Column name (NUL terminated) */
+	uint name_length;       /**< Length of the name without the NUL */
+	ulong hash;             /**< Precomputed hash of the name */
+	unsigned char type;     /**< One of PHALCON_RESULTSET_COLUMN_* */
+	unsigned char *nulls;   /**< Null bitmap, NULL if the column has no nulls */
+	union {
+		long *lvals;
+		double *dvals;
+		zval **zvals;
+	} values;
+} phalcon_mvc_model_resultset_column;
+
+/**
+ * Rows of a resultset stored by column, it is shared between clones of the same resultset
+ */
+typedef struct _phalcon_mvc_model_resultset_columns {
+	zend_uint refcount;
+	zend_uint num_rows;
+	zend_uint num_columns;
+	phalcon_mvc_model_resultset_column *columns;
+} phalcon_mvc_model_resultset_columns;
+
+phalcon_mvc_model_resultset_columns* phalcon_mvc_model_resultset_columns_build(zval *rows TSRMLS_DC);
+void phalcon_mvc_model_resultset_columns_release(phalcon_mvc_model_resultset_columns *columns);
+void phalcon_mvc_model_resultset_columns_fetch(zval *return_value, const phalcon_mvc_model_resultset_columns *columns, zend_uint row);
+int phalcon_mvc_model_resultset_columns_fetch_column(zval *return_value, const phalcon_mvc_model_resultset_columns *columns, const char *name, uint name_length);
+void phalcon_mvc_model_resultset_columns_to_array(zval *return_value, const phalcon_mvc_model_resultset_columns *columns);
+
+#endif /* PHALCON_MVC_MODEL_RESULTSET_COLUMNS_H */
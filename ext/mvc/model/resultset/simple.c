@@ -17,12 +17,16 @@
 */
 
 #include "mvc/model/resultset/simple.h"
+#include "mvc/model/resultset/columns.h"
 #include "mvc/model/resultset.h"
 #include "mvc/model/resultsetinterface.h"
 #include "mvc/model/exception.h"
 #include "mvc/model.h"
+#include "mvc/modelinterface.h"
+#include "db/result/pdo.h"
 
 #include <ext/pdo/php_pdo_driver.h>
+#include <ext/standard/php_smart_str.h>
 
 #include "kernel/main.h"
 #include "kernel/memory.h"
@@ -50,6 +54,15 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, valid);
 PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, toArray);
 PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, serialize);
 PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, unserialize);
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, eagerLoad);
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, _eagerLoad);
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, pluck);
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, indexBy);
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, groupBy);
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, sum);
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, min);
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, max);
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, filter);
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_resultset_simple___construct, 0, 0, 3)
 	ZEND_ARG_INFO(0, columnMap)
@@ -63,15 +76,98 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_resultset_simple_toarray, 0, 0,
 	ZEND_ARG_INFO(0, renameColumns)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_resultset_simple_eagerload, 0, 0, 1)
+	ZEND_ARG_INFO(0, relations)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_mvc_model_resultset_simple_column, 0, 0, 1)
+	ZEND_ARG_INFO(0, column)
+ZEND_END_ARG_INFO()
+
 static const zend_function_entry phalcon_mvc_model_resultset_simple_method_entry[] = {
 	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, __construct, arginfo_phalcon_mvc_model_resultset_simple___construct, ZEND_ACC_PUBLIC|ZEND_ACC_CTOR)
 	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, valid, arginfo_iterator_valid, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, toArray, arginfo_phalcon_mvc_model_resultset_simple_toarray, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, serialize, arginfo_serializable_serialize, ZEND_ACC_PUBLIC)
 	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, unserialize, arginfo_serializable_unserialize, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, eagerLoad, arginfo_phalcon_mvc_model_resultset_simple_eagerload, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, _eagerLoad, NULL, ZEND_ACC_PROTECTED)
+	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, pluck, arginfo_phalcon_mvc_model_resultset_simple_column, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, indexBy, arginfo_phalcon_mvc_model_resultset_simple_column, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, groupBy, arginfo_phalcon_mvc_model_resultset_simple_column, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, sum, arginfo_phalcon_mvc_model_resultset_simple_column, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, min, arginfo_phalcon_mvc_model_resultset_simple_column, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, max, arginfo_phalcon_mvc_model_resultset_simple_column, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Mvc_Model_Resultset_Simple, filter, arginfo_phalcon_mvc_model_resultset_filter, ZEND_ACC_PUBLIC)
 	PHP_FE_END
 };
 
+static zend_object_handlers phalcon_mvc_model_resultset_simple_object_handlers;
+
+typedef struct _phalcon_mvc_model_resultset_simple_object {
+	zend_object obj;                               /**< Zend object data */
+	phalcon_mvc_model_resultset_columns *columns;  /**< Rows stored by column, NULL if they are stored in _rows */
+	zend_class_entry *read_only_ce;                /**< Class whose methods were probed for read-only records */
+	zend_bool read_only_after_fetch;               /**< Whether read_only_ce implements afterFetch */
+} phalcon_mvc_model_resultset_simple_object;
+
+static inline phalcon_mvc_model_resultset_simple_object* phalcon_mvc_model_resultset_simple_get_object(zval *zobj TSRMLS_DC)
+{
+	return (phalcon_mvc_model_resultset_simple_object*)zend_objects_get_address(zobj TSRMLS_CC);
+}
+
+static void phalcon_mvc_model_resultset_simple_object_dtor(void *v TSRMLS_DC)
+{
+	phalcon_mvc_model_resultset_simple_object *obj = v;
+
+	if (obj->columns) {
+		phalcon_mvc_model_resultset_columns_release(obj->columns);
+	}
+
+	zend_object_std_dtor(&(obj->obj) TSRMLS_CC);
+	efree(obj);
+}
+
+static zend_object_value phalcon_mvc_model_resultset_simple_object_ctor(zend_class_entry *ce TSRMLS_DC)
+{
+	phalcon_mvc_model_resultset_simple_object *obj = ecalloc(1, sizeof(phalcon_mvc_model_resultset_simple_object));
+	zend_object_value retval;
+
+	zend_object_std_init(&obj->obj, ce TSRMLS_CC);
+	object_properties_init(&obj->obj, ce);
+
+	retval.handle = zend_objects_store_put(
+		obj,
+		(zend_objects_store_dtor_t)zend_objects_destroy_object,
+		phalcon_mvc_model_resultset_simple_object_dtor,
+		NULL
+		TSRMLS_CC
+	);
+
+	retval.handlers = &phalcon_mvc_model_resultset_simple_object_handlers;
+	return retval;
+}
+
+static zend_object_value phalcon_mvc_model_resultset_simple_clone_obj(zval *object TSRMLS_DC)
+{
+	phalcon_mvc_model_resultset_simple_object *orig  = phalcon_mvc_model_resultset_simple_get_object(object TSRMLS_CC);
+	zend_object_value result                         = phalcon_mvc_model_resultset_simple_object_ctor(Z_OBJCE_P(object) TSRMLS_CC);
+	phalcon_mvc_model_resultset_simple_object *clone = zend_object_store_get_object_by_handle(result.handle TSRMLS_CC);
+
+	zend_objects_clone_members(&clone->obj, result, &orig->obj, Z_OBJ_HANDLE_P(object) TSRMLS_CC);
+
+	/* The columns are immutable, clones share them */
+	if (orig->columns) {
+		clone->columns = orig->columns;
+		++clone->columns->refcount;
+	}
+
+	clone->read_only_ce          = orig->read_only_ce;
+	clone->read_only_after_fetch = orig->read_only_after_fetch;
+
+	return result;
+}
+
 /**
  * Phalcon\Mvc\Model\Resultset\Simple initializer
  */
@@ -79,15 +175,445 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Resultset_Simple){
 
 	PHALCON_REGISTER_CLASS_EX(Phalcon\\Mvc\\Model\\Resultset, Simple, mvc_model_resultset_simple, phalcon_mvc_model_resultset_ce, phalcon_mvc_model_resultset_simple_method_entry, 0);
 
+	phalcon_mvc_model_resultset_simple_ce->create_object = phalcon_mvc_model_resultset_simple_object_ctor;
+
+	phalcon_mvc_model_resultset_simple_object_handlers = *zend_get_std_object_handlers();
+	phalcon_mvc_model_resultset_simple_object_handlers.clone_obj = phalcon_mvc_model_resultset_simple_clone_obj;
+
 	zend_declare_property_null(phalcon_mvc_model_resultset_simple_ce, SL("_model"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_null(phalcon_mvc_model_resultset_simple_ce, SL("_columnMap"), ZEND_ACC_PROTECTED TSRMLS_CC);
 	zend_declare_property_bool(phalcon_mvc_model_resultset_simple_ce, SL("_keepSnapshots"), 0, ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_mvc_model_resultset_simple_ce, SL("_eager"), ZEND_ACC_PROTECTED TSRMLS_CC);
 
 	zend_class_implements(phalcon_mvc_model_resultset_simple_ce TSRMLS_CC, 5, zend_ce_iterator, spl_ce_SeekableIterator, spl_ce_Countable, zend_ce_arrayaccess, zend_ce_serializable);
 
 	return SUCCESS;
 }
 
+/**
+ * Checks whether the database result is able to report its number of rows without
+ * executing an extra query
+ */
+static int phalcon_mvc_model_resultset_simple_has_native_count(zval *result TSRMLS_DC) {
+
+	zval *connection, *type = NULL;
+	int native;
+
+	if (!instanceof_function_ex(Z_OBJCE_P(result), phalcon_db_result_pdo_ce, 0 TSRMLS_CC)) {
+		return 1;
+	}
+
+	connection = phalcon_fetch_nproperty_this(result, SL("_connection"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(connection) != IS_OBJECT) {
+		return 1;
+	}
+
+	if (phalcon_call_method(&type, connection, "gettype", 0, NULL TSRMLS_CC) == FAILURE) {
+		return 1;
+	}
+
+	native = PHALCON_IS_STRING(type, "mysql") || PHALCON_IS_STRING(type, "pgsql");
+	zval_ptr_dtor(&type);
+
+	return native;
+}
+
+/**
+ * Assigns the eager loaded relations to a hydrated record, the related records are stored
+ * in the same properties used by Phalcon\Mvc\Model::__get so no queries are executed later
+ */
+static void phalcon_mvc_model_resultset_simple_attach(zval *this_ptr, zval *record TSRMLS_DC) {
+
+	zval *eager, **entry, *alias, *field, *records, *related, *value;
+	HashPosition hp;
+
+	eager = phalcon_fetch_nproperty_this(this_ptr, SL("_eager"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(eager) != IS_ARRAY || Z_TYPE_P(record) != IS_OBJECT) {
+		return;
+	}
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(eager), &hp);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(eager), (void**) &entry, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(eager), &hp)
+	) {
+		if (!phalcon_array_isset_string_fetch(&alias, *entry, SS("alias"))
+			|| !phalcon_array_isset_string_fetch(&field, *entry, SS("field"))
+			|| !phalcon_array_isset_string_fetch(&records, *entry, SS("records"))
+			|| !phalcon_array_isset_string_fetch(&related, *entry, SS("default"))
+		) {
+			continue;
+		}
+
+		phalcon_read_property_zval(&value, record, field, PH_SILENT TSRMLS_CC);
+		if (Z_TYPE_P(value) != IS_NULL) {
+			phalcon_array_isset_fetch(&related, records, value);
+		}
+
+		zval_ptr_dtor(&value);
+
+		phalcon_update_property_zval_zval(record, alias, related TSRMLS_CC);
+
+		/** 
+		 * Single records are stored in the related bag as Phalcon\Mvc\Model::__get does
+		 */
+		if (Z_TYPE_P(related) == IS_OBJECT && instanceof_function_ex(Z_OBJCE_P(related), phalcon_mvc_modelinterface_ce, 1 TSRMLS_CC)) {
+			phalcon_update_property_array(record, SL("_related"), alias, related TSRMLS_CC);
+		}
+	}
+}
+
+/**
+ * Clones the base entity as a persistent record with the values of a row, unlike
+ * Phalcon\Mvc\Model::cloneResultMap it doesn't take snapshots nor dispatch any method
+ */
+static int phalcon_mvc_model_resultset_simple_read_only_record(zval *record, zval *base, zval *row, zval *column_map TSRMLS_DC) {
+
+	zval **value, *attribute, key;
+	HashPosition hp;
+
+	if (phalcon_clone(record, base TSRMLS_CC) == FAILURE) {
+		return FAILURE;
+	}
+
+	phalcon_update_property_long(record, SL("_dirtyState"), 0 TSRMLS_CC);
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(row), &hp);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(row), (void**) &value, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(row), &hp)
+	) {
+		key = phalcon_get_current_key_w(Z_ARRVAL_P(row), &hp);
+		if (Z_TYPE(key) != IS_STRING) {
+			continue;
+		}
+
+		if (Z_TYPE_P(column_map) != IS_ARRAY) {
+			phalcon_update_property_zval_zval(record, &key, *value TSRMLS_CC);
+		} else if (phalcon_array_isset_fetch(&attribute, column_map, &key)) {
+			phalcon_update_property_zval_zval(record, attribute, *value TSRMLS_CC);
+		} else {
+			zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "Column \"%s\" doesn't make part of the column map", Z_STRVAL(key));
+			return FAILURE;
+		}
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * Adds a dot separated relation path to the eager loading tree
+ */
+static void phalcon_mvc_model_resultset_simple_add_path(zval *tree, const char *path, uint path_length) {
+
+	zval *node = tree, **child, *new_child;
+	const char *part = path, *end = path + path_length, *dot;
+	char *key;
+	uint key_length;
+
+	while (part < end) {
+
+		dot = memchr(part, '.', end - part);
+		if (!dot) {
+			dot = end;
+		}
+
+		key_length = dot - part;
+		if (key_length) {
+			key = zend_str_tolower_dup(part, key_length);
+			if (zend_symtable_find(Z_ARRVAL_P(node), key, key_length + 1, (void**) &child) == SUCCESS) {
+				node = *child;
+			} else {
+				MAKE_STD_ZVAL(new_child);
+				array_init(new_child);
+				zend_symtable_update(Z_ARRVAL_P(node), key, key_length + 1, (void*) &new_child, sizeof(zval*), NULL);
+				node = new_child;
+			}
+
+			efree(key);
+		}
+
+		part = dot + 1;
+	}
+}
+
+/**
+ * Builds the parameters to find the records whose field is in the list of keys
+ */
+static void phalcon_mvc_model_resultset_simple_in_params(zval *params, zval *field, zval *keys, zval *dependency_injector) {
+
+	zval *conditions, *bind, **key;
+	smart_str sql = { NULL, 0, 0 };
+	HashPosition hp;
+	long int i = 0;
+
+	MAKE_STD_ZVAL(bind);
+	array_init_size(bind, zend_hash_num_elements(Z_ARRVAL_P(keys)));
+
+	smart_str_appendc(&sql, '[');
+	smart_str_appendl(&sql, Z_STRVAL_P(field), Z_STRLEN_P(field));
+	smart_str_appendl(&sql, "] IN (", 6);
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(keys), &hp);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(keys), (void**) &key, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(keys), &hp)
+	) {
+		if (i) {
+			smart_str_appendl(&sql, ", ", 2);
+		}
+
+		smart_str_appendc(&sql, '?');
+		smart_str_append_long(&sql, i);
+
+		Z_ADDREF_PP(key);
+		add_next_index_zval(bind, *key);
+		++i;
+	}
+
+	smart_str_appendc(&sql, ')');
+	smart_str_0(&sql);
+
+	MAKE_STD_ZVAL(conditions);
+	ZVAL_STRINGL(conditions, sql.c, sql.len, 0);
+
+	array_init_size(params, 3);
+	add_next_index_zval(params, conditions);
+	add_assoc_zval_ex(params, SS("bind"), bind);
+
+	Z_ADDREF_P(dependency_injector);
+	add_assoc_zval_ex(params, SS("di"), dependency_injector);
+}
+
+/**
+ * Appends a value to the group identified by key
+ */
+static void phalcon_mvc_model_resultset_simple_group(zval *grouped, zval *key, zval *value) {
+
+	zval *group;
+
+	if (!phalcon_array_isset_fetch(&group, grouped, key)) {
+		MAKE_STD_ZVAL(group);
+		array_init(group);
+		phalcon_array_update_zval(&grouped, key, group, 0);
+	}
+
+	Z_ADDREF_P(value);
+	add_next_index_zval(group, value);
+}
+
+/**
+ * Keeps the materialized rows of the resultset, large sets are stored by column when
+ * phalcon.orm.columnar_resultsets is enabled
+ */
+void phalcon_mvc_model_resultset_simple_store_rows(zval *this_ptr, zval *rows TSRMLS_DC) {
+
+	phalcon_mvc_model_resultset_simple_object *obj = phalcon_mvc_model_resultset_simple_get_object(this_ptr TSRMLS_CC);
+	phalcon_mvc_model_resultset_columns *columns = NULL;
+	long threshold = PHALCON_GLOBAL(orm).columnar_resultsets;
+
+	if (obj->columns) {
+		phalcon_mvc_model_resultset_columns_release(obj->columns);
+		obj->columns = NULL;
+	}
+
+	if (threshold > 0 && Z_TYPE_P(rows) == IS_ARRAY && zend_hash_num_elements(Z_ARRVAL_P(rows)) >= (ulong)threshold) {
+		columns = phalcon_mvc_model_resultset_columns_build(rows TSRMLS_CC);
+	}
+
+	if (!columns) {
+		phalcon_update_property_this(this_ptr, SL("_rows"), rows TSRMLS_CC);
+		return;
+	}
+
+	/**
+	 * _rows is not an array nor null, so the cursor methods only move _pointer
+	 */
+	obj->columns = columns;
+	phalcon_update_property_bool(this_ptr, SL("_rows"), 0 TSRMLS_CC);
+	phalcon_update_property_long(this_ptr, SL("_count"), columns->num_rows TSRMLS_CC);
+}
+
+/**
+ * Renames the columns of raw rows, the column map is looked up once per column instead of
+ * once per value because the rows share the same columns
+ */
+static int phalcon_mvc_model_resultset_simple_rename(zval *renamed_records, zval *records, zval *column_map TSRMLS_DC) {
+
+	zval **record, **value, *renamed, *renamed_key, *cached_keys = NULL, **cached_renamed = NULL;
+	HashTable *ah0, *ah1;
+	HashPosition hp0, hp1;
+	uint num_cached = 0, j;
+	int cached;
+
+	array_init(renamed_records);
+	if (Z_TYPE_P(records) != IS_ARRAY) {
+		return SUCCESS;
+	}
+
+	ah0 = Z_ARRVAL_P(records);
+
+	for (
+		zend_hash_internal_pointer_reset_ex(ah0, &hp0);
+		zend_hash_get_current_data_ex(ah0, (void**) &record, &hp0) == SUCCESS;
+		zend_hash_move_forward_ex(ah0, &hp0)
+	) {
+		if (Z_TYPE_PP(record) != IS_ARRAY) {
+			continue;
+		}
+
+		ah1 = Z_ARRVAL_PP(record);
+
+		/** 
+		 * The keys of the first row are resolved and reused for the next rows
+		 */
+		if (!cached_keys) {
+			num_cached     = zend_hash_num_elements(ah1);
+			cached_keys    = safe_emalloc(num_cached + 1, sizeof(zval), 0);
+			cached_renamed = safe_emalloc(num_cached + 1, sizeof(zval*), 0);
+			cached         = 0;
+		} else {
+			cached = 1;
+		}
+
+		MAKE_STD_ZVAL(renamed);
+		array_init_size(renamed, zend_hash_num_elements(ah1));
+
+		for (
+			zend_hash_internal_pointer_reset_ex(ah1, &hp1), j = 0;
+			zend_hash_get_current_data_ex(ah1, (void**) &value, &hp1) == SUCCESS;
+			zend_hash_move_forward_ex(ah1, &hp1), ++j
+		) {
+			zval key = phalcon_get_current_key_w(ah1, &hp1);
+
+			if (cached && j < num_cached && Z_TYPE(key) == Z_TYPE(cached_keys[j]) && (
+				Z_TYPE(key) == IS_STRING
+					? (Z_STRLEN(key) == Z_STRLEN(cached_keys[j]) && !memcmp(Z_STRVAL(key), Z_STRVAL(cached_keys[j]), Z_STRLEN(key)))
+					: Z_LVAL(key) == Z_LVAL(cached_keys[j])
+			)) {
+				renamed_key = cached_renamed[j];
+			} else {
+				/** 
+				 * Check if the key is part of the column map
+				 */
+				if (!phalcon_array_isset_fetch(&renamed_key, column_map, &key)) {
+					if (Z_TYPE(key) == IS_STRING) {
+						zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "Column '%s' is not part of the column map", Z_STRVAL(key));
+					} else {
+						zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "Column '%ld' is not part of the column map", Z_LVAL(key));
+					}
+
+					zval_ptr_dtor(&renamed);
+					efree(cached_keys);
+					efree(cached_renamed);
+					return FAILURE;
+				}
+
+				if (!cached && j < num_cached) {
+					cached_keys[j]    = key;
+					cached_renamed[j] = renamed_key;
+				}
+			}
+
+			phalcon_array_update_zval(&renamed, renamed_key, *value, PH_COPY);
+		}
+
+		add_next_index_zval(renamed_records, renamed);
+	}
+
+	if (cached_keys) {
+		efree(cached_keys);
+		efree(cached_renamed);
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * Returns the name of the raw column that holds an attribute
+ */
+static int phalcon_mvc_model_resultset_simple_raw_column(zval *raw_column, zval *this_ptr, zval *column TSRMLS_DC) {
+
+	zval *column_map, **renamed;
+	HashPosition hp;
+
+	if (Z_TYPE_P(column) != IS_STRING) {
+		PHALCON_THROW_EXCEPTION_STRW(phalcon_mvc_model_exception_ce, "The column name must be a string");
+		return FAILURE;
+	}
+
+	column_map = phalcon_fetch_nproperty_this(this_ptr, SL("_columnMap"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(column_map) != IS_ARRAY) {
+		ZVAL_ZVAL(raw_column, column, 1, 0);
+		return SUCCESS;
+	}
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(column_map), &hp);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(column_map), (void**) &renamed, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(column_map), &hp)
+	) {
+		if (Z_TYPE_PP(renamed) == IS_STRING && Z_STRLEN_PP(renamed) == Z_STRLEN_P(column) && !memcmp(Z_STRVAL_PP(renamed), Z_STRVAL_P(column), Z_STRLEN_P(column))) {
+			zval key = phalcon_get_current_key_w(Z_ARRVAL_P(column_map), &hp);
+			ZVAL_ZVAL(raw_column, &key, 1, 0);
+			return SUCCESS;
+		}
+	}
+
+	zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "Column '%s' is not part of the column map", Z_STRVAL_P(column));
+	return FAILURE;
+}
+
+/**
+ * Collects the values of a raw column, rows stored by column are read without rebuilding them
+ */
+static int phalcon_mvc_model_resultset_simple_values(zval *values, zval *this_ptr, zval *raw_column, zval *records TSRMLS_DC) {
+
+	phalcon_mvc_model_resultset_simple_object *obj = phalcon_mvc_model_resultset_simple_get_object(this_ptr TSRMLS_CC);
+	zval **record, *value;
+	HashPosition hp;
+
+	if (!records) {
+		if (phalcon_mvc_model_resultset_columns_fetch_column(values, obj->columns, Z_STRVAL_P(raw_column), Z_STRLEN_P(raw_column)) == FAILURE) {
+			zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "Column '%s' is not part of the resultset", Z_STRVAL_P(raw_column));
+			return FAILURE;
+		}
+
+		return SUCCESS;
+	}
+
+	array_init_size(values, zend_hash_num_elements(Z_ARRVAL_P(records)));
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(records), &hp);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(records), (void**) &record, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(records), &hp)
+	) {
+		if (!phalcon_array_isset_fetch(&value, *record, raw_column)) {
+			zend_throw_exception_ex(phalcon_mvc_model_exception_ce, 0 TSRMLS_CC, "Column '%s' is not part of the resultset", Z_STRVAL_P(raw_column));
+			return FAILURE;
+		}
+
+		Z_ADDREF_P(value);
+		add_next_index_zval(values, value);
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * Creates a resultset that serves the passed rows from memory
+ */
+static void phalcon_mvc_model_resultset_simple_from_rows(zval *resultset, zval *model, zval *column_map, zval *rows, zval *keep_snapshots, zval *eager TSRMLS_DC) {
+
+	object_init_ex(resultset, phalcon_mvc_model_resultset_simple_ce);
+	phalcon_update_property_this(resultset, SL("_model"), model TSRMLS_CC);
+	phalcon_update_property_this(resultset, SL("_columnMap"), column_map TSRMLS_CC);
+	phalcon_update_property_this(resultset, SL("_keepSnapshots"), keep_snapshots TSRMLS_CC);
+	phalcon_update_property_this(resultset, SL("_eager"), eager TSRMLS_CC);
+	phalcon_mvc_model_resultset_simple_store_rows(resultset, rows TSRMLS_CC);
+}
+
 /**
  * Phalcon\Mvc\Model\Resultset\Simple constructor
  *
@@ -100,7 +626,8 @@ PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Resultset_Simple){
 PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, __construct){
 
 	zval *column_map, *model, *result, *cache = NULL, *keep_snapshots = NULL;
-	zval *fetch_assoc, *limit, *row_count = NULL, *big_resultset;
+	zval *fetch_assoc, *limit, *row_count = NULL, *big_resultset, *rows, *row = NULL;
+	long i;
 
 	PHALCON_MM_GROW();
 
@@ -132,23 +659,59 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, __construct){
 	PHALCON_INIT_VAR(limit);
 	ZVAL_LONG(limit, 32);
 	
-	PHALCON_CALL_METHOD(&row_count, result, "numrows");
+	if (phalcon_mvc_model_resultset_simple_has_native_count(result TSRMLS_CC)) {
 	
-	/** 
-	 * Check if it's a big resultset
-	 */
-	PHALCON_INIT_VAR(big_resultset);
-	is_smaller_function(big_resultset, limit, row_count TSRMLS_CC);
-	if (PHALCON_IS_TRUE(big_resultset)) {
-		phalcon_update_property_long(this_ptr, SL("_type"), 1 TSRMLS_CC);
+		PHALCON_CALL_METHOD(&row_count, result, "numrows");
+	
+		/** 
+		 * Check if it's a big resultset
+		 */
+		PHALCON_INIT_VAR(big_resultset);
+		is_smaller_function(big_resultset, limit, row_count TSRMLS_CC);
+		if (PHALCON_IS_TRUE(big_resultset)) {
+			phalcon_update_property_long(this_ptr, SL("_type"), 1 TSRMLS_CC);
+		} else {
+			phalcon_update_property_long(this_ptr, SL("_type"), 0 TSRMLS_CC);
+		}
+	
+		/** 
+		 * Update the row-count
+		 */
+		phalcon_update_property_this(this_ptr, SL("_count"), row_count TSRMLS_CC);
 	} else {
-		phalcon_update_property_long(this_ptr, SL("_type"), 0 TSRMLS_CC);
-	}
+		/** 
+		 * The driver would need an extra SELECT COUNT(*) to know the number of rows,
+		 * so we read up to limit + 1 rows instead. Small resultsets are kept in memory
+		 * and their row-count is known for free
+		 */
+		PHALCON_INIT_VAR(rows);
+		array_init(rows);
 	
-	/** 
-	 * Update the row-count
-	 */
-	phalcon_update_property_this(this_ptr, SL("_count"), row_count TSRMLS_CC);
+		for (i = 0; i <= Z_LVAL_P(limit); i++) {
+			PHALCON_CALL_METHOD(&row, result, "fetch");
+			if (Z_TYPE_P(row) != IS_ARRAY) {
+				break;
+			}
+	
+			phalcon_array_append(&rows, row, 0);
+		}
+	
+		if (i <= Z_LVAL_P(limit)) {
+			zend_hash_internal_pointer_reset(Z_ARRVAL_P(rows));
+	
+			phalcon_update_property_long(this_ptr, SL("_type"), 0 TSRMLS_CC);
+			phalcon_update_property_long(this_ptr, SL("_count"), i TSRMLS_CC);
+			phalcon_mvc_model_resultset_simple_store_rows(this_ptr, rows TSRMLS_CC);
+		} else {
+			/** 
+			 * Big resultsets continue from the open cursor, the rows already read are served
+			 * first. The count is only calculated if it's explicitly requested
+			 */
+			zend_hash_internal_pointer_reset(Z_ARRVAL_P(rows));
+			phalcon_update_property_this(this_ptr, SL("_prefetched"), rows TSRMLS_CC);
+			phalcon_update_property_long(this_ptr, SL("_type"), 1 TSRMLS_CC);
+		}
+	}
 	
 	/** 
 	 * Set if the returned resultset must keep the record snapshots
@@ -166,17 +729,31 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, __construct){
 PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, valid){
 
 	zval *type, *result = NULL, *row = NULL, *rows = NULL, *dirty_state, *hydrate_mode;
-	zval *keep_snapshots, *column_map, *model, *active_row = NULL;
+	zval *keep_snapshots, *column_map, *model, *active_row = NULL, *prefetched;
+	phalcon_mvc_model_resultset_simple_object *obj;
+	zval **hd;
+	long pointer;
 
 	PHALCON_MM_GROW();
 
+	obj = phalcon_mvc_model_resultset_simple_get_object(this_ptr TSRMLS_CC);
+
 	PHALCON_OBS_VAR(type);
 	phalcon_read_property_this(&type, this_ptr, SL("_type"), PH_NOISY TSRMLS_CC);
 	if (zend_is_true(type)) {
 	
 		PHALCON_OBS_VAR(result);
 		phalcon_read_property_this(&result, this_ptr, SL("_result"), PH_NOISY TSRMLS_CC);
-		if (Z_TYPE_P(result) == IS_OBJECT) {
+	
+		/** 
+		 * Rows read by the constructor are served before fetching from the cursor again
+		 */
+		prefetched = phalcon_fetch_nproperty_this(this_ptr, SL("_prefetched"), PH_NOISY TSRMLS_CC);
+		if (Z_TYPE_P(prefetched) == IS_ARRAY && zend_hash_get_current_data(Z_ARRVAL_P(prefetched), (void**) &hd) == SUCCESS) {
+			PHALCON_INIT_VAR(row);
+			ZVAL_ZVAL(row, *hd, 1, 0);
+			zend_hash_move_forward(Z_ARRVAL_P(prefetched));
+		} else if (Z_TYPE_P(result) == IS_OBJECT) {
 			PHALCON_CALL_METHOD(&row, result, "fetch", result);
 		} else {
 			PHALCON_INIT_VAR(row);
@@ -185,17 +762,30 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, valid){
 	} else {
 		PHALCON_OBS_VAR(rows);
 		phalcon_read_property_this(&rows, this_ptr, SL("_rows"), PH_NOISY TSRMLS_CC);
-		if (Z_TYPE_P(rows) != IS_ARRAY) { 
+		if (Z_TYPE_P(rows) != IS_ARRAY && !obj->columns) { 
 	
 			PHALCON_OBS_NVAR(result);
 			phalcon_read_property_this(&result, this_ptr, SL("_result"), PH_NOISY TSRMLS_CC);
 			if (Z_TYPE_P(result) == IS_OBJECT) {
 				PHALCON_CALL_METHOD(&rows, result, "fetchall");
-				phalcon_update_property_this(this_ptr, SL("_rows"), rows TSRMLS_CC);
+				phalcon_mvc_model_resultset_simple_store_rows(this_ptr, rows TSRMLS_CC);
 			}
 		}
 	
-		if (Z_TYPE_P(rows) == IS_ARRAY) { 
+		if (obj->columns) {
+	
+			/** 
+			 * Rows stored by column are rebuilt from the position of the cursor
+			 */
+			pointer = phalcon_get_intval(phalcon_fetch_nproperty_this(this_ptr, SL("_pointer"), PH_NOISY TSRMLS_CC));
+	
+			PHALCON_INIT_NVAR(row);
+			if (pointer >= 0 && (ulong)pointer < obj->columns->num_rows) {
+				phalcon_mvc_model_resultset_columns_fetch(row, obj->columns, (zend_uint)pointer);
+			} else {
+				ZVAL_BOOL(row, 0);
+			}
+		} else if (Z_TYPE_P(rows) == IS_ARRAY) { 
 	
 			PHALCON_INIT_NVAR(row);
 			phalcon_array_get_current(row, rows);
@@ -253,6 +843,41 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, valid){
 			 * Performs the standard hydration based on objects
 			 */
 			PHALCON_CALL_CE_STATIC(&active_row, phalcon_mvc_model_ce, "cloneresultmap", model, row, column_map, dirty_state, keep_snapshots);
+	
+			/** 
+			 * Assign the eager loaded relations to the record
+			 */
+			phalcon_mvc_model_resultset_simple_attach(this_ptr, active_row TSRMLS_CC);
+			break;
+	
+		case 3:
+			PHALCON_OBS_VAR(model);
+			phalcon_read_property_this(&model, this_ptr, SL("_model"), PH_NOISY TSRMLS_CC);
+	
+			/** 
+			 * Read-only records are plain clones of the base entity: no snapshots and no
+			 * per row method probes, the DI and the models manager are shared with the base
+			 */
+			if (obj->read_only_ce != Z_OBJCE_P(model)) {
+				obj->read_only_ce          = Z_OBJCE_P(model);
+				obj->read_only_after_fetch = zend_hash_exists(&obj->read_only_ce->function_table, SS("afterfetch"));
+			}
+	
+			PHALCON_INIT_VAR(active_row);
+			if (phalcon_mvc_model_resultset_simple_read_only_record(active_row, model, row, column_map TSRMLS_CC) == FAILURE) {
+				RETURN_MM();
+			}
+	
+			if (obj->read_only_after_fetch) {
+				PHALCON_CALL_METHOD(NULL, active_row, "afterfetch");
+			}
+	
+			phalcon_mvc_model_resultset_simple_attach(this_ptr, active_row TSRMLS_CC);
+	
+			/** 
+			 * Any write after this point is rejected
+			 */
+			phalcon_mvc_model_make_read_only(active_row TSRMLS_CC);
 			break;
 	
 		default:
@@ -279,14 +904,13 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, toArray){
 
 	zval *rename_columns = NULL, *type, *result = NULL, *active_row = NULL;
 	zval *records = NULL, *row_count, *column_map, *renamed_records;
-	zval *record = NULL, *renamed = NULL, *value = NULL, *key = NULL, *exception_message = NULL;
-	zval *renamed_key = NULL;
-	HashTable *ah0, *ah1;
-	HashPosition hp0, hp1;
-	zval **hd;
+	zval *prefetched, *rows = NULL, *merged;
+	phalcon_mvc_model_resultset_simple_object *obj;
 
 	PHALCON_MM_GROW();
 
+	obj = phalcon_mvc_model_resultset_simple_get_object(this_ptr TSRMLS_CC);
+
 	phalcon_fetch_params(1, 0, 1, &rename_columns);
 	
 	if (!rename_columns) {
@@ -307,18 +931,41 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, toArray){
 			/** 
 			 * Check if we need to re-execute the query
 			 */
+			prefetched = phalcon_fetch_nproperty_this(this_ptr, SL("_prefetched"), PH_NOISY TSRMLS_CC);
 			if (Z_TYPE_P(active_row) != IS_NULL) {
 				PHALCON_CALL_METHOD(NULL, result, "execute");
+				phalcon_update_property_null(this_ptr, SL("_prefetched") TSRMLS_CC);
+			} else if (Z_TYPE_P(prefetched) == IS_ARRAY) {
+				PHALCON_INIT_VAR(rows);
+				ZVAL_ZVAL(rows, prefetched, 1, 0);
+				phalcon_update_property_null(this_ptr, SL("_prefetched") TSRMLS_CC);
 			}
 	
 			/** 
 			 * We fetch all the results in memory
 			 */
 			PHALCON_CALL_METHOD(&records, result, "fetchall");
+	
+			/** 
+			 * Force to re-execute the query in the next traversal
+			 */
+			phalcon_update_property_bool(this_ptr, SL("_activeRow"), 0 TSRMLS_CC);
+	
+			/** 
+			 * The rows read by the constructor are not in the cursor anymore
+			 */
+			if (rows && Z_TYPE_P(records) == IS_ARRAY) {
+				PHALCON_INIT_VAR(merged);
+				phalcon_fast_array_merge(merged, &rows, &records TSRMLS_CC);
+				PHALCON_CPY_WRT(records, merged);
+			}
 		} else {
 			PHALCON_INIT_NVAR(records);
 			array_init(records);
 		}
+	} else if (obj->columns) {
+		PHALCON_INIT_NVAR(records);
+		phalcon_mvc_model_resultset_columns_to_array(records, obj->columns);
 	} else {
 		PHALCON_OBS_NVAR(records);
 		phalcon_read_property_this(&records, this_ptr, SL("_rows"), PH_NOISY TSRMLS_CC);
@@ -342,7 +989,6 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, toArray){
 				 * We fetch all the results in memory again
 				 */
 				PHALCON_CALL_METHOD(&records, result, "fetchall");
-				phalcon_update_property_this(this_ptr, SL("_rows"), records TSRMLS_CC);
 	
 				/** 
 				 * Update the row count
@@ -350,6 +996,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, toArray){
 				PHALCON_INIT_VAR(row_count);
 				phalcon_fast_count(row_count, records TSRMLS_CC);
 				phalcon_update_property_this(this_ptr, SL("_count"), row_count TSRMLS_CC);
+				phalcon_mvc_model_resultset_simple_store_rows(this_ptr, records TSRMLS_CC);
 			}
 			else {
 				PHALCON_INIT_NVAR(records);
@@ -373,57 +1020,8 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, toArray){
 		}
 	
 		PHALCON_INIT_VAR(renamed_records);
-		array_init(renamed_records);
-		if (Z_TYPE_P(records) == IS_ARRAY) { 
-	
-			phalcon_is_iterable(records, &ah0, &hp0, 0, 0);
-	
-			while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
-	
-				PHALCON_GET_HVALUE(record);
-	
-				PHALCON_INIT_NVAR(renamed);
-				array_init(renamed);
-	
-				phalcon_is_iterable(record, &ah1, &hp1, 0, 0);
-	
-				while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
-	
-					PHALCON_GET_HKEY(key, ah1, hp1);
-					PHALCON_GET_HVALUE(value);
-	
-					/** 
-					 * Check if the key is part of the column map
-					 */
-					if (!phalcon_array_isset(column_map, key)) {
-						PHALCON_INIT_NVAR(exception_message);
-						PHALCON_CONCAT_SVS(exception_message, "Column '", key, "' is not part of the column map");
-						PHALCON_THROW_EXCEPTION_ZVAL(phalcon_mvc_model_exception_ce, exception_message);
-						return;
-					}
-	
-					/** 
-					 * Get the renamed column
-					 */
-					PHALCON_OBS_NVAR(renamed_key);
-					phalcon_array_fetch(&renamed_key, column_map, key, PH_NOISY);
-	
-					/** 
-					 * Add the value renamed
-					 */
-					phalcon_array_update_zval(&renamed, renamed_key, value, PH_COPY | PH_SEPARATE);
-	
-					zend_hash_move_forward_ex(ah1, &hp1);
-				}
-	
-				/** 
-				 * Append the renamed records to the main array
-				 */
-				phalcon_array_append(&renamed_records, renamed, PH_SEPARATE);
-	
-				zend_hash_move_forward_ex(ah0, &hp0);
-			}
-	
+		if (phalcon_mvc_model_resultset_simple_rename(renamed_records, records, column_map TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
 		}
 	
 		RETURN_CTOR(renamed_records);
@@ -440,7 +1038,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, toArray){
 PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, serialize){
 
 	zval *rename_columns, *records = NULL, *model, *cache;
-	zval *column_map, *hydrate_mode, *data;
+	zval *column_map, *hydrate_mode, *data, *encoded;
 
 	PHALCON_MM_GROW();
 
@@ -449,6 +1047,15 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, serialize){
 	
 	PHALCON_CALL_METHOD(&records, this_ptr, "toarray", rename_columns);
 	
+	/** 
+	 * Rows are stored in the compact columnar format, the plain array is kept if they
+	 * can't be represented in it
+	 */
+	PHALCON_INIT_VAR(encoded);
+	if (phalcon_mvc_model_resultset_encode_rows(encoded, records TSRMLS_CC) == SUCCESS) {
+		PHALCON_CPY_WRT(records, encoded);
+	}
+	
 	PHALCON_OBS_VAR(model);
 	phalcon_read_property_this(&model, this_ptr, SL("_model"), PH_NOISY TSRMLS_CC);
 	
@@ -489,7 +1096,7 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, serialize){
 PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, unserialize){
 
 	zval *data, *resultset, *model, *rows, *cache, *column_map;
-	zval *hydrate_mode;
+	zval *hydrate_mode, *decoded;
 
 	PHALCON_MM_GROW();
 
@@ -510,7 +1117,21 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, unserialize){
 	
 	PHALCON_OBS_VAR(rows);
 	phalcon_array_fetch_string(&rows, resultset, SL("rows"), PH_NOISY);
-	phalcon_update_property_this(this_ptr, SL("_rows"), rows TSRMLS_CC);
+	
+	/** 
+	 * Rows serialized by older versions are plain arrays
+	 */
+	if (Z_TYPE_P(rows) == IS_STRING) {
+		PHALCON_INIT_VAR(decoded);
+		if (phalcon_mvc_model_resultset_decode_rows(decoded, rows TSRMLS_CC) == FAILURE) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Invalid serialization data");
+			return;
+		}
+	
+		PHALCON_CPY_WRT(rows, decoded);
+	}
+	
+	phalcon_mvc_model_resultset_simple_store_rows(this_ptr, rows TSRMLS_CC);
 	
 	PHALCON_OBS_VAR(cache);
 	phalcon_array_fetch_string(&cache, resultset, SL("cache"), PH_NOISY);
@@ -526,3 +1147,894 @@ PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, unserialize){
 	
 	PHALCON_MM_RESTORE();
 }
+
+/**
+ * Fetches the raw rows needed by the hydration-free operations, rows stored by column are
+ * not rebuilt when only the values of a column are needed
+ */
+static int phalcon_mvc_model_resultset_simple_raw_rows(zval **records, zval *this_ptr, int need_rows TSRMLS_DC) {
+
+	phalcon_mvc_model_resultset_simple_object *obj = phalcon_mvc_model_resultset_simple_get_object(this_ptr TSRMLS_CC);
+	zval *rename_columns = PHALCON_GLOBAL(z_false);
+
+	*records = NULL;
+	if (obj->columns && !need_rows) {
+		return SUCCESS;
+	}
+
+	return phalcon_call_method(records, this_ptr, "toarray", 1, &rename_columns TSRMLS_CC);
+}
+
+/**
+ * Finds the records of a model whose field is in the list of keys. The list is split in chunks
+ * that fit in the parameters accepted by the database system and the rows of the chunks are
+ * merged in a single resultset
+ */
+static void phalcon_mvc_model_resultset_simple_find_in(zval *return_value, zval *manager, zval *model_name, zval *field, zval *keys, zval *dependency_injector TSRMLS_DC) {
+
+	zval *model = NULL, *connection = NULL, *dialect = NULL, *max_list_params = NULL;
+	zval *chunk = NULL, *params = NULL, *resultset = NULL, *chunk_rows = NULL, *rows;
+	zval *column_map = NULL, *keep_snapshots = NULL, **key, **row;
+	zend_class_entry *ce0;
+	HashPosition hp0, hp1;
+	long int chunk_size, remaining;
+
+	PHALCON_MM_GROW();
+
+	PHALCON_CALL_METHOD(&model, manager, "load", model_name);
+	PHALCON_CALL_METHOD(&connection, model, "getreadconnection");
+	PHALCON_CALL_METHOD(&dialect, connection, "getdialect");
+	PHALCON_CALL_METHOD(&max_list_params, dialect, "getmaxlistparams");
+
+	chunk_size = phalcon_get_intval(max_list_params);
+	if (chunk_size < 1) {
+		chunk_size = 1;
+	}
+
+	ce0 = phalcon_fetch_class(model_name TSRMLS_CC);
+
+	if (zend_hash_num_elements(Z_ARRVAL_P(keys)) <= chunk_size) {
+		PHALCON_INIT_VAR(params);
+		phalcon_mvc_model_resultset_simple_in_params(params, field, keys, dependency_injector);
+
+		PHALCON_CALL_CE_STATIC(&resultset, ce0, "find", params);
+		RETURN_CTOR(resultset);
+	}
+
+	PHALCON_INIT_VAR(rows);
+	array_init(rows);
+
+	PHALCON_INIT_VAR(chunk);
+	array_init_size(chunk, chunk_size);
+
+	remaining = zend_hash_num_elements(Z_ARRVAL_P(keys));
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(keys), &hp0);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(keys), (void**) &key, &hp0) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(keys), &hp0)
+	) {
+		Z_ADDREF_PP(key);
+		add_next_index_zval(chunk, *key);
+
+		if (--remaining && zend_hash_num_elements(Z_ARRVAL_P(chunk)) < chunk_size) {
+			continue;
+		}
+
+		PHALCON_INIT_NVAR(params);
+		phalcon_mvc_model_resultset_simple_in_params(params, field, chunk, dependency_injector);
+
+		PHALCON_CALL_CE_STATIC(&resultset, ce0, "find", params);
+		PHALCON_CALL_METHOD(&chunk_rows, resultset, "toarray", PHALCON_GLOBAL(z_false));
+
+		for (
+			zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(chunk_rows), &hp1);
+			zend_hash_get_current_data_ex(Z_ARRVAL_P(chunk_rows), (void**) &row, &hp1) == SUCCESS;
+			zend_hash_move_forward_ex(Z_ARRVAL_P(chunk_rows), &hp1)
+		) {
+			Z_ADDREF_PP(row);
+			add_next_index_zval(rows, *row);
+		}
+
+		PHALCON_INIT_NVAR(chunk);
+		array_init_size(chunk, chunk_size);
+	}
+
+	PHALCON_OBS_VAR(column_map);
+	phalcon_read_property(&column_map, resultset, SL("_columnMap"), PH_NOISY TSRMLS_CC);
+
+	PHALCON_OBS_VAR(keep_snapshots);
+	phalcon_read_property(&keep_snapshots, resultset, SL("_keepSnapshots"), PH_NOISY TSRMLS_CC);
+
+	phalcon_mvc_model_resultset_simple_from_rows(return_value, model, column_map, rows, keep_snapshots, PHALCON_GLOBAL(z_null) TSRMLS_CC);
+
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Loads the related records of every record in the resultset executing a single query per relation
+ * level. Later accesses to the relations are served from memory
+ *
+ *<code>
+ * $robots = Robots::find();
+ * $robots->eagerLoad(array('robotsParts', 'robotsParts.parts'));
+ * foreach ($robots as $robot) {
+ *     foreach ($robot->robotsParts as $robotPart) {
+ *         echo $robotPart->parts->name, PHP_EOL;
+ *     }
+ * }
+ *</code>
+ *
+ * @param string|array $relations
+ * @return Phalcon\Mvc\Model\Resultset\Simple
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, eagerLoad){
+
+	zval *relations, *tree, *path = NULL;
+	HashTable *ah0;
+	HashPosition hp0;
+	zval **hd;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &relations);
+	
+	PHALCON_INIT_VAR(tree);
+	array_init(tree);
+	
+	if (Z_TYPE_P(relations) == IS_STRING) {
+		phalcon_mvc_model_resultset_simple_add_path(tree, Z_STRVAL_P(relations), Z_STRLEN_P(relations));
+	} else {
+		if (Z_TYPE_P(relations) != IS_ARRAY) { 
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Relations to eager load must be a string or an array");
+			return;
+		}
+	
+		phalcon_is_iterable(relations, &ah0, &hp0, 0, 0);
+	
+		while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+			PHALCON_GET_HVALUE(path);
+	
+			if (Z_TYPE_P(path) != IS_STRING) {
+				PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Relations to eager load must be a string or an array");
+				return;
+			}
+	
+			phalcon_mvc_model_resultset_simple_add_path(tree, Z_STRVAL_P(path), Z_STRLEN_P(path));
+	
+			zend_hash_move_forward_ex(ah0, &hp0);
+		}
+	}
+	
+	PHALCON_CALL_METHOD(NULL, this_ptr, "_eagerload", tree);
+	
+	RETURN_THIS();
+}
+
+/**
+ * Loads every relation in an eager loading tree, nested relations are loaded on the related
+ * resultsets before they are distributed among the records
+ *
+ * @param array $tree
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, _eagerLoad){
+
+	zval *tree, *model, *model_name, *manager = NULL, *dependency_injector = NULL;
+	zval *alias = NULL, *subtree = NULL, *relation = NULL, *exception_message = NULL;
+	zval *fields = NULL, *referenced_fields = NULL, *referenced_model = NULL;
+	zval *type = NULL, *is_through = NULL, *keys = NULL, *links = NULL, *link_keys = NULL;
+	zval *intermediate_model = NULL, *intermediate_fields = NULL, *intermediate_referenced_fields = NULL;
+	zval *intermediate_records = NULL, *children = NULL, *record = NULL;
+	zval *raw_records = NULL, *raw_column = NULL, *raw_values = NULL;
+	zval *value = NULL, *link_value = NULL, *records = NULL, *rows = NULL, *row = NULL;
+	zval *column_map = NULL, *column = NULL, *attribute = NULL, *by_key = NULL, *grouped = NULL;
+	zval *group = NULL, *group_key = NULL, *related = NULL, *empty_rows = NULL, *entry = NULL;
+	zval *children_model = NULL, *keep_snapshots = NULL, *children_eager = NULL, *r0 = NULL;
+	zval *query_keys, *row_key, *linked_row;
+	HashTable *ah0, *ah1, *ah2;
+	HashPosition hp0, hp1, hp2;
+	zval **hd;
+	int single;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &tree);
+	
+	if (Z_TYPE_P(tree) != IS_ARRAY) { 
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "The eager loading tree must be an array");
+		return;
+	}
+	
+	model = phalcon_fetch_nproperty_this(this_ptr, SL("_model"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(model) != IS_OBJECT || !instanceof_function_ex(Z_OBJCE_P(model), phalcon_mvc_modelinterface_ce, 1 TSRMLS_CC)) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Only resultsets of complete objects can eager load relations");
+		return;
+	}
+	
+	PHALCON_INIT_VAR(model_name);
+	phalcon_get_class(model_name, model, 0 TSRMLS_CC);
+	
+	PHALCON_CALL_METHOD(&manager, model, "getmodelsmanager");
+	PHALCON_CALL_METHOD(&dependency_injector, model, "getdi");
+	
+	/** 
+	 * The rows are fetched once for all the relations, the records aren't hydrated
+	 */
+	PHALCON_OBSERVE_OR_NULLIFY_VAR(raw_records);
+	if (phalcon_mvc_model_resultset_simple_raw_rows(&raw_records, this_ptr, 0 TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+	
+	phalcon_is_iterable(tree, &ah0, &hp0, 0, 0);
+	
+	while (zend_hash_get_current_data_ex(ah0, (void**) &hd, &hp0) == SUCCESS) {
+	
+		PHALCON_GET_HKEY(alias, ah0, hp0);
+		PHALCON_GET_HVALUE(subtree);
+	
+		PHALCON_CALL_METHOD(&relation, manager, "getrelationbyalias", model_name, alias);
+		if (Z_TYPE_P(relation) != IS_OBJECT) {
+			PHALCON_INIT_NVAR(exception_message);
+			PHALCON_CONCAT_SVSVS(exception_message, "There is no defined relations for the model \"", model_name, "\" using alias \"", alias, "\"");
+			PHALCON_THROW_EXCEPTION_ZVAL(phalcon_mvc_model_exception_ce, exception_message);
+			return;
+		}
+	
+		PHALCON_CALL_METHOD(&fields, relation, "getfields");
+		PHALCON_CALL_METHOD(&referenced_fields, relation, "getreferencedfields");
+		if (Z_TYPE_P(fields) == IS_ARRAY || Z_TYPE_P(referenced_fields) == IS_ARRAY) { 
+			PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Eager loading of compound relations is not supported");
+			return;
+		}
+	
+		PHALCON_CALL_METHOD(&referenced_model, relation, "getreferencedmodel");
+		PHALCON_CALL_METHOD(&type, relation, "gettype");
+		PHALCON_CALL_METHOD(&is_through, relation, "isthrough");
+	
+		/** 
+		 * Collect the keys of the records in the resultset from the raw rows
+		 */
+		PHALCON_INIT_NVAR(raw_column);
+		if (phalcon_mvc_model_resultset_simple_raw_column(raw_column, this_ptr, fields TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+	
+		PHALCON_INIT_NVAR(raw_values);
+		if (phalcon_mvc_model_resultset_simple_values(raw_values, this_ptr, raw_column, raw_records TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+	
+		PHALCON_INIT_NVAR(keys);
+		array_init(keys);
+	
+		phalcon_is_iterable(raw_values, &ah1, &hp1, 0, 0);
+	
+		while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
+	
+			if (Z_TYPE_PP(hd) != IS_NULL) {
+				phalcon_array_update_zval(&keys, *hd, *hd, PH_COPY);
+			}
+	
+			zend_hash_move_forward_ex(ah1, &hp1);
+		}
+	
+		PHALCON_INIT_NVAR(links);
+		array_init(links);
+	
+		PHALCON_INIT_NVAR(children);
+		query_keys = keys;
+	
+		/** 
+		 * Relations through an intermediate model need an extra query to know which
+		 * records are related to every record
+		 */
+		if (zend_is_true(is_through) && zend_hash_num_elements(Z_ARRVAL_P(keys))) {
+	
+			PHALCON_CALL_METHOD(&intermediate_model, relation, "getintermediatemodel");
+			PHALCON_CALL_METHOD(&intermediate_fields, relation, "getintermediatefields");
+			PHALCON_CALL_METHOD(&intermediate_referenced_fields, relation, "getintermediatereferencedfields");
+			if (Z_TYPE_P(intermediate_fields) == IS_ARRAY || Z_TYPE_P(intermediate_referenced_fields) == IS_ARRAY) { 
+				PHALCON_THROW_EXCEPTION_STR(phalcon_mvc_model_exception_ce, "Eager loading of compound relations is not supported");
+				return;
+			}
+	
+			PHALCON_INIT_NVAR(intermediate_records);
+			phalcon_mvc_model_resultset_simple_find_in(intermediate_records, manager, intermediate_model, intermediate_fields, keys, dependency_injector TSRMLS_CC);
+			if (EG(exception)) {
+				RETURN_MM();
+			}
+	
+			PHALCON_INIT_NVAR(link_keys);
+			array_init(link_keys);
+	
+			PHALCON_CALL_METHOD(NULL, intermediate_records, "rewind");
+	
+			while (1) {
+				PHALCON_CALL_METHOD(&r0, intermediate_records, "valid");
+				if (!zend_is_true(r0)) {
+					break;
+				}
+	
+				PHALCON_CALL_METHOD(&record, intermediate_records, "current");
+				PHALCON_CALL_METHOD(&value, record, "readattribute", intermediate_fields);
+				PHALCON_CALL_METHOD(&link_value, record, "readattribute", intermediate_referenced_fields);
+				if (Z_TYPE_P(value) != IS_NULL && Z_TYPE_P(link_value) != IS_NULL) {
+					phalcon_mvc_model_resultset_simple_group(links, value, link_value);
+					phalcon_array_update_zval(&link_keys, link_value, link_value, PH_COPY);
+				}
+	
+				PHALCON_CALL_METHOD(NULL, intermediate_records, "next");
+			}
+	
+			query_keys = link_keys;
+		}
+	
+		/** 
+		 * Query all the related records with a single IN (...) per chunk of keys
+		 */
+		if (zend_hash_num_elements(Z_ARRVAL_P(query_keys))) {
+			phalcon_mvc_model_resultset_simple_find_in(children, manager, referenced_model, referenced_fields, query_keys, dependency_injector TSRMLS_CC);
+			if (EG(exception)) {
+				RETURN_MM();
+			}
+		}
+	
+		/** 
+		 * Nested relations are loaded for all the related records at once
+		 */
+		if (Z_TYPE_P(children) == IS_OBJECT && Z_TYPE_P(subtree) == IS_ARRAY && zend_hash_num_elements(Z_ARRVAL_P(subtree))) {
+			PHALCON_CALL_METHOD(NULL, children, "_eagerload", subtree);
+		}
+	
+		/** 
+		 * belongsTo and hasOne relations return a single record
+		 */
+		single = !zend_is_true(is_through) && (PHALCON_IS_LONG(type, 0) || PHALCON_IS_LONG(type, 1));
+	
+		PHALCON_INIT_NVAR(records);
+		array_init(records);
+	
+		PHALCON_INIT_NVAR(entry);
+		array_init_size(entry, 4);
+		phalcon_array_update_string(&entry, SL("alias"), alias, PH_COPY);
+		phalcon_array_update_string(&entry, SL("field"), fields, PH_COPY);
+	
+		if (single) {
+	
+			if (Z_TYPE_P(children) == IS_OBJECT) {
+	
+				PHALCON_CALL_METHOD(NULL, children, "rewind");
+	
+				while (1) {
+					PHALCON_CALL_METHOD(&r0, children, "valid");
+					if (!zend_is_true(r0)) {
+						break;
+					}
+	
+					PHALCON_CALL_METHOD(&record, children, "current");
+					PHALCON_CALL_METHOD(&value, record, "readattribute", referenced_fields);
+					if (Z_TYPE_P(value) != IS_NULL) {
+						phalcon_array_update_zval(&records, value, record, PH_COPY);
+					}
+	
+					PHALCON_CALL_METHOD(NULL, children, "next");
+				}
+			}
+	
+			phalcon_array_update_string_bool(&entry, SL("default"), 0, 0);
+		} else {
+			PHALCON_CALL_METHOD(&children_model, manager, "load", referenced_model);
+	
+			if (Z_TYPE_P(children) == IS_OBJECT) {
+	
+				PHALCON_CALL_METHOD(&rows, children, "toarray", PHALCON_GLOBAL(z_false));
+	
+				PHALCON_OBS_NVAR(column_map);
+				phalcon_read_property(&column_map, children, SL("_columnMap"), PH_NOISY TSRMLS_CC);
+	
+				PHALCON_OBS_NVAR(keep_snapshots);
+				phalcon_read_property(&keep_snapshots, children, SL("_keepSnapshots"), PH_NOISY TSRMLS_CC);
+	
+				PHALCON_OBS_NVAR(children_eager);
+				phalcon_read_property(&children_eager, children, SL("_eager"), PH_NOISY TSRMLS_CC);
+	
+				/** 
+				 * Rows are not renamed, look for the column of the referenced field
+				 */
+				PHALCON_CPY_WRT(column, referenced_fields);
+				if (Z_TYPE_P(column_map) == IS_ARRAY) { 
+	
+					phalcon_is_iterable(column_map, &ah1, &hp1, 0, 0);
+	
+					while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
+	
+						PHALCON_GET_HKEY(attribute, ah1, hp1);
+						PHALCON_GET_HVALUE(value);
+	
+						if (PHALCON_IS_EQUAL(value, referenced_fields)) {
+							PHALCON_CPY_WRT(column, attribute);
+							break;
+						}
+	
+						zend_hash_move_forward_ex(ah1, &hp1);
+					}
+				}
+	
+				PHALCON_INIT_NVAR(grouped);
+				array_init(grouped);
+	
+				if (zend_is_true(is_through)) {
+	
+					PHALCON_INIT_NVAR(by_key);
+					array_init(by_key);
+	
+					phalcon_is_iterable(rows, &ah1, &hp1, 0, 0);
+	
+					while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
+	
+						PHALCON_GET_HVALUE(row);
+	
+						if (phalcon_array_isset_fetch(&row_key, row, column)) {
+							phalcon_array_update_zval(&by_key, row_key, row, PH_COPY);
+						}
+	
+						zend_hash_move_forward_ex(ah1, &hp1);
+					}
+	
+					/** 
+					 * Distribute the related rows following the intermediate records
+					 */
+					phalcon_is_iterable(links, &ah1, &hp1, 0, 0);
+	
+					while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
+	
+						PHALCON_GET_HKEY(group_key, ah1, hp1);
+						PHALCON_GET_HVALUE(group);
+	
+						phalcon_is_iterable(group, &ah2, &hp2, 0, 0);
+	
+						while (zend_hash_get_current_data_ex(ah2, (void**) &hd, &hp2) == SUCCESS) {
+	
+							if (phalcon_array_isset_fetch(&linked_row, by_key, *hd)) {
+								phalcon_mvc_model_resultset_simple_group(grouped, group_key, linked_row);
+							}
+	
+							zend_hash_move_forward_ex(ah2, &hp2);
+						}
+	
+						zend_hash_move_forward_ex(ah1, &hp1);
+					}
+				} else {
+					phalcon_is_iterable(rows, &ah1, &hp1, 0, 0);
+	
+					while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
+	
+						PHALCON_GET_HVALUE(row);
+	
+						if (phalcon_array_isset_fetch(&row_key, row, column)) {
+							phalcon_mvc_model_resultset_simple_group(grouped, row_key, row);
+						}
+	
+						zend_hash_move_forward_ex(ah1, &hp1);
+					}
+				}
+	
+				/** 
+				 * Every record gets a resultset with its related rows
+				 */
+				phalcon_is_iterable(grouped, &ah1, &hp1, 0, 0);
+	
+				while (zend_hash_get_current_data_ex(ah1, (void**) &hd, &hp1) == SUCCESS) {
+	
+					PHALCON_GET_HKEY(group_key, ah1, hp1);
+					PHALCON_GET_HVALUE(group);
+	
+					PHALCON_INIT_NVAR(related);
+					phalcon_mvc_model_resultset_simple_from_rows(related, children_model, column_map, group, keep_snapshots, children_eager TSRMLS_CC);
+					phalcon_array_update_zval(&records, group_key, related, PH_COPY);
+	
+					zend_hash_move_forward_ex(ah1, &hp1);
+				}
+			} else {
+				PHALCON_INIT_NVAR(column_map);
+	
+				PHALCON_INIT_NVAR(keep_snapshots);
+				ZVAL_FALSE(keep_snapshots);
+	
+				PHALCON_INIT_NVAR(children_eager);
+			}
+	
+			/** 
+			 * Records without related records get an empty resultset
+			 */
+			PHALCON_INIT_NVAR(empty_rows);
+			array_init(empty_rows);
+	
+			PHALCON_INIT_NVAR(related);
+			phalcon_mvc_model_resultset_simple_from_rows(related, children_model, column_map, empty_rows, keep_snapshots, children_eager TSRMLS_CC);
+			phalcon_array_update_string(&entry, SL("default"), related, PH_COPY);
+		}
+	
+		phalcon_array_update_string(&entry, SL("records"), records, PH_COPY);
+		phalcon_update_property_array(this_ptr, SL("_eager"), alias, entry TSRMLS_CC);
+	
+		zend_hash_move_forward_ex(ah0, &hp0);
+	}
+	
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Returns the values of a column of every row without hydrating the records
+ *
+ *<code>
+ * $ids = Robots::find()->pluck('id');
+ *</code>
+ *
+ * @param string $column
+ * @return array
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, pluck){
+
+	zval *column, *raw_column, *records = NULL;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &column);
+
+	PHALCON_INIT_VAR(raw_column);
+	if (phalcon_mvc_model_resultset_simple_raw_column(raw_column, this_ptr, column TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+
+	PHALCON_OBSERVE_OR_NULLIFY_VAR(records);
+	if (phalcon_mvc_model_resultset_simple_raw_rows(&records, this_ptr, 0 TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+
+	phalcon_mvc_model_resultset_simple_values(return_value, this_ptr, raw_column, records TSRMLS_CC);
+	RETURN_MM();
+}
+
+/**
+ * Returns the rows as arrays indexed by the value of a column, later rows replace earlier
+ * ones with the same value
+ *
+ *<code>
+ * $robots = Robots::find()->indexBy('id');
+ *</code>
+ *
+ * @param string $column
+ * @return array
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, indexBy){
+
+	zval *column, *raw_column, *records = NULL, *values, *column_map, *renamed;
+	zval **value, **row;
+	HashPosition hp0, hp1;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &column);
+
+	PHALCON_INIT_VAR(raw_column);
+	if (phalcon_mvc_model_resultset_simple_raw_column(raw_column, this_ptr, column TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+
+	PHALCON_OBSERVE_OR_NULLIFY_VAR(records);
+	if (phalcon_mvc_model_resultset_simple_raw_rows(&records, this_ptr, 1 TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+
+	PHALCON_INIT_VAR(values);
+	if (phalcon_mvc_model_resultset_simple_values(values, this_ptr, raw_column, records TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+
+	column_map = phalcon_fetch_nproperty_this(this_ptr, SL("_columnMap"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(column_map) == IS_ARRAY) {
+		PHALCON_INIT_VAR(renamed);
+		if (phalcon_mvc_model_resultset_simple_rename(renamed, records, column_map TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+	} else {
+		renamed = records;
+	}
+
+	array_init(return_value);
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(values), &hp0), zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(renamed), &hp1);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(values), (void**) &value, &hp0) == SUCCESS && zend_hash_get_current_data_ex(Z_ARRVAL_P(renamed), (void**) &row, &hp1) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(values), &hp0), zend_hash_move_forward_ex(Z_ARRVAL_P(renamed), &hp1)
+	) {
+		phalcon_array_update_zval(&return_value, *value, *row, PH_COPY);
+	}
+
+	RETURN_MM();
+}
+
+/**
+ * Groups the rows as arrays by the value of a column
+ *
+ *<code>
+ * $robots = Robots::find()->groupBy('type');
+ *</code>
+ *
+ * @param string $column
+ * @return array
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, groupBy){
+
+	zval *column, *raw_column, *records = NULL, *values, *column_map, *renamed;
+	zval **value, **row;
+	HashPosition hp0, hp1;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &column);
+
+	PHALCON_INIT_VAR(raw_column);
+	if (phalcon_mvc_model_resultset_simple_raw_column(raw_column, this_ptr, column TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+
+	PHALCON_OBSERVE_OR_NULLIFY_VAR(records);
+	if (phalcon_mvc_model_resultset_simple_raw_rows(&records, this_ptr, 1 TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+
+	PHALCON_INIT_VAR(values);
+	if (phalcon_mvc_model_resultset_simple_values(values, this_ptr, raw_column, records TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+
+	column_map = phalcon_fetch_nproperty_this(this_ptr, SL("_columnMap"), PH_NOISY TSRMLS_CC);
+	if (Z_TYPE_P(column_map) == IS_ARRAY) {
+		PHALCON_INIT_VAR(renamed);
+		if (phalcon_mvc_model_resultset_simple_rename(renamed, records, column_map TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+	} else {
+		renamed = records;
+	}
+
+	array_init(return_value);
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(values), &hp0), zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(renamed), &hp1);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(values), (void**) &value, &hp0) == SUCCESS && zend_hash_get_current_data_ex(Z_ARRVAL_P(renamed), (void**) &row, &hp1) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(values), &hp0), zend_hash_move_forward_ex(Z_ARRVAL_P(renamed), &hp1)
+	) {
+		phalcon_mvc_model_resultset_simple_group(return_value, *value, *row);
+	}
+
+	RETURN_MM();
+}
+
+/**
+ * Reduces the non null values of a column without hydrating the records
+ *
+ * @param operation 0 = sum, -1 = minimum, 1 = maximum
+ */
+static void phalcon_mvc_model_resultset_simple_reduce(zval *return_value, zval *this_ptr, zval *column, int operation TSRMLS_DC) {
+
+	zval *raw_column, *records = NULL, *values, **value, result;
+	HashPosition hp;
+
+	MAKE_STD_ZVAL(raw_column);
+	ZVAL_NULL(raw_column);
+
+	MAKE_STD_ZVAL(values);
+	ZVAL_NULL(values);
+
+	if (phalcon_mvc_model_resultset_simple_raw_column(raw_column, this_ptr, column TSRMLS_CC) == FAILURE) {
+		goto done;
+	}
+
+	if (phalcon_mvc_model_resultset_simple_raw_rows(&records, this_ptr, 0 TSRMLS_CC) == FAILURE) {
+		goto done;
+	}
+
+	if (phalcon_mvc_model_resultset_simple_values(values, this_ptr, raw_column, records TSRMLS_CC) == FAILURE) {
+		goto done;
+	}
+
+	if (operation == 0) {
+		ZVAL_LONG(return_value, 0);
+	}
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(values), &hp);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(values), (void**) &value, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(values), &hp)
+	) {
+		if (Z_TYPE_PP(value) == IS_NULL) {
+			continue;
+		}
+
+		if (operation == 0) {
+			add_function(return_value, return_value, *value TSRMLS_CC);
+			continue;
+		}
+
+		if (Z_TYPE_P(return_value) != IS_NULL) {
+			compare_function(&result, *value, return_value TSRMLS_CC);
+			if ((operation < 0 && Z_LVAL(result) >= 0) || (operation > 0 && Z_LVAL(result) <= 0)) {
+				continue;
+			}
+
+			zval_dtor(return_value);
+		}
+
+		ZVAL_ZVAL(return_value, *value, 1, 0);
+	}
+
+done:
+	zval_ptr_dtor(&raw_column);
+	zval_ptr_dtor(&values);
+	if (records) {
+		zval_ptr_dtor(&records);
+	}
+}
+
+/**
+ * Returns the sum of the values of a column without hydrating the records
+ *
+ *<code>
+ * $total = Robots::find()->sum('price');
+ *</code>
+ *
+ * @param string $column
+ * @return int|double
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, sum){
+
+	zval *column;
+
+	phalcon_fetch_params(0, 1, 0, &column);
+
+	phalcon_mvc_model_resultset_simple_reduce(return_value, this_ptr, column, 0 TSRMLS_CC);
+}
+
+/**
+ * Returns the minimum value of a column without hydrating the records, NULL if the
+ * column has no values
+ *
+ * @param string $column
+ * @return mixed
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, min){
+
+	zval *column;
+
+	phalcon_fetch_params(0, 1, 0, &column);
+
+	phalcon_mvc_model_resultset_simple_reduce(return_value, this_ptr, column, -1 TSRMLS_CC);
+}
+
+/**
+ * Returns the maximum value of a column without hydrating the records, NULL if the
+ * column has no values
+ *
+ * @param string $column
+ * @return mixed
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, max){
+
+	zval *column;
+
+	phalcon_fetch_params(0, 1, 0, &column);
+
+	phalcon_mvc_model_resultset_simple_reduce(return_value, this_ptr, column, 1 TSRMLS_CC);
+}
+
+/**
+ * Filters the resultset. A callback receives every hydrated record as in
+ * Phalcon\Mvc\Model\Resultset::filter(), while an array of column => value conditions is
+ * evaluated over the raw rows and a resultset with the matching rows is returned. A list
+ * of values matches any of them, values are compared as the == operator does
+ *
+ *<code>
+ * $robots = Robots::find()->filter(array('type' => array('mechanical', 'virtual')));
+ *</code>
+ *
+ * @param callable|array $filter
+ * @return Phalcon\Mvc\Model\ResultsetInterface|Phalcon\Mvc\ModelInterface[]
+ */
+PHP_METHOD(Phalcon_Mvc_Model_Resultset_Simple, filter){
+
+	zval *filter, *conditions, *raw_column = NULL, *records = NULL, *matched;
+	zval *model, *column_map, *keep_snapshots, *eager, *hydrate_mode;
+	zval **expected, **record, *value, **option;
+	HashPosition hp0, hp1, hp2;
+	int matches;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &filter);
+
+	if (Z_TYPE_P(filter) != IS_ARRAY) {
+		PHALCON_RETURN_CALL_PARENT(phalcon_mvc_model_resultset_simple_ce, this_ptr, "filter", filter);
+		RETURN_MM();
+	}
+
+	/** 
+	 * The attributes are translated to raw columns once
+	 */
+	PHALCON_INIT_VAR(conditions);
+	array_init_size(conditions, zend_hash_num_elements(Z_ARRVAL_P(filter)));
+
+	for (
+		zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(filter), &hp0);
+		zend_hash_get_current_data_ex(Z_ARRVAL_P(filter), (void**) &expected, &hp0) == SUCCESS;
+		zend_hash_move_forward_ex(Z_ARRVAL_P(filter), &hp0)
+	) {
+		zval column = phalcon_get_current_key_w(Z_ARRVAL_P(filter), &hp0);
+
+		PHALCON_INIT_NVAR(raw_column);
+		if (phalcon_mvc_model_resultset_simple_raw_column(raw_column, this_ptr, &column TSRMLS_CC) == FAILURE) {
+			RETURN_MM();
+		}
+
+		phalcon_array_update_zval(&conditions, raw_column, *expected, PH_COPY);
+	}
+
+	PHALCON_OBSERVE_OR_NULLIFY_VAR(records);
+	if (phalcon_mvc_model_resultset_simple_raw_rows(&records, this_ptr, 1 TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+
+	PHALCON_INIT_VAR(matched);
+	array_init(matched);
+
+	if (Z_TYPE_P(records) == IS_ARRAY) {
+		for (
+			zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(records), &hp0);
+			zend_hash_get_current_data_ex(Z_ARRVAL_P(records), (void**) &record, &hp0) == SUCCESS;
+			zend_hash_move_forward_ex(Z_ARRVAL_P(records), &hp0)
+		) {
+			matches = 1;
+
+			for (
+				zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(conditions), &hp1);
+				matches && zend_hash_get_current_data_ex(Z_ARRVAL_P(conditions), (void**) &expected, &hp1) == SUCCESS;
+				zend_hash_move_forward_ex(Z_ARRVAL_P(conditions), &hp1)
+			) {
+				zval column = phalcon_get_current_key_w(Z_ARRVAL_P(conditions), &hp1);
+
+				if (!phalcon_array_isset_fetch(&value, *record, &column)) {
+					matches = 0;
+				} else if (Z_TYPE_PP(expected) == IS_ARRAY) {
+					matches = 0;
+					for (
+						zend_hash_internal_pointer_reset_ex(Z_ARRVAL_PP(expected), &hp2);
+						!matches && zend_hash_get_current_data_ex(Z_ARRVAL_PP(expected), (void**) &option, &hp2) == SUCCESS;
+						zend_hash_move_forward_ex(Z_ARRVAL_PP(expected), &hp2)
+					) {
+						matches = PHALCON_IS_EQUAL(value, *option);
+					}
+				} else {
+					matches = PHALCON_IS_EQUAL(value, *expected);
+				}
+			}
+
+			if (matches) {
+				phalcon_array_append(&matched, *record, PH_COPY);
+			}
+		}
+	}
+
+	model          = phalcon_fetch_nproperty_this(this_ptr, SL("_model"), PH_NOISY TSRMLS_CC);
+	column_map     = phalcon_fetch_nproperty_this(this_ptr, SL("_columnMap"), PH_NOISY TSRMLS_CC);
+	keep_snapshots = phalcon_fetch_nproperty_this(this_ptr, SL("_keepSnapshots"), PH_NOISY TSRMLS_CC);
+	eager          = phalcon_fetch_nproperty_this(this_ptr, SL("_eager"), PH_NOISY TSRMLS_CC);
+	hydrate_mode   = phalcon_fetch_nproperty_this(this_ptr, SL("_hydrateMode"), PH_NOISY TSRMLS_CC);
+
+	phalcon_mvc_model_resultset_simple_from_rows(return_value, model, column_map, matched, keep_snapshots, eager TSRMLS_CC);
+	phalcon_update_property_this(return_value, SL("_hydrateMode"), hydrate_mode TSRMLS_CC);
+
+	RETURN_MM();
+}
@@ -26,4 +26,6 @@ extern zend_class_entry *phalcon_mvc_model_resultset_simple_ce;
 
 PHALCON_INIT_CLASS(Phalcon_Mvc_Model_Resultset_Simple);
 
+void phalcon_mvc_model_resultset_simple_store_rows(zval *this_ptr, zval *rows TSRMLS_DC);
+
 #endif /* PHALCON_MVC_MODEL_RESULTSET_SIMPLE_H */
@@ -117,7 +117,7 @@ static void phvolt_parse_with_token(void* phvolt_parser, int opcode, int parserc
 
 	phvolt_parser_token *pToken;
 
-	pToken = emalloc(sizeof(phvolt_parser_token));
+	pToken = phalcon_arena_alloc(&parser_status->arena, sizeof(phvolt_parser_token));
 	pToken->opcode = opcode;
 	pToken->token = token->value;
 	pToken->token_len = token->len;
@@ -230,10 +230,10 @@ int phvolt_is_blank_string(phvolt_scanner_token *token){
 int phvolt_internal_parse_view(zval **result, zval *view_code, zval *template_path, zval **error_msg TSRMLS_DC) {
 
 	char *error;
-	phvolt_scanner_state *state;
+	phvolt_scanner_state state_s, *state = &state_s;
 	phvolt_scanner_token token;
 	int scanner_status, status = SUCCESS;
-	phvolt_parser_status *parser_status = NULL;
+	phvolt_parser_status parser_status_s, *parser_status = &parser_status_s;
 	void* phvolt_parser;
 
 	/** Check if the view has code */
@@ -256,8 +256,10 @@ int phvolt_internal_parse_view(zval **result, zval *view_code, zval *template_pa
 		return FAILURE;
 	}
 
-	parser_status = emalloc(sizeof(phvolt_parser_status));
-	state = emalloc(sizeof(phvolt_scanner_state));
+	/**
+	 * Parser tokens are bump-allocated from an arena released at the end of the parse
+	 */
+	phalcon_arena_init(&parser_status->arena, PHVOLT_ARENA_BLOCK_SIZE);
 
 	parser_status->status = PHVOLT_PARSING_OK;
 	parser_status->scanner_state = state;
@@ -702,8 +704,7 @@ int phvolt_internal_parse_view(zval **result, zval *view_code, zval *template_pa
 		}
 	}
 
-	efree(parser_status);
-	efree(state);
+	phalcon_arena_destroy(&parser_status->arena);
 
 	return status;
 }
@@ -29,7 +29,6 @@ static zval *phvolt_ret_literal_zval(int type, phvolt_parser_token *T, phvolt_sc
 	add_assoc_long(ret, "type", type);
 	if (T) {
 		add_assoc_stringl(ret, "value", T->token, T->token_len, 0);
-		efree(T);
 	}
 
 	Z_ADDREF_P(state->active_file);
@@ -102,11 +101,9 @@ static zval *phvolt_ret_for_statement(phvolt_parser_token *variable, phvolt_pars
 	add_assoc_long(ret, "type", PHVOLT_T_FOR);
 
 	add_assoc_stringl(ret, "variable", variable->token, variable->token_len, 0);
-	efree(variable);
 
 	if (key) {
 		add_assoc_stringl(ret, "key", key->token, key->token_len, 0);
-		efree(key);
 	}
 
 	add_assoc_zval(ret, "expr", expr);
@@ -136,7 +133,6 @@ static zval *phvolt_ret_cache_statement(zval *expr, phvolt_parser_token *lifetim
 
 	if (lifetime) {
 		add_assoc_stringl(ret, "lifetime", lifetime->token, lifetime->token_len, 0);
-		efree(lifetime);
 	}
 	add_assoc_zval(ret, "block_statements", block_statements);
 
@@ -169,7 +165,6 @@ static zval *phvolt_ret_set_assignment(phvolt_parser_token *variable, int operat
 	array_init_size(ret, 5);
 
 	add_assoc_stringl(ret, "variable", variable->token, variable->token_len, 0);
-	efree(variable);
 
 	add_assoc_long(ret, "op", operator);
 
@@ -208,7 +203,6 @@ static zval *phvolt_ret_block_statement(phvolt_parser_token *name, zval *block_s
 	add_assoc_long(ret, "type", PHVOLT_T_BLOCK);
 
 	add_assoc_stringl(ret, "name", name->token, name->token_len, 0);
-	efree(name);
 
 	if (block_statements) {
 		add_assoc_zval(ret, "block_statements", block_statements);
@@ -230,7 +224,6 @@ static zval *phvolt_ret_macro_statement(phvolt_parser_token *macro_name, zval *p
 	add_assoc_long(ret, "type", PHVOLT_T_MACRO);
 
 	add_assoc_stringl(ret, "name", macro_name->token, macro_name->token_len, 0);
-	efree(macro_name);
 
 	if (parameters) {
 		add_assoc_zval(ret, "parameters", parameters);
@@ -255,7 +248,6 @@ static zval *phvolt_ret_macro_parameter(phvolt_parser_token *variable, zval *def
 	array_init_size(ret, 5);
 
 	add_assoc_stringl(ret, "variable", variable->token, variable->token_len, 0);
-	efree(variable);
 
 	if (default_value) {
 		add_assoc_zval(ret, "default", default_value);
@@ -277,7 +269,6 @@ static zval *phvolt_ret_extends_statement(phvolt_parser_token *P, phvolt_scanner
 
 	add_assoc_long(ret, "type", PHVOLT_T_EXTENDS);
 	add_assoc_stringl(ret, "path", P->token, P->token_len, 0);
-	efree(P);
 
 	Z_ADDREF_P(state->active_file);
 	add_assoc_zval(ret, "file", state->active_file);
@@ -453,7 +444,6 @@ static zval *phvolt_ret_named_item(phvolt_parser_token *name, zval *expr, phvolt
 	add_assoc_zval(ret, "expr", expr);
 	if (name != NULL) {
 		add_assoc_stringl(ret, "name", name->token, name->token_len, 0);
-		efree(name);
 	}
 
 	Z_ADDREF_P(state->active_file);
@@ -1685,7 +1675,6 @@ static void kk_destructor(KKCODETYPE kkmajor, KKMINORTYPE *kkpminor){
 		if ((kkpminor->kk0)->free_flag) {
 			efree((kkpminor->kk0)->token);
 		}
-		efree((kkpminor->kk0));
 	}
 }
 /* #line 1692 "parser.c" */
@@ -3457,7 +3446,7 @@ static void phvolt_parse_with_token(void* phvolt_parser, int opcode, int parserc
 
 	phvolt_parser_token *pToken;
 
-	pToken = emalloc(sizeof(phvolt_parser_token));
+	pToken = phalcon_arena_alloc(&parser_status->arena, sizeof(phvolt_parser_token));
 	pToken->opcode = opcode;
 	pToken->token = token->value;
 	pToken->token_len = token->len;
@@ -3570,10 +3559,10 @@ int phvolt_is_blank_string(phvolt_scanner_token *token){
 int phvolt_internal_parse_view(zval **result, zval *view_code, zval *template_path, zval **error_msg TSRMLS_DC) {
 
 	char *error;
-	phvolt_scanner_state *state;
+	phvolt_scanner_state state_s, *state = &state_s;
 	phvolt_scanner_token token;
 	int scanner_status, status = SUCCESS;
-	phvolt_parser_status *parser_status = NULL;
+	phvolt_parser_status parser_status_s, *parser_status = &parser_status_s;
 	void* phvolt_parser;
 
 	/** Check if the view has code */
@@ -3596,8 +3585,10 @@ int phvolt_internal_parse_view(zval **result, zval *view_code, zval *template_pa
 		return FAILURE;
 	}
 
-	parser_status = emalloc(sizeof(phvolt_parser_status));
-	state = emalloc(sizeof(phvolt_scanner_state));
+	/**
+	 * Parser tokens are bump-allocated from an arena released at the end of the parse
+	 */
+	phalcon_arena_init(&parser_status->arena, PHVOLT_ARENA_BLOCK_SIZE);
 
 	parser_status->status = PHVOLT_PARSING_OK;
 	parser_status->scanner_state = state;
@@ -4042,8 +4033,7 @@ int phvolt_internal_parse_view(zval **result, zval *view_code, zval *template_pa
 		}
 	}
 
-	efree(parser_status);
-	efree(state);
+	phalcon_arena_destroy(&parser_status->arena);
 
 	return status;
 }
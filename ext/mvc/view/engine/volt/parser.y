@@ -63,7 +63,6 @@ static zval *phvolt_ret_literal_zval(int type, phvolt_parser_token *T, phvolt_sc
 	add_assoc_long(ret, "type", type);
 	if (T) {
 		add_assoc_stringl(ret, "value", T->token, T->token_len, 0);
-		efree(T);
 	}
 
 	Z_ADDREF_P(state->active_file);
@@ -136,11 +135,9 @@ static zval *phvolt_ret_for_statement(phvolt_parser_token *variable, phvolt_pars
 	add_assoc_long(ret, "type", PHVOLT_T_FOR);
 
 	add_assoc_stringl(ret, "variable", variable->token, variable->token_len, 0);
-	efree(variable);
 
 	if (key) {
 		add_assoc_stringl(ret, "key", key->token, key->token_len, 0);
-		efree(key);
 	}
 
 	add_assoc_zval(ret, "expr", expr);
@@ -170,7 +167,6 @@ static zval *phvolt_ret_cache_statement(zval *expr, phvolt_parser_token *lifetim
 
 	if (lifetime) {
 		add_assoc_stringl(ret, "lifetime", lifetime->token, lifetime->token_len, 0);
-		efree(lifetime);
 	}
 	add_assoc_zval(ret, "block_statements", block_statements);
 
@@ -203,7 +199,6 @@ static zval *phvolt_ret_set_assignment(phvolt_parser_token *variable, int operat
 	array_init_size(ret, 5);
 
 	add_assoc_stringl(ret, "variable", variable->token, variable->token_len, 0);
-	efree(variable);
 
 	add_assoc_long(ret, "op", operator);
 
@@ -242,7 +237,6 @@ static zval *phvolt_ret_block_statement(phvolt_parser_token *name, zval *block_s
 	add_assoc_long(ret, "type", PHVOLT_T_BLOCK);
 
 	add_assoc_stringl(ret, "name", name->token, name->token_len, 0);
-	efree(name);
 
 	if (block_statements) {
 		add_assoc_zval(ret, "block_statements", block_statements);
@@ -264,7 +258,6 @@ static zval *phvolt_ret_macro_statement(phvolt_parser_token *macro_name, zval *p
 	add_assoc_long(ret, "type", PHVOLT_T_MACRO);
 
 	add_assoc_stringl(ret, "name", macro_name->token, macro_name->token_len, 0);
-	efree(macro_name);
 
 	if (parameters) {
 		add_assoc_zval(ret, "parameters", parameters);
@@ -289,7 +282,6 @@ static zval *phvolt_ret_macro_parameter(phvolt_parser_token *variable, zval *def
 	array_init_size(ret, 5);
 
 	add_assoc_stringl(ret, "variable", variable->token, variable->token_len, 0);
-	efree(variable);
 
 	if (default_value) {
 		add_assoc_zval(ret, "default", default_value);
@@ -311,7 +303,6 @@ static zval *phvolt_ret_extends_statement(phvolt_parser_token *P, phvolt_scanner
 
 	add_assoc_long(ret, "type", PHVOLT_T_EXTENDS);
 	add_assoc_stringl(ret, "path", P->token, P->token_len, 0);
-	efree(P);
 
 	Z_ADDREF_P(state->active_file);
 	add_assoc_zval(ret, "file", state->active_file);
@@ -487,7 +478,6 @@ static zval *phvolt_ret_named_item(phvolt_parser_token *name, zval *expr, phvolt
 	add_assoc_zval(ret, "expr", expr);
 	if (name != NULL) {
 		add_assoc_stringl(ret, "name", name->token, name->token_len, 0);
-		efree(name);
 	}
 
 	Z_ADDREF_P(state->active_file);
@@ -699,7 +689,6 @@ static zval *phvolt_ret_macro_call_statement(zval *expr, zval *arguments, zval *
 		if ($$->free_flag) {
 			efree($$->token);
 		}
-		efree($$);
 	}
 }
 
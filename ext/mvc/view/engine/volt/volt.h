@@ -23,6 +23,8 @@
 #include "php_phalcon.h"
 #include "mvc/view/engine/volt/volt.h"
 
+#include "kernel/arena.h"
+
 typedef struct _phvolt_parser_token {
 	char *token;
 	int opcode;
@@ -37,8 +39,15 @@ typedef struct _phvolt_parser_status {
 	zend_uint syntax_error_len;
 	char *syntax_error;
 	phvolt_scanner_token *token;
+	phalcon_arena arena;
 } phvolt_parser_status;
 
+/**
+ * Parser tokens are only needed for values and raw fragments, the templates of the unit tests
+ * have 64 of them at most, larger templates take more blocks
+ */
+#define PHVOLT_ARENA_BLOCK_SIZE (128 * ZEND_MM_ALIGNED_SIZE(sizeof(phvolt_parser_token)))
+
 #define PHVOLT_PARSING_OK 1
 #define PHVOLT_PARSING_FAILED 0
 
@@ -0,0 +1,636 @@
+
+/*
+  +------------------------------------------------------------------------+
+  | Phalcon Framework                                                      |
+  +------------------------------------------------------------------------+
+  | Copyright (c) 2011-2014 Phalcon Team (http://www.phalconphp.com)       |
+  +------------------------------------------------------------------------+
+  | This source file is subject to the New BSD License that is bundled     |
+  | with this package in the file docs/LICENSE.txt.                        |
+  |                                                                        |
+  | If you did not receive a copy of the license and are unable to         |
+  | obtain it through the world-wide-web, please send an email             |
+  | to license@phalconphp.com so we can send you a copy immediately.       |
+  +------------------------------------------------------------------------+
+  | Authors: Andres Gutierrez <andres@phalconphp.com>                      |
+  |          Eduar Carvajal <eduar@phalconphp.com>                         |
+  +------------------------------------------------------------------------+
+*/
+
+#include "paginator/adapter/keyset.h"
+#include "paginator/adapterinterface.h"
+#include "paginator/exception.h"
+#include "mvc/model/query/builderinterface.h"
+
+#include <ext/standard/php_smart_str.h>
+
+#include "kernel/main.h"
+#include "kernel/memory.h"
+#include "kernel/object.h"
+#include "kernel/array.h"
+#include "kernel/exception.h"
+#include "kernel/operators.h"
+#include "kernel/fcall.h"
+#include "kernel/hash.h"
+#include "kernel/string.h"
+
+#include "internal/arginfo.h"
+
+/**
+ * Phalcon\Paginator\Adapter\Keyset
+ *
+ * Pagination using a PHQL query builder and an ordered set of unique keys. Instead of
+ * skipping rows with an OFFSET, every page continues after the keys of the last row of
+ * the previous page, so deep pages cost the same as the first one. Pages are addressed
+ * by opaque cursors, the first page has a null cursor
+ *
+ *<code>
+ *  $builder = $this->modelsManager->createBuilder()
+ *                   ->columns('id, name')
+ *                   ->from('Robots');
+ *
+ *  $paginator = new Phalcon\Paginator\Adapter\Keyset(array(
+ *      "builder" => $builder,
+ *      "keys"    => array("name" => "ASC", "id" => "ASC"),
+ *      "limit"   => 20,
+ *      "cursor"  => $this->request->getQuery("cursor")
+ *  ));
+ *
+ *  $page = $paginator->getPaginate();
+ *  echo $page->next; // Cursor of the next page, null on the last one
+ *</code>
+ */
+zend_class_entry *phalcon_paginator_adapter_keyset_ce;
+
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, __construct);
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, getPaginate);
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, setCurrentPage);
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, getCurrentPage);
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, setLimit);
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, getLimit);
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, getKeys);
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, setQueryBuilder);
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, getQueryBuilder);
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_paginator_adapter_keyset___construct, 0, 0, 1)
+	ZEND_ARG_INFO(0, config)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_paginator_adapter_keyset_setlimit, 0, 0, 1)
+	ZEND_ARG_INFO(0, limit)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_phalcon_paginator_adapter_keyset_setquerybuilder, 0, 0, 1)
+	ZEND_ARG_INFO(0, queryBuilder)
+ZEND_END_ARG_INFO()
+
+static const zend_function_entry phalcon_paginator_adapter_keyset_method_entry[] = {
+	PHP_ME(Phalcon_Paginator_Adapter_Keyset, __construct, arginfo_phalcon_paginator_adapter_keyset___construct, ZEND_ACC_PUBLIC|ZEND_ACC_CTOR)
+	PHP_ME(Phalcon_Paginator_Adapter_Keyset, getPaginate, arginfo_phalcon_paginator_adapterinterface_getpaginate, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Paginator_Adapter_Keyset, setLimit, arginfo_phalcon_paginator_adapter_keyset_setlimit, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Paginator_Adapter_Keyset, getLimit, arginfo_empty, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Paginator_Adapter_Keyset, setCurrentPage, arginfo_phalcon_paginator_adapterinterface_setcurrentpage, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Paginator_Adapter_Keyset, getCurrentPage, arginfo_phalcon_paginator_adapterinterface_getcurrentpage, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Paginator_Adapter_Keyset, getKeys, arginfo_empty, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Paginator_Adapter_Keyset, setQueryBuilder, arginfo_phalcon_paginator_adapter_keyset_setquerybuilder, ZEND_ACC_PUBLIC)
+	PHP_ME(Phalcon_Paginator_Adapter_Keyset, getQueryBuilder, arginfo_empty, ZEND_ACC_PUBLIC)
+	PHP_FE_END
+};
+
+/**
+ * Phalcon\Paginator\Adapter\Keyset initializer
+ */
+PHALCON_INIT_CLASS(Phalcon_Paginator_Adapter_Keyset){
+
+	PHALCON_REGISTER_CLASS(Phalcon\\Paginator\\Adapter, Keyset, paginator_adapter_keyset, phalcon_paginator_adapter_keyset_method_entry, 0);
+
+	zend_declare_property_null(phalcon_paginator_adapter_keyset_ce, SL("_builder"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_paginator_adapter_keyset_ce, SL("_keys"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_paginator_adapter_keyset_ce, SL("_limitRows"), ZEND_ACC_PROTECTED TSRMLS_CC);
+	zend_declare_property_null(phalcon_paginator_adapter_keyset_ce, SL("_cursor"), ZEND_ACC_PROTECTED TSRMLS_CC);
+
+	zend_class_implements(phalcon_paginator_adapter_keyset_ce TSRMLS_CC, 1, phalcon_paginator_adapterinterface_ce);
+
+	return SUCCESS;
+}
+
+/**
+ * Encodes the values of the keys of a row as an URL-safe cursor
+ */
+static void phalcon_paginator_adapter_keyset_encode_cursor(zval *return_value, zval *values TSRMLS_DC) {
+
+	zval json;
+	char *c;
+	int length;
+
+	INIT_ZVAL(json);
+	if (phalcon_json_encode(&json, values, 0 TSRMLS_CC) == FAILURE || Z_TYPE(json) != IS_STRING) {
+		zval_dtor(&json);
+		RETURN_NULL();
+	}
+
+	phalcon_base64_encode(return_value, &json);
+	zval_dtor(&json);
+
+	if (Z_TYPE_P(return_value) == IS_STRING) {
+		length = Z_STRLEN_P(return_value);
+		while (length > 0 && Z_STRVAL_P(return_value)[length - 1] == '=') {
+			--length;
+		}
+
+		Z_STRVAL_P(return_value)[length] = '\0';
+		Z_STRLEN_P(return_value) = length;
+
+		for (c = Z_STRVAL_P(return_value); *c; ++c) {
+			if (*c == '+') {
+				*c = '-';
+			} else if (*c == '/') {
+				*c = '_';
+			}
+		}
+	}
+}
+
+/**
+ * Decodes a cursor produced by phalcon_paginator_adapter_keyset_encode_cursor()
+ */
+static void phalcon_paginator_adapter_keyset_decode_cursor(zval *return_value, zval *cursor TSRMLS_DC) {
+
+	zval encoded, json;
+	char *c;
+
+	if (Z_TYPE_P(cursor) != IS_STRING) {
+		RETURN_NULL();
+	}
+
+	INIT_ZVAL(encoded);
+	ZVAL_STRINGL(&encoded, Z_STRVAL_P(cursor), Z_STRLEN_P(cursor), 1);
+
+	for (c = Z_STRVAL(encoded); *c; ++c) {
+		if (*c == '-') {
+			*c = '+';
+		} else if (*c == '_') {
+			*c = '/';
+		}
+	}
+
+	INIT_ZVAL(json);
+	phalcon_base64_decode(&json, &encoded);
+	zval_dtor(&encoded);
+
+	if (Z_TYPE(json) != IS_STRING || phalcon_json_decode(return_value, &json, 1 TSRMLS_CC) == FAILURE) {
+		zval_dtor(return_value);
+		ZVAL_NULL(return_value);
+	}
+
+	zval_dtor(&json);
+}
+
+/**
+ * Phalcon\Paginator\Adapter\Keyset
+ *
+ * The keys must identify a row unambiguously (the last one is usually the primary key)
+ * and must be selected by the builder
+ *
+ * @param array $config
+ */
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, __construct){
+
+	zval *config, *builder, *limit, *keys, *cursor, *normalized;
+	zval **column, *direction = NULL;
+	HashTable *ah;
+	HashPosition hp;
+	long int i_limit;
+
+	PHALCON_MM_GROW();
+
+	phalcon_fetch_params(1, 1, 0, &config);
+
+	if (!phalcon_array_isset_string_fetch(&builder, config, SS("builder"))) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_paginator_exception_ce, "Parameter 'builder' is required");
+		return;
+	}
+
+	PHALCON_VERIFY_INTERFACE_EX(builder, phalcon_mvc_model_query_builderinterface_ce, phalcon_paginator_exception_ce, 1);
+
+	phalcon_update_property_this(this_ptr, SL("_builder"), builder TSRMLS_CC);
+
+	if (!phalcon_array_isset_string_fetch(&limit, config, SS("limit"))) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_paginator_exception_ce, "Parameter 'limit' is required");
+		return;
+	}
+
+	i_limit = phalcon_get_intval(limit);
+	if (i_limit < 1) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_paginator_exception_ce, "'limit' should be positive");
+		return;
+	}
+
+	phalcon_update_property_this(this_ptr, SL("_limitRows"), limit TSRMLS_CC);
+
+	if (!phalcon_array_isset_string_fetch(&keys, config, SS("keys")) || Z_TYPE_P(keys) != IS_ARRAY || !zend_hash_num_elements(Z_ARRVAL_P(keys))) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_paginator_exception_ce, "Parameter 'keys' must be a non-empty array of columns");
+		return;
+	}
+
+	/**
+	 * Keys are normalized to column => direction
+	 */
+	PHALCON_INIT_VAR(normalized);
+	array_init(normalized);
+
+	ah = Z_ARRVAL_P(keys);
+
+	for (
+		zend_hash_internal_pointer_reset_ex(ah, &hp);
+		zend_hash_get_current_data_ex(ah, (void**)&column, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(ah, &hp)
+	) {
+		zval key = phalcon_get_current_key_w(ah, &hp);
+
+		PHALCON_INIT_NVAR(direction);
+
+		if (Z_TYPE(key) == IS_STRING) {
+			if (Z_TYPE_PP(column) == IS_STRING && Z_STRLEN_PP(column) == 4 && !strncasecmp(Z_STRVAL_PP(column), "DESC", 4)) {
+				ZVAL_STRING(direction, "DESC", 1);
+			} else if (Z_TYPE_PP(column) == IS_STRING && Z_STRLEN_PP(column) == 3 && !strncasecmp(Z_STRVAL_PP(column), "ASC", 3)) {
+				ZVAL_STRING(direction, "ASC", 1);
+			} else {
+				PHALCON_THROW_EXCEPTION_STR(phalcon_paginator_exception_ce, "The direction of a key must be 'ASC' or 'DESC'");
+				return;
+			}
+
+			phalcon_array_update_zval(&normalized, &key, direction, PH_COPY);
+		} else {
+			if (Z_TYPE_PP(column) != IS_STRING || !Z_STRLEN_PP(column)) {
+				PHALCON_THROW_EXCEPTION_STR(phalcon_paginator_exception_ce, "Keys must be column names");
+				return;
+			}
+
+			ZVAL_STRING(direction, "ASC", 1);
+			phalcon_array_update_zval(&normalized, *column, direction, PH_COPY);
+		}
+	}
+
+	phalcon_update_property_this(this_ptr, SL("_keys"), normalized TSRMLS_CC);
+
+	if (phalcon_array_isset_string_fetch(&cursor, config, SS("cursor"))) {
+		phalcon_update_property_this(this_ptr, SL("_cursor"), cursor TSRMLS_CC);
+	}
+
+	PHALCON_MM_RESTORE();
+}
+
+/**
+ * Set the cursor of the current page, null means the first page
+ *
+ * @param string $cursor
+ * @return Phalcon\Paginator\Adapter\Keyset $this Fluent interface
+ */
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, setCurrentPage){
+
+	zval *cursor;
+
+	phalcon_fetch_params(0, 1, 0, &cursor);
+
+	phalcon_update_property_this(this_ptr, SL("_cursor"), cursor TSRMLS_CC);
+	RETURN_THISW();
+}
+
+/**
+ * Get the cursor of the current page
+ *
+ * @return string
+ */
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, getCurrentPage){
+
+	RETURN_MEMBER(this_ptr, "_cursor");
+}
+
+/**
+ * Set current rows limit
+ *
+ * @param int $limit
+ *
+ * @return Phalcon\Paginator\Adapter\Keyset $this Fluent interface
+ */
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, setLimit){
+
+	zval **current_limit;
+
+	phalcon_fetch_params_ex(1, 0, &current_limit);
+	PHALCON_ENSURE_IS_LONG(current_limit);
+
+	phalcon_update_property_this(this_ptr, SL("_limitRows"), *current_limit TSRMLS_CC);
+	RETURN_THISW();
+}
+
+/**
+ * Get current rows limit
+ *
+ * @return int $limit
+ */
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, getLimit){
+
+	RETURN_MEMBER(this_ptr, "_limitRows");
+}
+
+/**
+ * Returns the keys used to paginate as column => direction
+ *
+ * @return array
+ */
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, getKeys){
+
+	RETURN_MEMBER(this_ptr, "_keys");
+}
+
+/**
+ * Set query builder object
+ *
+ * @param Phalcon\Mvc\Model\Query\BuilderInterface $builder
+ *
+ * @return Phalcon\Paginator\Adapter\Keyset $this Fluent interface
+ */
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, setQueryBuilder){
+
+	zval *query_builder;
+
+	phalcon_fetch_params(0, 1, 0, &query_builder);
+	PHALCON_VERIFY_INTERFACE_EX(query_builder, phalcon_mvc_model_query_builderinterface_ce, phalcon_paginator_exception_ce, 0);
+
+	phalcon_update_property_this(this_ptr, SL("_builder"), query_builder TSRMLS_CC);
+
+	RETURN_THISW();
+}
+
+/**
+ * Get query builder object
+ *
+ * @return Phalcon\Mvc\Model\Query\BuilderInterface $builder
+ */
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, getQueryBuilder){
+
+	RETURN_MEMBER(this_ptr, "_builder");
+}
+
+/**
+ * Returns the page after the current cursor. The returned object has the properties
+ * items (an array with the rows of the page), first (always null), current (the current
+ * cursor) and next (the cursor of the next page or null when there are no more rows)
+ *
+ * @return stdClass
+ */
+PHP_METHOD(Phalcon_Paginator_Adapter_Keyset, getPaginate){
+
+	zval *original_builder, *builder, *keys, *limit, *cursor;
+	zval *columns, *directions, *properties, *property = NULL;
+	zval *values, *bind_params, *conditions, *order;
+	zval *query = NULL, *items = NULL, *valid = NULL, *last = NULL;
+	zval *page_items, *last_values, *value = NULL, *next, *page_limit;
+	zval **entry, *column, *direction, *key_value, *row_property;
+	HashTable *ah;
+	HashPosition hp;
+	smart_str sql = { NULL, 0, 0 };
+	char placeholder[32], *name;
+	int placeholder_length;
+	long int i_limit, i_keys, i, j, placeholder_number = 0;
+	int has_next = 0;
+
+	PHALCON_MM_GROW();
+
+	original_builder = phalcon_fetch_nproperty_this(this_ptr, SL("_builder"), PH_NOISY TSRMLS_CC);
+
+	/* Make a copy of the original builder to leave it as it is */
+	PHALCON_INIT_VAR(builder);
+	if (phalcon_clone(builder, original_builder TSRMLS_CC) == FAILURE) {
+		RETURN_MM();
+	}
+
+	keys   = phalcon_fetch_nproperty_this(this_ptr, SL("_keys"), PH_NOISY TSRMLS_CC);
+	limit  = phalcon_fetch_nproperty_this(this_ptr, SL("_limitRows"), PH_NOISY TSRMLS_CC);
+	cursor = phalcon_fetch_nproperty_this(this_ptr, SL("_cursor"), PH_NOISY TSRMLS_CC);
+
+	i_limit = phalcon_get_intval(limit);
+	if (i_limit < 1) {
+		/* This should never happen unless someone deliberately modified the properties of the object */
+		i_limit = 10;
+	}
+
+	if (Z_TYPE_P(keys) != IS_ARRAY) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_paginator_exception_ce, "The keys to paginate are not defined");
+		return;
+	}
+
+	/**
+	 * Split the keys into columns, directions and the properties holding them in the rows
+	 */
+	PHALCON_INIT_VAR(columns);
+	array_init(columns);
+
+	PHALCON_INIT_VAR(directions);
+	array_init(directions);
+
+	PHALCON_INIT_VAR(properties);
+	array_init(properties);
+
+	ah = Z_ARRVAL_P(keys);
+
+	for (
+		zend_hash_internal_pointer_reset_ex(ah, &hp);
+		zend_hash_get_current_data_ex(ah, (void**)&entry, &hp) == SUCCESS;
+		zend_hash_move_forward_ex(ah, &hp)
+	) {
+		zval key = phalcon_get_current_key_w(ah, &hp);
+
+		if (Z_TYPE(key) != IS_STRING) {
+			continue;
+		}
+
+		phalcon_array_append(&columns, &key, PH_COPY);
+		phalcon_array_append(&directions, *entry, PH_COPY);
+
+		/* Robots.id and [Robots].[id] are read from the rows as id */
+		name = zend_memrchr(Z_STRVAL(key), '.', Z_STRLEN(key));
+		name = name ? name + 1 : Z_STRVAL(key);
+		if (*name == '[') {
+			++name;
+		}
+
+		PHALCON_INIT_NVAR(property);
+		ZVAL_STRINGL(property, name, Z_STRVAL(key) + Z_STRLEN(key) - name, 1);
+		if (Z_STRLEN_P(property) && Z_STRVAL_P(property)[Z_STRLEN_P(property) - 1] == ']') {
+			Z_STRVAL_P(property)[--Z_STRLEN_P(property)] = '\0';
+		}
+
+		phalcon_array_append(&properties, property, PH_COPY);
+	}
+
+	i_keys = zend_hash_num_elements(Z_ARRVAL_P(columns));
+	if (!i_keys) {
+		PHALCON_THROW_EXCEPTION_STR(phalcon_paginator_exception_ce, "The keys to paginate are not defined");
+		return;
+	}
+
+	/**
+	 * The cursor holds the keys of the last row of the previous page, the rows after it
+	 * are selected by (k1 > :v1:) OR (k1 = :v1: AND k2 > :v2:) OR ..., which is the
+	 * expanded form of (k1, k2, ...) > (v1, v2, ...) that also allows mixed directions
+	 */
+	if (PHALCON_IS_NOT_EMPTY(cursor)) {
+
+		PHALCON_INIT_VAR(values);
+		phalcon_paginator_adapter_keyset_decode_cursor(values, cursor TSRMLS_CC);
+		if (Z_TYPE_P(values) != IS_ARRAY || zend_hash_num_elements(Z_ARRVAL_P(values)) != i_keys) {
+			PHALCON_THROW_EXCEPTION_STR(phalcon_paginator_exception_ce, "The cursor is not valid for this paginator");
+			return;
+		}
+
+		for (i = 0; i < i_keys; ++i) {
+			if (!phalcon_array_isset_long_fetch(&key_value, values, i) || Z_TYPE_P(key_value) == IS_NULL || Z_TYPE_P(key_value) == IS_ARRAY || Z_TYPE_P(key_value) == IS_OBJECT) {
+				PHALCON_THROW_EXCEPTION_STR(phalcon_paginator_exception_ce, "The cursor is not valid for this paginator");
+				return;
+			}
+		}
+
+		PHALCON_INIT_VAR(bind_params);
+		array_init(bind_params);
+
+		for (i = 0; i < i_keys; ++i) {
+
+			if (i) {
+				smart_str_appendl(&sql, " OR ", 4);
+			}
+
+			smart_str_appendc(&sql, '(');
+
+			for (j = 0; j <= i; ++j) {
+				phalcon_array_isset_long_fetch(&column, columns, j);
+				phalcon_array_isset_long_fetch(&direction, directions, j);
+				phalcon_array_isset_long_fetch(&key_value, values, j);
+
+				if (j) {
+					smart_str_appendl(&sql, " AND ", 5);
+				}
+
+				smart_str_appendl(&sql, Z_STRVAL_P(column), Z_STRLEN_P(column));
+
+				if (j < i) {
+					smart_str_appendl(&sql, " = ", 3);
+				} else if (Z_STRLEN_P(direction) == 4) {
+					smart_str_appendl(&sql, " < ", 3);
+				} else {
+					smart_str_appendl(&sql, " > ", 3);
+				}
+
+				/* Every occurrence gets its own placeholder, some drivers don't allow to repeat them */
+				placeholder_length = snprintf(placeholder, sizeof(placeholder), "_keyset%ld", placeholder_number++);
+
+				smart_str_appendc(&sql, ':');
+				smart_str_appendl(&sql, placeholder, placeholder_length);
+				smart_str_appendc(&sql, ':');
+
+				phalcon_array_update_string(&bind_params, placeholder, placeholder_length, key_value, PH_COPY);
+			}
+
+			smart_str_appendc(&sql, ')');
+		}
+
+		smart_str_0(&sql);
+
+		PHALCON_INIT_VAR(conditions);
+		ZVAL_STRINGL(conditions, sql.c, sql.len, 0);
+
+		PHALCON_CALL_METHOD(NULL, builder, "andwhere", conditions, bind_params);
+	}
+
+	/**
+	 * Order by the keys, the order of the builder is replaced
+	 */
+	sql.c   = NULL;
+	sql.len = 0;
+	sql.a   = 0;
+
+	for (i = 0; i < i_keys; ++i) {
+		phalcon_array_isset_long_fetch(&column, columns, i);
+		phalcon_array_isset_long_fetch(&direction, directions, i);
+
+		if (i) {
+			smart_str_appendl(&sql, ", ", 2);
+		}
+
+		smart_str_appendl(&sql, Z_STRVAL_P(column), Z_STRLEN_P(column));
+		smart_str_appendc(&sql, ' ');
+		smart_str_appendl(&sql, Z_STRVAL_P(direction), Z_STRLEN_P(direction));
+	}
+
+	smart_str_0(&sql);
+
+	PHALCON_INIT_VAR(order);
+	ZVAL_STRINGL(order, sql.c, sql.len, 0);
+
+	PHALCON_CALL_METHOD(NULL, builder, "orderby", order);
+
+	/**
+	 * One row more than the limit tells if there is a next page without counting the rows
+	 */
+	PHALCON_INIT_VAR(page_limit);
+	ZVAL_LONG(page_limit, i_limit + 1);
+	PHALCON_CALL_METHOD(NULL, builder, "limit", page_limit);
+
+	PHALCON_CALL_METHOD(&query, builder, "getquery");
+
+	/* Execute the query an return the requested slice of data */
+	PHALCON_CALL_METHOD(&items, query, "execute");
+
+	PHALCON_INIT_VAR(page_items);
+	array_init_size(page_items, i_limit);
+
+	PHALCON_CALL_METHOD(NULL, items, "rewind");
+
+	for (i = 0; ; ++i) {
+		PHALCON_CALL_METHOD(&valid, items, "valid");
+		if (!zend_is_true(valid)) {
+			break;
+		}
+
+		if (i == i_limit) {
+			has_next = 1;
+			break;
+		}
+
+		PHALCON_CALL_METHOD(&last, items, "current");
+		phalcon_array_append(&page_items, last, PH_COPY);
+
+		PHALCON_CALL_METHOD(NULL, items, "next");
+	}
+
+	/**
+	 * The next cursor holds the keys of the last row of this page
+	 */
+	PHALCON_INIT_VAR(next);
+
+	if (has_next) {
+
+		PHALCON_INIT_VAR(last_values);
+		array_init_size(last_values, i_keys);
+
+		for (i = 0; i < i_keys; ++i) {
+			phalcon_array_isset_long_fetch(&row_property, properties, i);
+
+			PHALCON_OBS_NVAR(value);
+			phalcon_read_property_zval(&value, last, row_property, PH_NOISY TSRMLS_CC);
+			phalcon_array_append(&last_values, value, PH_COPY);
+		}
+
+		phalcon_paginator_adapter_keyset_encode_cursor(next, last_values TSRMLS_CC);
+	}
+
+	object_init(return_value);
+	phalcon_update_property_zval(return_value, SL("items"), page_items TSRMLS_CC);
+	phalcon_update_property_null(return_value, SL("first") TSRMLS_CC);
+	phalcon_update_property_zval(return_value, SL("current"), cursor TSRMLS_CC);
+	phalcon_update_property_zval(return_value, SL("next"), next TSRMLS_CC);
+
+	PHALCON_MM_RESTORE();
+}
@@ -198,6 +198,8 @@ PHP_METHOD(Phalcon_Paginator_Adapter_Model, getPaginate){
 			if (i >= i_show) {
 				break;
 			}
+
+			PHALCON_CALL_METHOD(NULL, items, "next");
 		}
 	}
 	
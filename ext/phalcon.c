@@ -182,6 +182,14 @@ static void phalcon_verify_permanent_zvals(int strict TSRMLS_DC)
 
 #endif
 
+static PHP_INI_MH(OnUpdateOrmCacheLevel)
+{
+	zend_phalcon_globals *phalcon_globals_ptr = PHALCON_VGLOBAL;
+
+	phalcon_globals_ptr->orm.cache_level = atoi(new_value);
+	return SUCCESS;
+}
+
 PHP_INI_BEGIN()
 	/* Enables/Disables globally the internal events */
 	STD_PHP_INI_BOOLEAN("phalcon.orm.events",                   "1", PHP_INI_ALL,    OnUpdateBool, orm.events,                   zend_phalcon_globals, phalcon_globals)
@@ -195,6 +203,10 @@ PHP_INI_BEGIN()
 	STD_PHP_INI_BOOLEAN("phalcon.orm.exception_on_failed_save", "0", PHP_INI_ALL,    OnUpdateBool, orm.exception_on_failed_save, zend_phalcon_globals, phalcon_globals)
 	/* Enables/Disables literals in PHQL */
 	STD_PHP_INI_BOOLEAN("phalcon.orm.enable_literals",          "1", PHP_INI_ALL,    OnUpdateBool, orm.enable_literals,          zend_phalcon_globals, phalcon_globals)
+	/* Sets the PHQL parser cache level, a negative level disables the cache */
+	PHP_INI_ENTRY("phalcon.orm.cache_level",                    "3", PHP_INI_ALL,    OnUpdateOrmCacheLevel)
+	/* Minimum number of rows to store a resultset by column, 0 disables it */
+	STD_PHP_INI_ENTRY("phalcon.orm.columnar_resultsets",        "0", PHP_INI_ALL,    OnUpdateLong, orm.columnar_resultsets,        zend_phalcon_globals, phalcon_globals)
 	/* Enables/Disables auttomatic escape */
 	STD_PHP_INI_BOOLEAN("phalcon.db.escape_identifiers",        "1", PHP_INI_ALL,    OnUpdateBool, db.escape_identifiers,        zend_phalcon_globals, phalcon_globals)
 	/* Whether to register PSR-3 classes */
@@ -390,6 +402,7 @@ static PHP_MINIT_FUNCTION(phalcon)
 	PHALCON_INIT(Phalcon_Paginator_Adapter_Model);
 	PHALCON_INIT(Phalcon_Paginator_Adapter_NativeArray);
 	PHALCON_INIT(Phalcon_Paginator_Adapter_QueryBuilder);
+	PHALCON_INIT(Phalcon_Paginator_Adapter_Keyset);
 	PHALCON_INIT(Phalcon_Validation);
 	PHALCON_INIT(Phalcon_Validation_Message);
 	PHALCON_INIT(Phalcon_Validation_Message_Group);
@@ -519,6 +532,7 @@ static PHP_MINIT_FUNCTION(phalcon)
 	PHALCON_INIT(Phalcon_Mvc_Model_Query_Status);
 	PHALCON_INIT(Phalcon_Mvc_Model_MetaData_Apc);
 	PHALCON_INIT(Phalcon_Mvc_Model_MetaData_Files);
+	PHALCON_INIT(Phalcon_Mvc_Model_MetaData_Mmap);
 	PHALCON_INIT(Phalcon_Mvc_Model_Query_Builder);
 	PHALCON_INIT(Phalcon_Mvc_Model_Validator_Regex);
 	PHALCON_INIT(Phalcon_Mvc_Model_ValidationFailed);
@@ -590,6 +604,7 @@ static PHP_MSHUTDOWN_FUNCTION(phalcon){
 
 	assert(PHALCON_GLOBAL(orm).parser_cache == NULL);
 	assert(PHALCON_GLOBAL(orm).ast_cache == NULL);
+	assert(PHALCON_GLOBAL(orm).sql_cache == NULL);
 
 	UNREGISTER_INI_ENTRIES();
 
@@ -732,6 +747,15 @@ static PHP_GINIT_FUNCTION(phalcon)
 
 	phalcon_globals->register_psr3_classes = 0;
 
+	/* Backed by phalcon.orm.cache_level, must not be reset on every request */
+	phalcon_globals->orm.cache_level = 3;
+
+	/* Backed by phalcon.orm.columnar_resultsets */
+	phalcon_globals->orm.columnar_resultsets = 0;
+
+	/* Read replicas cooling down, kept across requests */
+	phalcon_globals->db.unhealthy_connections = NULL;
+
 	/* 'Allocator sizeof operand mismatch' warning can be safely ignored */
 	ALLOC_PERMANENT_ZVAL(phalcon_globals->z_null);
 	INIT_ZVAL(*phalcon_globals->z_null);
@@ -780,6 +804,12 @@ static PHP_GSHUTDOWN_FUNCTION(phalcon)
 	pefree(phalcon_globals->fcache, 1);
 	phalcon_globals->fcache = NULL;
 
+	if (phalcon_globals->db.unhealthy_connections) {
+		zend_hash_destroy(phalcon_globals->db.unhealthy_connections);
+		pefree(phalcon_globals->db.unhealthy_connections, 1);
+		phalcon_globals->db.unhealthy_connections = NULL;
+	}
+
 #ifndef PHALCON_RELEASE
 	phalcon_verify_permanent_zvals(1 TSRMLS_CC);
 #endif
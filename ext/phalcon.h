@@ -243,6 +243,7 @@
 #include "mvc/model/metadatainterface.h"
 #include "mvc/model/metadata/apc.h"
 #include "mvc/model/metadata/files.h"
+#include "mvc/model/metadata/mmap.h"
 #include "mvc/model/metadata/memory.h"
 #include "mvc/model/metadata/xcache.h"
 #include "mvc/model/metadata/session.h"
@@ -310,6 +311,7 @@
 #include "paginator/adapter/model.h"
 #include "paginator/adapter/nativearray.h"
 #include "paginator/adapter/querybuilder.h"
+#include "paginator/adapter/keyset.h"
 #include "paginator/exception.h"
 
 #include "psr/log/abstractlogger.h"
@@ -59,6 +59,8 @@ typedef struct _phalcon_symbol_table {
 typedef struct _phalcon_orm_options {
 	HashTable *parser_cache;
 	HashTable *ast_cache;
+	HashTable *sql_cache;
+	unsigned long sql_cache_misses;
 	int cache_level;
 	int unique_cache_id;
 	zend_bool events;
@@ -67,11 +69,15 @@ typedef struct _phalcon_orm_options {
 	zend_bool not_null_validations;
 	zend_bool exception_on_failed_save;
 	zend_bool enable_literals;
+	zend_bool identity_map;
+	long columnar_resultsets;
 } phalcon_orm_options;
 
 /** DB options */
 typedef struct _phalcon_db_options {
 	zend_bool escape_identifiers;
+	unsigned long count_fallbacks;
+	HashTable *unhealthy_connections;
 } phalcon_db_options;
 
 /** Security options */
@@ -796,4 +796,87 @@ class DbDescribeTest extends PHPUnit_Framework_TestCase
 		$this->assertEquals($describeReferences, $expectedReferences);
 	}
 
+	public function testSchemaCache()
+	{
+
+		require 'unit-tests/config.db.php';
+		if (empty($configSqlite)) {
+			$this->markTestSkipped("Skipped");
+			return;
+		}
+
+		$queries = 0;
+
+		$eventsManager = new Phalcon\Events\Manager();
+		$eventsManager->attach('db:beforeQuery', function() use (&$queries) {
+			$queries++;
+		});
+
+		$cache = new Phalcon\Cache\Backend\Memory(new Phalcon\Cache\Frontend\Data());
+
+		$connection = new Phalcon\Db\Adapter\Pdo\Sqlite($configSqlite);
+		$connection->setEventsManager($eventsManager);
+		$connection->setSchemaCache($cache);
+		$this->assertSame($connection->getSchemaCache(), $cache);
+
+		$expectedDescribe = $this->getExpectedColumnsSqlite();
+
+		$this->assertEquals($connection->describeColumns('personas'), $expectedDescribe);
+		$this->assertEquals($queries, 1);
+
+		//Descriptions are read from the cache
+		$this->assertEquals($connection->describeColumns('personas'), $expectedDescribe);
+		$connection->describeIndexes('robots_parts');
+		$connection->describeIndexes('robots_parts');
+		$this->assertEquals($queries, 2);
+
+		//Other connections to the same database share the descriptions
+		$other = new Phalcon\Db\Adapter\Pdo\Sqlite($configSqlite);
+		$other->setEventsManager($eventsManager);
+		$other->setSchemaCache($cache);
+		$this->assertEquals($other->describeColumns('personas'), $expectedDescribe);
+		$this->assertEquals($queries, 2);
+
+		//Explicit invalidation of a table
+		$connection->clearSchemaCache('personas');
+		$connection->describeColumns('personas');
+		$connection->describeIndexes('robots_parts');
+		$this->assertEquals($queries, 3);
+
+		//DDL statements discard every description
+		$connection->execute('CREATE TABLE schema_cache (id INTEGER)');
+		$connection->dropTable('schema_cache');
+		$queries = 0;
+
+		$connection->describeColumns('personas');
+		$connection->describeIndexes('robots_parts');
+		$this->assertEquals($queries, 2);
+
+		//Comments before the keyword and DDL sent through query() are detected too
+		$connection->query("-- migration\n/* schema */ CREATE TABLE schema_cache (id INTEGER)");
+		$connection->query('DROP TABLE schema_cache');
+		$queries = 0;
+
+		$connection->describeColumns('personas');
+		$this->assertEquals($queries, 1);
+
+		//Generations started by other connections are seen right away
+		$other->clearSchemaCache();
+		$connection->describeColumns('personas');
+		$this->assertEquals($queries, 2);
+		$other->describeColumns('personas');
+		$this->assertEquals($queries, 2);
+
+		$other->execute('CREATE TABLE schema_cache (id INTEGER)');
+		$other->dropTable('schema_cache');
+		$queries = 0;
+
+		$connection->describeColumns('personas');
+		$this->assertEquals($queries, 1);
+
+		$connection->setSchemaCache(null);
+		$connection->describeColumns('personas');
+		$this->assertEquals($queries, 2);
+	}
+
 }
@@ -23,6 +23,18 @@ use Phalcon\Db\Column as Column;
 use Phalcon\Db\Index as Index;
 use Phalcon\Db\Reference as Reference;
 
+class DbDialectPrefixed extends \Phalcon\Db\Dialect\Mysql
+{
+
+	public $prefix = '';
+
+	public function getSqlTable($table, $escapeChar = null)
+	{
+		return parent::getSqlTable($this->prefix . $table, $escapeChar);
+	}
+
+}
+
 class DbDialectTest extends PHPUnit_Framework_TestCase
 {
 
@@ -497,6 +509,48 @@ class DbDialectTest extends PHPUnit_Framework_TestCase
 		// Not implemented yet
 	}
 
+	public function testSelectCache()
+	{
+		$definition = array(
+			'columns' => array(
+				array('id', 'robots'),
+				array('name', 'robots', 'n'),
+			),
+			'tables' => array('robots'),
+			'where' => array(
+				'type' => 'binary-op',
+				'op' => '=',
+				'left' => array('type' => 'qualified', 'domain' => 'robots', 'name' => 'id'),
+				'right' => array('type' => 'placeholder', 'value' => ':id'),
+			),
+		);
+
+		$mysql = new \Phalcon\Db\Dialect\Mysql();
+		$sqlite = new \Phalcon\Db\Dialect\Sqlite();
+
+		//Repeated definitions return the same SQL
+		$expected = 'SELECT `robots`.`id`, `robots`.`name` AS `n` FROM `robots` WHERE `robots`.`id` = :id';
+		$this->assertEquals($mysql->select($definition), $expected);
+		$this->assertEquals($mysql->select($definition), $expected);
+
+		//Every dialect and escaping mode has its own SQL
+		$this->assertEquals($sqlite->select($definition), 'SELECT "robots"."id", "robots"."name" AS "n" FROM "robots" WHERE "robots"."id" = :id');
+
+		ini_set('phalcon.db.escape_identifiers', 0);
+		$this->assertEquals($mysql->select($definition), 'SELECT robots.id, robots.name AS n FROM robots WHERE robots.id = :id');
+		ini_set('phalcon.db.escape_identifiers', 1);
+
+		//A different definition produces a different SQL
+		$definition['where']['right']['value'] = ':other';
+		$this->assertEquals($mysql->select($definition), 'SELECT `robots`.`id`, `robots`.`name` AS `n` FROM `robots` WHERE `robots`.`id` = :other');
+
+		//Userland dialects aren't cached
+		$prefixed = new DbDialectPrefixed();
+		$this->assertEquals($prefixed->select($definition), 'SELECT `robots`.`id`, `robots`.`name` AS `n` FROM `robots` WHERE `robots`.`id` = :other');
+		$prefixed->prefix = 'old_';
+		$this->assertEquals($prefixed->select($definition), 'SELECT `robots`.`id`, `robots`.`name` AS `n` FROM `old_robots` WHERE `robots`.`id` = :other');
+	}
+
 	public function testViews()
 	{
 	// MySQL
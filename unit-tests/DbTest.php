@@ -110,6 +110,53 @@ class DbTest extends PHPUnit_Framework_TestCase
 
 	}
 
+	/**
+	 * @medium
+	 */
+	public function testDbStatementCache()
+	{
+		require 'unit-tests/config.db.php';
+
+		if (empty($configSqlite)) {
+			$this->markTestSkipped("Skipped");
+			return;
+		}
+
+		$connection = new Phalcon\Db\Adapter\Pdo\Sqlite(array_merge($configSqlite, array('statementCacheSize' => 2)));
+
+		$sql = "SELECT * FROM personas WHERE estado = ? LIMIT 3";
+		for ($i = 0; $i < 3; $i++) {
+			$result = $connection->query($sql, array('A'));
+			$this->assertEquals(count($result->fetchAll()), 3);
+			unset($result);
+		}
+
+		$stats = $connection->getStatementCacheStats();
+		$this->assertEquals($stats, array('size' => 2, 'statements' => 1, 'hits' => 2, 'misses' => 1));
+
+		//Statements still read by a result are not shared
+		$first = $connection->query($sql, array('A'));
+		$second = $connection->query($sql, array('A'));
+		$this->assertEquals(count($first->fetchAll()), 3);
+		$this->assertEquals(count($second->fetchAll()), 3);
+		unset($first, $second);
+
+		$connection->query("SELECT * FROM personas WHERE estado = ? LIMIT 1", array('A'));
+		$connection->query("SELECT * FROM personas WHERE estado = ? LIMIT 2", array('A'));
+		$stats = $connection->getStatementCacheStats();
+		$this->assertEquals($stats['statements'], 2);
+
+		$connection->execute("CREATE TABLE IF NOT EXISTS statement_cache_test (id INTEGER)");
+		$connection->execute("DROP TABLE statement_cache_test");
+		$stats = $connection->getStatementCacheStats();
+		$this->assertEquals($stats['statements'], 0);
+
+		$connection->setStatementCacheSize(0);
+		$connection->query($sql, array('A'));
+		$stats = $connection->getStatementCacheStats();
+		$this->assertEquals($stats['misses'], 4);
+	}
+
 	protected function _executeTests($connection)
 	{
 
@@ -211,6 +258,20 @@ class DbTest extends PHPUnit_Framework_TestCase
 		$this->assertTrue($success);
 		$this->assertEquals($connection->affectedRows(), 53);
 
+		$rows = array();
+		for ($i = 0; $i < 1200; $i++) {
+			$rows[] = array("LOL ".$i, "F");
+		}
+		$rows[] = array(new Phalcon\Db\RawValue('current_date'), "A");
+		$success = $connection->insertMultiple('prueba', $rows, array('nombre', 'estado'));
+		$this->assertTrue($success);
+
+		$row = $connection->fetchOne("SELECT COUNT(*) AS total FROM prueba");
+		$this->assertEquals($row['total'], 1201);
+
+		$success = $connection->delete("prueba");
+		$this->assertTrue($success);
+
 		$row = $connection->fetchOne("SELECT * FROM personas");
 		$this->assertEquals(count($row), 22);
 
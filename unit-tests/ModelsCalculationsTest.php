@@ -235,6 +235,33 @@ class ModelsCalculationsTest extends PHPUnit_Framework_TestCase
 		$group = Personnes::minimum(array("column" => "ciudad_id", "group" => "estado", "order" => "minimum ASC"));
 		$this->assertEquals($group[0]->minimum, 20404);
 
+		//Scalar aggregates with bound parameters
+		$rowcount = Personnes::count(array("estado = ?0", "bind" => array('A')));
+		$this->assertEquals($rowcount, 2178);
+
+		$rowcount = Personnes::count(array("conditions" => "estado = :estado:", "bind" => array('estado' => 'I'), "bindTypes" => array('estado' => Phalcon\Db\Column::BIND_PARAM_STR)));
+		$this->assertEquals($rowcount, 2);
+
+		$max = Personnes::maximum(array("estado = :estado:", "column" => "ciudad_id", "bind" => array('estado' => 'I')));
+		$this->assertEquals($max, 127591);
+
+		//Scalar aggregates honor the cache options
+		$di = Phalcon\DI::getDefault();
+		$di->set('modelsCache', function(){
+			return new Phalcon\Cache\Backend\Memory(new Phalcon\Cache\Frontend\Data());
+		}, true);
+
+		$rowcount = Personnes::count(array("estado='I'", "cache" => array("key" => "personnes-inactive")));
+		$this->assertEquals($rowcount, 2);
+		$this->assertEquals($di->getShared('modelsCache')->get('personnes-inactive'), 2);
+
+		$di->getShared('modelsCache')->save('personnes-inactive', 7);
+		$rowcount = Personnes::count(array("estado='I'", "cache" => array("key" => "personnes-inactive")));
+		$this->assertEquals($rowcount, 7);
+
+		$query = $di->getShared('modelsManager')->createQuery("SELECT SUM(ciudad_id) FROM Personnes WHERE estado = :estado:");
+		$this->assertEquals($query->getScalarResult(array('estado' => 'I')), Personnes::sum(array("estado='I'", "column" => "ciudad_id")));
+
 	}
 
 	protected function _executeTestsRenamed()
@@ -18,6 +18,19 @@
   +------------------------------------------------------------------------+
 */
 
+class ModelsEventsManager extends Phalcon\Mvc\Model\Manager
+{
+
+	public $notified = array();
+
+	public function notifyEvent($eventName, $model)
+	{
+		$this->notified[] = $eventName;
+		return parent::notifyEvent($eventName, $model);
+	}
+
+}
+
 class ModelsEventsTest extends PHPUnit_Framework_TestCase
 {
 
@@ -197,4 +210,72 @@ class ModelsEventsTest extends PHPUnit_Framework_TestCase
 
 	}
 
+	public function testEventsHandlers()
+	{
+		Phalcon\DI::reset();
+
+		$di = new Phalcon\DI();
+
+		$di->set('modelsManager', function() {
+			return new Phalcon\Mvc\Model\Manager();
+		}, true);
+
+		$trace = array();
+
+		$robot = new GossipRobots();
+		$robot->trace = &$trace;
+
+		//Only the methods implemented by the model are called
+		$robot->fireEvent('beforeSave');
+		$this->assertNull($robot->fireEvent('afterDelete'));
+		$this->assertTrue($robot->fireEventCancel('afterCreate'));
+		$this->assertFalse($robot->fireEventCancel('beforeCreate'));
+
+		$this->assertEquals($trace, array(
+			'beforeSave' => array(
+				'GossipRobots' => 1,
+			),
+			'beforeCreate' => array(
+				'GossipRobots' => 1,
+			)
+		));
+
+		//Events managers attached after the initialization are notified
+		$events = array();
+
+		$eventsManager = new Phalcon\Events\Manager();
+		$eventsManager->attach('model', function($event, $model) use (&$events) {
+			$events[] = $event->getType();
+		});
+
+		$di->getShared('modelsManager')->setCustomEventsManager($robot, $eventsManager);
+
+		$robot->fireEvent('afterDelete');
+		$this->assertTrue($robot->fireEventCancel('afterCreate'));
+
+		$this->assertEquals($events, array('afterDelete', 'afterCreate'));
+	}
+
+	public function testEventsHandlersOverridden()
+	{
+		Phalcon\DI::reset();
+
+		$di = new Phalcon\DI();
+
+		$di->set('modelsManager', function() {
+			return new ModelsEventsManager();
+		}, true);
+
+		$trace = array();
+
+		$robot = new GossipRobots();
+		$robot->trace = &$trace;
+
+		//Managers overriding notifyEvent() receive every event
+		$robot->fireEvent('afterDelete');
+		$this->assertTrue($robot->fireEventCancel('afterCreate'));
+
+		$this->assertEquals($di->getShared('modelsManager')->notified, array('afterDelete', 'afterCreate'));
+	}
+
 }
\ No newline at end of file
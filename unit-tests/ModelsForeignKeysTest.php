@@ -72,6 +72,7 @@ class ModelsForeignKeysTest extends PHPUnit_Framework_TestCase
 		}, true);
 
 		$this->_executeTestsNormal($di);
+		$this->_executeTestsBatched($di);
 		$this->_executeTestsRenamed($di);
 	}
 
@@ -91,6 +92,7 @@ class ModelsForeignKeysTest extends PHPUnit_Framework_TestCase
 		}, true);
 
 		$this->_executeTestsNormal($di);
+		$this->_executeTestsBatched($di);
 		$this->_executeTestsRenamed($di);
 	}
 
@@ -110,6 +112,7 @@ class ModelsForeignKeysTest extends PHPUnit_Framework_TestCase
 		}, true);
 
 		$this->_executeTestsNormal($di);
+		$this->_executeTestsBatched($di);
 		$this->_executeTestsRenamed($di);
 	}
 
@@ -185,6 +188,41 @@ class ModelsForeignKeysTest extends PHPUnit_Framework_TestCase
 
 	}
 
+	public function _executeTestsBatched($di)
+	{
+
+		$queries = array();
+
+		$eventsManager = new Phalcon\Events\Manager();
+		$eventsManager->attach('db:beforeQuery', function($event, $connection) use (&$queries) {
+			$queries[] = $connection->getSQLStatement();
+		});
+
+		$di->getShared('db')->setEventsManager($eventsManager);
+
+		//Both foreign keys are checked using a single query
+		$robotsParts = new RobotsParts();
+		$robotsParts->robots_id = 100;
+		$robotsParts->parts_id = 100;
+		$this->assertFalse($robotsParts->save());
+
+		$this->assertEquals(count($queries), 1);
+		$this->assertEquals(substr_count($queries[0], 'CASE WHEN EXISTS'), 2);
+
+		$messages = $robotsParts->getMessages();
+		$this->assertEquals(count($messages), 1);
+		$this->assertEquals($messages[0]->getField(), 'parts_id');
+
+		$robotsParts->robots_id = 1;
+		$robotsParts->parts_id = 100;
+		$this->assertFalse($robotsParts->save());
+
+		$messages = $robotsParts->getMessages();
+		$this->assertEquals($messages[0]->getField(), 'parts_id');
+
+		$di->getShared('db')->setEventsManager(new Phalcon\Events\Manager());
+	}
+
 	public function _executeTestsRenamed($di)
 	{
 
@@ -83,6 +83,7 @@ class ModelsMetadataAdaptersTest extends PHPUnit_Framework_TestCase
 
 	public function modelsAutoloader($className)
 	{
+		$className = str_replace('\\', '/', $className);
 		if (file_exists('unit-tests/models/' . $className . '.php')) {
 			require 'unit-tests/models/' . $className . '.php';
 		}
@@ -298,4 +299,130 @@ class ModelsMetadataAdaptersTest extends PHPUnit_Framework_TestCase
 		Robots::findFirst();
 	}
 
+	public function testMetadataMmap()
+	{
+		require 'unit-tests/config.db.php';
+		if (empty($configMysql)) {
+			$this->markTestSkipped('Test skipped');
+			return;
+		}
+
+		$di = $this->_getDI();
+
+		$di->set('modelsMetadata', function(){
+			return new Phalcon\Mvc\Model\Metadata\Mmap(array(
+				'metaDataFile' => 'unit-tests/cache/metadata.bin',
+			));
+		});
+
+		$metaData = $di->getShared('modelsMetadata');
+
+		$metaData->reset();
+
+		$this->assertTrue($metaData->isEmpty());
+
+		Robots::findFirst();
+
+		$this->assertFalse($metaData->isEmpty());
+		$this->assertTrue($metaData->flush());
+		$this->assertEquals($metaData->getVersion(), 1);
+
+		//Another process maps the segment written
+		$segment = new Phalcon\Mvc\Model\Metadata\Mmap(array(
+			'metaDataFile' => 'unit-tests/cache/metadata.bin',
+		));
+		$this->assertEquals($segment->getVersion(), 1);
+		$this->assertEquals($segment->read('meta-robots-robots'), $this->_data['meta-robots-robots']);
+		$this->assertEquals($segment->read('map-robots'), $this->_data['map-robots']);
+
+		//Single indexes are read without loading the whole meta-data
+		$this->assertEquals($segment->readMetaDataIndex(new Robots(), Phalcon\Mvc\Model\MetaData::MODELS_PRIMARY_KEY), array('id'));
+		$this->assertTrue($segment->isEmpty());
+		$this->assertFalse($segment->flush());
+
+		//Flushes are serialized through a lock file and keep the entries already written
+		$segment->write('map-other', array(null, null));
+		$this->assertTrue($segment->flush());
+		$this->assertTrue(file_exists('unit-tests/cache/metadata.bin.lock'));
+		$this->assertEquals($segment->getVersion(), 2);
+		$this->assertEquals($segment->read('map-robots'), $this->_data['map-robots']);
+		$this->assertEquals($segment->read('map-other'), array(null, null));
+
+		$metaData->reset();
+		$this->assertTrue($metaData->isEmpty());
+		$this->assertEquals($metaData->getVersion(), 0);
+
+		Robots::findFirst();
+	}
+
+	public function testMetadataWarmUp()
+	{
+		require 'unit-tests/config.db.php';
+		if (empty($configMysql)) {
+			$this->markTestSkipped('Test skipped');
+			return;
+		}
+
+		$di = $this->_getDI();
+
+		$di->set('modelsMetadata', function(){
+			$metaData = new Phalcon\Mvc\Model\Metadata\Files(array(
+				'metaDataDir' => 'unit-tests/cache/',
+			));
+			$metaData->setLockDir('unit-tests/cache/');
+			return $metaData;
+		});
+
+		foreach (array('dbOne', 'dbTwo') as $service) {
+			$di->set($service, function(){
+				require 'unit-tests/config.db.php';
+				return new Phalcon\Db\Adapter\Pdo\Mysql($configMysql);
+			}, true);
+		}
+
+		$metaData = $di->getShared('modelsMetadata');
+
+		$metaData->reset();
+
+		$this->assertTrue($metaData->isEmpty());
+		$this->assertEquals($metaData->getLockDir(), 'unit-tests/cache/');
+
+		$models = $metaData->warmUp(array(
+			'Store' => 'unit-tests/models/Store/',
+			'Robots'
+		));
+		sort($models);
+		$this->assertEquals($models, array('Robots', 'Store\Parts', 'Store\Robots', 'Store\RobotsParts'));
+
+		$this->assertFalse($metaData->isEmpty());
+		$this->assertEquals(require 'unit-tests/cache/meta-robots-robots.php', $this->_data['meta-robots-robots']);
+		$this->assertEquals(require 'unit-tests/cache/map-robots.php', $this->_data['map-robots']);
+		$this->assertTrue(file_exists('unit-tests/cache/meta-store_robots-robots.php'));
+		$this->assertTrue(file_exists('unit-tests/cache/meta-robots-robots.lock'));
+
+		//Stale meta-data is introspected again and replaced, the lock is released afterwards
+		$metaData->write('meta-robots-robots', array());
+		$this->assertEquals($metaData->warmUp('Robots'), array('Robots'));
+		$this->assertEquals(require 'unit-tests/cache/meta-robots-robots.php', $this->_data['meta-robots-robots']);
+		$this->assertEquals($metaData->readMetaData(new Robots()), $this->_data['meta-robots-robots']);
+
+		$lock = fopen('unit-tests/cache/meta-robots-robots.lock', 'r');
+		$this->assertTrue(flock($lock, LOCK_EX | LOCK_NB));
+		flock($lock, LOCK_UN);
+		fclose($lock);
+
+		try {
+			$metaData->warmUp('ModelsMetadataAdaptersTest');
+			$this->assertTrue(false);
+		}
+		catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), "Model 'ModelsMetadataAdaptersTest' could not be loaded");
+		}
+
+		$metaData->reset();
+		$this->assertTrue($metaData->isEmpty());
+
+		Robots::findFirst();
+	}
+
 }
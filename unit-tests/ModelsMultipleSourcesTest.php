@@ -39,6 +39,13 @@ class ModelsMultipleSourcesTest extends PHPUnit_Framework_TestCase
 		}
 	}
 
+	public function tearDown()
+	{
+		foreach (glob(sys_get_temp_dir() . '/phalcon_test_*.sqlite') as $file) {
+			unlink($file);
+		}
+	}
+
 	protected function _prepareDI()
 	{
 		Phalcon\DI::reset();
@@ -105,4 +112,290 @@ class ModelsMultipleSourcesTest extends PHPUnit_Framework_TestCase
 		$this->assertFalse($robot->save());
 	}
 
+	public function testReadReplicas()
+	{
+		require 'unit-tests/config.db.php';
+		if (empty($configSqlite)) {
+			$this->marktestSkipped('Test skipped');
+			return;
+		}
+
+		Phalcon\DI::reset();
+
+		$di = new Phalcon\DI();
+
+		$di->set('modelsManager', function() {
+			return new Phalcon\Mvc\Model\Manager();
+		}, true);
+
+		$di->set('modelsMetadata', function() {
+			return new Phalcon\Mvc\Model\Metadata\Memory();
+		}, true);
+
+		$replicas = array('db' => $configSqlite['dbname']);
+		foreach (array('replicaOne', 'replicaTwo') as $name) {
+			$replicas[$name] = sys_get_temp_dir() . '/phalcon_test_' . $name . '.sqlite';
+			copy($configSqlite['dbname'], $replicas[$name]);
+		}
+		$replicas['replicaDown'] = '/nonexistent/phalcon_test.sqlite';
+
+		foreach ($replicas as $name => $dbname) {
+			$di->set($name, function() use ($dbname) {
+				return new Phalcon\Db\Adapter\Pdo\Sqlite(array('dbname' => $dbname));
+			}, true);
+		}
+
+		$manager = $di->getShared('modelsManager');
+		$robot = new Robots();
+
+		//A pool where every replica is down falls back to the write connection
+		$manager->setReadConnectionService($robot, array('replicaDown'));
+		$descriptor = $manager->getReadConnection($robot)->getDescriptor();
+		$this->assertEquals($descriptor['dbname'], $replicas['db']);
+		$this->assertEquals($manager->getReadConnectionService($robot), 'db');
+
+		//The failed replica is cooling down
+		$manager->setReadConnectionService($robot, array('replicaDown', 'replicaOne'));
+		for ($i = 0; $i < 10; $i++) {
+			$manager->resetReadConnections();
+			$descriptor = $manager->getReadConnection($robot)->getDescriptor();
+			$this->assertEquals($descriptor['dbname'], $replicas['replicaOne']);
+		}
+		$this->assertTrue(Robots::count() > 0);
+
+		//The cool-down outlives the manager that found the failure
+		$other = new Phalcon\Mvc\Model\Manager();
+		$other->setDI($di);
+		$other->setReadConnectionService($robot, array('replicaDown' => 100, 'replicaOne' => 1));
+		for ($i = 0; $i < 10; $i++) {
+			$other->resetReadConnections();
+			$this->assertEquals($other->getReadConnectionService($robot), 'replicaOne');
+		}
+
+		//Only connection failures move the read to another replica
+		$di->set('replicaBroken', function() {
+			throw new Exception('Not a connection failure');
+		}, true);
+		$other->setReadConnectionService($robot, array('replicaBroken', 'replicaOne'));
+		try {
+			for ($i = 0; $i < 64; $i++) {
+				$other->resetReadConnections();
+				$other->getReadConnection($robot);
+			}
+			$this->assertTrue(false);
+		}
+		catch (Exception $e) {
+			$this->assertEquals($e->getMessage(), 'Not a connection failure');
+		}
+
+		//Replicas are picked by weight and kept until the next reset
+		$manager->setReadConnectionService($robot, array('replicaOne' => 1, 'replicaTwo' => 1, 'replicaDown' => 0));
+		$service = $manager->getReadConnectionService($robot);
+		for ($i = 0; $i < 10; $i++) {
+			$this->assertEquals($manager->getReadConnectionService($robot), $service);
+		}
+
+		$services = array();
+		for ($i = 0; $i < 64; $i++) {
+			$manager->resetReadConnections();
+			$services[$manager->getReadConnectionService($robot)] = true;
+		}
+		ksort($services);
+		$this->assertEquals(array_keys($services), array('replicaOne', 'replicaTwo'));
+
+		//The replica is picked once per request for every model reading from it
+		$persona = new Personas();
+		$manager->setReadConnectionService($persona, array('replicaTwo', 'replicaOne'));
+		for ($i = 0; $i < 16; $i++) {
+			$manager->resetReadConnections();
+			$this->assertEquals($manager->getReadConnectionService($persona), $manager->getReadConnectionService($robot));
+		}
+
+		//Reads stick to the write connection once it is used
+		$manager->getWriteConnection($robot);
+		$this->assertEquals($manager->getReadConnectionService($robot), 'db');
+		$descriptor = $manager->getReadConnection($robot)->getDescriptor();
+		$this->assertEquals($descriptor['dbname'], $replicas['db']);
+
+		$manager->resetReadConnections();
+		$this->assertNotEquals($manager->getReadConnectionService($robot), 'db');
+
+		try {
+			$manager->setReadConnectionService($robot, array('replicaOne' => 0));
+			$this->assertTrue(false);
+		}
+		catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), 'The pool of read connection services cannot be empty');
+		}
+	}
+
+	public function testShards()
+	{
+		require 'unit-tests/config.db.php';
+		if (empty($configSqlite)) {
+			$this->marktestSkipped('Test skipped');
+			return;
+		}
+
+		Phalcon\DI::reset();
+
+		$di = new Phalcon\DI();
+
+		$di->set('modelsManager', function() {
+			return new Phalcon\Mvc\Model\Manager();
+		}, true);
+
+		$di->set('modelsMetadata', function() {
+			return new Phalcon\Mvc\Model\Metadata\Memory();
+		}, true);
+
+		$di->set('db', function() {
+			throw new Exception('Using default database source');
+		}, true);
+
+		//Robots and their parts are split by the id of the robot
+		$shards = array('shardZero', 'shardOne');
+		foreach ($shards as $position => $name) {
+			$dbname = sys_get_temp_dir() . '/phalcon_test_' . $name . '.sqlite';
+			copy($configSqlite['dbname'], $dbname);
+
+			$connection = new Phalcon\Db\Adapter\Pdo\Sqlite(array('dbname' => $dbname));
+			$connection->delete('robots', 'id % 2 <> ' . $position);
+			$connection->delete('robots_parts', 'robots_id % 2 <> ' . $position);
+			$connection->close();
+
+			$di->set($name, function() use ($dbname) {
+				return new Phalcon\Db\Adapter\Pdo\Sqlite(array('dbname' => $dbname));
+			}, true);
+		}
+
+		$manager = $di->getShared('modelsManager');
+		$manager->setShards(new Robots(), $shards, 'id');
+		$manager->setShards(new RobotsParts(), $shards, 'robots_id');
+
+		$this->assertEquals($manager->getShards(new Robots()), $shards);
+		$this->assertEquals($manager->getShardKey(new RobotsParts()), 'robots_id');
+		$this->assertEquals($manager->getShardService(new Robots(), 3), 'shardOne');
+		$this->assertEquals($manager->getShardService(new Robots(), '2'), 'shardZero');
+		$this->assertNull($manager->getShards(new Parts()));
+
+		//Queries fixing the shard key go to its shard
+		$robot = Robots::findFirst(array('id = ?0', 'bind' => array(3)));
+		$this->assertEquals($robot->name, 'Terminator');
+		$this->assertEquals($manager->getReadConnectionService($robot), 'shardOne');
+		$this->assertEquals(Robots::count('id = 2'), 1);
+
+		//Relations are read from the shard of the related records
+		$robot = Robots::findFirst(array('id = :id:', 'bind' => array('id' => 1)));
+		$this->assertEquals(count($robot->getRobotsParts()), 3);
+
+		$robot = Robots::findFirst(array('id = :id:', 'bind' => array('id' => 2)));
+		$this->assertEquals(count($robot->getRobotsParts()), 0);
+
+		//Queries without the shard key are scattered and merged
+		$ids = array();
+		foreach (Robots::find(array('order' => 'id DESC')) as $robot) {
+			$ids[] = (int) $robot->id;
+		}
+		$this->assertEquals($ids, array(3, 2, 1));
+
+		$names = array();
+		foreach (Robots::find(array('order' => 'name', 'limit' => 2, 'offset' => 1)) as $robot) {
+			$names[] = $robot->name;
+		}
+		$this->assertEquals($names, array('Robotina', 'Terminator'));
+
+		//Aggregates without the shard key are computed on every shard and combined
+		$this->assertEquals(Robots::count(), 3);
+		$this->assertEquals(Robots::count("type = 'mechanical'"), 2);
+		$this->assertEquals(Robots::sum(array('column' => 'id')), 6);
+		$this->assertEquals(Robots::minimum(array('column' => 'id')), 1);
+		$this->assertEquals(Robots::maximum(array('column' => 'id')), 3);
+		$this->assertEquals(RobotsParts::count(), 3);
+
+		try {
+			Robots::average(array('column' => 'id'));
+			$this->assertTrue(false);
+		}
+		catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), "The shard key 'id' is required to query the sharded model 'Robots' this way");
+		}
+
+		try {
+			Robots::count(array('distinct' => 'type'));
+			$this->assertTrue(false);
+		}
+		catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), "The shard key 'id' is required to query the sharded model 'Robots' this way");
+		}
+
+		//Records are written to their own shard
+		$robot = Robots::findFirst(array('id = 2'));
+		$robot->name = 'Astro Girl';
+		$this->assertTrue($robot->save());
+
+		$row = $di->getShared('shardZero')->fetchOne('SELECT name FROM robots WHERE id = 2');
+		$this->assertEquals($row['name'], 'Astro Girl');
+		$this->assertFalse($di->getShared('shardOne')->fetchOne('SELECT name FROM robots WHERE id = 2'));
+
+		//Records without a value in the shard key can't be placed in a shard
+		$robot = new Robots();
+		$robot->name = 'Lost';
+		$robot->type = 'mechanical';
+		$robot->year = 2014;
+		try {
+			$robot->save();
+			$this->assertTrue(false);
+		}
+		catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), "The shard key 'id' of the sharded model 'Robots' must have a value to write the record");
+		}
+
+		//Bulk updates write every record to its own shard
+		$status = $manager->executeQuery('UPDATE Robots SET year = 2015');
+		$this->assertTrue($status->success());
+
+		$row = $di->getShared('shardZero')->fetchOne('SELECT year FROM robots WHERE id = 2');
+		$this->assertEquals($row['year'], 2015);
+		$row = $di->getShared('shardOne')->fetchOne('SELECT year FROM robots WHERE id = 3');
+		$this->assertEquals($row['year'], 2015);
+
+		//Resultsets update the rows of every shard
+		$this->assertTrue(Robots::find()->update(array('type' => 'virtual')));
+
+		$row = $di->getShared('shardZero')->fetchOne('SELECT type FROM robots WHERE id = 2');
+		$this->assertEquals($row['type'], 'virtual');
+		$row = $di->getShared('shardOne')->fetchOne('SELECT type FROM robots WHERE id = 3');
+		$this->assertEquals($row['type'], 'virtual');
+
+		//Bulk deletes remove every record from its own shard
+		foreach (array(4, 5) as $id) {
+			$robot = new Robots();
+			$robot->id = $id;
+			$robot->name = 'Bulk ' . $id;
+			$robot->type = 'virtual';
+			$robot->year = 2015;
+			$this->assertTrue($robot->save());
+		}
+
+		$status = $manager->executeQuery('DELETE FROM Robots WHERE id > 3');
+		$this->assertTrue($status->success());
+
+		$this->assertFalse($di->getShared('shardZero')->fetchOne('SELECT id FROM robots WHERE id = 4'));
+		$this->assertFalse($di->getShared('shardOne')->fetchOne('SELECT id FROM robots WHERE id = 5'));
+		$this->assertEquals(Robots::count(), 3);
+
+		//Removing without the shard key runs on every shard
+		$this->assertEquals(Robots::remove('id > 1'), 2);
+
+		$row = $di->getShared('shardZero')->fetchOne('SELECT COUNT(*) AS total FROM robots');
+		$this->assertEquals($row['total'], 0);
+		$row = $di->getShared('shardOne')->fetchOne('SELECT COUNT(*) AS total FROM robots');
+		$this->assertEquals($row['total'], 1);
+
+		//Removing with the shard key only runs on its shard
+		$this->assertEquals(Robots::remove(array('id = ?0', 'bind' => array(1))), 1);
+		$this->assertEquals(Robots::count(), 0);
+	}
+
 }
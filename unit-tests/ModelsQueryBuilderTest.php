@@ -313,6 +313,121 @@ class ModelsQueryBuilderTest extends PHPUnit_Framework_TestCase
 		$this->assertEquals($phql, 'SELECT Robots.name FROM [Robots] HAVING Robots.price > 1000');
 	}
 
+	public function testIntermediateReuse()
+	{
+		require 'unit-tests/config.db.php';
+		if (empty($configMysql)) {
+			$this->markTestSkipped("Test skipped");
+			return;
+		}
+
+		$di = $this->_getDI();
+
+		$builder = new Builder();
+		$query = $builder->setDi($di)
+			->from('Robots')
+			->where('Robots.id > :id:', array('id' => 1))
+			->orderBy('Robots.id')
+			->getQuery();
+		$this->assertTrue(is_array($query->getIntermediate()));
+		$robots = $query->execute();
+		$this->assertEquals(count($robots), 2);
+
+		$builder = new Builder();
+		$query = $builder->setDi($di)
+			->from('Robots')
+			->where('Robots.id > :id:', array('id' => 2))
+			->orderBy('Robots.id')
+			->getQuery();
+		$this->assertTrue(is_array($query->getIntermediate()));
+		$robots = $query->execute();
+		$this->assertEquals(count($robots), 1);
+		$this->assertEquals($robots->getFirst()->id, 3);
+
+		//Errors in the PHQL are reported by getQuery()
+		try {
+			$builder = new Builder();
+			$builder->setDi($di)
+				->from('Robots')
+				->where('Robots.id >')
+				->getQuery();
+			$this->assertTrue(false);
+		}
+		catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertTrue(true);
+		}
+	}
+
+	public function testQueryFromParts()
+	{
+		require 'unit-tests/config.db.php';
+		if (empty($configMysql)) {
+			$this->markTestSkipped("Test skipped");
+			return;
+		}
+
+		$di = $this->_getDI();
+
+		$builders = array(
+			function($builder) {
+				return $builder->from('Robots');
+			},
+			function($builder) {
+				return $builder->from(array('r' => 'Robots', 'RobotsParts'))->distinct(true);
+			},
+			function($builder) {
+				return $builder->columns(array('id', 'total' => 'COUNT(*)'))->from('Robots')->distinct(false);
+			},
+			function($builder) {
+				return $builder->from('Robots')->where(100);
+			},
+			function($builder) {
+				return $builder->from('Robots')
+					->join('RobotsParts', 'Robots.id = RobotsParts.robots_id', 'p')
+					->leftJoin('Parts', 'Parts.id = p.parts_id')
+					->rightJoin('RobotsParts', null, 'q');
+			},
+			function($builder) {
+				return $builder->columns('Robots.type, SUM(Robots.price)')
+					->from('Robots')
+					->where('Robots.id > :id:')
+					->groupBy(array('Robots.type', 'id'))
+					->having('SUM(Robots.price) > 1000')
+					->orderBy('Robots.type DESC');
+			},
+			function($builder) {
+				return $builder->from('Robots')->orderBy(array('id', 'Robots.name'))->limit(10, 5);
+			},
+			function($builder) {
+				return $builder->from('Robots')->limit(array('number' => '10', 'offset' => '20'));
+			},
+		);
+
+		foreach ($builders as $build) {
+
+			$builder = new Builder();
+			$builder->setDi($di);
+			$build($builder);
+
+			//The query built from the parts of the builder is prepared as its PHQL would be
+			$query = new Phalcon\Mvc\Model\Query($builder->getPhql(), $di);
+			$this->assertEquals($builder->getQuery()->getIntermediate(), $query->parse());
+		}
+
+		//Joins of an unknown type are rejected
+		try {
+			$builder = new Builder();
+			$builder->setDi($di)
+				->from('Robots')
+				->join('RobotsParts', null, null, 'SIDEWAYS')
+				->getQuery();
+			$this->assertTrue(false);
+		}
+		catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), 'Unknown join type: SIDEWAYS');
+		}
+	}
+
 	public function testSelectDistinctAll()
 	{
 		require 'unit-tests/config.db.php';
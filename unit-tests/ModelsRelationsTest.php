@@ -74,6 +74,7 @@ class ModelsRelationsTest extends PHPUnit_Framework_TestCase
 
 		$this->_executeTestsNormal($di);
 		$this->_executeTestsRenamed($di);
+		$this->_executeTestsEager($di);
 		$this->_testIssue938($di);
 	}
 
@@ -94,6 +95,7 @@ class ModelsRelationsTest extends PHPUnit_Framework_TestCase
 
 		$this->_executeTestsNormal($di);
 		$this->_executeTestsRenamed($di);
+		$this->_executeTestsEager($di);
 
 	}
 
@@ -114,6 +116,7 @@ class ModelsRelationsTest extends PHPUnit_Framework_TestCase
 
 		$this->_executeTestsNormal($di);
 		$this->_executeTestsRenamed($di);
+		$this->_executeTestsEager($di);
 		$this->_testIssue938($di);
 	}
 
@@ -321,6 +324,73 @@ class ModelsRelationsTest extends PHPUnit_Framework_TestCase
 
 	}
 
+	protected function _executeTestsEager($di)
+	{
+		$db = $di->getShared('db');
+
+		$robots = RelationsRobots::find(array(
+			'order' => 'id',
+			'with' => array('relationsRobotsParts.relationsParts', 'relationsParts')
+		));
+
+		$builderRobots = $di->getShared('modelsManager')->createBuilder()
+			->from('RelationsRobots')
+			->orderBy('id')
+			->with('relationsRobotsParts')
+			->getQuery()
+			->execute();
+
+		//Related records must be served from memory
+		$queries = 0;
+		$eventsManager = new Phalcon\Events\Manager();
+		$eventsManager->attach('db:beforeQuery', function() use (&$queries) {
+			$queries++;
+		});
+		$db->setEventsManager($eventsManager);
+
+		$robot = $robots->getFirst();
+
+		$robotsParts = $robot->relationsRobotsParts;
+		$this->assertEquals(get_class($robotsParts), 'Phalcon\Mvc\Model\Resultset\Simple');
+		$this->assertEquals(count($robotsParts), 3);
+		foreach ($robotsParts as $robotPart) {
+			$this->assertEquals(get_class($robotPart->relationsParts), 'RelationsParts');
+			$this->assertEquals($robotPart->relationsParts->id, $robotPart->parts_id);
+		}
+
+		$this->assertEquals(count($robot->relationsParts), 3);
+		$this->assertEquals(count($builderRobots->getFirst()->relationsRobotsParts), 3);
+
+		$this->assertEquals($queries, 0);
+
+		//Only relation aliases fall back to the lowercased name, attributes keep their case
+		try {
+			$robot->NAME;
+			$this->fail('Attribute read using a different case');
+		} catch (PHPUnit_Framework_Error_Notice $e) {
+			$this->assertEquals($e->getMessage(), 'Access to undefined property RelationsRobots::NAME');
+		}
+
+		//The keys are queried in chunks that fit in the parameters accepted by the database
+		$maxBindParams = new ReflectionProperty(get_class($db->getDialect()), '_maxBindParams');
+		$maxBindParams->setAccessible(true);
+		$limit = $maxBindParams->getValue($db->getDialect());
+		$maxBindParams->setValue($db->getDialect(), 2);
+
+		$robots = RelationsRobots::find(array(
+			'order' => 'id',
+			'with' => 'relationsRobotsParts'
+		));
+		$this->assertEquals($queries, 3);
+		$this->assertEquals(count($robots->getFirst()->relationsRobotsParts), 3);
+		$this->assertEquals(count($robots->getLast()->relationsRobotsParts), 0);
+		$this->assertEquals($queries, 3);
+
+		$maxBindParams->setValue($db->getDialect(), $limit);
+
+		$db->setEventsManager(new Phalcon\Events\Manager());
+	}
+
 	protected function _testIssue938($di)
 	{
 		$manager = $di->getShared('modelsManager');
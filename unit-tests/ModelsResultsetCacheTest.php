@@ -212,6 +212,98 @@ class ModelsResultsetCacheTest extends PHPUnit_Framework_TestCase
 		));
 	}
 
+	protected function _testCacheVersions($di)
+	{
+
+		$di->set('modelsCache', function(){
+			$frontCache = new Phalcon\Cache\Frontend\Data();
+			return new Phalcon\Cache\Backend\File($frontCache, array(
+				'cacheDir' => 'unit-tests/cache/'
+			));
+		}, true);
+
+		$di->set('modelsManager', function(){
+			$modelsManager = new Phalcon\Mvc\Model\Manager();
+			$modelsManager->setVersionsCache('modelsCache');
+			return $modelsManager;
+		}, true);
+
+		$manager = $di->getShared('modelsManager');
+		$version = $manager->getTableVersion('robots');
+		$this->assertTrue(is_string($version));
+		$this->assertEquals($manager->getTableVersion(new Robots()), $version);
+
+		$robots = Robots::find(array('cache' => array('key' => 'versioned'), 'order' => 'id'));
+		$this->assertTrue($robots->isFresh());
+
+		$robots = Robots::find(array('cache' => array('key' => 'versioned'), 'order' => 'id'));
+		$this->assertFalse($robots->isFresh());
+		$this->assertEquals($robots->getCache()->getLastKey(), 'versioned-' . $version);
+
+		//Saving a record invalidates the cached queries reading its table
+		$robot = Robots::findFirst(1);
+		$this->assertTrue($robot->save());
+		$this->assertNotEquals($manager->getTableVersion('robots'), $version);
+
+		$robots = Robots::find(array('cache' => array('key' => 'versioned'), 'order' => 'id'));
+		$this->assertTrue($robots->isFresh());
+
+		$robots = Robots::find(array('cache' => array('key' => 'versioned'), 'order' => 'id'));
+		$this->assertFalse($robots->isFresh());
+
+		//Writes to other tables don't
+		$manager->bumpTableVersion('robots_parts');
+		$robots = Robots::find(array('cache' => array('key' => 'versioned'), 'order' => 'id'));
+		$this->assertFalse($robots->isFresh());
+
+		//PHQL updates bump the version once
+		$version = $manager->getTableVersion('robots');
+		$status = $manager->executeQuery('UPDATE Robots SET year = year WHERE id > 0');
+		$this->assertTrue($status->success());
+		$this->assertNotEquals($manager->getTableVersion('robots'), $version);
+
+		$robots = Robots::find(array('cache' => array('key' => 'versioned'), 'order' => 'id'));
+		$this->assertTrue($robots->isFresh());
+
+		//Writes inside a transaction change the version when it ends
+		$connection = $di->getShared('db');
+		$version = $manager->getTableVersion('robots');
+
+		$connection->begin();
+		$status = $manager->executeQuery('UPDATE Robots SET year = year WHERE id > 0');
+		$this->assertTrue($status->success());
+		$this->assertEquals($manager->getTableVersion('robots'), $version);
+		$robot = Robots::findFirst(1);
+		$this->assertTrue($robot->save());
+		$this->assertEquals($manager->getTableVersion('robots'), $version);
+		$connection->commit();
+		$this->assertNotEquals($manager->getTableVersion('robots'), $version);
+
+		$version = $manager->getTableVersion('robots');
+		$connection->begin();
+		$this->assertTrue($robot->save());
+		$this->assertEquals($manager->getTableVersion('robots'), $version);
+		$connection->rollback();
+		$this->assertNotEquals($manager->getTableVersion('robots'), $version);
+
+		//Writes after the transaction are not deferred anymore
+		$version = $manager->getTableVersion('robots');
+		$this->assertTrue($robot->save());
+		$this->assertNotEquals($manager->getTableVersion('robots'), $version);
+
+		//A transaction dropped by reconnecting doesn't keep deferring the versions
+		$version = $manager->getTableVersion('robots');
+		$connection->begin();
+		$this->assertTrue($robot->save());
+		$this->assertEquals($manager->getTableVersion('robots'), $version);
+		$connection->close();
+		$connection->connect();
+		$this->assertEquals($manager->getTableVersion('robots'), $version);
+
+		$this->assertTrue($robot->save());
+		$this->assertNotEquals($manager->getTableVersion('robots'), $version);
+	}
+
 	public function testCacheDefaultDIMysql()
 	{
 		$di = $this->_prepareTestMysql();
@@ -311,4 +403,15 @@ class ModelsResultsetCacheTest extends PHPUnit_Framework_TestCase
 		}
 	}
 
+	public function testCacheVersionsSqlite()
+	{
+		$di = $this->_prepareTestSqlite();
+		if ($di) {
+			$this->_testCacheVersions($di);
+		}
+		else {
+			$this->markTestSkipped("Skipped");
+		}
+	}
+
 }
@@ -485,6 +485,240 @@ class ModelsResultsetTest extends PHPUnit_Framework_TestCase
 
 	}
 
+	public function testSerializeCompactSqlite()
+	{
+		if (!$this->_prepareTestSqlite()) {
+			$this->markTestSkipped("Skipped");
+			return;
+		}
+
+		$resultset = Personas::find(array('limit' => 33));
+		$rows = $resultset->toArray();
+
+		$data = serialize($resultset);
+		$this->assertTrue(strpos($data, 'PHRS') !== false);
+
+		$personas = unserialize($data);
+		$this->assertEquals($personas->toArray(), $rows);
+
+		//Rows serialized as plain arrays are still accepted
+		$legacy = serialize(array(
+			'model'       => new Personas(),
+			'cache'       => null,
+			'rows'        => $rows,
+			'columnMap'   => null,
+			'hydrateMode' => 0
+		));
+		$class = 'Phalcon\Mvc\Model\Resultset\Simple';
+		$legacy = 'C:' . strlen($class) . ':"' . $class . '":' . strlen($legacy) . ':{' . $legacy . '}';
+
+		$personas = unserialize($legacy);
+		$this->assertEquals($personas->toArray(), $rows);
+
+		$this->_applyTestsBig($personas);
+
+		//Corrupted entries are a cache miss and don't raise warnings
+		$cache = new Phalcon\Cache\Backend\Memory(new Phalcon\Cache\Frontend\Data(array('lifetime' => 3600)));
+		Phalcon\DI::getDefault()->set('modelsCache', $cache, true);
+
+		$parameters = array('limit' => 33, 'order' => 'cedula', 'cache' => array('key' => 'corrupted'));
+		$rows = Personas::find($parameters)->toArray();
+
+		$property = new ReflectionProperty($cache, '_data');
+		$property->setAccessible(true);
+		$entries = $property->getValue($cache);
+		$this->assertEquals(count($entries), 1);
+		foreach ($entries as $key => $entry) {
+			$position = strpos($entry, 'PHRS') + 6;
+			$entries[$key] = substr_replace($entry, str_repeat('x', 16), $position, 16);
+		}
+		$property->setValue($cache, $entries);
+
+		$personas = Personas::find($parameters);
+		$this->assertTrue($personas->isFresh());
+		$this->assertEquals($personas->toArray(), $rows);
+
+		$personas = Personas::find($parameters);
+		$this->assertFalse($personas->isFresh());
+		$this->assertEquals($personas->toArray(), $rows);
+	}
+
+	public function testColumnarSqlite()
+	{
+		if (!$this->_prepareTestSqlite()) {
+			$this->markTestSkipped("Skipped");
+			return;
+		}
+
+		$rows = Personas::find(array('limit' => 33))->toArray();
+		$robotRows = Robots::find(array('order' => 'id'))->toArray();
+
+		Phalcon\Mvc\Model::setup(array('columnarResultsets' => 1));
+
+		$personas = unserialize(serialize(Personas::find(array('limit' => 33))));
+		$this->assertEquals($personas->toArray(), $rows);
+		$this->assertEquals($personas[5]->toArray(), $rows[5]);
+		$this->_applyTestsBig($personas);
+
+		$robots = unserialize(serialize(Robots::find(array('order' => 'id'))));
+		$this->assertEquals($robots->toArray(), $robotRows);
+		$this->_applyTests($robots);
+
+		//Rows fetched by count(), seek() and foreach are stored by column too
+		$personas = Personas::find(array('limit' => 33));
+		$this->assertEquals(count($personas), count($rows));
+		for ($pass = 0; $pass < 2; $pass++) {
+			$number = 0;
+			foreach ($personas as $key => $persona) {
+				$this->assertEquals($persona->toArray(), $rows[$key]);
+				$number++;
+			}
+			$this->assertEquals($number, count($rows));
+		}
+
+		$personas = Personas::find(array('limit' => 33));
+		$personas->seek(20);
+		$this->assertEquals($personas->current()->toArray(), $rows[20]);
+		$this->assertEquals($personas->getLast()->toArray(), $rows[32]);
+		$this->assertEquals($personas->getFirst()->toArray(), $rows[0]);
+		$this->assertEquals($personas->toArray(), $rows);
+
+		$personas = Personas::find(array('limit' => 33));
+		foreach ($personas as $key => $persona) {
+			$this->assertEquals($persona->toArray(), $rows[$key]);
+		}
+		$this->assertEquals(count($personas), count($rows));
+
+		Phalcon\Mvc\Model::setup(array('columnarResultsets' => 0));
+	}
+
+	public function testColumnOperationsSqlite()
+	{
+		if (!$this->_prepareTestSqlite()) {
+			$this->markTestSkipped("Skipped");
+			return;
+		}
+
+		$robots = Robots::find(array('order' => 'id'));
+
+		$this->assertEquals($robots->pluck('id'), array(1, 2, 3));
+		$this->assertEquals($robots->sum('year'), 1972 + 1952 + 2029);
+		$this->assertEquals($robots->min('year'), 1952);
+		$this->assertEquals($robots->max('name'), 'Terminator');
+
+		$indexed = $robots->indexBy('name');
+		$this->assertEquals(array_keys($indexed), array('Robotina', 'Astro Boy', 'Terminator'));
+		$this->assertEquals($indexed['Astro Boy']['year'], 1952);
+
+		$grouped = $robots->groupBy('type');
+		$this->assertEquals(count($grouped['mechanical']), 2);
+		$this->assertEquals(count($grouped['cyborg']), 1);
+
+		$mechanical = $robots->filter(array('type' => 'mechanical'));
+		$this->assertEquals(count($mechanical), 2);
+		$this->assertEquals(get_class($mechanical[0]), 'Robots');
+		$this->assertEquals($mechanical[1]->name, 'Astro Boy');
+
+		$this->assertEquals(count($robots->filter(array('id' => array(1, 3)))), 2);
+
+		//The attributes of the column map are used
+		$robotters = Robotters::find(array('order' => 'code'));
+		$this->assertEquals($robotters->pluck('code'), array(1, 2, 3));
+
+		$indexed = $robotters->indexBy('code');
+		$this->assertEquals($indexed[3]['theName'], 'Terminator');
+
+		$cyborgs = $robotters->filter(array('theType' => 'cyborg'));
+		$this->assertEquals(count($cyborgs), 1);
+		$this->assertEquals($cyborgs[0]->theName, 'Terminator');
+
+		try {
+			$robotters->pluck('name');
+			$this->assertTrue(false);
+		} catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), "Column 'name' is not part of the column map");
+		}
+	}
+
+	public function testResultsetCountFallbacksSqlite()
+	{
+		if (!$this->_prepareTestSqlite()) {
+			$this->markTestSkipped("Skipped");
+			return;
+		}
+
+		$fallbacks = Phalcon\Db\Result\Pdo::getCountFallbacks();
+
+		//Small resultsets are buffered, counting them doesn't need an extra query
+		$robots = Robots::find(array('order' => 'id'));
+		$this->assertEquals(count($robots), 3);
+		$this->assertEquals(Phalcon\Db\Result\Pdo::getCountFallbacks(), $fallbacks);
+
+		$this->_applyTests($robots);
+		$this->assertEquals(Phalcon\Db\Result\Pdo::getCountFallbacks(), $fallbacks);
+
+		//Big resultsets only count when explicitly requested
+		$personas = Personas::find(array('limit' => 33));
+		$this->assertEquals(Phalcon\Db\Result\Pdo::getCountFallbacks(), $fallbacks);
+
+		$this->assertEquals(count($personas), 33);
+		$this->assertEquals(Phalcon\Db\Result\Pdo::getCountFallbacks(), $fallbacks + 1);
+
+		$this->_applyTestsBig($personas);
+
+		//Big resultsets continue from the open cursor, the SELECT is executed only once
+		$queries = 0;
+
+		$eventsManager = new Phalcon\Events\Manager();
+		$eventsManager->attach('db:beforeQuery', function() use (&$queries) {
+			$queries++;
+		});
+
+		$connection = Phalcon\DI::getDefault()->getShared('db');
+		$connection->setEventsManager($eventsManager);
+
+		$number = 0;
+		foreach (Personas::find(array('limit' => 40)) as $persona) {
+			$number++;
+		}
+		$this->assertEquals($number, 40);
+		$this->assertEquals($queries, 1);
+
+		$personas = Personas::find(array('limit' => 40));
+		$this->assertEquals(count($personas->toArray()), 40);
+		$this->assertEquals($queries, 2);
+
+		$connection->setEventsManager(null);
+	}
+
+	public function testDbResultRowCountSqlite()
+	{
+		require 'unit-tests/config.db.php';
+		if (empty($configSqlite)) {
+			$this->markTestSkipped("Skipped");
+			return;
+		}
+
+		$connection = new Phalcon\Db\Adapter\Pdo\Sqlite($configSqlite);
+
+		$fallbacks = Phalcon\Db\Result\Pdo::getCountFallbacks();
+
+		$result = $connection->query("SELECT * FROM robots ORDER BY id");
+		$result->fetchAll();
+		$this->assertEquals($result->numRows(), 3);
+
+		$result = $connection->query("SELECT * FROM robots ORDER BY id");
+		while ($result->fetch()) {
+		}
+		$this->assertEquals($result->numRows(), 3);
+
+		$this->assertEquals(Phalcon\Db\Result\Pdo::getCountFallbacks(), $fallbacks);
+
+		$result = $connection->query("SELECT * FROM robots ORDER BY id");
+		$this->assertEquals($result->numRows(), 3);
+		$this->assertEquals(Phalcon\Db\Result\Pdo::getCountFallbacks(), $fallbacks + 1);
+	}
+
 	public function testResultsetNormalZero()
 	{
 		if (!$this->_prepareTestMysql()) {
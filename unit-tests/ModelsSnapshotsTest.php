@@ -126,6 +126,14 @@ class ModelsSnapshotsTest extends PHPUnit_Framework_TestCase
 			$robot->year = 2005;
 			$this->assertEquals($robot->getChangedFields(), array('name', 'year'));
 		}
+
+		foreach (Snapshot\Robots::find(array('order' => 'id')) as $robot) {
+			$this->assertEquals($robot->getChangedFields(), array());
+			$robot->name .= ' II';
+			$robot->writeAttribute('type', 'android');
+			$this->assertTrue($robot->hasChanged('name'));
+			$this->assertEquals($robot->getChangedFields(), array('name', 'type'));
+		}
 	}
 
 	protected function _executeTestsRenamed($di)
@@ -176,6 +184,13 @@ class ModelsSnapshotsTest extends PHPUnit_Framework_TestCase
 			$robot->theYear = 2005;
 			$this->assertEquals($robot->getChangedFields(), array('theName', 'theYear'));
 		}
+
+		foreach (Snapshot\Robotters::find(array('order' => 'code')) as $robot) {
+			$this->assertEquals($robot->getChangedFields(), array());
+			$robot->writeAttribute('theType', 'android');
+			$this->assertTrue($robot->hasChanged('theType'));
+			$this->assertEquals($robot->getChangedFields(), array('theType'));
+		}
 	}
 
 	protected function _executeTestsNormalComplex($di)
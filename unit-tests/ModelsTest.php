@@ -146,6 +146,324 @@ class ModelsTest extends PHPUnit_Framework_TestCase
 		$this->issue886($di);
 	}
 
+	public function testModelsCreateManySqlite()
+	{
+		require 'unit-tests/config.db.php';
+		if (empty($configSqlite)) {
+			$this->markTestSkipped("Skipped");
+			return;
+		}
+
+		$di = $this->_getDI(function(){
+			require 'unit-tests/config.db.php';
+			return new Phalcon\Db\Adapter\Pdo\Sqlite($configSqlite);
+		});
+
+		$db = $di->getShared('db');
+		$this->assertTrue($db->delete('prueba'));
+
+		//More rows than bind parameters accepted by SQLite in a single statement
+		$records = array();
+		for ($i = 0; $i < 1200; $i++) {
+			$records[] = array('nombre' => 'BATCH '.$i, 'estado' => 'A');
+		}
+
+		$prueba = new Prueba();
+		$prueba->nombre = 'BATCH MODEL';
+		$prueba->estado = 'I';
+		$records[] = $prueba;
+
+		$this->assertTrue(Prueba::createMany($records));
+		$this->assertEquals(Prueba::count(), 1201);
+		$this->assertEquals(Prueba::count("estado = 'I'"), 1);
+		$this->assertEquals($prueba->getDirtyState(), Phalcon\Mvc\Model::DIRTY_STATE_PERSISTENT);
+
+		//The generated ids are assigned back in order, so the record can be updated afterwards
+		$this->assertEquals(Prueba::findFirst("nombre = 'BATCH 1199'")->id, $prueba->id - 1);
+		$prueba->nombre = 'BATCH MODEL UPDATED';
+		$this->assertTrue($prueba->save());
+		$this->assertEquals(Prueba::count(), 1201);
+		$this->assertEquals(Prueba::findFirst($prueba->id)->nombre, 'BATCH MODEL UPDATED');
+
+		//A record failing the validation aborts the whole batch
+		$this->assertFalse(Prueba::createMany(array(
+			array('nombre' => 'BATCH OK', 'estado' => 'A'),
+			array('nombre' => 'BATCH FAIL')
+		)));
+		$this->assertEquals(Prueba::count(), 1201);
+
+		//An insert throwing an exception rolls the transaction back
+		$existing = Prueba::findFirst("estado = 'I'");
+		try {
+			Prueba::createMany(array(
+				array('nombre' => 'BATCH NEW', 'estado' => 'A'),
+				array('id' => $existing->id, 'nombre' => 'BATCH DUPLICATED', 'estado' => 'A')
+			));
+			$this->assertTrue(false);
+		} catch (PDOException $e) {
+			$this->assertFalse($db->isUnderTransaction());
+		}
+		$this->assertEquals(Prueba::count(), 1201);
+
+		$manager = $di->getShared('modelsManager');
+		$manager->useIdentityMap('Prueba', true);
+		$this->assertSame(Prueba::findFirst($existing->id), Prueba::findFirst($existing->id));
+
+		$queries = 0;
+		$eventsManager = new Phalcon\Events\Manager();
+		$eventsManager->attach('db:beforeQuery', function() use (&$queries) {
+			$queries++;
+		});
+		$db->setEventsManager($eventsManager);
+
+		//Set-based update over the primary keys held by the resultset, the records aren't loaded,
+		//the 1200 keys are sent in two chunks of bind parameters
+		$this->assertTrue(Prueba::find("estado = 'A'")->update(array('estado' => 'X')));
+		$this->assertEquals($queries, 3);
+		$db->setEventsManager(null);
+
+		$this->assertEquals(Prueba::count("estado = 'X'"), 1200);
+		$this->assertNull($manager->getIdentityRecord('Prueba', $existing->id));
+		$manager->useIdentityMap('Prueba', false);
+
+		//Chunked update and delete over more primary keys than bind parameters
+
+		$this->assertTrue(Prueba::find()->update(array('estado' => 'Y'), function($prueba){
+			return $prueba->nombre != 'BATCH MODEL';
+		}));
+		$this->assertEquals(Prueba::count("estado = 'Y'"), 1200);
+		$this->assertEquals(Prueba::count("estado = 'I'"), 1);
+
+		$this->assertTrue(Prueba::find()->delete(function($prueba){
+			return $prueba->estado == 'Y';
+		}));
+		$this->assertEquals(Prueba::count(), 1);
+
+		$this->assertTrue(Prueba::find(array("estado = :estado:", "bind" => array('estado' => 'I')))->delete());
+		$this->assertEquals(Prueba::count(), 0);
+	}
+
+	public function testModelsUpsertSqlite()
+	{
+		require 'unit-tests/config.db.php';
+		if (empty($configSqlite)) {
+			$this->markTestSkipped("Skipped");
+			return;
+		}
+
+		$di = $this->_getDI(function(){
+			require 'unit-tests/config.db.php';
+			return new Phalcon\Db\Adapter\Pdo\Sqlite($configSqlite);
+		});
+
+		$dialect = new Phalcon\Db\Dialect\Mysql();
+		$this->assertEquals($dialect->upsert('`robots`', array('`id`', '`name`'), array('?', '?'), array('`id`'), array('`name`')), 'INSERT INTO `robots` (`id`, `name`) VALUES (?, ?) ON DUPLICATE KEY UPDATE `id` = LAST_INSERT_ID(`id`), `name` = VALUES(`name`)');
+		$this->assertEquals($dialect->upsert('`robots`', array('`id`'), array('?'), array('`id`')), 'INSERT INTO `robots` (`id`) VALUES (?) ON DUPLICATE KEY UPDATE `id` = LAST_INSERT_ID(`id`)');
+		$dialect = new Phalcon\Db\Dialect\Postgresql();
+		$this->assertEquals($dialect->upsert('"robots"', array('"id"', '"name"'), array('?', '?'), array('"id"'), array('"name"')), 'INSERT INTO "robots" ("id", "name") VALUES (?, ?) ON CONFLICT ("id") DO UPDATE SET "name" = EXCLUDED."name"');
+		$this->assertEquals($dialect->upsert('"robots"', array('"id"'), array('?'), array('"id"')), 'INSERT INTO "robots" ("id") VALUES (?) ON CONFLICT ("id") DO NOTHING');
+
+		$db = $di->getShared('db');
+		$this->assertTrue($db->delete('prueba'));
+		$this->assertEquals(Prueba::count(), 0);
+
+		$queries = 0;
+		$eventsManager = new Phalcon\Events\Manager();
+		$eventsManager->attach('db:beforeQuery', function() use (&$queries) {
+			$queries++;
+		});
+		$db->setEventsManager($eventsManager);
+
+		//New records are written without checking whether they exist
+		$prueba = new Prueba();
+		$prueba->nombre = 'UPSERT';
+		$prueba->estado = 'A';
+		$this->assertTrue($prueba->upsert());
+		$this->assertEquals($queries, 1);
+		$this->assertTrue($prueba->id > 0);
+		$this->assertEquals($prueba->getDirtyState(), Phalcon\Mvc\Model::DIRTY_STATE_PERSISTENT);
+
+		//A conflicting primary key updates the existing row
+		$other = new Prueba();
+		$this->assertTrue($other->upsert(array('id' => $prueba->id, 'nombre' => 'UPSERTED', 'estado' => 'I')));
+		$this->assertEquals($queries, 2);
+
+		$db->setEventsManager(null);
+		$this->assertEquals(Prueba::count(), 1);
+		$this->assertEquals(Prueba::findFirst($prueba->id)->nombre, 'UPSERTED');
+
+		//Validations still run
+		$invalid = new Prueba();
+		$invalid->nombre = 'UPSERT FAIL';
+		$this->assertFalse($invalid->upsert());
+		$this->assertEquals(Prueba::count(), 1);
+
+		//A mapped instance of the upserted row is dropped from the identity map
+		$manager = $di->getShared('modelsManager');
+		$manager->useIdentityMap('Prueba', true);
+		$mapped = Prueba::findFirst($prueba->id);
+		$this->assertSame($manager->getIdentityRecord('Prueba', $prueba->id), $mapped);
+
+		$other = new Prueba();
+		$this->assertTrue($other->upsert(array('id' => $prueba->id, 'nombre' => 'MAPPED', 'estado' => 'A')));
+		$this->assertNull($manager->getIdentityRecord('Prueba', $prueba->id));
+		$this->assertEquals(Prueba::findFirst($prueba->id)->nombre, 'MAPPED');
+		$manager->useIdentityMap('Prueba', false);
+
+		$this->assertTrue($db->delete('prueba'));
+	}
+
+	public function testModelsIdentityMapSqlite()
+	{
+		require 'unit-tests/config.db.php';
+		if (empty($configSqlite)) {
+			$this->markTestSkipped("Skipped");
+			return;
+		}
+
+		$di = $this->_getDI(function(){
+			require 'unit-tests/config.db.php';
+			return new Phalcon\Db\Adapter\Pdo\Sqlite($configSqlite);
+		});
+
+		$manager = $di->getShared('modelsManager');
+		$manager->useIdentityMap('Robots', true);
+		$this->assertTrue($manager->isUsingIdentityMap('Robots'));
+		$this->assertFalse($manager->isUsingIdentityMap('RobotsParts'));
+
+		$robot = Robots::findFirst(1);
+		$this->assertEquals(get_class($robot), 'Robots');
+		$part = RobotsParts::findFirst(1);
+
+		$queries = 0;
+		$eventsManager = new Phalcon\Events\Manager();
+		$eventsManager->attach('db:beforeQuery', function() use (&$queries) {
+			$queries++;
+		});
+		$di->getShared('db')->setEventsManager($eventsManager);
+
+		//Primary key lookups and belongsTo relations are served by the map
+		$this->assertSame(Robots::findFirst(1), $robot);
+		$this->assertSame(Robots::findFirst("1"), $robot);
+		$this->assertSame($part->robots, $robot);
+		$this->assertEquals($queries, 0);
+
+		//Other lookups still hit the database
+		$this->assertNotSame(Robots::findFirst("id = 1"), $robot);
+		$this->assertEquals($queries, 1);
+
+		//Refreshing the record drops it from the map
+		$robot->refresh();
+		$queries = 0;
+		$other = Robots::findFirst(1);
+		$this->assertNotSame($other, $robot);
+		$this->assertEquals($queries, 1);
+		$this->assertSame(Robots::findFirst(1), $other);
+		$this->assertEquals($queries, 1);
+
+		$manager->clearIdentityMap('Robots');
+		$this->assertNull($manager->getIdentityRecord('Robots', 1));
+		$this->assertNotSame(Robots::findFirst(1), $other);
+		$this->assertEquals($queries, 2);
+
+		//PHQL writes drop the records of the model from the map
+		$robot = Robots::findFirst(1);
+		$status = $manager->executeQuery('UPDATE Robots SET year = :year: WHERE id = 1', array('year' => $robot->year));
+		$this->assertTrue($status->success());
+		$this->assertNull($manager->getIdentityRecord('Robots', 1));
+
+		$di->getShared('db')->setEventsManager(null);
+		$manager->useIdentityMap('Robots', false);
+	}
+
+	public function testModelsReadOnlySqlite()
+	{
+		require 'unit-tests/config.db.php';
+		if (empty($configSqlite)) {
+			$this->markTestSkipped("Skipped");
+			return;
+		}
+
+		$di = $this->_getDI(function(){
+			require 'unit-tests/config.db.php';
+			return new Phalcon\Db\Adapter\Pdo\Sqlite($configSqlite);
+		});
+
+		//Per query
+		$robots = Robots::find(array('order' => 'id', 'hydration' => Phalcon\Mvc\Model\Resultset::HYDRATE_READONLY));
+		$robot = $robots->getFirst();
+		$this->assertEquals(get_class($robot), 'Robots');
+		$this->assertEquals($robot->name, 'Robotina');
+		$this->assertEquals($robot->getDirtyState(), Phalcon\Mvc\Model::DIRTY_STATE_PERSISTENT);
+		$this->assertFalse($robot->hasSnapshotData());
+
+		try {
+			$robot->name = 'Other';
+			$this->fail('Attribute written in a read-only record');
+		} catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), "Cannot modify the attribute 'name' of a read-only record");
+		}
+		$this->assertEquals($robot->name, 'Robotina');
+
+		//Only the internal properties of the model are exempted, not every underscored name
+		try {
+			$robot->_name = 'Other';
+			$this->fail('Underscored attribute written in a read-only record');
+		} catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), "Cannot modify the attribute '_name' of a read-only record");
+		}
+		$this->assertFalse(isset($robot->_name));
+
+		$clone = clone $robot;
+		try {
+			$clone->name = 'Other';
+			$this->fail('Attribute written in a clone of a read-only record');
+		} catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), "Cannot modify the attribute 'name' of a read-only record");
+		}
+
+		try {
+			$robot->delete();
+			$this->fail('Read-only record deleted');
+		} catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), 'The record is read-only');
+		}
+
+		//Related records are kept without adding attributes to the record
+		$robotsParts = $robot->robotsParts;
+		$this->assertEquals(count($robotsParts), 3);
+		$this->assertSame($robot->robotsParts, $robotsParts);
+
+		$robot = unserialize(serialize($robot));
+		$this->assertEquals($robot->name, 'Robotina');
+		try {
+			$robot->name = 'Other';
+			$this->fail('Attribute written in an unserialized read-only record');
+		} catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), "Cannot modify the attribute 'name' of a read-only record");
+		}
+
+		//Per model
+		$manager = $di->getShared('modelsManager');
+		$manager->useReadOnlyRecords('Robots', true);
+		$this->assertTrue($manager->isUsingReadOnlyRecords('Robots'));
+		$this->assertFalse($manager->isUsingReadOnlyRecords('RobotsParts'));
+
+		$robot = Robots::findFirst(1);
+		$this->assertEquals($robot->id, 1);
+		try {
+			$robot->save();
+			$this->fail('Read-only record saved');
+		} catch (Phalcon\Mvc\Model\Exception $e) {
+			$this->assertEquals($e->getMessage(), 'The record is read-only');
+		}
+
+		$manager->useReadOnlyRecords('Robots', false);
+		$robot = Robots::findFirst(1);
+		$robot->name = 'Other';
+		$this->assertEquals($robot->name, 'Other');
+	}
+
 	protected function issue1534($di)
 	{
 		$db = $di->getShared('db');
@@ -416,4 +416,88 @@ class PaginatorTest extends PHPUnit_Framework_TestCase
 		$this->assertEquals($setterResult, $paginator);
 	}
 
+	public function testKeysetPaginator()
+	{
+		require 'unit-tests/config.db.php';
+		if (empty($configMysql)) {
+			$this->markTestSkipped('Test skipped');
+			return;
+		}
+
+		$di = $this->_loadDI();
+
+		$builder = $di['modelsManager']->createBuilder()
+					->columns('cedula, nombres')
+					->from('Personnes');
+
+		$paginator = new Phalcon\Paginator\Adapter\Keyset(array(
+			"builder" => $builder,
+			"keys" => array('cedula'),
+			"limit"=> 10
+		));
+
+		$this->assertEquals($paginator->getKeys(), array('cedula' => 'ASC'));
+
+		$page = $paginator->getPaginate();
+
+		$this->assertEquals(get_class($page), 'stdClass');
+		$this->assertEquals(count($page->items), 10);
+		$this->assertNull($page->first);
+		$this->assertNull($page->current);
+		$this->assertTrue(is_string($page->next));
+
+		//The second page is the same one paginating with offsets
+		$offsetPaginator = new Phalcon\Paginator\Adapter\QueryBuilder(array(
+			"builder" => $di['modelsManager']->createBuilder()
+				->columns('cedula, nombres')
+				->from('Personnes')
+				->orderBy('cedula'),
+			"limit"=> 10,
+			"page" => 2
+		));
+		$offsetPage = $offsetPaginator->getPaginate();
+
+		$cursor = $page->next;
+		$page = $paginator->setCurrentPage($cursor)->getPaginate();
+
+		$this->assertEquals($page->current, $cursor);
+		$this->assertEquals(count($page->items), 10);
+		foreach ($page->items as $n => $item) {
+			$this->assertEquals($item->cedula, $offsetPage->items[$n]->cedula);
+		}
+
+		//The builder is left as it is
+		$this->assertEquals($builder->getPhql(), 'SELECT cedula, nombres FROM [Personnes]');
+
+		//Descending keys
+		$paginator = new Phalcon\Paginator\Adapter\Keyset(array(
+			"builder" => $builder,
+			"keys" => array('cedula' => 'desc'),
+			"limit"=> 5
+		));
+
+		$first = $paginator->getPaginate();
+		$second = $paginator->setCurrentPage($first->next)->getPaginate();
+		$this->assertTrue(end($first->items)->cedula > reset($second->items)->cedula);
+
+		//A page holding the last rows has no next page, even when it is full
+		$total = $builder->getQuery()->execute()->count();
+		$paginator = new Phalcon\Paginator\Adapter\Keyset(array(
+			"builder" => $builder,
+			"keys" => array('cedula'),
+			"limit"=> $total
+		));
+
+		$page = $paginator->getPaginate();
+		$this->assertEquals(count($page->items), $total);
+		$this->assertNull($page->next);
+
+		try {
+			$paginator->setCurrentPage('not a cursor')->getPaginate();
+			$this->assertTrue(false);
+		} catch (Phalcon\Paginator\Exception $e) {
+			$this->assertEquals($e->getMessage(), 'The cursor is not valid for this paginator');
+		}
+	}
+
 }